@@ -0,0 +1,1459 @@
+/*
+ * Multi-resolution time-frequency tiling for the excess power search
+ *
+ * Copyright (C) 2026  The gstlal authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+/**
+ * SECTION:gstlal_burst_tiler
+ * @short_description:  Compute excess power tile energies at many
+ * time-frequency resolutions in one pass.
+ *
+ * Replaces the per-resolution chains of lal_firbank, lal_audioundersample,
+ * lal_matrixmixer, pow and lal_mean built by the excess power pipeline.
+ * The single-channel whitened input is projected onto the base band
+ * channel filters ("fir-matrix") with FFT convolution, using the same
+ * kernel and latency conventions as lal_firbank configured with a latency
+ * of half the filter length.  Each channel's spectrum is folded to the
+ * rate of the highest requested resolution level before the inverse
+ * transform, so only the samples that are kept are ever computed.
+ *
+ * Resolution level l combines 2^l base channels into each wide channel,
+ * sampled at 2 * base-band * 2^l Hz.  The wide channels of level l + 1 are
+ * sums of pairs of level l wide channels, so the channel sums of all
+ * levels are built as one pyramid.  Each wide channel is normalized by
+ * 1 / mu^2 from the "channel-norms" property and squared.  A running sum
+ * along time shared by all request pads of a level then yields the sum
+ * over any number of degrees of freedom with one subtraction per sample.
+ *
+ * One source pad is requested per tile shape, named level_l_dof_d.  It
+ * carries one channel per wide channel of level l, each sample being the
+ * sum of the d most recent normalized energies, exactly as lal_mean with
+ * type = 2 and n = d would produce.  Output samples are aligned with
+ * those lal_audioundersample would keep.
+ *
+ * Setting "fir-matrix" or "channel-norms" to values of the same shape
+ * while the element is running replaces the filters between two blocks
+ * without interrupting the output streams.
+ */
+
+
+/*
+ * ========================================================================
+ *
+ *                                  Preamble
+ *
+ * ========================================================================
+ */
+
+
+/*
+ * stuff from C library, glib/gstreamer
+ */
+
+
+#include <complex.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <glib.h>
+#include <gst/gst.h>
+
+
+/*
+ * stuff from FFTW and GSL
+ */
+
+
+#include <fftw3.h>
+#include <gsl/gsl_matrix.h>
+
+
+/*
+ * our own stuff
+ */
+
+
+#include <gstlal/gstlal.h>
+#include <gstlal/gstlal_debug.h>
+#include <gstlal/gstaudioadapter.h>
+#include <gstlal_burst_tiler.h>
+
+
+#define DEFAULT_BASE_BAND 16.0
+#define DEFAULT_FREQUENCY_OVERLAP 0.0
+#define DEFAULT_BLOCK_STRIDE 0
+
+
+/*
+ * ============================================================================
+ *
+ *                                 Utilities
+ *
+ * ============================================================================
+ */
+
+
+static guint fir_channels(const GSTLALBurst_Tiler *element)
+{
+	return element->fir_matrix->size1;
+}
+
+
+static guint fir_length(const GSTLALBurst_Tiler *element)
+{
+	return element->fir_matrix->size2;
+}
+
+
+/*
+ * the filters from excesspower.filters are centred on their middle
+ * sample
+ */
+
+
+static guint fir_latency(const GSTLALBurst_Tiler *element)
+{
+	return fir_length(element) / 2;
+}
+
+
+/*
+ * with frequency overlap the base channels are interleaved in this many
+ * sets, and wide channels only combine channels from one set
+ */
+
+
+static guint channel_sets(const GSTLALBurst_Tiler *element)
+{
+	return (guint) (1.0 / (1.0 - element->frequency_overlap));
+}
+
+
+static guint level_channels(const GSTLALBurst_Tiler *element, guint level)
+{
+	return fir_channels(element) >> level;
+}
+
+
+/*
+ * wide channel r of a level is the sum of the base channels g n m + s +
+ * m j, j = 0, ..., n - 1, where n = 2^level, m is the number of sets, g =
+ * r / m and s = r % m.  at the top of the bank there might not be enough
+ * base channels left, in which case the wide channel is identically 0.
+ * this matches excesspower.filters.build_chan_matrix().
+ */
+
+
+static gboolean wide_channel_is_valid(const GSTLALBurst_Tiler *element, guint level, guint r)
+{
+	guint m = channel_sets(element);
+	guint n = 1 << level;
+
+	return (r / m) * n * m + r % m + m * (n - 1) < fir_channels(element);
+}
+
+
+static gboolean level_rate(const GSTLALBurst_Tiler *element, guint level, gint *rate)
+{
+	double r = 2.0 * element->base_band * (1 << level);
+
+	*rate = (gint) floor(r + 0.5);
+	return *rate >= 1 && fabs(r - *rate) < 1e-9 * r;
+}
+
+
+static guint64 get_available_samples(GSTLALBurst_Tiler *element)
+{
+	guint size;
+
+	g_object_get(element->adapter, "size", &size, NULL);
+
+	return size;
+}
+
+
+/*
+ * construct a gap buffer and push into adapter
+ */
+
+
+static int push_gap(GSTLALBurst_Tiler *element, unsigned samples)
+{
+	GstBuffer *zerobuf;
+
+	if(samples) {
+		zerobuf = gst_buffer_new();
+		if(!zerobuf) {
+			GST_ERROR_OBJECT(element, "failure allocating zero-pad buffer");
+			return -1;
+		}
+		GST_BUFFER_FLAG_SET(zerobuf, GST_BUFFER_FLAG_GAP);
+		GST_BUFFER_TIMESTAMP(zerobuf) = gst_audioadapter_expected_timestamp(element->adapter);
+		if(!GST_BUFFER_TIMESTAMP_IS_VALID(zerobuf))
+			GST_BUFFER_TIMESTAMP(zerobuf) = 0;
+		GST_BUFFER_DURATION(zerobuf) = gst_util_uint64_scale_int_round(samples, GST_SECOND, element->rate);
+		GST_BUFFER_OFFSET(zerobuf) = gst_audioadapter_expected_offset(element->adapter);
+		if(!GST_BUFFER_OFFSET_IS_VALID(zerobuf))
+			GST_BUFFER_OFFSET(zerobuf) = 0;
+		GST_BUFFER_OFFSET_END(zerobuf) = GST_BUFFER_OFFSET(zerobuf) + samples;
+		gst_audioadapter_push(element->adapter, zerobuf);
+	}
+
+	return 0;
+}
+
+
+/*
+ * ============================================================================
+ *
+ *                                 Workspace
+ *
+ * ============================================================================
+ */
+
+
+/*
+ * transform the time-domain filters to the frequency domain.  as in
+ * lal_firbank the filters are pre-scaled by 1/n and conjugated.  this is
+ * all that needs doing when the filters are replaced by new ones of the
+ * same shape.  call with filter_lock held.
+ */
+
+
+static void transform_filters(GSTLALBurst_Tiler *element)
+{
+	guint length_fd = element->workspace.block_length_fd;
+	guint i, j;
+
+	for(i = 0; i < fir_channels(element); i++) {
+		memset(element->workspace.input, 0, length_fd * sizeof(*element->workspace.input));
+		for(j = 0; j < fir_length(element); j++)
+			((double *) element->workspace.input)[j] = gsl_matrix_get(element->fir_matrix, i, j) / element->workspace.block_length;
+		fftw_execute(element->workspace.in_plan);
+		for(j = 0; j < length_fd; j++)
+			element->workspace.working_fir_matrix[i * length_fd + j] = conj(element->workspace.input[j]);
+	}
+}
+
+
+static void reset_levels(GSTLALBurst_Tiler *element, guint64 first_offset)
+{
+	guint level;
+
+	for(level = 0; level <= element->workspace.top_level; level++) {
+		struct gstlal_burst_tiler_level *lev = &element->workspace.level[level];
+		if(!lev->requested)
+			continue;
+		/* lal_mean starts from n - 1 zeros */
+		memset(lev->energy, 0, lev->history * lev->channels * sizeof(*lev->energy));
+		lev->zero_run = lev->history;
+		lev->next_out_offset = first_offset / lev->cadence;
+	}
+}
+
+
+static void free_workspace(GSTLALBurst_Tiler *element)
+{
+	guint level;
+
+	if(!element->workspace.level)
+		return;
+
+	gstlal_fftw_lock();
+	fftw_free(element->workspace.input);
+	fftw_destroy_plan(element->workspace.in_plan);
+	fftw_free(element->workspace.folded);
+	fftw_destroy_plan(element->workspace.out_plan);
+	fftw_free(element->workspace.working_fir_matrix);
+	gstlal_fftw_unlock();
+
+	g_free(element->workspace.fold_index);
+	for(level = 0; level <= element->workspace.top_level; level++) {
+		g_free(element->workspace.pyramid[level]);
+		g_free(element->workspace.level[level].energy);
+		g_free(element->workspace.level[level].prefix);
+	}
+	g_free(element->workspace.pyramid);
+	g_free(element->workspace.level);
+	memset(&element->workspace, 0, sizeof(element->workspace));
+
+	/*
+	 * the block alignment has changed.  drop the history and resync on
+	 * the next buffer
+	 */
+
+	if(element->adapter)
+		gst_audioadapter_clear(element->adapter);
+	element->t0 = GST_CLOCK_TIME_NONE;
+}
+
+
+/*
+ * build the workspace for the current filters, format and request pads.
+ * call with filter_lock held.  returns FALSE if the configuration can't be
+ * tiled.
+ */
+
+
+static gboolean create_workspace(GSTLALBurst_Tiler *element)
+{
+	guint top_level = 0;
+	guint cadence, cadence0;
+	guint block_length, block_stride, samples;
+	gint top_rate;
+	guint level, j;
+	GSList *l;
+
+	/*
+	 * which levels are wanted, and how much history does each need
+	 */
+
+	for(l = element->srcpads; l; l = l->next) {
+		struct gstlal_burst_tiler_pad *data = gst_pad_get_element_private(GST_PAD(l->data));
+		top_level = MAX(top_level, data->level);
+	}
+	if(level_channels(element, top_level) < 1) {
+		GST_ERROR_OBJECT(element, "resolution level %u needs at least %u base channels, have %u", top_level, 1 << top_level, fir_channels(element));
+		return FALSE;
+	}
+	if(!level_rate(element, 0, &top_rate) || !level_rate(element, top_level, &top_rate) || element->rate % top_rate) {
+		GST_ERROR_OBJECT(element, "input rate %d is not a multiple of the sample rate of resolution level %u (2 x %g Hz x 2^%u)", element->rate, top_level, element->base_band, top_level);
+		return FALSE;
+	}
+	for(l = element->srcpads; l; l = l->next) {
+		struct gstlal_burst_tiler_pad *data = gst_pad_get_element_private(GST_PAD(l->data));
+		if(data->level >= element->mu_sq_levels || element->mu_sq_length[data->level] != (gint) level_channels(element, data->level)) {
+			GST_ERROR_OBJECT(element, "channel-norms does not provide %u normalizations for resolution level %u", level_channels(element, data->level), data->level);
+			return FALSE;
+		}
+	}
+	cadence = element->rate / top_rate;
+	cadence0 = cadence << top_level;
+
+	/*
+	 * block geometry.  every block must yield a whole number of
+	 * samples at every level, and the FFT length must be a multiple of
+	 * twice the folding factor so the folded transform has an even
+	 * length
+	 */
+
+	if(element->block_stride > 0) {
+		block_stride = (element->block_stride + cadence0 - 1) / cadence0 * cadence0;
+		block_length = block_stride + fir_length(element) - 1;
+	} else {
+		block_length = 1;
+		while(block_length < 4 * (fir_length(element) - 1) || block_length < fir_length(element) - 1 + cadence0)
+			block_length <<= 1;
+		block_stride = 0;
+	}
+	block_length = (block_length + 2 * cadence - 1) / (2 * cadence) * (2 * cadence);
+	if(!block_stride)
+		block_stride = (block_length - fir_length(element) + 1) / cadence0 * cadence0;
+	g_assert_cmpuint(block_stride, >, 0);
+	g_assert_cmpuint(block_stride + fir_length(element) - 1, <=, block_length);
+
+	element->workspace.top_level = top_level;
+	element->workspace.cadence = cadence;
+	element->workspace.block_length = block_length;
+	element->workspace.block_stride = block_stride;
+	element->workspace.block_length_fd = block_length / 2 + 1;
+	element->workspace.folded_length = block_length / cadence;
+	samples = block_stride / cadence;
+
+	GST_INFO_OBJECT(element, "%u channels, %u levels, block length %u, stride %u, folded length %u", fir_channels(element), top_level + 1, block_length, block_stride, element->workspace.folded_length);
+
+	/*
+	 * FFT workspace
+	 */
+
+	gstlal_fftw_lock();
+	GST_LOG_OBJECT(element, "starting FFTW planning");
+	element->workspace.input = (complex double *) fftw_malloc(element->workspace.block_length_fd * sizeof(*element->workspace.input));
+	element->workspace.in_plan = fftw_plan_dft_r2c_1d(block_length, (double *) element->workspace.input, element->workspace.input, FFTW_MEASURE);
+	element->workspace.folded = (complex double *) fftw_malloc((element->workspace.folded_length / 2 + 1) * sizeof(*element->workspace.folded));
+	element->workspace.out_plan = fftw_plan_dft_c2r_1d(element->workspace.folded_length, element->workspace.folded, (double *) element->workspace.folded, FFTW_MEASURE);
+	GST_LOG_OBJECT(element, "FFTW planning complete");
+	element->workspace.working_fir_matrix = (complex double *) fftw_malloc(fir_channels(element) * element->workspace.block_length_fd * sizeof(*element->workspace.working_fir_matrix));
+	gstlal_fftw_unlock();
+
+	transform_filters(element);
+
+	/*
+	 * decimating the output by the cadence is the same as folding its
+	 * spectrum to folded_length bins.  bin j of the half-complex input
+	 * spectrum lands in bin j mod folded_length, its negative-frequency
+	 * image in bin -j mod folded_length.  record where each goes among
+	 * the folded_length / 2 + 1 bins the inverse transform reads, or -1
+	 * if it lands in the redundant half.
+	 */
+
+	element->workspace.fold_index = g_new(gint, 2 * element->workspace.block_length_fd);
+	for(j = 0; j < element->workspace.block_length_fd; j++) {
+		guint m = element->workspace.folded_length;
+		guint m1 = j % m;
+		guint m2 = (m - m1) % m;
+		element->workspace.fold_index[2 * j] = m1 <= m / 2 ? (gint) m1 : -1;
+		element->workspace.fold_index[2 * j + 1] = (j && j < block_length / 2 && m2 <= m / 2) ? (gint) m2 : -1;
+	}
+
+	/*
+	 * channel sum pyramid and per level energy buffers
+	 */
+
+	element->workspace.pyramid = g_new0(double *, top_level + 1);
+	element->workspace.level = g_new0(struct gstlal_burst_tiler_level, top_level + 1);
+	for(level = 0; level <= top_level; level++) {
+		struct gstlal_burst_tiler_level *lev = &element->workspace.level[level];
+		guint level_samples;
+		element->workspace.pyramid[level] = g_new0(double, level_channels(element, level) * samples);
+		lev->channels = level_channels(element, level);
+		lev->cadence = cadence << (top_level - level);
+		level_samples = block_stride / lev->cadence;
+		for(l = element->srcpads; l; l = l->next) {
+			struct gstlal_burst_tiler_pad *data = gst_pad_get_element_private(GST_PAD(l->data));
+			if(data->level != level)
+				continue;
+			lev->requested = TRUE;
+			lev->history = MAX(lev->history, data->dof - 1);
+		}
+		if(lev->requested) {
+			lev->energy = g_new0(double, (lev->history + level_samples) * lev->channels);
+			lev->prefix = g_new0(double, (lev->history + level_samples + 1) * lev->channels);
+		}
+	}
+
+	/*
+	 * tell downstream
+	 */
+
+	for(l = element->srcpads; l; l = l->next) {
+		GstPad *pad = GST_PAD(l->data);
+		struct gstlal_burst_tiler_pad *data = gst_pad_get_element_private(pad);
+		gint rate;
+		GstCaps *caps;
+		level_rate(element, data->level, &rate);
+		caps = gst_caps_new_simple(
+			"audio/x-raw-float",
+			"rate", G_TYPE_INT, rate,
+			"channels", G_TYPE_INT, (gint) level_channels(element, data->level),
+			"endianness", G_TYPE_INT, G_BYTE_ORDER,
+			"width", G_TYPE_INT, 64,
+			NULL
+		);
+		if(!gst_pad_set_caps(pad, caps))
+			GST_WARNING_OBJECT(pad, "unable to set caps %" GST_PTR_FORMAT, caps);
+		gst_caps_unref(caps);
+		data->need_discont = TRUE;
+	}
+
+	return TRUE;
+}
+
+
+/*
+ * ============================================================================
+ *
+ *                                 Filtering
+ *
+ * ============================================================================
+ */
+
+
+/*
+ * project one FFT block of input onto the base channels, and leave the
+ * valid samples, at the rate of the top level, in the bottom of the
+ * pyramid.
+ */
+
+
+static void channelize(GSTLALBurst_Tiler *element)
+{
+	guint folded_length_fd = element->workspace.folded_length / 2 + 1;
+	guint samples = element->workspace.block_stride / element->workspace.cadence;
+	const complex double *filter = element->workspace.working_fir_matrix;
+	double *output = element->workspace.pyramid[0];
+	guint i, j;
+
+	fftw_execute(element->workspace.in_plan);
+
+	for(i = 0; i < fir_channels(element); i++, output += samples) {
+		const complex double *input = element->workspace.input;
+		complex double *folded = element->workspace.folded;
+		const gint *fold_index = element->workspace.fold_index;
+
+		memset(folded, 0, folded_length_fd * sizeof(*folded));
+		for(j = 0; j < element->workspace.block_length_fd; j++, fold_index += 2) {
+			complex double z = *(input++) * *(filter++);
+			if(fold_index[0] >= 0)
+				folded[fold_index[0]] += z;
+			if(fold_index[1] >= 0)
+				folded[fold_index[1]] += conj(z);
+		}
+		fftw_execute(element->workspace.out_plan);
+		memcpy(output, folded, samples * sizeof(*output));
+	}
+}
+
+
+/*
+ * sum pairs of wide channels of each level into the wide channels of the
+ * next
+ */
+
+
+static void build_pyramid(GSTLALBurst_Tiler *element)
+{
+	guint samples = element->workspace.block_stride / element->workspace.cadence;
+	guint m = channel_sets(element);
+	guint level, r, k;
+
+	for(level = 1; level <= element->workspace.top_level; level++) {
+		for(r = 0; r < level_channels(element, level); r++) {
+			double *out = element->workspace.pyramid[level] + r * samples;
+			const double *a, *b;
+			if(!wide_channel_is_valid(element, level, r)) {
+				memset(out, 0, samples * sizeof(*out));
+				continue;
+			}
+			a = element->workspace.pyramid[level - 1] + (2 * (r / m) * m + r % m) * samples;
+			b = a + m * samples;
+			for(k = 0; k < samples; k++)
+				out[k] = a[k] + b[k];
+		}
+	}
+}
+
+
+/*
+ * normalize, square and undersample one level's wide channels for the
+ * current block, and update the running sum along time
+ */
+
+
+static void compute_energy(GSTLALBurst_Tiler *element, guint level, gboolean gap)
+{
+	struct gstlal_burst_tiler_level *lev = &element->workspace.level[level];
+	guint top_samples = element->workspace.block_stride / element->workspace.cadence;
+	guint samples = element->workspace.block_stride / lev->cadence;
+	guint step = lev->cadence / element->workspace.cadence;
+	guint channels = lev->channels;
+	double *energy = lev->energy + lev->history * channels;
+	guint r, k, t;
+
+	if(gap) {
+		memset(energy, 0, samples * channels * sizeof(*energy));
+		lev->zero_run += samples;
+	} else {
+		for(r = 0; r < channels; r++) {
+			const double *p = element->workspace.pyramid[level] + r * top_samples;
+			double mu_sq = element->mu_sq[level][r];
+			if(mu_sq <= 0 || !wide_channel_is_valid(element, level, r)) {
+				for(k = 0; k < samples; k++)
+					energy[k * channels + r] = 0;
+				continue;
+			}
+			for(k = 0; k < samples; k++, p += step)
+				energy[k * channels + r] = *p * *p / mu_sq;
+		}
+		lev->zero_run = 0;
+	}
+
+	memset(lev->prefix, 0, channels * sizeof(*lev->prefix));
+	for(t = 0; t < lev->history + samples; t++)
+		for(r = 0; r < channels; r++)
+			lev->prefix[(t + 1) * channels + r] = lev->prefix[t * channels + r] + lev->energy[t * channels + r];
+}
+
+
+/*
+ * sums over dof consecutive energies, for the first samples of the
+ * current block
+ */
+
+
+static void write_tiles(const struct gstlal_burst_tiler_level *lev, guint dof, double *out, guint samples)
+{
+	const double *hi = lev->prefix + (lev->history + 1) * lev->channels;
+	const double *lo = hi - dof * lev->channels;
+	const double *end = out + samples * lev->channels;
+
+	while(out < end)
+		*(out++) = *(hi++) - *(lo++);
+}
+
+
+static void shift_history(GSTLALBurst_Tiler *element, guint level)
+{
+	struct gstlal_burst_tiler_level *lev = &element->workspace.level[level];
+	guint samples = element->workspace.block_stride / lev->cadence;
+
+	memmove(lev->energy, lev->energy + samples * lev->channels, lev->history * lev->channels * sizeof(*lev->energy));
+}
+
+
+/*
+ * ============================================================================
+ *
+ *                                 Streaming
+ *
+ * ============================================================================
+ */
+
+
+static void set_metadata(GSTLALBurst_Tiler *element, GstBuffer *buf, struct gstlal_burst_tiler_pad *data, guint64 offset, guint64 samples, gboolean gap)
+{
+	struct gstlal_burst_tiler_level *lev = &element->workspace.level[data->level];
+
+	GST_BUFFER_OFFSET(buf) = offset;
+	GST_BUFFER_OFFSET_END(buf) = offset + samples;
+	GST_BUFFER_TIMESTAMP(buf) = element->t0 + gst_util_uint64_scale_int_round(GST_BUFFER_OFFSET(buf) * lev->cadence - element->offset0, GST_SECOND, element->rate);
+	GST_BUFFER_DURATION(buf) = element->t0 + gst_util_uint64_scale_int_round(GST_BUFFER_OFFSET_END(buf) * lev->cadence - element->offset0, GST_SECOND, element->rate) - GST_BUFFER_TIMESTAMP(buf);
+	if(G_UNLIKELY(data->need_discont)) {
+		GST_BUFFER_FLAG_SET(buf, GST_BUFFER_FLAG_DISCONT);
+		data->need_discont = FALSE;
+	}
+	if(gap)
+		GST_BUFFER_FLAG_SET(buf, GST_BUFFER_FLAG_GAP);
+	else
+		GST_BUFFER_FLAG_UNSET(buf, GST_BUFFER_FLAG_GAP);
+}
+
+
+/*
+ * process as many whole blocks as the adapter holds, producing at most
+ * limit samples of input-rate output.  one buffer is pushed on every
+ * linked source pad.  call with filter_lock held.
+ */
+
+
+static GstFlowReturn process(GSTLALBurst_Tiler *element, guint64 limit)
+{
+	guint block_length = element->workspace.block_length;
+	guint block_stride = element->workspace.block_stride;
+	guint top_level = element->workspace.top_level;
+	guint64 available = get_available_samples(element);
+	guint64 nblocks, block, positions;
+	guint npads = g_slist_length(element->srcpads);
+	GstBuffer **buf;
+	guint64 *zero_run;
+	gboolean all_gap = TRUE;
+	GstFlowReturn result = GST_FLOW_OK;
+	guint level, i;
+	GSList *l;
+
+	nblocks = available >= block_length ? (available - block_length) / block_stride + 1 : 0;
+	if(limit != G_MAXUINT64)
+		nblocks = MIN(nblocks, (limit + block_stride - 1) / block_stride);
+	positions = MIN(nblocks * block_stride, limit);
+	if(!nblocks || !npads)
+		return GST_FLOW_OK;
+
+	buf = g_new0(GstBuffer *, npads);
+	zero_run = g_new0(guint64, top_level + 1);
+	for(level = 0; level <= top_level; level++)
+		zero_run[level] = element->workspace.level[level].zero_run;
+
+	/*
+	 * one output buffer per pad, filled in block by block
+	 */
+
+	for(l = element->srcpads, i = 0; l; l = l->next, i++) {
+		GstPad *pad = GST_PAD(l->data);
+		struct gstlal_burst_tiler_pad *data = gst_pad_get_element_private(pad);
+		struct gstlal_burst_tiler_level *lev = &element->workspace.level[data->level];
+		result = gst_pad_alloc_buffer(pad, lev->next_out_offset, positions / lev->cadence * lev->channels * sizeof(double), GST_PAD_CAPS(pad), &buf[i]);
+		if(result == GST_FLOW_NOT_LINKED) {
+			buf[i] = NULL;
+			result = GST_FLOW_OK;
+		} else if(result != GST_FLOW_OK) {
+			GST_ERROR_OBJECT(pad, "failure allocating output buffer: %s", gst_flow_get_name(result));
+			goto done;
+		}
+	}
+
+	for(block = 0; block < nblocks; block++) {
+		gboolean gap = gst_audioadapter_head_gap_length(element->adapter) >= block_length;
+		guint64 block_positions = MIN(block_stride, positions - block * block_stride);
+
+		if(!gap) {
+			gst_audioadapter_copy_samples(element->adapter, element->workspace.input, block_length, NULL, NULL);
+			channelize(element);
+			build_pyramid(element);
+		}
+		all_gap &= gap;
+
+		for(level = 0; level <= top_level; level++)
+			if(element->workspace.level[level].requested)
+				compute_energy(element, level, gap);
+
+		for(l = element->srcpads, i = 0; l; l = l->next, i++) {
+			struct gstlal_burst_tiler_pad *data = gst_pad_get_element_private(GST_PAD(l->data));
+			struct gstlal_burst_tiler_level *lev = &element->workspace.level[data->level];
+			if(buf[i])
+				write_tiles(lev, data->dof, (double *) GST_BUFFER_DATA(buf[i]) + block * (block_stride / lev->cadence) * lev->channels, block_positions / lev->cadence);
+		}
+
+		for(level = 0; level <= top_level; level++)
+			if(element->workspace.level[level].requested)
+				shift_history(element, level);
+
+		gst_audioadapter_flush_samples(element->adapter, block_stride);
+	}
+
+	/*
+	 * push.  an output buffer is a gap if no input was seen in it nor
+	 * in the dof - 1 samples before it
+	 */
+
+	for(l = element->srcpads, i = 0; l; l = l->next, i++) {
+		GstPad *pad = GST_PAD(l->data);
+		struct gstlal_burst_tiler_pad *data = gst_pad_get_element_private(pad);
+		struct gstlal_burst_tiler_level *lev = &element->workspace.level[data->level];
+		GstFlowReturn pad_result;
+		if(!buf[i])
+			continue;
+		set_metadata(element, buf[i], data, lev->next_out_offset, positions / lev->cadence, all_gap && zero_run[data->level] >= data->dof - 1);
+		pad_result = gst_pad_push(pad, buf[i]);
+		buf[i] = NULL;
+		if(pad_result != GST_FLOW_OK && pad_result != GST_FLOW_NOT_LINKED && result == GST_FLOW_OK)
+			result = pad_result;
+	}
+	for(level = 0; level <= top_level; level++)
+		element->workspace.level[level].next_out_offset += positions / element->workspace.level[level].cadence;
+
+done:
+	for(i = 0; i < npads; i++)
+		if(buf[i])
+			gst_buffer_unref(buf[i]);
+	g_free(buf);
+	g_free(zero_run);
+	return result;
+}
+
+
+/*
+ * process what is left in the adapter, e.g. at EOS or before a
+ * discontinuity.  call with filter_lock held
+ */
+
+
+static GstFlowReturn flush_history(GSTLALBurst_Tiler *element)
+{
+	guint64 available, positions, nblocks;
+	guint cadence0;
+	GstFlowReturn result = GST_FLOW_OK;
+
+	if(!element->workspace.level || !element->adapter)
+		goto done;
+
+	available = get_available_samples(element);
+	if(available < fir_length(element))
+		goto done;
+	cadence0 = element->workspace.level[0].cadence;
+	positions = (available - fir_length(element) + 1) / cadence0 * cadence0;
+	if(!positions)
+		goto done;
+
+	/*
+	 * pad with zeros to a whole number of blocks
+	 */
+
+	nblocks = (positions + element->workspace.block_stride - 1) / element->workspace.block_stride;
+	if(push_gap(element, (nblocks - 1) * element->workspace.block_stride + element->workspace.block_length - available) < 0) {
+		result = GST_FLOW_ERROR;
+		goto done;
+	}
+
+	result = process(element, positions);
+
+done:
+	if(element->adapter)
+		gst_audioadapter_clear(element->adapter);
+	return result;
+}
+
+
+/*
+ * (re)start the timestamp book-keeping at the given buffer.  the first
+ * output sample must be one lal_audioundersample would keep at every
+ * level, so input is skipped until the channel output lands on a
+ * multiple of the level 0 cadence
+ */
+
+
+static void resync(GSTLALBurst_Tiler *element, GstBuffer *buf)
+{
+	guint cadence0 = element->workspace.level[0].cadence;
+	guint64 first_offset;
+	GSList *l;
+
+	element->t0 = GST_BUFFER_TIMESTAMP(buf);
+	element->offset0 = GST_BUFFER_OFFSET(buf);
+	first_offset = element->offset0 + fir_length(element) - 1 - fir_latency(element);
+	element->skip = (cadence0 - first_offset % cadence0) % cadence0;
+	reset_levels(element, first_offset + element->skip);
+
+	for(l = element->srcpads; l; l = l->next) {
+		struct gstlal_burst_tiler_pad *data = gst_pad_get_element_private(GST_PAD(l->data));
+		data->need_discont = TRUE;
+	}
+}
+
+
+/*
+ * ============================================================================
+ *
+ *                                  Sink Pad
+ *
+ * ============================================================================
+ */
+
+
+static gboolean setcaps(GstPad *pad, GstCaps *caps)
+{
+	GSTLALBurst_Tiler *element = GSTLAL_BURST_TILER(gst_pad_get_parent(pad));
+	GstStructure *structure;
+	gint rate;
+	gboolean success = TRUE;
+
+	structure = gst_caps_get_structure(caps, 0);
+	if(!gst_structure_get_int(structure, "rate", &rate))
+		success = FALSE;
+
+	if(success) {
+		g_mutex_lock(element->filter_lock);
+		if(rate != element->rate) {
+			free_workspace(element);
+			element->rate = rate;
+		}
+		g_mutex_unlock(element->filter_lock);
+	} else
+		GST_ERROR_OBJECT(element, "unable to parse and/or accept caps %" GST_PTR_FORMAT, caps);
+
+	gst_object_unref(element);
+	return success;
+}
+
+
+static gboolean sink_event(GstPad *pad, GstEvent *event)
+{
+	GSTLALBurst_Tiler *element = GSTLAL_BURST_TILER(GST_PAD_PARENT(pad));
+
+	switch(GST_EVENT_TYPE(event)) {
+	case GST_EVENT_EOS:
+		g_mutex_lock(element->filter_lock);
+		if(flush_history(element) != GST_FLOW_OK)
+			GST_WARNING_OBJECT(element, "unable to process internal history, some data at end of stream has been discarded");
+		g_mutex_unlock(element->filter_lock);
+		break;
+
+	default:
+		break;
+	}
+
+	return gst_pad_event_default(pad, event);
+}
+
+
+static GstFlowReturn chain(GstPad *pad, GstBuffer *sinkbuf)
+{
+	GSTLALBurst_Tiler *element = GSTLAL_BURST_TILER(gst_pad_get_parent(pad));
+	GstFlowReturn result = GST_FLOW_OK;
+
+	if(!GST_BUFFER_TIMESTAMP_IS_VALID(sinkbuf) || !GST_BUFFER_DURATION_IS_VALID(sinkbuf) || !GST_BUFFER_OFFSET_IS_VALID(sinkbuf) || !GST_BUFFER_OFFSET_END_IS_VALID(sinkbuf)) {
+		gst_buffer_unref(sinkbuf);
+		GST_ERROR_OBJECT(element, "error in input stream: buffer has invalid timestamp and/or offset");
+		result = GST_FLOW_ERROR;
+		goto done;
+	}
+
+	/*
+	 * wait for filters
+	 */
+
+	g_mutex_lock(element->filter_lock);
+	while(G_UNLIKELY(!element->fir_matrix || !element->mu_sq)) {
+		GST_DEBUG_OBJECT(element, "filters not available, waiting ...");
+		g_cond_wait(element->filter_available, element->filter_lock);
+		if(GST_STATE(GST_ELEMENT(element)) == GST_STATE_NULL) {
+			GST_DEBUG_OBJECT(element, "element now in null state, abandoning wait for filters");
+			gst_buffer_unref(sinkbuf);
+			result = GST_FLOW_WRONG_STATE;
+			goto unlock;
+		}
+	}
+
+	if(G_UNLIKELY(!element->srcpads)) {
+		gst_buffer_unref(sinkbuf);
+		goto unlock;
+	}
+
+	if(G_UNLIKELY(!element->workspace.level) && !create_workspace(element)) {
+		GST_ELEMENT_ERROR(element, STREAM, FAILED, ("unable to tile time-frequency plane"), ("invalid combination of filters, normalizations, base band and requested resolutions"));
+		gst_buffer_unref(sinkbuf);
+		result = GST_FLOW_ERROR;
+		goto unlock;
+	}
+
+	/*
+	 * check for discontinuity
+	 */
+
+	if(G_UNLIKELY(GST_BUFFER_IS_DISCONT(sinkbuf) || GST_BUFFER_OFFSET(sinkbuf) != element->next_in_offset || !GST_CLOCK_TIME_IS_VALID(element->t0))) {
+		flush_history(element);
+		resync(element, sinkbuf);
+	}
+	element->next_in_offset = GST_BUFFER_OFFSET_END(sinkbuf);
+
+	/*
+	 * put the incoming buffer into the adapter, drop whatever comes
+	 * before the first aligned block, and process whole blocks
+	 */
+
+	gst_audioadapter_push(element->adapter, sinkbuf);
+	if(element->skip) {
+		guint n = MIN(element->skip, get_available_samples(element));
+		gst_audioadapter_flush_samples(element->adapter, n);
+		element->skip -= n;
+	}
+
+	result = process(element, G_MAXUINT64);
+
+unlock:
+	g_mutex_unlock(element->filter_lock);
+done:
+	gst_object_unref(element);
+	return result;
+}
+
+
+/*
+ * ============================================================================
+ *
+ *                                Request Pads
+ *
+ * ============================================================================
+ */
+
+
+static GstPad *request_new_pad(GstElement *element, GstPadTemplate *templ, const gchar *name)
+{
+	GSTLALBurst_Tiler *tiler = GSTLAL_BURST_TILER(element);
+	struct gstlal_burst_tiler_pad *data;
+	guint level, dof;
+	GstPad *pad;
+
+	if(!name || sscanf(name, "level_%u_dof_%u", &level, &dof) != 2 || !dof || level >= 32) {
+		GST_ERROR_OBJECT(element, "invalid pad name \"%s\":  must be level_<level>_dof_<dof> with dof >= 1", name ? name : "(null)");
+		return NULL;
+	}
+
+	pad = gst_pad_new_from_template(templ, name);
+	gst_pad_use_fixed_caps(pad);
+	data = g_new0(struct gstlal_burst_tiler_pad, 1);
+	data->level = level;
+	data->dof = dof;
+	data->need_discont = TRUE;
+	gst_pad_set_element_private(pad, data);
+
+	g_mutex_lock(tiler->filter_lock);
+	tiler->srcpads = g_slist_append(tiler->srcpads, pad);
+	free_workspace(tiler);
+	g_mutex_unlock(tiler->filter_lock);
+
+	gst_element_add_pad(element, pad);
+	return pad;
+}
+
+
+static void release_pad(GstElement *element, GstPad *pad)
+{
+	GSTLALBurst_Tiler *tiler = GSTLAL_BURST_TILER(element);
+
+	g_mutex_lock(tiler->filter_lock);
+	tiler->srcpads = g_slist_remove(tiler->srcpads, pad);
+	free_workspace(tiler);
+	g_mutex_unlock(tiler->filter_lock);
+
+	g_free(gst_pad_get_element_private(pad));
+	gst_pad_set_element_private(pad, NULL);
+	gst_element_remove_pad(element, pad);
+}
+
+
+/*
+ * ============================================================================
+ *
+ *                                 Properties
+ *
+ * ============================================================================
+ */
+
+
+enum property {
+	ARG_FIR_MATRIX = 1,
+	ARG_CHANNEL_NORMS,
+	ARG_BASE_BAND,
+	ARG_FREQUENCY_OVERLAP,
+	ARG_BLOCK_STRIDE
+};
+
+
+static void free_mu_sq(GSTLALBurst_Tiler *element)
+{
+	guint i;
+
+	for(i = 0; i < element->mu_sq_levels; i++)
+		g_free(element->mu_sq[i]);
+	g_free(element->mu_sq);
+	element->mu_sq = NULL;
+	g_free(element->mu_sq_length);
+	element->mu_sq_length = NULL;
+	element->mu_sq_levels = 0;
+}
+
+
+static void set_property(GObject *object, enum property id, const GValue *value, GParamSpec *pspec)
+{
+	GSTLALBurst_Tiler *element = GSTLAL_BURST_TILER(object);
+
+	GST_OBJECT_LOCK(element);
+
+	switch(id) {
+	case ARG_FIR_MATRIX: {
+		gsl_matrix *fir_matrix = gstlal_gsl_matrix_from_g_value_array(g_value_get_boxed(value));
+		g_assert(fir_matrix != NULL);
+		g_mutex_lock(element->filter_lock);
+		if(element->workspace.level && fir_matrix->size1 == element->fir_matrix->size1 && fir_matrix->size2 == element->fir_matrix->size2) {
+			/*
+			 * same shape:  swap the filters in place, the
+			 * output streams carry on uninterrupted
+			 */
+
+			gsl_matrix_free(element->fir_matrix);
+			element->fir_matrix = fir_matrix;
+			transform_filters(element);
+		} else {
+			free_workspace(element);
+			if(element->fir_matrix)
+				gsl_matrix_free(element->fir_matrix);
+			element->fir_matrix = fir_matrix;
+		}
+		g_cond_broadcast(element->filter_available);
+		g_mutex_unlock(element->filter_lock);
+		break;
+	}
+
+	case ARG_CHANNEL_NORMS: {
+		GValueArray *va = g_value_get_boxed(value);
+		guint i;
+		g_mutex_lock(element->filter_lock);
+		free_mu_sq(element);
+		element->mu_sq_levels = va->n_values;
+		element->mu_sq = g_new0(double *, va->n_values);
+		element->mu_sq_length = g_new0(gint, va->n_values);
+		for(i = 0; i < va->n_values; i++)
+			element->mu_sq[i] = gstlal_doubles_from_g_value_array(g_value_get_boxed(g_value_array_get_nth(va, i)), NULL, &element->mu_sq_length[i]);
+		/*
+		 * the workspace reads the normalizations directly, so
+		 * they take effect with the next block.  if they no
+		 * longer fit, force the configuration to be checked again
+		 */
+		if(element->workspace.level) {
+			guint level;
+			for(level = 0; level <= element->workspace.top_level; level++)
+				if(element->workspace.level[level].requested && (level >= element->mu_sq_levels || element->mu_sq_length[level] != (gint) element->workspace.level[level].channels)) {
+					free_workspace(element);
+					break;
+				}
+		}
+		g_cond_broadcast(element->filter_available);
+		g_mutex_unlock(element->filter_lock);
+		break;
+	}
+
+	case ARG_BASE_BAND:
+		g_mutex_lock(element->filter_lock);
+		element->base_band = g_value_get_double(value);
+		free_workspace(element);
+		g_mutex_unlock(element->filter_lock);
+		break;
+
+	case ARG_FREQUENCY_OVERLAP:
+		g_mutex_lock(element->filter_lock);
+		element->frequency_overlap = g_value_get_double(value);
+		free_workspace(element);
+		g_mutex_unlock(element->filter_lock);
+		break;
+
+	case ARG_BLOCK_STRIDE:
+		g_mutex_lock(element->filter_lock);
+		element->block_stride = g_value_get_int(value);
+		free_workspace(element);
+		g_mutex_unlock(element->filter_lock);
+		break;
+
+	default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, id, pspec);
+		break;
+	}
+
+	GST_OBJECT_UNLOCK(element);
+}
+
+
+static void get_property(GObject *object, enum property id, GValue *value, GParamSpec *pspec)
+{
+	GSTLALBurst_Tiler *element = GSTLAL_BURST_TILER(object);
+
+	GST_OBJECT_LOCK(element);
+
+	switch(id) {
+	case ARG_FIR_MATRIX:
+		g_mutex_lock(element->filter_lock);
+		if(element->fir_matrix)
+			g_value_take_boxed(value, gstlal_g_value_array_from_gsl_matrix(element->fir_matrix));
+		g_mutex_unlock(element->filter_lock);
+		break;
+
+	case ARG_CHANNEL_NORMS: {
+		GValueArray *va;
+		guint i;
+		g_mutex_lock(element->filter_lock);
+		va = g_value_array_new(element->mu_sq_levels);
+		for(i = 0; i < element->mu_sq_levels; i++) {
+			GValue v = {0,};
+			g_value_init(&v, G_TYPE_VALUE_ARRAY);
+			g_value_take_boxed(&v, gstlal_g_value_array_from_doubles(element->mu_sq[i], element->mu_sq_length[i]));
+			g_value_array_append(va, &v);
+			g_value_unset(&v);
+		}
+		g_mutex_unlock(element->filter_lock);
+		g_value_take_boxed(value, va);
+		break;
+	}
+
+	case ARG_BASE_BAND:
+		g_value_set_double(value, element->base_band);
+		break;
+
+	case ARG_FREQUENCY_OVERLAP:
+		g_value_set_double(value, element->frequency_overlap);
+		break;
+
+	case ARG_BLOCK_STRIDE:
+		g_value_set_int(value, element->block_stride);
+		break;
+
+	default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, id, pspec);
+		break;
+	}
+
+	GST_OBJECT_UNLOCK(element);
+}
+
+
+/*
+ * ============================================================================
+ *
+ *                                Type Support
+ *
+ * ============================================================================
+ */
+
+
+/*
+ * Parent class.
+ */
+
+
+static GstElementClass *parent_class = NULL;
+
+
+/*
+ * Instance dispose function.  Wake up any threads waiting for the
+ * filters;  since we are being disposed of the element state should be
+ * NULL causing them to bail out.
+ */
+
+
+static void dispose(GObject *object)
+{
+	GSTLALBurst_Tiler *element = GSTLAL_BURST_TILER(object);
+
+	g_mutex_lock(element->filter_lock);
+	g_cond_broadcast(element->filter_available);
+	g_mutex_unlock(element->filter_lock);
+
+	G_OBJECT_CLASS(parent_class)->dispose(object);
+}
+
+
+/*
+ * Instance finalize function.
+ */
+
+
+static void finalize(GObject *object)
+{
+	GSTLALBurst_Tiler *element = GSTLAL_BURST_TILER(object);
+
+	free_workspace(element);
+	g_slist_free(element->srcpads);
+	element->srcpads = NULL;
+	gst_object_unref(element->sinkpad);
+	element->sinkpad = NULL;
+	g_object_unref(element->adapter);
+	element->adapter = NULL;
+	if(element->fir_matrix) {
+		gsl_matrix_free(element->fir_matrix);
+		element->fir_matrix = NULL;
+	}
+	free_mu_sq(element);
+	g_mutex_free(element->filter_lock);
+	element->filter_lock = NULL;
+	g_cond_free(element->filter_available);
+	element->filter_available = NULL;
+
+	G_OBJECT_CLASS(parent_class)->finalize(object);
+}
+
+
+/*
+ * Base init function.  See
+ *
+ * http://developer.gnome.org/doc/API/2.0/gobject/gobject-Type-Information.html#GBaseInitFunc
+ */
+
+
+#define SINK_CAPS \
+	"audio/x-raw-float, " \
+	"rate = (int) [1, MAX], " \
+	"channels = (int) 1, " \
+	"endianness = (int) BYTE_ORDER, " \
+	"width = (int) 64"
+
+
+#define SRC_CAPS \
+	"audio/x-raw-float, " \
+	"rate = (int) [1, MAX], " \
+	"channels = (int) [1, MAX], " \
+	"endianness = (int) BYTE_ORDER, " \
+	"width = (int) 64"
+
+
+static void base_init(gpointer class)
+{
+	GstElementClass *element_class = GST_ELEMENT_CLASS(class);
+
+	gst_element_class_set_details_simple(
+		element_class,
+		"Burst_Tiler",
+		"Filter/Audio",
+		"Compute excess power tile energies at many time-frequency resolutions from one channelization of the whitened data",
+		"The gstlal authors"
+	);
+
+	gst_element_class_add_pad_template(
+		element_class,
+		gst_pad_template_new(
+			"sink",
+			GST_PAD_SINK,
+			GST_PAD_ALWAYS,
+			gst_caps_from_string(SINK_CAPS)
+		)
+	);
+	gst_element_class_add_pad_template(
+		element_class,
+		gst_pad_template_new(
+			"level_%s",
+			GST_PAD_SRC,
+			GST_PAD_REQUEST,
+			gst_caps_from_string(SRC_CAPS)
+		)
+	);
+}
+
+
+/*
+ * Class init function.  See
+ *
+ * http://developer.gnome.org/doc/API/2.0/gobject/gobject-Type-Information.html#GClassInitFunc
+ */
+
+
+static void class_init(gpointer class, gpointer class_data)
+{
+	GObjectClass *gobject_class = G_OBJECT_CLASS(class);
+	GstElementClass *element_class = GST_ELEMENT_CLASS(class);
+
+	parent_class = g_type_class_ref(GST_TYPE_ELEMENT);
+
+	gobject_class->set_property = GST_DEBUG_FUNCPTR(set_property);
+	gobject_class->get_property = GST_DEBUG_FUNCPTR(get_property);
+	gobject_class->dispose = GST_DEBUG_FUNCPTR(dispose);
+	gobject_class->finalize = GST_DEBUG_FUNCPTR(finalize);
+
+	element_class->request_new_pad = GST_DEBUG_FUNCPTR(request_new_pad);
+	element_class->release_pad = GST_DEBUG_FUNCPTR(release_pad);
+
+	g_object_class_install_property(
+		gobject_class,
+		ARG_FIR_MATRIX,
+		g_param_spec_value_array(
+			"fir-matrix",
+			"FIR Matrix",
+			"Array of base band channel impulse response vectors, as for lal_firbank.  All filters must have the same length.  Replacing the filters by ones of the same shape takes effect at the next block without interrupting the output.",
+			g_param_spec_value_array(
+				"response",
+				"Impulse Response",
+				"Array of amplitudes.",
+				g_param_spec_double(
+					"amplitude",
+					"Amplitude",
+					"Impulse response sample",
+					-G_MAXDOUBLE, G_MAXDOUBLE, 0.0,
+					G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+				),
+				G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+			),
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+		)
+	);
+	g_object_class_install_property(
+		gobject_class,
+		ARG_CHANNEL_NORMS,
+		g_param_spec_value_array(
+			"channel-norms",
+			"Channel normalizations",
+			"Array of one vector per resolution level, starting from level 0, giving mu^2 for each wide channel of that level.  Wide channel energies are divided by mu^2;  wide channels with mu^2 <= 0 are 0.",
+			g_param_spec_value_array(
+				"level-norms",
+				"Level normalizations",
+				"mu^2 for each wide channel of one resolution level.",
+				g_param_spec_double(
+					"mu-sq",
+					"mu^2",
+					"Wide channel normalization",
+					-G_MAXDOUBLE, G_MAXDOUBLE, 0.0,
+					G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+				),
+				G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+			),
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+		)
+	);
+	g_object_class_install_property(
+		gobject_class,
+		ARG_BASE_BAND,
+		g_param_spec_double(
+			"base-band",
+			"Base band",
+			"Bandwidth of the base channels in Hz.  Resolution level l is sampled at 2 * base-band * 2^l Hz, which must divide the input rate.",
+			0, G_MAXDOUBLE, DEFAULT_BASE_BAND,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | G_PARAM_CONSTRUCT
+		)
+	);
+	g_object_class_install_property(
+		gobject_class,
+		ARG_FREQUENCY_OVERLAP,
+		g_param_spec_double(
+			"frequency-overlap",
+			"Frequency overlap",
+			"Fraction by which adjacent base channels overlap.  Wide channels combine every 1 / (1 - frequency-overlap)-th base channel.",
+			0, 0.99, DEFAULT_FREQUENCY_OVERLAP,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | G_PARAM_CONSTRUCT
+		)
+	);
+	g_object_class_install_property(
+		gobject_class,
+		ARG_BLOCK_STRIDE,
+		g_param_spec_int(
+			"block-stride",
+			"Convolution block stride",
+			"Number of input samples consumed by each FFT block, rounded up to a multiple of the level 0 undersampling cadence.  0 chooses an FFT length of at least four filter lengths.",
+			0, G_MAXINT, DEFAULT_BLOCK_STRIDE,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | G_PARAM_CONSTRUCT
+		)
+	);
+}
+
+
+/*
+ * Instance init function.  See
+ *
+ * http://developer.gnome.org/doc/API/2.0/gobject/gobject-Type-Information.html#GInstanceInitFunc
+ */
+
+
+static void instance_init(GTypeInstance *object, gpointer class)
+{
+	GSTLALBurst_Tiler *element = GSTLAL_BURST_TILER(object);
+	GstPad *pad;
+
+	gst_element_create_all_pads(GST_ELEMENT(element));
+
+	/* configure (and ref) sink pad */
+	pad = gst_element_get_static_pad(GST_ELEMENT(element), "sink");
+	gst_pad_set_setcaps_function(pad, GST_DEBUG_FUNCPTR(setcaps));
+	gst_pad_set_chain_function(pad, GST_DEBUG_FUNCPTR(chain));
+	gst_pad_set_event_function(pad, GST_DEBUG_FUNCPTR(sink_event));
+	element->sinkpad = pad;
+
+	/* internal data */
+	element->srcpads = NULL;
+	element->adapter = g_object_new(GST_TYPE_AUDIOADAPTER, "unit-size", (guint) sizeof(double), NULL);
+	element->rate = 0;
+	element->filter_lock = g_mutex_new();
+	element->filter_available = g_cond_new();
+	element->fir_matrix = NULL;
+	element->mu_sq = NULL;
+	element->mu_sq_length = NULL;
+	element->mu_sq_levels = 0;
+	memset(&element->workspace, 0, sizeof(element->workspace));
+	element->t0 = GST_CLOCK_TIME_NONE;
+	element->offset0 = GST_BUFFER_OFFSET_NONE;
+	element->next_in_offset = GST_BUFFER_OFFSET_NONE;
+	element->skip = 0;
+}
+
+
+/*
+ * gstlal_burst_tiler_get_type().
+ */
+
+
+GType gstlal_burst_tiler_get_type(void)
+{
+	static GType type = 0;
+
+	if(!type) {
+		static const GTypeInfo info = {
+			.class_size = sizeof(GSTLALBurst_TilerClass),
+			.class_init = class_init,
+			.base_init = base_init,
+			.instance_size = sizeof(GSTLALBurst_Tiler),
+			.instance_init = instance_init,
+		};
+		type = g_type_register_static(GST_TYPE_ELEMENT, "GSTLALBurst_Tiler", &info, 0);
+	}
+
+	return type;
+}
@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2026  The gstlal authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __GSTLAL_BURST_TILER_H__
+#define __GSTLAL_BURST_TILER_H__
+
+
+#include <complex.h>
+#include <glib.h>
+#include <gst/gst.h>
+#include <gstlal/gstaudioadapter.h>
+#include <fftw3.h>
+#include <gsl/gsl_matrix.h>
+
+G_BEGIN_DECLS
+
+
+#define GSTLAL_BURST_TILER_TYPE \
+	(gstlal_burst_tiler_get_type())
+#define GSTLAL_BURST_TILER(obj) \
+	(G_TYPE_CHECK_INSTANCE_CAST((obj), GSTLAL_BURST_TILER_TYPE, GSTLALBurst_Tiler))
+#define GSTLAL_BURST_TILER_CLASS(klass) \
+	(G_TYPE_CHECK_CLASS_CAST((klass), GSTLAL_BURST_TILER_TYPE, GSTLALBurst_TilerClass))
+#define GST_IS_GSTLAL_BURST_TILER(obj) \
+	(G_TYPE_CHECK_INSTANCE_TYPE((obj), GSTLAL_BURST_TILER_TYPE))
+#define GST_IS_GSTLAL_BURST_TILER_CLASS(klass) \
+	(G_TYPE_CHECK_CLASS_TYPE((klass), GSTLAL_BURST_TILER_TYPE))
+
+
+typedef struct {
+	GstElementClass parent_class;
+} GSTLALBurst_TilerClass;
+
+
+/*
+ * one request pad:  the tile energies of a resolution level summed over a
+ * number of degrees of freedom
+ */
+
+
+struct gstlal_burst_tiler_pad {
+	guint level;
+	guint dof;
+	gboolean need_discont;
+};
+
+
+/*
+ * per resolution level state.  energy holds the normalized squared wide
+ * channel samples of one block preceded by the last history samples of
+ * the previous block, prefix holds their running sum along time.
+ */
+
+
+struct gstlal_burst_tiler_level {
+	gboolean requested;
+	guint channels;
+	guint cadence;
+	guint history;
+	guint64 next_out_offset;
+	guint64 zero_run;
+	double *energy;
+	double *prefix;
+};
+
+
+typedef struct {
+	GstElement element;
+
+	GstPad *sinkpad;
+	GSList *srcpads;
+	GstAudioAdapter *adapter;
+
+	gint rate;
+	gdouble base_band;
+	gdouble frequency_overlap;
+	gint block_stride;
+
+	/*
+	 * filters and normalizations, protected by filter_lock
+	 */
+
+	GMutex *filter_lock;
+	GCond *filter_available;
+	gsl_matrix *fir_matrix;
+	double **mu_sq;
+	gint *mu_sq_length;
+	guint mu_sq_levels;
+
+	/*
+	 * workspace, built on the first block after the format, the
+	 * filter length, the channel count or the requested pads change
+	 */
+
+	struct {
+		guint top_level;
+		guint cadence;
+		guint block_length;
+		guint block_stride;
+		guint block_length_fd;
+		guint folded_length;
+		complex double *input;
+		fftw_plan in_plan;
+		complex double *folded;
+		fftw_plan out_plan;
+		complex double *working_fir_matrix;
+		gint *fold_index;
+		double **pyramid;
+		struct gstlal_burst_tiler_level *level;
+	} workspace;
+
+	/*
+	 * timestamp book-keeping
+	 */
+
+	GstClockTime t0;
+	guint64 offset0;
+	guint64 next_in_offset;
+	guint skip;
+} GSTLALBurst_Tiler;
+
+
+GType gstlal_burst_tiler_get_type(void);
+
+
+G_END_DECLS
+
+
+#endif	/* __GSTLAL_BURST_TILER_H__ */
@@ -52,6 +52,8 @@
 #include <gstlal_snglburst.h>
 
 #define DEFAULT_SNR_THRESH 5.5
+/* initial trigger arena size in rows, it grows as needed */
+#define DEFAULT_ARENA_CAPACITY 1024
 
 static guint64 output_num_samps(GSTLALBurst_Triggergen *element)
 {
@@ -398,7 +400,6 @@ static GstFlowReturn push_buffer(GSTLALBurst_Triggergen *element, GstBuffer *src
 	GST_DEBUG_OBJECT(element, "pushing %" GST_BUFFER_BOUNDARIES_FORMAT, GST_BUFFER_BOUNDARIES_ARGS(srcbuf));
 	GstFlowReturn result = gst_pad_push(element->srcpad, srcbuf);
 	element->total_offset = 0;
-	element->event_buffer = NULL;
 	return result;
 }
 
@@ -415,7 +416,7 @@ static GstFlowReturn push_gap(GSTLALBurst_Triggergen *element, guint samps)
 	/* potentially push the result */
 	GstClockTime total_duration = (GstClockTime) gst_util_uint64_scale_int_round(GST_SECOND, element->total_offset, element->rate);
 	if (total_duration >= 1e10 || element->EOS || element->n == 0) {
-		srcbuf = gstlal_snglburst_new_buffer_from_list(element->event_buffer, element->srcpad, element->next_output_offset, element->total_offset, element->next_output_timestamp, element->rate, &(element->count));
+		srcbuf = gstlal_snglburst_new_buffer_from_arena(element->events, element->srcpad, element->next_output_offset, element->total_offset, element->next_output_timestamp, element->rate, &(element->count));
 
 		if (srcbuf == NULL) { 
 			return GST_FLOW_ERROR;
@@ -433,6 +434,7 @@ static GstFlowReturn push_nongap(GSTLALBurst_Triggergen *element, guint copysamp
 	gint copied_gap, copied_nongap;
 	double complex *dataptr = NULL;
 	double *dataptrd = NULL;
+	const void *samples = NULL;
 
 	/* advance the offset */
 	GstClockTime total_duration = (GstClockTime) gst_util_uint64_scale_int_round(GST_SECOND, element->total_offset, element->rate);
@@ -448,7 +450,7 @@ static GstFlowReturn push_nongap(GSTLALBurst_Triggergen *element, guint copysamp
 			gstlal_double_complex_peak_over_window(element->maxdata, (const double complex*) dataptr, outsamps);
 			/* Either update the current buffer or create the new output buffer */
 			if (element->maxdata->num_events != 0) {
-				element->event_buffer = gstlal_snglburst_new_list_from_peak(element->maxdata, element->bankarray, element->next_output_timestamp + total_duration, element->rate, element->event_buffer);
+				gstlal_snglburst_arena_append_peak(element->events, element->maxdata, element->bankarray, element->next_output_timestamp + total_duration, element->rate);
 			}
 			break;
 		case GSTLAL_BURSTTRIGGEN_DOUBLE:
@@ -460,28 +462,24 @@ static GstFlowReturn push_nongap(GSTLALBurst_Triggergen *element, guint copysamp
 			gstlal_double_peak_over_window(element->maxdatad, (const double*) dataptrd, outsamps);
 			/* Either update the current buffer or create the new output buffer */
 			if (element->maxdatad->num_events != 0) {
-				element->event_buffer = gstlal_snglburst_new_list_from_double_peak(element->maxdatad, element->bankarray, element->next_output_timestamp + total_duration, element->rate, element->event_buffer);
+				gstlal_snglburst_arena_append_double_peak(element->events, element->maxdatad, element->bankarray, element->next_output_timestamp + total_duration, element->rate);
 		    }
 			break;
 		case GSTLAL_BURSTTRIGGEN_COMPLEX_DOUBLE_NO_PEAK:
-			/* Either update the current buffer or create the new output buffer */
-            dataptr = malloc(sizeof(complex double)*copysamps*element->channels);
-			gst_audioadapter_copy_samples(element->adapter, dataptrd, copysamps, &copied_gap, &copied_nongap);
-            element->event_buffer = gstlal_snglburst_new_list_from_complex_double_buffer(dataptr, element->bankarray, element->next_output_timestamp, element->channels, copysamps, element->rate, element->snr_thresh, element->event_buffer);
-            free(dataptrd);
+			/* threshold the samples in place, they are only copied if they span buffers */
+			samples = gst_audioadapter_peek_samples(element->adapter, copysamps, &copied_gap, &copied_nongap);
+			gstlal_snglburst_arena_append_complex_double_buffer(element->events, (const complex double *) samples, element->bankarray, element->next_output_timestamp, element->channels, copysamps, element->rate, element->snr_thresh);
 			break;
 		case GSTLAL_BURSTTRIGGEN_DOUBLE_NO_PEAK:
-			/* Either update the current buffer or create the new output buffer */
-            dataptrd = malloc(sizeof(double)*copysamps*element->channels);
-			gst_audioadapter_copy_samples(element->adapter, dataptrd, copysamps, &copied_gap, &copied_nongap);
-            element->event_buffer = gstlal_snglburst_new_list_from_double_buffer(dataptrd, element->bankarray, element->next_output_timestamp, element->channels, copysamps, element->rate, element->snr_thresh, element->event_buffer);
-            free(dataptrd);
+			/* threshold the samples in place, they are only copied if they span buffers */
+			samples = gst_audioadapter_peek_samples(element->adapter, copysamps, &copied_gap, &copied_nongap);
+			gstlal_snglburst_arena_append_double_buffer(element->events, (const double *) samples, element->bankarray, element->next_output_timestamp, element->channels, copysamps, element->rate, element->snr_thresh);
 			break;
 	}
 
 	/* potentially push the result */
 	if (total_duration >= 1e10 || element->EOS || element->n == 0) {
-		srcbuf = gstlal_snglburst_new_buffer_from_list(element->event_buffer, element->srcpad, element->next_output_offset, element->total_offset, element->next_output_timestamp, element->rate, &(element->count));
+		srcbuf = gstlal_snglburst_new_buffer_from_arena(element->events, element->srcpad, element->next_output_offset, element->total_offset, element->next_output_timestamp, element->rate, &(element->count));
 
 		if (srcbuf == NULL) { 
 			return GST_FLOW_ERROR;
@@ -684,6 +682,12 @@ static void finalize(GObject *object)
 	gst_object_unref(element->srcpad);
 	element->srcpad = NULL;
 	g_object_unref(element->adapter);
+	gstlal_snglburst_arena_free(element->events);
+	element->events = NULL;
+	free(element->data);
+	element->data = NULL;
+	free(element->datad);
+	element->datad = NULL;
 	if (element->bankarray)
 		free_bank(element);
 	G_OBJECT_CLASS(parent_class)->finalize(object);
@@ -856,8 +860,9 @@ static void instance_init(GTypeInstance *object, gpointer class)
 	element->channel_name = NULL;
 	element->bankarray = NULL;
 	element->bank_filename = NULL;
-	element->event_buffer = NULL;
+	element->events = gstlal_snglburst_arena_new(DEFAULT_ARENA_CAPACITY);
 	element->data = NULL;
+	element->datad = NULL;
 	element->maxdata = NULL;
 	element->bank_lock = g_mutex_new();
 	element->last_gap = TRUE;
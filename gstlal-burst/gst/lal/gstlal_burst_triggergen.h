@@ -37,6 +37,7 @@
 #include <gstlal/gstaudioadapter.h>
 #include <lal/LIGOMetadataTables.h>
 #include <gsl/gsl_matrix.h>
+#include <gstlal_snglburst.h>
 
 G_BEGIN_DECLS
 
@@ -66,7 +67,7 @@ typedef struct {
 	GstPad *srcpad;
 	GstAudioAdapter *adapter;
 	
-	SnglBurst *event_buffer;
+	struct gstlal_snglburst_arena *events;
 
 	gint rate;
 	guint n;
@@ -51,6 +51,7 @@
 
 #include <gstlal/gstlal_tags.h>
 #include <gstlal_burst_triggergen.h>
+#include <gstlal_burst_tiler.h>
 
 
 /*
@@ -69,6 +70,7 @@ static gboolean plugin_init(GstPlugin *plugin)
 		GType type;
 	} *element, elements[] = {
 		{"lal_bursttriggergen", GSTLAL_BURST_TRIGGERGEN_TYPE},
+		{"lal_bursttiler", GSTLAL_BURST_TILER_TYPE},
 		{NULL, 0},
 	};
 
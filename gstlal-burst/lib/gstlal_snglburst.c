@@ -71,171 +71,199 @@ int gstlal_set_instrument_in_snglburst_array(SnglBurst *bankarray, int length, c
 	return 0;
 }
 
-SnglBurst *gstlal_snglburst_new_list_from_peak(struct gstlal_peak_state *input, SnglBurst *bankarray, GstClockTime etime, guint rate, SnglBurst* output)
+/*
+ * trigger arena
+ */
+
+struct gstlal_snglburst_arena *gstlal_snglburst_arena_new(guint capacity)
+{
+	struct gstlal_snglburst_arena *arena = g_new0(struct gstlal_snglburst_arena, 1);
+	arena->initial_capacity = arena->capacity = capacity ? capacity : 1;
+	arena->rows = g_new(SnglBurst, arena->capacity);
+	arena->length = 0;
+	return arena;
+}
+
+void gstlal_snglburst_arena_free(struct gstlal_snglburst_arena *arena)
+{
+	if (!arena)
+		return;
+	g_free(arena->rows);
+	g_free(arena);
+}
+
+/* make room for n more rows, growing geometrically, and return the first */
+SnglBurst *gstlal_snglburst_arena_reserve(struct gstlal_snglburst_arena *arena, guint n)
+{
+	if (arena->length + n > arena->capacity) {
+		guint capacity = arena->capacity;
+		while (arena->length + n > capacity)
+			capacity *= 2;
+		arena->rows = g_renew(SnglBurst, arena->rows, capacity);
+		arena->capacity = capacity;
+	}
+	return arena->rows + arena->length;
+}
+
+guint gstlal_snglburst_arena_append_peak(struct gstlal_snglburst_arena *arena, struct gstlal_peak_state *input, SnglBurst *bankarray, GstClockTime etime, guint rate)
 {
-	/* advance the pointer if we have one */
 	guint channel;
 	double complex *maxdata = input->values.as_double_complex;
 	guint *maxsample = input->samples;
+	SnglBurst *event = gstlal_snglburst_arena_reserve(arena, input->channels);
+	guint n = 0;
 
-	/* FIXME do error checking */
 	for(channel = 0; channel < input->channels; channel++) {
 		if ( maxdata[channel] ) {
-			SnglBurst *new_event = XLALCreateSnglBurst();
-			memcpy(new_event, &(bankarray[channel]), sizeof(*new_event));
-			LIGOTimeGPS peak_time;
-			XLALINT8NSToGPS(&peak_time, etime);
-			XLALGPSAdd(&peak_time, -new_event->duration/2);
-			XLALGPSAdd(&peak_time, (double) maxsample[channel] / rate);
-			LIGOTimeGPS start_time = peak_time;
-			XLALGPSAdd(&start_time, -new_event->duration/2);
-			new_event->snr = cabs(maxdata[channel]);
-			new_event->start_time = start_time;
-			new_event->peak_time = peak_time;
-			new_event->next = output;
-			output = new_event;
+			*event = bankarray[channel];
+			XLALINT8NSToGPS(&event->peak_time, etime);
+			XLALGPSAdd(&event->peak_time, -event->duration/2);
+			XLALGPSAdd(&event->peak_time, (double) maxsample[channel] / rate);
+			event->start_time = event->peak_time;
+			XLALGPSAdd(&event->start_time, -event->duration/2);
+			event->snr = cabs(maxdata[channel]);
+			event->next = NULL;
+			event++;
+			n++;
 		}
 	}
 
-	return output;
+	arena->length += n;
+	return n;
 }
 
-SnglBurst *gstlal_snglburst_new_list_from_double_peak(struct gstlal_peak_state *input, SnglBurst *bankarray, GstClockTime etime, guint rate, SnglBurst* output)
+guint gstlal_snglburst_arena_append_double_peak(struct gstlal_snglburst_arena *arena, struct gstlal_peak_state *input, SnglBurst *bankarray, GstClockTime etime, guint rate)
 {
-	/* advance the pointer if we have one */
 	guint channel;
 	double *maxdata = input->values.as_double;
 	guint *maxsample = input->samples;
+	SnglBurst *event = gstlal_snglburst_arena_reserve(arena, input->channels);
+	guint n = 0;
 
-	/* FIXME do error checking */
 	for(channel = 0; channel < input->channels; channel++) {
 		if ( maxdata[channel] ) {
-			SnglBurst *new_event = XLALCreateSnglBurst();
-			memcpy(new_event, &(bankarray[channel]), sizeof(*new_event));
-			LIGOTimeGPS peak_time;
-			XLALINT8NSToGPS(&peak_time, etime);
-			XLALGPSAdd(&peak_time, (double) maxsample[channel] / rate);
-			XLALGPSAdd(&peak_time, -new_event->duration/2);
+			*event = bankarray[channel];
+			XLALINT8NSToGPS(&event->peak_time, etime);
+			XLALGPSAdd(&event->peak_time, (double) maxsample[channel] / rate);
+			XLALGPSAdd(&event->peak_time, -event->duration/2);
 			// Center the tile
-			XLALGPSAdd(&peak_time, 1.0/(2.0*rate));
-			LIGOTimeGPS start_time = peak_time;
-			XLALGPSAdd(&start_time, -new_event->duration/2);
-			new_event->snr = fabs(maxdata[channel]);
-			new_event->start_time = start_time;
-			new_event->peak_time = peak_time;
-			new_event->next = output;
-			output = new_event;
+			XLALGPSAdd(&event->peak_time, 1.0/(2.0*rate));
+			event->start_time = event->peak_time;
+			XLALGPSAdd(&event->start_time, -event->duration/2);
+			event->snr = fabs(maxdata[channel]);
+			event->next = NULL;
+			event++;
+			n++;
 		}
 	}
 
-	return output;
+	arena->length += n;
+	return n;
 }
 
-GstBuffer *gstlal_snglburst_new_buffer_from_list(SnglBurst *input, GstPad *pad, guint64 offset, guint64 length, GstClockTime etime, guint rate, guint64 *count)
+guint gstlal_snglburst_arena_append_double_buffer(struct gstlal_snglburst_arena *arena, const double *input, SnglBurst *bankarray, GstClockTime etime, guint channels, guint samples, guint rate, gdouble threshold)
 {
-	/* FIXME check errors */
-
-	/* size is length in samples times number of channels times number of bytes per sample */
-	gint size = XLALSnglBurstTableLength(input);
-	size *= sizeof(*input);
-	GstBuffer *srcbuf = NULL;
-	GstCaps *caps = GST_PAD_CAPS(pad);
-	GstFlowReturn result = gst_pad_alloc_buffer(pad, offset, size, caps, &srcbuf);
-	if (result != GST_FLOW_OK)
-		return srcbuf;
-
-	if (input) {
-		//FIXME: Process ID
-		(*count) = XLALSnglBurstAssignIDs(input, 0, *count);
-	}
+	guint channel, sample;
+	guint n = 0;
 
-	/* Copy the events into the buffer */
-	SnglBurst *output = (SnglBurst *) GST_BUFFER_DATA(srcbuf);
-    SnglBurst *head = input;
-	while (input) {
-		*output = *input;
-		/* Make the array look like a linked list */
-		output->next = input->next ? output+1 : NULL;
-		output++;
-		input = input->next;
+	for (channel = 0; channel < channels; channel++) {
+		for (sample = 0; sample < samples; sample++) {
+			if (input[channels*sample+channel] > threshold) {
+				SnglBurst *event = gstlal_snglburst_arena_reserve(arena, 1);
+				*event = bankarray[channel];
+				XLALINT8NSToGPS(&event->peak_time, etime);
+				XLALGPSAdd(&event->peak_time, (double) sample / rate);
+				XLALGPSAdd(&event->peak_time, -event->duration/2);
+				// Center the tile
+				XLALGPSAdd(&event->peak_time, 1.0/(2.0*rate));
+				event->start_time = event->peak_time;
+				XLALGPSAdd(&event->start_time, -event->duration/2);
+				event->snr = fabs(input[channels*sample+channel]);
+				event->next = NULL;
+				arena->length++;
+				n++;
+			}
+		}
 	}
-	/* Forget about this set of events, it's the buffer's now. */
-	XLALDestroySnglBurstTable(head);
-
-	if (size == 0)
-		GST_BUFFER_FLAG_SET(srcbuf, GST_BUFFER_FLAG_GAP);
-
-	/* set the offset */
-	GST_BUFFER_OFFSET(srcbuf) = offset;
-	GST_BUFFER_OFFSET_END(srcbuf) = offset + length;
-
-	/* set the time stamps */
-	GST_BUFFER_TIMESTAMP(srcbuf) = etime;
-	GST_BUFFER_DURATION(srcbuf) = (GstClockTime) gst_util_uint64_scale_int_round(GST_SECOND, length, rate);
 
-	return srcbuf;
+	return n;
 }
 
-SnglBurst *gstlal_snglburst_new_list_from_double_buffer(double *input, SnglBurst *bankarray, GstClockTime etime, guint channels, guint samples, guint rate, gdouble threshold, SnglBurst* output)
+guint gstlal_snglburst_arena_append_complex_double_buffer(struct gstlal_snglburst_arena *arena, const complex double *input, SnglBurst *bankarray, GstClockTime etime, guint channels, guint samples, guint rate, gdouble threshold)
 {
-	/* advance the pointer if we have one */
 	guint channel, sample;
+	guint n = 0;
+	/* the threshold applies to the squared magnitude */
+	double sqrt_threshold = sqrt(threshold);
 
-	/* FIXME do error checking */
 	for (channel = 0; channel < channels; channel++) {
-	    for (sample = 0; sample < samples; sample++) {
-		    if (input[channels*sample+channel] > threshold) {
-			    SnglBurst *new_event = XLALCreateSnglBurst();
-			    memcpy(new_event, &(bankarray[channel]), sizeof(*new_event));
-			    LIGOTimeGPS peak_time;
-			    XLALINT8NSToGPS(&peak_time, etime);
-			    XLALGPSAdd(&peak_time, (double) sample / rate);
-			    XLALGPSAdd(&peak_time, -new_event->duration/2);
-			    // Center the tile
-			    XLALGPSAdd(&peak_time, 1.0/(2.0*rate));
-			    LIGOTimeGPS start_time = peak_time;
-			    XLALGPSAdd(&start_time, -new_event->duration/2);
-			    new_event->snr = fabs(input[channels*sample+channel]);
-			    new_event->start_time = start_time;
-			    new_event->peak_time = peak_time;
-			    new_event->next = output;
-			    output = new_event;
-		    }
-        }
+		for (sample = 0; sample < samples; sample++) {
+			if (cabs(input[channels*sample+channel]) > sqrt_threshold) {
+				SnglBurst *event = gstlal_snglburst_arena_reserve(arena, 1);
+				*event = bankarray[channel];
+				XLALINT8NSToGPS(&event->peak_time, etime);
+				XLALGPSAdd(&event->peak_time, (double) sample / rate);
+				XLALGPSAdd(&event->peak_time, -event->duration/2);
+				// Center the tile
+				XLALGPSAdd(&event->peak_time, 1.0/(2.0*rate));
+				event->start_time = event->peak_time;
+				XLALGPSAdd(&event->start_time, -event->duration/2);
+				event->snr = cabs(input[channels*sample+channel]);
+				event->next = NULL;
+				arena->length++;
+				n++;
+			}
+		}
 	}
 
-	return output;
+	return n;
 }
 
-SnglBurst *gstlal_snglburst_new_list_from_complex_double_buffer(complex double *input, SnglBurst *bankarray, GstClockTime etime, guint channels, guint samples, guint rate, gdouble threshold, SnglBurst* output)
+/*
+ * hand the arena's rows to a buffer and empty the arena.  the block is
+ * trimmed to the rows written and becomes the buffer's malloc data, and the
+ * arena starts a new block the size of this flush or of its initial
+ * capacity, whichever is larger, so one unusually large flush does not set
+ * the size of every later one.  an empty arena keeps its block and
+ * produces a gap buffer.
+ */
+
+GstBuffer *gstlal_snglburst_new_buffer_from_arena(struct gstlal_snglburst_arena *arena, GstPad *pad, guint64 offset, guint64 length, GstClockTime etime, guint rate, guint64 *count)
 {
-	/* advance the pointer if we have one */
-	guint channel, sample;
+	GstBuffer *srcbuf = gst_buffer_new();
+	guint i;
 
-	/* FIXME do error checking */
-	for (channel = 0; channel < channels; channel++) {
-	    for (sample = 0; sample < samples; sample++) {
-	        /* FIXME Which are we thresholding on. the EP version uses the 
-             * squared value, so we make this consistent */
-		    if (cabs(input[channels*sample+channel]) > sqrt(threshold)) {
-			    SnglBurst *new_event = XLALCreateSnglBurst();
-			    memcpy(new_event, &(bankarray[channel]), sizeof(*new_event));
-			    LIGOTimeGPS peak_time;
-			    XLALINT8NSToGPS(&peak_time, etime);
-			    XLALGPSAdd(&peak_time, (double) sample / rate);
-			    XLALGPSAdd(&peak_time, -new_event->duration/2);
-			    // Center the tile
-			    XLALGPSAdd(&peak_time, 1.0/(2.0*rate));
-			    LIGOTimeGPS start_time = peak_time;
-			    XLALGPSAdd(&start_time, -new_event->duration/2);
-			    new_event->snr = cabs(input[channels*sample+channel]);
-			    new_event->start_time = start_time;
-			    new_event->peak_time = peak_time;
-			    new_event->next = output;
-			    output = new_event;
-		    }
-        }
-	}
+	if (!srcbuf)
+		return NULL;
+
+	if (arena->length) {
+		SnglBurst *rows = g_renew(SnglBurst, arena->rows, arena->length);
+
+		/* Make the array look like a linked list */
+		for (i = 0; i < arena->length - 1; i++)
+			rows[i].next = &rows[i + 1];
+		rows[arena->length - 1].next = NULL;
+		//FIXME: Process ID
+		(*count) = XLALSnglBurstAssignIDs(rows, 0, *count);
+
+		GST_BUFFER_MALLOCDATA(srcbuf) = GST_BUFFER_DATA(srcbuf) = (guint8 *) rows;
+		GST_BUFFER_SIZE(srcbuf) = arena->length * sizeof(*rows);
 
-	return output;
+		arena->capacity = MAX(arena->length, arena->initial_capacity);
+		arena->rows = g_new(SnglBurst, arena->capacity);
+		arena->length = 0;
+	} else
+		GST_BUFFER_FLAG_SET(srcbuf, GST_BUFFER_FLAG_GAP);
+
+	gst_buffer_set_caps(srcbuf, GST_PAD_CAPS(pad));
+
+	/* set the offset */
+	GST_BUFFER_OFFSET(srcbuf) = offset;
+	GST_BUFFER_OFFSET_END(srcbuf) = offset + length;
+
+	/* set the time stamps */
+	GST_BUFFER_TIMESTAMP(srcbuf) = etime;
+	GST_BUFFER_DURATION(srcbuf) = (GstClockTime) gst_util_uint64_scale_int_round(GST_SECOND, length, rate);
+
+	return srcbuf;
 }
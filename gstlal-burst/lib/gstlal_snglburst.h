@@ -22,13 +22,29 @@ int gstlal_set_instrument_in_snglburst_array(SnglBurst *bankarray, int length, c
 SnglBurst *gstlal_snglburst_new_buffer_from_peak(struct gstlal_peak_state *input, SnglBurst *bankarray, GstPad *pad, guint64 offset, guint64 length, GstClockTime etime, guint rate, guint64 *count);
 SnglBurst *gstlal_snglburst_new_double_buffer_from_peak(struct gstlal_peak_state *input, SnglBurst *bankarray, GstPad *pad, guint64 offset, guint64 length, GstClockTime etime, guint rate, guint64 *count);
 
-SnglBurst *gstlal_snglburst_new_list_from_peak(struct gstlal_peak_state *input, SnglBurst *bankarray, GstClockTime etime, guint rate, SnglBurst* output);
-SnglBurst *gstlal_snglburst_new_list_from_double_peak(struct gstlal_peak_state *input, SnglBurst *bankarray, GstClockTime etime, guint rate, SnglBurst* output);
-
-SnglBurst *gstlal_snglburst_new_list_from_double_buffer(double *input, SnglBurst *bankarray, GstClockTime etime, guint channels, guint samples, guint rate, gdouble threshold, SnglBurst* output);
-SnglBurst *gstlal_snglburst_new_list_from_complex_double_buffer(complex double *input, SnglBurst *bankarray, GstClockTime etime, guint channels, guint samples, guint rate, gdouble threshold, SnglBurst* output);
-
-GstBuffer *gstlal_snglburst_new_buffer_from_list(SnglBurst *input, GstPad *pad, guint64 offset, guint64 length, GstClockTime etime, guint rate, guint64 *count);
+/*
+ * contiguous, growable store of triggers.  rows are written in place in
+ * the layout of an application/x-lal-snglburst buffer, and the block is
+ * handed to the output buffer at each flush
+ */
+
+struct gstlal_snglburst_arena {
+	SnglBurst *rows;
+	guint length;
+	guint capacity;
+	guint initial_capacity;
+};
+
+struct gstlal_snglburst_arena *gstlal_snglburst_arena_new(guint capacity);
+void gstlal_snglburst_arena_free(struct gstlal_snglburst_arena *arena);
+SnglBurst *gstlal_snglburst_arena_reserve(struct gstlal_snglburst_arena *arena, guint n);
+
+guint gstlal_snglburst_arena_append_peak(struct gstlal_snglburst_arena *arena, struct gstlal_peak_state *input, SnglBurst *bankarray, GstClockTime etime, guint rate);
+guint gstlal_snglburst_arena_append_double_peak(struct gstlal_snglburst_arena *arena, struct gstlal_peak_state *input, SnglBurst *bankarray, GstClockTime etime, guint rate);
+guint gstlal_snglburst_arena_append_double_buffer(struct gstlal_snglburst_arena *arena, const double *input, SnglBurst *bankarray, GstClockTime etime, guint channels, guint samples, guint rate, gdouble threshold);
+guint gstlal_snglburst_arena_append_complex_double_buffer(struct gstlal_snglburst_arena *arena, const complex double *input, SnglBurst *bankarray, GstClockTime etime, guint channels, guint samples, guint rate, gdouble threshold);
+
+GstBuffer *gstlal_snglburst_new_buffer_from_arena(struct gstlal_snglburst_arena *arena, GstPad *pad, guint64 offset, guint64 length, GstClockTime etime, guint rate, guint64 *count);
 
 G_END_DECLS
 #endif	/* __GSTLAL_SNGLBURST_H__ */
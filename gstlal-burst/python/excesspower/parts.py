@@ -124,6 +124,7 @@ class EPHandler(Handler):
 		self.freq_filter_bank = None
 		# TODO: Maybe not necessary
 		self.firbank = None
+		self.tiler = None
 
 		# Defaults -- PSD settings
 		self.whitener = None
@@ -302,6 +303,29 @@ class EPHandler(Handler):
 		self.mmixers[res_level] = mm
 		self.rebuild_matrix_mixers(res_level)
 
+	def add_tiler(self, tiler):
+		"""
+		Set the tiling element which replaces the FIR bank, undersamplers and matrix mixers, and hand it the base band filters and the wide channel normalizations.
+		"""
+		tiler.set_property("fir-matrix", self.rebuild_filter())
+		self.tiler = tiler
+		self.rebuild_tiler_norms()
+
+	def rebuild_tiler_norms(self):
+		"""
+		Rebuild the wide channel normalizations of every resolution level and assign them to the tiling element.
+		"""
+		nlevels = int(numpy.ceil(numpy.log2(self.filter_bank.shape[0])))
+		for i in range(0, min(self.max_level, nlevels)):
+			self.chan_matrix[i] = filters.build_wide_filter_norm( 
+				corr = self.spec_corr, 
+				freq_filters = self.freq_filter_bank,
+				level = i,
+				frequency_overlap = self.frequency_overlap,
+				band = self.base_band
+			)
+		self.tiler.set_property("channel-norms", [self.chan_matrix[i] for i in range(0, min(self.max_level, nlevels))])
+
 	@staticmethod
 	def build_default_psd(rate, df, fhigh):
 		"""
@@ -427,6 +451,17 @@ class EPHandler(Handler):
 		"""
 		Top-level function to handle the asynchronous updating of FIR banks and matrix mixer elements.
 		"""
+		# The tiling element takes both the filters and the normalizations
+		# and swaps them in without interrupting its output
+		if self.tiler is not None:
+			if self.verbose:
+				print >>sys.stderr, "Rebuilding FIR bank and wide channel normalizations"
+			self.tiler.set_property("fir-matrix", self.rebuild_filter())
+			self.rebuild_tiler_norms()
+			if self.verbose:
+				print >>sys.stderr, "...done."
+			return
+
 		# Rebuild filter bank and hand it off to the FIR element
 		if self.verbose:
 			print >>sys.stderr, "Rebuilding FIR bank"
@@ -869,7 +904,7 @@ def on_spec_corr_change(elem, pspec, handler):
         handler.rebuild_everything()
 
 # FIXME: Make into bin
-def construct_excesspower_pipeline(pipeline, head, handler, scan_obj=None, drop_time=0, peak_fraction=None, disable_triggers=False, histogram_triggers=False, verbose=False):
+def construct_excesspower_pipeline(pipeline, head, handler, scan_obj=None, drop_time=0, peak_fraction=None, disable_triggers=False, histogram_triggers=False, native_tiling=False, verbose=False):
 
     # Scan piece: Save the raw time series
     if handler.trigger_segment:
@@ -905,6 +940,16 @@ def construct_excesspower_pipeline(pipeline, head, handler, scan_obj=None, drop_
     if verbose:
         head = pipeparts.mkprogressreport(pipeline, head, "whitened stream")
 
+    # The tiling element does the work of the FIR bank, undersamplers, matrix
+    # mixers and energy summation in one place, but it has no taps for the
+    # intermediate streams the scan needs, nor does it change units
+    if native_tiling and handler.trigger_segment:
+        print >>sys.stderr, "Native tiling does not provide the intermediate streams for a time-frequency scan, falling back to the element chain."
+    elif native_tiling and 2 * handler.base_band < 1:
+        print >>sys.stderr, "Native tiling requires an undersampling rate of at least 1 Hz, falling back to the element chain."
+    elif native_tiling:
+        return construct_tiled_excesspower_pipeline(pipeline, head, handler, peak_fraction, disable_triggers, verbose)
+
     # excess power channel firbank
     head = pipeparts.mkfirbank(pipeline, head, time_domain=False, block_stride=handler.rate)
 
@@ -1096,6 +1141,77 @@ def construct_excesspower_pipeline(pipeline, head, handler, scan_obj=None, drop_
 
     return handler
 
+def construct_tiled_excesspower_pipeline(pipeline, head, handler, peak_fraction=None, disable_triggers=False, verbose=False):
+    """
+    Build the analysis from the whitened stream onwards with the lal_bursttiler element. The same tiles are searched as by construct_excesspower_pipeline, with one trigger generator for each resolution level and DOF.
+    """
+    head = pipeparts.mkbursttiler(pipeline, head, base_band=handler.base_band, frequency_overlap=handler.frequency_overlap, block_stride=handler.rate)
+    handler.add_tiler(head)
+    nchannels = handler.filter_bank.shape[0]
+    if verbose:
+        print "Tiler constructed with %d %f Hz channels" % (nchannels, handler.base_band)
+
+    def get_triggers_with_handler(elem):
+        return handler.get_triggers(elem)
+    appsync = pipeparts.AppSync(appsink_new_buffer = get_triggers_with_handler)
+
+    nlevels = int(numpy.ceil(numpy.log2(nchannels))) 
+    for res_level in range(0, min(handler.max_level, nlevels)):
+        undersamp_rate = 2 * handler.base_band * 2**res_level
+
+        max_samp = int(handler.max_duration*undersamp_rate)
+        if handler.max_dof is not None:
+            max_samp = handler.max_dof
+
+        if max_samp < 2 and res_level == handler.max_level:
+            sys.exit("The duration for the largest tile is smaller than a two degree of freedom tile. Try increasing the requested maximum tile duration or maximum DOF requirement.")
+        elif max_samp < 2:
+            print "Further resolution levels would result in tiles for which the maximum duration (%f) would not have enough DOF (2). Skipping this levels." % handler.max_duration
+            continue
+        print "Can sum up to %s degress of freedom in powers of two for this resolution level." % max_samp
+
+        ndof = 2
+        while ndof <= max_samp:
+            if handler.fix_dof is not None and ndof != handler.fix_dof:
+                ndof <<= 1
+                continue
+
+            if ndof/undersamp_rate > handler.max_duration:
+                break
+
+            if verbose:
+                print "Resolution level %d, DOFs: %d" % (res_level, ndof)
+
+            durtee = pipeparts.mkqueue(pipeline, handler.tiler.get_request_pad("level_%d_dof_%d" % (res_level, ndof)), max_size_time = 1*gst.SECOND)
+
+            if verbose:
+                durtee = pipeparts.mkprogressreport(pipeline, durtee, "After energy summation resolution level %d, %d DOF" % (res_level, ndof))
+
+            if disable_triggers:
+                pipeparts.mkfakesink(pipeline, durtee)
+                ndof = ndof << 1
+                continue
+
+            # FIXME: see construct_excesspower_pipeline
+            if handler.psd_mode == 1:
+                durtee = pipeparts.mknofakedisconts(pipeline, durtee)
+
+            snr_thresh = utils.determine_thresh_from_fap(handler.fap, ndof)**2
+            if verbose:
+                print "SNR threshold for level %d, ndof %d: %f" % (res_level, ndof, snr_thresh)
+            durtee = pipeparts.mkbursttriggergen(pipeline, durtee, n=int((peak_fraction or 0) * ndof), bank_filename=handler.build_filter_xml(res_level, ndof, verbose=verbose), snr_thresh=snr_thresh)
+
+            if verbose:
+                durtee = pipeparts.mkprogressreport(pipeline, durtee, "Trigger generator resolution level %d, %d DOF" % (res_level, ndof))
+
+            appsync.add_sink(pipeline, pipeparts.mkqueue(pipeline, durtee, max_size_buffers = 10))
+
+            ndof <<= 1
+            if ndof > max_samp:
+                break
+
+    return handler
+
 def stream_tfmap_video(pipeline, head, handler, filename=None, split_on=None, snr_max=None, history=4, framerate=5):
 	"""
 	Stream the time frequency channel map to a video source. If filename is None and split_on is None (the default), then the pipeline will attempt to stream to a desktop based (xvimagesink or equivalent) video sink. If filename is not None, but no splitting behavior is specified, video will be encoded and saved to the filename plus ".ogg" in Ogg Vorbis format. If split_on is specified to be 'keyframe', then the encoded video will be split between multiple files based on the keyframes being emitted by the ogg muxer. If no file name is specifed a default will be used, otherwise, an index and ".ogg" will be appended to the file name. Specifying amp_max will set the top of the colorscale for the amplitude SNR, the default is 10. History is the amount of time to retain in the video buffer (in seconds), the default is 4. The frame rate is the number of frames per second to output in the video stream.
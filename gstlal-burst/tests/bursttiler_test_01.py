@@ -0,0 +1,181 @@
+#!/usr/bin/env python
+# Copyright (C) 2026  The gstlal authors
+#
+# This program is free software; you can redistribute it and/or modify it
+# under the terms of the GNU General Public License as published by the
+# Free Software Foundation; either version 2 of the License, or (at your
+# option) any later version.
+#
+# This program is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+# Public License for more details.
+#
+# You should have received a copy of the GNU General Public License along
+# with this program; if not, write to the Free Software Foundation, Inc.,
+# 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#
+# =============================================================================
+#
+#                                   Preamble
+#
+# =============================================================================
+#
+
+
+import numpy
+import sys
+
+
+import pygtk
+pygtk.require("2.0")
+import gobject
+import pygst
+pygst.require("0.10")
+import gst
+
+
+from gstlal import pipeparts
+from gstlal import pipeio
+from gstlal import simplehandler
+
+
+gobject.threads_init()
+
+
+#
+# =============================================================================
+#
+#                                  Reference
+#
+# =============================================================================
+#
+
+
+#
+# the tiles computed directly from their definition:  the base channels
+# are the input filtered with lal_firbank's conventions (the kernel is
+# applied in reverse, with a latency of half the filter length), wide
+# channel r of level l is the sum of base channels r 2^l ... (r + 1) 2^l -
+# 1, it is kept at the samples lal_audioundersample would keep, normalized
+# by 1 / mu^2, squared, and summed over the dof most recent samples.  the
+# input is taken to be 0 outside of the data so every sample has a value;
+# the caller only compares samples whose support lies within the data.
+#
+
+
+def reference_tiles(x, fir_matrix, mu_sq, level, dof, cadence):
+	length = fir_matrix.shape[1]
+	latency = length // 2
+	# y[t] = sum_j h[j] x[t - (length - 1 - latency) + j]
+	base = numpy.array([numpy.convolve(x, h[::-1])[latency:latency + len(x)] for h in fir_matrix])
+	n = 1 << level
+	wide = base[:(base.shape[0] // n) * n].reshape(-1, n, base.shape[1]).sum(axis = 1)
+	energy = wide[:, ::cadence]**2 / mu_sq[:, numpy.newaxis]
+	tiles = numpy.cumsum(energy, axis = 1)
+	tiles[:, dof:] = tiles[:, dof:] - tiles[:, :-dof]
+	return tiles.T
+
+
+#
+# =============================================================================
+#
+#                                  Pipelines
+#
+# =============================================================================
+#
+
+
+#
+# push seeded noise through the tiler in several buffers and record every
+# output buffer of every requested tile shape
+#
+
+
+def bursttiler_test_01(name, x, rate, buffer_length, fir_matrix, mu_sq, base_band, block_stride, shapes):
+	pipeline = gst.Pipeline(name)
+	mainloop = gobject.MainLoop()
+
+	head = pipeparts.mkgeneric(pipeline, None, "appsrc", caps = pipeio.caps_from_array(x[:, numpy.newaxis], rate = rate))
+	buffers = [(x[offset:offset + buffer_length, numpy.newaxis], offset * gst.SECOND // rate, offset, rate) for offset in range(0, len(x), buffer_length)]
+	def need_data(elem, arg, buffers):
+		if buffers:
+			elem.emit("push-buffer", pipeio.audio_buffer_from_array(*buffers.pop(0)))
+		else:
+			elem.emit("end-of-stream")
+	head.connect("need-data", need_data, buffers)
+
+	tiler = pipeparts.mkbursttiler(pipeline, head, fir_matrix = fir_matrix, channel_norms = mu_sq, base_band = base_band, frequency_overlap = 0.0, block_stride = block_stride)
+
+	outputs = {}
+	def appsink_get_array(elem, (level, dof)):
+		buf = elem.get_last_buffer()
+		outputs.setdefault((level, dof), []).append((buf.offset, pipeio.array_from_audio_buffer(buf)))
+	for level, dof in shapes:
+		sink = pipeparts.mkappsink(pipeline, pipeparts.mkqueue(pipeline, tiler.get_request_pad("level_%d_dof_%d" % (level, dof))), max_buffers = 0)
+		sink.connect("new-buffer", appsink_get_array, (level, dof))
+
+	handler = simplehandler.Handler(mainloop, pipeline)
+	if pipeline.set_state(gst.STATE_PLAYING) == gst.STATE_CHANGE_FAILURE:
+		raise RuntimeError("pipeline failed to enter PLAYING state")
+	mainloop.run()
+
+	return outputs
+
+
+#
+# =============================================================================
+#
+#                                     Main
+#
+# =============================================================================
+#
+
+
+#
+# try changing these.  test should still work!
+#
+
+
+rate = 256	# Hz
+base_band = 4.0	# Hz, level l is sampled at 2 * base_band * 2^l Hz
+buffer_length = 100	# samples, not a multiple of any cadence
+block_stride = 200	# samples, rounded up by the element
+duration = 40	# seconds
+nchannels = 8
+fir_length = 33	# samples
+shapes = [(0, 1), (0, 2), (1, 4), (2, 2), (3, 8)]
+
+rng = numpy.random.RandomState(1)
+x = rng.normal(size = duration * rate)
+fir_matrix = rng.normal(size = (nchannels, fir_length))
+mu_sq = [rng.uniform(0.5, 2.0, size = nchannels >> level) for level in range(max(level for level, dof in shapes) + 1)]
+
+print >>sys.stderr, "=== Running Test bursttiler_test_01 ==="
+outputs = bursttiler_test_01("bursttiler_test_01", x, rate, buffer_length, fir_matrix, mu_sq, base_band, block_stride, shapes)
+
+for level, dof in shapes:
+	cadence = rate // int(2 * base_band * 2**level)
+	reference = reference_tiles(x, fir_matrix, mu_sq[level], level, dof, cadence)
+	assert (level, dof) in outputs, "no output for level %d, %d dof" % (level, dof)
+
+	# the output sample at offset k covers input samples down to
+	# (k - dof + 1) cadence - (length - 1 - latency) and up to k cadence
+	# + latency.  only those entirely within the data are compared.
+	latency = fir_length // 2
+	first = (fir_length - 1 - latency + cadence - 1) // cadence + dof - 1
+	last = (len(x) - 1 - latency) // cadence
+
+	expected_offset = None
+	compared = 0
+	for offset, data in outputs[(level, dof)]:
+		assert expected_offset is None or offset == expected_offset, "level %d, %d dof:  discontinuity at offset %d" % (level, dof, offset)
+		expected_offset = offset + len(data)
+		assert data.shape[1] == nchannels >> level, "level %d:  wrong channel count %d" % (level, data.shape[1])
+		for k, row in enumerate(data, offset):
+			if first <= k <= last:
+				scale = numpy.abs(reference[k]).max()
+				assert numpy.allclose(row, reference[k], rtol = 1e-9, atol = 1e-9 * scale), "level %d, %d dof:  tiles disagree at offset %d:  %s != %s" % (level, dof, k, row, reference[k])
+				compared += 1
+	assert compared >= (last - first) // 2, "level %d, %d dof:  only %d of %d samples compared" % (level, dof, compared, last - first + 1)
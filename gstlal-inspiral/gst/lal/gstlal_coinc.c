@@ -17,6 +17,7 @@
  */
 
 
+#include <string.h>
 #include <gst/gst.h>
 #include <gstlal_coinc.h>
 #include <lal/Date.h>
@@ -32,7 +33,9 @@ static GstElementClass *parent_class = NULL;
 
 
 enum gen_property {
-	ARG_DT = 1
+	ARG_DT = 1,
+	ARG_TIME_SLIDES,
+	ARG_SLIDE_STEP
 };
 
 
@@ -46,6 +49,14 @@ static void set_property(GObject *object, enum gen_property id, const GValue *va
 			element->dt = g_value_get_uint64(value);
 			break;
 
+		case ARG_TIME_SLIDES:
+			element->time_slides = g_value_get_uint(value);
+			break;
+
+		case ARG_SLIDE_STEP:
+			element->slide_step = g_value_get_uint64(value);
+			break;
+
 		default:
 			G_OBJECT_WARN_INVALID_PROPERTY_ID(object, id, pspec);
 			break;
@@ -64,6 +75,14 @@ static void get_property(GObject * object, enum gen_property id, GValue * value,
 			g_value_set_uint64(value, element->dt);
 			break;
 
+		case ARG_TIME_SLIDES:
+			g_value_set_uint(value, element->time_slides);
+			break;
+
+		case ARG_SLIDE_STEP:
+			g_value_set_uint64(value, element->slide_step);
+			break;
+
 		default:
 			G_OBJECT_WARN_INVALID_PROPERTY_ID(object, id, pspec);
 			break;
@@ -75,15 +94,99 @@ static void get_property(GObject * object, enum gen_property id, GValue * value,
 typedef struct {
 	GstCollectData gstcollectdata;
 	GstClockTime last_end_time;
+	guint ifo;
 } GstCoincCollectData;
 
 
+/*
+ * Time ordered ring of the triggers one detector has produced for one
+ * template and that are still needed by at least one time slide.  Triggers
+ * are numbered consecutively from the first one pushed;  base is the number
+ * of the trigger at head.  capacity is always a power of 2.
+ */
+
+
+typedef struct {
+	SnglInspiralTable* sngl;
+	GstClockTime* end_time;
+	guint capacity;
+	guint head;
+	guint length;
+	guint64 base;
+} CoincRing;
+
+
+static guint ring_index(const CoincRing* ring, guint64 seq)
+{
+	return (ring->head + (guint) (seq - ring->base)) & (ring->capacity - 1);
+}
+
+
+static void ring_push(CoincRing* ring, const SnglInspiralTable* sngl)
+{
+	guint i;
+
+	if (ring->length == ring->capacity)
+	{
+		guint capacity = ring->capacity ? 2 * ring->capacity : 4;
+		SnglInspiralTable* new_sngl = g_new(SnglInspiralTable, capacity);
+		GstClockTime* new_end_time = g_new(GstClockTime, capacity);
+		guint first = ring->capacity - ring->head;
+
+		/* unwrap into the new storage */
+		if (ring->length)
+		{
+			memcpy(new_sngl, ring->sngl + ring->head, first * sizeof(*new_sngl));
+			memcpy(new_sngl + first, ring->sngl, ring->head * sizeof(*new_sngl));
+			memcpy(new_end_time, ring->end_time + ring->head, first * sizeof(*new_end_time));
+			memcpy(new_end_time + first, ring->end_time, ring->head * sizeof(*new_end_time));
+		}
+		g_free(ring->sngl);
+		g_free(ring->end_time);
+		ring->sngl = new_sngl;
+		ring->end_time = new_end_time;
+		ring->capacity = capacity;
+		ring->head = 0;
+	}
+
+	i = ring_index(ring, ring->base + ring->length);
+	ring->sngl[i] = *sngl;
+	ring->sngl[i].next = NULL;
+	ring->end_time[i] = XLALGPSToINT8NS(&sngl->end_time);
+	ring->length++;
+}
+
+
+/* Forget all triggers before number seq. */
+static void ring_pop_to(CoincRing* ring, guint64 seq)
+{
+	guint n = seq - ring->base;
+
+	g_assert(n <= ring->length);
+	ring->head = (ring->head + n) & (ring->capacity - 1);
+	ring->length -= n;
+	ring->base = seq;
+}
+
+
+static void ring_free(CoincRing* ring)
+{
+	g_free(ring->sngl);
+	g_free(ring->end_time);
+	ring->sngl = NULL;
+	ring->end_time = NULL;
+}
+
+
 static void update_src_caps(GSTLALCoinc* coinc)
 {
 	GstCaps* caps = gst_caps_new_simple("application/x-lal-snglinspiral", "channels", G_TYPE_INT, GST_ELEMENT(coinc)->numsinkpads, NULL);
 	g_assert(caps);
 
 	gst_pad_set_caps(coinc->srcpad, caps);
+	if (coinc->bgpad)
+		gst_pad_set_caps(coinc->bgpad, caps);
+	gst_caps_unref(caps);
 }
 
 
@@ -91,6 +194,23 @@ static GstPad *request_new_pad(GstElement *element, GstPadTemplate *templ, const
 {
 	GSTLALCoinc* coinc = GSTLAL_COINC(element);
 
+	/* the time-slid coincidences */
+	if (GST_PAD_TEMPLATE_DIRECTION(templ) == GST_PAD_SRC)
+	{
+		if (coinc->bgpad)
+			return NULL;
+		coinc->bgpad = gst_pad_new_from_template(templ, "background");
+		gst_pad_use_fixed_caps(coinc->bgpad);
+		if (!gst_element_add_pad(element, coinc->bgpad))
+		{
+			gst_object_unref(coinc->bgpad);
+			coinc->bgpad = NULL;
+			return NULL;
+		}
+		update_src_caps(coinc);
+		return coinc->bgpad;
+	}
+
 	GstPad* pad = gst_pad_new_from_template(templ, g_strdup_printf("sink%d", coinc->padcounter++));
 	if (!gst_element_add_pad(element, pad)) goto bad_pad;
 
@@ -100,6 +220,7 @@ static GstPad *request_new_pad(GstElement *element, GstPadTemplate *templ, const
 	if (!data) goto bad_collect;
 
 	data->last_end_time = 0;
+	data->ifo = 0;
 	update_src_caps(coinc);
 	return pad;
 
@@ -116,6 +237,13 @@ static void release_pad(GstElement *element, GstPad *pad)
 {
 	GSTLALCoinc* coinc = GSTLAL_COINC(element);
 
+	if (pad == coinc->bgpad)
+	{
+		coinc->bgpad = NULL;
+		gst_element_remove_pad(element, pad);
+		return;
+	}
+
 	gst_collect_pads_remove_pad(coinc->collect, pad);
 	gst_element_remove_pad(element, pad);
 
@@ -123,6 +251,37 @@ static void release_pad(GstElement *element, GstPad *pad)
 }
 
 
+/* Forget all pending triggers and templates. */
+static void clear_triggers(GSTLALCoinc* coinc)
+{
+	guint i;
+
+	for (i = 0; i < coinc->rings->len; i++)
+		ring_free(&g_array_index(coinc->rings, CoincRing, i));
+	g_array_set_size(coinc->rings, 0);
+	g_array_set_size(coinc->cursors, 0);
+	g_hash_table_remove_all(coinc->template_index);
+	coinc->ntemplates = 0;
+}
+
+
+/* Number the sink pads and size the engine for the current pads and slides. */
+static void reset_triggers(GSTLALCoinc* coinc)
+{
+	GSList* slist;
+	guint ifo = 0;
+
+	clear_triggers(coinc);
+	for (slist = coinc->collect->data; slist; slist = g_slist_next(slist))
+		((GstCoincCollectData*) slist->data)->ifo = ifo++;
+	coinc->nifo = ifo;
+
+	GST_OBJECT_LOCK(coinc);
+	coinc->nslides = coinc->time_slides;
+	GST_OBJECT_UNLOCK(coinc);
+}
+
+
 static GstStateChangeReturn change_state(GstElement *element, GstStateChange transition)
 {
 	GSTLALCoinc *coinc = GSTLAL_COINC(element);
@@ -132,6 +291,7 @@ static GstStateChangeReturn change_state(GstElement *element, GstStateChange tra
 		break;
 
 	case GST_STATE_CHANGE_READY_TO_PAUSED:
+		reset_triggers(coinc);
 		gst_collect_pads_start(coinc->collect);
 		break;
 
@@ -152,44 +312,6 @@ static GstStateChangeReturn change_state(GstElement *element, GstStateChange tra
 }
 
 
-static gboolean sngl_inspiral_le(SnglInspiralTable* lhs, SnglInspiralTable* rhs)
-{
-	return XLALGPSCmp(&lhs->end_time, &rhs->end_time) <= 0;
-}
-
-
-/* Merge two sngl_inspiral tables into one list, and return the head. */
-static SnglInspiralTable* sngl_inspiral_merge(SnglInspiralTable* lhs, SnglInspiralTable* rhs)
-{
-	if (lhs == NULL) return rhs;
-	if (rhs == NULL) return lhs;
-
-	if (!sngl_inspiral_le(lhs, rhs))
-	{
-		void* tmp = lhs;
-		lhs = rhs;
-		rhs = tmp;
-	}
-	SnglInspiralTable* top = lhs;
-
-	do {
-		SnglInspiralTable* head;
-		do {
-			head = lhs;
-			lhs = lhs->next;
-		} while (lhs && sngl_inspiral_le(lhs, rhs));
-		head->next = rhs;
-
-		/* swap lhs and rhs */
-		void* tmp = lhs;
-		lhs = rhs;
-		rhs = tmp;
-	} while (rhs);
-
-	return top;
-}
-
-
 // Hash function for storing SnglInspiralTable pointers in a GHashTable
 static guint sngl_inspiral_hash(gconstpointer v)
 {
@@ -214,9 +336,20 @@ static gboolean sngl_inspiral_equal(gconstpointer v1, gconstpointer v2)
 }
 
 
-static gboolean sngl_inspiral_handle_empty(gpointer key, gpointer value, gpointer user_data)
+/* Dense id of the template that produced sngl, assigning the next free id
+ * and making room for its rings and cursors the first time it is seen. */
+static guint template_id(GSTLALCoinc* coinc, const SnglInspiralTable* sngl)
 {
-	return *((SnglInspiralTable**)value) == NULL;
+	guint id = GPOINTER_TO_UINT(g_hash_table_lookup(coinc->template_index, sngl));
+
+	if (id)
+		return id - 1;
+
+	id = coinc->ntemplates++;
+	g_hash_table_insert(coinc->template_index, g_memdup(sngl, sizeof(*sngl)), GUINT_TO_POINTER(id + 1));
+	g_array_set_size(coinc->rings, coinc->ntemplates * coinc->nifo);
+	g_array_set_size(coinc->cursors, coinc->ntemplates * (coinc->nslides + 1) * 2 * coinc->nifo);
+	return id;
 }
 
 
@@ -255,65 +388,219 @@ static void pop_coincs(GstCollectData *collectdata, GSTLALCoinc *coinc)
 	{
 		data->last_end_time = GST_BUFFER_TIMESTAMP(buf) + GST_BUFFER_DURATION(buf);
 
-		/* Collate sngl_inspiral records from that buffer according to template. */
-		GHashTable* hash = g_hash_table_new_full(sngl_inspiral_hash, sngl_inspiral_equal, NULL, g_free);
+		/* Append each sngl_inspiral record to its template's ring for this detector. */
 		const SnglInspiralTable* sngl = (const SnglInspiralTable*) GST_BUFFER_DATA(buf);
 		const SnglInspiralTable* const sngl_end = (const SnglInspiralTable* const) (GST_BUFFER_DATA(buf) + GST_BUFFER_SIZE(buf));
 
 		for (; sngl < sngl_end; sngl++)
 		{
-			SnglInspiralTable* sngl_copy = g_memdup(sngl, sizeof(*sngl));
-			sngl_copy->next = NULL;
-
-			SnglInspiralTable** val_handle = g_hash_table_lookup(hash, sngl_copy);
-			if (val_handle)
-			{
-				val_handle[1]->next = sngl_copy;
-				val_handle[1] = sngl_copy;
-			} else {
-				val_handle = g_malloc(sizeof(SnglInspiralTable*) * 2);
-				val_handle[0] = val_handle[1] = sngl_copy;
-				g_hash_table_insert(hash, (gpointer)sngl_copy, (gpointer)val_handle);
-			}
+			guint id = template_id(coinc, sngl);
+			ring_push(&g_array_index(coinc->rings, CoincRing, id * coinc->nifo + data->ifo), sngl);
 		}
 
 		/* Unref input buffer. */
 		gst_buffer_unref(buf);
+	}
+}
+
+
+/* Detector whose trigger at from[] is earliest once slid, or -1 if there are
+ * none before to[], or before the end of the rings if to is NULL. */
+static gint next_trigger(const GSTLALCoinc* coinc, const CoincRing* rings, const guint64* from, const guint64* to, guint slide, GstClockTime* end_time)
+{
+	gint earliest = -1;
+	guint ifo;
+
+	for (ifo = 0; ifo < coinc->nifo; ifo++)
+	{
+		const CoincRing* ring = &rings[ifo];
+		GstClockTime t;
 
-		/* Merge input records with currently buffered records. */
-		GHashTableIter iter;
-		SnglInspiralTable* key;
-		SnglInspiralTable** val_handle;
-		GHashTable* dest_hash = coinc->trigger_sequence_hash;
-		g_hash_table_iter_init(&iter, hash);
-		while (g_hash_table_iter_next(&iter, (gpointer*)&key, (gpointer*)&val_handle))
+		if (from[ifo] >= (to ? to[ifo] : ring->base + ring->length))
+			continue;
+		t = ring->end_time[ring_index(ring, from[ifo])] + (GstClockTime) slide * ifo * coinc->slide_step;
+		if (earliest < 0 || t < *end_time)
 		{
-			SnglInspiralTable** dest_sngl_handle = g_hash_table_lookup(dest_hash, key);
-			if (dest_sngl_handle)
+			earliest = ifo;
+			*end_time = t;
+		}
+	}
+
+	return earliest;
+}
+
+
+/* Append the running group [head, cur) to outarray in time order, without
+ * the last trigger from detector skip if skip is not -1. */
+static void append_group(const GSTLALCoinc* coinc, const CoincRing* rings, const guint64* head, const guint64* cur, gint skip, guint slide, GArray* outarray)
+{
+	guint64 from[coinc->nifo], to[coinc->nifo];
+	GstClockTime t;
+	gint ifo;
+
+	memcpy(from, head, sizeof(from));
+	memcpy(to, cur, sizeof(to));
+	if (skip >= 0)
+		to[skip]--;
+	while ((ifo = next_trigger(coinc, rings, from, to, slide, &t)) >= 0)
+	{
+		const CoincRing* ring = &rings[ifo];
+		g_array_append_vals(outarray, &ring->sngl[ring_index(ring, from[ifo]++)], 1);
+	}
+
+	/* resize output array to a multiple of numsinkpads */
+	g_array_size_to_next_multiple(outarray, coinc->nifo);
+}
+
+
+/*
+ * Group one template's triggers into coincidences for one time slide.
+ *
+ * In slide k, detector i's triggers are moved later by k * i * slide-step.
+ * The detectors' rings are merged in time order by advancing one cursor per
+ * detector, and the triggers from head[] up to cur[] form a running group,
+ * which is grouped exactly as the per-template trigger lists always were:
+ *
+ *  - when the next trigger is more than dt after the first in the group,
+ *    the group without it is a coincidence if it has two or more triggers,
+ *    and triggers more than dt before the new one are dropped from it;
+ *  - otherwise, when the group has as many triggers as there are detectors
+ *    it is a coincidence and is emptied;
+ *  - when every trigger before horizon has been taken and the last is more
+ *    than dt before horizon, the group is a coincidence if it has two or
+ *    more triggers and is emptied.
+ *
+ * Nothing stops a group holding two triggers from the same detector, and a
+ * trigger kept in the group after the first rule can be in two
+ * coincidences.  Triggers with equal slid end times are taken in sink pad
+ * order.
+ */
+
+
+static void sweep_template(GSTLALCoinc* coinc, guint id, guint slide, GstClockTime horizon, GArray* outarray)
+{
+	const guint nifo = coinc->nifo;
+	const CoincRing* rings = &g_array_index(coinc->rings, CoincRing, id * nifo);
+	guint64* head = &g_array_index(coinc->cursors, guint64, (id * (coinc->nslides + 1) + slide) * 2 * nifo);
+	guint64* cur = head + nifo;
+	guint ifo;
+
+	/* a slide that was not swept while the background pad was unlinked
+	 * carries on from the triggers that are still held */
+	for (ifo = 0; ifo < nifo; ifo++)
+	{
+		head[ifo] = MAX(head[ifo], rings[ifo].base);
+		cur[ifo] = MAX(cur[ifo], head[ifo]);
+	}
+
+	while (TRUE)
+	{
+		GstClockTime t, earliest, latest = 0;
+		gint next = next_trigger(coinc, rings, cur, NULL, slide, &t);
+		gboolean take = next >= 0 && t < horizon;
+		guint n = 0;
+
+		if (take)
+		{
+			cur[next]++;
+			for (ifo = 0; ifo < nifo; ifo++)
+				n += cur[ifo] - head[ifo];
+			next_trigger(coinc, rings, head, cur, slide, &earliest);
+
+			if (t - earliest > coinc->dt)
 			{
-				*dest_sngl_handle = sngl_inspiral_merge(*val_handle, *dest_sngl_handle);
-			} else {
-				dest_sngl_handle = g_malloc(sizeof(SnglInspiralTable*));
-				*dest_sngl_handle = *val_handle;
-				g_hash_table_insert(dest_hash, g_memdup(*val_handle, sizeof(**val_handle)), dest_sngl_handle);
+				if (n > 2)
+					append_group(coinc, rings, head, cur, next, slide, outarray);
+
+				/* forget triggers that are no longer relevant */
+				do {
+					head[next_trigger(coinc, rings, head, cur, slide, &earliest)]++;
+					n--;
+					next_trigger(coinc, rings, head, cur, slide, &earliest);
+				} while (t - earliest > coinc->dt);
+			} else if (n >= nifo) {
+				/* as many triggers as detectors, form a coincidence */
+				append_group(coinc, rings, head, cur, -1, slide, outarray);
+				memcpy(head, cur, nifo * sizeof(*head));
+				n = 0;
 			}
+		} else {
+			for (ifo = 0; ifo < nifo; ifo++)
+				n += cur[ifo] - head[ifo];
 		}
 
-		/* Unref input hashtable. */
-		g_hash_table_unref(hash);
+		/* the group is complete if nothing more can join it */
+		for (ifo = 0; ifo < nifo; ifo++)
+			if (cur[ifo] > head[ifo])
+				latest = MAX(latest, rings[ifo].end_time[ring_index(&rings[ifo], cur[ifo] - 1)] + (GstClockTime) slide * ifo * coinc->slide_step);
+		if (n && (next_trigger(coinc, rings, cur, NULL, slide, &t) < 0 || t >= horizon) && latest + coinc->dt < horizon)
+		{
+			if (n > 1)
+				append_group(coinc, rings, head, cur, -1, slide, outarray);
+			memcpy(head, cur, nifo * sizeof(*head));
+		}
+
+		if (!take)
+			break;
+	}
+}
+
+
+/* Forget the triggers that no swept slide still holds.  Only zero lag is
+ * swept when nslides is 0. */
+static void trim_template(GSTLALCoinc* coinc, guint id, guint nslides)
+{
+	const guint nifo = coinc->nifo;
+	const guint64* heads = &g_array_index(coinc->cursors, guint64, id * (coinc->nslides + 1) * 2 * nifo);
+	guint ifo, slide;
+
+	for (ifo = 0; ifo < nifo; ifo++)
+	{
+		guint64 seq = heads[ifo];
+		for (slide = 1; slide <= nslides; slide++)
+			seq = MIN(seq, MAX(heads[slide * 2 * nifo + ifo], g_array_index(coinc->rings, CoincRing, id * nifo + ifo).base));
+		ring_pop_to(&g_array_index(coinc->rings, CoincRing, id * nifo + ifo), seq);
 	}
 }
 
 
+static GstFlowReturn push_coincs(GSTLALCoinc* coinc, GstPad* pad, GArray* outarray, guint64 offset, GstClockTime timestamp, GstClockTime duration)
+{
+	guint64 siz = outarray->len * sizeof(SnglInspiralTable);
+	GstBuffer *buf;
+	GstFlowReturn retval;
+
+	retval = gst_pad_alloc_buffer(pad, offset, siz, GST_PAD_CAPS(pad), &buf);
+	if (retval != GST_FLOW_OK)
+	{
+		GST_ERROR_OBJECT(coinc, "Failed to push buffer");
+		return retval;
+	}
+
+	memcpy(GST_BUFFER_DATA(buf), outarray->data, siz);
+	GST_BUFFER_TIMESTAMP(buf) = timestamp;
+	GST_BUFFER_DURATION(buf) = duration;
+	GST_BUFFER_OFFSET(buf) = offset;
+	GST_BUFFER_OFFSET_END(buf) = GST_BUFFER_OFFSET_NONE;
+	return gst_pad_push(pad, buf);
+}
+
+
 static GstFlowReturn collected(GstCollectPads *pads, gpointer user_data)
 {
 	GSTLALCoinc* coinc = GSTLAL_COINC(user_data);
 	GstElement* element = GST_ELEMENT(coinc);
+	GstPad* bgpad = coinc->bgpad && gst_pad_is_linked(coinc->bgpad) ? coinc->bgpad : NULL;
 
 	/* Assure that we have enough sink pads. */
 	if (element->numsinkpads < 2)
 	{
-		GST_ERROR_OBJECT(coinc, "not enough sink pads, 2 required but only %d are present", element->numsinkpads < 2);
+		GST_ERROR_OBJECT(coinc, "not enough sink pads, 2 required but only %d are present", element->numsinkpads);
+		return GST_FLOW_ERROR;
+	}
+	if (coinc->nifo != (guint) element->numsinkpads)
+	{
+		GST_ERROR_OBJECT(coinc, "sink pads may not be added or removed while running");
 		return GST_FLOW_ERROR;
 	}
 
@@ -343,184 +630,63 @@ static GstFlowReturn collected(GstCollectPads *pads, gpointer user_data)
 		last_seen_time = data->last_end_time;
 	}
 
-	/* Group each template's trigger stream into coincident groups.
-
-	 Here's the strategy for each template:
-
-	 Maintain a running list of consecutive triggers from all detectors.
-	 We assume that the coincidence window is larger than the minimum time
-	 between tirggers from a given detector.
-
-	 At the beginning, this list is empty.
-
-	 At the end of every subsequent iteration, the list must satisfy the
-	 following two conditions:
-
-	  1. Let t1 = the minimum of all the trigger times.
-	     Let t2 = the maximum of all the trigger times, or the latest analyzed time, whichever is smaller.
-	     (t2 - t1) must be less than dt.
-
-	  2. If there are N detectors, there must be fewer than N elements in the list.
-
+	/*
+	 * Sweep every template with pending triggers, zero lag first and then
+	 * each time slide.  Sliding only ever delays a detector's triggers, so
+	 * last_seen_time bounds what is complete in every slide.
 	 */
 
-	GHashTableIter iter;
-	SnglInspiralTable* key;
-	SnglInspiralTable** val_handle;
-	GHashTable* dest_hash = coinc->trigger_sequence_hash;
 	GArray* outarray = g_array_new(FALSE, TRUE, sizeof(SnglInspiralTable));
+	GArray** bgarrays = g_new0(GArray*, coinc->nslides + 1);
+	/* nobody to send the slides to, don't compute them */
+	guint nslides = bgpad ? coinc->nslides : 0;
+	guint id, slide, ifo;
 
-	g_hash_table_iter_init(&iter, dest_hash);
-	while (g_hash_table_iter_next(&iter, (gpointer*)&key, (gpointer*)&val_handle))
-	{
-		SnglInspiralTable* latest_sngl = *val_handle;
-		SnglInspiralTable* earliest_sngl = NULL;
-		GstClockTime earliest_time = 0; /* FIXME: this is needed to avoid uninitialized use warning, but you can check that this variable is always initialized on the first pass thru this loop! */
-		GstClockTime latest_time;
-		guint numtriggers = 0;
-
-		do {
-			/* Update late end of running list. */
-			++numtriggers;
-			latest_time = XLALGPSToINT8NS(&latest_sngl->end_time);
-
-			/* Update early end of running list. */
-			if (earliest_sngl == NULL)
-			{
-				earliest_sngl = latest_sngl;
-				earliest_time = latest_time;
-			}
+	for (slide = 1; slide <= nslides; slide++)
+		bgarrays[slide] = g_array_new(FALSE, TRUE, sizeof(SnglInspiralTable));
 
-			SnglInspiralTable* next_latest_sngl;
-			if (latest_time >= last_seen_time)
-			{
-				/* we don't have enough data to process this trigger yet */
-				next_latest_sngl = NULL;
-			} else {
-				next_latest_sngl = latest_sngl->next;
-
-				/* If necessary, enforce both of the running list's conditions. */
-				if (latest_time - earliest_time > coinc->dt) {
-					/* create coincidence records */
-					if (numtriggers > 2)
-					{
-						SnglInspiralTable* head_sngl;
-						for (head_sngl = earliest_sngl; head_sngl != latest_sngl; head_sngl = head_sngl->next)
-							g_array_append_vals(outarray, head_sngl, 1);
-
-						/* resize output array to a multiple of numsinkpads */
-						g_array_size_to_next_multiple(outarray, element->numsinkpads);
-					}
-
-					/* forget triggers that are no longer relevant */
-					while (latest_time - earliest_time > coinc->dt)
-					{
-						SnglInspiralTable* next_sngl = earliest_sngl->next;
-						earliest_sngl->next = NULL;
-						g_free(earliest_sngl);
-						earliest_sngl = next_sngl;
-						earliest_time = XLALGPSToINT8NS(&earliest_sngl->end_time);
-						g_assert(numtriggers > 0);
-						--numtriggers;
-					}
-				} else if (numtriggers >= element->numsinkpads) {
-					/* all detectors are present, form a coincidence. */
-					SnglInspiralTable* head_sngl;
-					if (numtriggers > 1)
-					{
-						for (head_sngl = earliest_sngl; head_sngl != next_latest_sngl; head_sngl = head_sngl->next)
-							g_array_append_vals(outarray, head_sngl, 1);
-					}
-
-					head_sngl = earliest_sngl;
-					while (head_sngl != next_latest_sngl)
-					{
-						SnglInspiralTable* next_sngl = head_sngl->next;
-						head_sngl->next = NULL;
-						g_free(head_sngl);
-						head_sngl = next_sngl;
-						g_assert(numtriggers > 0);
-						--numtriggers;
-					}
-					earliest_sngl = NULL;
-				}
-
-				if (earliest_sngl && (next_latest_sngl == NULL || (GstClockTime)XLALGPSToINT8NS(&next_latest_sngl->end_time) >= last_seen_time) && latest_time + coinc->dt < last_seen_time)
-				{
-					SnglInspiralTable* head_sngl;
-					/* create coincidence records */
-					if (numtriggers > 1)
-					{
-						for (head_sngl = earliest_sngl; head_sngl != next_latest_sngl; head_sngl = head_sngl->next)
-							g_array_append_vals(outarray, head_sngl, 1);
-
-						/* resize output array to a multiple of numsinkpads */
-						g_array_size_to_next_multiple(outarray, element->numsinkpads);
-					}
-
-					/* forget triggers that are no longer relevant */
-					head_sngl = earliest_sngl;
-					while (head_sngl != next_latest_sngl)
-					{
-						SnglInspiralTable* next_sngl = head_sngl->next;
-						head_sngl->next = NULL;
-						g_free(head_sngl);
-						head_sngl = next_sngl;
-						g_assert(numtriggers > 0);
-						--numtriggers;
-					}
-					earliest_sngl = NULL;
-				}
-			}
+	for (id = 0; id < coinc->ntemplates; id++)
+	{
+		const CoincRing* rings = &g_array_index(coinc->rings, CoincRing, id * coinc->nifo);
 
-			/* Take next value in list. */
-			latest_sngl = next_latest_sngl;
-		} while (latest_sngl != NULL);
+		for (ifo = 0; ifo < coinc->nifo && !rings[ifo].length; ifo++);
+		if (ifo == coinc->nifo)
+			continue;
 
-		/* put back linked list after we have eaten up as many triggers as we can. */
-		*val_handle = earliest_sngl;
+		sweep_template(coinc, id, 0, last_seen_time, outarray);
+		for (slide = 1; slide <= nslides; slide++)
+			sweep_template(coinc, id, slide, last_seen_time, bgarrays[slide]);
+		trim_template(coinc, id, nslides);
 	}
 
-	/* wipe out null entries in hashtable */
-	g_hash_table_foreach_remove(dest_hash, sngl_inspiral_handle_empty, NULL);
-
 	GST_INFO_OBJECT(coinc, "found %d coincident triggers", outarray->len);
 
 	GstFlowReturn retval;
 	if (eos && outarray->len == 0)
-	{
-		g_array_free(outarray, TRUE);
 		retval = GST_FLOW_UNEXPECTED;
-	} else {
-		guint64 siz = outarray->len * sizeof(SnglInspiralTable);
+	else
+		retval = push_coincs(coinc, coinc->srcpad, outarray, GST_BUFFER_OFFSET_NONE, timestamp, last_seen_time - timestamp);
+	g_array_free(outarray, TRUE);
 
-		/* wipe out next fields in case someone tries to dereference them */
-		{
-			SnglInspiralTable* ptr = (SnglInspiralTable*)outarray->data;
-			SnglInspiralTable* end = &ptr[outarray->len];
-			for (; ptr < end; ptr++)
-				ptr->next = NULL;
-		}
-
-		/* Generate outgoing buffer. */
-		GstBuffer *buf;
-		retval = gst_pad_alloc_buffer(coinc->srcpad, GST_BUFFER_OFFSET_NONE, siz, GST_PAD_CAPS(coinc->srcpad), &buf);
-		if (retval == GST_FLOW_OK)
+	/* one buffer per time slide, offset by the slide number */
+	for (slide = 1; slide <= nslides; slide++)
+	{
+		if (bgarrays[slide]->len && (retval == GST_FLOW_OK || retval == GST_FLOW_UNEXPECTED))
 		{
-			memcpy(GST_BUFFER_DATA(buf), outarray->data, siz);
-			g_array_free(outarray, TRUE);
-			GST_BUFFER_TIMESTAMP(buf) = timestamp;
-			GST_BUFFER_DURATION(buf) = last_seen_time - timestamp;
-			GST_BUFFER_OFFSET(buf) = GST_BUFFER_OFFSET_NONE;
-			GST_BUFFER_OFFSET_END(buf) = GST_BUFFER_OFFSET_NONE;
-			retval = gst_pad_push(coinc->srcpad, buf);
-		} else {
-			GST_ERROR_OBJECT(coinc, "Failed to push buffer");
+			GstFlowReturn bgretval = push_coincs(coinc, bgpad, bgarrays[slide], slide, timestamp, last_seen_time - timestamp);
+			if (bgretval != GST_FLOW_OK && bgretval != GST_FLOW_NOT_LINKED)
+				retval = bgretval;
 		}
+		g_array_free(bgarrays[slide], TRUE);
 	}
+	g_free(bgarrays);
 
 	if (eos)
+	{
+		if (bgpad)
+			gst_pad_push_event(bgpad, gst_event_new_eos());
 		retval = gst_pad_push_event(coinc->srcpad, gst_event_new_eos());
+	}
 
 	return retval;
 }
@@ -530,24 +696,14 @@ static void finalize(GObject *object)
 {
 	GSTLALCoinc *coinc = GSTLAL_COINC(object);
 
-	/* destroy hashtable and its contents */
-	GHashTableIter iter;
-	SnglInspiralTable* key;
-	SnglInspiralTable** val;
-	g_hash_table_iter_init(&iter, coinc->trigger_sequence_hash);
-	while (g_hash_table_iter_next(&iter, (gpointer*)&key, (gpointer*)&val))
-	{
-		g_hash_table_iter_remove(&iter);
-		while (*val != NULL)
-		{
-			SnglInspiralTable* next = (*val)->next;
-			(*val)->next = NULL;
-			g_free(*val);
-			*val = next;
-		}
-	}
-	g_hash_table_unref(coinc->trigger_sequence_hash);
-	coinc->trigger_sequence_hash = NULL;
+	/* destroy pending triggers and the template index */
+	clear_triggers(coinc);
+	g_array_free(coinc->rings, TRUE);
+	coinc->rings = NULL;
+	g_array_free(coinc->cursors, TRUE);
+	coinc->cursors = NULL;
+	g_hash_table_unref(coinc->template_index);
+	coinc->template_index = NULL;
 
 	G_OBJECT_CLASS(parent_class)->finalize(object);
 }
@@ -571,6 +727,12 @@ static void base_init(gpointer g_class)
 		"single-detector, single-template triggers, times the number of detectors.  This\n" \
 		"restriction may be lifted in the future.\n" \
 		"\n" \
+		"If time-slides is N > 0, the same sweep is repeated for slides k = 1 ... N in\n" \
+		"which the triggers of the i-th sink pad are moved later by k * i * slide-step.\n" \
+		"These coincidences are pushed on the \"background\" request pad, one buffer per\n" \
+		"slide, with the buffer offset set to k.  The triggers keep their original end\n" \
+		"times.\n" \
+		"\n" \
 		"Each detector is expected to provide buffers of SnglInspiralTable structures to\n" \
 		"one of the sink pads.  The SnglInspiralTable do not have to be in chronological\n" \
 		"order, although all of the SnglInspiralTable entries for a given template *do*\n" \
@@ -589,7 +751,7 @@ static void base_init(gpointer g_class)
 		"In particular, there is no reason that H1 triggers will ever appear in a\n" \
 		"particular channel in the output buffer.\n" \
 		"\n" \
-		"The process by which triggers are formed is a greedy recursive algorithm.\n",
+		"The process by which triggers are formed is a greedy algorithm.\n",
 		"Leo Singer <leo.singer@ligo.org>"
 	);
 	gst_element_class_add_pad_template(
@@ -615,6 +777,18 @@ static void base_init(gpointer g_class)
 			)
 		)
 	);
+	gst_element_class_add_pad_template(
+		element_class,
+		gst_pad_template_new(
+			"background",
+			GST_PAD_SRC,
+			GST_PAD_REQUEST,
+			gst_caps_from_string(
+				"application/x-lal-snglinspiral," \
+				"channels = (int) [0, MAX]"
+			)
+		)
+	);
 }
 
 
@@ -643,6 +817,28 @@ static void class_init(gpointer klass, gpointer class_data)
 			G_PARAM_READWRITE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS
 		)
 	);
+	g_object_class_install_property(
+		gobject_class,
+		ARG_TIME_SLIDES,
+		g_param_spec_uint(
+			"time-slides",
+			"Time Slides",
+			"Number of time slides to evaluate in addition to zero lag.  Takes effect at the next transition to PAUSED.",
+			0, G_MAXUINT16, 0,
+			G_PARAM_READWRITE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS
+		)
+	);
+	g_object_class_install_property(
+		gobject_class,
+		ARG_SLIDE_STEP,
+		g_param_spec_uint64(
+			"slide-step",
+			"Slide Step",
+			"Offset in nanoseconds between consecutive sink pads in the first time slide.",
+			1, G_MAXUINT64, 5 * GST_SECOND,
+			G_PARAM_READWRITE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS
+		)
+	);
 }
 
 
@@ -656,9 +852,15 @@ static void instance_init(GTypeInstance *object, gpointer klass)
 
 	coinc->collect = gst_collect_pads_new();
 	gst_collect_pads_set_function(coinc->collect, GST_DEBUG_FUNCPTR(collected), coinc);
+	coinc->bgpad = NULL;
 	coinc->padcounter = 0;
 
-	coinc->trigger_sequence_hash = g_hash_table_new_full(sngl_inspiral_hash, sngl_inspiral_equal, g_free, g_free);
+	coinc->template_index = g_hash_table_new_full(sngl_inspiral_hash, sngl_inspiral_equal, g_free, NULL);
+	coinc->ntemplates = 0;
+	coinc->nifo = 0;
+	coinc->nslides = 0;
+	coinc->rings = g_array_new(FALSE, TRUE, sizeof(CoincRing));
+	coinc->cursors = g_array_new(FALSE, TRUE, sizeof(guint64));
 }
 
 
@@ -77,9 +77,24 @@ typedef struct {
 	GstElement element;
 	GstCollectPads *collect;
 	GstPad* srcpad;
-	GHashTable* trigger_sequence_hash;
+	GstPad* bgpad;
 	guint64 dt;
+	guint time_slides;
+	guint64 slide_step;
 	guint padcounter;
+
+	/* template -> dense template id + 1 */
+	GHashTable* template_index;
+	guint ntemplates;
+	guint nifo;
+	guint nslides;
+	/* pending triggers, one ring per template and detector, indexed
+	 * template * nifo + ifo */
+	GArray* rings;
+	/* sequence numbers of the first trigger in the running group and of
+	 * the next trigger to sweep, indexed
+	 * ((template * (nslides + 1) + slide) * 2 + {0, 1}) * nifo + ifo */
+	GArray* cursors;
 } GSTLALCoinc;
 
 
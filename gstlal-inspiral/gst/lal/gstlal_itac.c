@@ -116,18 +116,6 @@ static unsigned autocorrelation_length(const GSTLALItac *element)
 }
 
 
-static guint64 output_num_samps(GSTLALItac *element)
-{
-	return (guint64) element->n;
-}
-
-
-static guint64 output_num_bytes(GSTLALItac *element)
-{
-	return (guint64) output_num_samps(element) * element->adapter->unit_size;
-}
-
-
 static int reset_time_and_offset(GSTLALItac *element)
 {
 	element->next_output_offset = 0;
@@ -503,25 +491,26 @@ static GstFlowReturn push_nongap(GSTLALItac *element, guint copysamps, guint out
 {
 	GstBuffer *srcbuf = NULL;
 	GstFlowReturn result = GST_FLOW_OK;
+	const void *data;
 	union {
-		float complex * as_complex;
-		double complex * as_double_complex;
-		void * as_void;
+		const float complex * as_complex;
+		const double complex * as_double_complex;
+		const void * as_void;
 		} dataptr;
 
 	/* make sure the snr threshold is up-to-date */
 	element->maxdata->thresh = element->snr_thresh;
 	/* call the peak finding library on a buffer from the adapter if no events are found the result will be a GAP */
-	gst_audioadapter_copy_samples(element->adapter, element->data, copysamps, NULL, NULL);
+	data = gst_audioadapter_peek_samples(element->adapter, copysamps, NULL, NULL);
 	
 	/* put the data pointer one pad length in */
 	if (element->peak_type == GSTLAL_PEAK_COMPLEX) {
-		dataptr.as_complex = ((float complex *) element->data) + element->maxdata->pad * element->maxdata->channels;
+		dataptr.as_complex = ((const float complex *) data) + element->maxdata->pad * element->maxdata->channels;
 		/* Find the peak */
 		gstlal_float_complex_peak_over_window_interp(element->maxdata, dataptr.as_complex, outsamps);
 		}
 	if (element->peak_type == GSTLAL_PEAK_DOUBLE_COMPLEX) {
-		dataptr.as_double_complex = ((double complex *) element->data) + element->maxdata->pad * element->maxdata->channels;
+		dataptr.as_double_complex = ((const double complex *) data) + element->maxdata->pad * element->maxdata->channels;
 		/* Find the peak */
 		gstlal_double_complex_peak_over_window_interp(element->maxdata, dataptr.as_double_complex, outsamps);
 		}
@@ -617,18 +606,10 @@ static GstFlowReturn chain(GstPad *pad, GstBuffer *sinkbuf)
 {
 	GSTLALItac *element = GSTLAL_ITAC(gst_pad_get_parent(pad));
 	GstFlowReturn result = GST_FLOW_OK;
-	guint64 maxsize;
 
 	/* do this before accessing any element properties */
 	gst_object_sync_values(G_OBJECT(element), GST_BUFFER_TIMESTAMP(sinkbuf));
 
-	/* The max size to copy from an adapter is the typical output size plus the padding */
-	maxsize = output_num_bytes(element) + element->adapter->unit_size * element->maxdata->pad * 2;
-
-	/* if we haven't allocated storage do it now, we should never try to copy from an adapter with a larger buffer than this */
-	if (!element->data)
-		element->data = malloc(maxsize);
-
 	/*
 	 * check validity of timestamp, offsets, tags, bank array
 	 */
@@ -723,10 +704,6 @@ static void finalize(GObject *object)
 		gstlal_peak_state_free(element->maxdata);
 		element->maxdata = NULL;
 		}
-	if (element->data) {
-		free(element->data);
-		element->data = NULL;
-		}
 	if(element->snr_mat) {
 		free(element->snr_mat);
 	}
@@ -963,7 +940,6 @@ static void instance_init(GTypeInstance *object, gpointer class)
 	element->channel_name = NULL;
 	element->bankarray = NULL;
 	element->bank_filename = NULL;
-	element->data = NULL;
 	element->maxdata = NULL;
 	element->bank_lock = g_mutex_new();
 	element->last_gap = TRUE;
@@ -50,7 +50,9 @@ enum gen_property {
 	ARG_DT = 1,
 	ARG_TRIGGER_PRESENT_PADDING,
 	ARG_TRIGGER_ABSENT_PADDING,
-	ARG_BANK_FILENAME
+	ARG_BANK_FILENAME,
+	ARG_HEALPIX_ORDER,
+	ARG_COARSE_LEVELS
 };
 
 
@@ -108,6 +110,14 @@ static void set_property(GObject *object, enum gen_property id, const GValue *va
 		g_mutex_unlock(element->bank_lock);
 		break;
 
+	case ARG_HEALPIX_ORDER:
+		element->healpix_order = g_value_get_int(value);
+		break;
+
+	case ARG_COARSE_LEVELS:
+		element->coarse_levels = g_value_get_int(value);
+		break;
+
 	default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, id, pspec);
 		break;
@@ -140,6 +150,14 @@ static void get_property(GObject * object, enum gen_property id, GValue * value,
 		g_mutex_unlock(element->bank_lock);
 		break;
 
+	case ARG_HEALPIX_ORDER:
+		g_value_set_int(value, element->healpix_order);
+		break;
+
+	case ARG_COARSE_LEVELS:
+		g_value_set_int(value, element->coarse_levels);
+		break;
+
 	default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, id, pspec);
 		break;
@@ -612,6 +630,21 @@ static GstFlowReturn collected(GstCollectPads *pads, gpointer user_data)
 						g_free(adapter_bytes);
 					}
 
+					/* Pick up changes to the sky grid. */
+					GST_OBJECT_LOCK(skymap);
+					if (skymap->healpix_order != skymap->wanalysis.healpix_order)
+					{
+						if (skymap->healpix_order >= 0)
+							analysis_healpix_directions(&skymap->wanalysis, skymap->healpix_order);
+						else {
+							g_free(skymap->wanalysis.directions);
+							skymap->wanalysis.directions = NULL;
+							analysis_default_directions(&skymap->wanalysis);
+						}
+					}
+					skymap->wanalysis.coarse_levels = skymap->coarse_levels;
+					GST_OBJECT_UNLOCK(skymap);
+
 					/* Analyze SNR using skymap library. */
 					skymap->wanalysis.log_skymap = g_malloc(sizeof(double) * skymap->wanalysis.n_directions);
 					analyze(&skymap->wanalysis);
@@ -638,7 +671,10 @@ static GstFlowReturn collected(GstCollectPads *pads, gpointer user_data)
 							double* entry = &((double*)GST_BUFFER_DATA(outbuf))[4 * i];
 							entry[0] = skymap->wanalysis.directions[2*i];
 							entry[1] = skymap->wanalysis.directions[2*i+1];
-							entry[2] = M_PI * 0.4 / 180.0; /* FIXME: How do I get the span out? */
+							if (skymap->wanalysis.healpix_order >= 0)
+								entry[2] = sqrt(4 * M_PI / skymap->wanalysis.n_directions);
+							else
+								entry[2] = M_PI * 0.4 / 180.0; /* FIXME: How do I get the span out? */
 							entry[3] = skymap->wanalysis.log_skymap[i];
 						}
 					}
@@ -854,6 +890,28 @@ static void class_init(gpointer klass, gpointer class_data)
 			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
 		)
 	);
+	g_object_class_install_property(
+		gobject_class,
+		ARG_HEALPIX_ORDER,
+		g_param_spec_int(
+			"healpix-order",
+			"HEALPix order",
+			"Sample the sky on a NESTED HEALPix grid with nside = 2^order, or -1 for the default 0.4 degree latitude-longitude grid.",
+			-1, 13, -1,
+			G_PARAM_READWRITE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS
+		)
+	);
+	g_object_class_install_property(
+		gobject_class,
+		ARG_COARSE_LEVELS,
+		g_param_spec_int(
+			"coarse-levels",
+			"Coarse levels",
+			"With a HEALPix grid, first compute the map this many orders lower and only refine the most probable pixels.  0 to compute every pixel at full resolution.",
+			0, 13, 0,
+			G_PARAM_READWRITE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS
+		)
+	);
 }
 
 
@@ -101,6 +101,8 @@ typedef struct {
 
 	/* analysis */
 	analysis wanalysis;
+	gint healpix_order;
+	gint coarse_levels;
 } GSTLALSkymap;
 
 
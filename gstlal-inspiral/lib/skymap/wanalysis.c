@@ -3,6 +3,10 @@
 #include <math.h>
 #include <string.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 // LAL headers
 
 #include <lal/LALConstants.h>
@@ -23,6 +27,10 @@ void analysis_default_construct(analysis* a)
     a->max_t = -log(0);
     a->delta_t = 1;
     a->log_skymap = 0;
+    a->n_threads = 0;
+    a->healpix_order = -1;
+    a->coarse_levels = 0;
+    a->coarse_coverage = 0.999;
     a->p_realloc = realloc;
     a->p_free = free;
     size_t i;
@@ -57,6 +65,81 @@ void analysis_default_directions(analysis* a)
 	    *(p++) = phi;
 	}
     }
+    a->healpix_order = -1;
+}
+
+// Gather the even (odd) bits of a NESTED pixel index into the x (y)
+// coordinate within its base face
+
+static size_t healpix_compress_bits(size_t v)
+{
+    size_t r = 0;
+    size_t b;
+    for (b = 0; v; ++b, v >>= 2)
+        r |= (v & 1) << b;
+    return r;
+}
+
+// Centre of pixel ipix in the NESTED scheme, from the HEALPix paper
+// (Gorski et al. 2005)
+
+static void healpix_pix2ang_nest(size_t nside, size_t ipix, double* theta, double* phi)
+{
+    static const int jrll[12] = {2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4};
+    static const int jpll[12] = {1, 3, 5, 7, 0, 2, 4, 6, 1, 3, 5, 7};
+
+    long ns = (long) nside;
+    long npface = ns * ns;
+    double fact2 = 4.0 / (12 * npface);
+    long face = (long) ipix / npface;
+    size_t ipf = ipix % npface;
+    long ix = (long) healpix_compress_bits(ipf);
+    long iy = (long) healpix_compress_bits(ipf >> 1);
+    long jr = jrll[face] * ns - ix - iy - 1;
+    long nr, jp;
+    int kshift;
+    double z;
+
+    if (jr < ns)
+    {
+        nr = jr;
+        z = 1 - nr * nr * fact2;
+        kshift = 0;
+    }
+    else if (jr > 3 * ns)
+    {
+        nr = 4 * ns - jr;
+        z = nr * nr * fact2 - 1;
+        kshift = 0;
+    }
+    else
+    {
+        nr = ns;
+        z = (2 * ns - jr) * 2 * ns * fact2;
+        kshift = (jr - ns) & 1;
+    }
+
+    jp = (jpll[face] * nr + ix - iy + 1 + kshift) / 2;
+    if (jp > 4 * ns)
+        jp -= 4 * ns;
+    if (jp < 1)
+        jp += 4 * ns;
+
+    *theta = acos(z);
+    *phi = (jp - (kshift + 1) * 0.5) * (LAL_PI_2 / nr);
+}
+
+void analysis_healpix_directions(analysis* a, int order)
+{
+    size_t nside = (size_t) 1 << order;
+
+    a->n_directions = 12 * nside * nside;
+    a->directions = a->p_realloc(a->directions, a->n_directions * 2 * sizeof(double));
+    a->healpix_order = order;
+
+    size_t i;
+    for (i = 0; i != a->n_directions; ++i)
+        healpix_pix2ang_nest(nside, i, a->directions + 2 * i, a->directions + 2 * i + 1);
 }
 
 int analysis_identify_detector(const char* s)
@@ -151,74 +234,215 @@ analysis* analysis_example(void)
     return a;
 }
 
-void analyze(analysis* s)
+// log(exp(a) + exp(b))
+
+static double log_add_exp(double a, double b)
 {
+    if (a < b)
+    {
+        double t = a;
+        a = b;
+        b = t;
+    }
+    if (isinf(b))
+        return a;
+    return a + log1p(exp(b - a));
+}
 
-    XLALSkymapPlanType plan;
+// Marginalize the posterior for one direction over arrival time.  Each
+// halving of the step only adds the samples midway between the existing
+// ones, so only those are evaluated and folded into the running total.
+// p_t is the calling thread's scratch, grown as needed.
 
-    // Construct the network
-    XLALSkymapPlanConstruct(s->rate, s->n_detectors, s->detectors, &plan);
+static double analyze_direction(analysis* s, XLALSkymapPlanType* plan, double* direction, double** p_t, size_t* p_t_capacity)
+{
+    XLALSkymapDirectionPropertiesType properties;
+    XLALSkymapDirectionPropertiesConstruct(plan, direction, &properties);
 
-    // Working array
-    double* p_t = 0;
+    double t_begin = s->min_t;
+    double t_end = s->max_t;
 
-    size_t i;
-    for (i = 0; i != s->n_directions; ++i) {
-        XLALSkymapDirectionPropertiesType properties;
-        XLALSkymapDirectionPropertiesConstruct(&plan, s->directions + (i * 2), &properties);
+    size_t j;
+    for (j = 0; j != s->n_detectors; ++j) {
+        t_begin = fmax(t_begin, s->min_ts[j] - properties.delay[j]);
+        t_end = fmin(t_end, s->max_ts[j] - properties.delay[j]);
+    }
 
-        double t_begin = s->min_t;
-        double t_end = s->max_t;
+    if (!(t_begin < t_end)) {
+        // the times of interest in each detector exclude this
+        // direction
+        return log(0);
+    }
 
-        size_t j;
-        for (j = 0; j != s->n_detectors; ++j) {
-            t_begin = fmax(t_begin, s->min_ts[j] - properties.delay[j]);
-            t_end = fmin(t_end, s->max_ts[j] - properties.delay[j]);
+    t_begin -= 0.0001;
+    t_end   += 0.0001;
+
+    XLALSkymapKernelType kernel;
+    // strict version assumes no calibration error (compatible with LAL release)
+    //XLALSkymapKernelConstruct(plan, &properties, wSw, &kernel);
+    // loose version allows for amplitude calibration error (requires LAL built from repository head as of 4/18/10)
+    XLALSkymapUncertainKernelConstruct(plan, &properties, s->wSw, s->calibration_error, &kernel);
+
+    double old_p;
+    double new_p = log(0);
+    double log_total = log(0);
+    size_t n = 0;
+
+    // take at least 10 samples
+    double dt = fmin(s->delta_t, (t_end - t_begin) * 0.1);
+
+    do {
+        // samples are at t_begin + j * dt.  Halving dt at most doubles
+        // their number, so every earlier sample lands on an even j.
+        size_t p_t_size = (size_t) (ceil((t_end - t_begin) / dt));
+        size_t first = n ? 1 : 0;
+        size_t stride = n ? 2 : 1;
+        size_t k = 0;
+
+        if (p_t_size > *p_t_capacity)
+        {
+            *p_t_capacity = p_t_size;
+            *p_t = (double*) realloc(*p_t, *p_t_capacity * sizeof(double));
+        }
+
+        for (j = first; j < p_t_size; j += stride)
+        {
+            double t = t_begin + j * dt;
+            double log_p_real, log_p_imag;
+            XLALSkymapApply(plan, &properties, &kernel, s->xSw_real, t, &log_p_real);
+            XLALSkymapApply(plan, &properties, &kernel, s->xSw_imag, t, &log_p_imag);
+            (*p_t)[k++] = log_p_real + log_p_imag;
         }
+        if (k)
+            log_total = log_add_exp(log_total, XLALSkymapLogTotalExp(*p_t, *p_t + k));
+        n = p_t_size;
 
-        if (t_begin < t_end) {
-
-            t_begin -= 0.0001;
-            t_end   += 0.0001;
-
-            XLALSkymapKernelType kernel;
-            // strict version assumes no calibration error (compatible with LAL release)
-            //XLALSkymapKernelConstruct(&plan, &properties, wSw, &kernel);
-            // loose version allows for amplitude calibration error (requires LAL built from repository head as of 4/18/10)
-            XLALSkymapUncertainKernelConstruct(&plan, &properties, s->wSw, s->calibration_error, &kernel);
-
-            double old_p;
-            double new_p = log(0);
-
-            // take at least 10 samples
-            double dt = fmin(s->delta_t, (t_end - t_begin) * 0.1);
-
-            do {
-                size_t p_t_size = (size_t) (ceil((t_end - t_begin) / dt));
-                p_t = (double*) s->p_realloc(p_t, p_t_size * sizeof(double));
-                double t = t_begin;
-                for (j = 0; j != p_t_size; ++j)
-                {
-                      double log_p_real, log_p_imag;
-                      XLALSkymapApply(&plan, &properties, &kernel, s->xSw_real, t, &log_p_real);
-                      XLALSkymapApply(&plan, &properties, &kernel, s->xSw_imag, t, &log_p_imag);
-                      p_t[j] = log_p_real + log_p_imag;
-                      t += dt;
-                }
-                old_p = new_p;
-                new_p = XLALSkymapLogTotalExp(&p_t[0], &p_t[0] + p_t_size) - log(p_t_size);
-                dt = dt / 2;
-            } while (fabs(new_p - old_p) > .1);
-            s->log_skymap[i] = new_p + log(t_end - t_begin);
+        old_p = new_p;
+        new_p = log_total - log(n);
+        dt = dt / 2;
+    } while (fabs(new_p - old_p) > .1);
+
+    return new_p + log(t_end - t_begin);
+}
+
+// Fill log_skymap[index[i]] for the n listed directions (or the first n if
+// index is null), sharing them out over the threads.  The per-thread
+// scratch is internal to this call, so it bypasses p_realloc, which need
+// not be thread-safe.
+
+static void analyze_directions(analysis* s, XLALSkymapPlanType* plan, double* directions, const size_t* index, size_t n, double* log_skymap)
+{
+#ifdef _OPENMP
+    int n_threads = s->n_threads > 0 ? s->n_threads : omp_get_max_threads();
+#endif
+
+    #pragma omp parallel num_threads(n_threads)
+    {
+        double* p_t = 0;
+        size_t p_t_capacity = 0;
+        long i;
+
+        // directions outside the allowed time ranges are nearly free, so
+        // hand them out in small chunks
+        #pragma omp for schedule(dynamic, 16)
+        for (i = 0; i < (long) n; ++i)
+        {
+            size_t d = index ? index[i] : (size_t) i;
+            log_skymap[d] = analyze_direction(s, plan, directions + 2 * d, &p_t, &p_t_capacity);
         }
-        else {
-            // the times of interest in each detector exclude this
-            // direction
-            s->log_skymap[i] = log(0);
+
+        free(p_t);
+    }
+}
+
+typedef struct
+{
+    double log_p;
+    size_t pixel;
+} ranked_pixel;
+
+static int ranked_pixel_descending(const void* a, const void* b)
+{
+    double x = ((const ranked_pixel*) a)->log_p;
+    double y = ((const ranked_pixel*) b)->log_p;
+    return (x < y) - (x > y);
+}
+
+// Compute the map at a lower HEALPix order, then recompute at full
+// resolution only the children of the most probable coarse pixels.  In
+// the NESTED scheme the children of coarse pixel c at l orders higher are
+// the 4^l consecutive pixels starting at c * 4^l.
+
+static void analyze_coarse_to_fine(analysis* s, XLALSkymapPlanType* plan)
+{
+    int levels = s->coarse_levels < s->healpix_order ? s->coarse_levels : s->healpix_order;
+    size_t nside = (size_t) 1 << (s->healpix_order - levels);
+    size_t n_coarse = 12 * nside * nside;
+    size_t n_children = (size_t) 1 << (2 * levels);
+
+    double* directions = (double*) malloc(n_coarse * 2 * sizeof(double));
+    double* log_p = (double*) malloc(n_coarse * sizeof(double));
+    ranked_pixel* ranked = (ranked_pixel*) malloc(n_coarse * sizeof(ranked_pixel));
+    size_t* index = (size_t*) malloc(s->n_directions * sizeof(size_t));
+
+    size_t i, k;
+    for (i = 0; i != n_coarse; ++i)
+        healpix_pix2ang_nest(nside, i, directions + 2 * i, directions + 2 * i + 1);
+    analyze_directions(s, plan, directions, 0, n_coarse, log_p);
+
+    // coarse pixels have equal areas, so their probabilities are
+    // proportional to exp(log_p)
+    double log_norm = log(0);
+    for (i = 0; i != n_coarse; ++i)
+    {
+        ranked[i].log_p = log_p[i];
+        ranked[i].pixel = i;
+        log_norm = log_add_exp(log_norm, log_p[i]);
+    }
+    qsort(ranked, n_coarse, sizeof(ranked_pixel), ranked_pixel_descending);
+
+    size_t n_refine = 0;
+    double coverage = 0;
+    for (i = 0; i != n_coarse; ++i)
+    {
+        size_t c = ranked[i].pixel;
+        if (coverage < s->coarse_coverage && !isinf(log_p[c]))
+        {
+            coverage += exp(log_p[c] - log_norm);
+            for (k = 0; k != n_children; ++k)
+                index[n_refine++] = c * n_children + k;
+        }
+        else
+        {
+            for (k = 0; k != n_children; ++k)
+                s->log_skymap[c * n_children + k] = log_p[c];
         }
     }
 
-    s->p_free(p_t);
-    
+    analyze_directions(s, plan, s->directions, index, n_refine, s->log_skymap);
+
+    free(index);
+    free(ranked);
+    free(log_p);
+    free(directions);
 }
 
+void analyze(analysis* s)
+{
+
+    XLALSkymapPlanType plan;
+
+    // Construct the network
+    XLALSkymapPlanConstruct(s->rate, s->n_detectors, s->detectors, &plan);
+
+    if (s->coarse_levels > 0 && s->healpix_order >= 0 &&
+        s->n_directions == (size_t) 12 << (2 * s->healpix_order))
+    {
+        analyze_coarse_to_fine(s, &plan);
+    }
+    else
+    {
+        analyze_directions(s, &plan, s->directions, 0, s->n_directions, s->log_skymap);
+    }
+    
+}
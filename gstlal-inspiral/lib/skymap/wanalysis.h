@@ -65,6 +65,25 @@ typedef struct
 
     double* log_skymap;
     
+    // Number of threads sharing out the directions, 0 for the OpenMP
+    // default
+
+    int n_threads;
+
+    // HEALPix order (nside = 2^order) if the directions were laid out in
+    // NESTED order by analysis_healpix_directions, otherwise -1
+
+    int healpix_order;
+
+    // Optional coarse-to-fine pass over HEALPix directions.  If > 0 the
+    // map is first computed coarse_levels orders lower, and only the
+    // coarse pixels holding coarse_coverage of the probability are
+    // computed at full resolution.  The remaining pixels take the value
+    // of the coarse pixel they lie in.
+
+    int coarse_levels;
+    double coarse_coverage;
+
     // Memory management hooks
 
     void* (*p_realloc)(void*, size_t);
@@ -75,6 +94,7 @@ typedef struct
 
 void analysis_default_construct(analysis* a);
 void analysis_default_directions(analysis* a);
+void analysis_healpix_directions(analysis* a, int order);
 
 // Perform the analysis
 
@@ -15,6 +15,7 @@ from gstlal.pipeutil import *
 import gstlal.pipeparts as pipeparts
 from pylal.xlal.datatypes.snglinspiraltable import SnglInspiralTable
 from itertools import groupby
+import random
 
 
 class CoincTestFixture(PipelineTestFixture):
@@ -170,5 +171,133 @@ class TestDoubleCoinc(CoincTestFixture):
 			for coinc in coinclist:
 				self.assertTrue(coinc in coincs[mass1], "unexpected coincidence " + str((mass1, coinc)) + " found")
 
+
+def baseline_coincs(triggers, dt, nifo):
+	"""Group one template's triggers the way lal_coinc's per-template trigger
+	lists always have been, as if they had all arrived in one buffer.
+	triggers is a list of (slid end time, sink pad, end time, ifo) sorted in
+	that order.  Returns the coincidences as sorted tuples of (end time, ifo)."""
+	coincs = []
+	group = []
+	for trigger in triggers:
+		group.append(trigger)
+		if group[-1][0] - group[0][0] > dt:
+			if len(group) > 2:
+				coincs.append(group[:-1])
+			while group[-1][0] - group[0][0] > dt:
+				del group[0]
+		elif len(group) >= nifo:
+			coincs.append(group)
+			group = []
+	if len(group) > 1:
+		coincs.append(group)
+	return [tuple(sorted((t, ifo) for (slid, pad, t, ifo) in coinc)) for coinc in coincs]
+
+
+class TestBaselineGrouping(PipelineTestFixture):
+	"""Feed lal_coinc a fixed set of triggers, denser than dt in every
+	detector, and check its zero-lag and time-slide coincidences against
+	baseline_coincs()."""
+
+	ifos = ('H1', 'L1', 'V1')
+	masses = (1.25, 1.5, 2.75)
+	nslides = 3
+	slide_step = 70 * gst.MSECOND
+	buffer_duration = 2 * gst.SECOND
+	duration = 20 * gst.SECOND
+
+	def make_triggers(self):
+		# a private generator, so the set is the same on every run
+		rng = random.Random(20101)
+		triggers = dict((ifo, []) for ifo in self.ifos)
+		for ifo in self.ifos:
+			for mass1 in self.masses:
+				t = rng.randint(0, 200) * gst.MSECOND
+				while t < self.duration:
+					triggers[ifo].append((t, mass1))
+					t += rng.randint(10, 250) * gst.MSECOND
+			triggers[ifo].sort()
+		return triggers
+
+	def sngl_buffers(self, ifo, triggers):
+		recordsize = len(buffer(SnglInspiralTable()))
+		buffers = []
+		for timestamp in range(0, self.duration, self.buffer_duration):
+			sngls = []
+			for t, mass1 in triggers:
+				if timestamp <= t < timestamp + self.buffer_duration:
+					sngl = SnglInspiralTable()
+					sngl.ifo = ifo
+					sngl.mass1 = mass1
+					sngl.mass2 = 1.
+					sngl.end_time = t // gst.SECOND
+					sngl.end_time_ns = t % gst.SECOND
+					sngl.snr = 5
+					sngls.append(str(buffer(sngl)))
+			buf = gst.Buffer(''.join(sngls))
+			assert len(buf) == recordsize * len(sngls)
+			buf.timestamp = timestamp
+			buf.duration = self.buffer_duration
+			buffers.append(buf)
+		return buffers
+
+	def coinc_new_buffer(self, elem, coincs):
+		buf = elem.get_property("last-buffer")
+		slide = 0 if buf.offset == gst.BUFFER_OFFSET_NONE else buf.offset
+		sngls = SnglInspiralTable.from_buffer(buf)
+		for coinc in zip(*[sngls[i::len(self.ifos)] for i in range(len(self.ifos))]):
+			key = (slide, coinc[0].mass1)
+			coincs.setdefault(key, []).append(tuple(sorted(
+				(gst.SECOND * sngl.end_time + sngl.end_time_ns, sngl.ifo)
+				for sngl in coinc if sngl.ifo != '')))
+
+	def setUp(self):
+		super(TestBaselineGrouping, self).setUp()
+
+		self.dt = 100 * gst.MSECOND
+		self.triggers = self.make_triggers()
+
+		coinc = gst.element_factory_make('lal_coinc')
+		coinc.set_property("dt", self.dt)
+		coinc.set_property("time-slides", self.nslides)
+		coinc.set_property("slide-step", self.slide_step)
+		self.pipeline.add(coinc)
+
+		def need_data(elem, arg, buffers):
+			if buffers:
+				elem.emit("push-buffer", buffers.pop(0))
+			else:
+				elem.emit("end-of-stream")
+
+		for i_ifo, ifo in enumerate(self.ifos):
+			appsrc = pipeparts.mkgeneric(self.pipeline, None, "appsrc", caps = gst.Caps("application/x-lal-snglinspiral, channels = (int) 1"), format = gst.FORMAT_TIME)
+			appsrc.connect("need-data", need_data, self.sngl_buffers(ifo, self.triggers[ifo]))
+			appsrc.link_pads('src', coinc, 'sink%d' % i_ifo)
+
+		self.coincs = dict()
+		appsink = pipeparts.mkappsink(self.pipeline, coinc)
+		appsink.connect_after('new-buffer', self.coinc_new_buffer, self.coincs)
+		appsink = pipeparts.mkappsink(self.pipeline, None)
+		coinc.get_request_pad('background').link(appsink.get_pad('sink'))
+		appsink.connect_after('new-buffer', self.coinc_new_buffer, self.coincs)
+
+	def runTest(self):
+		"""Check lal_coinc's zero-lag and time-slide coincidences against the baseline grouping."""
+
+		self.pipeline.set_state(gst.STATE_PLAYING)
+		self.mainloop.run()
+
+		for slide in range(self.nslides + 1):
+			for mass1 in self.masses:
+				triggers = sorted(
+					(t + slide * i_ifo * self.slide_step, i_ifo, t, ifo)
+					for i_ifo, ifo in enumerate(self.ifos)
+					for t, m in self.triggers[ifo] if m == mass1)
+				expected = baseline_coincs(triggers, self.dt, len(self.ifos))
+				found = self.coincs.get((slide, mass1), [])
+				self.assertTrue(expected, "no coincidences expected for slide %d, mass1=%f, the trigger set is too sparse" % (slide, mass1))
+				self.assertEqual(found, expected, "slide %d, mass1=%f:  found %s, expected %s" % (slide, mass1, found, expected))
+
+
 if __name__ == '__main__':
 	suite = unittest.main()
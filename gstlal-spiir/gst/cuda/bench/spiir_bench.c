@@ -0,0 +1,1136 @@
+/*
+ * Copyright (C) 2026 The SPIIR authors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Benchmarks for the stages of the SPIIR pipeline.
+ *
+ * Each case times one stage on its own over a number of iterations and
+ * prints one JSON object per line:
+ *
+ *   {"case": "spiirup_host", "status": "ok", "backend": "host",
+ *    "threads": 8, "params": {...}, "iterations": 200,
+ *    "items_per_iteration": 65536, "unit": "template-samples",
+ *    "throughput": 1.2e+09,
+ *    "latency_us": {"p50": ..., "p90": ..., "p99": ..., "max": ...}}
+ *
+ * throughput is items per second over all iterations. "threads" is only
+ * reported for the host backend. Cases that cannot run print "status":
+ * "skipped" and a reason.
+ *
+ * The cases of the CUDA elements run on compute_backend_get_default(), so
+ * they are skipped without a GPU, in a build without CUDA or with
+ * SPIIR_COMPUTE_BACKEND=host. They take the bank from --bank, a SPIIR bank
+ * as given to cuda_multiratespiir and cuda_postcoh:
+ *
+ *   downsample the multirate downsampler of cuda_multiratespiir on buffers
+ *              of --samples samples from --data (tiled)
+ *   spiirup    the IIR filters and upsampler of cuda_multiratespiir on the
+ *              output of one downsample
+ *   peakfind   the peak search of cuda_postcoh over one second of synthetic
+ *              SNR from each of --ifos, including the copy of the peak list
+ *              to the device
+ *   cohsnr     the coherent SNR and chisq of cuda_postcoh for the peaks
+ *              found by peakfind, on the map of --ifos at --order
+ *
+ * The host cases always run on the host backend. All inputs are either
+ * files given on the command line or generated from a fixed seed, so two
+ * runs with the same options do the same work:
+ *
+ *   spiirup_host
+ *              the host IIR filter bank on a synthetic bank of --templates x
+ *              --filters filters, fed with the samples in --data (tiled)
+ *   detrsp     generation of one detector response map slice for --ifos at
+ *              HEALPix --order
+ *   rankmap    building the background rank map, knn pdf estimation and
+ *              cumulative rank, from --events synthetic background triggers
+ *              or from the background in --stats
+ *   assignfar  false alarm probability of --triggers triggers against the
+ *              rank map built by rankmap
+ */
+
+#include <cohfar/background_stats_utils.h>
+#include <compute_backend.h>
+#include <getopt.h>
+#include <math.h>
+#include <pipe_macro.h>
+#include <postcoh/postcoh_detrsp.h>
+#include <spiir/spiir_host.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef SPIIR_HAVE_CUDA
+#include <LIGOLwHeader.h>
+#include <multiratespiir/multiratespiir_kernel.h>
+#include <multiratespiir/multiratespiir_utils.h>
+#include <postcoh/postcoh_utils.h>
+#endif
+
+/* inputs are generated from this so that runs are comparable */
+#define BENCH_SEED 20260118
+
+/* slices of the detector response map, as gstlal_postcoh_gen_detrsp_map */
+#define BENCH_DETRSP_GPS_STEP 1800
+
+/* bound on the iterations kept for --min-time */
+#define BENCH_MAX_ITER 100000
+
+typedef struct _BenchConfig {
+    guint templates;
+    guint filters;
+    guint samples;
+    const char *data_fname;
+    const char *bank_fname;
+    const char *ifos;
+    unsigned order;
+    const char *stats_fname;
+    char *stats_ifos;
+    guint events;
+    guint triggers;
+    guint iterations;
+    guint warmup;
+    double min_time;
+    gint nthreads;
+    const char *output_fname;
+    /* where the cases of the CUDA elements run */
+    const ComputeBackend *backend;
+} BenchConfig;
+
+/* filled in by a case's setup */
+typedef struct _BenchRun {
+    /* set before setup, where the case runs */
+    const ComputeBackend *backend;
+    /* "key": value pairs describing the problem size */
+    GString *params;
+    /* work done by one iteration, in units */
+    double items;
+    const char *unit;
+    /* set when the case cannot run */
+    const char *reason;
+} BenchRun;
+
+typedef struct _BenchCase {
+    const char *name;
+    /* the backend the case needs, the host cases always run on the host */
+    ComputeBackendType backend;
+    /* NULL if the case is not built. returns FALSE to skip the case, state
+     * is freed by teardown either way */
+    gboolean (*setup)(const BenchConfig *config,
+                      BenchRun *run,
+                      gpointer *pstate);
+    void (*run)(gpointer state);
+    void (*teardown)(gpointer state);
+} BenchCase;
+
+static float *bench_read_data(const char *fname, gsize *nsample);
+
+/*
+ * spiirup_host
+ */
+
+typedef struct _SpiirupState {
+    IIRBankHost *bank;
+    float *input;
+    float complex *output;
+    guint length;
+} SpiirupState;
+
+static gboolean spiirup_host_setup(const BenchConfig *config,
+                                   BenchRun *run,
+                                   gpointer *pstate) {
+    SpiirupState *state = g_new0(SpiirupState, 1);
+    guint ntmplt = config->templates, nf = config->filters;
+    gsize nfilt = (gsize)ntmplt * nf, i, ndata = 0;
+    double complex *a1 = g_new(double complex, nfilt);
+    double complex *b0 = g_new(double complex, nfilt);
+    double complex *y  = g_new0(double complex, nfilt);
+    gint *delay        = g_new(gint, nfilt);
+    GRand *rand        = g_rand_new_with_seed(BENCH_SEED);
+    float *data        = bench_read_data(config->data_fname, &ndata);
+    guint input_length;
+
+    /* poles inside the unit circle and delays up to a second at 4096 Hz,
+     * the shape of a bank from gstlal_iir_bank */
+    for (i = 0; i < nfilt; i++) {
+        double r   = g_rand_double_range(rand, 0.9, 0.9999);
+        double phi = g_rand_double_range(rand, -M_PI, M_PI);
+        a1[i]      = r * cexp(I * phi);
+        b0[i]      = g_rand_double_range(rand, -1e-3, 1e-3)
+                + I * g_rand_double_range(rand, -1e-3, 1e-3);
+        delay[i] = g_rand_int_range(rand, 0, 4096);
+    }
+    state->bank   = iir_bank_host_new(ntmplt, nf, a1, b0, y, delay);
+    state->length = config->samples;
+
+    input_length  = state->length + state->bank->dmax;
+    state->input  = g_new(float, input_length);
+    state->output = g_new(float complex, (gsize)state->length * ntmplt);
+    for (i = 0; i < input_length; i++)
+        state->input[i] =
+          data ? data[i % ndata] : g_rand_double_range(rand, -1., 1.);
+
+    g_string_append_printf(run->params,
+                           "\"templates\": %u, \"filters\": %u, "
+                           "\"samples\": %u, \"data\": \"%s\"",
+                           ntmplt, nf, state->length,
+                           data ? config->data_fname : "random");
+    run->items = (double)state->length * ntmplt;
+    run->unit  = "template-samples";
+
+    g_free(data);
+    g_rand_free(rand);
+    g_free(a1);
+    g_free(b0);
+    g_free(y);
+    g_free(delay);
+    *pstate = state;
+    return TRUE;
+}
+
+static void spiirup_host_run(gpointer data) {
+    SpiirupState *state = data;
+
+    iir_bank_host_filter_s(state->bank, state->input, state->length,
+                           state->output);
+}
+
+static void spiirup_host_teardown(gpointer data) {
+    SpiirupState *state = data;
+
+    iir_bank_host_free(state->bank);
+    g_free(state->input);
+    g_free(state->output);
+    g_free(state);
+}
+
+/*
+ * detrsp
+ */
+
+typedef struct _DetrspState {
+    DetrspMap *map;
+    float *U, *diff, *Det;
+    gint islice;
+} DetrspState;
+
+static gboolean detrsp_setup(const BenchConfig *config,
+                             BenchRun *run,
+                             gpointer *pstate) {
+    DetrspState *state;
+    char **ifos;
+    double *horizons;
+    gint nifo = detrsp_parse_ifo_horizons(config->ifos, &ifos, &horizons);
+    DetrspMap *map;
+
+    if (nifo == 0
+        || !(map = detrsp_map_new(ifos, nifo, horizons, BENCH_DETRSP_GPS_STEP,
+                                  config->order))) {
+        run->reason = "bad --ifos";
+        g_strfreev(ifos);
+        g_free(horizons);
+        return FALSE;
+    }
+    state       = g_new0(DetrspState, 1);
+    state->map  = map;
+    state->U    = g_new(float, (gsize)nifo * nifo * map->npix);
+    state->diff = g_new(float, (gsize)nifo * nifo * map->npix);
+    state->Det  = g_new(float, map->npix);
+
+    g_string_append_printf(run->params,
+                           "\"ifos\": \"%s\", \"order\": %u, \"npix\": %lu",
+                           config->ifos, config->order, map->npix);
+    run->items = map->npix;
+    run->unit  = "pixels";
+
+    g_strfreev(ifos);
+    g_free(horizons);
+    *pstate = state;
+    return TRUE;
+}
+
+static void detrsp_run(gpointer data) {
+    DetrspState *state = data;
+    DetrspMap *map     = state->map;
+
+    /* walk through the day so every slice sees different sky positions */
+    detrsp_map_generate_slice(map, state->islice,
+                              1000000000L + state->islice * map->gps_step,
+                              state->U, state->diff, state->Det);
+    state->islice = (state->islice + 1) % map->ngps;
+}
+
+static void detrsp_teardown(gpointer data) {
+    DetrspState *state = data;
+
+    detrsp_map_free(state->map);
+    g_free(state->U);
+    g_free(state->diff);
+    g_free(state->Det);
+    g_free(state);
+}
+
+/*
+ * rankmap and assignfar
+ */
+
+typedef struct _RankState {
+    TriggerStatsXML *stats;
+    TriggerStats *combined;
+    double *snr, *chisq;
+    guint ntrigger;
+    float fap_sum;
+} RankState;
+
+/* Background triggers that look roughly like Gaussian noise: SNR with an
+ * exponential tail above threshold and reduced chisq scattered about one. */
+static void rank_fill_synthetic(TriggerStats *stats, guint nevent, GRand *rand) {
+    guint i;
+
+    for (i = 0; i < nevent; i++) {
+        double snr   = 4. - log(1. - g_rand_double(rand));
+        double chisq = exp(g_rand_double_range(rand, -0.5, 0.5)) * snr / 4.;
+        trigger_stats_feature_rate_update(snr, chisq, stats->feature, stats);
+    }
+}
+
+static gboolean rank_setup_common(const BenchConfig *config,
+                                  BenchRun *run,
+                                  RankState *state) {
+    int hist_trials;
+    GRand *rand;
+
+    state->stats =
+      trigger_stats_xml_create(config->stats_ifos, STATS_XML_TYPE_BACKGROUND);
+    state->combined = state->stats->multistats[state->stats->nifo];
+
+    if (config->stats_fname) {
+        if (!trigger_stats_xml_from_xml(state->stats, &hist_trials,
+                                        config->stats_fname)
+            || state->combined->nevent == 0) {
+            run->reason = "no background in --stats";
+            return FALSE;
+        }
+        g_string_append_printf(run->params,
+                               "\"ifos\": \"%s\", \"stats\": \"%s\", "
+                               "\"events\": %ld",
+                               config->stats_ifos, config->stats_fname,
+                               state->combined->nevent);
+        return TRUE;
+    }
+
+    rand = g_rand_new_with_seed(BENCH_SEED);
+    rank_fill_synthetic(state->combined, config->events, rand);
+    g_rand_free(rand);
+    g_string_append_printf(run->params,
+                           "\"ifos\": \"%s\", \"stats\": \"synthetic\", "
+                           "\"events\": %u",
+                           config->stats_ifos, config->events);
+    return TRUE;
+}
+
+static gboolean rankmap_setup(const BenchConfig *config,
+                              BenchRun *run,
+                              gpointer *pstate) {
+    RankState *state = g_new0(RankState, 1);
+
+    *pstate = state;
+    if (!rank_setup_common(config, run, state)) return FALSE;
+    run->items = 1;
+    run->unit  = "maps";
+    return TRUE;
+}
+
+static void rankmap_run(gpointer data) {
+    RankState *state = data;
+
+    trigger_stats_feature_rate_to_pdf(state->combined->feature);
+    trigger_stats_feature_to_rank(state->combined->feature,
+                                  state->combined->rank);
+}
+
+static gboolean assignfar_setup(const BenchConfig *config,
+                                BenchRun *run,
+                                gpointer *pstate) {
+    RankState *state = g_new0(RankState, 1);
+    GRand *rand;
+    guint i;
+
+    *pstate = state;
+    if (!rank_setup_common(config, run, state)) return FALSE;
+    rankmap_run(state);
+
+    /* foreground spans the whole map, from noise to loud signals */
+    rand            = g_rand_new_with_seed(BENCH_SEED + 1);
+    state->ntrigger = config->triggers;
+    state->snr      = g_new(double, state->ntrigger);
+    state->chisq    = g_new(double, state->ntrigger);
+    for (i = 0; i < state->ntrigger; i++) {
+        state->snr[i] = pow(10., g_rand_double_range(rand, LOGSNR_CMIN,
+                                                      LOGSNR_CMAX));
+        state->chisq[i] = pow(10., g_rand_double_range(rand, LOGCHISQ_CMIN,
+                                                       LOGCHISQ_CMAX));
+    }
+    g_rand_free(rand);
+
+    g_string_append_printf(run->params, ", \"triggers\": %u",
+                           state->ntrigger);
+    run->items = state->ntrigger;
+    run->unit  = "triggers";
+    return TRUE;
+}
+
+static void assignfar_run(gpointer data) {
+    RankState *state = data;
+    guint i;
+
+    for (i = 0; i < state->ntrigger; i++)
+        state->fap_sum += gen_fap_from_feature(state->snr[i], state->chisq[i],
+                                               state->combined);
+}
+
+static void rank_teardown(gpointer data) {
+    RankState *state = data;
+
+    if (state->stats) trigger_stats_xml_destroy(state->stats);
+    g_free(state->snr);
+    g_free(state->chisq);
+    g_free(state);
+}
+
+#ifdef SPIIR_HAVE_CUDA
+
+/*
+ * downsample and spiirup, the multirate SPIIR filter of cuda_multiratespiir
+ */
+
+typedef struct _MultirateState {
+    const ComputeBackend *backend;
+    ComputeQueue *queue;
+    SpiirState **spstate;
+    guint num_depths;
+    gint rate;
+    gint num_exe_samples;
+    gint num_out_multidown;
+    float *input;
+    float *output;
+} MultirateState;
+
+static cudaStream_t bench_stream(const ComputeBackend *backend,
+                                 ComputeQueue *queue) {
+    return (cudaStream_t)backend->queue_native(queue);
+}
+
+static gboolean multirate_setup_common(const BenchConfig *config,
+                                       BenchRun *run,
+                                       MultirateState *state) {
+    guint num_head_cover_samples, num_tail_cover_samples;
+    gsize ndata = 0, i;
+    float *data;
+    GRand *rand;
+
+    if (!config->bank_fname) {
+        run->reason = "needs --bank";
+        return FALSE;
+    }
+    state->backend = run->backend;
+    state->queue   = state->backend->queue_new();
+
+    /* as cuda_multiratespiir sets up its state, with --samples in place of
+     * the one second buffers of the element */
+    cuda_multiratespiir_read_ndepth_and_rate(
+      config->bank_fname, &state->num_depths, &state->rate);
+    cuda_multiratespiir_init_cover_samples(
+      &num_head_cover_samples, &num_tail_cover_samples, state->rate,
+      state->num_depths, DOWN_FILT_LEN * 2, UP_FILT_LEN);
+    state->num_exe_samples = config->samples;
+    state->spstate         = spiir_state_create(
+      config->bank_fname, state->num_depths, state->rate,
+      num_head_cover_samples, state->num_exe_samples,
+      bench_stream(state->backend, state->queue));
+    if (state->spstate[0]->num_templates == 0) {
+        run->reason = "no SPIIR filters in --bank";
+        return FALSE;
+    }
+
+    data         = bench_read_data(config->data_fname, &ndata);
+    rand         = g_rand_new_with_seed(BENCH_SEED);
+    state->input = g_new(float, state->num_exe_samples);
+    for (i = 0; i < (gsize)state->num_exe_samples; i++)
+        state->input[i] =
+          data ? data[i % ndata] : g_rand_double_range(rand, -1., 1.);
+    state->output = g_new(float, (gsize)state->num_exe_samples
+                                   * state->spstate[0]->num_templates * 2);
+
+    g_string_append_printf(run->params,
+                           "\"bank\": \"%s\", \"templates\": %d, "
+                           "\"depths\": %u, \"rate\": %d, \"samples\": %d, "
+                           "\"data\": \"%s\"",
+                           config->bank_fname,
+                           state->spstate[0]->num_templates, state->num_depths,
+                           state->rate, state->num_exe_samples,
+                           data ? config->data_fname : "random");
+
+    g_free(data);
+    g_rand_free(rand);
+    return TRUE;
+}
+
+static gboolean downsample_setup(const BenchConfig *config,
+                                 BenchRun *run,
+                                 gpointer *pstate) {
+    MultirateState *state = g_new0(MultirateState, 1);
+
+    *pstate = state;
+    if (!multirate_setup_common(config, run, state)) return FALSE;
+    run->items = state->num_exe_samples;
+    run->unit  = "samples";
+    return TRUE;
+}
+
+static void downsample_run(gpointer data) {
+    MultirateState *state = data;
+
+    multi_downsample(state->spstate, state->input, state->num_exe_samples,
+                     state->num_depths,
+                     bench_stream(state->backend, state->queue));
+    state->backend->queue_sync(state->queue);
+}
+
+static gboolean spiirup_setup(const BenchConfig *config,
+                              BenchRun *run,
+                              gpointer *pstate) {
+    MultirateState *state = g_new0(MultirateState, 1);
+
+    *pstate = state;
+    if (!multirate_setup_common(config, run, state)) return FALSE;
+    /* fill the queues of every depth once, each iteration filters them */
+    state->num_out_multidown = multi_downsample(
+      state->spstate, state->input, state->num_exe_samples, state->num_depths,
+      bench_stream(state->backend, state->queue));
+    state->backend->queue_sync(state->queue);
+    run->items = (double)state->num_exe_samples
+                 * state->spstate[0]->num_templates;
+    run->unit = "template-samples";
+    return TRUE;
+}
+
+static void spiirup_run(gpointer data) {
+    MultirateState *state = data;
+
+    spiirup(state->spstate, state->num_out_multidown, state->num_depths,
+            state->output, bench_stream(state->backend, state->queue));
+    state->backend->queue_sync(state->queue);
+}
+
+static void multirate_teardown(gpointer data) {
+    MultirateState *state = data;
+
+    if (state->spstate) {
+        spiir_state_destroy(state->spstate, state->num_depths);
+        free(state->spstate);
+    }
+    if (state->queue) state->backend->queue_free(state->queue);
+    g_free(state->input);
+    g_free(state->output);
+    g_free(state);
+}
+
+/*
+ * peakfind and cohsnr, the coherent search of cuda_postcoh
+ */
+
+/* the time of the data, the peaks use the first slice of the map */
+#define BENCH_GPS 1187008880L
+
+/* the defaults of cuda_postcoh */
+#define BENCH_HIST_TRIALS    1
+#define BENCH_TRIAL_INTERVAL 0.1
+#define BENCH_SNGLSNR_THRESH 4.0
+
+/* a loud coincident peak every so many samples in every detector, so that
+ * each chunk has coherent work */
+#define BENCH_PEAK_SPACING 128
+#define BENCH_PEAK_SNR     8.0
+
+typedef struct _PostcohBenchState {
+    const ComputeBackend *backend;
+    ComputeQueue *queue;
+    DetrspMap *map;
+    PostcohState *state;
+    /* one chunk of snr for each detector, [one_take_len][ntmplt] */
+    COMPLEX_F **snglsnr;
+    gint one_take_len;
+    gint npeak;
+} PostcohBenchState;
+
+/* the number of templates in the autocorrelation of a SPIIR bank */
+static gint postcoh_bank_ntmplt(const char *bank_fname) {
+    XmlNodeStruct xns;
+    XmlArray array = { 0 };
+    gint ntmplt;
+
+    strncpy((char *)xns.tag, "autocorrelation_bank_real:array", XMLSTRMAXLEN);
+    xns.processPtr = readArray;
+    xns.data       = &array;
+    parseFile(bank_fname, &xns, 1);
+    ntmplt = array.ndim == 2 ? array.dim[1] : 0;
+    freeArraydata(&array);
+    return ntmplt;
+}
+
+/* complex Gaussian noise of unit variance in each part, with the loud peaks
+ * of BENCH_PEAK_SPACING at the same samples in every detector */
+static void postcoh_fill_snr(COMPLEX_F *snr,
+                             gint len,
+                             gint ntmplt,
+                             GRand *rand) {
+    gint ilen, itmplt;
+
+    for (ilen = 0; ilen < len; ilen++)
+        for (itmplt = 0; itmplt < ntmplt; itmplt++) {
+            double r   = sqrt(-2. * log(1. - g_rand_double(rand)));
+            double phi = g_rand_double_range(rand, -M_PI, M_PI);
+            snr[(gsize)ilen * ntmplt + itmplt].re = r * cos(phi);
+            snr[(gsize)ilen * ntmplt + itmplt].im = r * sin(phi);
+        }
+    for (ilen = BENCH_PEAK_SPACING / 2; ilen < len;
+         ilen += BENCH_PEAK_SPACING) {
+        double phi = g_rand_double_range(rand, -M_PI, M_PI);
+        /* spread over the bank */
+        itmplt = (ilen / BENCH_PEAK_SPACING) * 7919 % ntmplt;
+        snr[(gsize)ilen * ntmplt + itmplt].re = BENCH_PEAK_SNR * cos(phi);
+        snr[(gsize)ilen * ntmplt + itmplt].im = BENCH_PEAK_SNR * sin(phi);
+    }
+}
+
+static gboolean postcoh_setup_common(const BenchConfig *config,
+                                     BenchRun *run,
+                                     PostcohBenchState *pb) {
+    PostcohState *state;
+    char **ifos;
+    double *horizons;
+    gint nifo, icombo, iifo, preserved_len, rate;
+    guint num_depths;
+    gsize chunk_size;
+    GString *autocorr_fname;
+    COMPLEX_F *d_chunk;
+    cudaStream_t stream;
+    GRand *rand;
+
+    if (!config->bank_fname) {
+        run->reason = "needs --bank";
+        return FALSE;
+    }
+    /* as cuda_postcoh sets up its state for one second chunks of the snr
+     * of each detector in --ifos */
+    pb->state = state = g_new0(PostcohState, 1);
+    state->npix       = POSTCOH_PARAMS_NOT_INIT;
+    nifo = detrsp_parse_ifo_horizons(config->ifos, &ifos, &horizons);
+    if (nifo > 0)
+        pb->map = detrsp_map_new(ifos, nifo, horizons, BENCH_DETRSP_GPS_STEP,
+                                 config->order);
+    state->nifo     = nifo;
+    state->all_ifos = g_new0(char, nifo * IFO_LEN + 1);
+    for (iifo = 0; iifo < nifo; iifo++)
+        strncpy(state->all_ifos + iifo * IFO_LEN, ifos[iifo], IFO_LEN);
+    g_strfreev(ifos);
+    g_free(horizons);
+    icombo = pb->map ? get_icombo(state->all_ifos) : -1;
+    if (icombo < 0) {
+        run->reason = "bad --ifos";
+        return FALSE;
+    }
+    strncpy(state->all_ifos, IFOComboMap[icombo].name, nifo * IFO_LEN);
+    pb->backend = run->backend;
+    pb->queue   = pb->backend->queue_new();
+    stream      = bench_stream(pb->backend, pb->queue);
+
+    cuda_multiratespiir_read_ndepth_and_rate(config->bank_fname, &num_depths,
+                                             &rate);
+    state->ntmplt = postcoh_bank_ntmplt(config->bank_fname);
+    if (state->ntmplt == 0) {
+        run->reason = "no autocorrelation in --bank";
+        return FALSE;
+    }
+    autocorr_fname = g_string_new(NULL);
+    for (iifo = 0; iifo < nifo; iifo++)
+        g_string_append_printf(autocorr_fname, "%s%.*s:%s", iifo ? "," : "",
+                               IFO_LEN, state->all_ifos + iifo * IFO_LEN,
+                               config->bank_fname);
+    cuda_postcoh_autocorr_from_xml(autocorr_fname->str, state, stream);
+    g_string_free(autocorr_fname, TRUE);
+
+    cuda_postcoh_map_init_detrsp(pb->map, state);
+    cuda_postcoh_map_from_detrsp(pb->map, state, BENCH_GPS, stream);
+
+    state->dt                 = 1. / rate;
+    preserved_len             = state->autochisq_len + 160;
+    state->exe_len            = rate;
+    pb->one_take_len          = preserved_len / 2 + state->exe_len;
+    state->max_npeak          = MIN(rate, state->ntmplt);
+    state->hist_trials        = BENCH_HIST_TRIALS;
+    state->trial_sample_inv   = round(BENCH_TRIAL_INTERVAL * rate);
+    state->snglsnr_len        = preserved_len + state->exe_len
+                         + state->hist_trials * state->trial_sample_inv;
+    state->snglsnr_start_load = state->hist_trials * state->trial_sample_inv;
+    state->snglsnr_start_exe  = state->snglsnr_start_load;
+    state->snglsnr_thresh     = BENCH_SNGLSNR_THRESH;
+    state->tmp_maxsnr         = g_new(float, state->exe_len);
+    state->tmp_tmpltidx       = g_new(int, state->exe_len);
+
+    /* every detector has data, as in coincident time */
+    state->cur_nifo     = nifo;
+    state->cur_ifo_bits = (1 << nifo) - 1;
+    strncpy(state->cur_ifos, state->all_ifos, nifo * IFO_LEN);
+
+    state->write_ifo_mapping = g_new(gint, nifo);
+    get_write_ifo_mapping(state->all_ifos, nifo, state->write_ifo_mapping);
+    state->d_write_ifo_mapping = pb->backend->device_alloc(sizeof(gint) * nifo);
+    pb->backend->copy_async(state->d_write_ifo_mapping,
+                            state->write_ifo_mapping, sizeof(gint) * nifo,
+                            COMPUTE_COPY_HOST_TO_DEVICE, pb->queue);
+
+    chunk_size  = sizeof(COMPLEX_F) * pb->one_take_len * state->ntmplt;
+    d_chunk     = pb->backend->device_alloc(chunk_size);
+    pb->snglsnr = g_new0(COMPLEX_F *, nifo);
+    state->d_snglsnr  = g_new0(COMPLEX_F *, nifo);
+    state->dd_snglsnr = pb->backend->device_alloc(sizeof(COMPLEX_F *) * nifo);
+    state->peak_list  = g_new0(PeakList *, nifo);
+    rand              = g_rand_new_with_seed(BENCH_SEED);
+    for (iifo = 0; iifo < nifo; iifo++) {
+        gsize snr_size = sizeof(COMPLEX_F) * state->snglsnr_len * state->ntmplt;
+
+        state->d_snglsnr[iifo] = pb->backend->device_alloc(snr_size);
+        pb->backend->memset_async(state->d_snglsnr[iifo], 0, snr_size,
+                                  pb->queue);
+        pb->backend->copy_async(&state->dd_snglsnr[iifo],
+                                &state->d_snglsnr[iifo], sizeof(COMPLEX_F *),
+                                COMPUTE_COPY_HOST_TO_DEVICE, pb->queue);
+        state->peak_list[iifo] = create_peak_list(state, stream);
+
+        /* the chunk goes where cuda_postcoh puts it on the device */
+        pb->snglsnr[iifo] = g_malloc(chunk_size);
+        postcoh_fill_snr(pb->snglsnr[iifo], pb->one_take_len, state->ntmplt,
+                         rand);
+        pb->backend->copy_async(d_chunk, pb->snglsnr[iifo], chunk_size,
+                                COMPUTE_COPY_HOST_TO_DEVICE, pb->queue);
+        transpose_snglsnr(d_chunk, state->d_snglsnr[iifo],
+                          state->snglsnr_start_load, pb->one_take_len,
+                          state->snglsnr_len, state->ntmplt, stream);
+        pb->backend->queue_sync(pb->queue);
+    }
+    g_rand_free(rand);
+    pb->backend->device_free(d_chunk);
+
+    g_string_append_printf(run->params,
+                           "\"bank\": \"%s\", \"templates\": %d, "
+                           "\"ifos\": \"%s\", \"order\": %u, \"npix\": %d, "
+                           "\"samples\": %d, \"autochisq_len\": %d, "
+                           "\"hist_trials\": %d",
+                           config->bank_fname, state->ntmplt, config->ifos,
+                           config->order, state->npix, state->exe_len,
+                           state->autochisq_len, state->hist_trials);
+    return TRUE;
+}
+
+static gint postcoh_find_peaks(PostcohBenchState *pb) {
+    PostcohState *state = pb->state;
+    gint iifo, npeak = 0;
+
+    for (iifo = 0; iifo < state->nifo; iifo++) {
+        state->snglsnr_max[iifo] = 0;
+        npeak += peaks_over_thresh(pb->snglsnr[iifo], state, iifo,
+                                   bench_stream(pb->backend, pb->queue));
+    }
+    pb->backend->queue_sync(pb->queue);
+    return npeak;
+}
+
+static gboolean peakfind_setup(const BenchConfig *config,
+                               BenchRun *run,
+                               gpointer *pstate) {
+    PostcohBenchState *pb = g_new0(PostcohBenchState, 1);
+
+    *pstate = pb;
+    if (!postcoh_setup_common(config, run, pb)) return FALSE;
+    run->items = (double)pb->state->exe_len * pb->state->ntmplt
+                 * pb->state->nifo;
+    run->unit = "template-samples";
+    return TRUE;
+}
+
+static void peakfind_run(gpointer data) {
+    postcoh_find_peaks(data);
+}
+
+static gboolean cohsnr_setup(const BenchConfig *config,
+                             BenchRun *run,
+                             gpointer *pstate) {
+    PostcohBenchState *pb = g_new0(PostcohBenchState, 1);
+
+    *pstate = pb;
+    if (!postcoh_setup_common(config, run, pb)) return FALSE;
+    pb->npeak = postcoh_find_peaks(pb);
+    g_string_append_printf(run->params, ", \"peaks\": %d", pb->npeak);
+    run->items = pb->npeak;
+    run->unit  = "peaks";
+    return TRUE;
+}
+
+static void cohsnr_run(gpointer data) {
+    PostcohBenchState *pb = data;
+    PostcohState *state   = pb->state;
+    gint iifo;
+
+    /* the peak lists are left as peakfind made them, the kernels only read
+     * them */
+    for (iifo = 0; iifo < state->nifo; iifo++)
+        if (state->peak_list[iifo]->npeak[0] > 0)
+            cohsnr_and_chisq(state, iifo, 0, 0,
+                             bench_stream(pb->backend, pb->queue));
+}
+
+static void postcoh_teardown(gpointer data) {
+    PostcohBenchState *pb = data;
+    PostcohState *state   = pb->state;
+    gint iifo;
+
+    /* the autocorrelation is only reachable from the device and goes with
+     * the process */
+    if (state) {
+        for (iifo = 0; iifo < state->nifo; iifo++) {
+            if (state->peak_list && state->peak_list[iifo]) {
+                peak_list_destroy(state->peak_list[iifo]);
+                free(state->peak_list[iifo]);
+            }
+            if (state->d_snglsnr && state->d_snglsnr[iifo])
+                pb->backend->device_free(state->d_snglsnr[iifo]);
+            if (pb->snglsnr) g_free(pb->snglsnr[iifo]);
+        }
+        if (state->npix != POSTCOH_PARAMS_NOT_INIT && state->d_U_map)
+            for (iifo = 0; iifo < pb->map->ngps; iifo++) {
+                pb->backend->device_free(state->d_U_map[iifo]);
+                pb->backend->device_free(state->d_diff_map[iifo]);
+            }
+        if (state->dd_snglsnr) pb->backend->device_free(state->dd_snglsnr);
+        if (state->d_write_ifo_mapping)
+            pb->backend->device_free(state->d_write_ifo_mapping);
+        free(state->d_U_map);
+        free(state->d_diff_map);
+        g_free(state->d_snglsnr);
+        g_free(state->peak_list);
+        g_free(state->write_ifo_mapping);
+        g_free(state->tmp_maxsnr);
+        g_free(state->tmp_tmpltidx);
+        g_free(state->all_ifos);
+        g_free(state);
+    }
+    g_free(pb->snglsnr);
+    if (pb->queue) pb->backend->queue_free(pb->queue);
+    detrsp_map_free(pb->map);
+    g_free(pb);
+}
+
+#define CUDA_CASE(setup, run, teardown) setup, run, teardown
+#else
+#define CUDA_CASE(setup, run, teardown) NULL, NULL, NULL
+#endif /* SPIIR_HAVE_CUDA */
+
+static const BenchCase bench_cases[] = {
+    { "downsample", COMPUTE_BACKEND_CUDA,
+      CUDA_CASE(downsample_setup, downsample_run, multirate_teardown) },
+    { "spiirup", COMPUTE_BACKEND_CUDA,
+      CUDA_CASE(spiirup_setup, spiirup_run, multirate_teardown) },
+    { "spiirup_host", COMPUTE_BACKEND_HOST, spiirup_host_setup,
+      spiirup_host_run, spiirup_host_teardown },
+    { "peakfind", COMPUTE_BACKEND_CUDA,
+      CUDA_CASE(peakfind_setup, peakfind_run, postcoh_teardown) },
+    { "cohsnr", COMPUTE_BACKEND_CUDA,
+      CUDA_CASE(cohsnr_setup, cohsnr_run, postcoh_teardown) },
+    { "detrsp", COMPUTE_BACKEND_HOST, detrsp_setup, detrsp_run,
+      detrsp_teardown },
+    { "rankmap", COMPUTE_BACKEND_HOST, rankmap_setup, rankmap_run,
+      rank_teardown },
+    { "assignfar", COMPUTE_BACKEND_HOST, assignfar_setup, assignfar_run,
+      rank_teardown },
+    { NULL, 0, NULL, NULL, NULL },
+};
+
+/*
+ * driver
+ */
+
+/* the whole of a raw float32 file such as multiratespiir/test/data4k.bin */
+static float *bench_read_data(const char *fname, gsize *nsample) {
+    gchar *contents;
+    gsize length;
+
+    *nsample = 0;
+    if (!fname || !g_file_get_contents(fname, &contents, &length, NULL))
+        return NULL;
+    *nsample = length / sizeof(float);
+    if (*nsample == 0) {
+        g_free(contents);
+        return NULL;
+    }
+    return (float *)contents;
+}
+
+static double bench_now_us(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec * 1e-3;
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+
+    return (x > y) - (x < y);
+}
+
+/* nearest rank percentile of sorted values */
+static double percentile(const double *sorted, guint n, double p) {
+    guint rank = (guint)ceil(p / 100. * n);
+
+    return sorted[MAX(rank, 1) - 1];
+}
+
+static void bench_report(FILE *out,
+                         const BenchConfig *config,
+                         const BenchCase *bench,
+                         const BenchRun *run,
+                         const double *latency,
+                         guint niter) {
+    double total = 0;
+    guint i;
+
+    fprintf(out, "{\"case\": \"%s\", ", bench->name);
+    if (run->reason) {
+        fprintf(out, "\"status\": \"skipped\", \"reason\": \"%s\"}\n",
+                run->reason);
+        return;
+    }
+    for (i = 0; i < niter; i++) total += latency[i];
+    fprintf(out, "\"status\": \"ok\", \"backend\": \"%s\", ",
+            run->backend->name);
+    if (run->backend->type == COMPUTE_BACKEND_HOST)
+        fprintf(out, "\"threads\": %d, ", config->nthreads);
+    fprintf(out,
+            "\"params\": {%s}, \"iterations\": %u, "
+            "\"items_per_iteration\": %.0f, \"unit\": \"%s\", "
+            "\"throughput\": %.6g, \"latency_us\": {\"p50\": %.3f, "
+            "\"p90\": %.3f, \"p99\": %.3f, \"max\": %.3f}}\n",
+            run->params->str, niter, run->items, run->unit,
+            run->items * niter / (total * 1e-6),
+            percentile(latency, niter, 50.), percentile(latency, niter, 90.),
+            percentile(latency, niter, 99.), latency[niter - 1]);
+}
+
+static void bench_case_run(FILE *out,
+                           const BenchConfig *config,
+                           const BenchCase *bench) {
+    BenchRun run    = { NULL, g_string_new(NULL), 0., NULL, NULL };
+    gpointer state  = NULL;
+    double *latency = NULL, start, end, elapsed = 0.;
+    guint niter     = 0, i;
+
+    run.backend = bench->backend == COMPUTE_BACKEND_HOST
+                    ? compute_backend_host()
+                    : config->backend;
+    if (!bench->setup)
+        run.reason = "built without CUDA";
+    else if (run.backend->type != bench->backend)
+        run.reason = "no CUDA device, or SPIIR_COMPUTE_BACKEND=host";
+    else if (bench->setup(config, &run, &state)) {
+        latency = g_new(double, config->iterations);
+        for (i = 0; i < config->warmup; i++) bench->run(state);
+        /* at least --iterations, or as many as fit in --min-time */
+        while (niter < config->iterations
+               || (elapsed < config->min_time * 1e6 && niter < BENCH_MAX_ITER)) {
+            if (niter == config->iterations)
+                latency = g_renew(double, latency, BENCH_MAX_ITER);
+            start = bench_now_us();
+            bench->run(state);
+            end              = bench_now_us();
+            latency[niter++] = end - start;
+            elapsed += end - start;
+        }
+        qsort(latency, niter, sizeof(double), compare_double);
+    } else if (!run.reason)
+        run.reason = "setup failed";
+
+    bench_report(out, config, bench, &run, latency, niter);
+    fflush(out);
+    if (state && bench->teardown) bench->teardown(state);
+    g_free(latency);
+    g_string_free(run.params, TRUE);
+}
+
+static void usage(const char *prog) {
+    const BenchCase *bench;
+
+    fprintf(stderr,
+            "usage: %s [options] [case ...]\n"
+            "  --templates N      templates in the IIR bank (default 1024)\n"
+            "  --filters N        filters per template (default 64)\n"
+            "  --samples N        samples per IIR buffer (default 4096)\n"
+            "  --data FILE        float32 input samples, e.g. data4k.bin\n"
+            "  --bank FILE        SPIIR bank for the cases of the CUDA "
+            "elements\n"
+            "  --ifos STR         detectors and horizons (default "
+            "H1:26,L1:52,V1:10)\n"
+            "  --order N          HEALPix order of the response map (default "
+            "5)\n"
+            "  --stats FILE       background stats xml, default synthetic\n"
+            "  --stats-ifos STR   detector combination of the stats (default "
+            "H1L1)\n"
+            "  --events N         synthetic background triggers (default "
+            "100000)\n"
+            "  --triggers N       triggers per FAR assignment (default "
+            "10000)\n"
+            "  --iterations N     timed iterations (default 20)\n"
+            "  --warmup N         untimed iterations first (default 1)\n"
+            "  --min-time SEC     keep iterating for at least SEC seconds\n"
+            "  --nthreads N       host threads, 0 for one per processor\n"
+            "  --output FILE      write results to FILE instead of stdout\n"
+            "cases:",
+            prog);
+    for (bench = bench_cases; bench->name; bench++)
+        fprintf(stderr, " %s", bench->name);
+    fprintf(stderr, "\n");
+    exit(1);
+}
+
+static guint parse_uint(const char *prog, const char *arg) {
+    char *end;
+    long val = strtol(arg, &end, 10);
+
+    if (*end != '\0' || val < 0) usage(prog);
+    return (guint)val;
+}
+
+static void parse_opts(int argc, char *argv[], BenchConfig *config) {
+    int option_index          = 0;
+    struct option long_opts[] = {
+        { "templates", required_argument, 0, 'T' },
+        { "filters", required_argument, 0, 'F' },
+        { "samples", required_argument, 0, 'S' },
+        { "data", required_argument, 0, 'd' },
+        { "bank", required_argument, 0, 'b' },
+        { "ifos", required_argument, 0, 'i' },
+        { "order", required_argument, 0, 'n' },
+        { "stats", required_argument, 0, 's' },
+        { "stats-ifos", required_argument, 0, 'I' },
+        { "events", required_argument, 0, 'e' },
+        { "triggers", required_argument, 0, 'r' },
+        { "iterations", required_argument, 0, 'k' },
+        { "warmup", required_argument, 0, 'w' },
+        { "min-time", required_argument, 0, 'm' },
+        { "nthreads", required_argument, 0, 't' },
+        { "output", required_argument, 0, 'o' },
+        { "help", no_argument, 0, 'h' },
+        { 0, 0, 0, 0 }
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "h", long_opts, &option_index))
+           != -1) {
+        switch (opt) {
+        case 'T': config->templates = parse_uint(argv[0], optarg); break;
+        case 'F': config->filters = parse_uint(argv[0], optarg); break;
+        case 'S': config->samples = parse_uint(argv[0], optarg); break;
+        case 'd': config->data_fname = optarg; break;
+        case 'b': config->bank_fname = optarg; break;
+        case 'i': config->ifos = optarg; break;
+        case 'n': config->order = parse_uint(argv[0], optarg); break;
+        case 's': config->stats_fname = optarg; break;
+        case 'I': config->stats_ifos = optarg; break;
+        case 'e': config->events = parse_uint(argv[0], optarg); break;
+        case 'r': config->triggers = parse_uint(argv[0], optarg); break;
+        case 'k': config->iterations = parse_uint(argv[0], optarg); break;
+        case 'w': config->warmup = parse_uint(argv[0], optarg); break;
+        case 'm': config->min_time = g_ascii_strtod(optarg, NULL); break;
+        case 't': config->nthreads = parse_uint(argv[0], optarg); break;
+        case 'o': config->output_fname = optarg; break;
+        default: usage(argv[0]);
+        }
+    }
+    if (config->templates == 0 || config->filters == 0 || config->samples == 0
+        || config->iterations == 0 || config->iterations > BENCH_MAX_ITER)
+        usage(argv[0]);
+}
+
+int main(int argc, char *argv[]) {
+    BenchConfig config = {
+        .templates    = 1024,
+        .filters      = 64,
+        .samples      = 4096,
+        .data_fname   = NULL,
+        .bank_fname   = NULL,
+        .ifos         = "H1:26,L1:52,V1:10",
+        .order        = 5,
+        .stats_fname  = NULL,
+        .stats_ifos   = "H1L1",
+        .events       = 100000,
+        .triggers     = 10000,
+        .iterations   = 20,
+        .warmup       = 1,
+        .min_time     = 0.,
+        .nthreads     = 0,
+        .output_fname = NULL,
+        .backend      = NULL,
+    };
+    const BenchCase *bench;
+    FILE *out = stdout;
+    int i, status = 0;
+
+    parse_opts(argc, argv, &config);
+    if (!g_thread_supported()) g_thread_init(NULL);
+    /* resolve the thread count the way the host backend does, to report it */
+    if (config.nthreads <= 0) {
+        const char *env = getenv("SPIIR_HOST_THREADS");
+        config.nthreads = env ? atoi(env) : 0;
+    }
+    if (config.nthreads <= 0) config.nthreads = sysconf(_SC_NPROCESSORS_ONLN);
+    compute_backend_host_set_nthreads(config.nthreads);
+    config.backend = compute_backend_get_default();
+    if (config.output_fname && !(out = fopen(config.output_fname, "w"))) {
+        fprintf(stderr, "unable to open %s\n", config.output_fname);
+        return 1;
+    }
+
+    for (bench = bench_cases; bench->name; bench++) {
+        gboolean selected = optind == argc;
+        for (i = optind; i < argc; i++)
+            selected |= g_strcmp0(argv[i], bench->name) == 0;
+        if (selected) bench_case_run(out, &config, bench);
+    }
+    for (i = optind; i < argc; i++) {
+        for (bench = bench_cases; bench->name; bench++)
+            if (g_strcmp0(argv[i], bench->name) == 0) break;
+        if (!bench->name) {
+            fprintf(stderr, "unknown case %s\n", argv[i]);
+            status = 1;
+        }
+    }
+
+    if (out != stdout) fclose(out);
+    return status;
+}
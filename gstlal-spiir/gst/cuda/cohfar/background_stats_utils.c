@@ -315,6 +315,9 @@ TriggerStatsXML *trigger_stats_xml_create(char *ifos, int stats_type) {
         stats->feature_xmlname = g_string_new(SIGNAL_XML_FEATURE_NAME);
         stats->rank_xmlname    = g_string_new(SIGNAL_XML_RANK_NAME);
         printf("create sgstats %s\n", stats->feature_xmlname->str);
+    } else if (stats_type == STATS_XML_TYPE_SNGL) {
+        stats->feature_xmlname = g_string_new(SNGL_XML_FEATURE_NAME);
+        stats->rank_xmlname    = g_string_new(SNGL_XML_RANK_NAME);
     }
 
     int icombo        = get_icombo(ifos);
@@ -409,6 +412,19 @@ void trigger_stats_feature_rate_update(double snr,
     cur_stats->nevent++;
 }
 
+/* For triggers without a chisq: only the snr rate is counted, the chisq
+ * and snr-chisq rates are left as they are. */
+void trigger_stats_feature_snr_update(double snr,
+                                      FeatureStats *feature,
+                                      TriggerStats *cur_stats) {
+    int snr_idx              = bins1D_get_idx(snr, feature->lgsnr_rate);
+    gsl_vector_long *snr_vec = (gsl_vector_long *)feature->lgsnr_rate->data;
+
+    gsl_vector_long_set(snr_vec, snr_idx,
+                        gsl_vector_long_get(snr_vec, snr_idx) + 1);
+    cur_stats->nevent++;
+}
+
 void trigger_stats_feature_rate_add(FeatureStats *feature1,
                                     FeatureStats *feature2,
                                     TriggerStats *cur_stats) {
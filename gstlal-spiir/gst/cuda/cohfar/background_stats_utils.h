@@ -59,6 +59,10 @@ void trigger_stats_feature_rate_update(double snr,
                                        FeatureStats *feature,
                                        TriggerStats *cur_stats);
 
+void trigger_stats_feature_snr_update(double snr,
+                                      FeatureStats *feature,
+                                      TriggerStats *cur_stats);
+
 double trigger_stats_get_val_from_map(double snr, double chisq, Bins2D *bins);
 
 int scan_trigger_ifos(int icombo, PostcohInspiralTable *trigger);
@@ -69,11 +73,13 @@ void trigger_stats_xml_reset(TriggerStatsXML *stats);
 
 void signal_stats_init(TriggerStatsXML *sgstats, int source_type);
 
-void trigger_stats_feature_rates_add(FeatureStats *feature1,
-                                     FeatureStats *feature2,
-                                     TriggerStats *cur_stats);
+void trigger_stats_feature_rate_add(FeatureStats *feature1,
+                                    FeatureStats *feature2,
+                                    TriggerStats *cur_stats);
+
+void trigger_stats_feature_rate_to_pdf(FeatureStats *feature);
 
-void trigger_stats_feature_rates_to_pdf(FeatureStats *feature);
+void trigger_stats_feature_to_rank(FeatureStats *feature, RankingStats *rank);
 
 double bins2D_get_val(double snr, double chisq, Bins2D *bins);
 
@@ -34,6 +34,7 @@
 #include <gst/base/gstbasetransform.h>
 #include <gst/gst.h>
 #include <gstlal/gstlal.h>
+#include <gstlal/gstlal_element_stats.h>
 
 /*
  * stuff from here
@@ -84,7 +85,9 @@ enum property {
     PROP_SNAPSHOT_INTERVAL,
     PROP_HISTORY_FNAME,
     PROP_OUTPUT_PREFIX,
-    PROP_OUTPUT_NAME
+    PROP_OUTPUT_NAME,
+    /* first of the gstlal_element_stats properties */
+    PROP_STATS
 };
 
 static void cohfar_accumbackground_set_property(GObject *object,
@@ -139,6 +142,41 @@ static void update_stats_icombo(PostcohInspiralTable *intable,
     }
 }
 
+/* A single-detector trigger only updates the bin of its own IFO, there is
+ * no coherent statistic to put in the multi-IFO bin. Its row has no chisq,
+ * postcoh skips the kernel that computes it, so only the snr rate is
+ * counted. These are the zero-lag single-detector triggers, there are no
+ * time-slide trials to draw a background from with one detector. */
+static void update_sngl_stats(PostcohInspiralTable *intable,
+                              int table_icombo,
+                              TriggerStatsXML *stats) {
+    int ifo, index;
+
+    for (ifo = 0, index = 0; ifo < MAX_NIFO; ifo++) {
+        if ((stats->icombo + 1) & (1 << ifo)) {
+            if ((table_icombo + 1) & (1 << ifo))
+                trigger_stats_feature_snr_update(
+                  (double)(intable->snglsnr[ifo]),
+                  stats->multistats[index]->feature, stats->multistats[index]);
+            index++;
+        }
+    }
+}
+
+static void dump_stats(CohfarAccumbackground *element, const char *fname) {
+    trigger_stats_xml_dump(element->bgstats, element->hist_trials, fname,
+                           STATS_XML_WRITE_START, &(element->stats_writer));
+    trigger_stats_xml_dump(element->zlstats, element->hist_trials, fname,
+                           STATS_XML_WRITE_MID, &(element->stats_writer));
+    /* files stay as they were unless postcoh sends single-detector
+     * triggers */
+    if (element->have_sngl)
+        trigger_stats_xml_dump(element->snglstats, element->hist_trials, fname,
+                               STATS_XML_WRITE_MID, &(element->stats_writer));
+    trigger_stats_xml_dump(element->sgstats, element->hist_trials, fname,
+                           STATS_XML_WRITE_END, &(element->stats_writer));
+}
+
 /*
  * ============================================================================
  *
@@ -168,6 +206,8 @@ static GstFlowReturn cohfar_accumbackground_chain(GstPad *pad,
       GST_TIME_ARGS(GST_BUFFER_DURATION(inbuf)), GST_BUFFER_OFFSET(inbuf),
       GST_BUFFER_OFFSET_END(inbuf));
 
+    gstlal_element_stats_input(element->stats, inbuf);
+
     if (!GST_CLOCK_TIME_IS_VALID(element->t_roll_start))
         element->t_roll_start = GST_BUFFER_TIMESTAMP(inbuf);
 
@@ -199,7 +239,8 @@ static GstFlowReturn cohfar_accumbackground_chain(GstPad *pad,
       (PostcohInspiralTable *)(GST_BUFFER_DATA(inbuf) + GST_BUFFER_SIZE(inbuf));
     for (; intable < intable_end; intable++)
         if (intable->is_background == FLAG_FOREGROUND
-            || intable->is_background == FLAG_EMPTY)
+            || intable->is_background == FLAG_EMPTY
+            || intable->is_background == FLAG_SNGL)
             outentries++;
 
     /*
@@ -251,6 +292,13 @@ static GstFlowReturn cohfar_accumbackground_chain(GstPad *pad,
               zlstats); // update the last combination and single IFO stats
             memcpy(outtable, intable, sizeof(PostcohInspiralTable));
             outtable++;
+        } else if (intable->is_background == FLAG_SNGL) {
+            /* single-detector trigger, counted apart from the coherent
+             * stats and passed on */
+            update_sngl_stats(intable, table_icombo, element->snglstats);
+            element->have_sngl = TRUE;
+            memcpy(outtable, intable, sizeof(PostcohInspiralTable));
+            outtable++;
         } else {
             /* increment livetime if participating nifo >= 2 */
             // If icombo is a power of two, then there is only one participating
@@ -279,6 +327,17 @@ static GstFlowReturn cohfar_accumbackground_chain(GstPad *pad,
                         index++;
                     }
                 }
+            } else if (table_icombo >= 0) {
+                /* single-detector time is the livetime of the single
+                 * stream */
+                for (ifo = 0, index = 0; ifo < MAX_NIFO; ifo++) {
+                    if ((element->snglstats->icombo + 1) & (1 << ifo)) {
+                        if ((table_icombo + 1) & (1 << ifo))
+                            trigger_stats_livetime_inc(
+                              element->snglstats->multistats, index);
+                        index++;
+                    }
+                }
             }
             memcpy(outtable, intable, sizeof(PostcohInspiralTable));
             outtable++;
@@ -305,15 +364,7 @@ static GstFlowReturn cohfar_accumbackground_chain(GstPad *pad,
         g_string_append_printf(fname, "_%d_%d.xml.gz", gps_time, duration);
         g_string_append_printf(tmp_fname, "_%d_%d.xml.gz_next", gps_time,
                                duration);
-        trigger_stats_xml_dump(element->bgstats, element->hist_trials,
-                               tmp_fname->str, STATS_XML_WRITE_START,
-                               &(element->stats_writer));
-        trigger_stats_xml_dump(element->zlstats, element->hist_trials,
-                               tmp_fname->str, STATS_XML_WRITE_MID,
-                               &(element->stats_writer));
-        trigger_stats_xml_dump(element->sgstats, element->hist_trials,
-                               tmp_fname->str, STATS_XML_WRITE_END,
-                               &(element->stats_writer));
+        dump_stats(element, tmp_fname->str);
         printf("rename from %s\n", tmp_fname->str);
         if (g_rename(tmp_fname->str, fname->str) != 0) {
             fprintf(stderr, "unable to rename to %s\n", fname->str);
@@ -323,6 +374,7 @@ static GstFlowReturn cohfar_accumbackground_chain(GstPad *pad,
         g_string_free(tmp_fname, TRUE);
         trigger_stats_xml_reset(element->bgstats);
         trigger_stats_xml_reset(element->zlstats);
+        trigger_stats_xml_reset(element->snglstats);
         element->t_roll_start = t_cur;
     }
 
@@ -338,6 +390,9 @@ static GstFlowReturn cohfar_accumbackground_chain(GstPad *pad,
         GST_BUFFER_FLAG_SET(outbuf, GST_BUFFER_FLAG_GAP);
 
     gst_buffer_unref(inbuf);
+    gstlal_element_stats_output(element->stats, GST_BUFFER_TIMESTAMP(outbuf)
+                                                  + GST_BUFFER_DURATION(outbuf));
+    gstlal_element_stats_processed(element->stats);
     result = gst_pad_push(srcpad, outbuf);
 
     GST_LOG_OBJECT(
@@ -383,15 +438,7 @@ static gboolean cohfar_accumbackground_sink_event(GstPad *pad,
             g_string_append_printf(fname, "_%d_%d.xml.gz", gps_time, duration);
             g_string_append_printf(tmp_fname, "_%d_%d.xml.gz_next", gps_time,
                                    duration);
-            trigger_stats_xml_dump(element->bgstats, element->hist_trials,
-                                   tmp_fname->str, STATS_XML_WRITE_START,
-                                   &(element->stats_writer));
-            trigger_stats_xml_dump(element->zlstats, element->hist_trials,
-                                   tmp_fname->str, STATS_XML_WRITE_MID,
-                                   &(element->stats_writer));
-            trigger_stats_xml_dump(element->sgstats, element->hist_trials,
-                                   tmp_fname->str, STATS_XML_WRITE_END,
-                                   &(element->stats_writer));
+            dump_stats(element, tmp_fname->str);
             printf("rename from %s\n", tmp_fname->str);
             g_rename(tmp_fname->str, fname->str);
             g_string_free(fname, TRUE);
@@ -399,15 +446,7 @@ static gboolean cohfar_accumbackground_sink_event(GstPad *pad,
 
         } else {
             GString *fname = g_string_new(element->output_name);
-            trigger_stats_xml_dump(element->bgstats, element->hist_trials,
-                                   fname->str, STATS_XML_WRITE_START,
-                                   &(element->stats_writer));
-            trigger_stats_xml_dump(element->zlstats, element->hist_trials,
-                                   fname->str, STATS_XML_WRITE_MID,
-                                   &(element->stats_writer));
-            trigger_stats_xml_dump(element->sgstats, element->hist_trials,
-                                   fname->str, STATS_XML_WRITE_END,
-                                   &(element->stats_writer));
+            dump_stats(element, fname->str);
             g_string_free(fname, TRUE);
         }
 
@@ -440,6 +479,8 @@ static void cohfar_accumbackground_set_property(GObject *object,
           trigger_stats_xml_create(element->ifos, STATS_XML_TYPE_ZEROLAG);
         element->sgstats =
           trigger_stats_xml_create(element->ifos, STATS_XML_TYPE_SIGNAL);
+        element->snglstats =
+          trigger_stats_xml_create(element->ifos, STATS_XML_TYPE_SNGL);
         break;
 
     case PROP_SOURCE_TYPE:
@@ -474,7 +515,11 @@ static void cohfar_accumbackground_set_property(GObject *object,
         element->snapshot_interval = g_value_get_int(value);
         break;
 
-    default: G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec); break;
+    default:
+        if (!gstlal_element_stats_set_property(element->stats,
+                                               prop_id - PROP_STATS, value))
+            G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+        break;
     }
 
     GST_OBJECT_UNLOCK(element);
@@ -514,7 +559,11 @@ static void cohfar_accumbackground_get_property(GObject *object,
     case PROP_SNAPSHOT_INTERVAL:
         g_value_set_int(value, element->snapshot_interval);
         break;
-    default: G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec); break;
+    default:
+        if (!gstlal_element_stats_get_property(element->stats,
+                                               prop_id - PROP_STATS, value))
+            G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+        break;
     }
     GST_OBJECT_UNLOCK(element);
 }
@@ -529,6 +578,8 @@ static void cohfar_accumbackground_dispose(GObject *object) {
     if (element->bgstats) {
         // FIXME: free stats
     }
+    gstlal_element_stats_free(element->stats);
+    element->stats = NULL;
     G_OBJECT_CLASS(parent_class)->dispose(object);
 }
 
@@ -621,6 +672,10 @@ static void
                        "statistics xml file every N seconds.",
                        -1, G_MAXINT, 86400,
                        G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+    /* the element holds no data between buffers */
+    /* one buffer out for every buffer in, nothing is held */
+    gstlal_element_stats_install_properties(gobject_class, PROP_STATS, NULL);
 }
 /*
  * init()
@@ -646,7 +701,10 @@ static void
 
     element->bgstats           = NULL;
     element->zlstats           = NULL;
+    element->snglstats         = NULL;
+    element->have_sngl         = FALSE;
     element->stats_writer      = NULL;
     element->t_roll_start      = GST_CLOCK_TIME_NONE;
     element->snapshot_interval = NOT_INIT;
+    element->stats = gstlal_element_stats_new(GST_ELEMENT(element));
 }
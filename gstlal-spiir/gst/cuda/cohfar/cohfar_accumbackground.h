@@ -32,6 +32,7 @@
 #include <glib.h>
 #include <gst/base/gstbasetransform.h>
 #include <gst/gst.h>
+#include <gstlal/gstlal_element_stats.h>
 #include <libxml/xmlwriter.h>
 #include <postcohtable.h>
 
@@ -64,6 +65,10 @@ typedef struct {
     TriggerStatsXML *bgstats;
     TriggerStatsXML *zlstats;
     TriggerStatsXML *sgstats;
+    /* background of single-detector triggers from single-IFO time, only
+     * written once such a trigger has been seen */
+    TriggerStatsXML *snglstats;
+    gboolean have_sngl;
     int source_type; // BNS, NSBH, or BBH
     xmlTextWriterPtr stats_writer;
 
@@ -78,6 +83,8 @@ typedef struct {
      */
     GstClockTime t_end;
     GstClockTime t_roll_start;
+
+    struct gstlal_element_stats *stats;
 } CohfarAccumbackground;
 
 GType cohfar_accumbackground_get_type(void);
@@ -33,6 +33,7 @@
 #include <gst/base/gstbasetransform.h>
 #include <gst/gst.h>
 #include <gstlal/gstlal.h>
+#include <gstlal/gstlal_element_stats.h>
 
 /*
  * stuff from here
@@ -86,7 +87,9 @@ enum property {
     PROP_IFOS,
     PROP_REFRESH_INTERVAL,
     PROP_SILENT_TIME,
-    PROP_INPUT_FNAME
+    PROP_INPUT_FNAME,
+    /* first of the gstlal_element_stats properties */
+    PROP_STATS
 };
 
 static void cohfar_assignfar_set_property(GObject *object,
@@ -180,6 +183,8 @@ static GstFlowReturn cohfar_assignfar_transform_ip(GstBaseTransform *trans,
     CohfarAssignfar *element = COHFAR_ASSIGNFAR(trans);
     GstFlowReturn result     = GST_FLOW_OK;
 
+    gstlal_element_stats_input(element->stats, buf);
+
     GstClockTime t_cur = GST_BUFFER_TIMESTAMP(buf);
     if (!GST_CLOCK_TIME_IS_VALID(element->t_start)) element->t_start = t_cur;
 
@@ -247,7 +252,10 @@ static GstFlowReturn cohfar_assignfar_transform_ip(GstBaseTransform *trans,
         PostcohInspiralTable *table_end =
           (PostcohInspiralTable *)(GST_BUFFER_DATA(buf) + GST_BUFFER_SIZE(buf));
         for (; table < table_end; table++) {
-            if (table->is_background == FLAG_EMPTY) continue;
+            /* no coherent background to rank single-detector triggers */
+            if (table->is_background == FLAG_EMPTY
+                || table->is_background == FLAG_SNGL)
+                continue;
             icombo = get_icombo(table->ifos);
             icombo = scan_trigger_ifos(icombo, table);
             if (icombo < 0) {
@@ -261,6 +269,9 @@ static GstFlowReturn cohfar_assignfar_transform_ip(GstBaseTransform *trans,
         }
     }
 
+    gstlal_element_stats_output(element->stats, GST_BUFFER_TIMESTAMP(buf)
+                                                  + GST_BUFFER_DURATION(buf));
+    gstlal_element_stats_processed(element->stats);
     return result;
 }
 
@@ -337,7 +348,11 @@ static void cohfar_assignfar_set_property(GObject *object,
         element->refresh_interval = g_value_get_int(value);
         break;
 
-    default: G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec); break;
+    default:
+        if (!gstlal_element_stats_set_property(element->stats,
+                                               prop_id - PROP_STATS, value))
+            G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+        break;
     }
 
     GST_OBJECT_UNLOCK(element);
@@ -367,7 +382,11 @@ static void cohfar_assignfar_get_property(GObject *object,
     case PROP_REFRESH_INTERVAL:
         g_value_set_int(value, element->refresh_interval);
         break;
-    default: G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec); break;
+    default:
+        if (!gstlal_element_stats_get_property(element->stats,
+                                               prop_id - PROP_STATS, value))
+            G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+        break;
     }
     GST_OBJECT_UNLOCK(element);
 }
@@ -384,6 +403,8 @@ static void cohfar_assignfar_dispose(GObject *object) {
         trigger_stats_xml_destroy(element->bgstats_1d);
         trigger_stats_xml_destroy(element->bgstats_2h);
     }
+    gstlal_element_stats_free(element->stats);
+    element->stats = NULL;
     G_OBJECT_CLASS(parent_class)->dispose(object);
     g_strfreev(element->input_fnames);
 }
@@ -458,6 +479,10 @@ static void cohfar_assignfar_class_init(CohfarAssignfarClass *klass) {
                        "seconds to accumulate background.",
                        0, G_MAXINT, G_MAXINT,
                        G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+    /* the element holds no data between buffers */
+    /* one buffer out for every buffer in, nothing is held */
+    gstlal_element_stats_install_properties(gobject_class, PROP_STATS, NULL);
 }
 /*
  * init()
@@ -474,4 +499,5 @@ static void cohfar_assignfar_init(CohfarAssignfar *element,
     element->t_roll_start     = GST_CLOCK_TIME_NONE;
     element->pass_silent_time = FALSE;
     element->ninput           = -1;
+    element->stats = gstlal_element_stats_new(GST_ELEMENT(element));
 }
@@ -32,6 +32,7 @@
 #include <glib.h>
 #include <gst/base/gstbasetransform.h>
 #include <gst/gst.h>
+#include <gstlal/gstlal_element_stats.h>
 
 G_BEGIN_DECLS
 #define COHFAR_ASSIGNFAR_TYPE (cohfar_assignfar_get_type())
@@ -72,6 +73,8 @@ typedef struct {
 
     GstClockTime t_start;
     GstClockTime t_roll_start;
+
+    struct gstlal_element_stats *stats;
 } CohfarAssignfar;
 
 GType cohfar_assignfar_get_type(void);
@@ -1,4 +1,9 @@
-gcc -g -c ../ssvkernel.c -I ../ -I ../../LIGOLw_xmllib `pkg-config --libs gstlal` `pkg-config --cflags gstlal`  
-gcc -g -c ../background_stats_utils.c -I ../ -I ../../LIGOLw_xmllib `pkg-config --libs gstlal` `pkg-config --cflags gstlal`  
-gcc -g -c test_write_stats.c `pkg-config --cflags gstlal` `pkg-config --libs gstlal` 
-gcc -g -o test_write test_write_stats.o background_stats_utils.o ssvkernel.o ../../LIGOLw_xmllib/test/LIGOLwUtils.o ../../LIGOLw_xmllib/test/LIGOLwReader.o ../../LIGOLw_xmllib/test/LIGOLwWriter.o `pkg-config --cflags gstlal` `pkg-config --libs gstlal` `pkg-config --libs gsl`
+INC="-I ../.. -I ../../../../include -I ../../../../lib/include"
+gcc -g -c ../ssvkernel.c $INC `pkg-config --cflags gstlal`
+gcc -g -c ../knn_kde.c $INC `pkg-config --cflags gstlal`
+gcc -g -c ../background_stats_utils.c $INC `pkg-config --cflags gstlal`
+gcc -g -c test_write_stats.c $INC `pkg-config --cflags gstlal`
+for f in LIGOLwUtils LIGOLwReader LIGOLwWriter ; do
+	gcc -g -c ../../../../lib/LIGOLw_xmllib/$f.c $INC `pkg-config --cflags gstlal`
+done
+gcc -g -o test_write test_write_stats.o background_stats_utils.o ssvkernel.o knn_kde.o LIGOLwUtils.o LIGOLwReader.o LIGOLwWriter.o `pkg-config --libs gstlal` `pkg-config --libs gsl` -lm
@@ -1,15 +1,42 @@
+/* Writes test_stats.xml.gz, the H1L1 background that gstlal_spiir_bench
+ * loads with --stats.  Every node gets NEVENT noise-like triggers, SNR
+ * with an exponential tail above 4 and reduced chisq scattered about one,
+ * spread over the distribution deterministically so the file is the same
+ * on every machine.  Only the rates are filled; the pdf and rank are built
+ * from them by the reader. */
 
-#include "../../LIGOLw_xmllib/LIGOLwHeader.h"
-#include "../background_stats_utils.h"
+#include <math.h>
+
+#include <LIGOLwHeader.h>
+#include <cohfar/background_stats_utils.h>
+
+#define NEVENT   100000
+#define LIVETIME 1000
+#define GOLDEN   0.6180339887498949
 
 int main(int argc, char *argv[]) {
 
-    char *ifos              = "H1L1";
-    char *output_fname      = "test_stats.xml.gz";
-    BackgroundStats **stats = background_stats_create(ifos);
+    char *ifos             = "H1L1";
+    char *output_fname     = "test_stats.xml.gz";
+    TriggerStatsXML *stats =
+      trigger_stats_xml_create(ifos, STATS_XML_TYPE_BACKGROUND);
+    xmlTextWriterPtr writer = NULL;
+    int inode, ievent;
 
-    gsl_vector_long_set_all(stats[0]->rates->logsnr_bins->data, 125);
-    gsl_matrix_set_all(stats[0]->cdf->data, 0.1);
-    background_stats_to_xml(stats, 1, output_fname);
+    for (inode = 0; inode <= stats->nifo; inode++) {
+        TriggerStats *cur_stats = stats->multistats[inode];
+        for (ievent = 0; ievent < NEVENT; ievent++) {
+            double u     = (ievent + 0.5) / NEVENT;
+            double v     = fmod(ievent * GOLDEN, 1.);
+            double snr   = 4. - log(1. - u);
+            double chisq = exp(v - 0.5) * snr / 4.;
+            trigger_stats_feature_rate_update(snr, chisq, cur_stats->feature,
+                                              cur_stats);
+        }
+        cur_stats->livetime = LIVETIME;
+    }
+    trigger_stats_xml_dump(stats, 1, output_fname, STATS_XML_WRITE_FULL,
+                           &writer);
+    trigger_stats_xml_destroy(stats);
     return 0;
 }
@@ -0,0 +1,223 @@
+/*
+ * Copyright (C) 2026 The SPIIR authors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Backend selection and the host implementation of the compute backend.
+ * The host queue runs every operation on the calling thread in the order it
+ * is issued, so copies and kernels have completed by the time the call
+ * returns and events are no-ops. Kernels are split into contiguous block
+ * ranges that run on a process-wide thread pool, the calling thread taking
+ * one of the ranges itself. */
+
+#include <compute_backend.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+struct _ComputeQueue {
+    gint unused;
+};
+
+struct _ComputeEvent {
+    gint unused;
+};
+
+typedef struct _HostGrid {
+    const ComputeKernel *kernel;
+    gpointer args;
+    gint pending; /* ranges still running on the pool, under host_lock */
+} HostGrid;
+
+typedef struct _HostTask {
+    HostGrid *grid;
+    guint block_start;
+    guint block_end;
+} HostTask;
+
+static GThreadPool *host_pool = NULL;
+static gint host_nthreads     = 0;
+/* shared by every dispatch: a worker finishing the last range of a grid
+ * wakes the waiters, each of which goes back to sleep unless it was its own
+ * grid that completed */
+static GMutex *host_lock = NULL;
+static GCond *host_done  = NULL;
+
+static void host_worker(gpointer data, gpointer user_data) {
+    HostTask *task = data;
+    HostGrid *grid = task->grid;
+
+    grid->kernel->host(task->block_start, task->block_end, grid->args);
+    g_mutex_lock(host_lock);
+    if (--grid->pending == 0) g_cond_broadcast(host_done);
+    g_mutex_unlock(host_lock);
+}
+
+static GThreadPool *host_get_pool(void) {
+    static gsize initialized = 0;
+
+    if (g_once_init_enter(&initialized)) {
+        if (host_nthreads <= 0) {
+            const char *env = getenv("SPIIR_HOST_THREADS");
+            host_nthreads   = env ? atoi(env) : 0;
+        }
+        if (host_nthreads <= 0) host_nthreads = sysconf(_SC_NPROCESSORS_ONLN);
+        if (host_nthreads <= 0) host_nthreads = 1;
+        /* the dispatching thread does one share of the work itself */
+        if (host_nthreads > 1) {
+            host_lock = g_mutex_new();
+            host_done = g_cond_new();
+            host_pool =
+              g_thread_pool_new(host_worker, NULL, host_nthreads - 1, TRUE, NULL);
+        }
+        g_once_init_leave(&initialized, 1);
+    }
+    return host_pool;
+}
+
+/* Must be called before the first kernel is dispatched to have any effect.
+ * Otherwise the thread count is taken from SPIIR_HOST_THREADS or the number
+ * of online processors. */
+void compute_backend_host_set_nthreads(gint nthreads) {
+    host_nthreads = nthreads;
+}
+
+static gint host_device_count(void) { return 1; }
+
+static void host_set_device(gint device_id) {}
+
+static void *host_alloc(gsize size) { return g_malloc(size); }
+
+static void host_free(void *ptr) { g_free(ptr); }
+
+static ComputeQueue *host_queue_new(void) { return g_new0(ComputeQueue, 1); }
+
+static void host_queue_free(ComputeQueue *queue) { g_free(queue); }
+
+static void host_queue_sync(ComputeQueue *queue) {}
+
+static void *host_queue_native(ComputeQueue *queue) { return NULL; }
+
+static void host_copy_async(void *dst,
+                            const void *src,
+                            gsize size,
+                            ComputeCopyKind kind,
+                            ComputeQueue *queue) {
+    memmove(dst, src, size);
+}
+
+static void host_memset_async(void *dst,
+                              gint value,
+                              gsize size,
+                              ComputeQueue *queue) {
+    memset(dst, value, size);
+}
+
+static ComputeEvent *host_event_new(void) { return g_new0(ComputeEvent, 1); }
+
+static void host_event_free(ComputeEvent *event) { g_free(event); }
+
+static void host_event_record(ComputeEvent *event, ComputeQueue *queue) {}
+
+static void host_event_wait(ComputeEvent *event) {}
+
+static gboolean host_dispatch(ComputeQueue *queue,
+                              const ComputeKernel *kernel,
+                              guint nblocks,
+                              gpointer args) {
+    GThreadPool *pool = host_get_pool();
+    HostGrid grid;
+    HostTask *tasks;
+    guint ntasks, per_task, itask;
+
+    if (!kernel->host) return FALSE;
+    if (!nblocks) return TRUE;
+
+    ntasks = MIN(nblocks, (guint)host_nthreads);
+    if (!pool || ntasks == 1) {
+        kernel->host(0, nblocks, args);
+        return TRUE;
+    }
+
+    grid.kernel  = kernel;
+    grid.args    = args;
+    grid.pending = ntasks - 1;
+
+    per_task = (nblocks + ntasks - 1) / ntasks;
+    tasks    = g_new(HostTask, ntasks);
+    for (itask = 0; itask < ntasks; itask++) {
+        tasks[itask].grid        = &grid;
+        tasks[itask].block_start = MIN(itask * per_task, nblocks);
+        tasks[itask].block_end   = MIN((itask + 1) * per_task, nblocks);
+    }
+    for (itask = 1; itask < ntasks; itask++)
+        g_thread_pool_push(pool, &tasks[itask], NULL);
+    kernel->host(tasks[0].block_start, tasks[0].block_end, args);
+
+    g_mutex_lock(host_lock);
+    while (grid.pending) g_cond_wait(host_done, host_lock);
+    g_mutex_unlock(host_lock);
+
+    g_free(tasks);
+    return TRUE;
+}
+
+static const ComputeBackend host_backend = {
+    .type         = COMPUTE_BACKEND_HOST,
+    .name         = "host",
+    .device_count = host_device_count,
+    .set_device   = host_set_device,
+    .host_alloc   = host_alloc,
+    .host_free    = host_free,
+    .device_alloc = host_alloc,
+    .device_free  = host_free,
+    .queue_new    = host_queue_new,
+    .queue_free   = host_queue_free,
+    .queue_sync   = host_queue_sync,
+    .queue_native = host_queue_native,
+    .copy_async   = host_copy_async,
+    .memset_async = host_memset_async,
+    .event_new    = host_event_new,
+    .event_free   = host_event_free,
+    .event_record = host_event_record,
+    .event_wait   = host_event_wait,
+    .dispatch     = host_dispatch,
+};
+
+const ComputeBackend *compute_backend_host(void) { return &host_backend; }
+
+#ifndef SPIIR_HAVE_CUDA
+const ComputeBackend *compute_backend_cuda(void) { return NULL; }
+#endif
+
+/* The CUDA backend if it was built and there is a device to run on,
+ * otherwise the host backend. COMPUTE_BACKEND_ENV overrides the choice. */
+const ComputeBackend *compute_backend_get_default(void) {
+    const ComputeBackend *cuda = compute_backend_cuda();
+    const char *env            = getenv(COMPUTE_BACKEND_ENV);
+
+    if (env && !strcmp(env, "host")) return compute_backend_host();
+    if (env && !strcmp(env, "cuda")) {
+        if (!cuda)
+            fprintf(stderr, "%s=cuda but built without CUDA, using host\n",
+                    COMPUTE_BACKEND_ENV);
+        return cuda ? cuda : compute_backend_host();
+    }
+    if (cuda && cuda->device_count() > 0) return cuda;
+    return compute_backend_host();
+}
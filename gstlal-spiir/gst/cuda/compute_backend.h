@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2026 The SPIIR authors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Device-agnostic compute backend for the SPIIR elements.
+ *
+ * A ComputeBackend is a table of the primitives the elements need from an
+ * accelerator: memory allocation, asynchronous copies, in-order queues
+ * (CUDA streams), events, and kernel dispatch. There are two
+ * implementations:
+ *
+ *   "cuda"  the CUDA runtime, only built when configured --with-cuda
+ *   "host"  ordinary memory, queues that execute on the calling thread and
+ *           kernels that are split into blocks over a shared thread pool
+ *
+ * A kernel is described by a ComputeKernel holding one implementation per
+ * backend. The host implementation is called with a range of block
+ * indices and must be safe to run concurrently on disjoint ranges.
+ *
+ * Not every element runs on both. cuda_iirbank, postcoh_filesink and the
+ * cohfar elements do; cuda_multiratespiir and cuda_postcoh still drive
+ * the CUDA runtime directly for their filtering and coherent search, and
+ * cuda_plugin.c registers them only when the cuda backend is selected.
+ *
+ * Errors are fatal, as with CUDA_CHECK.
+ */
+
+#ifndef __COMPUTE_BACKEND_H__
+#define __COMPUTE_BACKEND_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* environment variable to force the backend choice, "host" or "cuda" */
+#define COMPUTE_BACKEND_ENV "SPIIR_COMPUTE_BACKEND"
+
+typedef enum {
+    COMPUTE_BACKEND_HOST = 1 << 0,
+    COMPUTE_BACKEND_CUDA = 1 << 1,
+} ComputeBackendType;
+
+typedef enum {
+    COMPUTE_COPY_HOST_TO_HOST,
+    COMPUTE_COPY_HOST_TO_DEVICE,
+    COMPUTE_COPY_DEVICE_TO_HOST,
+    COMPUTE_COPY_DEVICE_TO_DEVICE,
+} ComputeCopyKind;
+
+/* opaque, defined by each backend */
+typedef struct _ComputeQueue ComputeQueue;
+typedef struct _ComputeEvent ComputeEvent;
+
+typedef struct _ComputeKernel {
+    const char *name;
+    /* process blocks [block_start, block_end) */
+    void (*host)(guint block_start, guint block_end, gpointer args);
+    /* launch the whole grid on a cudaStream_t, NULL if there is none */
+    void (*cuda)(guint nblocks, gpointer args, void *stream);
+} ComputeKernel;
+
+typedef struct _ComputeBackend {
+    ComputeBackendType type;
+    const char *name;
+
+    gint (*device_count)(void);
+    void (*set_device)(gint device_id);
+
+    /* page-locked host memory where the backend supports it */
+    void *(*host_alloc)(gsize size);
+    void (*host_free)(void *ptr);
+    void *(*device_alloc)(gsize size);
+    void (*device_free)(void *ptr);
+
+    ComputeQueue *(*queue_new)(void);
+    void (*queue_free)(ComputeQueue *queue);
+    /* block until everything queued so far has completed */
+    void (*queue_sync)(ComputeQueue *queue);
+    /* the backend's own handle, e.g. the cudaStream_t */
+    void *(*queue_native)(ComputeQueue *queue);
+
+    void (*copy_async)(void *dst,
+                       const void *src,
+                       gsize size,
+                       ComputeCopyKind kind,
+                       ComputeQueue *queue);
+    void (*memset_async)(void *dst, gint value, gsize size, ComputeQueue *queue);
+
+    ComputeEvent *(*event_new)(void);
+    void (*event_free)(ComputeEvent *event);
+    /* mark the point in queue that event completes at */
+    void (*event_record)(ComputeEvent *event, ComputeQueue *queue);
+    /* block the caller until event has completed */
+    void (*event_wait)(ComputeEvent *event);
+
+    /* returns FALSE if the kernel has no implementation for this backend */
+    gboolean (*dispatch)(ComputeQueue *queue,
+                         const ComputeKernel *kernel,
+                         guint nblocks,
+                         gpointer args);
+} ComputeBackend;
+
+const ComputeBackend *compute_backend_host(void);
+const ComputeBackend *compute_backend_cuda(void);
+const ComputeBackend *compute_backend_get_default(void);
+
+void compute_backend_host_set_nthreads(gint nthreads);
+
+G_END_DECLS
+
+#endif /* __COMPUTE_BACKEND_H__ */
@@ -0,0 +1,161 @@
+/*
+ * Copyright (C) 2026 The SPIIR authors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* CUDA implementation of the compute backend, a thin layer over the CUDA
+ * runtime. A ComputeQueue is a non-blocking cudaStream_t. */
+
+#include <compute_backend.h>
+#include <cuda_debug.h>
+#include <cuda_runtime.h>
+
+struct _ComputeQueue {
+    cudaStream_t stream;
+};
+
+struct _ComputeEvent {
+    cudaEvent_t event;
+};
+
+static gint cuda_device_count(void) {
+    int count = 0;
+    /* no driver or no device is not an error here, it just means this
+     * backend can't be used */
+    if (cudaGetDeviceCount(&count) != cudaSuccess) {
+        cudaGetLastError();
+        return 0;
+    }
+    return count;
+}
+
+static void cuda_set_device(gint device_id) {
+    CUDA_CHECK(cudaSetDevice(device_id));
+}
+
+static void *cuda_host_alloc(gsize size) {
+    void *ptr;
+    CUDA_CHECK(cudaMallocHost(&ptr, size));
+    return ptr;
+}
+
+static void cuda_host_free(void *ptr) {
+    if (ptr) CUDA_CHECK(cudaFreeHost(ptr));
+}
+
+static void *cuda_device_alloc(gsize size) {
+    void *ptr;
+    CUDA_CHECK(cudaMalloc(&ptr, size));
+    return ptr;
+}
+
+static void cuda_device_free(void *ptr) {
+    if (ptr) CUDA_CHECK(cudaFree(ptr));
+}
+
+static ComputeQueue *cuda_queue_new(void) {
+    ComputeQueue *queue = g_new0(ComputeQueue, 1);
+    CUDA_CHECK(cudaStreamCreateWithFlags(&queue->stream, cudaStreamNonBlocking));
+    return queue;
+}
+
+static void cuda_queue_free(ComputeQueue *queue) {
+    CUDA_CHECK(cudaStreamDestroy(queue->stream));
+    g_free(queue);
+}
+
+static void cuda_queue_sync(ComputeQueue *queue) {
+    CUDA_CHECK(cudaStreamSynchronize(queue->stream));
+}
+
+static void *cuda_queue_native(ComputeQueue *queue) {
+    return (void *)queue->stream;
+}
+
+static void cuda_copy_async(void *dst,
+                            const void *src,
+                            gsize size,
+                            ComputeCopyKind kind,
+                            ComputeQueue *queue) {
+    static const enum cudaMemcpyKind cuda_kind[] = {
+        [COMPUTE_COPY_HOST_TO_HOST]     = cudaMemcpyHostToHost,
+        [COMPUTE_COPY_HOST_TO_DEVICE]   = cudaMemcpyHostToDevice,
+        [COMPUTE_COPY_DEVICE_TO_HOST]   = cudaMemcpyDeviceToHost,
+        [COMPUTE_COPY_DEVICE_TO_DEVICE] = cudaMemcpyDeviceToDevice,
+    };
+    CUDA_CHECK(
+      cudaMemcpyAsync(dst, src, size, cuda_kind[kind], queue->stream));
+}
+
+static void cuda_memset_async(void *dst,
+                              gint value,
+                              gsize size,
+                              ComputeQueue *queue) {
+    CUDA_CHECK(cudaMemsetAsync(dst, value, size, queue->stream));
+}
+
+static ComputeEvent *cuda_event_new(void) {
+    ComputeEvent *event = g_new0(ComputeEvent, 1);
+    CUDA_CHECK(cudaEventCreateWithFlags(&event->event, cudaEventDisableTiming));
+    return event;
+}
+
+static void cuda_event_free(ComputeEvent *event) {
+    CUDA_CHECK(cudaEventDestroy(event->event));
+    g_free(event);
+}
+
+static void cuda_event_record(ComputeEvent *event, ComputeQueue *queue) {
+    CUDA_CHECK(cudaEventRecord(event->event, queue->stream));
+}
+
+static void cuda_event_wait(ComputeEvent *event) {
+    CUDA_CHECK(cudaEventSynchronize(event->event));
+}
+
+static gboolean cuda_dispatch(ComputeQueue *queue,
+                              const ComputeKernel *kernel,
+                              guint nblocks,
+                              gpointer args) {
+    if (!kernel->cuda) return FALSE;
+    if (nblocks) kernel->cuda(nblocks, args, (void *)queue->stream);
+    return TRUE;
+}
+
+static const ComputeBackend cuda_backend = {
+    .type         = COMPUTE_BACKEND_CUDA,
+    .name         = "cuda",
+    .device_count = cuda_device_count,
+    .set_device   = cuda_set_device,
+    .host_alloc   = cuda_host_alloc,
+    .host_free    = cuda_host_free,
+    .device_alloc = cuda_device_alloc,
+    .device_free  = cuda_device_free,
+    .queue_new    = cuda_queue_new,
+    .queue_free   = cuda_queue_free,
+    .queue_sync   = cuda_queue_sync,
+    .queue_native = cuda_queue_native,
+    .copy_async   = cuda_copy_async,
+    .memset_async = cuda_memset_async,
+    .event_new    = cuda_event_new,
+    .event_free   = cuda_event_free,
+    .event_record = cuda_event_record,
+    .event_wait   = cuda_event_wait,
+    .dispatch     = cuda_dispatch,
+};
+
+const ComputeBackend *compute_backend_cuda(void) { return &cuda_backend; }
@@ -36,14 +36,19 @@
  * Our own stuff
  */
 
-#include <spiir/spiir.h>
 //#include <audioresample/cuda_gstaudioresample.h>
 //#include <multidownsample/gstlal_multidownsample.h>
 #include <cohfar/cohfar_accumbackground.h>
 #include <cohfar/cohfar_assignfar.h>
+#include <compute_backend.h>
+#include <postcoh/postcoh_filesink.h>
+#include <spiir/spiir.h>
+#ifdef SPIIR_HAVE_CUDA
 #include <multiratespiir/multiratespiir.h>
 #include <postcoh/postcoh.h>
-#include <postcoh/postcoh_filesink.h>
+#endif
+
+#define ANY_BACKEND (COMPUTE_BACKEND_HOST | COMPUTE_BACKEND_CUDA)
 
 /*
  * ============================================================================
@@ -54,30 +59,47 @@
  */
 
 static gboolean plugin_init(GstPlugin *plugin) {
+    const ComputeBackend *backend = compute_backend_get_default();
     struct {
         const gchar *name;
         GType type;
+        /* backends the element can run on */
+        guint backends;
     } * element, elements[] = {
-        { "cuda_iirbank", CUDA_IIRBANK_TYPE },
+        { "cuda_iirbank", CUDA_IIRBANK_TYPE, ANY_BACKEND },
+#ifdef SPIIR_HAVE_CUDA
         //		{"cuda_audioresample", CUDA_AUDIO_RESAMPLE_TYPE},
         //		{"gstlal_multidownsample",
         // GSTLAL_MULTI_DOWNSAMPLE_TYPE},
-        { "cuda_multiratespiir", CUDA_TYPE_MULTIRATESPIIR },
-        { "cuda_postcoh", CUDA_TYPE_POSTCOH },
-        { "postcoh_filesink", POSTCOH_TYPE_FILESINK },
-        { "cohfar_accumbackground", COHFAR_ACCUMBACKGROUND_TYPE },
-        { "cohfar_assignfar", COHFAR_ASSIGNFAR_TYPE },
-        { NULL, 0 },
+        /* these call the CUDA runtime themselves, they have no host path */
+        { "cuda_multiratespiir", CUDA_TYPE_MULTIRATESPIIR,
+          COMPUTE_BACKEND_CUDA },
+        { "cuda_postcoh", CUDA_TYPE_POSTCOH, COMPUTE_BACKEND_CUDA },
+#endif
+        { "postcoh_filesink", POSTCOH_TYPE_FILESINK, ANY_BACKEND },
+        { "cohfar_accumbackground", COHFAR_ACCUMBACKGROUND_TYPE, ANY_BACKEND },
+        { "cohfar_assignfar", COHFAR_ASSIGNFAR_TYPE, ANY_BACKEND },
+        { NULL, 0, 0 },
     };
 
     /*
-     * Tell GStreamer about the elements.
+     * Tell GStreamer about the elements that can run on the selected
+     * compute backend.  The CUDA-only elements are left out on the host
+     * backend, so pipelines that need them fail to build instead of
+     * running somewhere they cannot.
      */
 
-    for (element = elements; element->name; element++)
+    GST_INFO("spiir compute backend: %s", backend->name);
+    for (element = elements; element->name; element++) {
+        if (!(element->backends & backend->type)) {
+            GST_INFO("%s not registered, it does not run on the %s backend",
+                     element->name, backend->name);
+            continue;
+        }
         if (!gst_element_register(plugin, element->name, GST_RANK_NONE,
                                   element->type))
             return FALSE;
+    }
 
     /*
      * Done.
@@ -35,6 +35,7 @@
 #include <gst/base/gstbasetransform.h>
 #include <gst/gst.h>
 #include <gstlal/gstlal.h>
+#include <gstlal/gstlal_element_stats.h>
 #include <math.h>
 #include <multiratespiir/multiratespiir.h>
 #include <multiratespiir/multiratespiir_kernel.h>
@@ -157,7 +158,8 @@ static GstFlowReturn push_with_flag(CudaMultirateSPIIR *element,
               (float *)GST_BUFFER_DATA(subbuf)[0],
               (float *)GST_BUFFER_DATA(subbuf)[1]);
 
-            ret = gst_pad_push(element->srcpad, subbuf);
+            ret = gstlal_element_stats_push(element->stats, element->srcpad,
+                                            subbuf);
             GST_LOG_OBJECT(element, "pushed sub buffer, result = %s",
                            gst_flow_get_name(ret));
             is_buf_intact = 0;
@@ -174,7 +176,8 @@ static GstFlowReturn push_with_flag(CudaMultirateSPIIR *element,
 
     if (is_buf_intact) {
         gst_buffer_ref(outbuf); /* need the transform to free it */
-        ret = gst_pad_push(element->srcpad, outbuf);
+        ret =
+          gstlal_element_stats_push(element->stats, element->srcpad, outbuf);
         GST_LOG_OBJECT(element, "pushed original buffer, result = %s",
                        gst_flow_get_name(ret));
     }
@@ -230,7 +233,22 @@ GST_BOILERPLATE_FULL(CudaMultirateSPIIR,
                      GST_TYPE_BASE_TRANSFORM,
                      additional_initializations);
 
-enum { PROP_0, PROP_IIRBANK_FNAME, PROP_GAP_HANDLE, PROP_STREAM_ID };
+enum {
+    PROP_0,
+    PROP_IIRBANK_FNAME,
+    PROP_GAP_HANDLE,
+    PROP_STREAM_ID,
+    PROP_CHECKPOINT_FNAME,
+    PROP_CHECKPOINT_INTERVAL,
+    /* first of the gstlal_element_stats properties */
+    PROP_STATS
+};
+
+enum cuda_multiratespiir_signal { SIGNAL_CHECKPOINT, NUM_SIGNALS };
+
+static guint signals[NUM_SIGNALS] = {
+    0,
+};
 
 // FIXME: not support width=64 yet
 static GstStaticPadTemplate cuda_multiratespiir_sink_template =
@@ -261,6 +279,7 @@ static void cuda_multiratespiir_get_property(GObject *object,
                                              guint prop_id,
                                              GValue *value,
                                              GParamSpec *pspec);
+static void cuda_multiratespiir_finalize(GObject *object);
 
 /* vmethods */
 static gboolean cuda_multiratespiir_get_unit_size(GstBaseTransform *base,
@@ -289,6 +308,8 @@ static gboolean cuda_multiratespiir_stop(GstBaseTransform *base);
 // static gboolean cuda_multiratespiir_query (GstPad * pad, GstQuery * query);
 // static const GstQueryType *cuda_multiratespiir_query_type (GstPad * pad);
 
+static void cuda_multiratespiir_checkpoint(CudaMultirateSPIIR *element);
+
 static void cuda_multiratespiir_base_init(gpointer g_class) {
     GstElementClass *gstelement_class = GST_ELEMENT_CLASS(g_class);
 
@@ -330,6 +351,7 @@ static void cuda_multiratespiir_class_init(CudaMultirateSPIIRClass *klass) {
       GST_DEBUG_FUNCPTR(cuda_multiratespiir_set_property);
     gobject_class->get_property =
       GST_DEBUG_FUNCPTR(cuda_multiratespiir_get_property);
+    gobject_class->finalize = GST_DEBUG_FUNCPTR(cuda_multiratespiir_finalize);
 
     g_object_class_install_property(
       gobject_class, PROP_IIRBANK_FNAME,
@@ -349,6 +371,35 @@ static void cuda_multiratespiir_class_init(CudaMultirateSPIIRClass *klass) {
       g_param_spec_int("stream-id", "id for cuda stream", "id for cuda stream",
                        0, G_MAXINT, 0,
                        G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+    g_object_class_install_property(
+      gobject_class, PROP_CHECKPOINT_FNAME,
+      g_param_spec_string(
+        "checkpoint-fname", "Filter state checkpoint file",
+        "The filter state is written to this file on request and every "
+        "checkpoint-interval seconds, and restored from it at start if the "
+        "input resumes where the checkpoint left off.",
+        NULL, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+    g_object_class_install_property(
+      gobject_class, PROP_CHECKPOINT_INTERVAL,
+      g_param_spec_int("checkpoint-interval", "Checkpoint interval",
+                       "Seconds of data between filter state checkpoints, 0 "
+                       "to write them only when the checkpoint signal is "
+                       "emitted and at EOS.",
+                       0, G_MAXINT, 0,
+                       G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+    /* the queue level is the input waiting in the adapter */
+    gstlal_element_stats_install_properties(gobject_class, PROP_STATS,
+                                            "samples");
+
+    klass->checkpoint = GST_DEBUG_FUNCPTR(cuda_multiratespiir_checkpoint);
+    signals[SIGNAL_CHECKPOINT] = g_signal_new(
+      "checkpoint", G_TYPE_FROM_CLASS(klass),
+      G_SIGNAL_RUN_LAST | G_SIGNAL_ACTION,
+      G_STRUCT_OFFSET(CudaMultirateSPIIRClass, checkpoint), NULL, NULL,
+      g_cclosure_marshal_VOID__VOID, G_TYPE_NONE, 0);
 }
 
 static void cuda_multiratespiir_init(CudaMultirateSPIIR *element,
@@ -365,6 +416,9 @@ static void cuda_multiratespiir_init(CudaMultirateSPIIR *element,
     element->num_head_cover_samples =
       13120; // assumes the rate=4096Hz, down quality = 9
     element->num_tail_cover_samples = 13104; // assumes the rate=4096Hz
+    element->checkpoint_fname        = NULL;
+    element->checkpoint_interval     = 0;
+    element->checkpoint_requested    = 0;
 
     //  gst_base_transform_set_gap_aware (trans, TRUE);
     //  gst_pad_set_query_function (trans->srcpad, cuda_multiratespiir_query);
@@ -375,6 +429,18 @@ static void cuda_multiratespiir_init(CudaMultirateSPIIR *element,
     element->h_snglsnr_buffer   = NULL;
     element->len_snglsnr_buffer = 0;
     element->srcpad             = gst_element_get_static_pad(element, "src");
+    element->stats = gstlal_element_stats_new(GST_ELEMENT(element));
+}
+
+static void cuda_multiratespiir_finalize(GObject *object) {
+    CudaMultirateSPIIR *element = CUDA_MULTIRATESPIIR(object);
+
+    gstlal_element_stats_free(element->stats);
+    element->stats = NULL;
+    g_free(element->checkpoint_fname);
+    element->checkpoint_fname = NULL;
+
+    G_OBJECT_CLASS(parent_class)->finalize(object);
 }
 
 /* vmethods */
@@ -392,6 +458,10 @@ static gboolean cuda_multiratespiir_start(GstBaseTransform *base) {
     element->next_in_offset  = GST_BUFFER_OFFSET_NONE;
     element->samples_in      = 0;
     element->samples_out     = 0;
+
+    element->checkpoint_tried     = FALSE;
+    element->next_in_time         = GST_CLOCK_TIME_NONE;
+    element->last_checkpoint_time = GST_CLOCK_TIME_NONE;
     return TRUE;
 }
 
@@ -677,7 +747,8 @@ static GstFlowReturn cuda_multiratespiir_push_gap(CudaMultirateSPIIR *element,
     // FIXME: no sanity check
     res = cuda_multiratespiir_assemble_gap_buffer(element, gap_len, gapbuf);
 
-    res = gst_pad_push(GST_BASE_TRANSFORM_SRC_PAD(element), gapbuf);
+    res = gstlal_element_stats_push(
+      element->stats, GST_BASE_TRANSFORM_SRC_PAD(element), gapbuf);
 
     if (G_UNLIKELY(res != GST_FLOW_OK))
         GST_WARNING_OBJECT(element, "Failed to push gap: %s",
@@ -819,7 +890,8 @@ static GstFlowReturn cuda_multiratespiir_push_drain(CudaMultirateSPIIR *element,
         return GST_BASE_TRANSFORM_FLOW_DROPPED;
     }
 
-    res = gst_pad_push(GST_BASE_TRANSFORM_SRC_PAD(element), outbuf);
+    res = gstlal_element_stats_push(
+      element->stats, GST_BASE_TRANSFORM_SRC_PAD(element), outbuf);
 
     if (G_UNLIKELY(res != GST_FLOW_OK))
         GST_WARNING_OBJECT(element, "Failed to push drain: %s",
@@ -991,9 +1063,220 @@ static void adapter_push_zeros(CudaMultirateSPIIR *element, unsigned samples) {
     gst_adapter_push(element->adapter, zerobuf);
 }
 
-static GstFlowReturn cuda_multiratespiir_transform(GstBaseTransform *base,
-                                                   GstBuffer *inbuf,
-                                                   GstBuffer *outbuf) {
+/*
+ * filter state checkpoints. They are taken between input buffers, when the
+ * device state, the adapter and the flag segments agree with each other and
+ * the next input is expected at next_in_offset and next_in_time.
+ */
+
+static gchar *cuda_multiratespiir_dup_checkpoint_fname(
+  CudaMultirateSPIIR *element) {
+    gchar *fname;
+
+    GST_OBJECT_LOCK(element);
+    fname = g_strdup(element->checkpoint_fname);
+    GST_OBJECT_UNLOCK(element);
+    return fname;
+}
+
+static void cuda_multiratespiir_write_checkpoint(CudaMultirateSPIIR *element) {
+    SpiirCheckpointDepthInfo *info;
+    SpiirCheckpoint *ckpt;
+    FlagSegment *segments;
+    guint num_pending, i;
+    GError *error = NULL;
+    gchar *fname  = cuda_multiratespiir_dup_checkpoint_fname(element);
+
+    if (!fname) {
+        GST_WARNING_OBJECT(element, "no checkpoint-fname, checkpoint skipped");
+        return;
+    }
+
+    info = g_new(SpiirCheckpointDepthInfo, element->num_depths);
+    spiir_state_get_checkpoint_info(element->spstate, element->num_depths,
+                                    info);
+    num_pending = cuda_multiratespiir_get_available_samples(element);
+    ckpt = spiir_checkpoint_new(element->num_depths, element->rate, info,
+                                num_pending, element->flag_segments->len);
+    g_free(info);
+
+    spiir_state_save(element->spstate, element->num_depths, ckpt,
+                     element->stream);
+
+    ckpt->stream.t0              = element->t0;
+    ckpt->stream.offset0         = element->offset0;
+    ckpt->stream.samples_in      = element->samples_in;
+    ckpt->stream.samples_out     = element->samples_out;
+    ckpt->stream.next_in_offset  = element->next_in_offset;
+    ckpt->stream.next_in_time    = element->next_in_time;
+    ckpt->stream.num_gap_samples = element->num_gap_samples;
+    ckpt->stream.num_exe_samples = element->num_exe_samples;
+    ckpt->stream.need_tail_drain = element->need_tail_drain;
+    if (num_pending > 0)
+        memcpy(ckpt->pending,
+               gst_adapter_peek(element->adapter, num_pending * sizeof(float)),
+               num_pending * sizeof(float));
+    segments = (FlagSegment *)element->flag_segments->data;
+    for (i = 0; i < element->flag_segments->len; i++) {
+        ckpt->segments[i].start  = segments[i].start;
+        ckpt->segments[i].stop   = segments[i].stop;
+        ckpt->segments[i].is_gap = segments[i].is_gap;
+    }
+
+    if (spiir_checkpoint_write(ckpt, fname, &error) < 0) {
+        GST_WARNING_OBJECT(element, "checkpoint skipped: %s", error->message);
+        g_error_free(error);
+    } else
+        GST_INFO_OBJECT(element,
+                        "checkpointed filter state to %s, next input at "
+                        "%" GST_TIME_FORMAT,
+                        fname, GST_TIME_ARGS(element->next_in_time));
+
+    spiir_checkpoint_free(ckpt);
+    g_free(fname);
+}
+
+/* after a buffer has been transformed, write a checkpoint if one was
+ * requested or checkpoint-interval seconds of data have gone by */
+static void cuda_multiratespiir_maybe_checkpoint(CudaMultirateSPIIR *element) {
+    gint interval;
+    gboolean due;
+
+    if (!GST_CLOCK_TIME_IS_VALID(element->t0)
+        || !GST_CLOCK_TIME_IS_VALID(element->next_in_time))
+        return;
+    if (!GST_CLOCK_TIME_IS_VALID(element->last_checkpoint_time))
+        element->last_checkpoint_time = element->next_in_time;
+
+    GST_OBJECT_LOCK(element);
+    interval = element->checkpoint_interval;
+    GST_OBJECT_UNLOCK(element);
+
+    due = g_atomic_int_compare_and_exchange(&element->checkpoint_requested, 1,
+                                            0);
+    if (interval > 0
+        && element->next_in_time
+             >= element->last_checkpoint_time + interval * GST_SECOND)
+        due = TRUE;
+    if (!due) return;
+
+    cuda_multiratespiir_write_checkpoint(element);
+    element->last_checkpoint_time = element->next_in_time;
+}
+
+/* the action signal can come from any thread, the checkpoint is written by
+ * the streaming thread after the buffer it is working on */
+static void cuda_multiratespiir_checkpoint(CudaMultirateSPIIR *element) {
+    g_atomic_int_set(&element->checkpoint_requested, 1);
+}
+
+/*
+ * on the first discontinuity after start, resume from the checkpoint if it
+ * was taken with the same bank and inbuf is the buffer it expects next.
+ * Returns FALSE if the element has to start cold.
+ */
+static gboolean
+cuda_multiratespiir_restore_checkpoint(CudaMultirateSPIIR *element,
+                                       GstBuffer *inbuf) {
+    SpiirCheckpointDepthInfo *info;
+    SpiirCheckpoint *ckpt = NULL;
+    gboolean matches;
+    guint i;
+    GError *error = NULL;
+    gchar *fname  = cuda_multiratespiir_dup_checkpoint_fname(element);
+
+    element->checkpoint_tried = TRUE;
+    if (!fname) return FALSE;
+
+    ckpt = spiir_checkpoint_read(fname, &error);
+    if (!ckpt) {
+        /* no checkpoint yet is the normal first start */
+        if (g_error_matches(error, G_FILE_ERROR, G_FILE_ERROR_NOENT))
+            GST_INFO_OBJECT(element, "no checkpoint restored: %s",
+                            error->message);
+        else
+            GST_WARNING_OBJECT(element, "%s, starting cold", error->message);
+        g_error_free(error);
+        goto cold;
+    }
+
+    info = g_new(SpiirCheckpointDepthInfo, element->num_depths);
+    spiir_state_get_checkpoint_info(element->spstate, element->num_depths,
+                                    info);
+    matches = spiir_checkpoint_matches(ckpt, element->num_depths,
+                                       element->rate, info);
+    g_free(info);
+    if (!matches) {
+        GST_WARNING_OBJECT(element,
+                           "checkpoint %s was taken with another bank, "
+                           "starting cold",
+                           fname);
+        goto cold;
+    }
+    if (GST_BUFFER_OFFSET(inbuf) != ckpt->stream.next_in_offset
+        || GST_BUFFER_TIMESTAMP(inbuf) != ckpt->stream.next_in_time) {
+        GST_WARNING_OBJECT(
+          element,
+          "checkpoint %s continues at %" GST_TIME_FORMAT
+          ", offset %" G_GUINT64_FORMAT " but input starts at %" GST_TIME_FORMAT
+          ", offset %" G_GUINT64_FORMAT ", starting cold",
+          fname, GST_TIME_ARGS(ckpt->stream.next_in_time),
+          ckpt->stream.next_in_offset,
+          GST_TIME_ARGS(GST_BUFFER_TIMESTAMP(inbuf)), GST_BUFFER_OFFSET(inbuf));
+        goto cold;
+    }
+
+    spiir_state_restore(element->spstate, element->num_depths, ckpt,
+                        element->stream);
+
+    element->t0              = ckpt->stream.t0;
+    element->offset0         = ckpt->stream.offset0;
+    element->samples_in      = ckpt->stream.samples_in;
+    element->samples_out     = ckpt->stream.samples_out;
+    element->num_gap_samples = ckpt->stream.num_gap_samples;
+    element->need_tail_drain = ckpt->stream.need_tail_drain;
+    cuda_multiratespiir_update_exe_samples(&element->num_exe_samples,
+                                           ckpt->stream.num_exe_samples);
+
+    gst_adapter_clear(element->adapter);
+    if (ckpt->stream.num_pending > 0) {
+        GstBuffer *pending =
+          gst_buffer_new_and_alloc(ckpt->stream.num_pending * sizeof(float));
+        memcpy(GST_BUFFER_DATA(pending), ckpt->pending,
+               GST_BUFFER_SIZE(pending));
+        gst_adapter_push(element->adapter, pending);
+    }
+    g_array_set_size(element->flag_segments, 0);
+    for (i = 0; i < ckpt->stream.num_segments; i++) {
+        FlagSegment segment = { .start  = ckpt->segments[i].start,
+                                .stop   = ckpt->segments[i].stop,
+                                .is_gap = ckpt->segments[i].is_gap };
+        g_array_append_val(element->flag_segments, segment);
+    }
+
+    /* downstream has restarted too */
+    element->need_discont         = TRUE;
+    element->last_checkpoint_time = ckpt->stream.next_in_time;
+
+    GST_INFO_OBJECT(element,
+                    "restored filter state from %s, resuming at "
+                    "%" GST_TIME_FORMAT " with %u samples pending",
+                    fname, GST_TIME_ARGS(ckpt->stream.next_in_time),
+                    ckpt->stream.num_pending);
+    spiir_checkpoint_free(ckpt);
+    g_free(fname);
+    return TRUE;
+
+cold:
+    spiir_checkpoint_free(ckpt);
+    g_free(fname);
+    return FALSE;
+}
+
+static GstFlowReturn
+cuda_multiratespiir_transform_buffer(GstBaseTransform *base,
+                                     GstBuffer *inbuf,
+                                     GstBuffer *outbuf) {
     /*
      * output buffer is generated in cuda_multiratespiir_process function.
      */
@@ -1032,7 +1315,9 @@ static GstFlowReturn cuda_multiratespiir_transform(GstBaseTransform *base,
 
     if (G_UNLIKELY(GST_BUFFER_IS_DISCONT(inbuf)
                    || GST_BUFFER_OFFSET(inbuf) != element->next_in_offset
-                   || !GST_CLOCK_TIME_IS_VALID(element->t0))) {
+                   || !GST_CLOCK_TIME_IS_VALID(element->t0))
+        && !(G_UNLIKELY(!element->checkpoint_tried)
+             && cuda_multiratespiir_restore_checkpoint(element, inbuf))) {
         GST_DEBUG_OBJECT(element, "reset spstate");
         spiir_state_reset(element->spstate, element->num_depths,
                           element->stream);
@@ -1062,6 +1347,8 @@ static GstFlowReturn cuda_multiratespiir_transform(GstBaseTransform *base,
     }
 
     element->next_in_offset = GST_BUFFER_OFFSET_END(inbuf);
+    element->next_in_time =
+      GST_BUFFER_TIMESTAMP(inbuf) + GST_BUFFER_DURATION(inbuf);
 
     /* 0-length buffers are produced to inform downstreams for current timestamp
      */
@@ -1293,6 +1580,28 @@ static GstFlowReturn cuda_multiratespiir_transform(GstBaseTransform *base,
     return GST_FLOW_OK;
 }
 
+/*
+ * outputs are pushed from inside cuda_multiratespiir_transform_buffer() with
+ * gstlal_element_stats_push(), so the processing time recorded here leaves
+ * out the time spent downstream
+ */
+static GstFlowReturn cuda_multiratespiir_transform(GstBaseTransform *base,
+                                                   GstBuffer *inbuf,
+                                                   GstBuffer *outbuf) {
+    CudaMultirateSPIIR *element = CUDA_MULTIRATESPIIR(base);
+    GstFlowReturn res;
+
+    gstlal_element_stats_input(element->stats, inbuf);
+    res = cuda_multiratespiir_transform_buffer(base, inbuf, outbuf);
+    if (res == GST_FLOW_OK || res == GST_BASE_TRANSFORM_FLOW_DROPPED)
+        cuda_multiratespiir_maybe_checkpoint(element);
+    gstlal_element_stats_queue_level(
+      element->stats, cuda_multiratespiir_get_available_samples(element));
+    gstlal_element_stats_processed(element->stats);
+
+    return res;
+}
+
 static gboolean cuda_multiratespiir_event(GstBaseTransform *base,
                                           GstEvent *event) {
     CudaMultirateSPIIR *element = CUDA_MULTIRATESPIIR(base);
@@ -1360,6 +1669,11 @@ static gboolean cuda_multiratespiir_event(GstBaseTransform *base,
         GST_DEBUG_OBJECT(element, "EVENT EOS");
         if (element->need_tail_drain) {
             CUDA_CHECK(cudaSetDevice(element->deviceID));
+            /* the drain below runs zeros through the filters, keep the
+             * state the stream can be resumed from */
+            if (element->checkpoint_fname
+                && GST_CLOCK_TIME_IS_VALID(element->next_in_time))
+                cuda_multiratespiir_write_checkpoint(element);
             if (element->num_gap_samples >= element->num_tail_cover_samples) {
                 GST_DEBUG_OBJECT(element,
                                  "EOS, clear tails by pushing gap, num gap "
@@ -1472,7 +1786,20 @@ static void cuda_multiratespiir_set_property(GObject *object,
 
     case PROP_STREAM_ID: element->stream_id = g_value_get_int(value); break;
 
-    default: G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec); break;
+    case PROP_CHECKPOINT_FNAME:
+        g_free(element->checkpoint_fname);
+        element->checkpoint_fname = g_value_dup_string(value);
+        break;
+
+    case PROP_CHECKPOINT_INTERVAL:
+        element->checkpoint_interval = g_value_get_int(value);
+        break;
+
+    default:
+        if (!gstlal_element_stats_set_property(element->stats,
+                                               prop_id - PROP_STATS, value))
+            G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+        break;
     }
     GST_OBJECT_UNLOCK(element);
 }
@@ -1497,7 +1824,19 @@ static void cuda_multiratespiir_get_property(GObject *object,
 
     case PROP_STREAM_ID: g_value_set_int(value, element->stream_id); break;
 
-    default: G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec); break;
+    case PROP_CHECKPOINT_FNAME:
+        g_value_set_string(value, element->checkpoint_fname);
+        break;
+
+    case PROP_CHECKPOINT_INTERVAL:
+        g_value_set_int(value, element->checkpoint_interval);
+        break;
+
+    default:
+        if (!gstlal_element_stats_get_property(element->stats,
+                                               prop_id - PROP_STATS, value))
+            G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+        break;
     }
 
     GST_OBJECT_UNLOCK(element);
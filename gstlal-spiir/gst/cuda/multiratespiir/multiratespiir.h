@@ -25,6 +25,7 @@
 #include <gst/base/gstadapter.h>
 #include <gst/base/gstbasetransform.h>
 #include <gst/gst.h>
+#include <gstlal/gstlal_element_stats.h>
 
 G_BEGIN_DECLS
 
@@ -154,14 +155,26 @@ struct _CudaMultirateSPIIR {
 
     gint gap_handle;
 
+    /* filter state checkpoints, see multiratespiir_checkpoint.h */
+    gchar *checkpoint_fname;
+    gint checkpoint_interval; /* seconds, 0 to only write on request */
+    volatile gint checkpoint_requested;
+    gboolean checkpoint_tried; /* looked for one to restore since start */
+    GstClockTime next_in_time;
+    GstClockTime last_checkpoint_time;
+
     // for ACCELERATE_MULTIRATESPIIR_MEMORY_COPY
     float *h_snglsnr_buffer;
     int len_snglsnr_buffer;
     double offset_per_nanosecond;
+
+    struct gstlal_element_stats *stats;
 };
 
 struct _CudaMultirateSPIIRClass {
     GstBaseTransformClass parent_class;
+
+    void (*checkpoint)(CudaMultirateSPIIR *element);
 };
 
 GType cuda_multiratespiir_get_type(void);
@@ -0,0 +1,264 @@
+/*
+ * Copyright (C) 2026 The gstlal authors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <errno.h>
+#include <multiratespiir/multiratespiir_checkpoint.h>
+#include <stdio.h>
+#include <string.h>
+
+/* number of floats in each array of a depth */
+static gsize depth_y_len(const SpiirCheckpointDepthInfo *info) {
+    return 2 * (gsize)info->num_filters * (gsize)info->num_templates;
+}
+
+static gsize depth_down_len(const SpiirCheckpointDepthInfo *info) {
+    return (gsize)info->down_mem_len * (gsize)info->down_channels;
+}
+
+static gsize depth_up_len(const SpiirCheckpointDepthInfo *info) {
+    return (gsize)info->up_mem_len * (gsize)info->up_channels;
+}
+
+/* refuse shapes no bank has, so a damaged file can not make us allocate
+ * gigabytes */
+static gboolean depth_info_is_sane(const SpiirCheckpointDepthInfo *info) {
+    const gint32 max_len = 1 << 28;
+
+    if (info->num_filters < 0 || info->num_templates < 0
+        || info->queue_len < 0 || info->down_mem_len < 0
+        || info->down_channels < 0 || info->up_mem_len < 0
+        || info->up_channels < 0)
+        return FALSE;
+    return depth_y_len(info) < max_len && info->queue_len < max_len
+           && depth_down_len(info) < max_len && depth_up_len(info) < max_len;
+}
+
+SpiirCheckpoint *spiir_checkpoint_new(guint num_depths,
+                                      gint rate,
+                                      const SpiirCheckpointDepthInfo *info,
+                                      guint num_pending,
+                                      guint num_segments) {
+    SpiirCheckpoint *ckpt = g_new0(SpiirCheckpoint, 1);
+    guint i;
+
+    ckpt->num_depths = num_depths;
+    ckpt->rate       = rate;
+    ckpt->depths     = g_new0(SpiirCheckpointDepth, num_depths);
+    for (i = 0; i < num_depths; i++) {
+        SpiirCheckpointDepth *depth = &ckpt->depths[i];
+        depth->info                 = info[i];
+        depth->y                    = g_new0(float, depth_y_len(&info[i]));
+        depth->queue                = g_new0(float, info[i].queue_len);
+        depth->down_mem             = g_new0(float, depth_down_len(&info[i]));
+        depth->up_mem               = g_new0(float, depth_up_len(&info[i]));
+    }
+    ckpt->stream.num_pending  = num_pending;
+    ckpt->stream.num_segments = num_segments;
+    ckpt->pending             = g_new0(float, num_pending);
+    ckpt->segments            = g_new0(SpiirCheckpointSegment, num_segments);
+    return ckpt;
+}
+
+void spiir_checkpoint_free(SpiirCheckpoint *ckpt) {
+    guint i;
+
+    if (!ckpt) return;
+    for (i = 0; i < ckpt->num_depths; i++) {
+        g_free(ckpt->depths[i].y);
+        g_free(ckpt->depths[i].queue);
+        g_free(ckpt->depths[i].down_mem);
+        g_free(ckpt->depths[i].up_mem);
+    }
+    g_free(ckpt->depths);
+    g_free(ckpt->pending);
+    g_free(ckpt->segments);
+    g_free(ckpt);
+}
+
+gboolean spiir_checkpoint_matches(const SpiirCheckpoint *ckpt,
+                                  guint num_depths,
+                                  gint rate,
+                                  const SpiirCheckpointDepthInfo *info) {
+    guint i;
+
+    if (ckpt->num_depths != num_depths || ckpt->rate != rate) return FALSE;
+    for (i = 0; i < num_depths; i++) {
+        const SpiirCheckpointDepthInfo *saved = &ckpt->depths[i].info;
+        if (saved->num_filters != info[i].num_filters
+            || saved->num_templates != info[i].num_templates
+            || saved->delay_max != info[i].delay_max
+            || saved->queue_len != info[i].queue_len
+            || saved->down_channels != info[i].down_channels
+            || saved->down_mem_len != info[i].down_mem_len
+            || saved->up_channels != info[i].up_channels
+            || saved->up_mem_len != info[i].up_mem_len)
+            return FALSE;
+    }
+    return TRUE;
+}
+
+static int write_block(FILE *fp, const void *data, gsize size) {
+    if (size == 0) return 0;
+    return fwrite(data, size, 1, fp) == 1 ? 0 : -1;
+}
+
+static int read_block(FILE *fp, void *data, gsize size) {
+    if (size == 0) return 0;
+    return fread(data, size, 1, fp) == 1 ? 0 : -1;
+}
+
+int spiir_checkpoint_write(const SpiirCheckpoint *ckpt,
+                           const char *fname,
+                           GError **error) {
+    SpiirCheckpointHeader header;
+    GString *tmp_fname = g_string_new(fname);
+    FILE *fp;
+    guint i;
+    int ret = 0;
+
+    g_string_append(tmp_fname, ".next");
+    fp = g_fopen(tmp_fname->str, "wb");
+    if (!fp) {
+        int saved_errno = errno;
+        g_set_error(error, G_FILE_ERROR, g_file_error_from_errno(saved_errno),
+                    "unable to open %s: %s", tmp_fname->str,
+                    g_strerror(saved_errno));
+        g_string_free(tmp_fname, TRUE);
+        return -1;
+    }
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SPIIR_CHECKPOINT_MAGIC, sizeof(header.magic));
+    header.version    = SPIIR_CHECKPOINT_VERSION;
+    header.num_depths = ckpt->num_depths;
+    header.rate       = ckpt->rate;
+
+    ret |= write_block(fp, &header, sizeof(header));
+    ret |= write_block(fp, &ckpt->stream, sizeof(ckpt->stream));
+    for (i = 0; i < ckpt->num_depths && !ret; i++) {
+        const SpiirCheckpointDepth *depth = &ckpt->depths[i];
+        ret |= write_block(fp, &depth->info, sizeof(depth->info));
+        ret |= write_block(fp, depth->y,
+                           depth_y_len(&depth->info) * sizeof(float));
+        ret |= write_block(fp, depth->queue,
+                           depth->info.queue_len * sizeof(float));
+        ret |= write_block(fp, depth->down_mem,
+                           depth_down_len(&depth->info) * sizeof(float));
+        ret |= write_block(fp, depth->up_mem,
+                           depth_up_len(&depth->info) * sizeof(float));
+    }
+    ret |= write_block(fp, ckpt->pending,
+                       ckpt->stream.num_pending * sizeof(float));
+    ret |=
+      write_block(fp, ckpt->segments,
+                  ckpt->stream.num_segments * sizeof(SpiirCheckpointSegment));
+
+    if (fclose(fp) != 0) ret = -1;
+    if (ret != 0)
+        g_set_error(error, G_FILE_ERROR, G_FILE_ERROR_IO,
+                    "unable to write %s", tmp_fname->str);
+    else if (g_rename(tmp_fname->str, fname) != 0) {
+        int saved_errno = errno;
+        g_set_error(error, G_FILE_ERROR, g_file_error_from_errno(saved_errno),
+                    "unable to rename %s to %s: %s", tmp_fname->str, fname,
+                    g_strerror(saved_errno));
+        ret = -1;
+    }
+    if (ret != 0) g_unlink(tmp_fname->str);
+    g_string_free(tmp_fname, TRUE);
+    return ret == 0 ? 0 : -1;
+}
+
+SpiirCheckpoint *spiir_checkpoint_read(const char *fname, GError **error) {
+    SpiirCheckpointHeader header;
+    SpiirCheckpointStream stream;
+    SpiirCheckpointDepthInfo *info = NULL;
+    SpiirCheckpoint *ckpt          = NULL;
+    long arrays_start;
+    FILE *fp;
+    guint i;
+
+    fp = g_fopen(fname, "rb");
+    if (!fp) {
+        int saved_errno = errno;
+        g_set_error(error, G_FILE_ERROR, g_file_error_from_errno(saved_errno),
+                    "unable to open %s: %s", fname, g_strerror(saved_errno));
+        return NULL;
+    }
+
+    if (read_block(fp, &header, sizeof(header))
+        || strncmp(header.magic, SPIIR_CHECKPOINT_MAGIC, sizeof(header.magic))
+        || header.version != SPIIR_CHECKPOINT_VERSION
+        || header.num_depths > 64)
+        goto read_failed;
+    if (read_block(fp, &stream, sizeof(stream))
+        || stream.num_pending > (1u << 28) || stream.num_segments > (1u << 20))
+        goto read_failed;
+
+    /* the shapes come first in every depth, so look them all up before
+     * allocating, then go back for the arrays */
+    arrays_start = ftell(fp);
+    info         = g_new0(SpiirCheckpointDepthInfo, header.num_depths);
+    for (i = 0; i < header.num_depths; i++) {
+        if (read_block(fp, &info[i], sizeof(info[i]))
+            || !depth_info_is_sane(&info[i]))
+            goto read_failed;
+        if (fseek(fp,
+                  (long)((depth_y_len(&info[i]) + info[i].queue_len
+                          + depth_down_len(&info[i]) + depth_up_len(&info[i]))
+                         * sizeof(float)),
+                  SEEK_CUR))
+            goto read_failed;
+    }
+    if (fseek(fp, arrays_start, SEEK_SET)) goto read_failed;
+
+    ckpt = spiir_checkpoint_new(header.num_depths, header.rate, info,
+                                stream.num_pending, stream.num_segments);
+    ckpt->stream = stream;
+    for (i = 0; i < ckpt->num_depths; i++) {
+        SpiirCheckpointDepth *depth = &ckpt->depths[i];
+        if (read_block(fp, &depth->info, sizeof(depth->info))
+            || read_block(fp, depth->y,
+                          depth_y_len(&info[i]) * sizeof(float))
+            || read_block(fp, depth->queue, info[i].queue_len * sizeof(float))
+            || read_block(fp, depth->down_mem,
+                          depth_down_len(&info[i]) * sizeof(float))
+            || read_block(fp, depth->up_mem,
+                          depth_up_len(&info[i]) * sizeof(float)))
+            goto read_failed;
+    }
+    if (read_block(fp, ckpt->pending, stream.num_pending * sizeof(float))
+        || read_block(fp, ckpt->segments,
+                      stream.num_segments * sizeof(SpiirCheckpointSegment)))
+        goto read_failed;
+
+    g_free(info);
+    fclose(fp);
+    return ckpt;
+
+read_failed:
+    g_set_error(error, G_FILE_ERROR, G_FILE_ERROR_INVAL,
+                "%s is not a usable filter state checkpoint", fname);
+    spiir_checkpoint_free(ckpt);
+    g_free(info);
+    fclose(fp);
+    return NULL;
+}
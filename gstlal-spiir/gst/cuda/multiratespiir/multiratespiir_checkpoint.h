@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2026 The gstlal authors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __CUDA_MULTIRATESPIIR_CHECKPOINT_H__
+#define __CUDA_MULTIRATESPIIR_CHECKPOINT_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/*
+ * filter state checkpoints of cuda_multiratespiir: a SpiirCheckpointHeader,
+ * the SpiirCheckpointStream book-keeping of the element, then for every depth
+ * its SpiirCheckpointDepthInfo followed by the IIR outputs, the queue and the
+ * memories of the down and up resamplers, then the input waiting in the
+ * adapter and the flag segments covering it. Native byte order, the files are
+ * meant for the host and build that wrote them.
+ *
+ * The state is held in host memory so checkpoints can be written, read and
+ * checked without a GPU; spiir_state_save() and spiir_state_restore() in
+ * multiratespiir_utils.c move it to and from the device.
+ */
+#define SPIIR_CHECKPOINT_MAGIC   "SPIIRCKP"
+#define SPIIR_CHECKPOINT_VERSION 1
+
+typedef struct _SpiirCheckpointHeader {
+    char magic[8];
+    guint32 version;
+    guint32 num_depths;
+    gint32 rate;
+    guint32 reserved;
+} SpiirCheckpointHeader;
+
+typedef struct _SpiirCheckpointStream {
+    guint64 t0;
+    guint64 offset0;
+    guint64 samples_in;
+    guint64 samples_out;
+    guint64 next_in_offset; /* offset of the next input buffer */
+    guint64 next_in_time; /* timestamp of the next input buffer */
+    guint64 num_gap_samples;
+    gint32 num_exe_samples;
+    gint32 need_tail_drain;
+    guint32 num_pending; /* samples waiting in the adapter */
+    guint32 num_segments; /* flag segments not pushed yet */
+} SpiirCheckpointStream;
+
+/* the shape of a depth, set by the bank, and where its state stands */
+typedef struct _SpiirCheckpointDepthInfo {
+    gint32 num_filters;
+    gint32 num_templates;
+    gint32 delay_max;
+    gint32 queue_len;
+    gint32 down_channels;
+    gint32 down_mem_len;
+    gint32 up_channels;
+    gint32 up_mem_len;
+
+    guint32 nb;
+    gint32 queue_first_sample;
+    gint32 queue_last_sample;
+    gint32 pre_out_spiir_len;
+    gint32 down_last_sample;
+    gint32 up_last_sample;
+} SpiirCheckpointDepthInfo;
+
+typedef struct _SpiirCheckpointDepth {
+    SpiirCheckpointDepthInfo info;
+    float *y; /* num_filters * num_templates complex, re and im interleaved */
+    float *queue; /* queue_len */
+    float *down_mem; /* down_mem_len * down_channels */
+    float *up_mem; /* up_mem_len * up_channels */
+} SpiirCheckpointDepth;
+
+typedef struct _SpiirCheckpointSegment {
+    guint64 start;
+    guint64 stop;
+    gint32 is_gap;
+    guint32 reserved;
+} SpiirCheckpointSegment;
+
+typedef struct _SpiirCheckpoint {
+    guint num_depths;
+    gint rate;
+    SpiirCheckpointStream stream;
+    SpiirCheckpointDepth *depths;
+    float *pending; /* stream.num_pending */
+    SpiirCheckpointSegment *segments; /* stream.num_segments */
+} SpiirCheckpoint;
+
+/* allocate a checkpoint for a bank of the shape given by info[num_depths],
+ * with room for num_pending adapter samples and num_segments flag segments.
+ * The state fields of info are copied too. */
+SpiirCheckpoint *spiir_checkpoint_new(guint num_depths,
+                                      gint rate,
+                                      const SpiirCheckpointDepthInfo *info,
+                                      guint num_pending,
+                                      guint num_segments);
+
+void spiir_checkpoint_free(SpiirCheckpoint *ckpt);
+
+/* TRUE if the checkpoint was taken from a bank of the shape given by
+ * info[num_depths] at the given rate, so it can be restored into it */
+gboolean spiir_checkpoint_matches(const SpiirCheckpoint *ckpt,
+                                  guint num_depths,
+                                  gint rate,
+                                  const SpiirCheckpointDepthInfo *info);
+
+/* write to fname.next and rename it over fname, so a crash during the write
+ * leaves the previous checkpoint in place. Return 0 on success, -1 and set
+ * error on failure. */
+int spiir_checkpoint_write(const SpiirCheckpoint *ckpt,
+                           const char *fname,
+                           GError **error);
+
+/* NULL, with error set, if the file can not be opened (G_FILE_ERROR_NOENT if
+ * there is none), is not a checkpoint, is of another version or is
+ * truncated (G_FILE_ERROR_INVAL) */
+SpiirCheckpoint *spiir_checkpoint_read(const char *fname, GError **error);
+
+G_END_DECLS
+
+#endif /* __CUDA_MULTIRATESPIIR_CHECKPOINT_H__ */
@@ -680,6 +680,108 @@ void spiir_state_reset(SpiirState **spstate,
     }
 }
 
+/*
+ * checkpoints: the bank shape and state of every depth, see
+ * multiratespiir_checkpoint.h. d_mem_copy is scratch space of the
+ * downsampler kernel and is not part of the state.
+ */
+
+void spiir_state_get_checkpoint_info(SpiirState **spstate,
+                                     guint num_depths,
+                                     SpiirCheckpointDepthInfo *info) {
+    guint i;
+    for (i = 0; i < num_depths; i++) {
+        info[i].num_filters        = SPSTATE(i)->num_filters;
+        info[i].num_templates      = SPSTATE(i)->num_templates;
+        info[i].delay_max          = SPSTATE(i)->delay_max;
+        info[i].queue_len          = SPSTATE(i)->queue_len;
+        info[i].down_channels      = SPSTATEDOWN(i)->channels;
+        info[i].down_mem_len       = SPSTATEDOWN(i)->mem_len;
+        info[i].up_channels        = SPSTATEUP(i)->channels;
+        info[i].up_mem_len         = SPSTATEUP(i)->mem_len;
+        info[i].nb                 = SPSTATE(i)->nb;
+        info[i].queue_first_sample = SPSTATE(i)->queue_first_sample;
+        info[i].queue_last_sample  = SPSTATE(i)->queue_last_sample;
+        info[i].pre_out_spiir_len  = SPSTATE(i)->pre_out_spiir_len;
+        info[i].down_last_sample   = SPSTATEDOWN(i)->last_sample;
+        info[i].up_last_sample     = SPSTATEUP(i)->last_sample;
+    }
+}
+
+/* ckpt must have been made for the shape of spstate */
+void spiir_state_save(SpiirState **spstate,
+                      guint num_depths,
+                      SpiirCheckpoint *ckpt,
+                      cudaStream_t stream) {
+    guint i;
+    SpiirCheckpointDepthInfo *info =
+      (SpiirCheckpointDepthInfo *)malloc(num_depths * sizeof(*info));
+
+    spiir_state_get_checkpoint_info(spstate, num_depths, info);
+    for (i = 0; i < num_depths; i++) {
+        SpiirCheckpointDepth *depth = &ckpt->depths[i];
+        int eff_len = SPSTATE(i)->num_filters * SPSTATE(i)->num_templates;
+
+        depth->info = info[i];
+        if (eff_len > 0)
+            CUDA_CHECK(cudaMemcpyAsync(depth->y, SPSTATE(i)->d_y,
+                                       eff_len * sizeof(COMPLEX_F),
+                                       cudaMemcpyDeviceToHost, stream));
+        CUDA_CHECK(cudaMemcpyAsync(depth->queue, SPSTATE(i)->d_queue,
+                                   SPSTATE(i)->queue_len * sizeof(float),
+                                   cudaMemcpyDeviceToHost, stream));
+        CUDA_CHECK(cudaMemcpyAsync(
+          depth->down_mem, SPSTATEDOWN(i)->d_mem,
+          SPSTATEDOWN(i)->mem_len * SPSTATEDOWN(i)->channels * sizeof(float),
+          cudaMemcpyDeviceToHost, stream));
+        CUDA_CHECK(cudaMemcpyAsync(
+          depth->up_mem, SPSTATEUP(i)->d_mem,
+          SPSTATEUP(i)->mem_len * SPSTATEUP(i)->channels * sizeof(float),
+          cudaMemcpyDeviceToHost, stream));
+    }
+    free(info);
+    /* the caller writes the host copies out as soon as we return */
+    CUDA_CHECK(cudaStreamSynchronize(stream));
+}
+
+/* ckpt must match the shape of spstate, see spiir_checkpoint_matches() */
+void spiir_state_restore(SpiirState **spstate,
+                         guint num_depths,
+                         const SpiirCheckpoint *ckpt,
+                         cudaStream_t stream) {
+    guint i;
+    for (i = 0; i < num_depths; i++) {
+        const SpiirCheckpointDepth *depth = &ckpt->depths[i];
+        int eff_len = SPSTATE(i)->num_filters * SPSTATE(i)->num_templates;
+
+        if (eff_len > 0)
+            CUDA_CHECK(cudaMemcpyAsync(SPSTATE(i)->d_y, depth->y,
+                                       eff_len * sizeof(COMPLEX_F),
+                                       cudaMemcpyHostToDevice, stream));
+        CUDA_CHECK(cudaMemcpyAsync(SPSTATE(i)->d_queue, depth->queue,
+                                   SPSTATE(i)->queue_len * sizeof(float),
+                                   cudaMemcpyHostToDevice, stream));
+        CUDA_CHECK(cudaMemcpyAsync(
+          SPSTATEDOWN(i)->d_mem, depth->down_mem,
+          SPSTATEDOWN(i)->mem_len * SPSTATEDOWN(i)->channels * sizeof(float),
+          cudaMemcpyHostToDevice, stream));
+        CUDA_CHECK(cudaMemcpyAsync(
+          SPSTATEUP(i)->d_mem, depth->up_mem,
+          SPSTATEUP(i)->mem_len * SPSTATEUP(i)->channels * sizeof(float),
+          cudaMemcpyHostToDevice, stream));
+
+        SPSTATE(i)->nb                 = depth->info.nb;
+        SPSTATE(i)->queue_first_sample = depth->info.queue_first_sample;
+        SPSTATE(i)->queue_last_sample  = depth->info.queue_last_sample;
+        SPSTATE(i)->pre_out_spiir_len  = depth->info.pre_out_spiir_len;
+        SPSTATEDOWN(i)->last_sample    = depth->info.down_last_sample;
+        SPSTATEUP(i)->last_sample      = depth->info.up_last_sample;
+    }
+    /* the host copies belong to the caller, who may free them */
+    CUDA_CHECK(cudaStreamSynchronize(stream));
+    CUDA_CHECK(cudaPeekAtLastError());
+}
+
 gint spiir_state_get_outlen(SpiirState **spstate,
                             gint in_len,
                             guint num_depths) {
@@ -21,6 +21,7 @@
 #define __CUDA_MULTIRATESPIIR_UTILS_H__
 
 #include <multiratespiir/multiratespiir.h>
+#include <multiratespiir/multiratespiir_checkpoint.h>
 #define RESAMPLER_NUM_DEPTHS_MIN     0
 #define RESAMPLER_NUM_DEPTHS_MAX     7
 #define RESAMPLER_NUM_DEPTHS_DEFAULT 7
@@ -75,6 +76,20 @@ void spiir_state_reset(SpiirState **spstate,
                        guint num_depths,
                        cudaStream_t stream);
 
+void spiir_state_get_checkpoint_info(SpiirState **spstate,
+                                     guint num_depths,
+                                     SpiirCheckpointDepthInfo *info);
+
+void spiir_state_save(SpiirState **spstate,
+                      guint num_depths,
+                      SpiirCheckpoint *ckpt,
+                      cudaStream_t stream);
+
+void spiir_state_restore(SpiirState **spstate,
+                         guint num_depths,
+                         const SpiirCheckpoint *ckpt,
+                         cudaStream_t stream);
+
 gint spiir_state_get_outlen(SpiirState **spstate,
                             gint in_len,
                             guint num_depths);
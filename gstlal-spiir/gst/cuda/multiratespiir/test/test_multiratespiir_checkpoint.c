@@ -0,0 +1,246 @@
+/* Check the filter state checkpoints of cuda_multiratespiir on the host. The
+ * host SPIIR bank of spiir_host.c is run over the input in one go, and again
+ * with its state and input history checkpointed halfway and read back into a
+ * fresh bank; the two outputs must agree exactly. Also checks that every
+ * array and counter survives the round trip, and that checkpoints of another
+ * bank shape, another version, cut short or missing are refused with an
+ * error. No GPU needed. */
+
+#include <complex.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <math.h>
+#include <multiratespiir/multiratespiir_checkpoint.h>
+#include <spiir/spiir_host.h>
+#include <stdio.h>
+#include <string.h>
+
+#define NUM_DEPTHS    3
+#define RATE          4096
+#define NUM_TEMPLATES 37
+#define NUM_FILTERS   21
+#define MAX_DELAY     50
+#define LENGTH        1000
+#define NUM_PENDING   13
+
+/* a bank with a partly filled block of templates, see spiir_host.h */
+static IIRBankHost *make_bank(void) {
+    double complex a1[NUM_TEMPLATES * NUM_FILTERS];
+    double complex b0[NUM_TEMPLATES * NUM_FILTERS];
+    double complex y0[NUM_TEMPLATES * NUM_FILTERS];
+    gint delay[NUM_TEMPLATES * NUM_FILTERS];
+    GRand *rand = g_rand_new_with_seed(1);
+    IIRBankHost *bank;
+    guint i;
+
+    for (i = 0; i < NUM_TEMPLATES * NUM_FILTERS; i++) {
+        a1[i] = g_rand_double_range(rand, 0.9, 0.999)
+                * cexp(I * g_rand_double_range(rand, 0., 2. * M_PI));
+        b0[i] = g_rand_double_range(rand, -.5, .5)
+                + I * g_rand_double_range(rand, -.5, .5);
+        y0[i]    = 0.;
+        delay[i] = g_rand_int_range(rand, 0, MAX_DELAY);
+    }
+    bank = iir_bank_host_new(NUM_TEMPLATES, NUM_FILTERS, a1, b0, y0, delay);
+    g_rand_free(rand);
+    return bank;
+}
+
+/* depth 0 is the bank, whose queue holds the input history it needs; the
+ * others only have to survive the round trip */
+static void fill_info(SpiirCheckpointDepthInfo *info,
+                      const IIRBankHost *bank) {
+    guint i;
+
+    memset(info, 0, NUM_DEPTHS * sizeof(*info));
+    for (i = 0; i < NUM_DEPTHS; i++) {
+        info[i].num_filters        = NUM_FILTERS - i;
+        info[i].num_templates      = NUM_TEMPLATES;
+        info[i].delay_max          = bank->dmax;
+        info[i].queue_len          = bank->dmax >> i;
+        info[i].down_channels      = 1;
+        info[i].down_mem_len       = 400 >> i;
+        info[i].up_channels        = 2 * NUM_TEMPLATES;
+        info[i].up_mem_len         = 40 >> i;
+        info[i].nb                 = i;
+        info[i].queue_first_sample = 3 * i;
+        info[i].queue_last_sample  = 3 * i + 20;
+        info[i].pre_out_spiir_len  = 17 * i;
+        info[i].down_last_sample   = 192;
+        info[i].up_last_sample     = 8;
+    }
+}
+
+static gchar *test_fname(const gchar *dir, const gchar *name) {
+    return g_build_filename(dir, name, NULL);
+}
+
+int main(int argc, char *argv[]) {
+    SpiirCheckpointDepthInfo info[NUM_DEPTHS], other[NUM_DEPTHS];
+    SpiirCheckpoint *ckpt, *back;
+    IIRBankHost *bank;
+    GError *error = NULL;
+    gchar *dir    = g_dir_make_tmp("spiir_checkpoint_XXXXXX", NULL);
+    gchar *fname  = test_fname(dir, "state.ckpt");
+    gchar *missing, *next_fname, *contents;
+    gsize size;
+    float *x, *resumed;
+    float complex *ref, *out;
+    guint i, j, dmax, half = LENGTH / 2 + 3;
+
+    if (!g_thread_supported()) g_thread_init(NULL);
+
+    g_assert(dir != NULL);
+    bank = make_bank();
+    dmax = bank->dmax;
+    fill_info(info, bank);
+    x = g_new(float, LENGTH + dmax);
+    for (i = 0; i < LENGTH + dmax; i++) x[i] = sin(0.01 * i * i);
+    ref = g_new(float complex, NUM_TEMPLATES * LENGTH);
+    out = g_new(float complex, NUM_TEMPLATES * LENGTH);
+
+    /* straight through */
+    iir_bank_host_filter_s(bank, x, LENGTH, ref);
+    iir_bank_host_free(bank);
+
+    /* checkpointed halfway, with the history of depth 0, some input waiting
+     * and two flag segments */
+    bank = make_bank();
+    iir_bank_host_filter_s(bank, x, half, out);
+    ckpt = spiir_checkpoint_new(NUM_DEPTHS, RATE, info, NUM_PENDING, 2);
+    iir_bank_host_get_state(bank, ckpt->depths[0].y);
+    iir_bank_host_free(bank);
+    memcpy(ckpt->depths[0].queue, x + half, dmax * sizeof(float));
+    for (i = 1; i < NUM_DEPTHS; i++) {
+        SpiirCheckpointDepth *depth = &ckpt->depths[i];
+        for (j = 0; j < (guint)(2 * depth->info.num_filters
+                                * depth->info.num_templates);
+             j++)
+            depth->y[j] = 0.125f * j - i;
+        for (j = 0; j < (guint)depth->info.queue_len; j++)
+            depth->queue[j] = i + 0.5f * j;
+    }
+    for (i = 0; i < NUM_DEPTHS; i++) {
+        SpiirCheckpointDepth *depth = &ckpt->depths[i];
+        for (j = 0; j < (guint)(depth->info.down_mem_len
+                                * depth->info.down_channels);
+             j++)
+            depth->down_mem[j] = -0.25f * j;
+        for (j = 0;
+             j < (guint)(depth->info.up_mem_len * depth->info.up_channels);
+             j++)
+            depth->up_mem[j] = 1e-3f * j + i;
+    }
+    memcpy(ckpt->pending, x + half + dmax, NUM_PENDING * sizeof(float));
+    ckpt->segments[0].start         = 1000000000;
+    ckpt->segments[0].stop          = 1500000000;
+    ckpt->segments[1].start         = 1500000000;
+    ckpt->segments[1].stop          = 2000000000;
+    ckpt->segments[1].is_gap        = 1;
+    ckpt->stream.t0                 = 1000000000;
+    ckpt->stream.offset0            = 4096;
+    ckpt->stream.samples_in         = half + dmax + NUM_PENDING;
+    ckpt->stream.samples_out        = half;
+    ckpt->stream.next_in_offset     = 4096 + half + dmax + NUM_PENDING;
+    ckpt->stream.next_in_time       = 2000000000;
+    ckpt->stream.num_gap_samples    = 11;
+    ckpt->stream.num_exe_samples    = RATE;
+    ckpt->stream.need_tail_drain    = TRUE;
+    g_assert(spiir_checkpoint_write(ckpt, fname, &error) == 0);
+    g_assert_no_error(error);
+
+    /* written in place of the old one, no temporary left behind */
+    next_fname = g_strconcat(fname, ".next", NULL);
+    g_assert(g_file_test(fname, G_FILE_TEST_EXISTS));
+    g_assert(!g_file_test(next_fname, G_FILE_TEST_EXISTS));
+
+    back = spiir_checkpoint_read(fname, &error);
+    g_assert_no_error(error);
+    g_assert(back != NULL);
+    g_assert(spiir_checkpoint_matches(back, NUM_DEPTHS, RATE, info));
+    g_assert(memcmp(&back->stream, &ckpt->stream, sizeof(back->stream)) == 0);
+    for (i = 0; i < NUM_DEPTHS; i++) {
+        SpiirCheckpointDepth *a = &ckpt->depths[i], *b = &back->depths[i];
+        g_assert(memcmp(&a->info, &b->info, sizeof(a->info)) == 0);
+        g_assert(memcmp(a->y, b->y,
+                        2 * a->info.num_filters * a->info.num_templates
+                          * sizeof(float))
+                 == 0);
+        g_assert(memcmp(a->queue, b->queue, a->info.queue_len * sizeof(float))
+                 == 0);
+        g_assert(memcmp(a->down_mem, b->down_mem,
+                        a->info.down_mem_len * a->info.down_channels
+                          * sizeof(float))
+                 == 0);
+        g_assert(memcmp(a->up_mem, b->up_mem,
+                        a->info.up_mem_len * a->info.up_channels
+                          * sizeof(float))
+                 == 0);
+    }
+    g_assert(memcmp(back->pending, ckpt->pending, NUM_PENDING * sizeof(float))
+             == 0);
+    g_assert(memcmp(back->segments, ckpt->segments,
+                    2 * sizeof(SpiirCheckpointSegment))
+             == 0);
+
+    /* a fresh bank restored from the file carries on exactly where the first
+     * one stopped, fed the saved history, the pending input and then the
+     * rest of the stream */
+    bank = make_bank();
+    iir_bank_host_set_state(bank, back->depths[0].y);
+    resumed = g_new(float, LENGTH - half + dmax);
+    memcpy(resumed, back->depths[0].queue, dmax * sizeof(float));
+    memcpy(resumed + dmax, back->pending, NUM_PENDING * sizeof(float));
+    memcpy(resumed + dmax + NUM_PENDING, x + half + dmax + NUM_PENDING,
+           (LENGTH - half - NUM_PENDING) * sizeof(float));
+    iir_bank_host_filter_s(bank, resumed, LENGTH - half,
+                           out + NUM_TEMPLATES * half);
+    g_assert(memcmp(out, ref, NUM_TEMPLATES * LENGTH * sizeof(*out)) == 0);
+    iir_bank_host_free(bank);
+
+    /* another bank shape or rate */
+    memcpy(other, info, sizeof(info));
+    other[1].num_filters++;
+    g_assert(!spiir_checkpoint_matches(back, NUM_DEPTHS, RATE, other));
+    g_assert(!spiir_checkpoint_matches(back, NUM_DEPTHS, RATE / 2, info));
+    g_assert(!spiir_checkpoint_matches(back, NUM_DEPTHS - 1, RATE, info));
+
+    /* cut short, of another version, or not there at all */
+    g_assert(g_file_get_contents(fname, &contents, &size, NULL));
+    g_assert(g_file_set_contents(fname, contents, size - 1, NULL));
+    g_assert(spiir_checkpoint_read(fname, &error) == NULL);
+    g_assert_error(error, G_FILE_ERROR, G_FILE_ERROR_INVAL);
+    g_clear_error(&error);
+    ((SpiirCheckpointHeader *)contents)->version++;
+    g_assert(g_file_set_contents(fname, contents, size, NULL));
+    g_assert(spiir_checkpoint_read(fname, &error) == NULL);
+    g_assert_error(error, G_FILE_ERROR, G_FILE_ERROR_INVAL);
+    g_clear_error(&error);
+    g_assert(spiir_checkpoint_read(next_fname, &error) == NULL);
+    g_assert_error(error, G_FILE_ERROR, G_FILE_ERROR_NOENT);
+    g_clear_error(&error);
+
+    /* the write fails cleanly if the directory is gone */
+    missing = g_build_filename(dir, "no_such_dir", "state.ckpt", NULL);
+    g_assert(spiir_checkpoint_write(ckpt, missing, &error) == -1);
+    g_assert_error(error, G_FILE_ERROR, G_FILE_ERROR_NOENT);
+    g_clear_error(&error);
+
+    g_print("multiratespiir checkpoint: %u templates x %u filters, "
+            "%" G_GSIZE_FORMAT " bytes, resumed bit-exact\n",
+            NUM_TEMPLATES, NUM_FILTERS, size);
+    g_free(contents);
+    g_unlink(fname);
+    g_rmdir(dir);
+    spiir_checkpoint_free(ckpt);
+    spiir_checkpoint_free(back);
+    g_free(x);
+    g_free(resumed);
+    g_free(ref);
+    g_free(out);
+    g_free(missing);
+    g_free(next_fname);
+    g_free(fname);
+    g_free(dir);
+    return 0;
+}
@@ -24,20 +24,23 @@
 #include <chealpix.h>
 #include <cuda_debug.h>
 #include <gst/gst.h>
+#include <gstlal/gstlal_element_stats.h>
 #include <lal/Date.h>
 #include <lal/LIGOMetadataTables.h>
 #include <math.h>
 #include <pipe_macro.h> // for get_icombo, IFOComboMap
 #include <postcoh/postcoh.h>
+#include <postcoh/postcoh_staging.h>
 #include <postcoh/postcoh_utils.h>
 #include <postcoh/postcohtable_utils.h>
 #include <string.h>
 
 #define DEFAULT_DETRSP_FNAME      "H1L1V1_detrsp.xml"
+#define DEFAULT_DETRSP_ORDER      4
+/* as gstlal_postcoh_gen_detrsp_map */
+#define DETRSP_GPS_STEP           1800
 #define EPSILON                   5
-#define PEAKFINDER_CLUSTER_WINDOW 5
 #define RAD2DEG                   57.2957795
-#define ACCELERATE_POSTCOH_MEMORY_COPY
 
 #define GST_CAT_DEFAULT cuda_postcoh_debug
 GST_DEBUG_CATEGORY_STATIC(GST_CAT_DEFAULT);
@@ -157,62 +160,6 @@ static void add_flag_segment(GstPostcohCollectData *data,
     g_array_append_val(data->flag_segments, new_segment);
 }
 
-#ifdef ACCELERATE_POSTCOH_MEMORY_COPY
-// This function is just copy from gst_adapter_peek and change malloc to
-// cudaMallocHost
-// FIXME: temporarily used to speed up cudaMemcpy, will be deleted when
-// transfered to gstreamer1.x
-const guint8 *gst_adapter_peek_cuda(GstAdapter *adapter, guint size) {
-    int DEFAULT_SIZE = 16;
-    GstBuffer *cur;
-    GSList *cur_list;
-    guint copied;
-
-    g_return_val_if_fail(GST_IS_ADAPTER(adapter), NULL);
-    g_return_val_if_fail(size > 0, NULL);
-
-    /* we don't have enough data, return NULL. This is unlikely
-     *    * as one usually does an _available() first instead of peeking a
-     *       * random size. */
-    if (G_UNLIKELY(size > adapter->size)) return NULL;
-
-    /* we have enough assembled data, return it */
-    if (adapter->assembled_len >= size) return adapter->assembled_data;
-
-    /* our head buffer has enough data left, return it */
-    cur = adapter->buflist->data;
-    if (GST_BUFFER_SIZE(cur) >= size + adapter->skip)
-        return GST_BUFFER_DATA(cur) + adapter->skip;
-
-    if (adapter->assembled_size < size) {
-        adapter->assembled_size = (size / DEFAULT_SIZE + 1) * DEFAULT_SIZE;
-        GST_DEBUG_OBJECT(adapter, "setting size of internal buffer to %u",
-                         adapter->assembled_size);
-        // CUDA_CHECK(cudaFreeHost((void*)adapter->assembled_data));
-        // assert(adapter->assembled_data == NULL);
-        CUDA_CHECK(cudaMallocHost((void **)&(adapter->assembled_data),
-                                  adapter->assembled_size));
-        // g_realloc (adapter->assembled_data, adapter->assembled_size);
-    }
-    adapter->assembled_len = size;
-    copied                 = GST_BUFFER_SIZE(cur) - adapter->skip;
-    memcpy(adapter->assembled_data, GST_BUFFER_DATA(cur) + adapter->skip,
-           copied);
-
-    cur_list = g_slist_next(adapter->buflist);
-    while (copied < size) {
-        g_assert(cur_list);
-        cur      = cur_list->data;
-        cur_list = g_slist_next(cur_list);
-        memcpy(adapter->assembled_data + copied, GST_BUFFER_DATA(cur),
-               MIN(GST_BUFFER_SIZE(cur), size - copied));
-        copied = MIN(size, copied + GST_BUFFER_SIZE(cur));
-    }
-
-    return adapter->assembled_data;
-}
-#endif
-
 GST_BOILERPLATE_FULL(CudaPostcoh,
                      cuda_postcoh,
                      GstElement,
@@ -256,21 +203,36 @@ enum {
     PROP_COHSNR_THRESH,
     PROP_SNGLSNR_THRESH,
     PROP_STREAM_ID,
-    PROP_REFRESH_INTERVAL
+    PROP_REFRESH_INTERVAL,
+    PROP_SNGL_OUTPUT,
+    PROP_DETRSP_IFO_HORIZONS,
+    PROP_DETRSP_ORDER,
+    /* first of the gstlal_element_stats properties */
+    PROP_STATS
 };
 
-static void cuda_postcoh_device_set_init(CudaPostcoh *element) {
+/* Pick the device from the stream id and open a queue on it. The coherent
+ * search kernels are CUDA only, so without a device there is nothing to run
+ * on: FALSE is returned and the element refuses to go to READY. */
+static gboolean cuda_postcoh_device_set_init(CudaPostcoh *element) {
     if (element->device_id == POSTCOH_PARAMS_NOT_INIT) {
-        int deviceCount;
-        CUDA_CHECK(cudaGetDeviceCount(&deviceCount));
+        const ComputeBackend *backend = compute_backend_cuda();
+        int deviceCount = backend ? backend->device_count() : 0;
+        if (deviceCount <= 0) {
+            GST_ERROR_OBJECT(element, "no CUDA device found");
+            return FALSE;
+        }
         /* FIXME: only print device info like runtime version in debug mode */
         // cuda_device_print(deviceCount);
-        element->device_id = element->stream_id % deviceCount;
+        element->backend   = backend;
+        element->device_id = MAX(element->stream_id, 0) % deviceCount;
         GST_LOG("device for postcoh %d\n", element->device_id);
-        CUDA_CHECK(cudaSetDevice(element->device_id));
-        CUDA_CHECK(
-          cudaStreamCreateWithFlags(&element->stream, cudaStreamNonBlocking));
+        element->backend->set_device(element->device_id);
+        element->queue  = element->backend->queue_new();
+        element->stream = (cudaStream_t)element->backend->queue_native(
+          element->queue);
     }
+    return TRUE;
 }
 
 static void cuda_postcoh_set_property(GObject *object,
@@ -287,12 +249,16 @@ static void cuda_postcoh_set_property(GObject *object,
         g_assert(element->stream_id != POSTCOH_PARAMS_NOT_INIT);
         g_mutex_lock(element->prop_lock);
         element->detrsp_fname = g_value_dup_string(value);
-        cuda_postcoh_device_set_init(element);
-        CUDA_CHECK(cudaSetDevice(element->device_id));
-        cuda_postcoh_map_from_xml(element->detrsp_fname, element->state,
-                                  element->stream);
-        GST_DEBUG("detrsp map has been read in, broad cast the lock avail");
-        g_cond_broadcast(element->prop_avail);
+        if (cuda_postcoh_device_set_init(element)) {
+            CUDA_CHECK(cudaSetDevice(element->device_id));
+            /* a map generated in memory takes precedence */
+            if (element->detrsp_map == NULL)
+                cuda_postcoh_map_from_xml(element->detrsp_fname,
+                                          element->state, element->stream);
+            GST_DEBUG("detrsp map has been read in, broad cast the lock "
+                      "avail");
+            g_cond_broadcast(element->prop_avail);
+        }
         g_mutex_unlock(element->prop_lock);
         GST_DEBUG("detrsp map lock broad cast done");
         break;
@@ -304,16 +270,17 @@ static void cuda_postcoh_set_property(GObject *object,
         GST_DEBUG("autocorrelation and sigma acquiring the lock");
         g_mutex_lock(element->prop_lock);
         GST_DEBUG("autocorrelation and sigma have acquired the lock");
-        cuda_postcoh_device_set_init(element);
-        CUDA_CHECK(cudaSetDevice(element->device_id));
         element->spiir_bank_fname = g_value_dup_string(value);
-        cuda_postcoh_autocorr_from_xml(element->spiir_bank_fname,
-                                       element->state, element->stream);
-        cuda_postcoh_sigmasq_from_xml(element->spiir_bank_fname,
-                                      element->state);
-        GST_DEBUG("autocorrelation and sigma have been read in, broad cast the "
-                  "lock avail");
-        g_cond_broadcast(element->prop_avail);
+        if (cuda_postcoh_device_set_init(element)) {
+            CUDA_CHECK(cudaSetDevice(element->device_id));
+            cuda_postcoh_autocorr_from_xml(element->spiir_bank_fname,
+                                           element->state, element->stream);
+            cuda_postcoh_sigmasq_from_xml(element->spiir_bank_fname,
+                                          element->state);
+            GST_DEBUG("autocorrelation and sigma have been read in, broad "
+                      "cast the lock avail");
+            g_cond_broadcast(element->prop_avail);
+        }
         g_mutex_unlock(element->prop_lock);
         GST_DEBUG("autocorrelation and sigma lock broad cast done");
         break;
@@ -367,7 +334,62 @@ static void cuda_postcoh_set_property(GObject *object,
         element->refresh_interval = g_value_get_int(value);
         break;
 
-    default: G_OBJECT_WARN_INVALID_PROPERTY_ID(object, id, pspec); break;
+    case PROP_DETRSP_IFO_HORIZONS: {
+        char **ifos;
+        double *horizons;
+        gint nifo;
+
+        /* must make sure stream_id has already loaded */
+        g_assert(element->stream_id != POSTCOH_PARAMS_NOT_INIT);
+        g_mutex_lock(element->prop_lock);
+        g_free(element->detrsp_ifo_horizons);
+        element->detrsp_ifo_horizons = g_value_dup_string(value);
+        detrsp_map_free(element->detrsp_map);
+        element->detrsp_map = NULL;
+        nifo = detrsp_parse_ifo_horizons(element->detrsp_ifo_horizons, &ifos,
+                                         &horizons);
+        if (nifo > 0)
+            element->detrsp_map = detrsp_map_new(
+              ifos, nifo, horizons, DETRSP_GPS_STEP, element->detrsp_order);
+        if (element->detrsp_map == NULL) {
+            GST_ERROR_OBJECT(element, "invalid detrsp-ifo-horizons \"%s\"",
+                             element->detrsp_ifo_horizons);
+        } else if (cuda_postcoh_device_set_init(element)) {
+            LIGOTimeGPS now;
+            CUDA_CHECK(cudaSetDevice(element->device_id));
+            cuda_postcoh_map_init_detrsp(element->detrsp_map, element->state);
+            /* the first slices for the current time, right for a low latency
+             * analysis. An offline one regenerates them at its first buffer.
+             * The rest of the day follows in the background */
+            if (XLALGPSTimeNow(&now))
+                cuda_postcoh_map_from_detrsp(element->detrsp_map,
+                                             element->state, now.gpsSeconds,
+                                             element->stream);
+            g_cond_broadcast(element->prop_avail);
+        }
+        g_strfreev(ifos);
+        g_free(horizons);
+        g_mutex_unlock(element->prop_lock);
+        break;
+    }
+
+    case PROP_DETRSP_ORDER:
+        element->detrsp_order = g_value_get_int(value);
+        if (element->detrsp_map)
+            GST_WARNING_OBJECT(element, "detrsp-chealpix-order must be set "
+                                        "before detrsp-ifo-horizons to take "
+                                        "effect");
+        break;
+
+    case PROP_SNGL_OUTPUT:
+        element->sngl_output = g_value_get_boolean(value);
+        break;
+
+    default:
+        if (!gstlal_element_stats_set_property(element->stats, id - PROP_STATS,
+                                               value))
+            G_OBJECT_WARN_INVALID_PROPERTY_ID(object, id, pspec);
+        break;
     }
     GST_OBJECT_UNLOCK(element);
 }
@@ -416,7 +438,23 @@ static void cuda_postcoh_get_property(GObject *object,
         g_value_set_int(value, element->refresh_interval);
         break;
 
-    default: G_OBJECT_WARN_INVALID_PROPERTY_ID(object, id, pspec); break;
+    case PROP_SNGL_OUTPUT:
+        g_value_set_boolean(value, element->sngl_output);
+        break;
+
+    case PROP_DETRSP_IFO_HORIZONS:
+        g_value_set_string(value, element->detrsp_ifo_horizons);
+        break;
+
+    case PROP_DETRSP_ORDER:
+        g_value_set_int(value, element->detrsp_order);
+        break;
+
+    default:
+        if (!gstlal_element_stats_get_property(element->stats, id - PROP_STATS,
+                                               value))
+            G_OBJECT_WARN_INVALID_PROPERTY_ID(object, id, pspec);
+        break;
     }
     GST_OBJECT_UNLOCK(element);
 }
@@ -729,6 +767,10 @@ static gboolean cuda_postcoh_sink_setcaps(GstPad *pad, GstCaps *caps) {
       sizeof(int) * state->nifo, cudaMemcpyHostToDevice, postcoh->stream));
     CUDA_CHECK(cudaStreamSynchronize(postcoh->stream));
 
+    postcoh_staging_free(postcoh->staging);
+    postcoh->staging = postcoh_staging_new(postcoh->backend, state->nifo,
+                                           postcoh->one_take_size);
+
     state->is_member_init = POSTCOH_PARAMS_INIT;
     GST_OBJECT_UNLOCK(postcoh->collect);
     return TRUE;
@@ -803,7 +845,15 @@ static GstStateChangeReturn
     CudaPostcoh *postcoh = CUDA_POSTCOH(element);
 
     switch (transition) {
-    case GST_STATE_CHANGE_NULL_TO_READY: break;
+    case GST_STATE_CHANGE_NULL_TO_READY:
+        if (!cuda_postcoh_device_set_init(postcoh)) {
+            GST_ELEMENT_ERROR(postcoh, RESOURCE, NOT_FOUND,
+                              ("no CUDA device found"),
+                              ("the coherent search runs on CUDA devices "
+                               "only"));
+            return GST_STATE_CHANGE_FAILURE;
+        }
+        break;
 
     case GST_STATE_CHANGE_READY_TO_PAUSED:
         gst_collect_pads_start(postcoh->collect);
@@ -960,6 +1010,7 @@ static gint cuda_postcoh_push_and_get_common_size(GstCollectPads *pads,
             continue;
         }
 
+        gstlal_element_stats_input(postcoh->stats, buf);
         buf_end = GST_BUFFER_TIMESTAMP(buf) + GST_BUFFER_DURATION(buf);
         is_gap =
           GST_BUFFER_FLAG_IS_SET(buf, GST_BUFFER_FLAG_GAP) ? TRUE : FALSE;
@@ -984,6 +1035,21 @@ static gint cuda_postcoh_push_and_get_common_size(GstCollectPads *pads,
     return min_size;
 }
 
+/* samples left in the fullest adapter */
+static guint64 cuda_postcoh_queue_level(GstCollectPads *pads,
+                                        CudaPostcoh *postcoh) {
+    GSList *collectlist;
+    guint64 level = 0, size_cur;
+
+    for (collectlist = pads->data; collectlist;
+         collectlist = g_slist_next(collectlist)) {
+        GstPostcohCollectData *data = collectlist->data;
+        size_cur = gst_adapter_available(data->adapter);
+        level    = MAX(level, size_cur);
+    }
+    return level / postcoh->bps;
+}
+
 static gboolean cuda_postcoh_need_recollect(GstCollectPads *pads,
                                             CudaPostcoh *postcoh) {
 
@@ -1239,6 +1305,118 @@ static int cuda_postcoh_select_foreground(PostcohState *state,
     return left_entries;
 }
 
+/* The only detector with data during single-IFO time, -1 otherwise. */
+static int cuda_postcoh_sngl_ifo(PostcohState *state) {
+    int iifo;
+    if (state->cur_nifo != 1) return -1;
+    for (iifo = 0; iifo < state->nifo; iifo++)
+        if (!state->cur_ifo_is_gap[iifo]) return iifo;
+    return -1;
+}
+
+/* Fill the single snr and phase of the peaks of ifo from its host snr
+ * chunk, laid out as [exe_len][ntmplt]. This stands in for the coherent
+ * kernel, which is skipped during single-IFO time. */
+static void cuda_postcoh_sngl_fill(PostcohState *state,
+                                   int iifo,
+                                   COMPLEX_F *snglsnr) {
+    PeakList *pklist = state->peak_list[iifo];
+    int write_ifo    = state->write_ifo_mapping[iifo];
+    int ipeak, peak_cur;
+    COMPLEX_F *isnr;
+
+    for (ipeak = 0; ipeak < pklist->npeak[0]; ipeak++) {
+        peak_cur = pklist->peak_pos[ipeak];
+        isnr     = snglsnr + (long)pklist->len_idx[peak_cur] * state->ntmplt
+               + pklist->tmplt_idx[peak_cur];
+        pklist->snglsnr[write_ifo][peak_cur] =
+          sqrt((*isnr).re * (*isnr).re + (*isnr).im * (*isnr).im);
+        pklist->coaphase[write_ifo][peak_cur] = atan2((*isnr).im, (*isnr).re);
+    }
+}
+
+/* Write one compact row per peak of the single detector in iifo. The rows
+ * are flagged FLAG_SNGL so that cohfar_accumbackground counts them apart
+ * from the coherent stats. cohsnr is the single snr. chisq, nullsnr and the
+ * sky position need the coherent kernel and are left zero, so the single
+ * stats are binned on snr alone. No time-slide trials are written, with one
+ * detector there is nothing to slide against. */
+static int cuda_postcoh_write_sngl_to_table(CudaPostcoh *postcoh,
+                                            int iifo,
+                                            PostcohInspiralTable *output,
+                                            GstClockTime ts) {
+    PostcohState *state = postcoh->state;
+    PeakList *pklist    = state->peak_list[iifo];
+    int write_ifo       = state->write_ifo_mapping[iifo];
+    int ipeak, peak_cur, len_cur, tmplt_idx, write_entries = 0;
+    int livetime = (int)((ts - postcoh->t0) / GST_SECOND);
+    SnglInspiralTable *sngl_table = postcoh->sngl_table;
+    LIGOTimeGPS end_time;
+
+    for (ipeak = 0; ipeak < pklist->npeak[0]; ipeak++) {
+        peak_cur  = pklist->peak_pos[ipeak];
+        tmplt_idx = pklist->tmplt_idx[peak_cur];
+        len_cur   = pklist->len_idx[peak_cur];
+
+        XLALINT8NSToGPS(&end_time, ts);
+        XLALGPSAddGPS(&end_time, &(sngl_table[tmplt_idx].end));
+        XLALGPSAdd(&end_time, (double)len_cur / state->exe_len);
+        output->next                     = NULL;
+        output->end_time                 = end_time;
+        output->end_time_sngl[write_ifo] = end_time;
+        output->ringdown_dur.gpsSeconds =
+          -sngl_table[tmplt_idx].end.gpsSeconds;
+        output->ringdown_dur.gpsNanoSeconds =
+          -sngl_table[tmplt_idx].end.gpsNanoSeconds;
+
+        output->snglsnr[write_ifo]  = pklist->snglsnr[write_ifo][peak_cur];
+        output->coaphase[write_ifo] = pklist->coaphase[write_ifo][peak_cur];
+        output->deff[write_ifo] = sqrt(state->sigmasq[iifo][tmplt_idx])
+                                  / output->snglsnr[write_ifo]; // in MPC
+
+        output->is_background = FLAG_SNGL;
+        output->livetime      = livetime;
+        strncpy(output->ifos, state->cur_ifos, IFO_LEN);
+        output->ifos[IFO_LEN] = '\0';
+        strncpy(output->pivotal_ifo, state->all_ifos + IFO_LEN * iifo,
+                IFO_LEN);
+        output->pivotal_ifo[IFO_LEN] = '\0';
+        output->tmplt_idx            = tmplt_idx;
+        output->bankid               = postcoh->stream_id;
+        output->pix_idx              = -1;
+        output->cohsnr               = output->snglsnr[write_ifo];
+
+        output->template_duration = sngl_table[tmplt_idx].template_duration;
+        output->mchirp            = sngl_table[tmplt_idx].mchirp;
+        output->mtotal            = sngl_table[tmplt_idx].mtotal;
+        output->mass1             = sngl_table[tmplt_idx].mass1;
+        output->mass2             = sngl_table[tmplt_idx].mass2;
+        output->spin1x            = sngl_table[tmplt_idx].spin1x;
+        output->spin1y            = sngl_table[tmplt_idx].spin1y;
+        output->spin1z            = sngl_table[tmplt_idx].spin1z;
+        output->spin2x            = sngl_table[tmplt_idx].spin2x;
+        output->spin2y            = sngl_table[tmplt_idx].spin2y;
+        output->spin2z            = sngl_table[tmplt_idx].spin2z;
+        output->eta               = sngl_table[tmplt_idx].eta;
+        output->f_final           = sngl_table[tmplt_idx].f_final;
+        output->event_id          = postcoh->cur_event_id++;
+        output->skymap_fname[0]   = '\0';
+
+        XLALINT8NSToGPS(&output->epoch, ts);
+        output->deltaT     = 1. / postcoh->rate;
+        output->snr_length = 0;
+
+        GST_LOG_OBJECT(postcoh,
+                       "sngl ifo %d, ipeak %d, len_cur %d, tmplt_idx %d, "
+                       "snglsnr %f, coaphase %f",
+                       iifo, ipeak, len_cur, tmplt_idx,
+                       output->snglsnr[write_ifo], output->coaphase[write_ifo]);
+        output++;
+        write_entries++;
+    }
+    return write_entries;
+}
+
 static int cuda_postcoh_write_table_to_buf(CudaPostcoh *postcoh,
                                            GstBuffer *outbuf) {
     PostcohState *state = postcoh->state;
@@ -1272,10 +1450,9 @@ static int cuda_postcoh_write_table_to_buf(CudaPostcoh *postcoh,
     write_entries++;
     /* end of the first entry */
 
-    /* FIXME: can output single-detector events, consider cohsnr = single snr,
-     * and cmbchisq = single chisq */
-    /* only output multi-detector events, cohsnr, cmbchisq only make sense when
-     * cur_nifo >=2 */
+    /* only output multi-detector events here, cohsnr, cmbchisq only make
+     * sense when cur_nifo >=2. single-detector time is handled by the
+     * sngl-output property */
     for (iifo = 0; (iifo < nifo) && (state->cur_nifo >= 2); iifo++) {
         if (state->cur_ifo_is_gap[iifo]) continue;
         PeakList *pklist = state->peak_list[iifo];
@@ -1470,6 +1647,11 @@ static int cuda_postcoh_write_table_to_buf(CudaPostcoh *postcoh,
                        "write to output, ifo %d, npeak %d, %d total entries",
                        iifo, npeak, write_entries);
     }
+
+    iifo = cuda_postcoh_sngl_ifo(state);
+    if (postcoh->sngl_output && iifo >= 0)
+        write_entries +=
+          cuda_postcoh_write_sngl_to_table(postcoh, iifo, output, ts);
     return write_entries;
 }
 
@@ -1480,12 +1662,14 @@ static GstFlowReturn cuda_postcoh_new_buffer_and_push(CudaPostcoh *postcoh,
     GstCaps *caps     = GST_PAD_CAPS(srcpad);
     GstFlowReturn ret;
     PostcohState *state = postcoh->state;
-    int left_entries    = 0;
+    int left_entries = 0, sngl_ifo = cuda_postcoh_sngl_ifo(state);
 
     /* NOTE: explicitly add one more entry to indicate the participating IFOs */
     if (state->cur_nifo >= 2)
         left_entries =
           cuda_postcoh_select_foreground(state, postcoh->cohsnr_thresh) + 1;
+    else if (postcoh->sngl_output && sngl_ifo >= 0)
+        left_entries = state->peak_list[sngl_ifo]->npeak[0] + 1;
     else if (state->cur_nifo == 1)
         left_entries = 1;
 
@@ -1531,7 +1715,7 @@ static GstFlowReturn cuda_postcoh_new_buffer_and_push(CudaPostcoh *postcoh,
 
     if (left_entries == 0) GST_BUFFER_FLAG_SET(outbuf, GST_BUFFER_FLAG_GAP);
 
-    ret = gst_pad_push(postcoh->srcpad, outbuf);
+    ret = gstlal_element_stats_push(postcoh->stats, postcoh->srcpad, outbuf);
     if (ret != GST_FLOW_OK) {
         fprintf(
           stderr,
@@ -1566,109 +1750,12 @@ int timestamp_to_gps_idx(long gps_start, int gps_step, GstClockTime t) {
     return gps_idx;
 }
 
-static int peaks_over_thresh(COMPLEX_F *snglsnr,
-                             PostcohState *state,
-                             int cur_ifo,
-                             cudaStream_t stream) {
-    int exe_len = state->exe_len, ntmplt = state->ntmplt, itmplt, ilen, jlen,
-        npeak = 0, max_npeak = state->max_npeak;
-    COMPLEX_F *isnr = snglsnr;
-    float tmp_abssnr, tmp_tmplt, snglsnr_thresh = state->snglsnr_thresh;
-    PeakList *pklist  = state->peak_list[cur_ifo];
-    float *tmp_maxsnr = state->tmp_maxsnr;
-    int *tmp_tmpltidx = state->tmp_tmpltidx;
-    int *peak_pos     = pklist->peak_pos;
-    int *tmplt_idx    = pklist->tmplt_idx;
-    int *len_idx      = pklist->len_idx;
-    /* find maxsnr for each sampling point, keep the record of the tmplt_idx */
-    for (ilen = 0; ilen < exe_len; ilen++) {
-        tmp_maxsnr[ilen]               = 0.0;
-        tmp_tmpltidx[ilen]             = -1;
-        peak_pos[MIN(ilen, max_npeak)] = -1;
-        for (itmplt = 0; itmplt < ntmplt; itmplt++) {
-            tmp_abssnr =
-              sqrt((*isnr).re * (*isnr).re + (*isnr).im * (*isnr).im);
-            if (tmp_abssnr > tmp_maxsnr[ilen]) {
-                tmp_maxsnr[ilen]   = tmp_abssnr;
-                tmp_tmpltidx[ilen] = itmplt;
-            }
-            isnr++;
-        }
-    }
-    /* find the maxsnr acrros each tmplt */
-    for (ilen = 0; ilen < exe_len; ilen++) {
-        if (tmp_tmpltidx[ilen] > -1) {
-            /* find if the subsequential snr has larger snr,
-             * yes: continue to next sample point,
-             * no: save this snr and delete snr on other times of the same
-             * tmplt*/
-            for (jlen = ilen + 1; jlen < exe_len; jlen++) {
-                if (tmp_tmpltidx[jlen] == tmp_tmpltidx[ilen]
-                    && tmp_maxsnr[jlen] > tmp_maxsnr[ilen])
-                    break;
-                if (tmp_tmpltidx[jlen] == tmp_tmpltidx[ilen]
-                    && tmp_maxsnr[jlen] < tmp_maxsnr[ilen])
-                    tmp_tmpltidx[jlen] = -1;
-            }
-
-            if (jlen == exe_len && tmp_maxsnr[ilen] > snglsnr_thresh) {
-                len_idx[npeak]   = ilen;
-                tmplt_idx[npeak] = tmp_tmpltidx[ilen];
-                peak_pos[npeak]  = npeak;
-                npeak++;
-            }
-        }
-    }
-
-    /* keep track of the maximum single snr in this snr chunk */
-    for (ilen = 0; ilen < exe_len; ilen++) {
-        if (tmp_maxsnr[ilen] > state->snglsnr_max[cur_ifo])
-            state->snglsnr_max[cur_ifo] = tmp_maxsnr[ilen];
-    }
-
-    /* do clustering every PEAKFINDER_CLUSTER_WINDOW samples, FIXME: if set to
-     * 0, the size of output will be ten times */
-    int cluster_peak_pos[max_npeak], len_cluster_peak, len_next_peak,
-      final_peaks       = 0, ipeak;
-    cluster_peak_pos[0] = peak_pos[0];
-    for (ipeak = 0; ipeak < npeak - 1; ipeak++) {
-        if (peak_pos[ipeak + 1] - cluster_peak_pos[final_peaks]
-            > PEAKFINDER_CLUSTER_WINDOW) {
-            final_peaks++;
-            cluster_peak_pos[final_peaks] = peak_pos[ipeak + 1];
-        } else { // update the cluster_peak_pos if next peak pos has larger SNR
-            len_cluster_peak = len_idx[cluster_peak_pos[final_peaks]];
-            len_next_peak    = len_idx[peak_pos[ipeak + 1]];
-            if (tmp_maxsnr[len_cluster_peak] < tmp_maxsnr[len_next_peak])
-                cluster_peak_pos[final_peaks] = peak_pos[ipeak + 1];
-        }
-    }
-
-    npeak = npeak == 0 ? 0 : final_peaks + 1;
-    memcpy(peak_pos, cluster_peak_pos, sizeof(int) * npeak);
-    pklist->npeak[0] = npeak;
-
-    // printf("peaks_over_thresh , ifo %d, npeak %d\n", cur_ifo, npeak);
-    CUDA_CHECK(cudaMemcpyAsync(pklist->d_npeak, pklist->npeak,
-                               sizeof(int) * (pklist->peak_intlen),
-                               cudaMemcpyHostToDevice, stream));
-
-#if 0
-	CUDA_CHECK(cudaMemcpyAsync(	pklist->d_maxsnglsnr, 
-			pklist->maxsnglsnr, 
-			sizeof(float) * (pklist->peak_floatlen), 
-			cudaMemcpyHostToDevice,
-			stream));
-#endif
-    return npeak;
-}
-
 static void cuda_postcoh_process(GstCollectPads *pads,
                                  gint common_size,
                                  CudaPostcoh *postcoh) {
     GSList *collectlist;
     GstPostcohCollectData *data;
-    COMPLEX_F *snglsnr, *pos_dd_snglsnr, *pos_in_snglsnr;
+    COMPLEX_F *snglsnr, *d_snglsnr_buffer, *host_snglsnr[MAX_NIFO];
 
     int i = 0, cur_ifo = 0;
     PostcohState *state = postcoh->state;
@@ -1681,11 +1768,15 @@ static void cuda_postcoh_process(GstCollectPads *pads,
                       + gst_util_uint64_scale_int_round(
                         postcoh->samples_out, GST_SECOND, postcoh->rate);
 
-    /* Refresh the detector response U and Dt matrices if reached the refresh
-     * interval */
-    if (postcoh->refresh_interval > 0
-        && (ts - postcoh->t_roll_start) / GST_SECOND
-             > (unsigned)postcoh->refresh_interval) {
+    /* Bring the slices of an in-memory detector response map up to date for
+     * this time, or refresh the U and Dt matrices from file if reached the
+     * refresh interval */
+    if (postcoh->detrsp_map) {
+        cuda_postcoh_map_from_detrsp(postcoh->detrsp_map, postcoh->state,
+                                     ts / GST_SECOND, postcoh->stream);
+    } else if (postcoh->refresh_interval > 0
+               && (ts - postcoh->t_roll_start) / GST_SECOND
+                    > (unsigned)postcoh->refresh_interval) {
         postcoh->t_roll_start = ts;
         /* re-read matrices and send them to GPU */
         CUDA_CHECK(cudaSetDevice(postcoh->device_id));
@@ -1721,22 +1812,31 @@ static void cuda_postcoh_process(GstCollectPads *pads,
             cur_ifo = state->input_ifo_mapping[i];
             state->cur_ifo_is_gap[cur_ifo] =
               need_flag_gap(data, postcoh->next_exe_t, ts_exe_end);
-            state->snglsnr_max[cur_ifo] = 0;
-            PeakList *pklist            = state->peak_list[cur_ifo];
+            state->snglsnr_max[cur_ifo]    = 0;
 
             if (!state->cur_ifo_is_gap[cur_ifo]) {
                 state->cur_ifo_bits += 1 << cur_ifo;
                 state->cur_nifo += 1;
             }
 
-#ifdef ACCELERATE_POSTCOH_MEMORY_COPY
-            // temporal solution for low memory copy speed
-            snglsnr =
-              (COMPLEX_F *)gst_adapter_peek_cuda(data->adapter, one_take_size);
-#else
+            /* gather the chunk into a pinned staging slot and queue its
+             * transfer and transpose, the copy for this ifo then runs
+             * while the host looks for peaks in the same data */
             snglsnr =
-              (COMPLEX_F *)gst_adapter_peek(data->adapter, one_take_size);
-#endif
+              (COMPLEX_F *)postcoh_staging_acquire(postcoh->staging, cur_ifo);
+            gst_adapter_copy(data->adapter, (guint8 *)snglsnr, 0,
+                             one_take_size);
+            host_snglsnr[cur_ifo] = snglsnr;
+            d_snglsnr_buffer = (COMPLEX_F *)postcoh_staging_upload(
+              postcoh->staging, cur_ifo, one_take_size, postcoh->queue);
+            /* the new postcoh kernel optimized by Xiaoyang Guo needs the
+             * transposed matrix, this also moves the snr data to the right
+             * position in state->d_snglsnr[cur_ifo] */
+            transpose_snglsnr(d_snglsnr_buffer, state->d_snglsnr[cur_ifo],
+                              state->snglsnr_start_load, postcoh->one_take_len,
+                              state->snglsnr_len, state->ntmplt,
+                              postcoh->stream);
+
             c_npeak =
               peaks_over_thresh(snglsnr, state, cur_ifo, postcoh->stream);
 
@@ -1744,59 +1844,6 @@ static void cuda_postcoh_process(GstCollectPads *pads,
                              "gps %d, ifo %d, c_npeak %d, max_snglsnr %f\n",
                              ligo_time.gpsSeconds, cur_ifo, c_npeak,
                              state->snglsnr_max[cur_ifo]);
-
-            /*
-            // because you use new postcoh kernel optimized by Xiaoyang Guo now,
-            you cannot use
-            // the following memory copy code any more
-            // new postcoh kernel need transposed state->d_snglsnr[cur_ifo]
-            matrix and there is no transpose in the following code
-            pos_dd_snglsnr = state->d_snglsnr[cur_ifo] +
-            state->snglsnr_start_load * state->ntmplt;
-            // copy the snglsnr to the right cuda memory
-            if(state->snglsnr_start_load + one_take_len <= state->snglsnr_len){
-                    // when the snglsnr can be put in as one chunk
-                    CUDA_CHECK(cudaMemcpyAsync(pos_dd_snglsnr, snglsnr,
-            one_take_size, cudaMemcpyHostToDevice, postcoh->stream));
-                    GST_LOG("load snr to gpu as a chunk");
-            } else {
-
-                    int tail_cpy_size = (state->snglsnr_len -
-            state->snglsnr_start_load) * postcoh->bps;
-                    CUDA_CHECK(cudaMemcpyAsync(pos_dd_snglsnr, snglsnr,
-            tail_cpy_size, cudaMemcpyHostToDevice, postcoh->stream)); int
-            head_cpy_size = one_take_size - tail_cpy_size; pos_dd_snglsnr =
-            state->d_snglsnr[cur_ifo]; pos_in_snglsnr = snglsnr +
-            (state->snglsnr_len - state->snglsnr_start_load) * state->ntmplt;
-                    CUDA_CHECK(cudaMemcpyAsync(pos_dd_snglsnr, pos_in_snglsnr,
-            head_cpy_size, cudaMemcpyHostToDevice, postcoh->stream));
-                    GST_LOG("load snr to gpu as as two chunks");
-            }
-            */
-
-            // this is necessory for new postcoh kernel
-            // 1. expand temporal memory space if necessary
-            g_assert(pklist->len_snglsnr_buffer >= 0);
-            if (one_take_size > pklist->len_snglsnr_buffer) {
-                // re-malloc pklist->d_snglsnr_buffer
-                if (pklist->d_snglsnr_buffer != NULL) {
-                    cudaFree(pklist->d_snglsnr_buffer);
-                }
-                cudaMalloc((void **)&pklist->d_snglsnr_buffer, one_take_size);
-                pklist->len_snglsnr_buffer = one_take_size;
-            }
-            // 2. copy snglsnr to temporal gpu memory d_snglsnr_buffer
-            CUDA_CHECK(cudaMemcpyAsync(pklist->d_snglsnr_buffer, snglsnr,
-                                       one_take_size, cudaMemcpyHostToDevice,
-                                       postcoh->stream));
-            // 3. do transpose, at the same time, snr data will be moved to
-            // proper positions in state->d_snglsnr[cur_ifo]
-            transpose_snglsnr(
-              pklist->d_snglsnr_buffer, state->d_snglsnr[cur_ifo],
-              state->snglsnr_start_load, postcoh->one_take_len,
-              state->snglsnr_len, state->ntmplt, postcoh->stream);
-
-            cudaStreamSynchronize(postcoh->stream);
         }
         cur_ifo = 0;
         for (int iifo = 0; iifo < state->nifo; ++iifo)
@@ -1809,6 +1856,12 @@ static void cuda_postcoh_process(GstCollectPads *pads,
 
         g_assert(cur_ifo == state->cur_nifo);
 
+        /* single-IFO time: the peaks are final as found on the host, no
+         * coherent work is queued for them below */
+        cur_ifo = cuda_postcoh_sngl_ifo(state);
+        if (postcoh->sngl_output && cur_ifo >= 0)
+            cuda_postcoh_sngl_fill(state, cur_ifo, host_snglsnr[cur_ifo]);
+
         for (i = 0, collectlist = pads->data; collectlist;
              collectlist = g_slist_next(collectlist), i++) {
             data    = collectlist->data;
@@ -1830,6 +1883,9 @@ static void cuda_postcoh_process(GstCollectPads *pads,
                              exe_size);
             gst_adapter_flush(data->adapter, exe_size);
         }
+        /* the peak lists' pinned host arrays are reused by the next
+         * chunk, make sure their transfers are done */
+        CUDA_CHECK(cudaStreamSynchronize(postcoh->stream));
         common_size -= exe_size;
         int exe_len = state->exe_len;
         state->snglsnr_start_load =
@@ -1917,6 +1973,9 @@ static GstFlowReturn collected(GstCollectPads *pads, gpointer user_data) {
         }
 
         cuda_postcoh_process(pads, common_size, postcoh);
+        gstlal_element_stats_queue_level(
+          postcoh->stats, cuda_postcoh_queue_level(pads, postcoh));
+        gstlal_element_stats_processed(postcoh->stats);
 
     } else {
         postcoh->is_all_aligned = cuda_postcoh_align_collected(pads, postcoh);
@@ -1929,6 +1988,12 @@ static void cuda_postcoh_dispose(GObject *object) {
     if (element->collect) gst_object_unref(GST_OBJECT(element->collect));
     element->collect = NULL;
 
+    postcoh_staging_free(element->staging);
+    element->staging = NULL;
+    if (element->queue) element->backend->queue_free(element->queue);
+    element->queue  = NULL;
+    element->stream = NULL;
+
     if (element->state) {
         state_destroy(element->state);
         free(element->state);
@@ -1938,6 +2003,14 @@ static void cuda_postcoh_dispose(GObject *object) {
     if (element->srcpad) gst_object_unref(element->srcpad);
     element->srcpad = NULL;
 
+    detrsp_map_free(element->detrsp_map);
+    element->detrsp_map = NULL;
+    g_free(element->detrsp_ifo_horizons);
+    element->detrsp_ifo_horizons = NULL;
+
+    gstlal_element_stats_free(element->stats);
+    element->stats = NULL;
+
     g_mutex_free(element->prop_lock);
     g_cond_free(element->prop_avail);
 
@@ -2038,6 +2111,38 @@ static void cuda_postcoh_class_init(CudaPostcohClass *klass) {
         "detrsp-refresh-interval", "detector response refresh interval",
         "(0) never refresh stats; (N) refresh stats every N seconds. ", 0,
         G_MAXINT, 600, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+    g_object_class_install_property(
+      gobject_class, PROP_DETRSP_IFO_HORIZONS,
+      g_param_spec_string(
+        "detrsp-ifo-horizons", "Detector horizons for the response map",
+        "Generate the detector response map in memory instead of reading "
+        "detrsp-fname, e.g. H1:26,L1:52,V1:10 in the order of the detectors "
+        "in the map. Slices are regenerated as they go by and "
+        "detrsp-refresh-interval is not used.",
+        NULL, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+    g_object_class_install_property(
+      gobject_class, PROP_DETRSP_ORDER,
+      g_param_spec_int("detrsp-chealpix-order",
+                       "HEALPix order of the response map",
+                       "Order of the map generated for detrsp-ifo-horizons, "
+                       "4 = 3072 pixels. Must be set before it.",
+                       0, 29, DEFAULT_DETRSP_ORDER,
+                       G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+    g_object_class_install_property(
+      gobject_class, PROP_SNGL_OUTPUT,
+      g_param_spec_boolean(
+        "sngl-output", "single-detector output",
+        "Output single-detector triggers when only one detector has data. "
+        "The coherent search is skipped for these and their rows carry no "
+        "chisq or sky position.",
+        FALSE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+    /* the queue level is the input waiting in the fullest sink pad */
+    gstlal_element_stats_install_properties(gobject_class, PROP_STATS,
+                                            "samples");
 }
 
 static void cuda_postcoh_init(CudaPostcoh *postcoh, CudaPostcohClass *klass) {
@@ -2075,4 +2180,12 @@ static void cuda_postcoh_init(CudaPostcoh *postcoh, CudaPostcohClass *klass) {
     postcoh->cur_event_id          = 0;
     postcoh->t_roll_start          = GST_CLOCK_TIME_NONE;
     postcoh->refresh_interval      = 0;
+    postcoh->sngl_output           = FALSE;
+    postcoh->staging               = NULL;
+    postcoh->backend               = NULL;
+    postcoh->queue                 = NULL;
+    postcoh->detrsp_ifo_horizons   = NULL;
+    postcoh->detrsp_order          = DEFAULT_DETRSP_ORDER;
+    postcoh->detrsp_map            = NULL;
+    postcoh->stats = gstlal_element_stats_new(GST_ELEMENT(postcoh));
 }
@@ -25,7 +25,10 @@
 #include <gst/base/gstadapter.h>
 #include <gst/base/gstcollectpads.h>
 #include <gst/gst.h>
+#include <gstlal/gstlal_element_stats.h>
 #include <pipe_macro.h>
+#include <postcoh/postcoh_detrsp.h>
+#include <postcoh/postcoh_staging.h>
 
 // FIXME: hack for cuda-6.5 and lal header to work
 #ifndef __STDC_CONSTANT_MACROS
@@ -143,11 +146,6 @@ typedef struct _PeakList {
 
     float *d_peak_tmplt;
     float *d_maxsnglsnr; // for cuda peakfinder, not used now
-
-    float *d_snglsnr_buffer; // we need to copy data from CPU memory to this
-                             // buffer; then do transpose for new postcoh kernel
-                             // optimized by Xiaoyang Guo
-    int len_snglsnr_buffer;
 } PeakList;
 
 typedef struct _PostcohState {
@@ -254,6 +252,8 @@ struct _CudaPostcoh {
     float trial_interval;
     gint trial_interval_in_samples;
     gint output_skymap;
+    /* emit single-detector triggers during single-IFO time */
+    gboolean sngl_output;
 
     char *sngl_tmplt_fname;
     SnglInspiralTable *sngl_table;
@@ -266,9 +266,21 @@ struct _CudaPostcoh {
     /* book-keeping */
     long process_id;
     long cur_event_id;
+    const ComputeBackend *backend;
+    ComputeQueue *queue;
+    /* native handle of queue */
     cudaStream_t stream;
+    /* pinned host to device staging of the snr input */
+    PostcohStaging *staging;
     GstClockTime t_roll_start;
     int refresh_interval;
+    /* detector response map generated in memory, NULL if it is read from
+     * detrsp_fname */
+    char *detrsp_ifo_horizons;
+    gint detrsp_order;
+    DetrspMap *detrsp_map;
+
+    struct gstlal_element_stats *stats;
 };
 
 struct _CudaPostcohClass {
@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2026  The gstlal authors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Convert the binary table files written by postcoh_filesink with
+ * output-format=1 to the LIGO_LW XML files it writes by default.
+ *
+ *   gstlal_postcoh_bin_to_xml --input H1L1_1187008882_100.bin \
+ *       --output H1L1_1187008882_100.xml.gz
+ *
+ * The output is compressed unless --no-compression is given.
+ */
+#include <getopt.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <postcoh/postcohtable_utils.h>
+#include <stdlib.h>
+
+/* rows converted per read */
+#define ROWS_PER_READ 1024
+
+static void parse_opts(int argc,
+                       char *argv[],
+                       gchar **pin,
+                       gchar **pout,
+                       int *compress) {
+    int option_index          = 0;
+    struct option long_opts[] = {
+        // The binary file to convert.
+        { "input", required_argument, 0, 'i' },
+        // The XML file to write.
+        { "output", required_argument, 0, 'o' },
+        // Write the XML uncompressed.
+        { "no-compression", no_argument, 0, 'n' },
+        { 0, 0, 0, 0 }
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "i:o:n", long_opts, &option_index))
+           != -1) {
+        switch (opt) {
+        case 'i': *pin = g_strdup((gchar *)optarg); break;
+        case 'o': *pout = g_strdup((gchar *)optarg); break;
+        case 'n': *compress = 0; break;
+        default: exit(1);
+        }
+    }
+}
+
+int main(int argc, char *argv[]) {
+    gchar *in = NULL, *out = NULL;
+    int compress = 1;
+    FILE *fp;
+    xmlTextWriterPtr writer;
+    XmlTable xtable;
+    PostcohInspiralTable *rows;
+    GString *line;
+    gsize nrows, irow, total = 0;
+
+    parse_opts(argc, argv, &in, &out, &compress);
+    if (!in || !out) {
+        fprintf(stderr, "usage: %s --input file.bin --output file.xml.gz "
+                        "[--no-compression]\n",
+                argv[0]);
+        return 1;
+    }
+
+    fp = g_fopen(in, "rb");
+    if (!fp) {
+        fprintf(stderr, "unable to open %s\n", in);
+        return 1;
+    }
+    if (postcohtable_bin_read_header(fp) < 0) {
+        fprintf(stderr,
+                "%s is not a postcoh table file written by this version\n",
+                in);
+        fclose(fp);
+        return 1;
+    }
+
+    /* write to a temporary name so that a failed conversion leaves no
+     * truncated XML behind */
+    GString *tmp_out = g_string_new(out);
+    g_string_append_printf(tmp_out, "_next");
+    writer = xmlNewTextWriterFilename(tmp_out->str, compress);
+    if (!writer) {
+        fprintf(stderr, "unable to create %s\n", tmp_out->str);
+        fclose(fp);
+        return 1;
+    }
+    postcohtable_init(&xtable);
+    if (postcohtable_xml_start(writer, &xtable) < 0) goto write_failed;
+
+    rows = g_new(PostcohInspiralTable, ROWS_PER_READ);
+    line = g_string_new(NULL);
+    while ((nrows = fread(rows, sizeof(*rows), ROWS_PER_READ, fp)) > 0) {
+        for (irow = 0; irow < nrows; irow++) {
+            g_string_assign(line, "\t\t\t\t");
+            postcohtable_set_line(line, &rows[irow], &xtable);
+            if (xmlTextWriterWriteRaw(writer, BAD_CAST line->str) < 0)
+                goto write_failed;
+        }
+        total += nrows;
+    }
+    g_string_free(line, TRUE);
+    g_free(rows);
+
+    if (ferror(fp)) {
+        fprintf(stderr, "error reading %s\n", in);
+        goto write_failed;
+    }
+    fclose(fp);
+
+    if (postcohtable_xml_end(writer) < 0) goto write_failed;
+    xmlFreeTextWriter(writer);
+
+    if (g_rename(tmp_out->str, out) != 0) {
+        fprintf(stderr, "unable to rename to %s\n", out);
+        return 1;
+    }
+    fprintf(stderr, "converted %" G_GSIZE_FORMAT " rows\n", total);
+    g_string_free(tmp_out, TRUE);
+    g_free(in);
+    g_free(out);
+    return 0;
+
+write_failed:
+    fprintf(stderr, "error writing %s\n", tmp_out->str);
+    xmlFreeTextWriter(writer);
+    g_unlink(tmp_out->str);
+    return 1;
+}
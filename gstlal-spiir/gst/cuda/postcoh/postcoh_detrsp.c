@@ -0,0 +1,455 @@
+/*
+ * Copyright (C) 2026 The SPIIR authors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* The antenna patterns and time delays are those of
+ * XLALComputeDetAMResponse() and XLALArrivalTimeDiff(), written out so that
+ * the sidereal time and the trigonometry of each pixel are computed once
+ * per slice instead of once per detector pair. A block of pixels is
+ * processed one detector at a time with the pixel index innermost, so the
+ * loops below have no dependencies between pixels and vectorize. */
+
+#include <chealpix.h>
+#include <compute_backend.h>
+#include <float.h>
+#include <lal/Date.h>
+#include <lal/LALConstants.h>
+#include <lal/LALSimulation.h>
+#include <math.h>
+#include <postcoh/postcoh_detrsp.h>
+#include <string.h>
+
+/* pixels per block, the unit of work handed to the thread pool */
+#define DETRSP_BLOCK 256
+/* s2 / s1 below which the second singular vector is taken as undefined */
+#define DETRSP_EPS 1e-6
+
+DetrspMap *detrsp_map_new(char **ifos,
+                          gint nifo,
+                          const double *horizons,
+                          gint gps_step,
+                          unsigned order) {
+    DetrspMap *map;
+    const LALDetector *detector;
+    unsigned long ipix;
+    double theta, phi;
+    gint iifo, i;
+
+    map            = g_new0(DetrspMap, 1);
+    map->nifo      = nifo;
+    map->detectors = g_new(LALDetector, nifo);
+    map->horizons  = g_new(double, nifo);
+    for (iifo = 0; iifo < nifo; iifo++) {
+        /* lalCachedDetectors, copy it so the map owns its detectors */
+        detector = XLALDetectorPrefixToLALDetector(ifos[iifo]);
+        if (!detector) {
+            detrsp_map_free(map);
+            return NULL;
+        }
+        map->detectors[iifo] = *detector;
+        map->horizons[iifo]  = horizons[iifo];
+    }
+
+    map->order     = order;
+    map->nside     = (unsigned long)1 << order;
+    map->npix      = nside2npix(map->nside);
+    map->gps_step  = gps_step;
+    map->ngps      = DETRSP_SECONDS_IN_DAY / gps_step;
+    map->gps_start = -1;
+    map->slice_gps = g_new(long, map->ngps);
+    for (i = 0; i < map->ngps; i++) map->slice_gps[i] = -1;
+
+    map->cos_ra  = g_new(double, map->npix);
+    map->sin_ra  = g_new(double, map->npix);
+    map->cos_dec = g_new(double, map->npix);
+    map->sin_dec = g_new(double, map->npix);
+    for (ipix = 0; ipix < map->npix; ipix++) {
+        /* ra = phi, dec = pi/2 - theta, see bayestar healpix_lookup */
+        pix2ang_nest(map->nside, ipix, &theta, &phi);
+        map->cos_ra[ipix]  = cos(phi);
+        map->sin_ra[ipix]  = sin(phi);
+        map->cos_dec[ipix] = sin(theta);
+        map->sin_dec[ipix] = cos(theta);
+    }
+    return map;
+}
+
+void detrsp_map_free(DetrspMap *map) {
+    if (!map) return;
+    if (map->prefetch_thread) g_thread_join(map->prefetch_thread);
+    g_free(map->prefetch_U);
+    g_free(map->prefetch_diff);
+    g_free(map->detectors);
+    g_free(map->horizons);
+    g_free(map->slice_gps);
+    g_free(map->cos_ra);
+    g_free(map->sin_ra);
+    g_free(map->cos_dec);
+    g_free(map->sin_dec);
+    g_free(map);
+}
+
+gint detrsp_parse_ifo_horizons(const char *str,
+                               char ***ifos,
+                               double **horizons) {
+    gchar **items = g_strsplit(str, ",", -1);
+    gint nifo     = g_strv_length(items), iifo;
+    gchar *end;
+
+    *ifos     = g_new0(char *, nifo + 1);
+    *horizons = g_new(double, nifo);
+    for (iifo = 0; iifo < nifo; iifo++) {
+        gchar **pair = g_strsplit(items[iifo], ":", 2);
+        if (!pair[0] || !pair[1]) {
+            g_strfreev(pair);
+            nifo = 0;
+            break;
+        }
+        (*ifos)[iifo]     = g_strstrip(g_strdup(pair[0]));
+        (*horizons)[iifo] = g_ascii_strtod(pair[1], &end);
+        if (end == pair[1]) nifo = 0;
+        g_strfreev(pair);
+        if (!nifo) break;
+    }
+    g_strfreev(items);
+    if (!nifo) {
+        g_strfreev(*ifos);
+        g_free(*horizons);
+        *ifos     = NULL;
+        *horizons = NULL;
+    }
+    return nifo;
+}
+
+typedef struct _DetrspSliceArgs {
+    const DetrspMap *map;
+    double cos_gmst, sin_gmst;
+    float *U, *diff, *Det;
+} DetrspSliceArgs;
+
+/* Fill columns ncol.. of the row major nifo x nifo matrix u, whose first
+ * ncol columns are orthonormal, by Gram-Schmidt on the unit vectors. */
+static void complete_basis(double *u, gint nifo, gint ncol) {
+    double best_v[nifo], v[nifo], norm, best_norm;
+    gint col, k, i, c;
+
+    for (col = ncol; col < nifo; col++) {
+        best_norm = -1.;
+        for (k = 0; k < nifo; k++) {
+            for (i = 0; i < nifo; i++) v[i] = i == k;
+            for (c = 0; c < col; c++) {
+                /* projection of e_k on column c is u[k][c] */
+                double proj = u[k * nifo + c];
+                for (i = 0; i < nifo; i++) v[i] -= proj * u[i * nifo + c];
+            }
+            for (norm = 0., i = 0; i < nifo; i++) norm += v[i] * v[i];
+            if (norm > best_norm) {
+                best_norm = norm;
+                memcpy(best_v, v, sizeof(v));
+            }
+        }
+        norm = sqrt(best_norm);
+        for (i = 0; i < nifo; i++) u[i * nifo + col] = best_v[i] / norm;
+    }
+}
+
+static void detrsp_slice_host(guint block_start,
+                              guint block_end,
+                              gpointer data) {
+    const DetrspSliceArgs *args = data;
+    const DetrspMap *map        = args->map;
+    const gint nifo             = map->nifo;
+    const unsigned long npix    = map->npix;
+    const double cg = args->cos_gmst, sg = args->sin_gmst;
+    double *Ap    = g_new(double, nifo * DETRSP_BLOCK);
+    double *Ac    = g_new(double, nifo * DETRSP_BLOCK);
+    double *delay = g_new(double, nifo * DETRSP_BLOCK);
+    double *u     = g_new(double, nifo * nifo);
+    double a[DETRSP_BLOCK], b[DETRSP_BLOCK], c[DETRSP_BLOCK];
+    double ct[DETRSP_BLOCK], st[DETRSP_BLOCK];
+    double inv1[DETRSP_BLOCK], inv2[DETRSP_BLOCK], det[DETRSP_BLOCK];
+    gboolean fixup[DETRSP_BLOCK];
+    guint block;
+    gint iifo, jifo;
+    int k;
+
+    for (block = block_start; block < block_end; block++) {
+        const unsigned long p0 = (unsigned long)block * DETRSP_BLOCK;
+        const int n            = MIN(DETRSP_BLOCK, npix - p0);
+        const double *restrict cos_ra  = map->cos_ra + p0;
+        const double *restrict sin_ra  = map->sin_ra + p0;
+        const double *restrict cos_dec = map->cos_dec + p0;
+        const double *restrict sin_dec = map->sin_dec + p0;
+
+        /* antenna patterns and delays from the geocentre, psi = 0 */
+        for (iifo = 0; iifo < nifo; iifo++) {
+            const LALDetector *det = &map->detectors[iifo];
+            const double d00 = det->response[0][0], d01 = det->response[0][1],
+                         d02 = det->response[0][2], d11 = det->response[1][1],
+                         d12 = det->response[1][2], d22 = det->response[2][2];
+            const double r0 = det->location[0] / LAL_C_SI,
+                         r1 = det->location[1] / LAL_C_SI,
+                         r2 = det->location[2] / LAL_C_SI;
+            const double h = map->horizons[iifo];
+            double *restrict ap = Ap + iifo * DETRSP_BLOCK;
+            double *restrict ac = Ac + iifo * DETRSP_BLOCK;
+            double *restrict dt = delay + iifo * DETRSP_BLOCK;
+
+            for (k = 0; k < n; k++) {
+                /* gha = gmst - ra */
+                const double cosgha = cg * cos_ra[k] + sg * sin_ra[k];
+                const double singha = sg * cos_ra[k] - cg * sin_ra[k];
+                const double x0 = -singha, x1 = -cosgha;
+                const double y0 = -cosgha * sin_dec[k],
+                             y1 = singha * sin_dec[k], y2 = cos_dec[k];
+                const double dx0 = d00 * x0 + d01 * x1;
+                const double dx1 = d01 * x0 + d11 * x1;
+                const double dx2 = d02 * x0 + d12 * x1;
+                const double dy0 = d00 * y0 + d01 * y1 + d02 * y2;
+                const double dy1 = d01 * y0 + d11 * y1 + d12 * y2;
+                const double dy2 = d02 * y0 + d12 * y1 + d22 * y2;
+
+                ap[k] = h
+                        * (x0 * dx0 + x1 * dx1 - y0 * dy0 - y1 * dy1
+                           - y2 * dy2);
+                ac[k] = h
+                        * (x0 * dy0 + x1 * dy1 + y0 * dx0 + y1 * dx1
+                           + y2 * dx2);
+                dt[k] = -(cos_dec[k] * cosgha * r0 - cos_dec[k] * singha * r1
+                          + sin_dec[k] * r2);
+            }
+        }
+
+        /* A^T A = [[a, b], [b, c]] */
+        for (k = 0; k < n; k++) a[k] = b[k] = c[k] = 0.;
+        for (iifo = 0; iifo < nifo; iifo++) {
+            const double *restrict ap = Ap + iifo * DETRSP_BLOCK;
+            const double *restrict ac = Ac + iifo * DETRSP_BLOCK;
+            for (k = 0; k < n; k++) {
+                a[k] += ap[k] * ap[k];
+                b[k] += ap[k] * ac[k];
+                c[k] += ac[k] * ac[k];
+            }
+        }
+
+        /* eigen decomposition of A^T A: s^2 are the eigenvalues, V is the
+         * rotation by theta with tan(2 theta) = 2 b / (a - c). Written
+         * without branches so that it vectorizes, a zero s gives a zero
+         * inverse and the pixel is fixed up below. */
+        for (k = 0; k < n; k++) {
+            const double half_diff = (a[k] - c[k]) / 2.;
+            const double r  = sqrt(half_diff * half_diff + b[k] * b[k]);
+            const double l1 = (a[k] + c[k]) / 2. + r;
+            const double l2 = fmax((a[k] + c[k]) / 2. - r, 0.);
+            const double s1 = sqrt(l1), s2 = sqrt(l2);
+            /* any rotation will do if r = 0 */
+            const double cos2 = half_diff / fmax(r, DBL_MIN);
+            const double i1   = 1. / fmax(s1, DBL_MIN);
+            const double i2   = 1. / fmax(s2, DBL_MIN);
+
+            ct[k]    = sqrt((1. + cos2) / 2.);
+            st[k]    = copysign(sqrt(fmax((1. - cos2) / 2., 0.)), b[k]);
+            inv1[k]  = s1 > 0. ? i1 : 0.;
+            inv2[k]  = s2 > DETRSP_EPS * s1 ? i2 : 0.;
+            fixup[k] = (inv1[k] == 0.) | ((nifo > 1) & (inv2[k] == 0.));
+            det[k]   = l1 * l2;
+        }
+        if (args->Det)
+            for (k = 0; k < n; k++) args->Det[p0 + k] = (float)det[k];
+
+        if (args->U) {
+            float *U = args->U + p0;
+
+            /* u1 = A v1 / s1, u2 = A v2 / s2 */
+            for (iifo = 0; iifo < nifo; iifo++) {
+                const double *restrict ap = Ap + iifo * DETRSP_BLOCK;
+                const double *restrict ac = Ac + iifo * DETRSP_BLOCK;
+                float *restrict u0 = U + (iifo * nifo + 0) * npix;
+                for (k = 0; k < n; k++)
+                    u0[k] = (float)((ap[k] * ct[k] + ac[k] * st[k]) * inv1[k]);
+                if (nifo > 1) {
+                    float *restrict u1 = U + (iifo * nifo + 1) * npix;
+                    for (k = 0; k < n; k++)
+                        u1[k] =
+                          (float)((ac[k] * ct[k] - ap[k] * st[k]) * inv2[k]);
+                }
+            }
+
+            if (nifo == 3) {
+                /* u3 = u1 x u2 */
+                for (k = 0; k < n; k++) {
+                    const double u00 = U[0 * npix + k], u01 = U[1 * npix + k];
+                    const double u10 = U[3 * npix + k], u11 = U[4 * npix + k];
+                    const double u20 = U[6 * npix + k], u21 = U[7 * npix + k];
+                    U[2 * npix + k] = (float)(u10 * u21 - u20 * u11);
+                    U[5 * npix + k] = (float)(u20 * u01 - u00 * u21);
+                    U[8 * npix + k] = (float)(u00 * u11 - u10 * u01);
+                }
+            }
+
+            /* degenerate pixels and more than three detectors */
+            for (k = 0; k < n; k++) {
+                gint ncol, col;
+
+                if (!fixup[k] && nifo <= 3) continue;
+                ncol = inv1[k] == 0. ? 0 : (inv2[k] == 0. ? 1 : MIN(nifo, 2));
+                for (iifo = 0; iifo < nifo; iifo++) {
+                    const double ap = Ap[iifo * DETRSP_BLOCK + k];
+                    const double ac = Ac[iifo * DETRSP_BLOCK + k];
+                    if (ncol > 0)
+                        u[iifo * nifo + 0] =
+                          (ap * ct[k] + ac * st[k]) * inv1[k];
+                    if (ncol > 1)
+                        u[iifo * nifo + 1] =
+                          (ac * ct[k] - ap * st[k]) * inv2[k];
+                }
+                complete_basis(u, nifo, ncol);
+                for (iifo = 0; iifo < nifo; iifo++)
+                    for (col = 0; col < nifo; col++)
+                        U[(iifo * nifo + col) * npix + k] =
+                          (float)u[iifo * nifo + col];
+            }
+        }
+
+        if (args->diff) {
+            /* arrival time at jifo - arrival time at iifo */
+            for (iifo = 0; iifo < nifo; iifo++)
+                for (jifo = 0; jifo < nifo; jifo++) {
+                    const double *restrict dti = delay + iifo * DETRSP_BLOCK;
+                    const double *restrict dtj = delay + jifo * DETRSP_BLOCK;
+                    float *restrict out =
+                      args->diff + (iifo * nifo + jifo) * npix + p0;
+                    for (k = 0; k < n; k++) out[k] = (float)(dtj[k] - dti[k]);
+                }
+        }
+    }
+
+    g_free(Ap);
+    g_free(Ac);
+    g_free(delay);
+    g_free(u);
+}
+
+static const ComputeKernel detrsp_slice_kernel = {
+    .name = "detrsp_slice",
+    .host = detrsp_slice_host,
+    .cuda = NULL,
+};
+
+/* only reads the map, so it can run on the prefetch thread */
+static void generate_slice(const DetrspMap *map,
+                           long gps,
+                           float *U,
+                           float *diff,
+                           float *Det) {
+    LIGOTimeGPS gps_slice = { gps, 0 };
+    DetrspSliceArgs args;
+    double gmst;
+    guint nblocks = (map->npix + DETRSP_BLOCK - 1) / DETRSP_BLOCK;
+
+    gmst          = XLALGreenwichMeanSiderealTime(&gps_slice);
+    args.map      = map;
+    args.cos_gmst = cos(gmst);
+    args.sin_gmst = sin(gmst);
+    args.U        = U;
+    args.diff     = diff;
+    args.Det      = Det;
+    /* the host queue runs on the calling thread, no queue needed */
+    compute_backend_host()->dispatch(NULL, &detrsp_slice_kernel, nblocks,
+                                     &args);
+}
+
+void detrsp_map_generate_slice(DetrspMap *map,
+                               gint islice,
+                               long gps,
+                               float *U,
+                               float *diff,
+                               float *Det) {
+    g_assert(islice >= 0 && islice < map->ngps);
+    if (map->gps_start < 0) map->gps_start = gps - (long)islice * map->gps_step;
+
+    generate_slice(map, gps, U, diff, Det);
+    map->slice_gps[islice] = gps;
+}
+
+gint detrsp_map_next_stale(DetrspMap *map, long now, long until, long *gps) {
+    gint i, stale = -1;
+
+    if (map->gps_start < 0) map->gps_start = now;
+    for (i = 0; i < map->ngps; i++) {
+        long base = map->gps_start + (long)i * map->gps_step;
+        /* the first occurrence of the slice whose window, +- gps_step / 2
+         * as in timestamp_to_gps_idx(), has not ended. d is negative when
+         * the map was started ahead of now, round towards -infinity */
+        long d = now - map->gps_step / 2 - base;
+        long n = (d >= 0 ? d / DETRSP_SECONDS_IN_DAY
+                         : -((-d - 1) / DETRSP_SECONDS_IN_DAY) - 1)
+                 + 1;
+        long need = base + n * DETRSP_SECONDS_IN_DAY;
+        if (map->slice_gps[i] == need || need - map->gps_step / 2 >= until)
+            continue;
+        if (stale < 0 || need < *gps) {
+            stale = i;
+            *gps  = need;
+        }
+    }
+    return stale;
+}
+
+static gpointer prefetch_thread(gpointer data) {
+    DetrspMap *map = data;
+
+    generate_slice(map, map->prefetch_gps, map->prefetch_U,
+                   map->prefetch_diff, NULL);
+    g_atomic_int_set(&map->prefetch_done, TRUE);
+    return NULL;
+}
+
+gboolean detrsp_map_prefetch(DetrspMap *map, gint islice, long gps) {
+    gsize size = sizeof(float) * map->nifo * map->nifo * map->npix;
+
+    g_assert(islice >= 0 && islice < map->ngps);
+    g_assert(map->gps_start >= 0);
+    if (map->prefetch_thread) return FALSE;
+
+    if (!map->prefetch_U) {
+        map->prefetch_U    = g_malloc(size);
+        map->prefetch_diff = g_malloc(size);
+    }
+    map->prefetch_slice = islice;
+    map->prefetch_gps   = gps;
+    map->prefetch_done  = FALSE;
+    /* without a thread the slice is generated when it is needed */
+    map->prefetch_thread = g_thread_create(prefetch_thread, map, TRUE, NULL);
+    return map->prefetch_thread != NULL;
+}
+
+gint detrsp_map_collect_prefetch(DetrspMap *map,
+                                 gboolean wait,
+                                 const float **U,
+                                 const float **diff) {
+    if (!map->prefetch_thread) return -1;
+    if (!wait && !g_atomic_int_get(&map->prefetch_done)) return -1;
+
+    g_thread_join(map->prefetch_thread);
+    map->prefetch_thread                = NULL;
+    map->slice_gps[map->prefetch_slice] = map->prefetch_gps;
+    *U                                  = map->prefetch_U;
+    *diff                               = map->prefetch_diff;
+    return map->prefetch_slice;
+}
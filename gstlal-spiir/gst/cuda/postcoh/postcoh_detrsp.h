@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2026 The SPIIR authors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Detector response maps for the coherent search.
+ *
+ * For each HEALPix pixel (nested ordering) and each gps_step slice of a day
+ * the map holds
+ *
+ *   U     the nifo x nifo left singular vectors of the horizon weighted
+ *         antenna pattern matrix A[iifo] = horizon[iifo] * (F+, Fx) at
+ *         psi = 0, row major
+ *   diff  the nifo x nifo arrival time differences, diff[i][j] = arrival
+ *         time at ifo j - arrival time at ifo i
+ *   Det   det(A^T A) = s1^2 s2^2
+ *
+ * stored as [element][pixel] so a slice can be copied to the device as is.
+ * The SVD is done in closed form from the 2x2 matrix A^T A, the remaining
+ * columns of U are the cross product for three detectors and Gram-Schmidt
+ * otherwise. Singular vectors are only defined up to sign, which the
+ * coherent and null SNR do not depend on.
+ *
+ * Slices are generated on the host compute backend's thread pool, see
+ * compute_backend.h. A slice i is valid for gps_start + i * gps_step plus a
+ * whole number of days, and DetrspMap keeps track of which day each slice
+ * was last generated for so that a long-running analysis only regenerates
+ * the slices that have gone by. One slice at a time can be generated ahead
+ * of need on a background thread, which dispatches its blocks to the same
+ * pool.
+ */
+
+#ifndef __POSTCOH_DETRSP_H__
+#define __POSTCOH_DETRSP_H__
+
+#include <glib.h>
+#include <lal/LALDetectors.h>
+
+G_BEGIN_DECLS
+
+#define DETRSP_SECONDS_IN_DAY (24 * 3600)
+
+typedef struct _DetrspMap {
+    gint nifo;
+    LALDetector *detectors;
+    double *horizons;
+    unsigned order;
+    unsigned long nside;
+    unsigned long npix;
+    gint gps_step;
+    gint ngps;
+    /* -1 until the first slice is generated or looked up */
+    long gps_start;
+    /* gps time each slice was last generated for, -1 if never */
+    long *slice_gps;
+    /* sky position of each pixel */
+    double *cos_ra, *sin_ra, *cos_dec, *sin_dec;
+    /* the slice being generated in the background, NULL thread if none */
+    GThread *prefetch_thread;
+    gint prefetch_slice;
+    long prefetch_gps;
+    volatile gint prefetch_done;
+    float *prefetch_U, *prefetch_diff;
+} DetrspMap;
+
+/* ifos are detector prefixes, e.g. "H1". Returns NULL if one is unknown. */
+DetrspMap *detrsp_map_new(char **ifos,
+                          gint nifo,
+                          const double *horizons,
+                          gint gps_step,
+                          unsigned order);
+
+void detrsp_map_free(DetrspMap *map);
+
+/* Parse "H1:26,L1:52,V1:10" into detector prefixes and horizons. Returns
+ * the number of detectors, or 0 if the string is malformed. Free the
+ * results with g_strfreev() and g_free(). */
+gint detrsp_parse_ifo_horizons(const char *str,
+                               char ***ifos,
+                               double **horizons);
+
+/* Generate slice islice for gps time gps. U and diff hold nifo * nifo *
+ * npix floats and Det npix floats, any of them can be NULL. The first call
+ * fixes gps_start to gps - islice * gps_step. */
+void detrsp_map_generate_slice(DetrspMap *map,
+                               gint islice,
+                               long gps,
+                               float *U,
+                               float *diff,
+                               float *Det);
+
+/* Find the slice that is next used after now, up to but not including
+ * until, and has never been generated or was generated for another day.
+ * Returns the slice index and sets *gps to the time it should be generated
+ * for, or returns -1 if all slices used in that time are current. Pass
+ * G_MAXLONG for until to look at the whole day. If gps_start is not set yet
+ * the map starts at now. */
+gint detrsp_map_next_stale(DetrspMap *map, long now, long until, long *gps);
+
+/* Start generating slice islice for gps on a background thread. Only one
+ * prefetch is pending at a time: returns FALSE and does nothing if one has
+ * not been collected yet, or if no thread could be started. gps_start must
+ * be set. */
+gboolean detrsp_map_prefetch(DetrspMap *map, gint islice, long gps);
+
+/* Collect the pending prefetch, waiting for it if wait is set. Marks the
+ * slice generated and returns its index, with U and diff pointing at its
+ * arrays until the next prefetch. Returns -1 if nothing is pending or, if
+ * not waiting, it is still running. */
+gint detrsp_map_collect_prefetch(DetrspMap *map,
+                                 gboolean wait,
+                                 const float **U,
+                                 const float **diff);
+
+G_END_DECLS
+
+#endif /* __POSTCOH_DETRSP_H__ */
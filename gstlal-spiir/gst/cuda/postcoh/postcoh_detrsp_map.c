@@ -20,34 +20,16 @@
 /* This element will synchronize the snr sequencies from all detectors, find
  * peaks from all detectors and for each peak, do null stream analysis.
  */
+#include <compute_backend.h>
 #include <getopt.h>
 #include <gst/gst.h>
 #include <math.h>
 #include <pipe_macro.h>
-#include <postcoh/postcoh_utils.h>
+#include <postcoh/postcoh_detrsp.h>
 #include <stdlib.h>
 //
 
 #include <LIGOLwHeader.h>
-#include <chealpix.h>
-#include <lal/Date.h>
-#include <lal/DetResponse.h>
-#include <lal/LALDetectors.h>
-#include <lal/LALSimulation.h>
-#include <lal/LIGOMetadataTables.h> // SnglInspiralTable
-#include <lal/TimeDelay.h>
-
-#ifdef SPIIR_HAVE_LAPACKE
-#include <lapacke/lapacke.h>
-#include <lapacke/lapacke_config.h>
-#else
-#include <lapacke.h>
-#include <lapacke_config.h>
-#endif
-
-//#include <LIGOLw_xmllib/LIGOLwHeader.h>
-#include <math.h>
-#define min(a, b) ((a) > (b) ? (b) : (a))
 
 typedef struct _RspSkymap {
     char **ifos;
@@ -62,24 +44,8 @@ typedef struct _RspSkymap {
 } RspSkymap;
 
 /* get u matirx for each sky direction from detector response for each sky
- * direction at every minute
+ * direction at every gps_step, see postcoh_detrsp.h
  */
-LALDetector *const *create_detectors_from_name(char **ifos, int nifo) {
-    LALDetector **detectors =
-      (LALDetector **)malloc(sizeof(LALDetector *) * nifo);
-    const LALDetector *detector;
-    int i;
-    for (i = 0; i < nifo; i++) {
-        /* LALSimulation.c returns lalCachedDetectors defined in LALDetectors.h,
-         * NOTE: external type */
-        // printf("ifo%d %s\n", i, ifos[i]);
-        detector     = XLALDetectorPrefixToLALDetector(ifos[i]);
-        detectors[i] = (LALDetector *)malloc(sizeof(LALDetector));
-        memcpy(detectors[i], detector, sizeof(LALDetector));
-    }
-    return detectors;
-}
-
 RspSkymap *create_detresponse_skymap(char **ifos,
                                      int nifo,
                                      double *horizons,
@@ -87,122 +53,41 @@ RspSkymap *create_detresponse_skymap(char **ifos,
                                      unsigned order,
                                      long gps) {
     RspSkymap *rsp_map = (RspSkymap *)malloc(sizeof(RspSkymap));
-    // from 0h UTC 6 Jan 1980
-    // LIGOTimeGPS gps_cur = {0, 0};
-    LIGOTimeGPS gps_cur = { gps, 0 };
-    // current time
-    // LIGOTimeGPS *out_cur = XLALGPSTimeNow(&gps_cur);
-    // if (out_cur == NULL)
-    //	printf("can not find current gps time");
-    // printf("current gps time %d, %d for detector response\n",
-    // gps_cur.gpsSeconds, gps_cur.gpsNanoSeconds);
-    LIGOTimeGPS gps_start = { gps_cur.gpsSeconds, 0 };
-    LIGOTimeGPS gps_end   = { gps_cur.gpsSeconds + 24 * 3600, 0 };
-    LIGOTimeGPS gps_step  = { ingps_step, 0 };
-
-    int ngps;
-    ngps =
-      (int)(gps_end.gpsSeconds - gps_start.gpsSeconds) / gps_step.gpsSeconds;
-
-    rsp_map->gps_start      = gps_cur.gpsSeconds;
-    rsp_map->gps_step       = ingps_step;
-    rsp_map->matrix_size[0] = ngps;
+    DetrspMap *map =
+      detrsp_map_new(ifos, nifo, horizons, ingps_step, order);
+    int igps;
 
-    LALDetector *const *detectors = create_detectors_from_name(ifos, nifo);
-    rsp_map->nifo                 = nifo;
-    rsp_map->matrix_size[1]       = nifo * nifo;
+    if (map == NULL) {
+        fprintf(stderr, "unknown detector in ifo list\n");
+        exit(1);
+    }
 
-    unsigned long nside = (unsigned long)1 << order, npix = nside2npix(nside);
+    rsp_map->gps_start      = gps;
+    rsp_map->gps_step       = ingps_step;
     rsp_map->order          = order;
-    rsp_map->matrix_size[2] = npix;
-
-    int iifo, jifo;
+    rsp_map->nifo           = nifo;
+    rsp_map->matrix_size[0] = map->ngps;
+    rsp_map->matrix_size[1] = nifo * nifo;
+    rsp_map->matrix_size[2] = map->npix;
 
-    unsigned long Umap_len = (unsigned long)rsp_map->matrix_size[0]
-                             * (rsp_map->matrix_size)[1]
-                             * (rsp_map->matrix_size)[2];
     unsigned long Umatrix_len =
       (unsigned long)(rsp_map->matrix_size)[1] * (rsp_map->matrix_size)[2];
+    unsigned long Umap_len =
+      (unsigned long)rsp_map->matrix_size[0] * Umatrix_len;
     unsigned long Detmap_len =
       (unsigned long)(rsp_map->matrix_size)[0] * (rsp_map->matrix_size)[2];
-    // printf("u len %lu \n", Umap_len);
-    rsp_map->U_map = (float *)malloc(sizeof(float) * Umap_len);
-    memset(rsp_map->U_map, 0, sizeof(float) * Umap_len);
+    rsp_map->U_map    = (float *)malloc(sizeof(float) * Umap_len);
     rsp_map->diff_map = (float *)malloc(sizeof(float) * Umap_len);
-    memset(rsp_map->diff_map, 0, sizeof(float) * Umap_len);
-    rsp_map->Det_map = (float *)malloc(sizeof(float) * Detmap_len);
-    memset(rsp_map->Det_map, 0, sizeof(float) * Detmap_len);
-
-    double theta, phi, fplus, fcross, gmst;
-    unsigned long ipix;
-
-    double U[nifo * nifo], VT[2 * 2], S[2], diff[nifo * nifo], A[nifo * 2],
-      superb[min(nifo, 2) - 1];
-    lapack_int lda = 2, ldu = nifo, ldvt = 2, info;
-
-    unsigned long index = 0, igps = 0;
-
-    for (igps = 0, gps_cur.gpsSeconds = gps_start.gpsSeconds;
-         gps_cur.gpsSeconds < gps_end.gpsSeconds;
-         XLALGPSAdd(&gps_cur, ingps_step), igps++) {
-        for (ipix = 0; ipix < npix; ipix++) {
-            for (iifo = 0; iifo < nifo; iifo++) {
-
-                /* ra = phi, dec = pi/2 - theta , phi: longitude 0-2PI, theta
-                 * colatitude 0-PI, see bayestar lalinference plot.py
-                 * healpix_lookup */
-                pix2ang_nest(nside, ipix, &theta, &phi);
-
-                /* get fplus, fcross from lalsuite DetResponse.c */
-
-                gmst = XLALGreenwichMeanSiderealTime(&gps_cur);
-                /* polarization angle---psi must be set to zero */
-                XLALComputeDetAMResponse(&fplus, &fcross,
-                                         detectors[iifo]->response, phi,
-                                         M_PI_2 - theta, 0, gmst);
-
-                A[iifo * 2]     = fplus * horizons[iifo];
-                A[iifo * 2 + 1] = fcross * horizons[iifo];
-                // printf("igps %d, ipix %d, ra %f, dec %f, iifo %d, fplus %f,
-                // fcross %f, horizon %f \n", gps_cur.gpsSeconds, ipix, phi,
-                // M_PI_2-theta, iifo, fplus, fcross, horizons[iifo]);
-            }
-
-            /* TimeDelay.c */
-            /* note that in the c file, the function is calculating arrival_time
-             * from input1 - arrival_time from input2 */
-            for (iifo = 0; iifo < nifo; iifo++)
-                for (jifo = 0; jifo < nifo; jifo++)
-                    diff[iifo * nifo + jifo] = XLALArrivalTimeDiff(
-                      detectors[jifo]->location, detectors[iifo]->location, phi,
-                      M_PI_2 - theta, &gps_cur);
-            // printf("igps %d, ipix %d, ra %f, dec %f, A %f, %f, %f, %f, %f,
-            // %f, diff %f, %f, %f, %f, %f, %f\n", gps_cur.gpsSeconds, ipix,
-            // phi, M_PI_2-theta, A[0], A[1], A[2], A[3], A[4], A[5], diff[0],
-            // diff[1], diff[2], diff[3], diff[4], diff[5]);
-
-            /* compute SVD of A */
-            info = LAPACKE_dgesvd(LAPACK_ROW_MAJOR, 'A', 'A', nifo, 2, A, lda,
-                                  S, U, ldu, VT, ldvt, superb);
-
-            if (info > 0) {
-                printf("SVD of A matrix failed to converge. \n");
-                exit(1);
-            }
-
-            /* save the U and diff into U_map and diff_map */
-            for (iifo = 0; iifo < nifo * nifo; iifo++) {
-
-                index                 = igps * Umatrix_len + iifo * npix + ipix;
-                rsp_map->U_map[index] = (float)U[iifo];
-                rsp_map->diff_map[index] = (float)diff[iifo];
-                // printf("index %d diff %f\n", index, diff[i]);
-            }
-            /* save Det map */
-            rsp_map->Det_map[igps * npix + ipix] =
-              S[0] * S[0] * S[1] * S[1]; // det(G.T*G)
-        }
-    }
+    rsp_map->Det_map  = (float *)malloc(sizeof(float) * Detmap_len);
+
+    for (igps = 0; igps < map->ngps; igps++)
+        detrsp_map_generate_slice(
+          map, igps, gps + (long)igps * ingps_step,
+          rsp_map->U_map + igps * Umatrix_len,
+          rsp_map->diff_map + igps * Umatrix_len,
+          rsp_map->Det_map + (unsigned long)igps * map->npix);
+
+    detrsp_map_free(map);
     return rsp_map;
 }
 
@@ -349,7 +234,8 @@ static void parse_opts(int argc,
                        gchar **pnorder,
                        gchar **pgps,
                        gchar **pout_coh,
-                       gchar **pout_prob) {
+                       gchar **pout_prob,
+                       gchar **pnthreads) {
     int option_index          = 0;
     struct option long_opts[] = {
         { "ifo-horizons", required_argument, 0, 'i' },
@@ -357,10 +243,11 @@ static void parse_opts(int argc,
         { "output-coh-coeff", required_argument, 0, 'c' },
         { "output-prob-coeff", required_argument, 0, 'p' },
         { "gps-time", required_argument, 0, 'g' },
+        { "nthreads", required_argument, 0, 't' },
         { 0, 0, 0, 0 }
     };
     int opt;
-    while ((opt = getopt_long(argc, argv, "i:n:o:g:", long_opts, &option_index))
+    while ((opt = getopt_long(argc, argv, "i:n:o:g:t:", long_opts, &option_index))
            != -1) {
         switch (opt) {
         case 'i': *pin = g_strdup((gchar *)optarg); break;
@@ -368,6 +255,7 @@ static void parse_opts(int argc,
         case 'g': *pgps = g_strdup((gchar *)optarg); break;
         case 'c': *pout_coh = g_strdup((gchar *)optarg); break;
         case 'p': *pout_prob = g_strdup((gchar *)optarg); break;
+        case 't': *pnthreads = g_strdup((gchar *)optarg); break;
         default: exit(0);
         }
     }
@@ -379,8 +267,14 @@ int main(int argc, char *argv[]) {
     gchar **pgps      = (gchar **)malloc(sizeof(gchar *));
     gchar **pout_coh  = (gchar **)malloc(sizeof(gchar *));
     gchar **pout_prob = (gchar **)malloc(sizeof(gchar *));
-
-    parse_opts(argc, argv, pin, pnorder, pgps, pout_coh, pout_prob);
+    gchar **pnthreads = (gchar **)malloc(sizeof(gchar *));
+
+    *pnthreads = NULL;
+    parse_opts(argc, argv, pin, pnorder, pgps, pout_coh, pout_prob,
+               pnthreads);
+    /* 0, the default, is one thread per processor */
+    if (*pnthreads) compute_backend_host_set_nthreads(atoi(*pnthreads));
+    if (!g_thread_supported()) g_thread_init(NULL);
 
     gchar **in_ifo_strings = g_strsplit(*pin, ",", -1);
     gchar **one_ifo_string = NULL;
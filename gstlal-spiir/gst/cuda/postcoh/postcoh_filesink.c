@@ -37,7 +37,17 @@
 #include <string.h>
 
 #define EPSILON 5.0
-enum { PROP_0, PROP_LOCATION, PROP_COMPRESS, PROP_SNAPSHOT_INTERVAL };
+#define DEFAULT_QUEUE_SIZE 64
+enum {
+    PROP_0,
+    PROP_LOCATION,
+    PROP_COMPRESS,
+    PROP_SNAPSHOT_INTERVAL,
+    PROP_OUTPUT_FORMAT,
+    PROP_QUEUE_SIZE,
+    /* first of the gstlal_element_stats properties */
+    PROP_STATS
+};
 
 /* The following content is mostly copied from gstfilesink.c */
 
@@ -137,7 +147,8 @@ static void postcoh_filesink_base_init(gpointer g_class) {
     GstElementClass *gstelement_class = GST_ELEMENT_CLASS(g_class);
     gst_element_class_set_details_simple(
       gstelement_class, "Postcoh File Sink", "Sink/File",
-      "Write postcoh tables to a xml file", "Qi Chu <qi.chu at ligo dot org>");
+      "Write postcoh tables to xml or binary files",
+      "Qi Chu <qi.chu at ligo dot org>");
 
     gst_element_class_add_pad_template(
       gstelement_class,
@@ -175,6 +186,29 @@ static void postcoh_filesink_class_init(PostcohFilesinkClass *klass) {
         "How often to store postcoh table: (0) At the end, (N) Every N seconds",
         0, G_MAXINT, 0, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+    g_object_class_install_property(
+      gobject_class, PROP_OUTPUT_FORMAT,
+      g_param_spec_int("output-format", "Format of the table files",
+                       "(0) LIGO_LW XML, (1) binary rows, see "
+                       "gstlal_postcoh_bin_to_xml. Compression applies to "
+                       "XML only.",
+                       POSTCOH_FILESINK_FORMAT_XML,
+                       POSTCOH_FILESINK_FORMAT_BINARY,
+                       POSTCOH_FILESINK_FORMAT_XML,
+                       G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+    g_object_class_install_property(
+      gobject_class, PROP_QUEUE_SIZE,
+      g_param_spec_int("queue-size", "Writer queue size",
+                       "Number of buffers that may wait for the writer thread "
+                       "before the element blocks upstream.",
+                       1, G_MAXINT, DEFAULT_QUEUE_SIZE,
+                       G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+    /* the queue level is the buffers waiting for the writer thread */
+    gstlal_element_stats_install_properties(gobject_class, PROP_STATS,
+                                            "buffers");
+
     gstbasesink_class->start = GST_DEBUG_FUNCPTR(postcoh_filesink_start);
     gstbasesink_class->stop  = GST_DEBUG_FUNCPTR(postcoh_filesink_stop);
     //  gstbasesink_class->query = GST_DEBUG_FUNCPTR (postcoh_filesink_query);
@@ -189,6 +223,14 @@ static void postcoh_filesink_init(PostcohFilesink *sink,
     sink->uri      = NULL;
 
     sink->cur_filename = NULL;
+    sink->stats        = gstlal_element_stats_new(GST_ELEMENT(sink));
+
+    sink->output_format = POSTCOH_FILESINK_FORMAT_XML;
+    sink->queue_size    = DEFAULT_QUEUE_SIZE;
+    sink->writer_thread = NULL;
+    sink->queue_lock    = g_mutex_new();
+    sink->queue_changed = g_cond_new();
+    sink->queue         = g_queue_new();
     gst_base_sink_set_sync(GST_BASE_SINK(sink), FALSE);
 }
 
@@ -205,6 +247,14 @@ static void postcoh_filesink_dispose(GObject *object) {
         g_free(sink->filename);
         sink->filename = NULL;
     }
+    gstlal_element_stats_free(sink->stats);
+    sink->stats = NULL;
+    if (sink->queue) {
+        g_queue_free(sink->queue);
+        sink->queue = NULL;
+        g_mutex_free(sink->queue_lock);
+        g_cond_free(sink->queue_changed);
+    }
 }
 
 /* copied from gstreamer-0.10.36/ gstreamer/ gst/ gsturi.c */
@@ -361,7 +411,24 @@ static void postcoh_filesink_set_property(GObject *object,
     case PROP_SNAPSHOT_INTERVAL:
         sink->snapshot_interval = g_value_get_int(value);
         break;
-    default: G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec); break;
+    case PROP_OUTPUT_FORMAT:
+        if (sink->writer_thread)
+            g_warning("Changing the `output-format' property on "
+                      "postcoh_filesink when running is not supported.");
+        else
+            sink->output_format = g_value_get_int(value);
+        break;
+    case PROP_QUEUE_SIZE:
+        g_mutex_lock(sink->queue_lock);
+        sink->queue_size = g_value_get_int(value);
+        g_cond_broadcast(sink->queue_changed);
+        g_mutex_unlock(sink->queue_lock);
+        break;
+    default:
+        if (!gstlal_element_stats_set_property(sink->stats, prop_id - PROP_STATS,
+                                               value))
+            G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+        break;
     }
 }
 
@@ -377,7 +444,13 @@ static void postcoh_filesink_get_property(GObject *object,
     case PROP_SNAPSHOT_INTERVAL:
         g_value_set_int(value, sink->snapshot_interval);
         break;
-    default: G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec); break;
+    case PROP_OUTPUT_FORMAT: g_value_set_int(value, sink->output_format); break;
+    case PROP_QUEUE_SIZE: g_value_set_int(value, sink->queue_size); break;
+    default:
+        if (!gstlal_element_stats_get_property(sink->stats, prop_id - PROP_STATS,
+                                               value))
+            G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+        break;
     }
 }
 #if 0
@@ -435,124 +508,72 @@ close_failed:
 }
 #endif
 
+static const gchar *postcoh_filesink_suffix(PostcohFilesink *sink) {
+    return sink->output_format == POSTCOH_FILESINK_FORMAT_BINARY ? "bin"
+                                                                 : "xml.gz";
+}
+
 static gboolean postcoh_filesink_start_xml(PostcohFilesink *sink) {
     sink->writer =
       xmlNewTextWriterFilename(sink->cur_filename->str, sink->compress);
-    xmlTextWriterPtr writer = sink->writer;
-    if (writer == NULL) {
-        printf("testXmlwriterFilename: Error creating the xml writer\n");
+    if (sink->writer == NULL) {
+        GST_ERROR_OBJECT(sink, "error creating the xml writer for %s",
+                         sink->cur_filename->str);
         return FALSE;
     }
 
-    int rc;
-    rc = xmlTextWriterSetIndent(writer, 1);
-    rc = xmlTextWriterSetIndentString(writer, BAD_CAST "\t");
-
-    /* Start the document with the xml default for the version,
-     * encoding utf-8 and the default for the standalone
-     * declaration. */
-    rc = xmlTextWriterStartDocument(writer, NULL, MY_ENCODING, NULL);
-    if (rc < 0) {
-        printf("testXmlwriterFilename: Error at xmlTextWriterStartDocument\n");
-        return FALSE;
-    }
-
-    rc = xmlTextWriterWriteDTD(
-      writer, BAD_CAST "LIGO_LW", NULL,
-      BAD_CAST
-      "http://ldas-sw.ligo.caltech.edu/doc/ligolwAPI/html/ligolw_dtd.txt",
-      NULL);
-    if (rc < 0) {
-        printf("testXmlwriterFilename: Error at xmlTextWriterWriteDTD\n");
-        return FALSE;
-    }
+    sink->xtable = (XmlTable *)malloc(sizeof(XmlTable));
+    postcohtable_init(sink->xtable);
+    return postcohtable_xml_start(sink->writer, sink->xtable) == 0;
+}
 
-    /* Start an element named "LIGO_LW". Since thist is the first
-     * element, this will be the root element of the document. */
-    rc = xmlTextWriterStartElement(writer, BAD_CAST "LIGO_LW");
-    if (rc < 0) {
-        printf("testXmlwriterFilename: Error at xmlTextWriterStartElement\n");
-        return FALSE;
-    }
+static gboolean postcoh_filesink_start_bin(PostcohFilesink *sink) {
+    gchar *filename = g_filename_from_uri(sink->cur_filename->str, NULL, NULL);
 
-    /* Start an element named "LIGO_LW" as child of EXAMPLE. */
-    rc = xmlTextWriterStartElement(writer, BAD_CAST "LIGO_LW");
-    if (rc < 0) {
-        printf("testXmlwriterFilename: Error at xmlTextWriterStartElement\n");
+    sink->file = filename ? g_fopen(filename, "wb") : NULL;
+    if (sink->file == NULL) {
+        GST_ERROR_OBJECT(sink, "could not open %s for writing: %s",
+                         sink->cur_filename->str, g_strerror(errno));
+        g_free(filename);
         return FALSE;
     }
-
-    sink->xtable     = (XmlTable *)malloc(sizeof(XmlTable));
-    XmlTable *xtable = sink->xtable;
-    postcohtable_init(xtable);
-    // Add the Table Node
-    rc = xmlTextWriterStartElement(writer, BAD_CAST "Table");
-
-    // Add Attribute "Name"
-    rc = xmlTextWriterWriteAttribute(writer, BAD_CAST "Name",
-                                     BAD_CAST xtable->tableName->str);
-
-    // Write Column Nodes
-    int i;
-    for (i = 0; i < (int)xtable->names->len; ++i) {
-        rc = xmlTextWriterStartElement(writer, BAD_CAST "Column");
-
-        GString *colName = &g_array_index(xtable->names, GString, i);
-        GString *type    = &g_array_index(xtable->type_names, GString, i);
-
-        rc = xmlTextWriterWriteAttribute(writer, BAD_CAST "Type",
-                                         BAD_CAST type->str);
-        rc = xmlTextWriterWriteAttribute(writer, BAD_CAST "Name",
-                                         BAD_CAST colName->str);
-
-        rc = xmlTextWriterEndElement(writer);
-    }
-
-    // Write Stream Nodes
-    rc = xmlTextWriterStartElement(writer, BAD_CAST "Stream");
-    rc = xmlTextWriterWriteAttribute(writer, BAD_CAST "Delimiter",
-                                     BAD_CAST xtable->delimiter->str);
-    rc = xmlTextWriterWriteAttribute(writer, BAD_CAST "Type", BAD_CAST "Local");
-    rc = xmlTextWriterWriteAttribute(writer, BAD_CAST "Name",
-                                     BAD_CAST xtable->tableName->str);
-
-    rc = xmlTextWriterWriteString(writer, BAD_CAST "\n");
-    if (rc < 0) return FALSE;
-    else
-        return TRUE;
+    g_free(filename);
+    return postcohtable_bin_write_header(sink->file) == 0;
 }
 
-static gboolean postcoh_filesink_end_xml(PostcohFilesink *sink) {
-    xmlTextWriterPtr writer = sink->writer;
-    int rc                  = 0;
+/* open sink->cur_filename and write what precedes the rows */
+static gboolean postcoh_filesink_begin_file(PostcohFilesink *sink) {
+    if (sink->output_format == POSTCOH_FILESINK_FORMAT_BINARY)
+        return postcoh_filesink_start_bin(sink);
+    return postcoh_filesink_start_xml(sink);
+}
 
-    /* for stream */
-    rc = xmlTextWriterEndElement(writer);
-    if (rc < 0) {
-        printf("Error at xmlTextWriterEndElement\n");
-        return FALSE;
-    }
+/* write what follows the rows and close the file, keeping cur_filename */
+static gboolean postcoh_filesink_end_file(PostcohFilesink *sink) {
+    gboolean rt = TRUE;
 
-    /* for table */
-    xmlTextWriterEndElement(writer);
-    if (rc < 0) {
-        printf("Error at xmlTextWriterEndElement\n");
-        return FALSE;
+    if (sink->output_format == POSTCOH_FILESINK_FORMAT_BINARY) {
+        if (sink->file) {
+            rt         = fclose(sink->file) == 0;
+            sink->file = NULL;
+        }
+        return rt;
     }
 
-    /* for the whole document */
-    xmlTextWriterEndDocument(writer);
-    if (rc < 0) {
-        printf("Error at xmlTextWriterEndDocument\n");
-        return FALSE;
+    if (sink->writer) {
+        rt = postcohtable_xml_end(sink->writer) == 0;
+        xmlFreeTextWriter(sink->writer);
+        sink->writer = NULL;
     }
-    return TRUE;
+    return rt;
 }
 
 static gboolean postcoh_filesink_cleanup_xml(PostcohFilesink *sink) {
 
     if (sink->writer) xmlFreeTextWriter(sink->writer);
-    //  postcoh_filesink_close_file (sink);
+    sink->writer = NULL;
+    if (sink->file) fclose(sink->file);
+    sink->file = NULL;
     if (sink->xtable) {
         free(sink->xtable);
         sink->xtable = NULL;
@@ -581,15 +602,24 @@ static GstFlowReturn
     gboolean is_invalid = FALSE;
 
     GST_LOG_OBJECT(sink, "start to write postcoh table");
-    for (; table < table_end; table++) {
-        // is_invalid = postcoh_filesink_is_invalid_background(table);
-        if (!is_invalid) {
-            GString *line = g_string_new("\t\t\t\t");
-            postcohtable_set_line(line, table, xtable);
-            rc = xmlTextWriterWriteFormatRaw(sink->writer, line->str);
-            if (rc < 0) return GST_FLOW_ERROR;
-            g_string_free(line, TRUE);
+    if (sink->output_format == POSTCOH_FILESINK_FORMAT_BINARY) {
+        if (postcohtable_bin_write(sink->file, table, table_end - table) < 0)
+            return GST_FLOW_ERROR;
+    } else {
+        GString *line = g_string_new(NULL);
+        for (; table < table_end; table++) {
+            // is_invalid = postcoh_filesink_is_invalid_background(table);
+            if (!is_invalid) {
+                g_string_assign(line, "\t\t\t\t");
+                postcohtable_set_line(line, table, xtable);
+                rc = xmlTextWriterWriteRaw(sink->writer, BAD_CAST line->str);
+                if (rc < 0) {
+                    g_string_free(line, TRUE);
+                    return GST_FLOW_ERROR;
+                }
+            }
         }
+        g_string_free(line, TRUE);
     }
 
     GST_LOG_OBJECT(sink,
@@ -604,76 +634,42 @@ static GstFlowReturn
     return GST_FLOW_OK;
 }
 
-/* handle events (search) */
-static gboolean postcoh_filesink_event(GstBaseSink *basesink, GstEvent *event) {
-    GstEventType type;
-    PostcohFilesink *sink;
-
-    sink = POSTCOH_FILESINK(basesink);
-
-    type = GST_EVENT_TYPE(event);
-
-    switch (type) {
-    case GST_EVENT_EOS:
-        //	  if (fflush (sink->file))
-        //		goto flush_failed;
+/* finish the last file at EOS, on the writer thread */
+static GstFlowReturn postcoh_filesink_write_eos(PostcohFilesink *sink) {
+    GST_LOG_OBJECT(sink, "EVENT EOS. Finish writing document");
 
-        GST_LOG_OBJECT(sink, "EVENT EOS. Finish writing document");
+    /* nothing was written */
+    if (!sink->cur_filename) return GST_FLOW_OK;
 
-        gboolean rt = postcoh_filesink_end_xml(sink);
-        if (rt == FALSE) {
-            GST_ERROR_OBJECT(sink, "postcoh xml end writing failed");
-            return FALSE;
-        }
-        /* close current file */
-        if (sink->writer) {
-            xmlFreeTextWriter(sink->writer);
-            sink->writer = NULL;
-        }
+    if (!postcoh_filesink_end_file(sink)) {
+        GST_ERROR_OBJECT(sink, "postcoh file end writing failed");
+        return GST_FLOW_ERROR;
+    }
 
-        guint duration = (sink->t_end - sink->t_start) / GST_SECOND;
-        if (duration != (unsigned)sink->snapshot_interval) {
-            GString *new_filename = g_string_new(sink->uri);
-            gint gps_time         = sink->t_start / GST_SECOND;
-            g_string_append_printf(new_filename, "_%d_%d.xml.gz", gps_time,
-                                   duration);
-            /* rename does not recognize the first 7 chars "file://" so we need
-             * to remove that */
-            gchar *tmp_new_filename_str = g_strdup(&(new_filename->str[7]));
-            gchar *tmp_cur_filename_str =
-              g_strdup(&(sink->cur_filename->str[7]));
-            /* rename the current file to a proper name */
-            if (g_rename(tmp_cur_filename_str, tmp_new_filename_str) == -1) {
-                perror("Error when renaming");
-            }
-            g_string_free(new_filename, TRUE);
-            new_filename = NULL;
-            g_free(tmp_new_filename_str);
-            g_free(tmp_cur_filename_str);
+    guint duration = (sink->t_end - sink->t_start) / GST_SECOND;
+    if (duration != (unsigned)sink->snapshot_interval) {
+        GString *new_filename = g_string_new(sink->uri);
+        gint gps_time         = sink->t_start / GST_SECOND;
+        g_string_append_printf(new_filename, "_%d_%d.%s", gps_time, duration,
+                               postcoh_filesink_suffix(sink));
+        /* rename does not recognize the first 7 chars "file://" so we need
+         * to remove that */
+        gchar *tmp_new_filename_str = g_strdup(&(new_filename->str[7]));
+        gchar *tmp_cur_filename_str = g_strdup(&(sink->cur_filename->str[7]));
+        /* rename the current file to a proper name */
+        if (g_rename(tmp_cur_filename_str, tmp_new_filename_str) == -1) {
+            perror("Error when renaming");
         }
-        break;
-    default: break;
+        g_string_free(new_filename, TRUE);
+        new_filename = NULL;
+        g_free(tmp_new_filename_str);
+        g_free(tmp_cur_filename_str);
     }
-
-    return TRUE;
-
-    // return GST_BASE_SINK_CLASS (parent_class)->event (sink, event);
-#if 0
-flush_failed:
-  {
-	GST_ELEMENT_ERROR (sink, RESOURCE, WRITE,
-		(_("Error while writing to file \"%s\"."), sink->filename),
-		GST_ERROR_SYSTEM);
-	gst_event_unref (event);
-	return FALSE;
-  }
-#endif
+    return GST_FLOW_OK;
 }
 
-static GstFlowReturn postcoh_filesink_render(GstBaseSink *basesink,
-                                             GstBuffer *buf) {
-    PostcohFilesink *sink;
-    sink        = POSTCOH_FILESINK(basesink);
+static GstFlowReturn postcoh_filesink_write_buffer(PostcohFilesink *sink,
+                                                   GstBuffer *buf) {
     sink->t_end = GST_BUFFER_TIMESTAMP(buf) + GST_BUFFER_DURATION(buf);
 
     if (!GST_CLOCK_TIME_IS_VALID(sink->t_start)) {
@@ -683,15 +679,16 @@ static GstFlowReturn postcoh_filesink_render(GstBaseSink *basesink,
         sink->cur_filename = g_string_new(sink->uri);
         gint gps_time      = sink->t_start / GST_SECOND;
         if (sink->snapshot_interval)
-            g_string_append_printf(sink->cur_filename, "_%d_%d.xml.gz",
-                                   gps_time, sink->snapshot_interval);
+            g_string_append_printf(sink->cur_filename, "_%d_%d.%s", gps_time,
+                                   sink->snapshot_interval,
+                                   postcoh_filesink_suffix(sink));
         else
-            g_string_append_printf(sink->cur_filename, "_%d_end.xml.gz",
-                                   gps_time);
+            g_string_append_printf(sink->cur_filename, "_%d_end.%s", gps_time,
+                                   postcoh_filesink_suffix(sink));
 
-        gboolean rt = postcoh_filesink_start_xml(sink);
+        gboolean rt = postcoh_filesink_begin_file(sink);
         if (rt == FALSE) {
-            GST_ERROR_OBJECT(sink, "postcoh xml header writing failed");
+            GST_ERROR_OBJECT(sink, "postcoh file header writing failed");
             return GST_FLOW_ERROR;
         }
         GstFlowReturn rs = postcoh_filesink_write_table_from_buf(sink, buf);
@@ -703,25 +700,26 @@ static GstFlowReturn postcoh_filesink_render(GstBaseSink *basesink,
         && (t_cur - sink->t_start) / GST_SECOND
              > (unsigned)sink->snapshot_interval) {
 
-        gboolean rt = postcoh_filesink_end_xml(sink);
+        gboolean rt = postcoh_filesink_end_file(sink);
         if (rt == FALSE) {
-            GST_ERROR_OBJECT(sink, "postcoh xml end writing failed");
+            GST_ERROR_OBJECT(sink, "postcoh file end writing failed");
             return GST_FLOW_ERROR;
         }
 
         postcoh_filesink_cleanup_xml(sink);
 
-        /* Create a new xml file for postcoh table */
+        /* Create a new file for postcoh table */
         sink->t_start = t_cur;
         // This is the filename prefix.
         g_assert(sink->uri);
         sink->cur_filename = g_string_new(sink->uri);
         gint gps_time      = sink->t_start / GST_SECOND;
-        g_string_append_printf(sink->cur_filename, "_%d_%d.xml.gz", gps_time,
-                               sink->snapshot_interval);
-        rt = postcoh_filesink_start_xml(sink);
+        g_string_append_printf(sink->cur_filename, "_%d_%d.%s", gps_time,
+                               sink->snapshot_interval,
+                               postcoh_filesink_suffix(sink));
+        rt = postcoh_filesink_begin_file(sink);
         if (rt == FALSE) {
-            GST_ERROR_OBJECT(sink, "postcoh xml header writing failed");
+            GST_ERROR_OBJECT(sink, "postcoh file header writing failed");
             return GST_FLOW_ERROR;
         }
     }
@@ -729,15 +727,158 @@ static GstFlowReturn postcoh_filesink_render(GstBaseSink *basesink,
     return rs;
 }
 
+/*
+ * The writer thread. Buffers and the EOS event are queued by the streaming
+ * thread and are formatted, compressed and written here, so that slow disks
+ * or compression hold up the pipeline only once the queue is full.
+ */
+static gpointer postcoh_filesink_writer(gpointer data) {
+    PostcohFilesink *sink = POSTCOH_FILESINK(data);
+    GstMiniObject *obj;
+    GstFlowReturn rs;
+
+    g_mutex_lock(sink->queue_lock);
+    while (TRUE) {
+        while (g_queue_is_empty(sink->queue) && !sink->writer_stop)
+            g_cond_wait(sink->queue_changed, sink->queue_lock);
+        if (g_queue_is_empty(sink->queue)) break;
+
+        obj               = g_queue_pop_head(sink->queue);
+        sink->writer_busy = TRUE;
+        rs                = sink->writer_result;
+        g_cond_broadcast(sink->queue_changed);
+        g_mutex_unlock(sink->queue_lock);
+
+        /* after an error, only drain the queue */
+        if (rs == GST_FLOW_OK) {
+            if (GST_IS_BUFFER(obj)) {
+                GstBuffer *buf = GST_BUFFER(obj);
+                rs             = postcoh_filesink_write_buffer(sink, buf);
+                gstlal_element_stats_output(sink->stats,
+                                            GST_BUFFER_TIMESTAMP(buf)
+                                              + GST_BUFFER_DURATION(buf));
+            } else
+                rs = postcoh_filesink_write_eos(sink);
+        }
+        gst_mini_object_unref(obj);
+
+        g_mutex_lock(sink->queue_lock);
+        if (rs != GST_FLOW_OK && sink->writer_result == GST_FLOW_OK) {
+            GST_ELEMENT_ERROR(sink, RESOURCE, WRITE, (NULL),
+                              ("failed to write postcoh table to %s",
+                               sink->cur_filename ? sink->cur_filename->str
+                                                  : sink->uri));
+            sink->writer_result = rs;
+        }
+        sink->writer_busy = FALSE;
+        g_cond_broadcast(sink->queue_changed);
+    }
+    g_mutex_unlock(sink->queue_lock);
+
+    return NULL;
+}
+
+/* wait for the writer thread to empty the queue */
+static GstFlowReturn postcoh_filesink_drain(PostcohFilesink *sink) {
+    GstFlowReturn rs;
+
+    g_mutex_lock(sink->queue_lock);
+    while (!g_queue_is_empty(sink->queue) || sink->writer_busy)
+        g_cond_wait(sink->queue_changed, sink->queue_lock);
+    rs = sink->writer_result;
+    g_mutex_unlock(sink->queue_lock);
+    return rs;
+}
+
+/* handle events (search) */
+static gboolean postcoh_filesink_event(GstBaseSink *basesink, GstEvent *event) {
+    GstEventType type;
+    PostcohFilesink *sink;
+
+    sink = POSTCOH_FILESINK(basesink);
+
+    type = GST_EVENT_TYPE(event);
+
+    switch (type) {
+    case GST_EVENT_EOS:
+        /* the files must be complete when EOS reaches the application */
+        g_mutex_lock(sink->queue_lock);
+        g_queue_push_tail(sink->queue, gst_event_ref(event));
+        g_cond_broadcast(sink->queue_changed);
+        g_mutex_unlock(sink->queue_lock);
+
+        if (postcoh_filesink_drain(sink) != GST_FLOW_OK) {
+            GST_ERROR_OBJECT(sink, "postcoh file end writing failed");
+            return FALSE;
+        }
+        break;
+    default: break;
+    }
+
+    return TRUE;
+
+    // return GST_BASE_SINK_CLASS (parent_class)->event (sink, event);
+}
+
+static GstFlowReturn postcoh_filesink_render(GstBaseSink *basesink,
+                                             GstBuffer *buf) {
+    PostcohFilesink *sink = POSTCOH_FILESINK(basesink);
+    GstFlowReturn rs;
+    guint level;
+
+    gstlal_element_stats_input(sink->stats, buf);
+
+    g_mutex_lock(sink->queue_lock);
+    while (g_queue_get_length(sink->queue) >= (guint)sink->queue_size
+           && sink->writer_result == GST_FLOW_OK)
+        g_cond_wait(sink->queue_changed, sink->queue_lock);
+    rs = sink->writer_result;
+    if (rs == GST_FLOW_OK) {
+        g_queue_push_tail(sink->queue, gst_buffer_ref(buf));
+        g_cond_broadcast(sink->queue_changed);
+    }
+    level = g_queue_get_length(sink->queue);
+    g_mutex_unlock(sink->queue_lock);
+
+    /* the output is recorded by the writer thread once it is on disk */
+    gstlal_element_stats_queue_level(sink->stats, level);
+    gstlal_element_stats_processed(sink->stats);
+    return rs;
+}
+
 static gboolean postcoh_filesink_start(GstBaseSink *basesink) {
     PostcohFilesink *sink = POSTCOH_FILESINK(basesink);
-    sink->t_start         = GST_CLOCK_TIME_NONE;
+    GError *error         = NULL;
+
+    sink->t_start       = GST_CLOCK_TIME_NONE;
+    sink->writer_stop   = FALSE;
+    sink->writer_busy   = FALSE;
+    sink->writer_result = GST_FLOW_OK;
+    sink->writer_thread =
+      g_thread_create(postcoh_filesink_writer, sink, TRUE, &error);
+    if (!sink->writer_thread) {
+        GST_ELEMENT_ERROR(sink, RESOURCE, FAILED, (NULL),
+                          ("could not start the writer thread: %s",
+                           error->message));
+        g_error_free(error);
+        return FALSE;
+    }
     return TRUE;
 }
 
 static gboolean postcoh_filesink_stop(GstBaseSink *basesink) {
 
     PostcohFilesink *sink = POSTCOH_FILESINK(basesink);
+
+    if (sink->writer_thread) {
+        g_mutex_lock(sink->queue_lock);
+        sink->writer_stop = TRUE;
+        g_cond_broadcast(sink->queue_changed);
+        g_mutex_unlock(sink->queue_lock);
+        g_thread_join(sink->writer_thread);
+        sink->writer_thread = NULL;
+    }
+
     postcoh_filesink_cleanup_xml(sink);
     return TRUE;
 }
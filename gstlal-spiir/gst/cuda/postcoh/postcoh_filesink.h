@@ -23,6 +23,7 @@
 #include <LIGOLwHeader.h>
 #include <gst/base/gstbasesink.h>
 #include <gst/gst.h>
+#include <gstlal/gstlal_element_stats.h>
 #include <stdio.h>
 
 G_BEGIN_DECLS
@@ -41,6 +42,11 @@ G_BEGIN_DECLS
 typedef struct _PostcohFilesink PostcohFilesink;
 typedef struct _PostcohFilesinkClass PostcohFilesinkClass;
 
+typedef enum {
+    POSTCOH_FILESINK_FORMAT_XML = 0,
+    POSTCOH_FILESINK_FORMAT_BINARY
+} PostcohFilesinkFormat;
+
 /**
  * PostcohFilesink:
  *
@@ -62,6 +68,19 @@ struct _PostcohFilesink {
     GstClockTime t_start;
     GstClockTime t_end;
     GString *cur_filename;
+    gint output_format;
+
+    /* the writer thread and the buffers and EOS waiting for it */
+    gint queue_size;
+    GThread *writer_thread;
+    GMutex *queue_lock;
+    GCond *queue_changed;
+    GQueue *queue;
+    gboolean writer_stop;
+    gboolean writer_busy;
+    GstFlowReturn writer_result;
+
+    struct gstlal_element_stats *stats;
 };
 
 struct _PostcohFilesinkClass {
@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2026 The SPIIR authors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <postcoh/postcoh_staging.h>
+#include <string.h>
+
+PostcohStaging *postcoh_staging_new(const ComputeBackend *backend,
+                                    gint nifo,
+                                    gsize slot_size) {
+    PostcohStaging *staging = g_new0(PostcohStaging, 1);
+    int iifo, islot;
+
+    staging->backend   = backend;
+    staging->nifo      = nifo;
+    staging->slot_size = slot_size;
+    staging->ring      = g_new0(PostcohStagingRing, nifo);
+
+    for (iifo = 0; iifo < nifo; iifo++) {
+        PostcohStagingRing *ring = &staging->ring[iifo];
+        for (islot = 0; islot < POSTCOH_STAGING_NSLOT; islot++) {
+            ring->slot[islot].host      = backend->host_alloc(slot_size);
+            ring->slot[islot].device    = backend->device_alloc(slot_size);
+            ring->slot[islot].event     = backend->event_new();
+            ring->slot[islot].in_flight = FALSE;
+        }
+        /* so that the first acquire hands out slot 0 */
+        ring->cur = POSTCOH_STAGING_NSLOT - 1;
+    }
+    return staging;
+}
+
+void postcoh_staging_free(PostcohStaging *staging) {
+    const ComputeBackend *backend;
+    int iifo, islot;
+
+    if (!staging) return;
+    backend = staging->backend;
+    postcoh_staging_drain(staging);
+    for (iifo = 0; iifo < staging->nifo; iifo++) {
+        PostcohStagingRing *ring = &staging->ring[iifo];
+        for (islot = 0; islot < POSTCOH_STAGING_NSLOT; islot++) {
+            backend->host_free(ring->slot[islot].host);
+            backend->device_free(ring->slot[islot].device);
+            backend->event_free(ring->slot[islot].event);
+        }
+    }
+    g_free(staging->ring);
+    g_free(staging);
+}
+
+/* Return the next host slot of ifo's ring for the caller to fill. Blocks if
+ * the transfer last issued from that slot has not completed. The pointer
+ * stays valid, and its contents untouched, until the slot comes round again
+ * POSTCOH_STAGING_NSLOT acquires later. */
+void *postcoh_staging_acquire(PostcohStaging *staging, gint ifo) {
+    PostcohStagingRing *ring = &staging->ring[ifo];
+    PostcohStagingSlot *slot;
+
+    ring->cur = (ring->cur + 1) % POSTCOH_STAGING_NSLOT;
+    slot      = &ring->slot[ring->cur];
+    if (slot->in_flight) {
+        staging->nstall++;
+        staging->backend->event_wait(slot->event);
+        slot->in_flight = FALSE;
+    }
+    return slot->host;
+}
+
+/* Queue the transfer of the first size bytes of the slot handed out by the
+ * last acquire into that slot's device buffer and return the buffer.
+ * Anything queued on queue afterwards sees the data; the host does not
+ * wait. The device buffer is not written again until the slot comes round,
+ * and that transfer is queued behind everything queued before it. */
+void *postcoh_staging_upload(PostcohStaging *staging,
+                             gint ifo,
+                             gsize size,
+                             ComputeQueue *queue) {
+    PostcohStagingRing *ring = &staging->ring[ifo];
+    PostcohStagingSlot *slot = &ring->slot[ring->cur];
+
+    g_assert(size <= staging->slot_size);
+    staging->backend->copy_async(slot->device, slot->host, size,
+                                 COMPUTE_COPY_HOST_TO_DEVICE, queue);
+    staging->backend->event_record(slot->event, queue);
+    slot->in_flight = TRUE;
+    return slot->device;
+}
+
+/* wait for every outstanding transfer */
+void postcoh_staging_drain(PostcohStaging *staging) {
+    int iifo, islot;
+
+    for (iifo = 0; iifo < staging->nifo; iifo++)
+        for (islot = 0; islot < POSTCOH_STAGING_NSLOT; islot++) {
+            PostcohStagingSlot *slot = &staging->ring[iifo].slot[islot];
+            if (slot->in_flight) {
+                staging->backend->event_wait(slot->event);
+                slot->in_flight = FALSE;
+            }
+        }
+}
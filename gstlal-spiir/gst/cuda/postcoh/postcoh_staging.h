@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2026 The SPIIR authors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Host-to-device staging of the per-IFO SNR chunks consumed by postcoh.
+ *
+ * Each IFO owns a ring of POSTCOH_STAGING_NSLOT slots, each a page-locked
+ * host buffer and the device buffer it is copied to. A chunk is gathered
+ * from the adapter straight into the next host slot, its transfer is queued
+ * on the stream without waiting, and the host copy stays valid for the CPU
+ * peakfinder while the transfer and transpose run. The next chunk lands in
+ * the other slot's device buffer, so its transfer cannot overwrite data a
+ * kernel queued for the previous chunk is still reading. A slot is only
+ * waited on when it comes round again, i.e. after the transfer queued
+ * POSTCOH_STAGING_NSLOT - 1 chunks later has been issued.
+ *
+ * The memory and transfer primitives come from a ComputeBackend, so with
+ * the host backend the ring logic builds and runs without a GPU.
+ */
+
+#ifndef __POSTCOH_STAGING_H__
+#define __POSTCOH_STAGING_H__
+
+#include <compute_backend.h>
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+#define POSTCOH_STAGING_NSLOT 2
+
+typedef struct _PostcohStagingSlot {
+    void *host;
+    void *device;
+    ComputeEvent *event;
+    gboolean in_flight;
+} PostcohStagingSlot;
+
+typedef struct _PostcohStagingRing {
+    PostcohStagingSlot slot[POSTCOH_STAGING_NSLOT];
+    guint cur; /* slot handed out by the last acquire */
+} PostcohStagingRing;
+
+typedef struct _PostcohStaging {
+    const ComputeBackend *backend;
+    gint nifo;
+    gsize slot_size;
+    PostcohStagingRing *ring;
+    /* number of acquires that had to wait for an earlier transfer */
+    guint64 nstall;
+} PostcohStaging;
+
+PostcohStaging *postcoh_staging_new(const ComputeBackend *backend,
+                                    gint nifo,
+                                    gsize slot_size);
+
+void postcoh_staging_free(PostcohStaging *staging);
+
+void *postcoh_staging_acquire(PostcohStaging *staging, gint ifo);
+
+void *postcoh_staging_upload(PostcohStaging *staging,
+                             gint ifo,
+                             gsize size,
+                             ComputeQueue *queue);
+
+void postcoh_staging_drain(PostcohStaging *staging);
+
+G_END_DECLS
+
+#endif /* __POSTCOH_STAGING_H__ */
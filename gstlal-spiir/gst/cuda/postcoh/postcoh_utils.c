@@ -21,12 +21,14 @@
 #include <cuda_debug.h>
 #include <cuda_runtime.h>
 #include <gst/gst.h>
+#include <math.h>
 #include <pipe_macro.h> // for IFOComboMap
 #include <postcoh/postcoh_utils.h>
 #include <postcohtable.h>
 
 //#define __DEBUG__ 0
-#define NSNGL_TMPLT_COLS 15
+#define NSNGL_TMPLT_COLS          15
+#define PEAKFINDER_CLUSTER_WINDOW 5
 
 void cuda_device_print(int deviceCount) {
     int dev, driverVersion = 0, runtimeVersion = 0;
@@ -324,10 +326,6 @@ PeakList *create_peak_list(PostcohState *state, cudaStream_t stream) {
     CUDA_CHECK(cudaMemsetAsync(pklist->d_peak_tmplt, 0,
                                sizeof(float) * state->ntmplt, stream));
 
-    // add for new postcoh kernel optimized by Xiaoyang Guo
-    pklist->d_snglsnr_buffer   = NULL;
-    pklist->len_snglsnr_buffer = 0;
-
     int mem_alloc_size = sizeof(float) * state->npix * 2;
     printf("alloc cohsnr_skymap size %f MB\n", (float)mem_alloc_size / 1000000);
 
@@ -559,6 +557,87 @@ void cuda_postcoh_map_from_xml(char *fname,
     free(xns);
 }
 
+static void map_destroy(PostcohState *state);
+
+/* Allocate the device maps for a map that is generated in memory, replacing
+ * any read from xml. The slices are filled in by
+ * cuda_postcoh_map_from_detrsp(). */
+void cuda_postcoh_map_init_detrsp(DetrspMap *map, PostcohState *state) {
+    int i, mem_alloc_size = sizeof(float) * map->nifo * map->nifo * map->npix;
+
+    if (state->npix != POSTCOH_PARAMS_NOT_INIT) map_destroy(state);
+
+    state->gps_step   = map->gps_step;
+    state->gps_start  = map->gps_start;
+    state->nside      = map->nside;
+    state->d_U_map    = (float **)malloc(sizeof(float *) * map->ngps);
+    state->d_diff_map = (float **)malloc(sizeof(float *) * map->ngps);
+    for (i = 0; i < map->ngps; i++) {
+        CUDA_CHECK(cudaMalloc((void **)&(state->d_U_map[i]), mem_alloc_size));
+        CUDA_CHECK(
+          cudaMalloc((void **)&(state->d_diff_map[i]), mem_alloc_size));
+    }
+    /* label that the map has been initialized */
+    state->npix = map->npix;
+}
+
+static void map_copy_slice(PostcohState *state,
+                           int islice,
+                           const float *U,
+                           const float *diff,
+                           int mem_alloc_size,
+                           cudaStream_t stream) {
+    CUDA_CHECK(cudaMemcpyAsync(state->d_U_map[islice], U, mem_alloc_size,
+                               cudaMemcpyHostToDevice, stream));
+    CUDA_CHECK(cudaMemcpyAsync(state->d_diff_map[islice], diff,
+                               mem_alloc_size, cudaMemcpyHostToDevice,
+                               stream));
+    /* U and diff are reused for the next slice */
+    CUDA_CHECK(cudaStreamSynchronize(stream));
+}
+
+/* Make the slices of the map used between gps time now and one gps_step
+ * later current on the device, then start generating the next slice to be
+ * needed in the background. Each call copies over the slice finished since
+ * the last, so the rest of the day is generated ahead of need one slice at
+ * a time and most calls only check. */
+void cuda_postcoh_map_from_detrsp(DetrspMap *map,
+                                  PostcohState *state,
+                                  long now,
+                                  cudaStream_t stream) {
+    int i, mem_alloc_size = sizeof(float) * map->nifo * map->nifo * map->npix;
+    float *U = NULL, *diff = NULL;
+    const float *slice_U, *slice_diff;
+    long gps;
+
+    if ((i = detrsp_map_collect_prefetch(map, FALSE, &slice_U, &slice_diff))
+        >= 0)
+        map_copy_slice(state, i, slice_U, slice_diff, mem_alloc_size, stream);
+
+    while ((i = detrsp_map_next_stale(map, now, now + map->gps_step, &gps))
+           >= 0) {
+        /* the slice in the background is most likely this one */
+        int j = detrsp_map_collect_prefetch(map, TRUE, &slice_U, &slice_diff);
+        if (j < 0) {
+            if (U == NULL) {
+                U    = (float *)malloc(mem_alloc_size);
+                diff = (float *)malloc(mem_alloc_size);
+            }
+            detrsp_map_generate_slice(map, i, gps, U, diff, NULL);
+            j          = i;
+            slice_U    = U;
+            slice_diff = diff;
+        }
+        map_copy_slice(state, j, slice_U, slice_diff, mem_alloc_size, stream);
+    }
+    state->gps_start = map->gps_start;
+    free(U);
+    free(diff);
+
+    if ((i = detrsp_map_next_stale(map, now, G_MAXLONG, &gps)) >= 0)
+        detrsp_map_prefetch(map, i, gps);
+}
+
 void cuda_postcoh_autocorr_from_xml(char *fname,
                                     PostcohState *state,
                                     cudaStream_t stream) {
@@ -908,3 +987,103 @@ void state_reset_npeak(PeakList *pklist) {
     CUDA_CHECK(cudaMemset(pklist->d_npeak, 0, sizeof(int)));
     pklist->npeak[0] = 0;
 }
+
+/* Find the peaks above snglsnr_thresh in the exe_len samples of an snr
+ * chunk on the host, cluster them and copy the peak list to the device for
+ * cohsnr_and_chisq(). Returns the number of peaks. */
+int peaks_over_thresh(COMPLEX_F *snglsnr,
+                      PostcohState *state,
+                      int cur_ifo,
+                      cudaStream_t stream) {
+    int exe_len = state->exe_len, ntmplt = state->ntmplt, itmplt, ilen, jlen,
+        npeak = 0, max_npeak = state->max_npeak;
+    COMPLEX_F *isnr = snglsnr;
+    float tmp_abssnr, tmp_tmplt, snglsnr_thresh = state->snglsnr_thresh;
+    PeakList *pklist  = state->peak_list[cur_ifo];
+    float *tmp_maxsnr = state->tmp_maxsnr;
+    int *tmp_tmpltidx = state->tmp_tmpltidx;
+    int *peak_pos     = pklist->peak_pos;
+    int *tmplt_idx    = pklist->tmplt_idx;
+    int *len_idx      = pklist->len_idx;
+    /* find maxsnr for each sampling point, keep the record of the tmplt_idx */
+    for (ilen = 0; ilen < exe_len; ilen++) {
+        tmp_maxsnr[ilen]               = 0.0;
+        tmp_tmpltidx[ilen]             = -1;
+        peak_pos[MIN(ilen, max_npeak)] = -1;
+        for (itmplt = 0; itmplt < ntmplt; itmplt++) {
+            tmp_abssnr =
+              sqrt((*isnr).re * (*isnr).re + (*isnr).im * (*isnr).im);
+            if (tmp_abssnr > tmp_maxsnr[ilen]) {
+                tmp_maxsnr[ilen]   = tmp_abssnr;
+                tmp_tmpltidx[ilen] = itmplt;
+            }
+            isnr++;
+        }
+    }
+    /* find the maxsnr acrros each tmplt */
+    for (ilen = 0; ilen < exe_len; ilen++) {
+        if (tmp_tmpltidx[ilen] > -1) {
+            /* find if the subsequential snr has larger snr,
+             * yes: continue to next sample point,
+             * no: save this snr and delete snr on other times of the same
+             * tmplt*/
+            for (jlen = ilen + 1; jlen < exe_len; jlen++) {
+                if (tmp_tmpltidx[jlen] == tmp_tmpltidx[ilen]
+                    && tmp_maxsnr[jlen] > tmp_maxsnr[ilen])
+                    break;
+                if (tmp_tmpltidx[jlen] == tmp_tmpltidx[ilen]
+                    && tmp_maxsnr[jlen] < tmp_maxsnr[ilen])
+                    tmp_tmpltidx[jlen] = -1;
+            }
+
+            if (jlen == exe_len && tmp_maxsnr[ilen] > snglsnr_thresh) {
+                len_idx[npeak]   = ilen;
+                tmplt_idx[npeak] = tmp_tmpltidx[ilen];
+                peak_pos[npeak]  = npeak;
+                npeak++;
+            }
+        }
+    }
+
+    /* keep track of the maximum single snr in this snr chunk */
+    for (ilen = 0; ilen < exe_len; ilen++) {
+        if (tmp_maxsnr[ilen] > state->snglsnr_max[cur_ifo])
+            state->snglsnr_max[cur_ifo] = tmp_maxsnr[ilen];
+    }
+
+    /* do clustering every PEAKFINDER_CLUSTER_WINDOW samples, FIXME: if set to
+     * 0, the size of output will be ten times */
+    int cluster_peak_pos[max_npeak], len_cluster_peak, len_next_peak,
+      final_peaks       = 0, ipeak;
+    cluster_peak_pos[0] = peak_pos[0];
+    for (ipeak = 0; ipeak < npeak - 1; ipeak++) {
+        if (peak_pos[ipeak + 1] - cluster_peak_pos[final_peaks]
+            > PEAKFINDER_CLUSTER_WINDOW) {
+            final_peaks++;
+            cluster_peak_pos[final_peaks] = peak_pos[ipeak + 1];
+        } else { // update the cluster_peak_pos if next peak pos has larger SNR
+            len_cluster_peak = len_idx[cluster_peak_pos[final_peaks]];
+            len_next_peak    = len_idx[peak_pos[ipeak + 1]];
+            if (tmp_maxsnr[len_cluster_peak] < tmp_maxsnr[len_next_peak])
+                cluster_peak_pos[final_peaks] = peak_pos[ipeak + 1];
+        }
+    }
+
+    npeak = npeak == 0 ? 0 : final_peaks + 1;
+    memcpy(peak_pos, cluster_peak_pos, sizeof(int) * npeak);
+    pklist->npeak[0] = npeak;
+
+    // printf("peaks_over_thresh , ifo %d, npeak %d\n", cur_ifo, npeak);
+    CUDA_CHECK(cudaMemcpyAsync(pklist->d_npeak, pklist->npeak,
+                               sizeof(int) * (pklist->peak_intlen),
+                               cudaMemcpyHostToDevice, stream));
+
+#if 0
+	CUDA_CHECK(cudaMemcpyAsync(	pklist->d_maxsnglsnr, 
+			pklist->maxsnglsnr, 
+			sizeof(float) * (pklist->peak_floatlen), 
+			cudaMemcpyHostToDevice,
+			stream));
+#endif
+    return npeak;
+}
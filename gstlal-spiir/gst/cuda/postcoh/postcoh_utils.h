@@ -21,6 +21,13 @@ void cuda_postcoh_map_from_xml(char *fname,
                                PostcohState *state,
                                cudaStream_t stream);
 
+void cuda_postcoh_map_init_detrsp(DetrspMap *map, PostcohState *state);
+
+void cuda_postcoh_map_from_detrsp(DetrspMap *map,
+                                  PostcohState *state,
+                                  long now,
+                                  cudaStream_t stream);
+
 void cuda_postcoh_autocorr_from_xml(char *fname,
                                     PostcohState *state,
                                     cudaStream_t stream);
@@ -29,6 +36,10 @@ void cuda_postcoh_sngl_tmplt_from_xml(char *fname,
                                       SnglInspiralTable **psngl_table);
 
 void peakfinder(PostcohState *state, int iifo, cudaStream_t stream);
+int peaks_over_thresh(COMPLEX_F *snglsnr,
+                      PostcohState *state,
+                      int cur_ifo,
+                      cudaStream_t stream);
 void state_destroy(PostcohState *state);
 
 void peak_list_destroy(PeakList *pklist);
@@ -234,3 +234,150 @@ void postcohtable_set_line(GString *line,
     g_string_append(line, "\n");
     // printf("%s", line->str);
 }
+
+int postcohtable_xml_start(xmlTextWriterPtr writer, XmlTable *xtable) {
+    int i;
+
+    xmlTextWriterSetIndent(writer, 1);
+    xmlTextWriterSetIndentString(writer, BAD_CAST "\t");
+
+    /* Start the document with the xml default for the version,
+     * encoding utf-8 and the default for the standalone
+     * declaration. */
+    if (xmlTextWriterStartDocument(writer, NULL, MY_ENCODING, NULL) < 0)
+        return -1;
+
+    if (xmlTextWriterWriteDTD(
+          writer, BAD_CAST "LIGO_LW", NULL,
+          BAD_CAST
+          "http://ldas-sw.ligo.caltech.edu/doc/ligolwAPI/html/ligolw_dtd.txt",
+          NULL)
+        < 0)
+        return -1;
+
+    /* the root LIGO_LW element and the LIGO_LW holding the table */
+    if (xmlTextWriterStartElement(writer, BAD_CAST "LIGO_LW") < 0) return -1;
+    if (xmlTextWriterStartElement(writer, BAD_CAST "LIGO_LW") < 0) return -1;
+
+    xmlTextWriterStartElement(writer, BAD_CAST "Table");
+    xmlTextWriterWriteAttribute(writer, BAD_CAST "Name",
+                                BAD_CAST xtable->tableName->str);
+
+    for (i = 0; i < (int)xtable->names->len; ++i) {
+        GString *colName = &g_array_index(xtable->names, GString, i);
+        GString *type    = &g_array_index(xtable->type_names, GString, i);
+
+        xmlTextWriterStartElement(writer, BAD_CAST "Column");
+        xmlTextWriterWriteAttribute(writer, BAD_CAST "Type",
+                                    BAD_CAST type->str);
+        xmlTextWriterWriteAttribute(writer, BAD_CAST "Name",
+                                    BAD_CAST colName->str);
+        xmlTextWriterEndElement(writer);
+    }
+
+    xmlTextWriterStartElement(writer, BAD_CAST "Stream");
+    xmlTextWriterWriteAttribute(writer, BAD_CAST "Delimiter",
+                                BAD_CAST xtable->delimiter->str);
+    xmlTextWriterWriteAttribute(writer, BAD_CAST "Type", BAD_CAST "Local");
+    xmlTextWriterWriteAttribute(writer, BAD_CAST "Name",
+                                BAD_CAST xtable->tableName->str);
+
+    return xmlTextWriterWriteString(writer, BAD_CAST "\n") < 0 ? -1 : 0;
+}
+
+int postcohtable_xml_end(xmlTextWriterPtr writer) {
+    /* Stream, Table, and everything else still open */
+    if (xmlTextWriterEndElement(writer) < 0) return -1;
+    if (xmlTextWriterEndElement(writer) < 0) return -1;
+    if (xmlTextWriterEndDocument(writer) < 0) return -1;
+    return 0;
+}
+
+int postcohtable_bin_write_header(FILE *fp) {
+    PostcohBinHeader header;
+
+    memset(&header, 0, sizeof(header));
+    strncpy(header.magic, POSTCOH_BIN_MAGIC, sizeof(header.magic));
+    header.version     = POSTCOH_BIN_VERSION;
+    header.record_size = sizeof(PostcohInspiralTable);
+    return fwrite(&header, sizeof(header), 1, fp) == 1 ? 0 : -1;
+}
+
+int postcohtable_bin_read_header(FILE *fp) {
+    PostcohBinHeader header;
+
+    if (fread(&header, sizeof(header), 1, fp) != 1) return -1;
+    if (strncmp(header.magic, POSTCOH_BIN_MAGIC, sizeof(header.magic))
+        || header.version != POSTCOH_BIN_VERSION
+        || header.record_size != sizeof(PostcohInspiralTable))
+        return -1;
+    return 0;
+}
+
+/* copy the columns of src into a zeroed row, so that neither the struct
+ * padding nor the pointers reach the file */
+static void postcohtable_bin_pack(PostcohInspiralTable *row,
+                                  const PostcohInspiralTable *src) {
+    memset(row, 0, sizeof(*row));
+    row->process_id   = src->process_id;
+    row->event_id     = src->event_id;
+    row->ringdown_dur = src->ringdown_dur;
+    row->end_time     = src->end_time;
+    memcpy(row->end_time_sngl, src->end_time_sngl, sizeof(row->end_time_sngl));
+    row->is_background = src->is_background;
+    row->livetime      = src->livetime;
+    memcpy(row->ifos, src->ifos, sizeof(row->ifos));
+    memcpy(row->pivotal_ifo, src->pivotal_ifo, sizeof(row->pivotal_ifo));
+    row->tmplt_idx = src->tmplt_idx;
+    row->bankid    = src->bankid;
+    row->pix_idx   = src->pix_idx;
+    memcpy(row->snglsnr, src->snglsnr, sizeof(row->snglsnr));
+    memcpy(row->coaphase, src->coaphase, sizeof(row->coaphase));
+    memcpy(row->chisq, src->chisq, sizeof(row->chisq));
+    row->cohsnr        = src->cohsnr;
+    row->nullsnr       = src->nullsnr;
+    row->cmbchisq      = src->cmbchisq;
+    row->spearman_pval = src->spearman_pval;
+    row->fap           = src->fap;
+    memcpy(row->far_sngl, src->far_sngl, sizeof(row->far_sngl));
+    memcpy(row->far_1w_sngl, src->far_1w_sngl, sizeof(row->far_1w_sngl));
+    memcpy(row->far_1d_sngl, src->far_1d_sngl, sizeof(row->far_1d_sngl));
+    memcpy(row->far_2h_sngl, src->far_2h_sngl, sizeof(row->far_2h_sngl));
+    row->far    = src->far;
+    row->far_2h = src->far_2h;
+    row->far_1d = src->far_1d;
+    row->far_1w = src->far_1w;
+    memcpy(row->skymap_fname, src->skymap_fname, sizeof(row->skymap_fname));
+    row->template_duration = src->template_duration;
+    row->mass1             = src->mass1;
+    row->mass2             = src->mass2;
+    row->mchirp            = src->mchirp;
+    row->mtotal            = src->mtotal;
+    row->spin1x            = src->spin1x;
+    row->spin1y            = src->spin1y;
+    row->spin1z            = src->spin1z;
+    row->spin2x            = src->spin2x;
+    row->spin2y            = src->spin2y;
+    row->spin2z            = src->spin2z;
+    row->eta               = src->eta;
+    row->ra                = src->ra;
+    row->dec               = src->dec;
+    memcpy(row->deff, src->deff, sizeof(row->deff));
+    row->rank    = src->rank;
+    row->f_final = src->f_final;
+    row->epoch   = src->epoch;
+    row->deltaT  = src->deltaT;
+}
+
+int postcohtable_bin_write(FILE *fp,
+                           const PostcohInspiralTable *table,
+                           gsize nrows) {
+    PostcohInspiralTable row;
+    gsize i;
+
+    for (i = 0; i < nrows; i++) {
+        postcohtable_bin_pack(&row, &table[i]);
+        if (fwrite(&row, sizeof(row), 1, fp) != 1) return -1;
+    }
+    return 0;
+}
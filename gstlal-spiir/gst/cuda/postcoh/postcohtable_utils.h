@@ -29,4 +29,34 @@
 #include <postcohtable.h>
 
 void postcohtable_init(XmlTable *table);
+void postcohtable_set_line(GString *line,
+                           PostcohInspiralTable *table,
+                           XmlTable *xtable);
+
+/* LIGO_LW document around the postcoh table: the header up to and including
+ * the opening of the table's Stream, and the closing of the document after
+ * the rows. Return 0 on success, -1 if the writer failed. */
+int postcohtable_xml_start(xmlTextWriterPtr writer, XmlTable *xtable);
+int postcohtable_xml_end(xmlTextWriterPtr writer);
+
+/*
+ * binary table files: a PostcohBinHeader followed by the rows as
+ * PostcohInspiralTable structures in native byte order, with the pointers
+ * and the struct padding zeroed. The files are meant for the host and build that wrote them;
+ * gstlal_postcoh_bin_to_xml converts them to LIGO_LW.
+ */
+#define POSTCOH_BIN_MAGIC "PCOHBIN"
+#define POSTCOH_BIN_VERSION 1
+
+typedef struct _PostcohBinHeader {
+    char magic[8];
+    guint32 version;
+    guint32 record_size; /* sizeof(PostcohInspiralTable) */
+} PostcohBinHeader;
+
+int postcohtable_bin_write_header(FILE *fp);
+int postcohtable_bin_read_header(FILE *fp);
+int postcohtable_bin_write(FILE *fp,
+                           const PostcohInspiralTable *table,
+                           gsize nrows);
 #endif /* __POSTCOH_TABLE_UTILS_H__ */
@@ -1,3 +1,9 @@
 
 gcc -g -c gen_detrsp_maps.c `pkg-config --cflags gstlal` `pkg-config --libs gstlal` `pkg-config --cflags chealpix` `pkg-config --libs chealpix` -llapack -llapacke
 gcc -g -o gen_detrsp_maps gen_detrsp_maps.o ../../LIGOLw_xmllib/test/LIGOLwUtils.o ../../LIGOLw_xmllib/test/LIGOLwWriter.o `pkg-config --cflags gstlal` `pkg-config --libs gstlal` `pkg-config --cflags chealpix` `pkg-config --libs chealpix` -llapack -llapacke
+
+# staging rings against the host compute backend, no GPU needed
+gcc -g -o test_postcoh_staging -I ../.. test_postcoh_staging.c ../postcoh_staging.c ../../compute_backend.c `pkg-config --cflags gthread-2.0` `pkg-config --libs gthread-2.0`
+
+# detector response map against the LAL functions, no GPU needed
+gcc -g -O2 -o test_postcoh_detrsp -I ../.. test_postcoh_detrsp.c ../postcoh_detrsp.c ../../compute_backend.c `pkg-config --cflags --libs gthread-2.0 lal lalsimulation chealpix` -lm
@@ -0,0 +1,141 @@
+/* Check the detector response map against the LAL functions it replaces.
+ * The antenna patterns and arrival time differences are recomputed with
+ * XLALComputeDetAMResponse() and XLALArrivalTimeDiff() for every pixel, U
+ * must be orthogonal with the horizon weighted antenna patterns in the span
+ * of its first two columns, and Det must be det(A^T A). Also checks which
+ * slices are stale when, and that a slice generated in the background is
+ * the same. Runs on the host compute backend, no GPU needed. */
+
+#include <chealpix.h>
+#include <glib.h>
+#include <lal/Date.h>
+#include <lal/DetResponse.h>
+#include <lal/LALSimulation.h>
+#include <lal/TimeDelay.h>
+#include <math.h>
+#include <postcoh/postcoh_detrsp.h>
+#include <string.h>
+
+#define ORDER    3
+#define GPS_STEP 1800
+#define GPS      1187008882L
+#define TOL      1e-5
+
+static void check(const char *ifo_horizons) {
+    DetrspMap *map;
+    char **ifos;
+    double *horizons;
+    float *U, *diff, *Det;
+    LIGOTimeGPS gps = { GPS, 0 };
+    double gmst     = XLALGreenwichMeanSiderealTime(&gps);
+    unsigned long ipix, npix;
+    gint nifo, iifo, jifo, c, j, islice = 5;
+    long next;
+
+    nifo = detrsp_parse_ifo_horizons(ifo_horizons, &ifos, &horizons);
+    g_assert(nifo > 0);
+    map = detrsp_map_new(ifos, nifo, horizons, GPS_STEP, ORDER);
+    g_assert(map != NULL);
+    npix = map->npix;
+
+    U    = g_new(float, nifo * nifo * npix);
+    diff = g_new(float, nifo * nifo * npix);
+    Det  = g_new(float, npix);
+    detrsp_map_generate_slice(map, islice, GPS, U, diff, Det);
+    g_assert(map->gps_start == GPS - islice * GPS_STEP);
+
+    for (ipix = 0; ipix < npix; ipix++) {
+        double theta, phi, fplus, fcross, A[nifo][2], ata[3] = { 0, 0, 0 };
+
+        pix2ang_nest(map->nside, ipix, &theta, &phi);
+        for (iifo = 0; iifo < nifo; iifo++) {
+            XLALComputeDetAMResponse(&fplus, &fcross,
+                                     map->detectors[iifo].response, phi,
+                                     M_PI_2 - theta, 0, gmst);
+            A[iifo][0] = fplus * horizons[iifo];
+            A[iifo][1] = fcross * horizons[iifo];
+            ata[0] += A[iifo][0] * A[iifo][0];
+            ata[1] += A[iifo][0] * A[iifo][1];
+            ata[2] += A[iifo][1] * A[iifo][1];
+        }
+
+        for (iifo = 0; iifo < nifo; iifo++)
+            for (jifo = 0; jifo < nifo; jifo++) {
+                double dt = XLALArrivalTimeDiff(
+                  map->detectors[jifo].location, map->detectors[iifo].location,
+                  phi, M_PI_2 - theta, &gps);
+                g_assert(fabs(diff[(iifo * nifo + jifo) * npix + ipix] - dt)
+                         < 1e-7);
+            }
+
+        g_assert(fabs(Det[ipix] - (ata[0] * ata[2] - ata[1] * ata[1]))
+                 <= TOL * ata[0] * ata[2]);
+
+        /* U^T U = 1 */
+        for (c = 0; c < nifo; c++)
+            for (j = 0; j < nifo; j++) {
+                double dot = 0;
+                for (iifo = 0; iifo < nifo; iifo++)
+                    dot += U[(iifo * nifo + c) * npix + ipix]
+                           * U[(iifo * nifo + j) * npix + ipix];
+                g_assert(fabs(dot - (c == j)) < TOL);
+            }
+
+        /* the null space columns see no signal */
+        for (c = 2; c < nifo; c++)
+            for (j = 0; j < 2; j++) {
+                double dot = 0;
+                for (iifo = 0; iifo < nifo; iifo++)
+                    dot += U[(iifo * nifo + c) * npix + ipix] * A[iifo][j];
+                g_assert(fabs(dot) < TOL * sqrt(ata[0] + ata[2]));
+            }
+    }
+
+    /* slice 5 is current until GPS + GPS_STEP / 2, slice 6 is next */
+    g_assert(detrsp_map_next_stale(map, GPS, GPS + GPS_STEP / 2, &next) < 0);
+    g_assert(detrsp_map_next_stale(map, GPS, G_MAXLONG, &next) == 6);
+    g_assert(next == GPS + GPS_STEP);
+    /* after GPS_STEP slice 5 has gone by, it is next needed a day later */
+    g_assert(detrsp_map_next_stale(map, GPS + GPS_STEP, G_MAXLONG, &next)
+             == 6);
+    g_assert(detrsp_map_next_stale(map, GPS + 2 * GPS_STEP, G_MAXLONG, &next)
+             == 7);
+    /* data from before the map was started needs every slice again */
+    g_assert(detrsp_map_next_stale(map, GPS - 3 * DETRSP_SECONDS_IN_DAY,
+                                   GPS - 3 * DETRSP_SECONDS_IN_DAY + 1, &next)
+             == 5);
+    g_assert(next == GPS - 3 * DETRSP_SECONDS_IN_DAY);
+
+    /* slice 6 generated in the background is the same as in the foreground */
+    {
+        const float *pU, *pdiff;
+        g_assert(detrsp_map_collect_prefetch(map, TRUE, &pU, &pdiff) < 0);
+        g_assert(detrsp_map_prefetch(map, 6, GPS + GPS_STEP));
+        g_assert(!detrsp_map_prefetch(map, 7, GPS + 2 * GPS_STEP));
+        detrsp_map_generate_slice(map, 6, GPS + GPS_STEP, U, diff, NULL);
+        map->slice_gps[6] = -1;
+        g_assert(detrsp_map_collect_prefetch(map, TRUE, &pU, &pdiff) == 6);
+        g_assert(memcmp(pU, U, sizeof(float) * nifo * nifo * npix) == 0);
+        g_assert(memcmp(pdiff, diff, sizeof(float) * nifo * nifo * npix)
+                 == 0);
+        g_assert(map->slice_gps[6] == GPS + GPS_STEP);
+        g_assert(detrsp_map_next_stale(map, GPS, G_MAXLONG, &next) == 7);
+        /* one left running is joined by detrsp_map_free() */
+        g_assert(detrsp_map_prefetch(map, 7, GPS + 2 * GPS_STEP));
+    }
+
+    g_print("postcoh detrsp %s: %lu pixels ok\n", ifo_horizons, npix);
+    g_free(U);
+    g_free(diff);
+    g_free(Det);
+    g_strfreev(ifos);
+    g_free(horizons);
+    detrsp_map_free(map);
+}
+
+int main(int argc, char *argv[]) {
+    check("H1:26,L1:52");
+    check("H1:26,L1:52,V1:10");
+    check("H1:26,L1:52,V1:10,K1:8");
+    return 0;
+}
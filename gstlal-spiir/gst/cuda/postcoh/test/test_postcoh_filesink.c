@@ -0,0 +1,233 @@
+/* Drive postcoh_filesink from a bare source pad, without a GPU.
+ *
+ * The first test pushes more buffers than the writer queue holds, across
+ * several snapshot intervals, and checks that the binary files hold every
+ * row in the order pushed and are complete as soon as EOS has been
+ * pushed.  The second writes the same buffers as XML and as binary rows,
+ * converts the binary file with gstlal_postcoh_bin_to_xml, and checks the
+ * two XML files are identical.
+ *
+ * The path to gstlal_postcoh_bin_to_xml may be given as the first
+ * argument, it defaults to the one in the current directory. */
+
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <gst/gst.h>
+#include <postcoh/postcoh_filesink.h>
+#include <postcoh/postcohtable_utils.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NBUFFER         40
+#define SNAPSHOT        4
+#define QUEUE_SIZE      2
+#define T0              1187008880
+#define MAX_ROWS_PER_BUF 3
+
+/* 0 to MAX_ROWS_PER_BUF rows, so some buffers are empty */
+static int rows_in_buffer(int ibuf) {
+    return ibuf % (MAX_ROWS_PER_BUF + 1);
+}
+
+static GstBuffer *make_buffer(int ibuf, long *event_id) {
+    int nrows = rows_in_buffer(ibuf), irow, iifo;
+    GstBuffer *buf =
+      gst_buffer_new_and_alloc(nrows * sizeof(PostcohInspiralTable));
+    PostcohInspiralTable *row = (PostcohInspiralTable *)GST_BUFFER_DATA(buf);
+
+    memset(row, 0, GST_BUFFER_SIZE(buf));
+    for (irow = 0; irow < nrows; irow++, row++) {
+        row->event_id                = (*event_id)++;
+        row->end_time.gpsSeconds     = T0 + ibuf;
+        row->end_time.gpsNanoSeconds = irow * 1000;
+        for (iifo = 0; iifo < MAX_NIFO; iifo++) {
+            row->end_time_sngl[iifo] = row->end_time;
+            row->snglsnr[iifo]       = 4.f + iifo + 0.25f * irow;
+            row->coaphase[iifo]      = 0.5f * iifo;
+            row->chisq[iifo]         = 1.f + iifo;
+            row->deff[iifo]          = 100. + iifo;
+        }
+        strcpy(row->ifos, "H1L1V1");
+        strcpy(row->pivotal_ifo, "H1");
+        row->tmplt_idx = ibuf;
+        row->cohsnr    = 8.f + 0.125f * ibuf;
+        row->far       = 1e-7f * (ibuf + 1);
+        row->mass1     = 1.4f;
+        row->mass2     = 1.3f;
+        row->ra        = 0.1 * irow;
+        row->dec       = -0.1 * irow;
+    }
+
+    GST_BUFFER_TIMESTAMP(buf) = (GstClockTime)(T0 + ibuf) * GST_SECOND;
+    GST_BUFFER_DURATION(buf)  = GST_SECOND;
+    return buf;
+}
+
+/* run NBUFFER buffers through a sink writing to prefix.  returns once EOS
+ * has been pushed, with the sink still running */
+static GstElement *run_sink(GstPad **psrc,
+                            const gchar *prefix,
+                            int format,
+                            int snapshot) {
+    GstElement *sink = g_object_new(POSTCOH_TYPE_FILESINK, NULL);
+    GstPad *src      = gst_pad_new("src", GST_PAD_SRC);
+    GstPad *sinkpad  = gst_element_get_static_pad(sink, "sink");
+    GstCaps *caps    = gst_caps_from_string("application/x-lal-postcoh");
+    long event_id    = 0;
+    int ibuf;
+
+    g_object_set(sink, "location", prefix, "output-format", format,
+                 "compression", 0, "snapshot-interval", snapshot,
+                 "queue-size", QUEUE_SIZE, "async", FALSE, NULL);
+    g_assert(gst_pad_link(src, sinkpad) == GST_PAD_LINK_OK);
+    gst_object_unref(sinkpad);
+    gst_pad_set_active(src, TRUE);
+    gst_pad_set_caps(src, caps);
+    g_assert(gst_element_set_state(sink, GST_STATE_PLAYING)
+             == GST_STATE_CHANGE_SUCCESS);
+
+    g_assert(gst_pad_push_event(
+      src, gst_event_new_new_segment(FALSE, 1.0, GST_FORMAT_TIME, 0, -1, 0)));
+    for (ibuf = 0; ibuf < NBUFFER; ibuf++) {
+        GstBuffer *buf = make_buffer(ibuf, &event_id);
+        gst_buffer_set_caps(buf, caps);
+        g_assert(gst_pad_push(src, buf) == GST_FLOW_OK);
+    }
+    g_assert(gst_pad_push_event(src, gst_event_new_eos()));
+
+    gst_caps_unref(caps);
+    *psrc = src;
+    return sink;
+}
+
+static void stop_sink(GstElement *sink, GstPad *src) {
+    gst_element_set_state(sink, GST_STATE_NULL);
+    gst_object_unref(sink);
+    gst_object_unref(src);
+}
+
+/* the files in dir starting with base_, in time order */
+static GPtrArray *list_files(const gchar *dir, const gchar *base) {
+    GPtrArray *files = g_ptr_array_new_with_free_func(g_free);
+    GDir *d          = g_dir_open(dir, 0, NULL);
+    gchar *start     = g_strdup_printf("%s_", base);
+    const gchar *name;
+
+    g_assert(d);
+    while ((name = g_dir_read_name(d)))
+        if (g_str_has_prefix(name, start))
+            g_ptr_array_add(files, g_build_filename(dir, name, NULL));
+    g_dir_close(d);
+    g_free(start);
+    /* every name has the same number of digits */
+    g_ptr_array_sort(files, (GCompareFunc)g_strcmp0);
+    return files;
+}
+
+static void test_writer_order(const gchar *dir) {
+    gchar *prefix = g_build_filename(dir, "order", NULL);
+    GstPad *src;
+    GstElement *sink = run_sink(&src, prefix, POSTCOH_FILESINK_FORMAT_BINARY,
+                                SNAPSHOT);
+    GPtrArray *files;
+    PostcohInspiralTable row;
+    long expect = 0, nrows = 0;
+    guint ifile;
+    int ibuf;
+
+    for (ibuf = 0; ibuf < NBUFFER; ibuf++) nrows += rows_in_buffer(ibuf);
+
+    /* EOS has returned:  every file, including the last one, must be
+     * complete and have its final name before the sink is stopped */
+    files = list_files(dir, "order");
+    g_assert_cmpuint(files->len, ==, (NBUFFER + SNAPSHOT) / (SNAPSHOT + 1));
+    for (ifile = 0; ifile < files->len; ifile++) {
+        const gchar *path = g_ptr_array_index(files, ifile);
+        FILE *fp          = g_fopen(path, "rb");
+
+        g_assert(fp);
+        g_assert(g_str_has_suffix(path, ".bin"));
+        g_assert(postcohtable_bin_read_header(fp) == 0);
+        while (fread(&row, sizeof(row), 1, fp) == 1) {
+            g_assert_cmpint(row.event_id, ==, expect);
+            g_assert(row.next == NULL && row.snr == NULL);
+            expect++;
+        }
+        g_assert(feof(fp));
+        fclose(fp);
+    }
+    g_assert_cmpint(expect, ==, nrows);
+
+    stop_sink(sink, src);
+    for (ifile = 0; ifile < files->len; ifile++)
+        g_unlink(g_ptr_array_index(files, ifile));
+    g_ptr_array_free(files, TRUE);
+    g_free(prefix);
+}
+
+static void test_bin_to_xml(const gchar *dir, const gchar *converter) {
+    gchar *xml_prefix = g_build_filename(dir, "xml", NULL);
+    gchar *bin_prefix = g_build_filename(dir, "bin", NULL);
+    gchar *converted  = g_build_filename(dir, "converted.xml", NULL);
+    gchar *xml_data, *converted_data, *argv[7];
+    gsize xml_len, converted_len;
+    GPtrArray *xml_files, *bin_files;
+    GstElement *sink;
+    GstPad *src;
+    gint status;
+
+    sink = run_sink(&src, xml_prefix, POSTCOH_FILESINK_FORMAT_XML, 0);
+    stop_sink(sink, src);
+    sink = run_sink(&src, bin_prefix, POSTCOH_FILESINK_FORMAT_BINARY, 0);
+    stop_sink(sink, src);
+
+    xml_files = list_files(dir, "xml");
+    bin_files = list_files(dir, "bin");
+    g_assert_cmpuint(xml_files->len, ==, 1);
+    g_assert_cmpuint(bin_files->len, ==, 1);
+
+    argv[0] = (gchar *)converter;
+    argv[1] = "--input";
+    argv[2] = g_ptr_array_index(bin_files, 0);
+    argv[3] = "--output";
+    argv[4] = converted;
+    argv[5] = "--no-compression";
+    argv[6] = NULL;
+    g_assert(g_spawn_sync(NULL, argv, NULL, G_SPAWN_STDERR_TO_DEV_NULL, NULL,
+                          NULL, NULL, NULL, &status, NULL));
+    g_assert_cmpint(status, ==, 0);
+
+    g_assert(g_file_get_contents(g_ptr_array_index(xml_files, 0), &xml_data,
+                                 &xml_len, NULL));
+    g_assert(g_file_get_contents(converted, &converted_data, &converted_len,
+                                 NULL));
+    g_assert(xml_len > 0);
+    g_assert_cmpuint(xml_len, ==, converted_len);
+    g_assert(memcmp(xml_data, converted_data, xml_len) == 0);
+
+    g_free(xml_data);
+    g_free(converted_data);
+    g_unlink(g_ptr_array_index(xml_files, 0));
+    g_unlink(g_ptr_array_index(bin_files, 0));
+    g_unlink(converted);
+    g_ptr_array_free(xml_files, TRUE);
+    g_ptr_array_free(bin_files, TRUE);
+    g_free(xml_prefix);
+    g_free(bin_prefix);
+    g_free(converted);
+}
+
+int main(int argc, char *argv[]) {
+    gchar dir[] = "test_postcoh_filesink.XXXXXX";
+    const gchar *converter =
+      argc > 1 ? argv[1] : "./gstlal_postcoh_bin_to_xml";
+
+    gst_init(&argc, &argv);
+    g_assert(mkdtemp(dir));
+
+    test_writer_order(dir);
+    test_bin_to_xml(dir, converter);
+
+    g_rmdir(dir);
+    return 0;
+}
@@ -0,0 +1,101 @@
+/* Exercise the postcoh staging rings with the host compute backend, so it
+ * runs without a GPU. A second backend wraps the host one to count the
+ * event waits and to check that a slot is never refilled while its
+ * transfer is still outstanding. */
+
+#include <glib.h>
+#include <postcoh/postcoh_staging.h>
+#include <string.h>
+
+#define NIFO       3
+#define SLOT_SIZE  4096
+#define NCHUNK     10
+
+static int nrecord = 0, nwait = 0;
+
+typedef struct {
+    int pending;
+} FakeEvent;
+
+static ComputeEvent *fake_event_new(void) {
+    return (ComputeEvent *)g_new0(FakeEvent, 1);
+}
+
+static void fake_event_free(ComputeEvent *event) { g_free(event); }
+
+static void fake_event_record(ComputeEvent *event, ComputeQueue *queue) {
+    ((FakeEvent *)event)->pending = 1;
+    nrecord++;
+}
+
+static void fake_event_wait(ComputeEvent *event) {
+    ((FakeEvent *)event)->pending = 0;
+    nwait++;
+}
+
+int main(int argc, char *argv[]) {
+    ComputeBackend counting = *compute_backend_host();
+    ComputeQueue *queue;
+    PostcohStaging *staging;
+    void *host[NIFO][NCHUNK], *dev[NIFO][NCHUNK];
+    int ichunk, iifo;
+
+    counting.name         = "counting";
+    counting.event_new    = fake_event_new;
+    counting.event_free   = fake_event_free;
+    counting.event_record = fake_event_record;
+    counting.event_wait   = fake_event_wait;
+
+    queue   = counting.queue_new();
+    staging = postcoh_staging_new(&counting, NIFO, SLOT_SIZE);
+
+    for (ichunk = 0; ichunk < NCHUNK; ichunk++) {
+        for (iifo = 0; iifo < NIFO; iifo++) {
+            unsigned char *slot, *device;
+            gsize size = SLOT_SIZE - ichunk;
+
+            slot = postcoh_staging_acquire(staging, iifo);
+            host[iifo][ichunk] = slot;
+            memset(slot, ichunk * NIFO + iifo, size);
+            device = postcoh_staging_upload(staging, iifo, size, queue);
+            dev[iifo][ichunk] = device;
+
+            /* the host backend completes the copy immediately */
+            g_assert(device[0] == (unsigned char)(ichunk * NIFO + iifo));
+            g_assert(device[size - 1] == (unsigned char)(ichunk * NIFO + iifo));
+
+            /* consecutive chunks alternate slots */
+            if (ichunk > 0) {
+                g_assert(slot != host[iifo][ichunk - 1]);
+                g_assert(device != dev[iifo][ichunk - 1]);
+            }
+            if (ichunk >= POSTCOH_STAGING_NSLOT) {
+                g_assert(slot == host[iifo][ichunk - POSTCOH_STAGING_NSLOT]);
+                g_assert(device == dev[iifo][ichunk - POSTCOH_STAGING_NSLOT]);
+            }
+
+            /* the previous chunk's host and device data are still intact,
+             * a kernel reading it is not overwritten by this transfer */
+            if (ichunk > 0) {
+                g_assert(((unsigned char *)host[iifo][ichunk - 1])[0]
+                         == (unsigned char)((ichunk - 1) * NIFO + iifo));
+                g_assert(((unsigned char *)dev[iifo][ichunk - 1])[0]
+                         == (unsigned char)((ichunk - 1) * NIFO + iifo));
+            }
+        }
+    }
+
+    /* every slot reuse after the first lap had to wait for its transfer */
+    g_assert(nrecord == NIFO * NCHUNK);
+    g_assert(nwait == NIFO * (NCHUNK - POSTCOH_STAGING_NSLOT));
+    g_assert(staging->nstall == (guint64)nwait);
+
+    /* the last lap is still in flight until drained */
+    postcoh_staging_drain(staging);
+    g_assert(nwait == NIFO * NCHUNK);
+
+    postcoh_staging_free(staging);
+    counting.queue_free(queue);
+    g_print("postcoh staging: %d ifos x %d chunks ok\n", NIFO, NCHUNK);
+    return 0;
+}
@@ -41,12 +41,14 @@
 #include <gst/gst.h>
 #include <gstlal/gstlal.h>
 #include <spiir/spiir.h>
+#include <spiir/spiir_host.h>
 
 /*
  * stuff from FFTW and GSL
  */
 
 #include <gsl/gsl_blas.h>
+#include <gsl/gsl_complex_math.h>
 #include <gsl/gsl_matrix.h>
 #include <time.h>
 
@@ -81,6 +83,152 @@ static int push_zeros(GSTLALIIRBankCuda *element, unsigned samples) {
     return 0;
 }
 
+/*
+ * return the number of IIR channels
+ */
+
+unsigned iir_channels(const GSTLALIIRBankCuda *element) {
+    if (element->a1) return 2 * element->a1->size1;
+    return 0;
+}
+
+/*
+ * the number of samples available in the adapter
+ */
+
+guint64 get_available_samples(GSTLALIIRBankCuda *element) {
+    return gst_adapter_available(element->adapter) / (element->width / 8);
+}
+
+/*
+ * set the metadata on an output buffer.
+ */
+
+void set_metadata(GSTLALIIRBankCuda *element,
+                  GstBuffer *buf,
+                  guint64 outsamples,
+                  gboolean gap) {
+    GST_BUFFER_SIZE(buf) =
+      outsamples * iir_channels(element) * element->width / 8;
+    GST_BUFFER_OFFSET(buf) = element->next_out_offset;
+    element->next_out_offset += outsamples;
+    GST_BUFFER_OFFSET_END(buf) = element->next_out_offset;
+    GST_BUFFER_TIMESTAMP(buf) =
+      element->t0
+      + gst_util_uint64_scale_int_round(
+        GST_BUFFER_OFFSET(buf) - element->offset0, GST_SECOND, element->rate);
+    GST_BUFFER_DURATION(buf) = element->t0
+                               + gst_util_uint64_scale_int_round(
+                                 GST_BUFFER_OFFSET_END(buf) - element->offset0,
+                                 GST_SECOND, element->rate)
+                               - GST_BUFFER_TIMESTAMP(buf);
+    if (element->need_discont) {
+        GST_BUFFER_FLAG_SET(buf, GST_BUFFER_FLAG_DISCONT);
+        element->need_discont = FALSE;
+    }
+    if (gap) GST_BUFFER_FLAG_SET(buf, GST_BUFFER_FLAG_GAP);
+    else
+        GST_BUFFER_FLAG_UNSET(buf, GST_BUFFER_FLAG_GAP);
+}
+
+/*
+ * drop the host bank so the next buffer rebuilds it from the current
+ * coefficients, keeping its filter state in y when the shape still matches.
+ * call with iir_matrix_lock held.
+ */
+
+static void host_bank_invalidate(GSTLALIIRBankCuda *element) {
+    IIRBankHost *bank = element->host_bank;
+
+    if (!bank) return;
+    if (element->y && element->y->size1 == bank->num_templates
+        && element->y->size2 == bank->num_filters) {
+        float *y = g_new(float, 2 * bank->num_templates * bank->num_filters);
+        guint t, f;
+
+        iir_bank_host_get_state(bank, y);
+        for (t = 0; t < bank->num_templates; t++)
+            for (f = 0; f < bank->num_filters; f++) {
+                float *yi = y + 2 * (t * bank->num_filters + f);
+                gsl_matrix_complex_set(element->y, t, f,
+                                       gsl_complex_rect(yi[0], yi[1]));
+            }
+        g_free(y);
+    }
+    iir_bank_host_free(bank);
+    element->host_bank = NULL;
+}
+
+/*
+ * transform input samples to output samples on the host backend, in single
+ * precision for both widths like the GPU kernel
+ */
+
+static GstFlowReturn filter_host(GSTLALIIRBankCuda *element,
+                                 GstBuffer *outbuf) {
+    IIRBankHost *bank;
+    guint available_length = get_available_samples(element);
+    guint output_length;
+    gconstpointer input;
+
+    if (!element->host_bank)
+        element->host_bank = iir_bank_host_new(
+          element->a1->size1, element->a1->size2,
+          (const double complex *)gsl_matrix_complex_const_ptr(element->a1, 0,
+                                                               0),
+          (const double complex *)gsl_matrix_complex_const_ptr(element->b0, 0,
+                                                               0),
+          (const double complex *)gsl_matrix_complex_const_ptr(element->y, 0,
+                                                               0),
+          gsl_matrix_int_const_ptr(element->delay, 0, 0));
+    bank = element->host_bank;
+
+    if (available_length <= (guint)bank->dmax)
+        return GST_BASE_TRANSFORM_FLOW_DROPPED;
+    output_length = available_length - bank->dmax;
+
+    input = gst_adapter_peek(element->adapter,
+                             available_length * element->width / 8);
+    g_assert(output_length * iir_channels(element) * element->width / 8
+             <= GST_BUFFER_SIZE(outbuf));
+    if (element->width == 64)
+        iir_bank_host_filter_d(bank, input, output_length,
+                               (double complex *)GST_BUFFER_DATA(outbuf));
+    else
+        iir_bank_host_filter_s(bank, input, output_length,
+                               (float complex *)GST_BUFFER_DATA(outbuf));
+
+    /*
+     * flush the data from the adapter
+     */
+
+    gst_adapter_flush(element->adapter, output_length * element->width / 8);
+    if (element->zeros_in_adapter > available_length - output_length)
+        /*
+         * some trailing zeros have been flushed from the adapter
+         */
+
+        element->zeros_in_adapter = available_length - output_length;
+
+    set_metadata(element, outbuf, output_length, FALSE);
+
+    return GST_FLOW_OK;
+}
+
+/*
+ * run the filter bank on the element's compute backend
+ */
+
+static GstFlowReturn run_bank(GSTLALIIRBankCuda *element, GstBuffer *outbuf) {
+    if (element->backend->type == COMPUTE_BACKEND_HOST)
+        return filter_host(element, outbuf);
+#ifdef SPIIR_HAVE_CUDA
+    if (element->width == 64) return filter_d(element, outbuf);
+    if (element->width == 32) return filter_s(element, outbuf);
+#endif
+    return GST_FLOW_ERROR;
+}
+
 /*
  * ============================================================================
  *
@@ -440,9 +588,7 @@ static GstFlowReturn
         gst_buffer_ref(inbuf); /* don't let the adapter free it */
         gst_adapter_push(element->adapter, inbuf);
         element->zeros_in_adapter = 0;
-        if (element->width == 64) result = filter_d(element, outbuf);
-        else if (element->width == 32)
-            result = filter_s(element, outbuf);
+        result                    = run_bank(element, outbuf);
 
     } else if (TRUE) {
         /*
@@ -450,9 +596,7 @@ static GstFlowReturn
          */
 
         push_zeros(element, length);
-        if (element->width == 64) result = filter_d(element, outbuf);
-        else if (element->width == 32)
-            result = filter_s(element, outbuf);
+        result = run_bank(element, outbuf);
     }
     // fprintf(stderr, "TIMESTAMP %f, BUFFERSIZE %d\n", (double) 1e-9 *
     // GST_BUFFER_TIMESTAMP(inbuf), GST_BUFFER_SIZE(inbuf) / sizeof(double));
@@ -503,6 +647,7 @@ static void set_property(GObject *object,
     switch (prop_id) {
     case ARG_IIR_A1:
         g_mutex_lock(element->iir_matrix_lock);
+        host_bank_invalidate(element);
         if (element->a1) gsl_matrix_complex_free(element->a1);
 
         element->a1 = gstlal_gsl_matrix_complex_from_g_value_array(
@@ -518,6 +663,7 @@ static void set_property(GObject *object,
 
     case ARG_IIR_B0:
         g_mutex_lock(element->iir_matrix_lock);
+        host_bank_invalidate(element);
         if (element->b0) gsl_matrix_complex_free(element->b0);
 
         element->b0 = gstlal_gsl_matrix_complex_from_g_value_array(
@@ -536,6 +682,7 @@ static void set_property(GObject *object,
         int dmin_new, dmax_new;
 
         g_mutex_lock(element->iir_matrix_lock);
+        host_bank_invalidate(element);
         if (element->delay) {
             gsl_matrix_int_minmax(element->delay, &dmin, &dmax);
             dmin = 0;
@@ -639,10 +786,14 @@ static void finalize(GObject *object) {
         gsl_matrix_complex_free(element->y);
         element->y = NULL;
     }
+#ifdef SPIIR_HAVE_CUDA
     if (element->bank) {
         cuda_bank_free(element);
         element->bank = NULL;
     }
+#endif
+    iir_bank_host_free(element->host_bank);
+    element->host_bank = NULL;
     g_object_unref(element->adapter);
     element->adapter = NULL;
 
@@ -755,5 +906,7 @@ static void cuda_iirbank_init(GSTLALIIRBankCuda *filter,
     filter->delay                = NULL;
     filter->y                    = NULL;
     filter->bank                 = NULL;
+    filter->host_bank            = NULL;
+    filter->backend              = compute_backend_get_default();
     gst_base_transform_set_gap_aware(GST_BASE_TRANSFORM(filter), TRUE);
 }
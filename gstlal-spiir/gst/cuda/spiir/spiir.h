@@ -29,7 +29,10 @@
 #define __CUDA_GST_LAL_IIRBANK_H__
 
 #include <complex.h>
+#include <compute_backend.h>
+#if defined(SPIIR_HAVE_CUDA) || defined(__CUDACC__)
 #include <cuda_runtime.h>
+#endif
 #include <glib.h>
 #include <gsl/gsl_matrix.h>
 #include <gst/base/gstadapter.h>
@@ -94,8 +97,14 @@ typedef struct {
      */
 
     gint rate, width;
+    /* host or cuda, fixed when the element is created */
+    const ComputeBackend *backend;
     gint deviceID; // gpu device ID
+#if defined(SPIIR_HAVE_CUDA) || defined(__CUDACC__)
     cudaStream_t stream;
+#else
+    void *stream;
+#endif
     GstAdapter *adapter;
     guint zeros_in_adapter;
 
@@ -122,6 +131,8 @@ typedef struct {
     gboolean need_discont;
 
     IIRBankCuda_s *bank;
+    /* the bank on the host backend, see spiir_host.h */
+    struct _IIRBankHost *host_bank;
 
 } GSTLALIIRBankCuda;
 
@@ -0,0 +1,269 @@
+/*
+ * Copyright (C) 2026 The SPIIR authors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* A block of templates is held in a GCC vector, so each filter update is a
+ * handful of vector multiply-adds over the block plus a gather of the
+ * delayed input. Where the compiler supports it the filter loop is built for
+ * AVX-512, AVX2 and baseline x86-64 and the best one is picked at load
+ * time. */
+
+#include <compute_backend.h>
+#include <spiir/spiir_host.h>
+#include <string.h>
+
+#define LANES IIR_BANK_HOST_LANES
+
+/* output samples accumulated at a time, keeps the sums in L1 */
+#define IIR_BANK_HOST_CHUNK 128
+
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(__clang__)           \
+  && __GNUC__ >= 8
+#define IIR_BANK_HOST_TARGETS                                                  \
+    __attribute__((target_clones("arch=skylake-avx512", "arch=haswell",       \
+                                 "default")))
+#else
+#define IIR_BANK_HOST_TARGETS
+#endif
+
+/* template t, filter f in the [block][filter][lane] arrays */
+static gsize iir_bank_host_index(const IIRBankHost *bank, guint t, guint f) {
+    return ((gsize)(t / LANES) * bank->num_filters + f) * LANES + t % LANES;
+}
+
+IIRBankHost *iir_bank_host_new(guint num_templates,
+                               guint num_filters,
+                               const double complex *a1,
+                               const double complex *b0,
+                               const double complex *y,
+                               const gint *delay) {
+    IIRBankHost *bank = g_new0(IIRBankHost, 1);
+    gsize size;
+    guint t, f;
+
+    bank->num_templates = num_templates;
+    bank->num_filters   = num_filters;
+    bank->num_blocks    = (num_templates + LANES - 1) / LANES;
+    bank->dmax          = 0;
+    for (t = 0; t < num_templates * num_filters; t++)
+        bank->dmax = MAX(bank->dmax, delay[t]);
+
+    size        = (gsize)bank->num_blocks * num_filters * LANES;
+    bank->a1_re = g_new0(float, size);
+    bank->a1_im = g_new0(float, size);
+    bank->b0_re = g_new0(float, size);
+    bank->b0_im = g_new0(float, size);
+    bank->y_re  = g_new0(float, size);
+    bank->y_im  = g_new0(float, size);
+    /* padding lanes read the first input sample and filter it to zero */
+    bank->shift = g_new0(gint, size);
+
+    for (t = 0; t < num_templates; t++)
+        for (f = 0; f < num_filters; f++) {
+            gsize src = (gsize)t * num_filters + f;
+            gsize dst = iir_bank_host_index(bank, t, f);
+            bank->a1_re[dst] = creal(a1[src]);
+            bank->a1_im[dst] = cimag(a1[src]);
+            bank->b0_re[dst] = creal(b0[src]);
+            bank->b0_im[dst] = cimag(b0[src]);
+            bank->y_re[dst]  = creal(y[src]);
+            bank->y_im[dst]  = cimag(y[src]);
+            bank->shift[dst] = bank->dmax - delay[src];
+        }
+
+    return bank;
+}
+
+void iir_bank_host_free(IIRBankHost *bank) {
+    if (!bank) return;
+    g_free(bank->a1_re);
+    g_free(bank->a1_im);
+    g_free(bank->b0_re);
+    g_free(bank->b0_im);
+    g_free(bank->y_re);
+    g_free(bank->y_im);
+    g_free(bank->shift);
+    g_free(bank->input);
+    g_free(bank);
+}
+
+void iir_bank_host_get_state(const IIRBankHost *bank, float *y) {
+    guint t, f;
+
+    for (t = 0; t < bank->num_templates; t++)
+        for (f = 0; f < bank->num_filters; f++) {
+            gsize src = iir_bank_host_index(bank, t, f);
+            gsize dst = 2 * ((gsize)t * bank->num_filters + f);
+            y[dst]     = bank->y_re[src];
+            y[dst + 1] = bank->y_im[src];
+        }
+}
+
+void iir_bank_host_set_state(IIRBankHost *bank, const float *y) {
+    guint t, f;
+
+    for (t = 0; t < bank->num_templates; t++)
+        for (f = 0; f < bank->num_filters; f++) {
+            gsize dst = iir_bank_host_index(bank, t, f);
+            gsize src = 2 * ((gsize)t * bank->num_filters + f);
+            bank->y_re[dst] = y[src];
+            bank->y_im[dst] = y[src + 1];
+        }
+}
+
+/* a block of templates as one vector, split by the compiler into as many
+ * hardware vectors as the target has */
+typedef float iir_lanes __attribute__((vector_size(LANES * sizeof(float))));
+
+/* Run one filter of a block of templates over n samples of x, adding its
+ * output to acc, [sample][lane]. */
+IIR_BANK_HOST_TARGETS
+static void filter_lanes(const float *a1_re,
+                         const float *a1_im,
+                         const float *b0_re,
+                         const float *b0_im,
+                         const gint *shift,
+                         float *y_re,
+                         float *y_im,
+                         const float *x,
+                         guint n,
+                         float *acc_re,
+                         float *acc_im) {
+    iir_lanes ar, ai, br, bi, yr, yi, xk, re, im, acc;
+    guint i, k;
+
+    memcpy(&ar, a1_re, sizeof(ar));
+    memcpy(&ai, a1_im, sizeof(ai));
+    memcpy(&br, b0_re, sizeof(br));
+    memcpy(&bi, b0_im, sizeof(bi));
+    memcpy(&yr, y_re, sizeof(yr));
+    memcpy(&yi, y_im, sizeof(yi));
+    for (i = 0; i < n; i++) {
+        for (k = 0; k < LANES; k++) xk[k] = x[shift[k] + i];
+        re = ar * yr - ai * yi + br * xk;
+        im = ar * yi + ai * yr + bi * xk;
+        yr = re;
+        yi = im;
+        memcpy(&acc, acc_re + i * LANES, sizeof(acc));
+        acc += re;
+        memcpy(acc_re + i * LANES, &acc, sizeof(acc));
+        memcpy(&acc, acc_im + i * LANES, sizeof(acc));
+        acc += im;
+        memcpy(acc_im + i * LANES, &acc, sizeof(acc));
+    }
+    memcpy(y_re, &yr, sizeof(yr));
+    memcpy(y_im, &yi, sizeof(yi));
+}
+
+typedef struct _IIRBankHostArgs {
+    IIRBankHost *bank;
+    const float *input;
+    guint length;
+    /* exactly one of these is set */
+    float complex *output_s;
+    double complex *output_d;
+} IIRBankHostArgs;
+
+static void iir_bank_host_block(guint block_start,
+                                guint block_end,
+                                gpointer data) {
+    const IIRBankHostArgs *args = data;
+    IIRBankHost *bank           = args->bank;
+    const guint nf = bank->num_filters, ntmplt = bank->num_templates;
+    float acc_re[IIR_BANK_HOST_CHUNK * LANES];
+    float acc_im[IIR_BANK_HOST_CHUNK * LANES];
+    guint block, n0, n, i, k, f;
+
+    for (block = block_start; block < block_end; block++) {
+        const guint t0     = block * LANES;
+        const guint nlanes = MIN(LANES, ntmplt - t0);
+        const gsize base   = (gsize)block * nf * LANES;
+
+        for (n0 = 0; n0 < args->length; n0 += IIR_BANK_HOST_CHUNK) {
+            n = MIN(IIR_BANK_HOST_CHUNK, args->length - n0);
+            memset(acc_re, 0, n * LANES * sizeof(*acc_re));
+            memset(acc_im, 0, n * LANES * sizeof(*acc_im));
+
+            for (f = 0; f < nf; f++) {
+                gsize off = base + (gsize)f * LANES;
+                filter_lanes(bank->a1_re + off, bank->a1_im + off,
+                             bank->b0_re + off, bank->b0_im + off,
+                             bank->shift + off, bank->y_re + off,
+                             bank->y_im + off, args->input + n0, n, acc_re,
+                             acc_im);
+            }
+
+            /* interleave into the [sample][template] output */
+            for (i = 0; i < n; i++) {
+                gsize out = (gsize)(n0 + i) * ntmplt + t0;
+                if (args->output_s)
+                    for (k = 0; k < nlanes; k++)
+                        args->output_s[out + k] =
+                          acc_re[i * LANES + k] + I * acc_im[i * LANES + k];
+                else
+                    for (k = 0; k < nlanes; k++)
+                        args->output_d[out + k] =
+                          acc_re[i * LANES + k] + I * acc_im[i * LANES + k];
+            }
+        }
+    }
+}
+
+static const ComputeKernel iir_bank_host_kernel = {
+    .name = "iir_bank",
+    .host = iir_bank_host_block,
+    .cuda = NULL,
+};
+
+static void iir_bank_host_run(IIRBankHost *bank, IIRBankHostArgs *args) {
+    /* the host queue runs on the calling thread, no queue needed */
+    compute_backend_host()->dispatch(NULL, &iir_bank_host_kernel,
+                                     bank->num_blocks, args);
+}
+
+void iir_bank_host_filter_s(IIRBankHost *bank,
+                            const float *input,
+                            guint length,
+                            float complex *output) {
+    IIRBankHostArgs args = { bank, input, length, output, NULL };
+
+    iir_bank_host_run(bank, &args);
+}
+
+void iir_bank_host_filter_d(IIRBankHost *bank,
+                            const double *input,
+                            guint length,
+                            double complex *output) {
+    IIRBankHostArgs args;
+    guint input_length = length + bank->dmax, i;
+
+    /* the bank runs in single precision like the GPU kernel */
+    if (input_length > bank->input_length) {
+        g_free(bank->input);
+        bank->input        = g_new(float, input_length);
+        bank->input_length = input_length;
+    }
+    for (i = 0; i < input_length; i++) bank->input[i] = input[i];
+
+    args.bank     = bank;
+    args.input    = bank->input;
+    args.length   = length;
+    args.output_s = NULL;
+    args.output_d = output;
+    iir_bank_host_run(bank, &args);
+}
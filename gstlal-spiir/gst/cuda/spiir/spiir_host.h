@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2026 The SPIIR authors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Host implementation of the SPIIR filter bank.
+ *
+ * Computes the same thing as cuda_iir_filter_kernel: for template t and
+ * filter f
+ *
+ *   y[t][f](n) = a1[t][f] y[t][f](n - 1) + b0[t][f] x(dmax - d[t][f] + n)
+ *   out(n)[t]  = sum over f of y[t][f](n)
+ *
+ * in single precision, where x holds length + dmax input samples and out is
+ * length samples of num_templates interleaved complex channels. The filter
+ * state is kept between calls.
+ *
+ * Templates are processed IIR_BANK_HOST_LANES at a time so that the complex
+ * recursion of one filter runs on a vector of templates, and blocks of
+ * templates are spread over the host compute backend's thread pool, see
+ * compute_backend.h.
+ */
+
+#ifndef __SPIIR_HOST_H__
+#define __SPIIR_HOST_H__
+
+#include <complex.h>
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* templates per block, one AVX-512 or two AVX2 vectors of floats */
+#define IIR_BANK_HOST_LANES 16
+
+typedef struct _IIRBankHost {
+    guint num_templates;
+    guint num_filters;
+    gint dmax;
+    guint num_blocks;
+    /* [block][filter][lane], templates past num_templates are zero */
+    float *a1_re, *a1_im;
+    float *b0_re, *b0_im;
+    float *y_re, *y_im;
+    gint *shift;
+    /* single precision copy of double precision input */
+    float *input;
+    guint input_length;
+} IIRBankHost;
+
+/* a1, b0 and y are num_templates x num_filters row major, as in the
+ * element's gsl matrices, delay likewise. y is the initial filter state. */
+IIRBankHost *iir_bank_host_new(guint num_templates,
+                               guint num_filters,
+                               const double complex *a1,
+                               const double complex *b0,
+                               const double complex *y,
+                               const gint *delay);
+
+void iir_bank_host_free(IIRBankHost *bank);
+
+/* the filter state as num_templates x num_filters interleaved complex
+ * floats, row major like y above. This is the layout of a depth's y in a
+ * filter state checkpoint, see multiratespiir_checkpoint.h. */
+void iir_bank_host_get_state(const IIRBankHost *bank, float *y);
+
+void iir_bank_host_set_state(IIRBankHost *bank, const float *y);
+
+/* input holds length + bank->dmax samples, output length * num_templates */
+void iir_bank_host_filter_s(IIRBankHost *bank,
+                            const float *input,
+                            guint length,
+                            float complex *output);
+
+void iir_bank_host_filter_d(IIRBankHost *bank,
+                            const double *input,
+                            guint length,
+                            double complex *output);
+
+G_END_DECLS
+
+#endif /* __SPIIR_HOST_H__ */
@@ -91,53 +91,6 @@ int get_stream_id(GSTLALIIRBankCuda *elem)
 }
 */
 
-/*
- * return the number of IIR channels
- */
-unsigned iir_channels(const GSTLALIIRBankCuda *element) {
-    if (element->a1) return 2 * element->a1->size1;
-    return 0;
-}
-
-/*
- * the number of samples available in the adapter
- */
-
-guint64 get_available_samples(GSTLALIIRBankCuda *element) {
-    return gst_adapter_available(element->adapter) / (element->width / 8);
-}
-
-/*
- * set the metadata on an output buffer.
- */
-
-void set_metadata(GSTLALIIRBankCuda *element,
-                  GstBuffer *buf,
-                  guint64 outsamples,
-                  gboolean gap) {
-    GST_BUFFER_SIZE(buf) =
-      outsamples * iir_channels(element) * element->width / 8;
-    GST_BUFFER_OFFSET(buf) = element->next_out_offset;
-    element->next_out_offset += outsamples;
-    GST_BUFFER_OFFSET_END(buf) = element->next_out_offset;
-    GST_BUFFER_TIMESTAMP(buf) =
-      element->t0
-      + gst_util_uint64_scale_int_round(
-        GST_BUFFER_OFFSET(buf) - element->offset0, GST_SECOND, element->rate);
-    GST_BUFFER_DURATION(buf) = element->t0
-                               + gst_util_uint64_scale_int_round(
-                                 GST_BUFFER_OFFSET_END(buf) - element->offset0,
-                                 GST_SECOND, element->rate)
-                               - GST_BUFFER_TIMESTAMP(buf);
-    if (element->need_discont) {
-        GST_BUFFER_FLAG_SET(buf, GST_BUFFER_FLAG_DISCONT);
-        element->need_discont = FALSE;
-    }
-    if (gap) GST_BUFFER_FLAG_SET(buf, GST_BUFFER_FLAG_GAP);
-    else
-        GST_BUFFER_FLAG_UNSET(buf, GST_BUFFER_FLAG_GAP);
-}
-
 int cuda_bank_init(GSTLALIIRBankCuda *element) {
 
     int dmax, dmin;
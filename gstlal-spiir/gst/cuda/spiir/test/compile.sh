@@ -0,0 +1,3 @@
+
+# host filter bank against a scalar double precision reference, no GPU needed
+gcc -g -O2 -o test_spiir_host -I ../.. test_spiir_host.c ../spiir_host.c ../../compute_backend.c `pkg-config --cflags --libs gthread-2.0` -lm
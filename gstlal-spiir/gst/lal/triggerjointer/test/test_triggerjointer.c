@@ -0,0 +1,366 @@
+/* Drive trigger_jointer from bare source pads, one thread per pad.
+ *
+ * The postcoh buffers carry zerolag triggers of several detector
+ * combinations and a background entry; V1 SNR comes in on a second pad.
+ * Every joined trigger is checked against the V1 SNR computed directly, and
+ * the output of batch-join=true must be identical to that of
+ * batch-join=false. A second run puts some triggers before the start of the
+ * SNR kept in the adapter: with snr-history they must be joined from the
+ * history, without it they must be left alone. */
+
+#include <glib.h>
+#include <gst/gst.h>
+#include <lal/Date.h>
+#include <math.h>
+#include <string.h>
+#include <triggerjointer/triggerjointer.h>
+
+#define RATE          256
+#define NTMPLT        4
+#define NBUFFER       6
+#define T0            1187008880
+#define NS_PER_SAMPLE ((INT8)GST_SECOND / RATE)
+/* V1_TIMELAG of triggerjointer.c in samples */
+#define NTIMELAG      7
+#define COHSNR        5.f
+
+/* where the template end time of each zerolag trigger falls in its buffer,
+ * in samples. The late ones are before the buffer start. */
+static const gint on_time_samples[] = { 0, 3, 100, 200, 255 };
+static const gint late_samples[]    = { -1, -20 };
+static const gchar *trigger_ifos[]  = { "H1L1", "H1", "L1" };
+
+/* V1 SNR of template t at sample n from T0, no two samples of a template
+ * alike */
+static COMPLEX_F snr_sample(gint64 n, gint t) {
+    COMPLEX_F snr   = { 0.f, 0.f };
+    float amplitude = 1.f + ((n * 37 + t * 11) % 97) / 16.f;
+    float phase     = 0.1f * (n % 61) + t;
+
+    /* the element pads the start with zeros */
+    if (n < 0) return snr;
+    snr.re = amplitude * cosf(phase);
+    snr.im = amplitude * sinf(phase);
+    return snr;
+}
+
+static GstBuffer *make_snr_buffer(gint ibuf) {
+    GstBuffer *buf =
+      gst_buffer_new_and_alloc(RATE * NTMPLT * sizeof(COMPLEX_F));
+    COMPLEX_F *snr = (COMPLEX_F *)GST_BUFFER_DATA(buf);
+    gint i, t;
+
+    for (i = 0; i < RATE; i++)
+        for (t = 0; t < NTMPLT; t++)
+            snr[i * NTMPLT + t] = snr_sample((gint64)ibuf * RATE + i, t);
+    GST_BUFFER_TIMESTAMP(buf)  = (GstClockTime)(T0 + ibuf) * GST_SECOND;
+    GST_BUFFER_DURATION(buf)   = GST_SECOND;
+    GST_BUFFER_OFFSET(buf)     = (guint64)ibuf * RATE;
+    GST_BUFFER_OFFSET_END(buf) = (guint64)(ibuf + 1) * RATE;
+    return buf;
+}
+
+static void set_trigger(PostcohInspiralTable *row,
+                        gint ibuf,
+                        gint irow,
+                        gint sample) {
+    INT8 ringdown_ns = irow * 1000000;
+    INT8 end_ns =
+      (INT8)(T0 + ibuf) * GST_SECOND + sample * NS_PER_SAMPLE - ringdown_ns;
+
+    row->event_id = irow;
+    XLALINT8NSToGPS(&row->end_time, end_ns);
+    XLALINT8NSToGPS(&row->ringdown_dur, ringdown_ns);
+    row->tmplt_idx = irow % NTMPLT;
+    row->cohsnr    = COHSNR;
+    strcpy(row->ifos, trigger_ifos[irow % G_N_ELEMENTS(trigger_ifos)]);
+}
+
+/* a background entry followed by the zerolag triggers, the late ones only
+ * if asked for */
+static GstBuffer *make_postcoh_buffer(gint ibuf, gboolean late) {
+    guint nlate = late ? G_N_ELEMENTS(late_samples) : 0;
+    guint nrows = 1 + G_N_ELEMENTS(on_time_samples) + nlate, i;
+    GstBuffer *buf =
+      gst_buffer_new_and_alloc(nrows * sizeof(PostcohInspiralTable));
+    PostcohInspiralTable *row = (PostcohInspiralTable *)GST_BUFFER_DATA(buf);
+
+    memset(row, 0, GST_BUFFER_SIZE(buf));
+    set_trigger(row, ibuf, 0, 10);
+    row->is_background = FLAG_BACKGROUND;
+    for (i = 0; i < G_N_ELEMENTS(on_time_samples); i++)
+        set_trigger(&row[1 + i], ibuf, 1 + i, on_time_samples[i]);
+    for (i = 0; i < nlate; i++)
+        set_trigger(&row[1 + G_N_ELEMENTS(on_time_samples) + i], ibuf,
+                    1 + G_N_ELEMENTS(on_time_samples) + i, late_samples[i]);
+
+    GST_BUFFER_TIMESTAMP(buf)  = (GstClockTime)(T0 + ibuf) * GST_SECOND;
+    GST_BUFFER_DURATION(buf)   = GST_SECOND;
+    GST_BUFFER_OFFSET(buf)     = ibuf;
+    GST_BUFFER_OFFSET_END(buf) = ibuf + 1;
+    return buf;
+}
+
+/* check one output row against its input row, joined with V1 or not */
+static void check_row(const PostcohInspiralTable *in,
+                      const PostcohInspiralTable *out,
+                      gint ibuf,
+                      gboolean joined) {
+    gint v1 = V1_IFO_ID, isample, max_isample = 0;
+    INT8 offset_ns = XLALGPSToINT8NS(&in->end_time)
+                     + XLALGPSToINT8NS(&in->ringdown_dur)
+                     - (INT8)(T0 + ibuf) * GST_SECOND;
+    gint64 first =
+      (gint64)ibuf * RATE + offset_ns / NS_PER_SAMPLE - NTIMELAG;
+    float max_abs_snr = 0.f, this_abs_snr, cohsnr;
+    COMPLEX_F snr;
+    gchar ifos[MAX_ALLIFO_LEN];
+
+    g_assert_cmpint(offset_ns % NS_PER_SAMPLE, ==, 0);
+    if (!joined) {
+        g_assert(memcmp(in, out, sizeof(*in)) == 0);
+        return;
+    }
+
+    /* the loudest sample of the template within the time lag window */
+    for (isample = 0; isample < 2 * NTIMELAG; isample++) {
+        snr          = snr_sample(first + isample, in->tmplt_idx);
+        this_abs_snr = sqrt(snr.re * snr.re + snr.im * snr.im);
+        if (this_abs_snr > max_abs_snr) {
+            max_isample = isample;
+            max_abs_snr = this_abs_snr;
+        }
+    }
+    snr    = snr_sample(first + max_isample, in->tmplt_idx);
+    cohsnr = sqrt(in->cohsnr * in->cohsnr + max_abs_snr * max_abs_snr);
+
+    g_snprintf(ifos, sizeof(ifos), "%sV1", in->ifos);
+    g_assert_cmpstr(out->ifos, ==, ifos);
+    g_assert_cmpfloat(fabs(out->snglsnr[v1] - max_abs_snr), <=,
+                      1e-6 * max_abs_snr);
+    g_assert_cmpfloat(fabs(out->coaphase[v1] - atan2(snr.im, snr.re)), <=,
+                      1e-6);
+    g_assert_cmpfloat(fabs(out->cohsnr - cohsnr), <=, 1e-6 * cohsnr);
+    g_assert_cmpint(XLALGPSToINT8NS(&out->end_time_sngl[v1]), ==,
+                    XLALGPSToINT8NS(&in->end_time)
+                      + (max_isample - NTIMELAG) * NS_PER_SAMPLE
+                      - XLALGPSToINT8NS(&in->ringdown_dur));
+    /* nothing else is touched */
+    g_assert(out->snglsnr[H1_IFO_ID] == 0.f && out->snglsnr[L1_IFO_ID] == 0.f);
+    g_assert(memcmp(&out->tmplt_idx, &in->tmplt_idx,
+                    G_STRUCT_OFFSET(PostcohInspiralTable, snglsnr)
+                      - G_STRUCT_OFFSET(PostcohInspiralTable, tmplt_idx))
+             == 0);
+}
+
+/*
+ * the element between bare pads
+ */
+
+typedef struct {
+    GstPad *pad;
+    gboolean late;
+    gboolean is_snr;
+} Feeder;
+
+static GMutex *output_lock;
+static GCond *output_eos;
+static GPtrArray *output;
+static gboolean got_eos;
+
+static GstFlowReturn output_chain(GstPad *pad, GstBuffer *buf) {
+    g_mutex_lock(output_lock);
+    g_ptr_array_add(output, buf);
+    g_mutex_unlock(output_lock);
+    return GST_FLOW_OK;
+}
+
+static gboolean output_event(GstPad *pad, GstEvent *event) {
+    if (GST_EVENT_TYPE(event) == GST_EVENT_EOS) {
+        g_mutex_lock(output_lock);
+        got_eos = TRUE;
+        g_cond_signal(output_eos);
+        g_mutex_unlock(output_lock);
+    }
+    gst_event_unref(event);
+    return TRUE;
+}
+
+/* the pads of collectpads block until the element takes their buffer, so
+ * each one is fed from its own thread. The SNR runs one buffer ahead of the
+ * triggers. */
+static gpointer feed(gpointer user_data) {
+    Feeder *feeder = user_data;
+    gint ibuf, nbuf = feeder->is_snr ? NBUFFER + 1 : NBUFFER;
+
+    gst_pad_push_event(feeder->pad, gst_event_new_new_segment(
+                                      FALSE, 1.0, GST_FORMAT_TIME, 0, -1, 0));
+    for (ibuf = 0; ibuf < nbuf; ibuf++) {
+        GstBuffer *buf = feeder->is_snr
+                           ? make_snr_buffer(ibuf)
+                           : make_postcoh_buffer(ibuf, feeder->late);
+        gst_buffer_set_caps(buf, GST_PAD_CAPS(feeder->pad));
+        /* refused once the element has stopped */
+        if (gst_pad_push(feeder->pad, buf) != GST_FLOW_OK) return NULL;
+    }
+    gst_pad_push_event(feeder->pad, gst_event_new_eos());
+    return NULL;
+}
+
+static GstPad *link_feeder(GstElement *jointer,
+                           const gchar *name,
+                           const gchar *caps_string) {
+    GstPad *src   = gst_pad_new(name, GST_PAD_SRC);
+    GstPad *sink  = gst_element_get_request_pad(jointer, name);
+    GstCaps *caps = gst_caps_from_string(caps_string);
+
+    g_assert(sink);
+    g_assert(gst_pad_link(src, sink) == GST_PAD_LINK_OK);
+    gst_object_unref(sink);
+    gst_pad_set_active(src, TRUE);
+    gst_pad_set_caps(src, caps);
+    gst_caps_unref(caps);
+    return src;
+}
+
+/* run NBUFFER postcoh buffers through a jointer, return the output buffers */
+static GPtrArray *run_jointer(gboolean batch_join,
+                              gdouble snr_history,
+                              gboolean late) {
+    GstElement *jointer = g_object_new(GSTLAL_TYPE_TRIGGER_JOINTER, NULL);
+    GstPad *sink        = gst_pad_new("sink", GST_PAD_SINK);
+    GstPad *srcpad;
+    gchar *snr_caps = g_strdup_printf(
+      "audio/x-raw-float, rate = (int) %d, channels = (int) %d, "
+      "endianness = (int) BYTE_ORDER, width = (int) 32",
+      RATE, 2 * NTMPLT);
+    Feeder postcoh = { NULL, late, FALSE }, snr = { NULL, late, TRUE };
+    GThread *postcoh_thread, *snr_thread;
+    GTimeVal deadline;
+    GPtrArray *result;
+
+    g_object_set(jointer, "batch-join", batch_join, "snr-history",
+                 snr_history, NULL);
+    /* the postcoh pad first, it sets the start time on a tie */
+    postcoh.pad =
+      link_feeder(jointer, "postcoh_H1L1", "application/x-lal-postcoh");
+    snr.pad = link_feeder(jointer, "snr_V1", snr_caps);
+    g_free(snr_caps);
+
+    gst_pad_set_chain_function(sink, output_chain);
+    gst_pad_set_event_function(sink, output_event);
+    srcpad = gst_element_get_static_pad(jointer, "src");
+    g_assert(gst_pad_link(srcpad, sink) == GST_PAD_LINK_OK);
+    gst_object_unref(srcpad);
+    gst_pad_set_active(sink, TRUE);
+
+    output  = g_ptr_array_new();
+    got_eos = FALSE;
+    g_assert(gst_element_set_state(jointer, GST_STATE_PLAYING)
+             == GST_STATE_CHANGE_SUCCESS);
+    postcoh_thread = g_thread_create(feed, &postcoh, TRUE, NULL);
+    snr_thread     = g_thread_create(feed, &snr, TRUE, NULL);
+
+    g_get_current_time(&deadline);
+    g_time_val_add(&deadline, 30 * G_USEC_PER_SEC);
+    g_mutex_lock(output_lock);
+    while (!got_eos)
+        g_assert(g_cond_timed_wait(output_eos, output_lock, &deadline));
+    result = output;
+    output = NULL;
+    g_mutex_unlock(output_lock);
+
+    gst_element_set_state(jointer, GST_STATE_NULL);
+    g_thread_join(postcoh_thread);
+    g_thread_join(snr_thread);
+    gst_object_unref(jointer);
+    gst_object_unref(postcoh.pad);
+    gst_object_unref(snr.pad);
+    gst_object_unref(sink);
+    return result;
+}
+
+static void free_buffers(GPtrArray *buffers) {
+    g_ptr_array_foreach(buffers, (GFunc)gst_buffer_unref, NULL);
+    g_ptr_array_free(buffers, TRUE);
+}
+
+/* on-time triggers, batched and one at a time */
+static void test_batch_matches_legacy(void) {
+    GPtrArray *legacy  = run_jointer(FALSE, 0, FALSE);
+    GPtrArray *batched = run_jointer(TRUE, 0, FALSE);
+    guint ibuf, irow, nrows;
+
+    g_assert_cmpuint(legacy->len, ==, NBUFFER);
+    g_assert_cmpuint(batched->len, ==, NBUFFER);
+    for (ibuf = 0; ibuf < NBUFFER; ibuf++) {
+        GstBuffer *in = make_postcoh_buffer(ibuf, FALSE);
+        GstBuffer *a  = g_ptr_array_index(legacy, ibuf);
+        GstBuffer *b  = g_ptr_array_index(batched, ibuf);
+        PostcohInspiralTable *in_rows =
+          (PostcohInspiralTable *)GST_BUFFER_DATA(in);
+        PostcohInspiralTable *rows = (PostcohInspiralTable *)GST_BUFFER_DATA(b);
+
+        g_assert_cmpuint(GST_BUFFER_TIMESTAMP(b), ==,
+                         GST_BUFFER_TIMESTAMP(in));
+        g_assert_cmpuint(GST_BUFFER_SIZE(a), ==, GST_BUFFER_SIZE(in));
+        g_assert_cmpuint(GST_BUFFER_SIZE(b), ==, GST_BUFFER_SIZE(in));
+        g_assert(memcmp(GST_BUFFER_DATA(a), GST_BUFFER_DATA(b),
+                        GST_BUFFER_SIZE(a))
+                 == 0);
+        nrows = GST_BUFFER_SIZE(in) / sizeof(PostcohInspiralTable);
+        for (irow = 0; irow < nrows; irow++)
+            check_row(&in_rows[irow], &rows[irow], ibuf,
+                      in_rows[irow].is_background == FLAG_FOREGROUND);
+        gst_buffer_unref(in);
+    }
+    free_buffers(legacy);
+    free_buffers(batched);
+}
+
+/* triggers before the adapter start are joined from the history, except in
+ * the first buffer, which has none, and are left alone without history */
+static void test_late_triggers(void) {
+    GPtrArray *history    = run_jointer(TRUE, 1.0, TRUE);
+    GPtrArray *no_history = run_jointer(TRUE, 0, TRUE);
+    guint ibuf, irow, nrows;
+
+    g_assert_cmpuint(history->len, ==, NBUFFER);
+    g_assert_cmpuint(no_history->len, ==, NBUFFER);
+    for (ibuf = 0; ibuf < NBUFFER; ibuf++) {
+        GstBuffer *in = make_postcoh_buffer(ibuf, TRUE);
+        PostcohInspiralTable *in_rows =
+          (PostcohInspiralTable *)GST_BUFFER_DATA(in);
+        PostcohInspiralTable *a = (PostcohInspiralTable *)GST_BUFFER_DATA(
+          g_ptr_array_index(history, ibuf));
+        PostcohInspiralTable *b = (PostcohInspiralTable *)GST_BUFFER_DATA(
+          g_ptr_array_index(no_history, ibuf));
+
+        nrows = GST_BUFFER_SIZE(in) / sizeof(PostcohInspiralTable);
+        for (irow = 0; irow < nrows; irow++) {
+            gboolean foreground =
+              in_rows[irow].is_background == FLAG_FOREGROUND;
+            gboolean late = irow > G_N_ELEMENTS(on_time_samples);
+
+            check_row(&in_rows[irow], &a[irow], ibuf,
+                      foreground && !(late && ibuf == 0));
+            check_row(&in_rows[irow], &b[irow], ibuf, foreground && !late);
+        }
+        gst_buffer_unref(in);
+    }
+    free_buffers(history);
+    free_buffers(no_history);
+}
+
+int main(int argc, char *argv[]) {
+    gst_init(&argc, &argv);
+    output_lock = g_mutex_new();
+    output_eos  = g_cond_new();
+
+    test_batch_matches_legacy();
+    test_late_triggers();
+
+    g_mutex_free(output_lock);
+    g_cond_free(output_eos);
+    return 0;
+}
@@ -321,6 +321,11 @@ static void destroy_notify(TriggerJointerCollectData *data) {
             g_array_unref(data->flag_segments);
             data->flag_segments = NULL;
         }
+        g_free(data->snr_span);
+        data->snr_span      = NULL;
+        data->snr_span_size = 0;
+        g_free(data->snr_ring);
+        data->snr_ring = NULL;
     }
 }
 
@@ -384,8 +389,17 @@ static gboolean trigger_jointer_set_snr_info(TriggerJointer *jointer) {
           "timelag in nsamples %d",
           data->ifo_name, data->ifo_mapping, data->rate, data->channels,
           data->bps, data->ntimelag);
-        return TRUE;
+
+        /* history of flushed SNR for late triggers */
+        data->ring_capacity = round(jointer->snr_history * data->rate);
+        data->ring_len      = 0;
+        data->ring_head     = 0;
+        g_free(data->snr_ring);
+        data->snr_ring = data->ring_capacity > 0
+                           ? g_malloc((gsize)data->ring_capacity * data->bps)
+                           : NULL;
     }
+    return TRUE;
 }
 
 static GstPad *trigger_jointer_request_new_pad(GstElement *element,
@@ -431,9 +445,15 @@ static GstPad *trigger_jointer_request_new_pad(GstElement *element,
         data->adapter = gst_adapter_new();
         /* gap segments */
         data->flag_segments = g_array_new(FALSE, FALSE, sizeof(FlagSegment));
-        data->ifo_name      = (gchar *)malloc(IFO_LEN * sizeof(gchar));
-        strncpy(data->ifo_name, req_name + 4,
-                sizeof(data->ifo_name)); // 4 for snr_
+        data->snr_span      = NULL;
+        data->snr_span_size = 0;
+        data->snr_ring      = NULL;
+        data->ring_capacity = 0;
+        data->ring_len      = 0;
+        data->ring_head     = 0;
+        data->ifo_name = (gchar *)malloc((IFO_LEN + 1) * sizeof(gchar));
+        strncpy(data->ifo_name, req_name + 4, IFO_LEN); // 4 for snr_
+        data->ifo_name[IFO_LEN] = '\0';
         for (j = 0; j < MAX_NIFO; j++) {
             if (strncmp(data->ifo_name, IFOMap[j].name, IFO_LEN) == 0)
                 data->ifo_mapping = j;
@@ -728,6 +748,68 @@ static gboolean trigger_jointer_need_recollect(GstCollectPads *pads,
     return need_recollect;
 }
 
+/* seconds from the start of the postcoh buffer to the template end time of
+ * the trigger, that is its merger end_time adjusted by the ringdown */
+static double trigger_jointer_trigger_offset(PostcohInspiralTable *trigger,
+                                             LIGOTimeGPS *buftime) {
+    float this_sec, this_nano;
+
+    this_sec = trigger->end_time.gpsSeconds + trigger->ringdown_dur.gpsSeconds
+               - buftime->gpsSeconds;
+    this_nano = trigger->end_time.gpsNanoSeconds
+                + trigger->ringdown_dur.gpsNanoSeconds
+                - buftime->gpsNanoSeconds;
+    return (double)this_sec + (double)(this_nano) / GST_SECOND;
+}
+
+/* fill in the coinc SNR of the trigger from the loudest sample of its
+ * template within the time lag window of this ifo. snr points to the first
+ * sample of the window, samples are ntmplt complex SNRs apart */
+static void trigger_jointer_join_trigger(TriggerJointer *jointer,
+                                         TriggerJointerCollectData *data,
+                                         PostcohInspiralTable *trigger,
+                                         const COMPLEX_F *snr) {
+    int isample, max_isample = 0, tmplt_idx = trigger->tmplt_idx;
+    COMPLEX_F this_snr;
+    float max_abs_snr = 0, this_abs_snr;
+    LIGOTimeGPS end_time;
+
+    /* find the maximum SNR within the window of the triggering time
+     */
+    for (isample = 0; isample < 2 * data->ntimelag; isample++) {
+        this_snr     = snr[data->ntmplt * isample + tmplt_idx];
+        this_abs_snr = sqrt(this_snr.re * this_snr.re + this_snr.im * this_snr.im);
+        if (this_abs_snr > max_abs_snr) {
+            max_isample = isample;
+            max_abs_snr = this_abs_snr;
+        }
+    }
+    trigger->snglsnr[data->ifo_mapping]  = max_abs_snr;
+    this_snr                             = snr[data->ntmplt * max_isample + tmplt_idx];
+    trigger->coaphase[data->ifo_mapping] = atan2(this_snr.im, this_snr.re);
+    end_time = trigger->end_time; // end time from the triggering
+                                  // single-ifo trigger
+    XLALGPSAdd(&(end_time), (double)(max_isample - data->ntimelag)
+                              / data->rate); // adjust for the start
+    end_time.gpsSeconds =
+      end_time.gpsSeconds
+      - trigger->ringdown_dur.gpsSeconds; // adjust for ringdown
+    end_time.gpsNanoSeconds =
+      end_time.gpsNanoSeconds - trigger->ringdown_dur.gpsNanoSeconds;
+
+    trigger->end_time_sngl[data->ifo_mapping] = end_time;
+    trigger->cohsnr =
+      sqrt(trigger->cohsnr * trigger->cohsnr + max_abs_snr * max_abs_snr);
+
+    GST_DEBUG_OBJECT(
+      jointer,
+      "new ifos -> %s, this ifo %d, sample %d, tmplt_idx %d,"
+      "coinc ifo time %d, %d, max snr.re %f, snr.im %f, snr %f",
+      trigger->ifos, data->ifo_mapping, max_isample, tmplt_idx,
+      end_time.gpsSeconds, end_time.gpsNanoSeconds, this_snr.re, this_snr.im,
+      sqrt(this_snr.re * this_snr.re + this_snr.im * this_snr.im));
+}
+
 static GstFlowReturn trigger_jointer_append_coinc_snr(TriggerJointer *jointer,
                                                       GstBuffer *postcoh_buf) {
 
@@ -740,17 +822,15 @@ static GstFlowReturn trigger_jointer_append_coinc_snr(TriggerJointer *jointer,
     float exe_dur = ((double)GST_BUFFER_DURATION(postcoh_buf)) / GST_SECOND;
     gint exe_size = 0, one_take_size = 0;
     gboolean is_gap;
-    int one_ifo_size = sizeof(gchar) * IFO_LEN, len_ifos = 0, nifo = 0,
-        pad_loc = 0;
+    int len_ifos;
     LIGOTimeGPS cur_buftime;
     GstClockTime postcoh_buf_ts = GST_BUFFER_TIMESTAMP(postcoh_buf);
     XLALINT8NSToGPS(&cur_buftime, postcoh_buf_ts);
 
-    int tmplt_idx, this_sample;
-    float this_sec, this_nano;
+    int this_sample;
 
-    PostcohInspiralTable *trigger =
-      (PostcohInspiralTable *)GST_BUFFER_DATA(postcoh_buf);
+    PostcohInspiralTable *trigger,
+      *trigger_start = (PostcohInspiralTable *)GST_BUFFER_DATA(postcoh_buf);
     PostcohInspiralTable *trigger_end =
       (PostcohInspiralTable *)(GST_BUFFER_DATA(postcoh_buf)
                                + GST_BUFFER_SIZE(postcoh_buf));
@@ -792,39 +872,21 @@ static GstFlowReturn trigger_jointer_append_coinc_snr(TriggerJointer *jointer,
             continue;
         }
 
-        /* not a gap, extend the trigger field ifos with the new ifo */
-        if (trigger->ifos) {
-            len_ifos = strlen(trigger->ifos);
-            nifo     = len_ifos / IFO_LEN;
-            pad_loc  = len_ifos + IFO_LEN;
-        }
-
-        /* find the coinc snr from tmplt idx
+        /* not a gap, find the coinc snr from tmplt idx
          * and time idx */
-        int isample, max_isample = 0;
-        COMPLEX_F this_snr;
-        float max_abs_snr = 0, this_abs_snr;
-        LIGOTimeGPS end_time;
-        for (; trigger < trigger_end; trigger++) {
+        for (trigger = trigger_start; trigger < trigger_end; trigger++) {
             /* not a zerolag trigger but an entry
              * just to indicate ifos */
             if (trigger->is_background != FLAG_FOREGROUND) continue;
-            max_isample = 0;
-            max_abs_snr = 0;
-            /* inserting the IFO into the IFO list */
-            strncpy(trigger->ifos + len_ifos, data->ifo_name, one_ifo_size);
-            trigger->ifos[pad_loc] = '\0';
+            /* extend the trigger field ifos with the new ifo, the triggers
+             * of a buffer need not have the same ifos */
+            len_ifos = strlen(trigger->ifos);
+            strncpy(trigger->ifos + len_ifos, data->ifo_name, IFO_LEN);
+            trigger->ifos[len_ifos + IFO_LEN] = '\0';
             /* find the sample corresponding to the end_time of the trigger
-             * note adjust the merger end_time to the template end_time */
-            this_sec = trigger->end_time.gpsSeconds
-                       + trigger->ringdown_dur.gpsSeconds
-                       - cur_buftime.gpsSeconds;
-            this_nano = trigger->end_time.gpsNanoSeconds
-                        + trigger->ringdown_dur.gpsNanoSeconds
-                        - cur_buftime.gpsNanoSeconds;
-            this_sample =
-              round(((double)this_sec + (double)(this_nano) / GST_SECOND)
-                    * data->rate);
+             */
+            this_sample = round(
+              trigger_jointer_trigger_offset(trigger, &cur_buftime) * data->rate);
             if (this_sample < 0 || this_sample >= data->rate) {
                 fprintf(
                   stderr,
@@ -832,54 +894,185 @@ static GstFlowReturn trigger_jointer_append_coinc_snr(TriggerJointer *jointer,
                   this_sample);
                 exit(0);
             }
-            /* find the tmplt idx of the trigger */
-            tmplt_idx = trigger->tmplt_idx;
-            /* find the maximum SNR within the window of the triggering time
-             */
-            for (isample = 0; isample < 2 * data->ntimelag; isample++) {
-                this_snr =
-                  snglsnr[data->ntmplt * (this_sample + isample) + tmplt_idx];
-                this_abs_snr =
-                  sqrt(this_snr.re * this_snr.re + this_snr.im * this_snr.im);
-                if (this_abs_snr > max_abs_snr) {
-                    max_isample = isample;
-                    max_abs_snr = this_abs_snr;
-                }
-            }
-            trigger->snglsnr[data->ifo_mapping] = max_abs_snr;
-            this_snr =
-              snglsnr[data->ntmplt * (this_sample + max_isample) + tmplt_idx];
-            trigger->coaphase[data->ifo_mapping] =
-              atan2(this_snr.im, this_snr.re);
-            end_time = trigger->end_time; // end time from the triggering
-                                          // single-ifo trigger
-            XLALGPSAdd(&(end_time),
-                       (double)(max_isample - data->ntimelag)
-                         / data->rate); // adjust for the start
-            end_time.gpsSeconds =
-              end_time.gpsSeconds
-              - trigger->ringdown_dur.gpsSeconds; // adjust for ringdown
-            end_time.gpsNanoSeconds =
-              end_time.gpsNanoSeconds - trigger->ringdown_dur.gpsNanoSeconds;
-
-            trigger->end_time_sngl[data->ifo_mapping] = end_time;
-            trigger->cohsnr = sqrt(trigger->cohsnr * trigger->cohsnr
-                                   + max_abs_snr * max_abs_snr);
-
-            GST_DEBUG_OBJECT(
-              jointer,
-              "new ifos -> %s, this ifo %d, sample %d, tmplt_idx %d,"
-              "coinc ifo time %d, %d, max snr.re %f, snr.im %f, snr %f",
-              trigger->ifos, data->ifo_mapping, max_isample, tmplt_idx,
-              end_time.gpsSeconds, end_time.gpsNanoSeconds, this_snr.re,
-              this_snr.im,
-              sqrt(this_snr.re * this_snr.re + this_snr.im * this_snr.im));
+            trigger_jointer_join_trigger(jointer, data, trigger,
+                                         snglsnr + data->ntmplt * this_sample);
         }
         gst_adapter_flush(data->adapter, exe_size);
     }
     return ret;
 }
 
+/* a zerolag trigger and its time from the start of the postcoh buffer */
+typedef struct _TriggerIndex {
+    double offset;
+    PostcohInspiralTable *trigger;
+} TriggerIndex;
+
+/* flush size bytes of SNR from the adapter, the latest of them go to the
+ * history ring if there is one */
+static void trigger_jointer_flush_snr(TriggerJointerCollectData *data,
+                                      gint size) {
+    gint nsamples, nkeep, first, chunk;
+
+    nsamples = MIN((gsize)size, gst_adapter_available(data->adapter))
+               / data->bps;
+    if (data->snr_ring && nsamples > 0) {
+        nkeep = MIN(nsamples, data->ring_capacity);
+        first = nsamples - nkeep;
+        while (nkeep > 0) {
+            chunk = MIN(nkeep, data->ring_capacity - data->ring_head);
+            gst_adapter_copy(data->adapter,
+                             data->snr_ring + data->ring_head * data->bps,
+                             first * data->bps, chunk * data->bps);
+            data->ring_head = (data->ring_head + chunk) % data->ring_capacity;
+            first += chunk;
+            nkeep -= chunk;
+        }
+        data->ring_len = MIN(data->ring_len + nsamples, data->ring_capacity);
+    }
+    gst_adapter_flush(data->adapter, size);
+}
+
+/* copy nsamples of the history ring starting at sample from, counted
+ * backwards from the adapter start so from is negative */
+static void trigger_jointer_copy_ring(TriggerJointerCollectData *data,
+                                      guint8 *dest,
+                                      gint from,
+                                      gint nsamples) {
+    gint start = (data->ring_head + from + data->ring_capacity)
+                 % data->ring_capacity;
+    gint chunk = MIN(nsamples, data->ring_capacity - start);
+
+    memcpy(dest, data->snr_ring + start * data->bps, chunk * data->bps);
+    memcpy(dest + chunk * data->bps, data->snr_ring,
+           (nsamples - chunk) * data->bps);
+}
+
+/* same as trigger_jointer_append_coinc_snr, but the zerolag triggers and
+ * their times are found once, and the SNR of each ifo they need is gathered
+ * with a single copy out of the adapter instead of one peek of the whole
+ * buffer. Triggers
+ * earlier than the adapter start are looked up in the history ring, those
+ * out of reach are left without this ifo instead of stopping the pipeline.
+ */
+static GstFlowReturn
+trigger_jointer_append_coinc_snr_batched(TriggerJointer *jointer,
+                                         GstBuffer *postcoh_buf) {
+
+    GSList *snrdata;
+    TriggerJointerCollectData *data;
+    TriggerIndex *index, entry;
+    /* promote the type to double, otherwise it will be interger */
+    float exe_dur = ((double)GST_BUFFER_DURATION(postcoh_buf)) / GST_SECOND;
+    gint exe_size, one_take_size, exe_samples, window, sample, lo, hi, from;
+    gsize span_size;
+    guint i, ntrigger;
+    int len_ifos;
+    LIGOTimeGPS cur_buftime;
+    GstClockTime postcoh_buf_ts = GST_BUFFER_TIMESTAMP(postcoh_buf);
+    XLALINT8NSToGPS(&cur_buftime, postcoh_buf_ts);
+
+    PostcohInspiralTable *trigger =
+      (PostcohInspiralTable *)GST_BUFFER_DATA(postcoh_buf);
+    PostcohInspiralTable *trigger_end =
+      (PostcohInspiralTable *)(GST_BUFFER_DATA(postcoh_buf)
+                               + GST_BUFFER_SIZE(postcoh_buf));
+
+    /* the zerolag triggers, the same for every ifo */
+    g_array_set_size(jointer->trigger_index, 0);
+    for (; trigger < trigger_end; trigger++) {
+        if (trigger->is_background != FLAG_FOREGROUND) continue;
+        entry.offset  = trigger_jointer_trigger_offset(trigger, &cur_buftime);
+        entry.trigger = trigger;
+        g_array_append_val(jointer->trigger_index, entry);
+    }
+    index    = (TriggerIndex *)jointer->trigger_index->data;
+    ntrigger = jointer->trigger_index->len;
+
+    for (snrdata = jointer->collect_snrdata; snrdata;
+         snrdata = g_slist_next(snrdata)) {
+        data     = snrdata->data;
+        exe_size = round(exe_dur * data->rate * data->bps);
+        one_take_size =
+          exe_size + data->ntimelag * 2 * data->bps; // bps: bypes per sample
+        exe_samples = exe_size / data->bps;
+        window      = 2 * data->ntimelag;
+
+        /* if no triggers, just flush the snrs */
+        if (GST_BUFFER_SIZE(postcoh_buf) == 0) {
+            trigger_jointer_flush_snr(data, exe_size);
+            continue;
+        }
+
+        /* no enough data in adapter, do nothing */
+        if (gst_adapter_available(data->adapter) < (guint)one_take_size)
+            continue;
+
+        /* a gap also breaks the history */
+        if (need_flag_gap(data, postcoh_buf_ts, data->next_tstart)) {
+            gst_adapter_flush(data->adapter, exe_size);
+            data->ring_len = 0;
+            GST_DEBUG_OBJECT(jointer,
+                             "the snr buffer is a gap, flush it from adapter");
+            continue;
+        }
+
+        /* the span of samples the triggers need */
+        lo = G_MAXINT;
+        hi = G_MININT;
+        for (i = 0; i < ntrigger; i++) {
+            sample = round(index[i].offset * data->rate);
+            if (sample < -data->ring_len || sample >= exe_samples) {
+                GST_WARNING_OBJECT(jointer,
+                                   "%s snr for the trigger at sample %d is "
+                                   "not kept, [%d, %d), skip it",
+                                   data->ifo_name, sample, -data->ring_len,
+                                   exe_samples);
+                continue;
+            }
+            lo = MIN(lo, sample);
+            hi = MAX(hi, sample + window);
+        }
+        if (lo > hi) {
+            trigger_jointer_flush_snr(data, exe_size);
+            continue;
+        }
+
+        /* gather the span, the part before the adapter start from the ring
+         */
+        span_size = (gsize)(hi - lo) * data->bps;
+        if (span_size > data->snr_span_size) {
+            g_free(data->snr_span);
+            data->snr_span      = g_malloc(span_size);
+            data->snr_span_size = span_size;
+        }
+        if (lo < 0)
+            trigger_jointer_copy_ring(data, data->snr_span, lo,
+                                      MIN(hi, 0) - lo);
+        if (hi > 0) {
+            from = MAX(lo, 0);
+            gst_adapter_copy(data->adapter,
+                             data->snr_span + (from - lo) * data->bps,
+                             from * data->bps, (hi - from) * data->bps);
+        }
+
+        for (i = 0; i < ntrigger; i++) {
+            sample = round(index[i].offset * data->rate);
+            if (sample < -data->ring_len || sample >= exe_samples) continue;
+            trigger = index[i].trigger;
+            /* inserting the IFO into the IFO list */
+            len_ifos = strlen(trigger->ifos);
+            strncpy(trigger->ifos + len_ifos, data->ifo_name, IFO_LEN);
+            trigger->ifos[len_ifos + IFO_LEN] = '\0';
+            trigger_jointer_join_trigger(
+              jointer, data, trigger,
+              (COMPLEX_F *)(data->snr_span + (sample - lo) * data->bps));
+        }
+        trigger_jointer_flush_snr(data, exe_size);
+    }
+    return GST_FLOW_OK;
+}
+
 static GstFlowReturn trigger_jointer_process(GstCollectPads *pads,
                                              TriggerJointer *jointer) {
     GSList *collectlist;
@@ -919,7 +1112,10 @@ static GstFlowReturn trigger_jointer_process(GstCollectPads *pads,
     }
     /* append coincidence snr from the snr buffer for each postcoh trigger
      */
-    ret = trigger_jointer_append_coinc_snr(jointer, postcoh_buf);
+    if (jointer->batch_join)
+        ret = trigger_jointer_append_coinc_snr_batched(jointer, postcoh_buf);
+    else
+        ret = trigger_jointer_append_coinc_snr(jointer, postcoh_buf);
 
     if (ret != GST_FLOW_OK) {
         fprintf(stderr, "failed to append coinc snr");
@@ -1038,7 +1234,55 @@ static GstFlowReturn collected(GstCollectPads *pads, gpointer user_data) {
 
 /* no set caps */
 
-/* no set properties */
+/* properties */
+
+enum {
+    PROP_0,
+    PROP_BATCH_JOIN,
+    PROP_SNR_HISTORY,
+};
+
+static void trigger_jointer_set_property(GObject *object,
+                                         guint id,
+                                         const GValue *value,
+                                         GParamSpec *pspec) {
+    TriggerJointer *element = TRIGGER_JOINTER(object);
+
+    GST_OBJECT_LOCK(element);
+    switch (id) {
+    case PROP_BATCH_JOIN:
+        element->batch_join = g_value_get_boolean(value);
+        break;
+
+    case PROP_SNR_HISTORY:
+        element->snr_history = g_value_get_double(value);
+        break;
+
+    default: G_OBJECT_WARN_INVALID_PROPERTY_ID(object, id, pspec); break;
+    }
+    GST_OBJECT_UNLOCK(element);
+}
+
+static void trigger_jointer_get_property(GObject *object,
+                                         guint id,
+                                         GValue *value,
+                                         GParamSpec *pspec) {
+    TriggerJointer *element = TRIGGER_JOINTER(object);
+
+    GST_OBJECT_LOCK(element);
+    switch (id) {
+    case PROP_BATCH_JOIN:
+        g_value_set_boolean(value, element->batch_join);
+        break;
+
+    case PROP_SNR_HISTORY:
+        g_value_set_double(value, element->snr_history);
+        break;
+
+    default: G_OBJECT_WARN_INVALID_PROPERTY_ID(object, id, pspec); break;
+    }
+    GST_OBJECT_UNLOCK(element);
+}
 
 /* initialization */
 
@@ -1049,6 +1293,9 @@ static void trigger_jointer_dispose(GObject *object) {
 
     if (element->srcpad) gst_object_unref(element->srcpad);
     element->srcpad = NULL;
+
+    if (element->trigger_index) g_array_unref(element->trigger_index);
+    element->trigger_index = NULL;
     G_OBJECT_CLASS(parent_class)->dispose(object);
 }
 
@@ -1081,6 +1328,10 @@ static void trigger_jointer_class_init(TriggerJointerClass *klass) {
 
     parent_class = g_type_class_ref(GST_TYPE_ELEMENT);
 
+    gobject_class->set_property =
+      GST_DEBUG_FUNCPTR(trigger_jointer_set_property);
+    gobject_class->get_property =
+      GST_DEBUG_FUNCPTR(trigger_jointer_get_property);
     gobject_class->dispose = GST_DEBUG_FUNCPTR(trigger_jointer_dispose);
     gstelement_class->request_new_pad =
       GST_DEBUG_FUNCPTR(trigger_jointer_request_new_pad);
@@ -1088,6 +1339,24 @@ static void trigger_jointer_class_init(TriggerJointerClass *klass) {
       GST_DEBUG_FUNCPTR(trigger_jointer_release_pad);
     gstelement_class->change_state =
       GST_DEBUG_FUNCPTR(trigger_jointer_change_state);
+
+    g_object_class_install_property(
+      gobject_class, PROP_BATCH_JOIN,
+      g_param_spec_boolean(
+        "batch-join", "batch join",
+        "Gather the SNR the triggers of a buffer need with one copy per "
+        "detector, and join late triggers from snr-history. Off to join them "
+        "one at a time from a peek of the whole buffer.",
+        FALSE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+    g_object_class_install_property(
+      gobject_class, PROP_SNR_HISTORY,
+      g_param_spec_double(
+        "snr-history", "SNR history",
+        "Seconds of flushed SNR kept per detector for triggers that arrive "
+        "after their SNR has left the adapter. Only used with batch-join, "
+        "0 keeps none. Takes effect when the caps are first set.",
+        0, G_MAXDOUBLE, 0, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 }
 
 static void trigger_jointer_init(TriggerJointer *jointer,
@@ -1110,4 +1379,7 @@ static void trigger_jointer_init(TriggerJointer *jointer,
     jointer->is_snr_info_set    = FALSE;
     jointer->is_all_aligned     = FALSE;
     jointer->is_next_tstart_set = FALSE;
+    jointer->batch_join         = FALSE;
+    jointer->snr_history        = 0;
+    jointer->trigger_index = g_array_new(FALSE, FALSE, sizeof(TriggerIndex));
 }
@@ -77,6 +77,15 @@ struct _TriggerJointerCollectData {
     GstClockTime next_tstart; // expected next buffer time
     GstAdapter *adapter;
     GArray *flag_segments;
+    /* batched joining: the SNR span the triggers of a postcoh buffer need,
+     * and a ring of the most recently flushed SNR samples so triggers that
+     * arrive late can still be joined */
+    guint8 *snr_span;
+    gsize snr_span_size;
+    guint8 *snr_ring;
+    gint ring_capacity; // in samples
+    gint ring_len; // valid samples, the latest one before the adapter
+    gint ring_head; // where the next sample goes
 };
 
 /**
@@ -106,6 +115,10 @@ struct _TriggerJointer {
 
     GstClockTime t0;
     gint output_skymap;
+
+    gboolean batch_join;
+    gdouble snr_history; // seconds of flushed SNR kept for late triggers
+    GArray *trigger_index;
 };
 
 struct _TriggerJointerClass {
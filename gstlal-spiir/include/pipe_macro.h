@@ -43,6 +43,9 @@ int get_icombo(char *ifos);
 #define FLAG_FOREGROUND      0
 #define FLAG_BACKGROUND      1
 #define FLAG_EMPTY           2
+/* single-detector trigger taken straight from the peak list, no coherent
+ * statistics and no chisq. There are no background trials for these */
+#define FLAG_SNGL 3
 
 /* definition of array for background statistics */
 #define LOGSNR_CMIN   0.54 // center of the first bin
@@ -73,12 +76,16 @@ int get_icombo(char *ifos);
 #define ZEROLAG_XML_RANK_NAME    "zerolag_rank"
 #define SIGNAL_XML_FEATURE_NAME  "signal_feature"
 #define SIGNAL_XML_RANK_NAME     "signal_rank"
+/* zero-lag single-detector triggers, snr rate only */
+#define SNGL_XML_FEATURE_NAME    "sngl_feature"
+#define SNGL_XML_RANK_NAME       "sngl_rank"
 
 #define STATS_XML_ID_NAME         "gstlal_postcohspiir_stats"
 #define STATS_XML_TYPE_BACKGROUND 1
 #define STATS_XML_TYPE_ZEROLAG    2
 #define STATS_XML_TYPE_SIGNAL     3
 #define STATS_XML_TYPE_ALL        4
+#define STATS_XML_TYPE_SNGL       5
 
 #define STATS_XML_WRITE_START 1
 #define STATS_XML_WRITE_MID   2
@@ -130,7 +130,9 @@ def mkcudapostcoh(pipeline,
                   output_skymap=0,
                   detrsp_refresh_interval=0,
                   trial_interval=0.1,
-                  stream_id=0):
+                  stream_id=0,
+                  detrsp_ifo_horizons=None,
+                  detrsp_chealpix_order=4):
     properties = dict((name, value) for name, value in zip((
         "detrsp-fname", "autocorrelation-fname", "sngl-tmplt-fname",
         "hist-trials", "snglsnr-thresh", "cohsnr_thresh", "output-skymap",
@@ -139,6 +141,10 @@ def mkcudapostcoh(pipeline,
                        hist_trials, snglsnr_thresh, cohsnr_thresh,
                        output_skymap, detrsp_refresh_interval, trial_interval,
                        stream_id)))
+    # generate the detector response map in memory instead of reading
+    # detrsp_fname, the order has to be set first
+    if detrsp_ifo_horizons is not None:
+        properties["detrsp-chealpix-order"] = detrsp_chealpix_order
     if "name" in properties:
         elem = gst.element_factory_make("cuda_postcoh", properties.pop("name"))
     else:
@@ -150,6 +156,8 @@ def mkcudapostcoh(pipeline,
     for name, value in properties.items():
         if name != "stream-id":
             elem.set_property(name.replace("_", "-"), value)
+    if detrsp_ifo_horizons is not None:
+        elem.set_property("detrsp-ifo-horizons", detrsp_ifo_horizons)
 
     pipeline.add(elem)
     snr.link_pads(None, elem, instrument)
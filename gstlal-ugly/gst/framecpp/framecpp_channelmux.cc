@@ -37,6 +37,8 @@
 #include <stdint.h>
 #include <stdexcept>
 #include <string.h>
+#include <unistd.h>
+#include <vector>
 
 
 /*
@@ -147,6 +149,8 @@ GType framecpp_channelmux_compression_scheme_get_type(void)
 #define DEFAULT_FRAME_NUMBER 0
 #define DEFAULT_COMPRESSION_SCHEME FrameCPP::FrVect::RAW
 #define DEFAULT_COMPRESSION_LEVEL 0
+#define DEFAULT_COMPRESSION_THREADS 1
+#define DEFAULT_OVERLAP_WRITE FALSE
 
 
 #define FRAME_FILE_DURATION(mux) ((mux)->frames_per_file * (mux)->frame_duration)
@@ -247,6 +251,318 @@ static GstTagList *get_srcpad_tag_list(GstFrameCPPChannelMux *mux)
 }
 
 
+/*
+ * parallel FrVect compression.  the FrVects of a frame are compressed in
+ * place by the worker pool, one task per FrVect;  the frame is written
+ * once all of its FrVects are done, so the file's contents do not depend
+ * on the order in which the tasks complete.
+ */
+
+
+struct compression_job {
+	GMutex *lock;
+	GCond *finished;
+	guint remaining;
+	FrameCPP::FrVect::compression_scheme_type scheme;
+	gint level;
+	gchar *error;
+};
+
+
+struct compression_task {
+	struct compression_job *job;
+	FrameCPP::FrVect *vect;
+};
+
+
+static void compress_vect(gpointer data, gpointer user_data)
+{
+	struct compression_task *task = (struct compression_task *) data;
+	struct compression_job *job = task->job;
+	gchar *error = NULL;
+
+	try {
+		task->vect->Compress(job->scheme, job->level);
+	} catch(const std::exception& Exception) {
+		error = g_strdup(Exception.what());
+	} catch(...) {
+		error = g_strdup("unknown exception");
+	}
+
+	g_mutex_lock(job->lock);
+	if(error && !job->error)
+		job->error = error;
+	else
+		g_free(error);
+	if(!--job->remaining)
+		g_cond_signal(job->finished);
+	g_mutex_unlock(job->lock);
+
+	g_free(task);
+}
+
+
+static struct compression_job *compression_job_start(GstFrameCPPChannelMux *mux, const std::vector<FrameCPP::FrVect *> &vects)
+{
+	struct compression_job *job = g_new(struct compression_job, 1);
+	std::vector<FrameCPP::FrVect *>::const_iterator vect;
+
+	job->lock = g_mutex_new();
+	job->finished = g_cond_new();
+	job->remaining = vects.size();
+	job->scheme = (FrameCPP::FrVect::compression_scheme_type) mux->compression_scheme;
+	job->level = mux->compression_level;
+	job->error = NULL;
+
+	for(vect = vects.begin(); vect != vects.end(); vect++) {
+		struct compression_task *task = g_new(struct compression_task, 1);
+		GError *error = NULL;
+		task->job = job;
+		task->vect = *vect;
+		g_thread_pool_push(mux->compression_pool, task, &error);
+		if(error) {
+			/* can't get help, do it ourselves */
+			GST_WARNING_OBJECT(mux, "g_thread_pool_push() failed: %s", error->message);
+			g_error_free(error);
+			compress_vect(task, NULL);
+		}
+	}
+
+	return job;
+}
+
+
+/*
+ * wait for a job to complete and free it.  returns the first error
+ * reported by a worker, if any, which the calling code must free.
+ */
+
+
+static gchar *compression_job_finish(struct compression_job *job)
+{
+	gchar *error;
+
+	g_mutex_lock(job->lock);
+	while(job->remaining)
+		g_cond_wait(job->finished, job->lock);
+	g_mutex_unlock(job->lock);
+
+	error = job->error;
+	g_cond_free(job->finished);
+	g_mutex_free(job->lock);
+	g_free(job);
+
+	return error;
+}
+
+
+static guint compression_threads(GstFrameCPPChannelMux *mux)
+{
+	if(mux->compression_threads)
+		return mux->compression_threads;
+	return MAX(sysconf(_SC_NPROCESSORS_ONLN), 1);
+}
+
+
+/*
+ * build one frame from queue contents.  the FrVects appended to the frame
+ * are recorded in vects.  may throw.
+ */
+
+
+static LDASTools::AL::SharedPtr<FrameCPP::FrameH> build_frame(GstFrameCPPChannelMux *mux, GstClockTime frame_t_start, GstClockTime frame_t_end, guint frame_number, std::vector<FrameCPP::FrVect *> &vects)
+{
+	GHashTableIter it;
+	gchar *instrument;
+	guint i;
+	GSList *collectdatalist;
+	FrameCPP::GPSTime gpstime(frame_t_start / GST_SECOND, frame_t_start % GST_SECOND);
+	LDASTools::AL::SharedPtr<FrameCPP::FrameH> frame(new FrameCPP::FrameH(mux->frame_name, mux->frame_run, frame_number, gpstime, gpstime.GetLeapSeconds(), (double) (frame_t_end - frame_t_start) / GST_SECOND));
+
+	GST_LOG_OBJECT(mux, "building frame %d [%" GST_TIME_SECONDS_FORMAT ", %" GST_TIME_SECONDS_FORMAT ")", frame_number, GST_TIME_SECONDS_ARGS(frame_t_start), GST_TIME_SECONDS_ARGS(frame_t_end));
+
+	/*
+	 * add FrDetector objects
+	 */
+
+	g_hash_table_iter_init(&it, mux->instruments);
+	while(g_hash_table_iter_next(&it, (void **) &instrument, NULL)) {
+		if(!strcmp(instrument, "H1"))
+			frame->RefDetectProc().append(FrameCPP::GetDetector(FrameCPP::DETECTOR_LOCATION_H1, gpstime));
+		if(!strcmp(instrument, "H2"))
+			frame->RefDetectProc().append(FrameCPP::GetDetector(FrameCPP::DETECTOR_LOCATION_H2, gpstime));
+		if(!strcmp(instrument, "L1"))
+			frame->RefDetectProc().append(FrameCPP::GetDetector(FrameCPP::DETECTOR_LOCATION_L1, gpstime));
+		if(!strcmp(instrument, "V1"))
+			frame->RefDetectProc().append(FrameCPP::GetDetector(FrameCPP::DETECTOR_LOCATION_V1, gpstime));
+		else
+			GST_WARNING_OBJECT(mux, "not adding FrDetector for unknown instrument '%s'", instrument);
+	}
+
+	/*
+	 * add frame-level FrHistory objects
+	 */
+
+	for(i = 0; i < mux->frame_history->n_values; i++) {
+		GstLALFrHistory *history = GSTLAL_FRHISTORY(g_value_get_boxed(g_value_array_get_nth(mux->frame_history, i)));
+		gchar *str = gstlal_frhistory_to_string(history);
+		GST_LOG_OBJECT(mux, "FrHistory: %s", str);
+		g_free(str);
+		frame->RefHistory().append(FrameCPP::FrHistory(gstlal_frhistory_get_name(history), gstlal_frhistory_get_timestamp(history) / GST_SECOND, gstlal_frhistory_get_comment(history)));
+	}
+
+	/*
+	 * loop over pads
+	 */
+
+	for(collectdatalist = mux->collect->pad_list; collectdatalist; collectdatalist = g_slist_next(collectdatalist)) {
+		FrameCPP::Common::Container<FrameCPP::FrVect> *container;
+		FrameCPPMuxCollectPadsData *data = (FrameCPPMuxCollectPadsData *) collectdatalist->data;
+		framecpp_channelmux_appdata *appdata = get_appdata(data);
+		GstFrPad *frpad = GST_FRPAD(data->pad);
+		gdouble timeOffset = 0.0;
+		/* we own this list and its contents */
+		GList *buffer_list = framecpp_muxcollectpads_take_list(data, frame_t_end);
+
+		/*
+		 * merge contiguous buffers, ignoring gap
+		 * state
+		 *
+		 * FIXME:  the difference between the first
+		 * buffer's start time and the start of the
+		 * frame could be absorbed into timeOffset
+		 * instead of going into startX of the
+		 * FrVect
+		 */
+
+		buffer_list = framecpp_muxcollectpads_buffer_list_join(buffer_list, FALSE);
+		/* FIXME:  the next two tests should be
+		 * removed.  the muxer no longer requires
+		 * the buffer list to contain exactly 1
+		 * buffer.  these checks are here
+		 * temporarily to reproduce old behaviour
+		 * that the code has been generalized to no
+		 * longer require */
+		if(!buffer_list)
+			continue;
+		g_assert_cmpuint(g_list_length(buffer_list), ==, 1);
+
+		/*
+		 * build Fr{Adc,Proc,Sim}Data, append to
+		 * frame
+		 */
+
+		g_assert_cmpuint(frame_t_start + (GstClockTime) round(timeOffset * GST_SECOND), <=, frame_t_end);
+
+		switch(frpad->pad_type) {
+		case GST_FRPAD_TYPE_FRADCDATA: {
+			FrameCPP::FrAdcData adc_data(GST_PAD_NAME(data->pad), frpad->channel_group, frpad->channel_number, frpad->nbits, appdata->rate, frpad->bias, frpad->slope, frpad->units, 0.0, timeOffset);
+			adc_data.AppendComment(frpad->comment);
+			GST_LOG_OBJECT(data->pad, "appending FrAdcData starting at %" GST_TIME_SECONDS_FORMAT, GST_TIME_SECONDS_ARGS(frame_t_start + (GstClockTime) round(timeOffset * GST_SECOND)));
+			if(!frame->GetRawData()) {
+				FrameCPP::FrameH::rawData_type rawData(new FrameCPP::FrameH::rawData_type::element_type);
+				frame->SetRawData(rawData);
+			}
+			frame->GetRawData()->RefFirstAdc().append(adc_data);
+			container = &(frame->GetRawData()->RefFirstAdc().back()->RefData());
+			break;
+		}
+
+		case GST_FRPAD_TYPE_FRPROCDATA: {
+			/* FIXME:  history */
+			FrameCPP::FrProcData proc_data(GST_PAD_NAME(data->pad), frpad->comment, 1, 0, timeOffset, (double) GST_CLOCK_DIFF(frame_t_start, frame_t_end) / GST_SECOND - timeOffset, 0.0, 0.0, appdata->rate / 2.0, 0.0);
+			GST_LOG_OBJECT(data->pad, "appending FrProcData spanning [%" GST_TIME_SECONDS_FORMAT ", %" GST_TIME_SECONDS_FORMAT ")", GST_TIME_SECONDS_ARGS(frame_t_start + (GstClockTime) round(timeOffset * GST_SECOND)), GST_TIME_SECONDS_ARGS(frame_t_end));
+			frame->RefProcData().append(proc_data);
+			container = &(frame->RefProcData().back()->RefData());
+			break;
+		}
+
+		case GST_FRPAD_TYPE_FRSIMDATA: {
+			FrameCPP::FrSimData sim_data(GST_PAD_NAME(data->pad), frpad->comment, appdata->rate, 0.0, 0.0, timeOffset);
+			GST_LOG_OBJECT(data->pad, "appending FrSimData starting at %" GST_TIME_SECONDS_FORMAT, GST_TIME_SECONDS_ARGS(frame_t_start + (GstClockTime) round(timeOffset * GST_SECOND)));
+			frame->RefSimData().append(sim_data);
+			container = &(frame->RefSimData().back()->RefData());
+			break;
+		}
+
+		default:
+			g_assert_not_reached();
+			break;
+		}
+
+		/*
+		 * build FrVects from buffers, append to
+		 * channel
+		 */
+
+		for(; buffer_list; buffer_list = g_list_delete_link(buffer_list, buffer_list)) {
+			GstBuffer *buffer = GST_BUFFER(buffer_list->data);
+			GstClockTime buffer_t_start = GST_BUFFER_TIMESTAMP(buffer);
+			GstClockTime buffer_t_end = buffer_t_start + GST_BUFFER_DURATION(buffer);
+
+			/*
+			 * safety checks.  1 ns of rounding
+			 * noise in the buffer's start and
+			 * end times is permitted because
+			 * the process of slicing the input
+			 * stream into chunks for frames
+			 * can lead to off-by-one rounding
+			 * errors since it is performed
+			 * without global state
+			 * information.
+			 */
+
+			g_assert(GST_BUFFER_TIMESTAMP_IS_VALID(buffer));
+			g_assert(GST_BUFFER_DURATION_IS_VALID(buffer));
+			g_assert_cmpuint(GST_BUFFER_OFFSET_END(buffer) - GST_BUFFER_OFFSET(buffer), ==, gst_util_uint64_scale_int_round(GST_BUFFER_DURATION(buffer), appdata->rate, GST_SECOND));
+			if(llabs(frame_t_start - buffer_t_start) <= 1)
+				buffer_t_start = frame_t_start;
+			if(llabs(frame_t_end - buffer_t_end) <= 1)
+				buffer_t_end = frame_t_end;
+			g_assert_cmpuint(frame_t_start, <=, buffer_t_start);
+			g_assert_cmpuint(buffer_t_start, <=, buffer_t_end);
+			g_assert_cmpuint(buffer_t_end, <=, frame_t_end);
+
+			/*
+			 * build FrVect, append to channel
+			 */
+
+			GST_LOG_OBJECT(data->pad, "appending FrVect [%" GST_TIME_SECONDS_FORMAT ", %" GST_TIME_SECONDS_FORMAT ")", GST_TIME_SECONDS_ARGS(buffer_t_start), GST_TIME_SECONDS_ARGS(buffer_t_end));
+			appdata->dims[0].SetNx(GST_BUFFER_OFFSET_END(buffer) - GST_BUFFER_OFFSET(buffer));
+			appdata->dims[0].SetStartX((double) GST_CLOCK_DIFF(frame_t_start, buffer_t_start) / GST_SECOND - timeOffset);
+			container->append(FrameCPP::FrVect(GST_PAD_NAME(data->pad), appdata->type, appdata->nDims, appdata->dims, FrameCPP::BYTE_ORDER_HOST, GST_BUFFER_DATA(buffer), frpad->units));
+			vects.push_back(container->back().get());
+			gst_buffer_unref(buffer);
+		}
+	}
+
+	return frame;
+}
+
+
+/*
+ * wait for a frame's FrVects to be compressed, then add it to the file.
+ * may throw.
+ */
+
+
+static void write_compressed_frame(GstFrameCPPChannelMux *mux, FrameCPP::OFrameStream &ofs, LDASTools::AL::SharedPtr<FrameCPP::FrameH> frame, struct compression_job **job)
+{
+	gchar *error = compression_job_finish(*job);
+	*job = NULL;
+	if(error) {
+		std::runtime_error Exception(error);
+		g_free(error);
+		throw Exception;
+	}
+
+	/* FrVects are already compressed, they are written as they are */
+	ofs.WriteFrame(frame, FrameCPP::Common::CheckSum::CRC);
+	mux->frame_number++;
+	g_object_notify(G_OBJECT(mux), "frame-number");
+}
+
+
 /*
  * build frame file from queue contents and push downstream
  */
@@ -255,194 +571,74 @@ static GstTagList *get_srcpad_tag_list(GstFrameCPPChannelMux *mux)
 static GstFlowReturn build_and_push_frame_file(GstFrameCPPChannelMux *mux, GstClockTime gwf_t_start, GstClockTime gwf_t_end)
 {
 	GstBuffer *outbuf = NULL;
+	/* RAW needs no compression, so there's nothing to farm out */
+	gboolean parallel = mux->compression_scheme != FrameCPP::FrVect::RAW && (compression_threads(mux) > 1 || mux->overlap_write);
+	/* declared out here so the frames outlive jobs interrupted by an
+	 * exception */
+	LDASTools::AL::SharedPtr<FrameCPP::FrameH> frame, pending_frame;
+	struct compression_job *job = NULL, *pending_job = NULL;
 	GstFlowReturn result = GST_FLOW_OK;
 
 	g_assert_cmpuint(gwf_t_start, <=, gwf_t_end);
 
 	GST_LOG_OBJECT(mux, "building frame file [%" GST_TIME_SECONDS_FORMAT ", %" GST_TIME_SECONDS_FORMAT ")", GST_TIME_SECONDS_ARGS(gwf_t_start), GST_TIME_SECONDS_ARGS(gwf_t_end));
 
+	if(parallel && !mux->compression_pool) {
+		GError *error = NULL;
+		mux->compression_pool = g_thread_pool_new(compress_vect, NULL, compression_threads(mux), FALSE, &error);
+		if(!mux->compression_pool) {
+			GST_WARNING_OBJECT(mux, "failed to start compression threads, compressing serially: %s", error->message);
+			g_error_free(error);
+			parallel = FALSE;
+		}
+	}
+
 	try {
 		FrameCPP::Common::MemoryBuffer *obuf(new FrameCPP::Common::MemoryBuffer(std::ios::out));
 		FrameCPP::OFrameStream ofs(obuf);
 		GstClockTime frame_t_start, frame_t_end;
+		guint frame_number = mux->frame_number;
 
 		/*
 		 * loop over frames
 		 */
 
 		for(frame_t_start = gwf_t_start, frame_t_end = MIN(gwf_t_start - gwf_t_start % mux->frame_duration + mux->frame_duration, gwf_t_end); frame_t_start < gwf_t_end; frame_t_start = frame_t_end, frame_t_end = MIN(frame_t_end + mux->frame_duration, gwf_t_end)) {
-			GHashTableIter it;
-			gchar *instrument;
-			guint i;
-			GSList *collectdatalist;
-			FrameCPP::GPSTime gpstime(frame_t_start / GST_SECOND, frame_t_start % GST_SECOND);
-			LDASTools::AL::SharedPtr<FrameCPP::FrameH> frame(new FrameCPP::FrameH(mux->frame_name, mux->frame_run, mux->frame_number, gpstime, gpstime.GetLeapSeconds(), (double) (frame_t_end - frame_t_start) / GST_SECOND));
+			std::vector<FrameCPP::FrVect *> vects;
 
-			GST_LOG_OBJECT(mux, "building frame %d [%" GST_TIME_SECONDS_FORMAT ", %" GST_TIME_SECONDS_FORMAT ")", mux->frame_number, GST_TIME_SECONDS_ARGS(frame_t_start), GST_TIME_SECONDS_ARGS(frame_t_end));
+			frame = build_frame(mux, frame_t_start, frame_t_end, frame_number++, vects);
 
 			/*
-			 * add FrDetector objects
-			 */
-
-			g_hash_table_iter_init(&it, mux->instruments);
-			while(g_hash_table_iter_next(&it, (void **) &instrument, NULL)) {
-				if(!strcmp(instrument, "H1"))
-					frame->RefDetectProc().append(FrameCPP::GetDetector(FrameCPP::DETECTOR_LOCATION_H1, gpstime));
-				if(!strcmp(instrument, "H2"))
-					frame->RefDetectProc().append(FrameCPP::GetDetector(FrameCPP::DETECTOR_LOCATION_H2, gpstime));
-				if(!strcmp(instrument, "L1"))
-					frame->RefDetectProc().append(FrameCPP::GetDetector(FrameCPP::DETECTOR_LOCATION_L1, gpstime));
-				if(!strcmp(instrument, "V1"))
-					frame->RefDetectProc().append(FrameCPP::GetDetector(FrameCPP::DETECTOR_LOCATION_V1, gpstime));
-				else
-					GST_WARNING_OBJECT(mux, "not adding FrDetector for unknown instrument '%s'", instrument);
-			}
-
-			/*
-			 * add frame-level FrHistory objects
+			 * add frame to file
 			 */
 
-			for(i = 0; i < mux->frame_history->n_values; i++) {
-				GstLALFrHistory *history = GSTLAL_FRHISTORY(g_value_get_boxed(g_value_array_get_nth(mux->frame_history, i)));
-				gchar *str = gstlal_frhistory_to_string(history);
-				GST_LOG_OBJECT(mux, "FrHistory: %s", str);
-				g_free(str);
-				frame->RefHistory().append(FrameCPP::FrHistory(gstlal_frhistory_get_name(history), gstlal_frhistory_get_timestamp(history) / GST_SECOND, gstlal_frhistory_get_comment(history)));
+			if(!parallel) {
+				ofs.WriteFrame(frame, (gushort) mux->compression_scheme, (gushort) mux->compression_level, FrameCPP::Common::CheckSum::CRC);
+				mux->frame_number++;
+				g_object_notify(G_OBJECT(mux), "frame-number");
+				continue;
 			}
 
-			/*
-			 * loop over pads
-			 */
-
-			for(collectdatalist = mux->collect->pad_list; collectdatalist; collectdatalist = g_slist_next(collectdatalist)) {
-				FrameCPP::Common::Container<FrameCPP::FrVect> *container;
-				FrameCPPMuxCollectPadsData *data = (FrameCPPMuxCollectPadsData *) collectdatalist->data;
-				framecpp_channelmux_appdata *appdata = get_appdata(data);
-				GstFrPad *frpad = GST_FRPAD(data->pad);
-				gdouble timeOffset = 0.0;
-				/* we own this list and its contents */
-				GList *buffer_list = framecpp_muxcollectpads_take_list(data, frame_t_end);
-
-				/*
-				 * merge contiguous buffers, ignoring gap
-				 * state
-				 *
-				 * FIXME:  the difference between the first
-				 * buffer's start time and the start of the
-				 * frame could be absorbed into timeOffset
-				 * instead of going into startX of the
-				 * FrVect
-				 */
-
-				buffer_list = framecpp_muxcollectpads_buffer_list_join(buffer_list, FALSE);
-				/* FIXME:  the next two tests should be
-				 * removed.  the muxer no longer requires
-				 * the buffer list to contain exactly 1
-				 * buffer.  these checks are here
-				 * temporarily to reproduce old behaviour
-				 * that the code has been generalized to no
-				 * longer require */
-				if(!buffer_list)
-					continue;
-				g_assert_cmpuint(g_list_length(buffer_list), ==, 1);
-
-				/*
-				 * build Fr{Adc,Proc,Sim}Data, append to
-				 * frame
-				 */
-
-				g_assert_cmpuint(frame_t_start + (GstClockTime) round(timeOffset * GST_SECOND), <=, frame_t_end);
-
-				switch(frpad->pad_type) {
-				case GST_FRPAD_TYPE_FRADCDATA: {
-					FrameCPP::FrAdcData adc_data(GST_PAD_NAME(data->pad), frpad->channel_group, frpad->channel_number, frpad->nbits, appdata->rate, frpad->bias, frpad->slope, frpad->units, 0.0, timeOffset);
-					adc_data.AppendComment(frpad->comment);
-					GST_LOG_OBJECT(data->pad, "appending FrAdcData starting at %" GST_TIME_SECONDS_FORMAT, GST_TIME_SECONDS_ARGS(frame_t_start + (GstClockTime) round(timeOffset * GST_SECOND)));
-					if(!frame->GetRawData()) {
-						FrameCPP::FrameH::rawData_type rawData(new FrameCPP::FrameH::rawData_type::element_type);
-						frame->SetRawData(rawData);
-					}
-					frame->GetRawData()->RefFirstAdc().append(adc_data);
-					container = &(frame->GetRawData()->RefFirstAdc().back()->RefData());
-					break;
-				}
-
-				case GST_FRPAD_TYPE_FRPROCDATA: {
-					/* FIXME:  history */
-					FrameCPP::FrProcData proc_data(GST_PAD_NAME(data->pad), frpad->comment, 1, 0, timeOffset, (double) GST_CLOCK_DIFF(frame_t_start, frame_t_end) / GST_SECOND - timeOffset, 0.0, 0.0, appdata->rate / 2.0, 0.0);
-					GST_LOG_OBJECT(data->pad, "appending FrProcData spanning [%" GST_TIME_SECONDS_FORMAT ", %" GST_TIME_SECONDS_FORMAT ")", GST_TIME_SECONDS_ARGS(frame_t_start + (GstClockTime) round(timeOffset * GST_SECOND)), GST_TIME_SECONDS_ARGS(frame_t_end));
-					frame->RefProcData().append(proc_data);
-					container = &(frame->RefProcData().back()->RefData());
-					break;
-				}
-
-				case GST_FRPAD_TYPE_FRSIMDATA: {
-					FrameCPP::FrSimData sim_data(GST_PAD_NAME(data->pad), frpad->comment, appdata->rate, 0.0, 0.0, timeOffset);
-					GST_LOG_OBJECT(data->pad, "appending FrSimData starting at %" GST_TIME_SECONDS_FORMAT, GST_TIME_SECONDS_ARGS(frame_t_start + (GstClockTime) round(timeOffset * GST_SECOND)));
-					frame->RefSimData().append(sim_data);
-					container = &(frame->RefSimData().back()->RefData());
-					break;
-				}
-
-				default:
-					g_assert_not_reached();
-					break;
-				}
-
-				/*
-				 * build FrVects from buffers, append to
-				 * channel
-				 */
-
-				for(; buffer_list; buffer_list = g_list_delete_link(buffer_list, buffer_list)) {
-					GstBuffer *buffer = GST_BUFFER(buffer_list->data);
-					GstClockTime buffer_t_start = GST_BUFFER_TIMESTAMP(buffer);
-					GstClockTime buffer_t_end = buffer_t_start + GST_BUFFER_DURATION(buffer);
-
-					/*
-					 * safety checks.  1 ns of rounding
-					 * noise in the buffer's start and
-					 * end times is permitted because
-					 * the process of slicing the input
-					 * stream into chunks for frames
-					 * can lead to off-by-one rounding
-					 * errors since it is performed
-					 * without global state
-					 * information.
-					 */
-
-					g_assert(GST_BUFFER_TIMESTAMP_IS_VALID(buffer));
-					g_assert(GST_BUFFER_DURATION_IS_VALID(buffer));
-					g_assert_cmpuint(GST_BUFFER_OFFSET_END(buffer) - GST_BUFFER_OFFSET(buffer), ==, gst_util_uint64_scale_int_round(GST_BUFFER_DURATION(buffer), appdata->rate, GST_SECOND));
-					if(llabs(frame_t_start - buffer_t_start) <= 1)
-						buffer_t_start = frame_t_start;
-					if(llabs(frame_t_end - buffer_t_end) <= 1)
-						buffer_t_end = frame_t_end;
-					g_assert_cmpuint(frame_t_start, <=, buffer_t_start);
-					g_assert_cmpuint(buffer_t_start, <=, buffer_t_end);
-					g_assert_cmpuint(buffer_t_end, <=, frame_t_end);
-
-					/*
-					 * build FrVect, append to channel
-					 */
-
-					GST_LOG_OBJECT(data->pad, "appending FrVect [%" GST_TIME_SECONDS_FORMAT ", %" GST_TIME_SECONDS_FORMAT ")", GST_TIME_SECONDS_ARGS(buffer_t_start), GST_TIME_SECONDS_ARGS(buffer_t_end));
-					appdata->dims[0].SetNx(GST_BUFFER_OFFSET_END(buffer) - GST_BUFFER_OFFSET(buffer));
-					appdata->dims[0].SetStartX((double) GST_CLOCK_DIFF(frame_t_start, buffer_t_start) / GST_SECOND - timeOffset);
-					container->append(FrameCPP::FrVect(GST_PAD_NAME(data->pad), appdata->type, appdata->nDims, appdata->dims, FrameCPP::BYTE_ORDER_HOST, GST_BUFFER_DATA(buffer), frpad->units));
-					gst_buffer_unref(buffer);
-				}
+			job = compression_job_start(mux, vects);
+			if(!mux->overlap_write) {
+				write_compressed_frame(mux, ofs, frame, &job);
+				continue;
 			}
 
 			/*
-			 * add frame to file
+			 * write the previous frame while this one's FrVects
+			 * are being compressed
 			 */
 
-			ofs.WriteFrame(frame, (gushort) mux->compression_scheme, (gushort) mux->compression_level, FrameCPP::Common::CheckSum::CRC);
-			mux->frame_number++;
-			g_object_notify(G_OBJECT(mux), "frame-number");
+			if(pending_job)
+				write_compressed_frame(mux, ofs, pending_frame, &pending_job);
+			pending_frame = frame;
+			pending_job = job;
+			job = NULL;
 		}
 		g_assert_cmpuint(frame_t_start, ==, gwf_t_end);	/* safety check */
+		if(pending_job)
+			write_compressed_frame(mux, ofs, pending_frame, &pending_job);
 
 		/*
 		 * close frame file, extract bytes into GstBuffer
@@ -492,6 +688,11 @@ static GstFlowReturn build_and_push_frame_file(GstFrameCPPChannelMux *mux, GstCl
 	 */
 
 done:
+	/* the workers must be done with the frames before they're freed */
+	if(job)
+		g_free(compression_job_finish(job));
+	if(pending_job)
+		g_free(compression_job_finish(pending_job));
 	if(outbuf)
 		gst_buffer_unref(outbuf);
 	return result;
@@ -1054,7 +1255,9 @@ enum property {
 	ARG_FRAME_NUMBER,
 	ARG_FRAME_HISTORY,
 	ARG_COMPRESSION_SCHEME,
-	ARG_COMPRESSION_LEVEL
+	ARG_COMPRESSION_LEVEL,
+	ARG_COMPRESSION_THREADS,
+	ARG_OVERLAP_WRITE
 };
 
 
@@ -1096,6 +1299,16 @@ static void set_property(GObject *object, guint id, const GValue *value, GParamS
 		element->compression_level = g_value_get_uint(value);
 		break;
 
+	case ARG_COMPRESSION_THREADS:
+		element->compression_threads = g_value_get_uint(value);
+		if(element->compression_pool)
+			g_thread_pool_set_max_threads(element->compression_pool, compression_threads(element), NULL);
+		break;
+
+	case ARG_OVERLAP_WRITE:
+		element->overlap_write = g_value_get_boolean(value);
+		break;
+
 	default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, id, pspec);
 		break;
@@ -1120,6 +1333,14 @@ static void get_property(GObject *object, guint id, GValue *value, GParamSpec *p
 		g_value_set_uint(value, element->compression_level);
 		break;
 
+	case ARG_COMPRESSION_THREADS:
+		g_value_set_uint(value, element->compression_threads);
+		break;
+
+	case ARG_OVERLAP_WRITE:
+		g_value_set_boolean(value, element->overlap_write);
+		break;
+
 	case ARG_FRAME_DURATION:
 		g_value_set_uint(value, element->frame_duration / GST_SECOND);
 		break;
@@ -1172,6 +1393,9 @@ static void finalize(GObject * object)
 	element->instruments = NULL;
 	g_value_array_free(element->frame_history);
 	element->frame_history = NULL;
+	if(element->compression_pool)
+		g_thread_pool_free(element->compression_pool, FALSE, TRUE);
+	element->compression_pool = NULL;
 
 	G_OBJECT_CLASS(parent_class)->finalize(object);
 }
@@ -1376,6 +1600,28 @@ static void framecpp_channelmux_class_init(GstFrameCPPChannelMuxClass *klass)
 			(GParamFlags) (G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | G_PARAM_CONSTRUCT)
 		)
 	);
+	g_object_class_install_property(
+		gobject_class,
+		ARG_COMPRESSION_THREADS,
+		g_param_spec_uint(
+			"compression-threads",
+			"Compression threads",
+			"Number of threads with which to compress the channels' data.  1 compresses each frame serially as it is written, 0 uses one thread per CPU.  Output is identical for all values.",
+			0, G_MAXUINT, DEFAULT_COMPRESSION_THREADS,
+			(GParamFlags) (G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | G_PARAM_CONSTRUCT)
+		)
+	);
+	g_object_class_install_property(
+		gobject_class,
+		ARG_OVERLAP_WRITE,
+		g_param_spec_boolean(
+			"overlap-write",
+			"Overlap write",
+			"Compress the data for each frame while the previous frame is being written.",
+			DEFAULT_OVERLAP_WRITE,
+			(GParamFlags) (G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | G_PARAM_CONSTRUCT)
+		)
+	);
 }
 
 
@@ -1407,4 +1653,5 @@ static void framecpp_channelmux_init(GstFrameCPPChannelMux *mux, GstFrameCPPChan
 	mux->instruments = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
 	mux->need_tag_list = FALSE;
 	mux->frame_history = g_value_array_new(0);
+	mux->compression_pool = NULL;
 }
@@ -78,6 +78,9 @@ typedef struct {
 
 	guint compression_scheme;
 	guint compression_level;
+	guint compression_threads;
+	gboolean overlap_write;
+	GThreadPool *compression_pool;
 
 	GstClockTime frame_duration;
 	guint frames_per_file;
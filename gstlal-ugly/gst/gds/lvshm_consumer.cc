@@ -0,0 +1,308 @@
+/*
+ * Consumer interface to LIGO-Virgo shared memory partitions
+ *
+ * Copyright (C) 2026  The gstlal authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+/*
+ * ========================================================================
+ *
+ *                                  Preamble
+ *
+ * ========================================================================
+ */
+
+
+/*
+ * stuff from the C/C++ library
+ */
+
+
+#include <algorithm>
+#include <errno.h>
+#include <pthread.h>
+#include <set>
+#include <signal.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+
+/*
+ * stuff from glib
+ */
+
+
+#include <glib.h>
+
+
+/*
+ * stuff from gds
+ */
+
+
+#include <gds/lsmp_con.hh>
+
+
+/*
+ * our own stuff
+ */
+
+
+#include <lvshm_consumer.h>
+
+
+/*
+ * ========================================================================
+ *
+ *                              GDS LSMP Consumer
+ *
+ * ========================================================================
+ */
+
+
+/*
+ * LSMP_CON holds at most one buffer, and releases it without being told
+ * which one.  the blocked thread is interrupted with SIGALRM, for which
+ * the gds library installs a handler.
+ */
+
+
+class LSMPConsumer : public LVSHMConsumer {
+public:
+	LSMPConsumer(const char *name, unsigned mask) : con(new LSMP_CON(name, 0 /* nbuf */, mask)) {}
+
+	bool isConnected(void) const {
+		return con->isConnected();
+	}
+
+	const char *Error(void) const {
+		return con->Error();
+	}
+
+	void setTimeout(double wait_time) {
+		con->setTimeout(wait_time);
+	}
+
+	const char *get_buffer(int flags) {
+		return con->get_buffer(flags);
+	}
+
+	unsigned getLength(void) const {
+		return con->getLength();
+	}
+
+	unsigned long getEvtID(void) const {
+		return con->getEvtID();
+	}
+
+	void free_buffer(const char *data) {
+		con->free_buffer();
+	}
+
+	bool interrupt(pthread_t thread) {
+		return !pthread_kill(thread, SIGALRM);
+	}
+
+	unsigned max_held(void) const {
+		return 1;
+	}
+
+protected:
+	~LSMPConsumer() {
+		delete con;
+	}
+
+private:
+	LSMP_CON *con;
+};
+
+
+LVSHMConsumer *lvshm_consumer_new_lsmp(const char *name, unsigned mask)
+{
+	return new LSMPConsumer(name, mask);
+}
+
+
+/*
+ * ========================================================================
+ *
+ *                           In-Process Fake Partition
+ *
+ * ========================================================================
+ */
+
+
+class FakeConsumer : public LVSHMConsumer {
+public:
+	FakeConsumer(const char *directory, unsigned nbuf) :
+		nbuf(nbuf),
+		next(0),
+		wait_time(-1.0),
+		interrupted(false),
+		length(0),
+		evtid(0),
+		lock(g_mutex_new()),
+		wakeup(g_cond_new())
+	{
+		GError *gerror = NULL;
+		GDir *dir = g_dir_open(directory, 0, &gerror);
+		const gchar *name;
+
+		if(!dir) {
+			error = gerror->message;
+			g_error_free(gerror);
+			return;
+		}
+		while((name = g_dir_read_name(dir))) {
+			unsigned start, duration;
+			int end = -1;
+			if(name[0] != '.' && sscanf(name, "%*[^-]-%*[^-]-%u-%u.gwf%n", &start, &duration, &end) == 2 && end >= 0 && !name[end]) {
+				gchar *path = g_build_filename(directory, name, NULL);
+				files.push_back(std::make_pair((unsigned long) start, std::string(path)));
+				g_free(path);
+			}
+		}
+		g_dir_close(dir);
+		std::sort(files.begin(), files.end());
+	}
+
+	bool isConnected(void) const {
+		return error.empty();
+	}
+
+	const char *Error(void) const {
+		return error.c_str();
+	}
+
+	void setTimeout(double wait_time) {
+		g_mutex_lock(lock);
+		this->wait_time = wait_time;
+		g_mutex_unlock(lock);
+	}
+
+	const char *get_buffer(int flags) {
+		gchar *contents = NULL;
+		gsize size;
+		GError *gerror = NULL;
+		int save_errno = 0;
+
+		g_mutex_lock(lock);
+		if(held.size() >= nbuf) {
+			save_errno = EBUSY;
+			goto done;
+		}
+		if(next >= files.size() && !interrupted) {
+			/*
+			 * out of files:  behave like an idle partition
+			 */
+
+			if(wait_time < 0.)
+				g_cond_wait(wakeup, lock);
+			else {
+				GTimeVal deadline;
+				g_get_current_time(&deadline);
+				g_time_val_add(&deadline, (glong) (wait_time * G_USEC_PER_SEC));
+				g_cond_timed_wait(wakeup, lock, &deadline);
+			}
+		}
+		if(interrupted) {
+			interrupted = false;
+			save_errno = EINTR;
+			goto done;
+		}
+		if(next >= files.size()) {
+			save_errno = EAGAIN;
+			goto done;
+		}
+		if(!g_file_get_contents(files[next].second.c_str(), &contents, &size, &gerror)) {
+			error = gerror->message;
+			g_error_free(gerror);
+			save_errno = EIO;
+			goto done;
+		}
+		length = size;
+		evtid = files[next].first;
+		next++;
+		held.insert(contents);
+
+	done:
+		g_mutex_unlock(lock);
+		errno = save_errno;
+		return contents;
+	}
+
+	unsigned getLength(void) const {
+		return length;
+	}
+
+	unsigned long getEvtID(void) const {
+		return evtid;
+	}
+
+	void free_buffer(const char *data) {
+		g_mutex_lock(lock);
+		if(held.erase(data))
+			g_free((gpointer) data);
+		else
+			g_warning("fake lvshm partition:  free_buffer(%p):  buffer not held", data);
+		g_mutex_unlock(lock);
+	}
+
+	bool interrupt(pthread_t thread) {
+		g_mutex_lock(lock);
+		interrupted = true;
+		g_cond_broadcast(wakeup);
+		g_mutex_unlock(lock);
+		return true;
+	}
+
+	unsigned max_held(void) const {
+		return nbuf;
+	}
+
+protected:
+	~FakeConsumer() {
+		std::set<const char *>::iterator data;
+		if(!held.empty())
+			g_warning("fake lvshm partition:  destroyed with %u buffer(s) held", (unsigned) held.size());
+		for(data = held.begin(); data != held.end(); data++)
+			g_free((gpointer) *data);
+		g_cond_free(wakeup);
+		g_mutex_free(lock);
+	}
+
+private:
+	std::vector<std::pair<unsigned long, std::string> > files;
+	std::set<const char *> held;
+	std::string error;
+	unsigned nbuf;
+	unsigned next;
+	double wait_time;
+	bool interrupted;
+	unsigned length;
+	unsigned long evtid;
+	GMutex *lock;
+	GCond *wakeup;
+};
+
+
+LVSHMConsumer *lvshm_consumer_new_fake(const char *directory, unsigned nbuf)
+{
+	return new FakeConsumer(directory, nbuf);
+}
@@ -0,0 +1,137 @@
+/*
+ * Consumer interface to LIGO-Virgo shared memory partitions
+ *
+ * Copyright (C) 2026  The gstlal authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifndef __GDS_LVSHM_CONSUMER_H__
+#define __GDS_LVSHM_CONSUMER_H__
+
+
+/*
+ * ============================================================================
+ *
+ *                                  Preamble
+ *
+ * ============================================================================
+ */
+
+
+#include <pthread.h>
+#include <glib.h>
+
+
+/*
+ * ============================================================================
+ *
+ *                                    Type
+ *
+ * ============================================================================
+ */
+
+
+/*
+ * the subset of the GDS LSMP_CON consumer API used by gds_lvshmsrc, with
+ * buffers released by address so that more than one can be held at a
+ * time.  this header does not require the gds headers, which allows the
+ * in-process fake partition to be used on machines without a shared
+ * memory partition.
+ *
+ * consumers are reference counted so that buffers still held downstream
+ * keep the partition attached after the element has been stopped.
+ * get_buffer() and free_buffer() may be called from different threads.
+ */
+
+
+class LVSHMConsumer {
+public:
+	LVSHMConsumer() : refcount(1) {}
+
+	void ref(void) {
+		g_atomic_int_inc(&refcount);
+	}
+
+	void unref(void) {
+		if(g_atomic_int_dec_and_test(&refcount))
+			delete this;
+	}
+
+	virtual bool isConnected(void) const = 0;
+	virtual const char *Error(void) const = 0;
+	virtual void setTimeout(double wait_time) = 0;
+
+	/*
+	 * returns NULL and sets errno on failure.  getLength() and
+	 * getEvtID() describe the buffer most recently returned.
+	 */
+
+	virtual const char *get_buffer(int flags) = 0;
+	virtual unsigned getLength(void) const = 0;
+	virtual unsigned long getEvtID(void) const = 0;
+	virtual void free_buffer(const char *data) = 0;
+
+	/*
+	 * cause a get_buffer() blocked in thread to return NULL with errno
+	 * set to EINTR.  returns false on failure.
+	 */
+
+	virtual bool interrupt(pthread_t thread) = 0;
+
+	/*
+	 * the number of buffers that can be held at once
+	 */
+
+	virtual unsigned max_held(void) const = 0;
+
+protected:
+	virtual ~LVSHMConsumer() {}
+
+private:
+	gint refcount;
+};
+
+
+/*
+ * ============================================================================
+ *
+ *                                Exported API
+ *
+ * ============================================================================
+ */
+
+
+/*
+ * consumer attached to the named GDS shared memory partition.  can hold
+ * one buffer at a time.
+ */
+
+
+LVSHMConsumer *lvshm_consumer_new_lsmp(const char *name, unsigned mask);
+
+
+/*
+ * in-process stand-in for a partition, for testing.  serves the
+ * LIGO-T050017-named frame files in directory in time order, then
+ * reports timeouts.  nbuf is the number of buffers in the fake partition.
+ */
+
+
+LVSHMConsumer *lvshm_consumer_new_fake(const char *directory, unsigned nbuf);
+
+
+#endif	/* __GDS_LVSHM_CONSUMER_H__ */
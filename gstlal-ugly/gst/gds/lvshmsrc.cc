@@ -23,6 +23,23 @@
  * SECTION:lvshmsrc
  * @short_description:  LIGO-Virgo shared memory frame file source element.
  *
+ * By default each frame file is copied out of the partition into a new
+ * #GstBuffer and the partition buffer is released immediately.  When the
+ * #GDSLVSHMSrc:zero-copy property is set the #GstBuffer instead wraps the
+ * partition buffer directly, and the partition buffer is released when
+ * the #GstBuffer is freed.  At most #GDSLVSHMSrc:max-outstanding such
+ * buffers are held downstream at once;  when the limit is reached the
+ * element waits for one to be freed before retrieving the next frame
+ * file, so that downstream elements cannot starve the partition of
+ * buffers.  The GDS consumer interface can only hold one buffer at a
+ * time, so for a real partition the limit is 1 and zero-copy mode
+ * requires downstream elements to free each buffer before the next one
+ * can be retrieved;  framecpp_channeldemux does this.
+ *
+ * For testing, the #GDSLVSHMSrc:fake-partition property can be set to a
+ * directory of frame files.  These are then served in time order by an
+ * in-process stand-in for the partition instead of from shared memory.
+ *
  * Reviewed:  00d65a70accca228bb76bd07e89b3ec07c78f736 2014-08-13 K.
  * Cannon, J.  Creighton, B. Sathyaprakash.
  *
@@ -76,6 +93,7 @@
 
 
 #include <gstlal/gstlal_debug.h>
+#include <lvshm_consumer.h>
 #include <lvshmsrc.h>
 
 
@@ -214,6 +232,10 @@ GST_BOILERPLATE_FULL(GDSLVSHMSrc, gds_lvshmsrc, GstBaseSrc, GST_TYPE_BASE_SRC, a
 #define DEFAULT_MASK -1
 #define DEFAULT_WAIT_TIME -1.0	/* wait indefinitely */
 #define DEFAULT_ASSUMED_DURATION 4
+#define DEFAULT_ZERO_COPY FALSE
+#define DEFAULT_MAX_OUTSTANDING 1
+#define DEFAULT_FAKE_PARTITION NULL
+#define FAKE_PARTITION_NBUF 4
 
 
 /*
@@ -225,7 +247,7 @@ GST_BOILERPLATE_FULL(GDSLVSHMSrc, gds_lvshmsrc, GstBaseSrc, GST_TYPE_BASE_SRC, a
  */
 
 
-#define lsmp_partition(element) ((LSMP_CON *) ((element)->partition))
+#define lsmp_partition(element) ((LVSHMConsumer *) ((element)->partition))
 
 
 static GstClockTime GPSNow(void)
@@ -235,6 +257,59 @@ static GstClockTime GPSNow(void)
 }
 
 
+/*
+ * zero-copy buffers.  the GstBuffer's mallocdata points to one of these,
+ * and its free function returns the data to the partition.  references
+ * are held to the element and the partition so both outlive the buffer.
+ */
+
+
+struct zero_copy_data {
+	GDSLVSHMSrc *element;
+	LVSHMConsumer *partition;
+	const char *data;
+};
+
+
+static void zero_copy_free(struct zero_copy_data *zc)
+{
+	GDSLVSHMSrc *element = zc->element;
+
+	zc->partition->free_buffer(zc->data);
+	zc->partition->unref();
+	GST_LOG_OBJECT(element, "released shared-memory buffer %p", zc->data);
+
+	g_mutex_lock(element->outstanding_lock);
+	element->outstanding--;
+	g_cond_broadcast(element->outstanding_released);
+	g_mutex_unlock(element->outstanding_lock);
+
+	gst_object_unref(element);
+	g_free(zc);
+}
+
+
+/*
+ * wait until fewer than the allowed number of zero-copy buffers are held
+ * downstream.  returns FALSE if unlock() was called while waiting.
+ */
+
+
+static gboolean wait_for_outstanding(GDSLVSHMSrc *element)
+{
+	guint max_outstanding = MIN(element->max_outstanding, lsmp_partition(element)->max_held());
+
+	g_mutex_lock(element->outstanding_lock);
+	if(element->outstanding >= max_outstanding)
+		GST_DEBUG_OBJECT(element, "%u shared-memory buffer(s) held downstream, waiting for one to be released", element->outstanding);
+	while(element->outstanding >= max_outstanding && !element->unblocked)
+		g_cond_wait(element->outstanding_released, element->outstanding_lock);
+	g_mutex_unlock(element->outstanding_lock);
+
+	return !element->unblocked;
+}
+
+
 /*
  * ============================================================================
  *
@@ -252,28 +327,33 @@ static GstClockTime GPSNow(void)
 static gboolean start(GstBaseSrc *object)
 {
 	GDSLVSHMSrc *element = GDS_LVSHMSRC(object);
+	const char *name = element->fake_partition ? element->fake_partition : element->name;
 	gboolean success = TRUE;
 
-	if(!element->name) {
-		GST_ELEMENT_ERROR(element, RESOURCE, READ, (NULL), ("shm-name not set"));
-		success = FALSE;
-		goto done;
+	if(element->fake_partition)
+		element->partition = lvshm_consumer_new_fake(element->fake_partition, FAKE_PARTITION_NBUF);
+	else {
+		if(!element->name) {
+			GST_ELEMENT_ERROR(element, RESOURCE, READ, (NULL), ("shm-name not set"));
+			success = FALSE;
+			goto done;
+		}
+		repair_lsmp(element); // repair the lvshm first as suggested by Patrick Brockill
+		element->partition = lvshm_consumer_new_lsmp(element->name, element->mask);
 	}
-	repair_lsmp(element); // repair the lvshm first as suggested by Patrick Brockill
-	element->partition = new LSMP_CON(element->name, 0 /* nbuf */, element->mask);
 	if(!element->partition) {
-		GST_ELEMENT_ERROR(element, RESOURCE, READ, (NULL), ("unknown failure accessing shared-memory parition \"%s\"", element->name));
+		GST_ELEMENT_ERROR(element, RESOURCE, READ, (NULL), ("unknown failure accessing shared-memory parition \"%s\"", name));
 		success = FALSE;
 		goto done;
 	}
 	if(!lsmp_partition(element)->isConnected()) {
-		GST_ELEMENT_ERROR(element, RESOURCE, OPEN_READ, (NULL), ("failure connecting to shared-memory partition \"%s\": %s", element->name, lsmp_partition(element)->Error()));
-		delete lsmp_partition(element);
+		GST_ELEMENT_ERROR(element, RESOURCE, OPEN_READ, (NULL), ("failure connecting to shared-memory partition \"%s\": %s", name, lsmp_partition(element)->Error()));
+		lsmp_partition(element)->unref();
 		element->partition = NULL;
 		success = FALSE;
 		goto done;
 	}
-	GST_DEBUG_OBJECT(element, "connected to shared-memory partition \"%s\"", element->name);
+	GST_DEBUG_OBJECT(element, "connected to %sshared-memory partition \"%s\"", element->fake_partition ? "fake " : "", name);
 
 	lsmp_partition(element)->setTimeout(element->wait_time);
 
@@ -294,9 +374,18 @@ static gboolean stop(GstBaseSrc *object)
 {
 	GDSLVSHMSrc *element = GDS_LVSHMSRC(object);
 
-	delete lsmp_partition(element);
+	/*
+	 * zero-copy buffers still held downstream keep the partition
+	 * attached until they are freed
+	 */
+
+	g_mutex_lock(element->outstanding_lock);
+	if(element->outstanding)
+		GST_DEBUG_OBJECT(element, "%u shared-memory buffer(s) still held downstream", element->outstanding);
+	g_mutex_unlock(element->outstanding_lock);
+	lsmp_partition(element)->unref();
 	element->partition = NULL;
-	GST_DEBUG_OBJECT(element, "de-accessed shared-memory partition \"%s\"", element->name);
+	GST_DEBUG_OBJECT(element, "de-accessed shared-memory partition \"%s\"", element->fake_partition ? element->fake_partition : element->name);
 
 	element->max_latency = element->min_latency = GST_CLOCK_TIME_NONE;
 
@@ -317,10 +406,14 @@ static gboolean unlock(GstBaseSrc *basesrc)
 	element->unblocked = TRUE;
 
 	if(!g_mutex_trylock(element->create_thread_lock))
-		success = !pthread_kill(element->create_thread, SIGALRM);
+		success = lsmp_partition(element)->interrupt(element->create_thread);
 	else
 		g_mutex_unlock(element->create_thread_lock);
 
+	g_mutex_lock(element->outstanding_lock);
+	g_cond_broadcast(element->outstanding_released);
+	g_mutex_unlock(element->outstanding_lock);
+
 	return success;
 }
 
@@ -367,7 +460,7 @@ static GstFlowReturn create(GstBaseSrc *basesrc, guint64 offset, guint size, Gst
 	 * element is "unlocked".
 	 */
 
-	if(element->unblocked) {
+	if(element->unblocked || !wait_for_outstanding(element)) {
 		GST_DEBUG_OBJECT(element, "unlock() called, no buffer created");
 		return GST_FLOW_UNEXPECTED;
 	}
@@ -489,7 +582,8 @@ static GstFlowReturn create(GstBaseSrc *basesrc, guint64 offset, guint size, Gst
 		/*
 		 * we have successfully retrieved data.  NOTE:  all code
 		 * paths from this point *must* include a call to
-		 * lsmp_partition(element)->free_buffer()
+		 * lsmp_partition(element)->free_buffer() or hand the
+		 * buffer to a zero-copy GstBuffer
 		 */
 
 		length = lsmp_partition(element)->getLength();
@@ -498,31 +592,60 @@ static GstFlowReturn create(GstBaseSrc *basesrc, guint64 offset, guint size, Gst
 		if(timestamp >= element->next_timestamp)
 			break;
 		GST_LOG_OBJECT(element, "time reversal.  skipping buffer.");
-		lsmp_partition(element)->free_buffer();
+		lsmp_partition(element)->free_buffer(data);
 	}
 
-	/*
-	 * copy into a GstBuffer
-	 */
-
 	if(!length) {
 		GST_ELEMENT_ERROR(element, RESOURCE, READ, (NULL), ("received 0-byte shared-memory buffer"));
 		result = GST_FLOW_UNEXPECTED;
 		goto done;
 	}
-	result = gst_pad_alloc_buffer(GST_BASE_SRC_PAD(basesrc), offset, length, GST_PAD_CAPS(GST_BASE_SRC_PAD(basesrc)), buffer);
-	if(result != GST_FLOW_OK) {
-		GST_ELEMENT_ERROR(element, RESOURCE, READ, (NULL), ("gst_pad_alloc_buffer() returned %d (%s)", result, gst_flow_get_name(result)));
-		goto done;
-	}
-	if(GST_BUFFER_SIZE(*buffer) != length) {
-		GST_ELEMENT_ERROR(element, RESOURCE, READ, (NULL), ("gst_pad_alloc_buffer(): requested buffer size %u, got buffer size %u", length, GST_BUFFER_SIZE(*buffer)));
-		gst_buffer_unref(*buffer);
-		*buffer = NULL;
-		result = GST_FLOW_ERROR;
-		goto done;
+
+	if(element->zero_copy) {
+		/*
+		 * wrap the shared-memory buffer in a GstBuffer.  the
+		 * buffer is released when the GstBuffer is freed.
+		 */
+
+		struct zero_copy_data *zc = g_new(struct zero_copy_data, 1);
+		zc->element = GDS_LVSHMSRC(gst_object_ref(element));
+		zc->partition = lsmp_partition(element);
+		zc->partition->ref();
+		zc->data = data;
+
+		*buffer = gst_buffer_new();
+		GST_BUFFER_FLAG_SET(*buffer, GST_BUFFER_FLAG_READONLY);
+		GST_BUFFER_DATA(*buffer) = (guint8 *) data;
+		GST_BUFFER_SIZE(*buffer) = length;
+		GST_BUFFER_MALLOCDATA(*buffer) = (guint8 *) zc;
+		GST_BUFFER_FREE_FUNC(*buffer) = (GFreeFunc) zero_copy_free;
+		gst_buffer_set_caps(*buffer, GST_PAD_CAPS(GST_BASE_SRC_PAD(basesrc)));
+
+		g_mutex_lock(element->outstanding_lock);
+		element->outstanding++;
+		g_mutex_unlock(element->outstanding_lock);
+
+		/* the GstBuffer owns it now */
+		data = NULL;
+	} else {
+		/*
+		 * copy into a GstBuffer
+		 */
+
+		result = gst_pad_alloc_buffer(GST_BASE_SRC_PAD(basesrc), offset, length, GST_PAD_CAPS(GST_BASE_SRC_PAD(basesrc)), buffer);
+		if(result != GST_FLOW_OK) {
+			GST_ELEMENT_ERROR(element, RESOURCE, READ, (NULL), ("gst_pad_alloc_buffer() returned %d (%s)", result, gst_flow_get_name(result)));
+			goto done;
+		}
+		if(GST_BUFFER_SIZE(*buffer) != length) {
+			GST_ELEMENT_ERROR(element, RESOURCE, READ, (NULL), ("gst_pad_alloc_buffer(): requested buffer size %u, got buffer size %u", length, GST_BUFFER_SIZE(*buffer)));
+			gst_buffer_unref(*buffer);
+			*buffer = NULL;
+			result = GST_FLOW_ERROR;
+			goto done;
+		}
+		memcpy(GST_BUFFER_DATA(*buffer), data, length);
 	}
-	memcpy(GST_BUFFER_DATA(*buffer), data, length);
 	GST_BUFFER_TIMESTAMP(*buffer) = timestamp;
 	GST_BUFFER_DURATION(*buffer) = element->assumed_duration * GST_SECOND;	/* FIXME:  we need to know this! */
 	GST_BUFFER_OFFSET(*buffer) = offset;
@@ -546,8 +669,10 @@ static GstFlowReturn create(GstBaseSrc *basesrc, guint64 offset, guint size, Gst
 	 */
 
 done:
-	lsmp_partition(element)->free_buffer();
-	GST_LOG_OBJECT(element, "released shared-memory buffer %p", data);
+	if(data) {
+		lsmp_partition(element)->free_buffer(data);
+		GST_LOG_OBJECT(element, "released shared-memory buffer %p", data);
+	}
 	return result;
 }
 
@@ -614,7 +739,10 @@ enum property {
 	ARG_SHM_NAME = 1,
 	ARG_MASK,
 	ARG_WAIT_TIME,
-	ARG_ASSUMED_DURATION
+	ARG_ASSUMED_DURATION,
+	ARG_ZERO_COPY,
+	ARG_MAX_OUTSTANDING,
+	ARG_FAKE_PARTITION
 };
 
 
@@ -644,6 +772,19 @@ static void set_property(GObject *object, guint id, const GValue *value, GParamS
 		element->assumed_duration = g_value_get_uint(value);
 		break;
 
+	case ARG_ZERO_COPY:
+		element->zero_copy = g_value_get_boolean(value);
+		break;
+
+	case ARG_MAX_OUTSTANDING:
+		element->max_outstanding = g_value_get_uint(value);
+		break;
+
+	case ARG_FAKE_PARTITION:
+		g_free(element->fake_partition);
+		element->fake_partition = g_value_dup_string(value);
+		break;
+
 	default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, id, pspec);
 		break;
@@ -676,6 +817,18 @@ static void get_property(GObject *object, guint id, GValue *value, GParamSpec *p
 		g_value_set_uint(value, element->assumed_duration);
 		break;
 
+	case ARG_ZERO_COPY:
+		g_value_set_boolean(value, element->zero_copy);
+		break;
+
+	case ARG_MAX_OUTSTANDING:
+		g_value_set_uint(value, element->max_outstanding);
+		break;
+
+	case ARG_FAKE_PARTITION:
+		g_value_set_string(value, element->fake_partition);
+		break;
+
 	default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, id, pspec);
 		break;
@@ -696,11 +849,17 @@ static void finalize(GObject *object)
 
 	g_free(element->name);
 	element->name = NULL;
+	g_free(element->fake_partition);
+	element->fake_partition = NULL;
 	g_mutex_free(element->create_thread_lock);
 	element->create_thread_lock = NULL;
+	g_mutex_free(element->outstanding_lock);
+	element->outstanding_lock = NULL;
+	g_cond_free(element->outstanding_released);
+	element->outstanding_released = NULL;
 	if(element->partition) {
 		GST_WARNING_OBJECT(element, "parent class failed to invoke stop() method.  doing shared-memory de-access in finalize() instead.");
-		delete lsmp_partition(element);
+		lsmp_partition(element)->unref();
 		element->partition = NULL;
 	}
 
@@ -805,6 +964,39 @@ static void gds_lvshmsrc_class_init(GDSLVSHMSrcClass *klass)
 			(GParamFlags) (G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | G_PARAM_CONSTRUCT)
 		)
 	);
+	g_object_class_install_property(
+		gobject_class,
+		ARG_ZERO_COPY,
+		g_param_spec_boolean(
+			"zero-copy",
+			"Zero copy",
+			"Wrap shared-memory buffers in the output buffers instead of copying them.  Each shared-memory buffer is released when its output buffer is freed.",
+			DEFAULT_ZERO_COPY,
+			(GParamFlags) (G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | G_PARAM_CONSTRUCT)
+		)
+	);
+	g_object_class_install_property(
+		gobject_class,
+		ARG_MAX_OUTSTANDING,
+		g_param_spec_uint(
+			"max-outstanding",
+			"Maximum outstanding buffers",
+			"In zero-copy mode, the most shared-memory buffers that can be held downstream at once.  Retrieving the next buffer waits until one is freed.  Limited to what the partition supports (1 for GDS partitions).",
+			1, G_MAXUINT, DEFAULT_MAX_OUTSTANDING,
+			(GParamFlags) (G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | G_PARAM_CONSTRUCT)
+		)
+	);
+	g_object_class_install_property(
+		gobject_class,
+		ARG_FAKE_PARTITION,
+		g_param_spec_string(
+			"fake-partition",
+			"Fake partition",
+			"For testing.  If set, frame files in this directory are served in time order by an in-process stand-in for the shared-memory partition, and shm-name and mask are ignored.",
+			DEFAULT_FAKE_PARTITION,
+			(GParamFlags) (G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | G_PARAM_CONSTRUCT)
+		)
+	);
 }
 
 
@@ -825,9 +1017,13 @@ static void gds_lvshmsrc_init(GDSLVSHMSrc *element, GDSLVSHMSrcClass *klass)
 	 */
 
 	element->name = NULL;
+	element->fake_partition = NULL;
 	element->max_latency = element->min_latency = GST_CLOCK_TIME_NONE;
 	element->unblocked = FALSE;
 	element->create_thread_lock = g_mutex_new();
+	element->outstanding_lock = g_mutex_new();
+	element->outstanding_released = g_cond_new();
+	element->outstanding = 0;
 	element->partition = NULL;
 }
  
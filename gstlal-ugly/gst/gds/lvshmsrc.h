@@ -70,6 +70,9 @@ typedef struct {
 	lvshm_mask mask;
 	double wait_time;
 	guint assumed_duration;
+	gboolean zero_copy;
+	guint max_outstanding;
+	char *fake_partition;
 
 	/*
 	 * latency
@@ -88,14 +91,20 @@ typedef struct {
 	gboolean need_new_segment;
 	GstClockTime next_timestamp;
 
+	/*
+	 * zero-copy buffers held downstream
+	 */
+
+	GMutex *outstanding_lock;
+	GCond *outstanding_released;
+	guint outstanding;
+
 	/*< private >*/
 
 	/*
-	 * LSMP_CON consumer interface.  this is declared void * here and
-	 * type casts are used in the module proper so that other code that
-	 * uses this header can be compiled without loading the lsmp
-	 * headers from gds.  the lsmp headers require C++, and there is no
-	 * pkg-config file available for them.
+	 * LVSHMConsumer interface to the partition.  this is declared
+	 * void * here and type casts are used in the module proper so that
+	 * other code that uses this header can be compiled as C.
 	 */
 
 	void *partition;
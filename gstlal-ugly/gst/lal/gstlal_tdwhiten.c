@@ -295,7 +295,7 @@ static unsigned tddfilter(GSTLALTDwhiten *element, GstBuffer *outbuf, unsigned o
 	double gain0;
 	double gain1;
 	unsigned poped_kernels;
-	double *input;
+	const double *input;
 	double *output = (double *)GST_BUFFER_DATA(outbuf);
 
 	/*
@@ -314,8 +314,7 @@ static unsigned tddfilter(GSTLALTDwhiten *element, GstBuffer *outbuf, unsigned o
 	 * retrieve input samples from the adapter
 	 */
 
-	input = g_malloc(input_length * sizeof(*input));
-	gst_audioadapter_copy_samples(element->adapter, input, input_length, NULL, NULL);
+	input = gst_audioadapter_peek_samples(element->adapter, input_length, NULL, NULL);
 
 	/*
 	 * zero the output
@@ -360,7 +359,6 @@ static unsigned tddfilter(GSTLALTDwhiten *element, GstBuffer *outbuf, unsigned o
 
 	while(poped_kernels--)
 		kernelinfo_free(g_queue_pop_head(element->kernels));
-	g_free(input);
 
 	return output_length;
 }
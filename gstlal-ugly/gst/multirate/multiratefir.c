@@ -0,0 +1,225 @@
+/*
+ * GStreamer
+ * Copyright (C) 2011 Leo Singer <leo.singer@ligo.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/*
+ * Filter evaluation shared by multiratefirdecim and multiratefirinterp.
+ *
+ * Input and output are interleaved, channels samples per frame.  The
+ * decimator reads the kernel time reversed, so output frame n is the inner
+ * product of input frames n * factor ... n * factor + ntaps - 1 with the
+ * taps.  The interpolator reads a phase table of factor polyphase
+ * components of taps_per_phase taps each, so output frame n * factor + q is
+ * the inner product of input frames n ... n + taps_per_phase - 1 with
+ * component q.
+ *
+ * The polyphase loops are written so the compiler vectorizes them:  a
+ * single channel is a contiguous inner product reduced over the taps, more
+ * than one channel accumulates one tap into every channel of a frame at a
+ * time.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include "multiratefir.h"
+
+GType
+gst_multirate_fir_algorithm_get_type (void)
+{
+  static GType algorithm_type = 0;
+  static const GEnumValue algorithms[] = {
+    {GST_MULTIRATE_FIR_ALGORITHM_DIRECT, "Per-sample direct form loop",
+        "direct"},
+    {GST_MULTIRATE_FIR_ALGORITHM_POLYPHASE,
+        "Vectorized polyphase phase tables", "polyphase"},
+    {0, NULL, NULL},
+  };
+
+  if (G_UNLIKELY (algorithm_type == 0))
+    algorithm_type = g_enum_register_static ("GstMultirateFirAlgorithm",
+        algorithms);
+  return algorithm_type;
+}
+
+/* Time reversed copy of the kernel, the decimator's taps. */
+double *
+gst_multirate_fir_reverse_kernel (const double *kernel, guint length)
+{
+  double *taps = g_new (double, length);
+  guint i;
+
+  for (i = 0; i < length; i++)
+    taps[i] = kernel[length - 1 - i];
+  return taps;
+}
+
+/* Group the time reversed kernel into factor polyphase components, last
+ * phase first, zero padding the kernel to a multiple of factor. */
+double *
+gst_multirate_fir_phase_table (const double *kernel, guint length,
+    guint factor, guint * taps_per_phase)
+{
+  guint ntaps = (length + factor - 1) / factor;
+  double *table = g_new0 (double, ntaps * factor);
+  guint q, i, j;
+
+  for (q = 0; q < factor; q++)
+    for (i = 0; i < ntaps; i++) {
+      j = factor - 1 - q + i * factor;
+      if (G_LIKELY (j < length))
+        table[q * ntaps + i] = kernel[length - 1 - j];
+    }
+  *taps_per_phase = ntaps;
+  return table;
+}
+
+static void
+decimate_direct (double *out, const double *in, const double *taps,
+    guint ntaps, guint channels, guint factor, guint outsamples)
+{
+  guint n, i, channel;
+
+  memset (out, 0, outsamples * channels * sizeof (double));
+  for (n = 0; n < outsamples; n++, out += channels) {
+    for (i = 0; i < ntaps; i++)
+      for (channel = 0; channel < channels; channel++)
+        out[channel] += in[i * channels + channel] * taps[i];
+    in += factor * channels;
+  }
+}
+
+static void
+decimate_polyphase (double *restrict out, const double *restrict in,
+    const double *restrict taps, guint ntaps, guint channels, guint factor,
+    guint outsamples)
+{
+  guint n, i, channel;
+
+  if (channels == 1) {
+    for (n = 0; n < outsamples; n++) {
+      const double *x = in + n * factor;
+      double y = 0.0;
+#pragma omp simd reduction(+:y)
+      for (i = 0; i < ntaps; i++)
+        y += x[i] * taps[i];
+      out[n] = y;
+    }
+    return;
+  }
+
+  for (n = 0; n < outsamples; n++) {
+    double *y = out + n * channels;
+    const double *x = in + n * factor * channels;
+    memset (y, 0, channels * sizeof (double));
+    for (i = 0; i < ntaps; i++, x += channels) {
+      const double h = taps[i];
+#pragma omp simd
+      for (channel = 0; channel < channels; channel++)
+        y[channel] += x[channel] * h;
+    }
+  }
+}
+
+void
+gst_multirate_fir_decimate (GstMultirateFirAlgorithm algorithm, double *out,
+    const double *in, const double *taps, guint ntaps, guint channels,
+    guint factor, guint outsamples)
+{
+  if (algorithm == GST_MULTIRATE_FIR_ALGORITHM_DIRECT)
+    decimate_direct (out, in, taps, ntaps, channels, factor, outsamples);
+  else
+    decimate_polyphase (out, in, taps, ntaps, channels, factor, outsamples);
+}
+
+static void
+interpolate_direct (double *out, const double *in, const double *table,
+    guint taps_per_phase, guint channels, guint factor, guint insamples)
+{
+  const double *kernel_ptr = table;
+  const double *kernelend = table + taps_per_phase * factor;
+  double *outend = out + insamples * factor * channels;
+  guint i, channel;
+
+  memset (out, 0, insamples * factor * channels * sizeof (double));
+  for (; out < outend; out += channels) {
+    for (i = 0; i < taps_per_phase; i++) {
+      for (channel = 0; channel < channels; channel++)
+        out[channel] += in[i * channels + channel] * (*kernel_ptr);
+      if (G_UNLIKELY (++kernel_ptr >= kernelend)) {
+        kernel_ptr = table;
+        in += channels;
+      }
+    }
+  }
+}
+
+static void
+interpolate_polyphase (double *restrict out, const double *restrict in,
+    const double *restrict table, guint taps_per_phase, guint channels,
+    guint factor, guint insamples)
+{
+  guint n, q, i, channel;
+
+  if (channels == 1) {
+    for (n = 0; n < insamples; n++) {
+      const double *x = in + n;
+      for (q = 0; q < factor; q++) {
+        const double *h = table + q * taps_per_phase;
+        double y = 0.0;
+#pragma omp simd reduction(+:y)
+        for (i = 0; i < taps_per_phase; i++)
+          y += x[i] * h[i];
+        out[n * factor + q] = y;
+      }
+    }
+    return;
+  }
+
+  for (n = 0; n < insamples; n++) {
+    for (q = 0; q < factor; q++) {
+      double *y = out + (n * factor + q) * channels;
+      const double *h = table + q * taps_per_phase;
+      const double *x = in + n * channels;
+      memset (y, 0, channels * sizeof (double));
+      for (i = 0; i < taps_per_phase; i++, x += channels) {
+        const double hi = h[i];
+#pragma omp simd
+        for (channel = 0; channel < channels; channel++)
+          y[channel] += x[channel] * hi;
+      }
+    }
+  }
+}
+
+void
+gst_multirate_fir_interpolate (GstMultirateFirAlgorithm algorithm,
+    double *out, const double *in, const double *table, guint taps_per_phase,
+    guint channels, guint factor, guint insamples)
+{
+  if (algorithm == GST_MULTIRATE_FIR_ALGORITHM_DIRECT)
+    interpolate_direct (out, in, table, taps_per_phase, channels, factor,
+        insamples);
+  else
+    interpolate_polyphase (out, in, table, taps_per_phase, channels, factor,
+        insamples);
+}
@@ -0,0 +1,60 @@
+/*
+ * GStreamer
+ * Copyright (C) 2011 Leo Singer <leo.singer@ligo.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __GST_MULTIRATE_FIR_H__
+#define __GST_MULTIRATE_FIR_H__
+
+#include <glib.h>
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+/**
+ * GstMultirateFirAlgorithm:
+ * @GST_MULTIRATE_FIR_ALGORITHM_DIRECT: evaluate each output sample with
+ * the reference per-sample, per-channel loop
+ * @GST_MULTIRATE_FIR_ALGORITHM_POLYPHASE: evaluate the polyphase
+ * components from precomputed phase tables with vectorized inner products
+ *
+ * How the multirate FIR elements evaluate their filter.  Both produce the
+ * same output up to floating point rounding.
+ */
+typedef enum
+{
+  GST_MULTIRATE_FIR_ALGORITHM_DIRECT,
+  GST_MULTIRATE_FIR_ALGORITHM_POLYPHASE
+} GstMultirateFirAlgorithm;
+
+#define GST_TYPE_MULTIRATE_FIR_ALGORITHM (gst_multirate_fir_algorithm_get_type())
+GType gst_multirate_fir_algorithm_get_type (void);
+
+double *gst_multirate_fir_reverse_kernel (const double *kernel, guint length);
+double *gst_multirate_fir_phase_table (const double *kernel, guint length,
+    guint factor, guint * taps_per_phase);
+
+void gst_multirate_fir_decimate (GstMultirateFirAlgorithm algorithm,
+    double *out, const double *in, const double *taps, guint ntaps,
+    guint channels, guint factor, guint outsamples);
+void gst_multirate_fir_interpolate (GstMultirateFirAlgorithm algorithm,
+    double *out, const double *in, const double *table, guint taps_per_phase,
+    guint channels, guint factor, guint insamples);
+
+G_END_DECLS
+#endif /* __GST_MULTIRATE_FIR_H__ */
@@ -24,7 +24,9 @@
  * SECTION:element-multiratefirdecim
  *
  * Apply an FIR decimation filter to a stream using a direct form polyphase
- * implementation.
+ * implementation.  The algorithm property selects between the reference
+ * per-sample loop and vectorized inner products over the time reversed
+ * kernel.
  */
 
 #ifdef HAVE_CONFIG_H
@@ -51,7 +53,8 @@ enum
 {
   PROP_0,
   PROP_KERNEL,
-  PROP_LAG
+  PROP_LAG,
+  PROP_ALGORITHM
 };
 
 static GstStaticPadTemplate gst_multirate_fir_decim_sink_template =
@@ -146,6 +149,13 @@ gst_multirate_fir_decim_class_init (GstMultirateFirDecimClass * klass)
           G_PARAM_WRITABLE | GST_PARAM_MUTABLE_READY |
           G_PARAM_STATIC_STRINGS));
 
+  g_object_class_install_property (gobject_class, PROP_ALGORITHM,
+      g_param_spec_enum ("algorithm", "Algorithm",
+          "How to evaluate the filter", GST_TYPE_MULTIRATE_FIR_ALGORITHM,
+          GST_MULTIRATE_FIR_ALGORITHM_POLYPHASE,
+          G_PARAM_READWRITE | GST_PARAM_MUTABLE_READY |
+          G_PARAM_STATIC_STRINGS));
+
   GST_BASE_TRANSFORM_CLASS (klass)->set_caps =
       GST_DEBUG_FUNCPTR (gst_multirate_fir_decim_set_caps);
   GST_BASE_TRANSFORM_CLASS (klass)->transform_caps =
@@ -164,6 +174,7 @@ static void
 gst_multirate_fir_decim_init (GstMultirateFirDecim * filter, GstMultirateFirDecimClass * klass)
 {
   filter->adapter = gst_adapter_new ();
+  filter->algorithm = GST_MULTIRATE_FIR_ALGORITHM_POLYPHASE;
 }
 
 static void gst_multirate_fir_decim_finalize (GObject * object)
@@ -172,6 +183,8 @@ static void gst_multirate_fir_decim_finalize (GObject * object)
 
   g_free (self->kernel);
   self->kernel = NULL;
+  g_free (self->taps);
+  self->taps = NULL;
   if (self->adapter) {
     g_object_unref (self->adapter);
     self->adapter = NULL;
@@ -198,11 +211,17 @@ gst_multirate_fir_decim_set_property (GObject * object, guint prop_id,
         filter->kernel = g_new (double, filter->kernel_length);
         for (i = 0; i < filter->kernel_length; i ++)
           filter->kernel[i] = g_value_get_double (g_value_array_get_nth (va, i));
+        g_free (filter->taps);
+        filter->taps = gst_multirate_fir_reverse_kernel (filter->kernel,
+            filter->kernel_length);
       }
       break;
     case PROP_LAG:
       filter->lag = g_value_get_uint64 (value);
       break;
+    case PROP_ALGORITHM:
+      filter->algorithm = g_value_get_enum (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -221,6 +240,9 @@ gst_multirate_fir_decim_get_property (GObject * object, guint prop_id,
 
   switch (prop_id) {
     /* FIXME: make properties readwritable and add getters*/
+    case PROP_ALGORITHM:
+      g_value_set_enum (value, filter->algorithm);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -307,10 +329,8 @@ gst_multirate_fir_decim_push_residue (GstMultirateFirDecim * filter)
 {
   GstBaseTransform *base = GST_BASE_TRANSFORM (filter);
   GstBuffer *inbuf, *outbuf;
-  double *indata, *outdata, *outend;
-  guint i;
+  double *indata;
   guint insize, availsize, insamples;
-  gint channel;
   guint minsize = filter->kernel_length * filter->channels * sizeof(double);
 
   /* Put inbuf into adapter. We have to ref inbuf because gst_adapter_push takes
@@ -332,19 +352,12 @@ gst_multirate_fir_decim_push_residue (GstMultirateFirDecim * filter)
   gst_buffer_set_caps (outbuf, GST_PAD_CAPS (GST_BASE_TRANSFORM_SRC_PAD (base)));
   insize = GST_BUFFER_SIZE (outbuf) * filter->downsample_factor;
   indata = (double *) gst_adapter_peek (filter->adapter, availsize);
-  outdata = (double *) GST_BUFFER_DATA (outbuf);
-  outend = (double *) ((guint8 *) outdata + GST_BUFFER_SIZE (outbuf));
-  memset (outdata, 0, GST_BUFFER_SIZE (outbuf));
 
   /* Evaluate filter. */
-  for (; outdata < outend; outdata += filter->channels) {
-    for (i = 0; i < filter->kernel_length; i ++) {
-      for (channel = 0; channel < filter->channels; channel++) {
-        *(outdata + channel) += *(indata + i * filter->channels + channel) * filter->kernel[filter->kernel_length - 1 - i];
-      }
-    }
-    indata += filter->downsample_factor * filter->channels;
-  }
+  gst_multirate_fir_decimate (filter->algorithm,
+      (double *) GST_BUFFER_DATA (outbuf), indata, filter->taps,
+      filter->kernel_length, filter->channels, filter->downsample_factor,
+      GST_BUFFER_SIZE (outbuf) / (sizeof(double) * filter->channels));
 
   /* Throw away the contents of the adapter that we have consumed. */
   gst_adapter_flush (filter->adapter, insize);
@@ -394,10 +407,8 @@ gst_multirate_fir_decim_transform (GstBaseTransform * base, GstBuffer * inbuf,
     GstBuffer * outbuf)
 {
   GstMultirateFirDecim *filter = GST_MULTIRATE_FIR_DECIM (base);
-  double *indata, *outdata, *outend;
-  guint i;
+  double *indata;
   guint insize, availsize, insamples;
-  gint channel;
   guint minsize = filter->kernel_length * filter->channels * sizeof(double);
 
   /* Store initial timestamp and offset if this is the first buffer. */
@@ -428,19 +439,12 @@ gst_multirate_fir_decim_transform (GstBaseTransform * base, GstBuffer * inbuf,
   GST_BUFFER_SIZE (outbuf) = insamples / filter->downsample_factor * (sizeof(double) * filter->channels);
   insize = GST_BUFFER_SIZE (outbuf) * filter->downsample_factor;
   indata = (double *) gst_adapter_peek (filter->adapter, availsize);
-  outdata = (double *) GST_BUFFER_DATA (outbuf);
-  outend = (double *) ((guint8 *) outdata + GST_BUFFER_SIZE (outbuf));
-  memset (outdata, 0, GST_BUFFER_SIZE (outbuf));
 
   /* Evaluate filter. */
-  for (; outdata < outend; outdata += filter->channels) {
-    for (i = 0; i < filter->kernel_length; i ++) {
-      for (channel = 0; channel < filter->channels; channel++) {
-        *(outdata + channel) += *(indata + i * filter->channels + channel) * filter->kernel[filter->kernel_length - 1 - i];
-      }
-    }
-    indata += filter->downsample_factor * filter->channels;
-  }
+  gst_multirate_fir_decimate (filter->algorithm,
+      (double *) GST_BUFFER_DATA (outbuf), indata, filter->taps,
+      filter->kernel_length, filter->channels, filter->downsample_factor,
+      GST_BUFFER_SIZE (outbuf) / (sizeof(double) * filter->channels));
 
   /* Throw away the contents of the adapter that we have consumed. */
   gst_adapter_flush (filter->adapter, insize);
@@ -27,6 +27,8 @@
 #include <gst/base/gstbasetransform.h>
 #include <gst/base/gstadapter.h>
 
+#include "multiratefir.h"
+
 G_BEGIN_DECLS
 #define GST_TYPE_MULTIRATE_FIR_DECIM            (gst_multirate_fir_decim_get_type())
 #define GST_MULTIRATE_FIR_DECIM(obj)            (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_MULTIRATE_FIR_DECIM,GstMultirateFirDecim))
@@ -46,6 +48,7 @@ struct _GstMultirateFirDecim
   double *kernel;
   guint kernel_length;
   guint64 lag;
+  GstMultirateFirAlgorithm algorithm;
 
   /* < private > */
   GstClockTime t0;
@@ -55,6 +58,7 @@ struct _GstMultirateFirDecim
 
   gint inrate, outrate, channels;
   GstAdapter *adapter;
+  double *taps;
   guint downsample_factor;
 };
 
@@ -24,7 +24,9 @@
  * SECTION:element-multiratefirinterp
  *
  * Apply an FIR interpolation filter to a stream using a direct form polyphase
- * implementation.
+ * implementation.  The polyphase components are precomputed into a phase
+ * table; the algorithm property selects between the reference per-sample
+ * loop over the table and vectorized inner products.
  */
 
 #ifdef HAVE_CONFIG_H
@@ -51,7 +53,8 @@ enum
 {
   PROP_0,
   PROP_KERNEL,
-  PROP_LAG
+  PROP_LAG,
+  PROP_ALGORITHM
 };
 
 static GstStaticPadTemplate gst_multirate_fir_interp_sink_template =
@@ -146,6 +149,13 @@ gst_multirate_fir_interp_class_init (GstMultirateFirInterpClass * klass)
           G_PARAM_WRITABLE | GST_PARAM_MUTABLE_READY |
           G_PARAM_STATIC_STRINGS));
 
+  g_object_class_install_property (gobject_class, PROP_ALGORITHM,
+      g_param_spec_enum ("algorithm", "Algorithm",
+          "How to evaluate the filter", GST_TYPE_MULTIRATE_FIR_ALGORITHM,
+          GST_MULTIRATE_FIR_ALGORITHM_POLYPHASE,
+          G_PARAM_READWRITE | GST_PARAM_MUTABLE_READY |
+          G_PARAM_STATIC_STRINGS));
+
   GST_BASE_TRANSFORM_CLASS (klass)->set_caps =
       GST_DEBUG_FUNCPTR (gst_multirate_fir_interp_set_caps);
   GST_BASE_TRANSFORM_CLASS (klass)->transform_caps =
@@ -164,6 +174,7 @@ static void
 gst_multirate_fir_interp_init (GstMultirateFirInterp * filter, GstMultirateFirInterpClass * klass)
 {
   filter->adapter = gst_adapter_new ();
+  filter->algorithm = GST_MULTIRATE_FIR_ALGORITHM_POLYPHASE;
 }
 
 static void gst_multirate_fir_interp_finalize (GObject * object)
@@ -172,9 +183,8 @@ static void gst_multirate_fir_interp_finalize (GObject * object)
 
   g_free (self->kernel);
   self->kernel = NULL;
-  g_free (self->reordered_kernel);
-  self->reordered_kernel = NULL;
-  self->kernel_ptr = NULL;
+  g_free (self->phase_table);
+  self->phase_table = NULL;
   if (self->adapter) {
     g_object_unref (self->adapter);
     self->adapter = NULL;
@@ -198,8 +208,8 @@ gst_multirate_fir_interp_set_property (GObject * object, guint prop_id,
         GValueArray *va = g_value_get_boxed (value);
         filter->kernel_length = va->n_values;
         g_free (filter->kernel);
-        g_free (filter->reordered_kernel);
-        filter->reordered_kernel = NULL;
+        g_free (filter->phase_table);
+        filter->phase_table = NULL;
         filter->kernel = g_new (double, filter->kernel_length);
         for (i = 0; i < filter->kernel_length; i ++)
           filter->kernel[i] = g_value_get_double (g_value_array_get_nth (va, i));
@@ -208,6 +218,9 @@ gst_multirate_fir_interp_set_property (GObject * object, guint prop_id,
     case PROP_LAG:
       filter->lag = g_value_get_uint64 (value);
       break;
+    case PROP_ALGORITHM:
+      filter->algorithm = g_value_get_enum (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -226,6 +239,9 @@ gst_multirate_fir_interp_get_property (GObject * object, guint prop_id,
 
   switch (prop_id) {
     /* FIXME: make properties readwritable and add getters*/
+    case PROP_ALGORITHM:
+      g_value_set_enum (value, filter->algorithm);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -262,8 +278,8 @@ gst_multirate_fir_interp_set_caps (GstBaseTransform * base,
   filter->outrate = outrate;
   filter->channels = inchannels;
   filter->upsample_factor = outrate / inrate;
-  g_free (filter->reordered_kernel);
-  filter->reordered_kernel = NULL;
+  g_free (filter->phase_table);
+  filter->phase_table = NULL;
 
   return TRUE;
 }
@@ -275,7 +291,6 @@ gst_multirate_fir_interp_start (GstBaseTransform * base)
 
   filter->samples = 0;
   filter->needs_timestamp = TRUE;
-  filter->kernel_ptr = filter->reordered_kernel;
   gst_adapter_clear (filter->adapter);
 
   return TRUE;
@@ -310,40 +325,35 @@ gst_multirate_fir_interp_transform_caps (GstBaseTransform * base,
   return othercaps;
 }
 
+/* Group the polyphase components of the kernel together, once per kernel and
+ * upsampling factor. */
+static gboolean
+gst_multirate_fir_interp_build_phase_table (GstMultirateFirInterp * filter)
+{
+  if (G_LIKELY (filter->phase_table))
+    return TRUE;
+  if (G_UNLIKELY (!(filter->kernel))) {
+    GST_ERROR_OBJECT (filter, "kernel not set");
+    return FALSE;
+  }
+
+  filter->phase_table = gst_multirate_fir_phase_table (filter->kernel,
+      filter->kernel_length, filter->upsample_factor, &filter->taps_per_phase);
+  return TRUE;
+}
+
 static GstFlowReturn
 gst_multirate_fir_interp_push_residue (GstMultirateFirInterp * filter)
 {
   GstBaseTransform *base = GST_BASE_TRANSFORM (filter);
   GstBuffer *inbuf, *outbuf;
-  double *indata, *outdata, *outend, *kernelend;
-  gint phase;
-  guint i, j;
+  double *indata;
   guint availsize;
-  gint channel;
   guint minsize;
 
-  /* Reorder kernel so that polyphase components are grouped together. */
-  if (G_UNLIKELY (!(filter->reordered_kernel))) {
-    if (G_UNLIKELY (!(filter->kernel))) {
-      GST_ERROR_OBJECT (filter, "kernel not set");
-      return GST_FLOW_ERROR;
-    }
-
-    filter->reordered_kernel_length = gst_util_uint64_scale_int_ceil (
-        filter->kernel_length, 1, filter->upsample_factor) *
-        filter->upsample_factor;
-
-    /* FIXME: don't force the kernel length to be a multiple of the upsampling factor. */
-    filter->reordered_kernel = g_new (double, filter->reordered_kernel_length);
-    for (phase = filter->upsample_factor - 1, i = 0; phase >= 0; phase --) {
-      for (j = phase; j < filter->reordered_kernel_length; j += filter->upsample_factor, i++) {
-        if (G_LIKELY (j < filter->kernel_length))
-          filter->reordered_kernel[i] = filter->kernel[filter->kernel_length - j - 1];
-      }
-    }
-    filter->kernel_ptr = filter->reordered_kernel;
-  }
-  minsize = filter->reordered_kernel_length * filter->channels * sizeof(double) / filter->upsample_factor;
+  if (G_UNLIKELY (!gst_multirate_fir_interp_build_phase_table (filter)))
+    return GST_FLOW_ERROR;
+  minsize = filter->taps_per_phase * filter->channels * sizeof(double);
 
   /* Put inbuf into adapter. We have to ref inbuf because gst_adapter_push takes
    ownership of it, but transform() is not responsible for unreffing it. */
@@ -362,23 +372,12 @@ gst_multirate_fir_interp_push_residue (GstMultirateFirInterp * filter)
   outbuf = gst_buffer_new_and_alloc ((availsize - minsize) * filter->upsample_factor);
   gst_buffer_set_caps (outbuf, GST_PAD_CAPS (GST_BASE_TRANSFORM_SRC_PAD (base)));
   indata = (double *) gst_adapter_peek (filter->adapter, availsize);
-  kernelend = filter->reordered_kernel + filter->reordered_kernel_length;
-  outdata = (double *) GST_BUFFER_DATA (outbuf);
-  outend = (double *) ((guint8 *) outdata + GST_BUFFER_SIZE (outbuf));
-  memset (outdata, 0, GST_BUFFER_SIZE (outbuf));
 
   /* Evaluate filter. */
-  for (; outdata < outend; outdata += filter->channels) {
-    for (i = 0; i < filter->reordered_kernel_length / filter->upsample_factor; i ++) {
-      for (channel = 0; channel < filter->channels; channel++) {
-        *(outdata + channel) += *(indata + i * filter->channels + channel) * (*filter->kernel_ptr);
-      }
-      if (G_UNLIKELY (++filter->kernel_ptr >= kernelend)) {
-        filter->kernel_ptr = filter->reordered_kernel;
-        indata += filter->channels;
-      }
-    }
-  }
+  gst_multirate_fir_interpolate (filter->algorithm,
+      (double *) GST_BUFFER_DATA (outbuf), indata, filter->phase_table,
+      filter->taps_per_phase, filter->channels, filter->upsample_factor,
+      (availsize - minsize) / (sizeof(double) * filter->channels));
 
   /* Throw away the contents of the adapter that we have consumed. */
   gst_adapter_flush (filter->adapter, availsize - minsize);
@@ -409,13 +408,11 @@ gst_multirate_fir_interp_event (GstBaseTransform * base, GstEvent * event)
         GST_ERROR_OBJECT (filter, "failed to push residue");
       filter->samples = 0;
       filter->needs_timestamp = TRUE;
-      filter->kernel_ptr = filter->reordered_kernel;
       gst_adapter_clear (filter->adapter);
       break;
     case GST_EVENT_NEWSEGMENT:
       filter->samples = 0;
       filter->needs_timestamp = TRUE;
-      filter->kernel_ptr = filter->reordered_kernel;
       gst_adapter_clear (filter->adapter);
       break;
     default:
@@ -430,35 +427,13 @@ gst_multirate_fir_interp_transform (GstBaseTransform * base, GstBuffer * inbuf,
     GstBuffer * outbuf)
 {
   GstMultirateFirInterp *filter = GST_MULTIRATE_FIR_INTERP (base);
-  double *indata, *outdata, *outend, *kernelend;
-  gint phase;
-  guint i, j;
+  double *indata;
   guint availsize;
-  gint channel;
   guint minsize;
 
-  /* Reorder kernel so that polyphase components are grouped together. */
-  if (G_UNLIKELY (!(filter->reordered_kernel))) {
-    if (G_UNLIKELY (!(filter->kernel))) {
-      GST_ERROR_OBJECT (filter, "kernel not set");
-      return GST_FLOW_ERROR;
-    }
-
-    filter->reordered_kernel_length = gst_util_uint64_scale_int_ceil (
-        filter->kernel_length, 1, filter->upsample_factor) *
-        filter->upsample_factor;
-
-    /* FIXME: don't force the kernel length to be a multiple of the upsampling factor. */
-    filter->reordered_kernel = g_new (double, filter->reordered_kernel_length);
-    for (phase = filter->upsample_factor - 1, i = 0; phase >= 0; phase --) {
-      for (j = phase; j < filter->reordered_kernel_length; j += filter->upsample_factor, i++) {
-        if (G_LIKELY (j < filter->kernel_length))
-          filter->reordered_kernel[i] = filter->kernel[filter->kernel_length - j - 1];
-      }
-    }
-    filter->kernel_ptr = filter->reordered_kernel;
-  }
-  minsize = filter->reordered_kernel_length * filter->channels * sizeof(double) / filter->upsample_factor;
+  if (G_UNLIKELY (!gst_multirate_fir_interp_build_phase_table (filter)))
+    return GST_FLOW_ERROR;
+  minsize = filter->taps_per_phase * filter->channels * sizeof(double);
 
   /* Store initial timestamp and offset if this is the first buffer. */
   if (G_UNLIKELY (filter->needs_timestamp)) {
@@ -486,23 +461,12 @@ gst_multirate_fir_interp_transform (GstBaseTransform * base, GstBuffer * inbuf,
   }
   GST_BUFFER_SIZE (outbuf) = (availsize - minsize) * filter->upsample_factor;
   indata = (double *) gst_adapter_peek (filter->adapter, availsize);
-  kernelend = filter->reordered_kernel + filter->reordered_kernel_length;
-  outdata = (double *) GST_BUFFER_DATA (outbuf);
-  outend = (double *) ((guint8 *) outdata + GST_BUFFER_SIZE (outbuf));
-  memset (outdata, 0, GST_BUFFER_SIZE (outbuf));
 
   /* Evaluate filter. */
-  for (; outdata < outend; outdata += filter->channels) {
-    for (i = 0; i < filter->reordered_kernel_length / filter->upsample_factor; i ++) {
-      for (channel = 0; channel < filter->channels; channel++) {
-        *(outdata + channel) += *(indata + i * filter->channels + channel) * (*filter->kernel_ptr);
-      }
-      if (G_UNLIKELY (++filter->kernel_ptr >= kernelend)) {
-        filter->kernel_ptr = filter->reordered_kernel;
-        indata += filter->channels;
-      }
-    }
-  }
+  gst_multirate_fir_interpolate (filter->algorithm,
+      (double *) GST_BUFFER_DATA (outbuf), indata, filter->phase_table,
+      filter->taps_per_phase, filter->channels, filter->upsample_factor,
+      (availsize - minsize) / (sizeof(double) * filter->channels));
 
   /* Throw away the contents of the adapter that we have consumed. */
   gst_adapter_flush (filter->adapter, availsize - minsize);
@@ -27,6 +27,8 @@
 #include <gst/base/gstbasetransform.h>
 #include <gst/base/gstadapter.h>
 
+#include "multiratefir.h"
+
 G_BEGIN_DECLS
 #define GST_TYPE_MULTIRATE_FIR_INTERP            (gst_multirate_fir_interp_get_type())
 #define GST_MULTIRATE_FIR_INTERP(obj)            (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_MULTIRATE_FIR_INTERP,GstMultirateFirInterp))
@@ -46,6 +48,7 @@ struct _GstMultirateFirInterp
   double *kernel;
   guint kernel_length;
   guint64 lag;
+  GstMultirateFirAlgorithm algorithm;
 
   /* < private > */
   GstClockTime t0;
@@ -55,9 +58,8 @@ struct _GstMultirateFirInterp
 
   gint inrate, outrate, channels;
   GstAdapter *adapter;
-  double *reordered_kernel;
-  guint reordered_kernel_length;
-  double *kernel_ptr;
+  double *phase_table;
+  guint taps_per_phase;
   guint upsample_factor;
 };
 
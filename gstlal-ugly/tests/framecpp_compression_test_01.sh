@@ -0,0 +1,33 @@
+#!/bin/sh
+
+#
+# mux the same data with serial and parallel compression and check that
+# the frame files are byte-for-byte identical.  several channels of
+# different widths and rates are used so that each frame has more than
+# one FrVect to farm out, and the data is noise so that it compresses
+# unevenly.
+#
+
+name=framecpp_compression_test_01
+
+mux() {
+	echo "framecpp_channelmux name=$1 frame-duration=4 frames-per-file=4 compression-scheme=DIFF_GZIP compression-level=6 $2 ! filesink sync=false async=false location=${name}_$1.gwf"
+}
+
+gst-launch --quiet \
+	audiotestsrc wave=9 samplesperbuffer=1024 num-buffers=64 ! audio/x-raw-float, width=32, rate=1024 ! tee name=a \
+	audiotestsrc wave=9 volume=0.25 samplesperbuffer=512 num-buffers=64 ! audio/x-raw-float, width=64, rate=512 ! tee name=b \
+	audiotestsrc wave=0 freq=30 samplesperbuffer=256 num-buffers=64 ! audio/x-raw-float, width=32, rate=256 ! tee name=c \
+	$(mux serial "compression-threads=1") \
+	$(mux threads "compression-threads=4") \
+	$(mux overlap "compression-threads=0 overlap-write=true") \
+	a. ! queue ! serial.H1:A a. ! queue ! threads.H1:A a. ! queue ! overlap.H1:A \
+	b. ! queue ! serial.H1:B b. ! queue ! threads.H1:B b. ! queue ! overlap.H1:B \
+	c. ! queue ! serial.H1:C c. ! queue ! threads.H1:C c. ! queue ! overlap.H1:C \
+	|| exit 1
+
+test -s ${name}_serial.gwf && cmp ${name}_serial.gwf ${name}_threads.gwf && cmp ${name}_serial.gwf ${name}_overlap.gwf
+result=$?
+
+rm -f ${name}_serial.gwf ${name}_threads.gwf ${name}_overlap.gwf
+exit $result
@@ -0,0 +1,29 @@
+#!/bin/sh
+
+#
+# read frame files through the in-process fake partition with and without
+# zero-copy buffers, and check the output matches the input.  the queue
+# in the zero-copy pipeline holds buffers downstream so the
+# max-outstanding limit is exercised:  if it is not respected the fake
+# partition runs out of buffers and the element posts an error.
+#
+
+dir="lvshmsrc_zerocopy_test_01.d"
+src=${srcdir:-.}/lvshmsrc_zerocopy_test_01.sh
+
+rm -rf $dir
+mkdir $dir
+for t in 874018527 874018531 874018535 874018539 874018543 874018547 ; do
+	cp $src $dir/H-LVSHMSRC_TEST_01-$t-4.gwf
+done
+
+cat $src $src $src $src $src $src >lvshmsrc_zerocopy_test_01.expected
+
+gst-launch --quiet gds_lvshmsrc fake-partition=$dir num-buffers=6 ! filesink location=lvshmsrc_zerocopy_test_01.copy sync=false async=false || exit 1
+gst-launch --quiet gds_lvshmsrc fake-partition=$dir zero-copy=true max-outstanding=3 num-buffers=6 ! queue ! filesink location=lvshmsrc_zerocopy_test_01.zerocopy sync=false async=false || exit 1
+
+cmp lvshmsrc_zerocopy_test_01.expected lvshmsrc_zerocopy_test_01.copy && cmp lvshmsrc_zerocopy_test_01.expected lvshmsrc_zerocopy_test_01.zerocopy
+result=$?
+
+rm -rf $dir lvshmsrc_zerocopy_test_01.expected lvshmsrc_zerocopy_test_01.copy lvshmsrc_zerocopy_test_01.zerocopy
+exit $result
@@ -0,0 +1,208 @@
+/*
+ * Consistency check for the multirate FIR filter evaluation
+ *
+ * Copyright (C) 2026  The gstlal authors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/*
+ * Decimates and interpolates random data with the direct and the
+ * polyphase algorithms for a range of kernel lengths, factors and channel
+ * counts, including kernels whose length is not a multiple of the factor,
+ * and checks that the two agree to within floating point rounding.  A
+ * delta function kernel checks both against the exact answer.  Exits with
+ * a non-zero status on any failure.
+ */
+
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <glib.h>
+
+#include "multiratefir.h"
+
+#define CHECK(expr) do { if (!(expr)) { fprintf (stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #expr); return 1; } } while (0)
+
+#define NSAMPLES 257
+
+static const guint lengths[] = { 1, 7, 16, 33, 128 };
+static const guint factors[] = { 1, 2, 3, 4, 8 };
+static const guint channel_counts[] = { 1, 2, 5 };
+
+static double *
+random_samples (GRand * rand, guint n)
+{
+  double *x = g_new (double, n);
+  guint i;
+
+  for (i = 0; i < n; i++)
+    x[i] = g_rand_double_range (rand, -1.0, 1.0);
+  return x;
+}
+
+/* largest difference between a and b, relative to the bound on the
+ * rounding error of an inner product of ntaps terms of x and h */
+static double
+max_error (const double *a, const double *b, guint n, guint ntaps,
+    double max_x, double max_h)
+{
+  double err = 0.0;
+  guint i;
+
+  for (i = 0; i < n; i++)
+    err = MAX (err, fabs (a[i] - b[i]));
+  return err / (ntaps * DBL_EPSILON * max_x * max_h);
+}
+
+static double
+max_abs (const double *x, guint n)
+{
+  double m = 0.0;
+  guint i;
+
+  for (i = 0; i < n; i++)
+    m = MAX (m, fabs (x[i]));
+  return m;
+}
+
+static int
+test_decimate (GRand * rand, guint length, guint factor, guint channels)
+{
+  guint outsamples = NSAMPLES;
+  guint insamples = (outsamples - 1) * factor + length;
+  double *kernel = random_samples (rand, length);
+  double *in = random_samples (rand, insamples * channels);
+  double *taps = gst_multirate_fir_reverse_kernel (kernel, length);
+  double *direct = g_new (double, outsamples * channels);
+  double *polyphase = g_new (double, outsamples * channels);
+
+  gst_multirate_fir_decimate (GST_MULTIRATE_FIR_ALGORITHM_DIRECT, direct, in,
+      taps, length, channels, factor, outsamples);
+  gst_multirate_fir_decimate (GST_MULTIRATE_FIR_ALGORITHM_POLYPHASE,
+      polyphase, in, taps, length, channels, factor, outsamples);
+  CHECK (max_error (direct, polyphase, outsamples * channels, length,
+          max_abs (in, insamples * channels), max_abs (kernel, length)) <= 1.0);
+
+  g_free (kernel);
+  g_free (in);
+  g_free (taps);
+  g_free (direct);
+  g_free (polyphase);
+  return 0;
+}
+
+static int
+test_interpolate (GRand * rand, guint length, guint factor, guint channels)
+{
+  double *kernel = random_samples (rand, length);
+  guint taps_per_phase;
+  double *table = gst_multirate_fir_phase_table (kernel, length, factor,
+      &taps_per_phase);
+  guint insamples = NSAMPLES;
+  double *in = random_samples (rand, (insamples + taps_per_phase) * channels);
+  guint n = insamples * factor * channels;
+  double *direct = g_new (double, n);
+  double *polyphase = g_new (double, n);
+
+  CHECK (taps_per_phase * factor >= length);
+  CHECK (taps_per_phase * factor < length + factor);
+
+  gst_multirate_fir_interpolate (GST_MULTIRATE_FIR_ALGORITHM_DIRECT, direct,
+      in, table, taps_per_phase, channels, factor, insamples);
+  gst_multirate_fir_interpolate (GST_MULTIRATE_FIR_ALGORITHM_POLYPHASE,
+      polyphase, in, table, taps_per_phase, channels, factor, insamples);
+  CHECK (max_error (direct, polyphase, n, taps_per_phase,
+          max_abs (in, (insamples + taps_per_phase) * channels),
+          max_abs (kernel, length)) <= 1.0);
+
+  g_free (kernel);
+  g_free (table);
+  g_free (in);
+  g_free (direct);
+  g_free (polyphase);
+  return 0;
+}
+
+/* a unit impulse d samples from the end of the kernel delays the input by
+ * d samples, exactly, with either algorithm */
+static int
+test_delta (GRand * rand, GstMultirateFirAlgorithm algorithm)
+{
+  const guint length = 12, d = 5, factor = 3, channels = 2;
+  double kernel[12];
+  double *in = random_samples (rand, (NSAMPLES * factor + length) * channels);
+  double *out = g_new (double, NSAMPLES * factor * channels);
+  double *taps, *table;
+  guint taps_per_phase, n, channel;
+
+  memset (kernel, 0, sizeof (kernel));
+  kernel[length - 1 - d] = 1.0;
+
+  /* output frame n is input frame n * factor + d */
+  taps = gst_multirate_fir_reverse_kernel (kernel, length);
+  gst_multirate_fir_decimate (algorithm, out, in, taps, length, channels,
+      factor, NSAMPLES);
+  for (n = 0; n < NSAMPLES; n++)
+    for (channel = 0; channel < channels; channel++)
+      CHECK (out[n * channels + channel] ==
+          in[(n * factor + d) * channels + channel]);
+  g_free (taps);
+
+  /* output frame m is input frame (m + d + 1) / factor - 1 where that is a
+   * whole sample, else 0.  d + 1 >= factor keeps the frame in range */
+  table = gst_multirate_fir_phase_table (kernel, length, factor,
+      &taps_per_phase);
+  gst_multirate_fir_interpolate (algorithm, out, in, table, taps_per_phase,
+      channels, factor, NSAMPLES);
+  for (n = 0; n < NSAMPLES * factor; n++)
+    for (channel = 0; channel < channels; channel++) {
+      double expect = (n + d + 1) % factor ? 0.0 :
+          in[((n + d + 1) / factor - 1) * channels + channel];
+      CHECK (out[n * channels + channel] == expect);
+    }
+  g_free (table);
+
+  g_free (in);
+  g_free (out);
+  return 0;
+}
+
+int
+main (int argc, char *argv[])
+{
+  GRand *rand = g_rand_new_with_seed (1);
+  guint i, j, k;
+
+  for (i = 0; i < G_N_ELEMENTS (lengths); i++)
+    for (j = 0; j < G_N_ELEMENTS (factors); j++)
+      for (k = 0; k < G_N_ELEMENTS (channel_counts); k++) {
+        if (test_decimate (rand, lengths[i], factors[j], channel_counts[k]))
+          return 1;
+        if (test_interpolate (rand, lengths[i], factors[j], channel_counts[k]))
+          return 1;
+      }
+
+  if (test_delta (rand, GST_MULTIRATE_FIR_ALGORITHM_DIRECT))
+    return 1;
+  if (test_delta (rand, GST_MULTIRATE_FIR_ALGORITHM_POLYPHASE))
+    return 1;
+
+  g_rand_free (rand);
+  return 0;
+}
@@ -168,6 +168,42 @@ MAKE_FUNC_NC (add_complex64, complex float)
 MAKE_FUNC_NC (add_complex128, complex double)
 /* *INDENT-ON* */
 
+/* fused versions (for float and complex):  all inputs are added into the
+ * output in one pass over it.  the output is visited a block at a time,
+ * and every input covering the block is added into it while it is still in
+ * cache, instead of streaming the whole output once per input.  inputs only
+ * cover the part of the output they have data for, so gaps are never read.
+ * complex samples are added as pairs of reals. */
+#define ADDER_BLOCK_SIZE 16384  /* bytes */
+
+#define MAKE_FUNC_MULTI(name,type)                                      \
+static void name (type *out, const GstAdderInput *in, guint n_in,       \
+    guint size) {                                                       \
+  guint n = size / sizeof (type);                                       \
+  guint block = ADDER_BLOCK_SIZE / sizeof (type);                       \
+  guint start, end, i, j;                                               \
+  for (start = 0; start < n; start += block) {                          \
+    end = MIN (start + block, n);                                       \
+    for (i = 0; i < n_in; i++) {                                        \
+      guint first = in[i].offset / sizeof (type);                       \
+      guint lo = MAX (start, first);                                    \
+      guint hi = MIN (end, (in[i].offset + in[i].length) / sizeof (type)); \
+      type *restrict dst = out + lo;                                    \
+      const type *restrict src = (const type *) in[i].data + (lo - first); \
+      if (lo >= hi)                                                     \
+        continue;                                                       \
+      _Pragma ("omp simd")                                              \
+      for (j = 0; j < hi - lo; j++)                                     \
+        dst[j] += src[j];                                               \
+    }                                                                   \
+  }                                                                     \
+}
+
+/* *INDENT-OFF* */
+MAKE_FUNC_MULTI (add_multi_float32, gfloat)
+MAKE_FUNC_MULTI (add_multi_float64, gdouble)
+/* *INDENT-ON* */
+
 /* we can only accept caps that we and downstream can handle.
  * if we have filtercaps set, use those to constrain the target caps.
  */
@@ -273,6 +309,7 @@ gst_adder_setcaps (GstPad * pad, GstCaps * caps)
     if (adder->endianness != G_BYTE_ORDER)
       goto not_supported;
 
+    adder->multi_func = NULL;
     switch (adder->width) {
       case 8:
         adder->func = (adder->is_signed ?
@@ -303,9 +340,11 @@ gst_adder_setcaps (GstPad * pad, GstCaps * caps)
     switch (adder->width) {
       case 32:
         adder->func = (GstAdderFunction) add_float32;
+        adder->multi_func = (GstAdderMultiFunction) add_multi_float32;
         break;
       case 64:
         adder->func = (GstAdderFunction) add_float64;
+        adder->multi_func = (GstAdderMultiFunction) add_multi_float64;
         break;
       default:
         goto not_supported;
@@ -324,9 +363,11 @@ gst_adder_setcaps (GstPad * pad, GstCaps * caps)
     switch (adder->width) {
       case 64:
         adder->func = (GstAdderFunction) add_complex64;
+        adder->multi_func = (GstAdderMultiFunction) add_multi_float32;
         break;
       case 128:
         adder->func = (GstAdderFunction) add_complex128;
+        adder->multi_func = (GstAdderMultiFunction) add_multi_float64;
         break;
       default:
         goto not_supported;
@@ -890,6 +931,8 @@ gstlal_adder_init (GstLALAdder * adder, GstLALAdderClass * klass)
   adder->format = GST_ADDER_FORMAT_UNSET;
   adder->padcount = 0;
   adder->func = NULL;
+  adder->multi_func = NULL;
+  adder->fused_inputs = g_array_new (FALSE, FALSE, sizeof (GstAdderInput));
 
   adder->filter_caps = NULL;
 
@@ -911,6 +954,10 @@ gst_adder_dispose (GObject * object)
     adder->collect = NULL;
   }
   gst_caps_replace (&adder->filter_caps, NULL);
+  if (adder->fused_inputs) {
+    g_array_unref (adder->fused_inputs);
+    adder->fused_inputs = NULL;
+  }
   /* FIXME:  switch to
     g_list_free_full (adder->pending_events, (GDestroyNotify) gst_event_unref);
     adder->pending_events = NULL;
@@ -1097,6 +1144,7 @@ gst_adder_collected (GstCollectPads * pads, gpointer user_data)
   GSList *collected;
   GstBuffer *outbuf = NULL;
   GSList *partial_nongap_buffers = NULL;
+  GSList *fused_buffers = NULL;
   GstBuffer *full_gap_buffer = NULL;
   gboolean have_gap_buffers = FALSE;
   GstFlowReturn ret;
@@ -1269,6 +1317,8 @@ gst_adder_collected (GstCollectPads * pads, gpointer user_data)
     } else if (offset == 0 && inlength == outlength) {	/* not a gap, does it span the full output interval? */
       if (!outbuf)	/* if we don't have a buffer to hold the output yet, this one's it */
         outbuf = inbuf;
+      else if (adder->multi_func)	/* add it with the others in one go */
+        fused_buffers = g_slist_prepend (fused_buffers, inbuf);
       else {	/* add this buffer to the output buffer */
         outbuf = gst_buffer_make_writable (outbuf);
         adder->func (GST_BUFFER_DATA (outbuf), GST_BUFFER_DATA (inbuf), GST_BUFFER_SIZE (outbuf) / adder->sample_size);
@@ -1278,8 +1328,8 @@ gst_adder_collected (GstCollectPads * pads, gpointer user_data)
       partial_nongap_buffers = g_slist_prepend (partial_nongap_buffers, inbuf);
   }
 
-  /* now add partial non-gap buffers */
-  if (partial_nongap_buffers) {
+  /* now add partial non-gap buffers, and full ones left for the fused add */
+  if (partial_nongap_buffers || fused_buffers) {
     if (!outbuf) {
       /* this code path should only be possible if the input included a gap
        * buffer spanning the full input interval */
@@ -1301,11 +1351,32 @@ gst_adder_collected (GstCollectPads * pads, gpointer user_data)
       memset (GST_BUFFER_DATA (outbuf), 0, GST_BUFFER_SIZE (outbuf));
     } else
       outbuf = gst_buffer_make_writable (outbuf);
+    /* the full buffers in pad order then the partial ones, the order they
+     * are added in one by one, so both ways give the same sums */
+    partial_nongap_buffers = g_slist_concat (g_slist_reverse (fused_buffers), partial_nongap_buffers);
+    fused_buffers = NULL;
+    if (adder->multi_func) {
+      GSList *l;
+      for (l = partial_nongap_buffers; l; l = g_slist_next (l)) {
+        GstBuffer *inbuf = GST_BUFFER (l->data);
+        GstAdderInput input;
+        guint offset = adder->synchronous ?  gst_util_uint64_scale_int_round (GST_BUFFER_TIMESTAMP (inbuf) - adder->segment.start, adder->rate, GST_SECOND) - earliest_output_offset : 0;
+        g_assert (offset * adder->bps + GST_BUFFER_SIZE (inbuf) <= GST_BUFFER_SIZE (outbuf) || GST_BUFFER_SIZE (inbuf) == 0);
+        input.data = GST_BUFFER_DATA (inbuf);
+        input.offset = offset * adder->bps;
+        input.length = GST_BUFFER_SIZE (inbuf);
+        g_array_append_val (adder->fused_inputs, input);
+      }
+      adder->multi_func (GST_BUFFER_DATA (outbuf), (GstAdderInput *) adder->fused_inputs->data, adder->fused_inputs->len, GST_BUFFER_SIZE (outbuf));
+      g_array_set_size (adder->fused_inputs, 0);
+    }
     while (partial_nongap_buffers) {
       GstBuffer *inbuf = GST_BUFFER (partial_nongap_buffers->data);
-      guint offset = adder->synchronous ?  gst_util_uint64_scale_int_round (GST_BUFFER_TIMESTAMP (inbuf) - adder->segment.start, adder->rate, GST_SECOND) - earliest_output_offset : 0;
-      g_assert (offset * adder->bps + GST_BUFFER_SIZE (inbuf) <= GST_BUFFER_SIZE (outbuf) || GST_BUFFER_SIZE (inbuf) == 0);
-      adder->func (GST_BUFFER_DATA (outbuf) + offset * adder->bps, GST_BUFFER_DATA (inbuf), GST_BUFFER_SIZE (inbuf) / adder->sample_size);
+      if (!adder->multi_func) {
+        guint offset = adder->synchronous ?  gst_util_uint64_scale_int_round (GST_BUFFER_TIMESTAMP (inbuf) - adder->segment.start, adder->rate, GST_SECOND) - earliest_output_offset : 0;
+        g_assert (offset * adder->bps + GST_BUFFER_SIZE (inbuf) <= GST_BUFFER_SIZE (outbuf) || GST_BUFFER_SIZE (inbuf) == 0);
+        adder->func (GST_BUFFER_DATA (outbuf) + offset * adder->bps, GST_BUFFER_DATA (inbuf), GST_BUFFER_SIZE (inbuf) / adder->sample_size);
+      }
       partial_nongap_buffers = g_slist_remove (partial_nongap_buffers, inbuf);
       gst_buffer_unref (inbuf);
     }
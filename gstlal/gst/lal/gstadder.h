@@ -48,6 +48,16 @@ typedef enum {
 
 typedef void (*GstAdderFunction) (gpointer out, gpointer in, guint size);
 
+/* an input of the fused add:  its data and the bytes of the output it
+ * covers */
+typedef struct _GstAdderInput {
+  gconstpointer data;
+  guint offset;
+  guint length;
+} GstAdderInput;
+
+typedef void (*GstAdderMultiFunction) (gpointer out, const GstAdderInput * in, guint n_in, guint size);
+
 /**
  * GstAdder:
  *
@@ -78,6 +88,10 @@ struct _GstLALAdder {
 
   /* function to add samples */
   GstAdderFunction func;
+  /* function to add all inputs at once, NULL to add them one by one with
+   * func, and the array of its inputs */
+  GstAdderMultiFunction multi_func;
+  GArray         *fused_inputs;
 
   /* counters to keep track of timestamps */
   GstClockTime    timestamp;
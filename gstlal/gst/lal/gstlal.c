@@ -51,9 +51,11 @@
 
 #include <gstlal/gstlal_tags.h>
 #include <gstlal/gstlal.h>
+#include <gstlal/gstlal_fftw.h>
 #include <gstlal_audioundersample.h>
 #include <gstlal_autochisq.h>
 #include <gstlal_cachesrc.h>
+#include <gstlal_dirwatchsrc.h>
 #include <gstlal_drop.h>
 #include <gstlal_firbank.h>
 #include <gstlal_gate.h>
@@ -89,6 +91,7 @@ static gboolean plugin_init(GstPlugin *plugin)
 		{"lal_audioundersample", GSTLAL_AUDIOUNDERSAMPLE_TYPE},
 		{"lal_autochisq", GSTLAL_AUTOCHISQ_TYPE},
 		{"lal_cachesrc", GSTLAL_CACHESRC_TYPE},
+		{"lal_dirwatchsrc", GSTLAL_DIRWATCHSRC_TYPE},
 		{"lal_drop", GSTLAL_DROP_TYPE},
 		{"lal_firbank", GSTLAL_FIRBANK_TYPE},
 		{"lal_gate", GSTLAL_GATE_TYPE},
@@ -120,10 +123,12 @@ static gboolean plugin_init(GstPlugin *plugin)
 	gstlal_register_tags();
 
 	/*
-	 * Load FFTW wisdom
+	 * Load FFTW wisdom, and plan the transforms we've been told will be
+	 * needed
 	 */
 
 	gstlal_load_fftw_wisdom();
+	gstlal_fftw_plan_cache_warm_up_from_env();
 
 	/*
 	 * Tell GStreamer about the elements.
@@ -171,7 +171,7 @@ static unsigned filter(GSTLALAutoChiSq *element, GstBuffer *outbuf)
 	unsigned zeros_in_adapter;
 	unsigned available_length;
 	unsigned output_length = 0;
-	complex double *input;
+	const complex double *input;
 
 	/*
 	 * do we have enough data to do anything?
@@ -207,8 +207,7 @@ static unsigned filter(GSTLALAutoChiSq *element, GstBuffer *outbuf)
 	 * get input data
 	 */
 
-	input = g_malloc(available_length * channels * sizeof(*input));
-	gst_audioadapter_copy_samples(element->adapter, input, available_length, NULL, NULL);
+	input = gst_audioadapter_peek_samples(element->adapter, available_length, NULL, NULL);
 
 	/*
 	 * compute output samples.  note:  we assume that gsl_complex can
@@ -228,7 +227,6 @@ static unsigned filter(GSTLALAutoChiSq *element, GstBuffer *outbuf)
 	 * flush the data from the adapter
 	 */
 
-	g_free(input);
 	gst_audioadapter_flush_samples(element->adapter, output_length);
 
 done:
@@ -0,0 +1,1161 @@
+/*
+ * GstLALDirWatchSrc
+ *
+ * Copyright (C) 2026  The gstlal authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+/**
+ * SECTION:gstlal_dirwatchsrc
+ * @short_description:  Retrieve frame files as they appear in a directory.
+ *
+ * Watches a directory, for example /dev/shm/llhoft/H1, with inotify(7)
+ * and loads each frame file as soon as the process writing it closes it
+ * or renames it into place.  Each file is placed into its own #GstBuffer
+ * either by mmap()ing the file or by reading it into memory, with the
+ * same buffer conventions as #lal_cachesrc so the stream can be fed to
+ * framecpp_channeldemux unchanged.  This is a live source:  files
+ * already present in the directory when the element starts are ignored.
+ *
+ * File names must follow the LIGO-T050017 convention
+ * <quote>OBS-DESCRIPTION-GPSSTART-DURATION.gwf</quote>;  the timestamp
+ * and duration of each buffer are taken from the name.  Names beginning
+ * with "." are ignored so that writers can create temporary files in the
+ * directory and rename them when complete.  Regular expressions can be
+ * used to select files by their observatory and description fields.
+ *
+ * If the file following the most recently pushed file has not appeared by
+ * the time the GPS clock reaches the end of the missing file plus
+ * #GstLALDirWatchSrc:wait-time seconds, the file is declared missing and
+ * a 0-length heart-beat buffer is pushed with a timestamp equal to the end
+ * of the missing interval, which framecpp_channeldemux forwards
+ * downstream as gaps.  This bounds the latency of the output stream even
+ * when the writer drops data.  Files that arrive after having been
+ * declared missing are discarded.
+ *
+ * When mmap() is used, writers must not modify files in place after
+ * closing them.  Replacing or deleting them is safe.
+ */
+
+
+/*
+ * ============================================================================
+ *
+ *                                  Preamble
+ *
+ * ============================================================================
+ */
+
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+#include <glib.h>
+#include <gst/gst.h>
+#include <gst/base/gstbasesrc.h>
+
+
+#include <lal/Date.h>
+#include <lal/XLALError.h>
+
+
+#include <gstlal/gstlal_debug.h>
+#include <gstlal_dirwatchsrc.h>
+
+
+/*
+ * ============================================================================
+ *
+ *                                Boilerplate
+ *
+ * ============================================================================
+ */
+
+
+#define GST_CAT_DEFAULT gstlal_dirwatchsrc_debug
+GST_DEBUG_CATEGORY_STATIC(GST_CAT_DEFAULT);
+
+
+static void additional_initializations(GType type)
+{
+	GST_DEBUG_CATEGORY_INIT(GST_CAT_DEFAULT, "lal_dirwatchsrc", 0, "lal_dirwatchsrc element");
+}
+
+
+GST_BOILERPLATE_FULL(GstLALDirWatchSrc, gstlal_dirwatchsrc, GstBaseSrc, GST_TYPE_BASE_SRC, additional_initializations);
+
+
+/*
+ * ============================================================================
+ *
+ *                                 Parameters
+ *
+ * ============================================================================
+ */
+
+
+#define DEFAULT_LOCATION NULL
+#define DEFAULT_SRC_REGEX NULL
+#define DEFAULT_DSC_REGEX NULL
+#define DEFAULT_USE_MMAP TRUE
+#define DEFAULT_WAIT_TIME 2.0	/* seconds */
+
+
+/*
+ * ============================================================================
+ *
+ *                             Internal Functions
+ *
+ * ============================================================================
+ */
+
+
+/*
+ * a frame file waiting to be pushed
+ */
+
+
+struct frame_file {
+	gchar *path;
+	GstClockTime t0;
+	GstClockTime dt;
+};
+
+
+static void frame_file_free(struct frame_file *file)
+{
+	if(file)
+		g_free(file->path);
+	g_free(file);
+}
+
+
+static gint frame_file_cmp(gconstpointer a, gconstpointer b, gpointer data)
+{
+	const struct frame_file *file_a = a;
+	const struct frame_file *file_b = b;
+
+	return file_a->t0 < file_b->t0 ? -1 : file_a->t0 > file_b->t0 ? +1 : 0;
+}
+
+
+static GstClockTime gps_now(GstLALDirWatchSrc *element)
+{
+	LIGOTimeGPS now;
+
+	if(!XLALGPSTimeNow(&now)) {
+		GST_WARNING_OBJECT(element, "XLALGPSTimeNow() failed: %s", XLALErrorString(XLALGetBaseErrno()));
+		XLALClearErrno();
+		return 0;
+	}
+	return XLALGPSToINT8NS(&now);
+}
+
+
+/*
+ * parse a LIGO-T050017 frame file name.  returns FALSE if the name does
+ * not have the expected form.
+ */
+
+
+static gboolean parse_file_name(const char *name, gchar **src, gchar **dsc, GstClockTime *t0, GstClockTime *dt)
+{
+	unsigned start, duration;
+	int end = -1;
+
+	*src = *dsc = NULL;
+
+	if(name[0] == '.')
+		return FALSE;
+	if(sscanf(name, "%m[^-]-%m[^-]-%u-%u.gwf%n", src, dsc, &start, &duration, &end) < 4 || end < 0 || name[end] != '\0' || !duration) {
+		free(*src);
+		free(*dsc);
+		*src = *dsc = NULL;
+		return FALSE;
+	}
+
+	*t0 = start * GST_SECOND;
+	*dt = duration * GST_SECOND;
+	return TRUE;
+}
+
+
+/*
+ * add a file to the queue of pending files.  files that precede the end
+ * of the most recently pushed file (or heart beat), and copies of files
+ * already in the queue, are discarded.
+ */
+
+
+static void enqueue_file(GstLALDirWatchSrc *element, const char *name)
+{
+	gchar *src, *dsc;
+	GstClockTime t0, dt;
+	struct frame_file *file;
+	GList *link;
+
+	if(!parse_file_name(name, &src, &dsc, &t0, &dt)) {
+		GST_LOG_OBJECT(element, "ignoring '%s': not a frame file name", name);
+		return;
+	}
+
+	if((element->src_re && !g_regex_match(element->src_re, src, 0, NULL)) || (element->dsc_re && !g_regex_match(element->dsc_re, dsc, 0, NULL))) {
+		GST_LOG_OBJECT(element, "ignoring '%s': rejected by regex", name);
+		goto done;
+	}
+
+	if(GST_CLOCK_TIME_IS_VALID(element->next_timestamp) && t0 < element->next_timestamp) {
+		GST_WARNING_OBJECT(element, "discarding '%s': precedes %" GST_TIME_SECONDS_FORMAT, name, GST_TIME_SECONDS_ARGS(element->next_timestamp));
+		goto done;
+	}
+
+	for(link = g_queue_peek_head_link(element->pending); link; link = g_list_next(link))
+		if(((struct frame_file *) link->data)->t0 == t0) {
+			GST_WARNING_OBJECT(element, "discarding '%s': duplicate of '%s'", name, ((struct frame_file *) link->data)->path);
+			goto done;
+		}
+
+	file = g_new(struct frame_file, 1);
+	file->path = g_build_filename(element->location, name, NULL);
+	file->t0 = t0;
+	file->dt = dt;
+	g_queue_insert_sorted(element->pending, file, frame_file_cmp, NULL);
+	GST_DEBUG_OBJECT(element, "queued '%s' spanning [%" GST_TIME_SECONDS_FORMAT ", %" GST_TIME_SECONDS_FORMAT ")", file->path, GST_TIME_SECONDS_ARGS(t0), GST_TIME_SECONDS_ARGS(t0 + dt));
+
+done:
+	free(src);
+	free(dsc);
+}
+
+
+/*
+ * record the names of the files already in the directory when the element
+ * starts.  until the first buffer has been pushed there is no timestamp to
+ * compare rescanned files against, so this is what keeps a rescan from
+ * queuing them.
+ */
+
+
+static GHashTable *list_directory(GstLALDirWatchSrc *element)
+{
+	GHashTable *names = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+	GError *error = NULL;
+	GDir *dir = g_dir_open(element->location, 0, &error);
+	const gchar *name;
+
+	if(!dir) {
+		GST_WARNING_OBJECT(element, "cannot list '%s': %s", element->location, error->message);
+		g_error_free(error);
+		return names;
+	}
+	while((name = g_dir_read_name(dir)))
+		g_hash_table_insert(names, g_strdup(name), NULL);
+	g_dir_close(dir);
+
+	return names;
+}
+
+
+/*
+ * queue every file in the directory.  used to recover after the kernel's
+ * inotify event queue has overflowed.  files that were present when the
+ * element started are skipped.
+ */
+
+
+static void rescan_directory(GstLALDirWatchSrc *element)
+{
+	GError *error = NULL;
+	GDir *dir = g_dir_open(element->location, 0, &error);
+	const gchar *name;
+
+	if(!dir) {
+		GST_WARNING_OBJECT(element, "cannot rescan '%s': %s", element->location, error->message);
+		g_error_free(error);
+		return;
+	}
+	while((name = g_dir_read_name(dir))) {
+		if(element->preexisting && g_hash_table_lookup_extended(element->preexisting, name, NULL, NULL)) {
+			GST_LOG_OBJECT(element, "ignoring '%s': present at start", name);
+			continue;
+		}
+		enqueue_file(element, name);
+	}
+	g_dir_close(dir);
+}
+
+
+/*
+ * consume all available inotify events without blocking.  returns FALSE
+ * if the watch has been lost.
+ */
+
+
+static gboolean read_events(GstLALDirWatchSrc *element)
+{
+	char events[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+	gboolean need_rescan = FALSE;
+
+	while(1) {
+		ssize_t len = read(element->inotify_fd, events, sizeof(events));
+		char *ptr;
+
+		if(len < 0) {
+			if(errno == EINTR)
+				continue;
+			if(errno == EAGAIN || errno == EWOULDBLOCK)
+				break;
+			GST_ELEMENT_ERROR(element, RESOURCE, READ, (NULL), ("read() from inotify descriptor failed: %s", strerror(errno)));
+			return FALSE;
+		}
+
+		for(ptr = events; ptr < events + len; ptr += sizeof(struct inotify_event) + ((struct inotify_event *) ptr)->len) {
+			const struct inotify_event *event = (const struct inotify_event *) ptr;
+
+			if(event->mask & IN_Q_OVERFLOW) {
+				GST_WARNING_OBJECT(element, "inotify event queue overflowed, rescanning '%s'", element->location);
+				need_rescan = TRUE;
+			} else if(event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) {
+				GST_ELEMENT_ERROR(element, RESOURCE, READ, (NULL), ("'%s' has been removed or renamed", element->location));
+				return FALSE;
+			} else if(event->len && (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)))
+				enqueue_file(element, event->name);
+		}
+	}
+
+	if(need_rescan)
+		rescan_directory(element);
+
+	return TRUE;
+}
+
+
+static GstFlowReturn read_buffer(GstBaseSrc *basesrc, const char *path, int fd, guint64 offset, size_t size, GstBuffer **buf)
+{
+	GstPad *pad = GST_BASE_SRC_PAD(basesrc);
+	size_t read_offset;
+	GstFlowReturn result = GST_FLOW_OK;
+
+	result = gst_pad_alloc_buffer(pad, offset, size, GST_PAD_CAPS(pad), buf);
+	if(result != GST_FLOW_OK)
+		goto done;
+	g_assert_cmpuint(GST_BUFFER_OFFSET(*buf), ==, offset);
+	g_assert_cmpuint(GST_BUFFER_SIZE(*buf), ==, size);
+
+	read_offset = 0;
+	do {
+		ssize_t bytes_read = read(fd, GST_BUFFER_DATA(*buf) + read_offset, GST_BUFFER_SIZE(*buf) - read_offset);
+		if(bytes_read <= 0) {
+			GST_ELEMENT_ERROR(basesrc, RESOURCE, READ, (NULL), ("read('%s') failed: %s", path, bytes_read ? strerror(errno) : "file truncated"));
+			gst_buffer_unref(*buf);
+			*buf = NULL;
+			result = GST_FLOW_ERROR;
+			goto done;
+		}
+		read_offset += bytes_read;
+	} while(read_offset < size);
+	g_assert_cmpuint(read_offset, ==, size);
+
+	GST_BUFFER_OFFSET_END(*buf) = offset + size;
+
+done:
+	return result;
+}
+
+
+static void munmap_buffer(GstBuffer *buf)
+{
+	if(buf) {
+		g_assert(GST_IS_BUFFER(buf));
+		munmap(GST_BUFFER_DATA(buf), GST_BUFFER_SIZE(buf));
+	}
+}
+
+
+static GstFlowReturn mmap_buffer(GstBaseSrc *basesrc, const char *path, int fd, guint64 offset, size_t size, GstBuffer **buf)
+{
+	void *data;
+	GstFlowReturn result = GST_FLOW_OK;
+
+	data = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+	if(data == MAP_FAILED) {
+		GST_ELEMENT_ERROR(basesrc, RESOURCE, READ, (NULL), ("mmap('%s') failed: %s", path, strerror(errno)));
+		result = GST_FLOW_ERROR;
+		goto done;
+	}
+	*buf = gst_buffer_new();
+	if(!*buf) {
+		munmap(data, size);
+		result = GST_FLOW_ERROR;
+		goto done;
+	}
+	GST_BUFFER_FLAG_SET(*buf, GST_BUFFER_FLAG_READONLY);
+	GST_BUFFER_DATA(*buf) = data;
+	GST_BUFFER_SIZE(*buf) = size;
+	GST_BUFFER_OFFSET(*buf) = offset;
+	GST_BUFFER_OFFSET_END(*buf) = offset + size;
+	gst_buffer_set_caps(*buf, GST_PAD_CAPS(GST_BASE_SRC_PAD(basesrc)));
+
+	/*
+	 * same trick as lal_cachesrc:  the mallocdata pointer is the
+	 * buffer itself so the freefunc can find the data pointer and the
+	 * size
+	 */
+
+	GST_BUFFER_MALLOCDATA(*buf) = (void *) *buf;
+	GST_BUFFER_FREE_FUNC(*buf) = (GFreeFunc) munmap_buffer;
+
+done:
+	return result;
+}
+
+
+/*
+ * load a frame file into a buffer.  a file that has vanished or is empty
+ * is not an error:  GST_FLOW_OK is returned with *buf set to NULL, and the
+ * missing-file logic takes care of it.
+ */
+
+
+static GstFlowReturn load_file(GstLALDirWatchSrc *element, const struct frame_file *file, GstBuffer **buf)
+{
+	GstBaseSrc *basesrc = GST_BASE_SRC(element);
+	struct stat statinfo;
+	int fd;
+	GstFlowReturn result = GST_FLOW_OK;
+
+	*buf = NULL;
+
+	fd = open(file->path, O_RDONLY);
+	if(fd < 0) {
+		GST_WARNING_OBJECT(element, "open('%s') failed: %s.  skipping", file->path, strerror(errno));
+		goto done;
+	}
+	if(fstat(fd, &statinfo)) {
+		GST_ELEMENT_ERROR(element, RESOURCE, READ, (NULL), ("fstat('%s') failed: %s", file->path, strerror(errno)));
+		result = GST_FLOW_ERROR;
+		goto done;
+	}
+	if(!statinfo.st_size) {
+		GST_WARNING_OBJECT(element, "'%s' is empty.  skipping", file->path);
+		goto done;
+	}
+
+	if(element->use_mmap)
+		result = mmap_buffer(basesrc, file->path, fd, basesrc->offset, statinfo.st_size, buf);
+	else
+		result = read_buffer(basesrc, file->path, fd, basesrc->offset, statinfo.st_size, buf);
+
+done:
+	if(fd >= 0)
+		close(fd);
+	return result;
+}
+
+
+/*
+ * 0-length buffer marking the stream as complete up to t
+ */
+
+
+static GstBuffer *heart_beat_buffer(GstLALDirWatchSrc *element, GstClockTime t)
+{
+	GstBaseSrc *basesrc = GST_BASE_SRC(element);
+	GstBuffer *buf = gst_buffer_new();
+
+	gst_buffer_set_caps(buf, GST_PAD_CAPS(GST_BASE_SRC_PAD(basesrc)));
+	GST_BUFFER_TIMESTAMP(buf) = t;
+	GST_BUFFER_DURATION(buf) = 0;
+	GST_BUFFER_OFFSET(buf) = GST_BUFFER_OFFSET_END(buf) = basesrc->offset;
+
+	return buf;
+}
+
+
+/*
+ * ============================================================================
+ *
+ *                             GstBaseSrc Methods
+ *
+ * ============================================================================
+ */
+
+
+/*
+ * start()
+ */
+
+
+static gboolean start(GstBaseSrc *basesrc)
+{
+	GstLALDirWatchSrc *element = GSTLAL_DIRWATCHSRC(basesrc);
+	GError *error = NULL;
+
+	g_return_val_if_fail(element->location != NULL, FALSE);
+	g_return_val_if_fail(element->inotify_fd < 0, FALSE);
+
+	if(element->src_regex) {
+		element->src_re = g_regex_new(element->src_regex, G_REGEX_OPTIMIZE, 0, &error);
+		if(!element->src_re)
+			goto regex_error;
+	}
+	if(element->dsc_regex) {
+		element->dsc_re = g_regex_new(element->dsc_regex, G_REGEX_OPTIMIZE, 0, &error);
+		if(!element->dsc_re)
+			goto regex_error;
+	}
+
+	element->inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if(element->inotify_fd < 0) {
+		GST_ELEMENT_ERROR(element, RESOURCE, OPEN_READ, (NULL), ("inotify_init1() failed: %s", strerror(errno)));
+		goto error;
+	}
+	if(inotify_add_watch(element->inotify_fd, element->location, IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR) < 0) {
+		GST_ELEMENT_ERROR(element, RESOURCE, OPEN_READ, (NULL), ("cannot watch '%s': %s", element->location, strerror(errno)));
+		goto error;
+	}
+	GST_DEBUG_OBJECT(element, "watching '%s'", element->location);
+
+	/*
+	 * list the directory after the watch is in place so that no file
+	 * can slip between the two
+	 */
+
+	element->preexisting = list_directory(element);
+
+	element->poll = gst_poll_new(TRUE);
+	gst_poll_fd_init(&element->pollfd);
+	element->pollfd.fd = element->inotify_fd;
+	gst_poll_add_fd(element->poll, &element->pollfd);
+	gst_poll_fd_ctl_read(element->poll, &element->pollfd, TRUE);
+
+	element->pending = g_queue_new();
+	element->next_timestamp = GST_CLOCK_TIME_NONE;
+	element->last_duration = GST_CLOCK_TIME_NONE;
+	element->need_discont = TRUE;
+	element->need_new_segment = TRUE;
+	basesrc->offset = 0;
+
+	GST_OBJECT_LOCK(element);
+	element->latency = 0;
+	element->max_latency = 0;
+	element->files_received = 0;
+	element->files_missing = 0;
+	GST_OBJECT_UNLOCK(element);
+
+	return TRUE;
+
+regex_error:
+	GST_ELEMENT_ERROR(element, LIBRARY, SETTINGS, (NULL), ("invalid regex: %s", error->message));
+	g_error_free(error);
+error:
+	if(element->inotify_fd >= 0)
+		close(element->inotify_fd);
+	element->inotify_fd = -1;
+	if(element->src_re)
+		g_regex_unref(element->src_re);
+	element->src_re = NULL;
+	if(element->dsc_re)
+		g_regex_unref(element->dsc_re);
+	element->dsc_re = NULL;
+	return FALSE;
+}
+
+
+/*
+ * stop()
+ */
+
+
+static gboolean stop(GstBaseSrc *basesrc)
+{
+	GstLALDirWatchSrc *element = GSTLAL_DIRWATCHSRC(basesrc);
+
+	if(element->poll) {
+		gst_poll_free(element->poll);
+		element->poll = NULL;
+	}
+	if(element->inotify_fd >= 0) {
+		close(element->inotify_fd);
+		element->inotify_fd = -1;
+	}
+	if(element->pending) {
+		g_queue_foreach(element->pending, (GFunc) frame_file_free, NULL);
+		g_queue_free(element->pending);
+		element->pending = NULL;
+	}
+	if(element->preexisting) {
+		g_hash_table_unref(element->preexisting);
+		element->preexisting = NULL;
+	}
+	if(element->src_re) {
+		g_regex_unref(element->src_re);
+		element->src_re = NULL;
+	}
+	if(element->dsc_re) {
+		g_regex_unref(element->dsc_re);
+		element->dsc_re = NULL;
+	}
+
+	return TRUE;
+}
+
+
+/*
+ * unlock()
+ */
+
+
+static gboolean unlock(GstBaseSrc *basesrc)
+{
+	GstLALDirWatchSrc *element = GSTLAL_DIRWATCHSRC(basesrc);
+
+	if(element->poll)
+		gst_poll_set_flushing(element->poll, TRUE);
+
+	return TRUE;
+}
+
+
+/*
+ * unlock_stop()
+ */
+
+
+static gboolean unlock_stop(GstBaseSrc *basesrc)
+{
+	GstLALDirWatchSrc *element = GSTLAL_DIRWATCHSRC(basesrc);
+
+	if(element->poll)
+		gst_poll_set_flushing(element->poll, FALSE);
+
+	return TRUE;
+}
+
+
+/*
+ * is_seekable()
+ */
+
+
+static gboolean is_seekable(GstBaseSrc *basesrc)
+{
+	return FALSE;
+}
+
+
+/*
+ * create()
+ */
+
+
+static GstFlowReturn create(GstBaseSrc *basesrc, guint64 offset, guint size, GstBuffer **buf)
+{
+	GstLALDirWatchSrc *element = GSTLAL_DIRWATCHSRC(basesrc);
+	struct frame_file *file;
+	GstClockTime now;
+	GstFlowReturn result = GST_FLOW_OK;
+
+	*buf = NULL;	/* just in case */
+
+	while(1) {
+		GstClockTime deadline = GST_CLOCK_TIME_NONE;
+
+		if(!read_events(element))
+			return GST_FLOW_ERROR;
+
+		/*
+		 * discard files that arrived after having been declared
+		 * missing
+		 */
+
+		while((file = g_queue_peek_head(element->pending)) && GST_CLOCK_TIME_IS_VALID(element->next_timestamp) && file->t0 < element->next_timestamp) {
+			GST_WARNING_OBJECT(element, "discarding '%s': arrived after being declared missing", file->path);
+			frame_file_free(g_queue_pop_head(element->pending));
+		}
+
+		/*
+		 * next file is available?
+		 */
+
+		if(file && (!GST_CLOCK_TIME_IS_VALID(element->next_timestamp) || file->t0 == element->next_timestamp)) {
+			g_queue_pop_head(element->pending);
+			result = load_file(element, file, buf);
+			if(result != GST_FLOW_OK || *buf)
+				break;
+			frame_file_free(file);
+			continue;
+		}
+
+		/*
+		 * has the next file been missing too long?  if so, declare
+		 * it missing, or if a later file has arrived declare the
+		 * whole interval up to that file missing.
+		 */
+
+		now = gps_now(element);
+		if(GST_CLOCK_TIME_IS_VALID(element->next_timestamp) && element->wait_time >= 0.) {
+			deadline = element->next_timestamp + element->last_duration + (GstClockTime) (element->wait_time * GST_SECOND);
+			if(now >= deadline) {
+				GstClockTime t = file ? file->t0 : element->next_timestamp + element->last_duration;
+				GST_WARNING_OBJECT(element, "data missing in [%" GST_TIME_SECONDS_FORMAT ", %" GST_TIME_SECONDS_FORMAT "), pushing heart-beat", GST_TIME_SECONDS_ARGS(element->next_timestamp), GST_TIME_SECONDS_ARGS(t));
+				*buf = heart_beat_buffer(element, t);
+				element->next_timestamp = t;
+				element->need_discont = TRUE;
+				GST_OBJECT_LOCK(element);
+				element->files_missing++;
+				GST_OBJECT_UNLOCK(element);
+				return GST_FLOW_OK;
+			}
+		}
+
+		/*
+		 * wait for something to happen
+		 */
+
+		if(gst_poll_wait(element->poll, GST_CLOCK_TIME_IS_VALID(deadline) ? deadline - now : GST_CLOCK_TIME_NONE) < 0) {
+			if(errno == EBUSY) {
+				GST_DEBUG_OBJECT(element, "unlock() called, no buffer created");
+				return GST_FLOW_WRONG_STATE;
+			}
+			if(errno != EINTR && errno != EAGAIN) {
+				GST_ELEMENT_ERROR(element, RESOURCE, READ, (NULL), ("gst_poll_wait() failed: %s", strerror(errno)));
+				return GST_FLOW_ERROR;
+			}
+		}
+	}
+	if(result != GST_FLOW_OK)
+		goto done;
+
+	/*
+	 * finish setting buffer metadata
+	 */
+
+	GST_BUFFER_TIMESTAMP(*buf) = file->t0;
+	GST_BUFFER_DURATION(*buf) = file->dt;
+	basesrc->offset = GST_BUFFER_OFFSET_END(*buf);
+	if(element->need_discont || GST_BUFFER_TIMESTAMP(*buf) != element->next_timestamp) {
+		GST_BUFFER_FLAG_SET(*buf, GST_BUFFER_FLAG_DISCONT);
+		element->need_discont = FALSE;
+	}
+	element->next_timestamp = file->t0 + file->dt;
+
+	/*
+	 * from here on enqueue_file() discards anything that precedes the
+	 * stream, the start-up listing is no longer needed
+	 */
+
+	if(element->preexisting) {
+		g_hash_table_unref(element->preexisting);
+		element->preexisting = NULL;
+	}
+
+	/*
+	 * the latency we report depends on the file duration.  tell the
+	 * pipeline to ask again when it changes.
+	 */
+
+	if(file->dt != element->last_duration) {
+		GST_OBJECT_LOCK(element);
+		element->last_duration = file->dt;
+		GST_OBJECT_UNLOCK(element);
+		gst_element_post_message(GST_ELEMENT(element), gst_message_new_latency(GST_OBJECT(element)));
+	}
+
+	if(element->need_new_segment) {
+		gst_base_src_new_seamless_segment(basesrc, GST_BUFFER_TIMESTAMP(*buf), GST_CLOCK_TIME_NONE, GST_BUFFER_TIMESTAMP(*buf));
+		element->need_new_segment = FALSE;
+	}
+
+	/*
+	 * latency is the time from the end of the data to the buffer being
+	 * pushed.  a writer whose clock is ahead of ours can make it
+	 * negative, report that as 0.
+	 */
+
+	now = gps_now(element);
+	GST_OBJECT_LOCK(element);
+	element->latency = now > element->next_timestamp ? now - element->next_timestamp : 0;
+	element->max_latency = MAX(element->max_latency, element->latency);
+	element->files_received++;
+	GST_OBJECT_UNLOCK(element);
+
+	GST_DEBUG_OBJECT(element, "pushing '%s' spanning %" GST_BUFFER_BOUNDARIES_FORMAT, file->path, GST_BUFFER_BOUNDARIES_ARGS(*buf));
+
+done:
+	frame_file_free(file);
+	return result;
+}
+
+
+/*
+ * query()
+ */
+
+
+static gboolean query(GstBaseSrc *basesrc, GstQuery *query)
+{
+	GstLALDirWatchSrc *element = GSTLAL_DIRWATCHSRC(basesrc);
+	gboolean success = TRUE;
+
+	switch(GST_QUERY_TYPE(query)) {
+	case GST_QUERY_FORMATS:
+		gst_query_set_formats(query, 1, GST_FORMAT_TIME);
+		break;
+
+	case GST_QUERY_LATENCY: {
+		/*
+		 * a file cannot be loaded before the last sample in it has
+		 * been written, so the minimum latency is one file
+		 * duration.  a file can be waited on for wait-time seconds
+		 * beyond that before a heart-beat is pushed in its place;
+		 * with no wait-time there is no upper bound.  the observed
+		 * latency is available from the latency and max-latency
+		 * properties.
+		 */
+		GstClockTime min_latency, max_latency;
+		GST_OBJECT_LOCK(element);
+		min_latency = GST_CLOCK_TIME_IS_VALID(element->last_duration) ? element->last_duration : 0;
+		max_latency = element->wait_time >= 0. ? min_latency + (GstClockTime) (element->wait_time * GST_SECOND) : GST_CLOCK_TIME_NONE;
+		GST_OBJECT_UNLOCK(element);
+		gst_query_set_latency(query, gst_base_src_is_live(basesrc), min_latency, max_latency);
+		break;
+	}
+
+	case GST_QUERY_POSITION:
+		/* timestamp of next buffer */
+		gst_query_set_position(query, GST_FORMAT_TIME, element->next_timestamp);
+		break;
+
+	default:
+		success = parent_class->query(basesrc, query);
+		break;
+	}
+
+	if(success)
+		GST_DEBUG_OBJECT(element, "result: %" GST_PTR_FORMAT, query);
+	else
+		GST_ERROR_OBJECT(element, "query failed");
+	return success;
+}
+
+
+/*
+ * ============================================================================
+ *
+ *                              GObject Methods
+ *
+ * ============================================================================
+ */
+
+
+enum property {
+	PROP_LOCATION = 1,
+	PROP_SRC_REGEX,
+	PROP_DSC_REGEX,
+	PROP_USE_MMAP,
+	PROP_WAIT_TIME,
+	PROP_LATENCY,
+	PROP_MAX_LATENCY,
+	PROP_FILES_RECEIVED,
+	PROP_FILES_MISSING,
+};
+
+
+static void set_property(GObject *object, enum property id, const GValue *value, GParamSpec *pspec)
+{
+	GstLALDirWatchSrc *element = GSTLAL_DIRWATCHSRC(object);
+
+	GST_OBJECT_LOCK(object);
+
+	switch(id) {
+	case PROP_LOCATION:
+		g_free(element->location);
+		element->location = g_value_dup_string(value);
+		break;
+
+	case PROP_SRC_REGEX:
+		g_free(element->src_regex);
+		element->src_regex = g_value_dup_string(value);
+		break;
+
+	case PROP_DSC_REGEX:
+		g_free(element->dsc_regex);
+		element->dsc_regex = g_value_dup_string(value);
+		break;
+
+	case PROP_USE_MMAP:
+		element->use_mmap = g_value_get_boolean(value);
+		break;
+
+	case PROP_WAIT_TIME:
+		element->wait_time = g_value_get_double(value);
+		break;
+
+	default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, id, pspec);
+		break;
+	}
+
+	GST_OBJECT_UNLOCK(object);
+}
+
+
+static void get_property(GObject *object, enum property id, GValue *value, GParamSpec *pspec)
+{
+	GstLALDirWatchSrc *element = GSTLAL_DIRWATCHSRC(object);
+
+	GST_OBJECT_LOCK(object);
+
+	switch(id) {
+	case PROP_LOCATION:
+		g_value_set_string(value, element->location);
+		break;
+
+	case PROP_SRC_REGEX:
+		g_value_set_string(value, element->src_regex);
+		break;
+
+	case PROP_DSC_REGEX:
+		g_value_set_string(value, element->dsc_regex);
+		break;
+
+	case PROP_USE_MMAP:
+		g_value_set_boolean(value, element->use_mmap);
+		break;
+
+	case PROP_WAIT_TIME:
+		g_value_set_double(value, element->wait_time);
+		break;
+
+	case PROP_LATENCY:
+		g_value_set_double(value, (double) element->latency / GST_SECOND);
+		break;
+
+	case PROP_MAX_LATENCY:
+		g_value_set_double(value, (double) element->max_latency / GST_SECOND);
+		break;
+
+	case PROP_FILES_RECEIVED:
+		g_value_set_uint64(value, element->files_received);
+		break;
+
+	case PROP_FILES_MISSING:
+		g_value_set_uint64(value, element->files_missing);
+		break;
+
+	default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, id, pspec);
+		break;
+	}
+
+	GST_OBJECT_UNLOCK(object);
+}
+
+
+static void finalize(GObject *object)
+{
+	GstLALDirWatchSrc *element = GSTLAL_DIRWATCHSRC(object);
+
+	stop(GST_BASE_SRC(object));
+	g_free(element->location);
+	element->location = NULL;
+	g_free(element->src_regex);
+	element->src_regex = NULL;
+	g_free(element->dsc_regex);
+	element->dsc_regex = NULL;
+
+	G_OBJECT_CLASS(parent_class)->finalize(object);
+}
+
+
+static void gstlal_dirwatchsrc_base_init(gpointer klass)
+{
+}
+
+
+static void gstlal_dirwatchsrc_class_init(GstLALDirWatchSrcClass *klass)
+{
+	GObjectClass *gobject_class = G_OBJECT_CLASS(klass);
+	GstElementClass *element_class = GST_ELEMENT_CLASS(klass);
+	GstBaseSrcClass *gstbasesrc_class = GST_BASE_SRC_CLASS(klass);
+
+	gobject_class->set_property = GST_DEBUG_FUNCPTR(set_property);
+	gobject_class->get_property = GST_DEBUG_FUNCPTR(get_property);
+	gobject_class->finalize = GST_DEBUG_FUNCPTR(finalize);
+
+	gstbasesrc_class->start = GST_DEBUG_FUNCPTR(start);
+	gstbasesrc_class->stop = GST_DEBUG_FUNCPTR(stop);
+	gstbasesrc_class->unlock = GST_DEBUG_FUNCPTR(unlock);
+	gstbasesrc_class->unlock_stop = GST_DEBUG_FUNCPTR(unlock_stop);
+	gstbasesrc_class->is_seekable = GST_DEBUG_FUNCPTR(is_seekable);
+	gstbasesrc_class->create = GST_DEBUG_FUNCPTR(create);
+	gstbasesrc_class->query = GST_DEBUG_FUNCPTR(query);
+
+	gst_element_class_set_details_simple(
+		element_class,
+		"LAL Frame Directory Watch Source",
+		"Source",
+		"Retrieve frame files as they are written into a directory.",
+		"The gstlal authors"
+	);
+
+	gst_element_class_add_pad_template(
+		element_class,
+		gst_pad_template_new(
+			"src",
+			GST_PAD_SRC,
+			GST_PAD_ALWAYS,
+			gst_caps_from_string(
+				"application/x-igwd-frame, " \
+				"framed = (boolean) true"
+			)
+		)
+	);
+
+	g_object_class_install_property(
+		gobject_class,
+		PROP_LOCATION,
+		g_param_spec_string(
+			"location",
+			"Location",
+			"Path to directory to watch for frame files.",
+			DEFAULT_LOCATION,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | G_PARAM_CONSTRUCT
+		)
+	);
+	g_object_class_install_property(
+		gobject_class,
+		PROP_SRC_REGEX,
+		g_param_spec_string(
+			"src-regex",
+			"Pattern",
+			"Source/Observatory regex for selecting files (e.g. \"H.*\").",
+			DEFAULT_SRC_REGEX,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | G_PARAM_CONSTRUCT
+		)
+	);
+	g_object_class_install_property(
+		gobject_class,
+		PROP_DSC_REGEX,
+		g_param_spec_string(
+			"dsc-regex",
+			"Pattern",
+			"Description regex for selecting files (e.g. \".*llhoft.*\").",
+			DEFAULT_DSC_REGEX,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | G_PARAM_CONSTRUCT
+		)
+	);
+	g_object_class_install_property(
+		gobject_class,
+		PROP_USE_MMAP,
+		g_param_spec_boolean(
+			"use-mmap",
+			"Use mmap() instead of read()",
+			"Use mmap() instead of read().",
+			DEFAULT_USE_MMAP,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | G_PARAM_CONSTRUCT
+		)
+	);
+	g_object_class_install_property(
+		gobject_class,
+		PROP_WAIT_TIME,
+		g_param_spec_double(
+			"wait-time",
+			"Wait time",
+			"Seconds past the end of a missing file's interval to wait for it before declaring it missing and pushing a heart-beat buffer.  Negative means wait indefinitely.",
+			-G_MAXDOUBLE, G_MAXDOUBLE, DEFAULT_WAIT_TIME,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | G_PARAM_CONSTRUCT
+		)
+	);
+	g_object_class_install_property(
+		gobject_class,
+		PROP_LATENCY,
+		g_param_spec_double(
+			"latency",
+			"Latency",
+			"Seconds from the end of the most recent file's interval to the file being pushed.",
+			0, G_MAXDOUBLE, 0,
+			G_PARAM_READABLE | G_PARAM_STATIC_STRINGS
+		)
+	);
+	g_object_class_install_property(
+		gobject_class,
+		PROP_MAX_LATENCY,
+		g_param_spec_double(
+			"max-latency",
+			"Maximum latency",
+			"Largest value of the latency property since the element was started.",
+			0, G_MAXDOUBLE, 0,
+			G_PARAM_READABLE | G_PARAM_STATIC_STRINGS
+		)
+	);
+	g_object_class_install_property(
+		gobject_class,
+		PROP_FILES_RECEIVED,
+		g_param_spec_uint64(
+			"files-received",
+			"Files received",
+			"Number of frame files pushed since the element was started.",
+			0, G_MAXUINT64, 0,
+			G_PARAM_READABLE | G_PARAM_STATIC_STRINGS
+		)
+	);
+	g_object_class_install_property(
+		gobject_class,
+		PROP_FILES_MISSING,
+		g_param_spec_uint64(
+			"files-missing",
+			"Files missing",
+			"Number of times data was declared missing and a heart-beat pushed since the element was started.",
+			0, G_MAXUINT64, 0,
+			G_PARAM_READABLE | G_PARAM_STATIC_STRINGS
+		)
+	);
+}
+
+
+static void gstlal_dirwatchsrc_init(GstLALDirWatchSrc *element, GstLALDirWatchSrcClass *klass)
+{
+	gst_base_src_set_format(GST_BASE_SRC(element), GST_FORMAT_TIME);
+	gst_base_src_set_live(GST_BASE_SRC(element), TRUE);
+
+	element->location = NULL;
+	element->src_regex = NULL;
+	element->dsc_regex = NULL;
+	element->latency = 0;
+	element->max_latency = 0;
+	element->files_received = 0;
+	element->files_missing = 0;
+	element->inotify_fd = -1;
+	element->poll = NULL;
+	element->src_re = NULL;
+	element->dsc_re = NULL;
+	element->pending = NULL;
+	element->preexisting = NULL;
+	element->next_timestamp = GST_CLOCK_TIME_NONE;
+	element->last_duration = GST_CLOCK_TIME_NONE;
+}
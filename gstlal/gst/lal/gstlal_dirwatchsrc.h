@@ -0,0 +1,141 @@
+/*
+ * GstLALDirWatchSrc
+ *
+ * Copyright (C) 2026  The gstlal authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifndef __GSTLAL_DIRWATCHSRC_H__
+#define __GSTLAL_DIRWATCHSRC_H__
+
+
+/*
+ * ============================================================================
+ *
+ *                                  Preamble
+ *
+ * ============================================================================
+ */
+
+
+#include <glib.h>
+#include <gst/gst.h>
+#include <gst/base/gstbasesrc.h>
+
+
+G_BEGIN_DECLS
+
+
+/*
+ * ============================================================================
+ *
+ *                                    Type
+ *
+ * ============================================================================
+ */
+
+
+#define GSTLAL_DIRWATCHSRC_TYPE \
+	(gstlal_dirwatchsrc_get_type())
+#define GSTLAL_DIRWATCHSRC(obj) \
+	(G_TYPE_CHECK_INSTANCE_CAST((obj), GSTLAL_DIRWATCHSRC_TYPE, GstLALDirWatchSrc))
+#define GSTLAL_DIRWATCHSRC_CLASS(klass) \
+	(G_TYPE_CHECK_CLASS_CAST((klass), GSTLAL_DIRWATCHSRC_TYPE, GstLALDirWatchSrcClass))
+#define GSTLAL_DIRWATCHSRC_GET_CLASS(obj) \
+	(G_TYPE_INSTANCE_GET_CLASS((obj), GSTLAL_DIRWATCHSRC_TYPE, GstLALDirWatchSrcClass))
+#define GST_IS_LAL_DIRWATCHSRC(obj) \
+	(G_TYPE_CHECK_INSTANCE_TYPE((obj), GSTLAL_DIRWATCHSRC_TYPE))
+#define GST_IS_LAL_DIRWATCHSRC_CLASS(klass) \
+	(G_TYPE_CHECK_CLASS_TYPE((klass), GSTLAL_DIRWATCHSRC_TYPE))
+
+
+typedef struct _GstLALDirWatchSrc GstLALDirWatchSrc;
+typedef struct _GstLALDirWatchSrcClass GstLALDirWatchSrcClass;
+
+
+/**
+ * GstLALDirWatchSrc:
+ */
+
+
+struct _GstLALDirWatchSrc {
+	GstBaseSrc basesrc;
+
+	/*
+	 * properties
+	 */
+
+	gchar *location;
+	gchar *src_regex;
+	gchar *dsc_regex;
+	gboolean use_mmap;
+	gdouble wait_time;
+
+	/*
+	 * latency counters, protected by the object lock
+	 */
+
+	GstClockTime latency;
+	GstClockTime max_latency;
+	guint64 files_received;
+	guint64 files_missing;
+
+	/*
+	 * state
+	 */
+
+	int inotify_fd;
+	GstPoll *poll;
+	GstPollFD pollfd;
+	GRegex *src_re;
+	GRegex *dsc_re;
+	GQueue *pending;
+	GHashTable *preexisting;
+	GstClockTime next_timestamp;
+	GstClockTime last_duration;
+	gboolean need_discont;
+	gboolean need_new_segment;
+};
+
+
+/**
+ * GstLALDirWatchSrcClass:
+ * @parent_class:  the parent class
+ */
+
+
+struct _GstLALDirWatchSrcClass {
+	GstBaseSrcClass parent_class;
+};
+
+
+/*
+ * ============================================================================
+ *
+ *                                Exported API
+ *
+ * ============================================================================
+ */
+
+
+GType gstlal_dirwatchsrc_get_type(void);
+
+
+G_END_DECLS
+
+
+#endif	/* __GSTLAL_DIRWATCHSRC_H__ */
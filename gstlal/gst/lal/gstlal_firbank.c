@@ -104,6 +104,7 @@
 #include <gstlal/gstaudioadapter.h>
 #include <gstlal/gstlal_debug.h>
 #include <gstlal/gstlal.h>
+#include <gstlal/gstlal_fftw.h>
 #include <gstlal_firbank.h>
 
 
@@ -375,18 +376,16 @@ static int create_fdd_workspace(GSTLALFIRBank *element)
 	 * frequency-domain input
 	 */
 
-	gstlal_fftw_lock();
-
 	GST_LOG_OBJECT(element, "starting FFTW planning");
 	element->workspace.fdd.input = (complex double *) fftw_malloc(length_fd * sizeof(*element->workspace.fdd.input));
-	element->workspace.fdd.in_plan = fftw_plan_dft_r2c_1d(fft_block_length(element), (double *) element->workspace.fdd.input, element->workspace.fdd.input, FFTW_MEASURE);
+	element->workspace.fdd.in_plan = gstlal_fftw_plan_dft_r2c_1d(fft_block_length(element), (double *) element->workspace.fdd.input, element->workspace.fdd.input, FFTW_MEASURE);
 
 	/*
 	 * frequency-domain workspace
 	 */
 
 	element->workspace.fdd.filtered = (complex double *) fftw_malloc(length_fd * sizeof(*element->workspace.fdd.filtered));
-	element->workspace.fdd.out_plan = fftw_plan_dft_c2r_1d(fft_block_length(element), element->workspace.fdd.filtered, (double *) element->workspace.fdd.filtered, FFTW_MEASURE);
+	element->workspace.fdd.out_plan = gstlal_fftw_plan_dft_c2r_1d(fft_block_length(element), element->workspace.fdd.filtered, (double *) element->workspace.fdd.filtered, FFTW_MEASURE);
 	GST_LOG_OBJECT(element, "FFTW planning complete");
 
 	/*
@@ -399,14 +398,12 @@ static int create_fdd_workspace(GSTLALFIRBank *element)
 
 	element->workspace.fdd.working_fir_matrix = (complex double *) fftw_malloc(fir_channels(element) * length_fd * sizeof(*element->workspace.fdd.working_fir_matrix));
 
-	gstlal_fftw_unlock();
-
 	for(i = 0; i < fir_channels(element); i++) {
 		unsigned j;
 		memset(element->workspace.fdd.input, 0, length_fd * sizeof(*element->workspace.fdd.input));
 		for(j = 0; j < fir_length(element); j++)
 			((double *) element->workspace.fdd.input)[j] = gsl_matrix_get(element->fir_matrix, i, j) / fft_block_length(element);
-		fftw_execute(element->workspace.fdd.in_plan);
+		fftw_execute_dft_r2c(element->workspace.fdd.in_plan, (double *) element->workspace.fdd.input, element->workspace.fdd.input);
 		for(j = 0; j < length_fd; j++)
 			element->workspace.fdd.working_fir_matrix[i * length_fd + j] = conj(element->workspace.fdd.input[j]);
 	}
@@ -421,20 +418,16 @@ static int create_fdd_workspace(GSTLALFIRBank *element)
 
 static void free_fdd_workspace(GSTLALFIRBank *element)
 {
-	gstlal_fftw_lock();
-
 	fftw_free(element->workspace.fdd.working_fir_matrix);
 	element->workspace.fdd.working_fir_matrix = NULL;
 	fftw_free(element->workspace.fdd.input);
 	element->workspace.fdd.input = NULL;
-	fftw_destroy_plan(element->workspace.fdd.in_plan);
+	gstlal_fftw_plan_release(element->workspace.fdd.in_plan);
 	element->workspace.fdd.in_plan = NULL;
 	fftw_free(element->workspace.fdd.filtered);
 	element->workspace.fdd.filtered = NULL;
-	fftw_destroy_plan(element->workspace.fdd.out_plan);
+	gstlal_fftw_plan_release(element->workspace.fdd.out_plan);
 	element->workspace.fdd.out_plan = NULL;
-
-	gstlal_fftw_unlock();
 }
 
 
@@ -447,18 +440,16 @@ static int create_fds_workspace(GSTLALFIRBank *element)
 	 * frequency-domain input
 	 */
 
-	gstlal_fftw_lock();
-
 	GST_LOG_OBJECT(element, "starting FFTW planning");
 	element->workspace.fds.input = (complex float *) fftwf_malloc(length_fd * sizeof(*element->workspace.fds.input));
-	element->workspace.fds.in_plan = fftwf_plan_dft_r2c_1d(fft_block_length(element), (float *) element->workspace.fds.input, element->workspace.fds.input, FFTW_MEASURE);
+	element->workspace.fds.in_plan = gstlal_fftwf_plan_dft_r2c_1d(fft_block_length(element), (float *) element->workspace.fds.input, element->workspace.fds.input, FFTW_MEASURE);
 
 	/*
 	 * frequency-domain workspace
 	 */
 
 	element->workspace.fds.filtered = (complex float *) fftwf_malloc(length_fd * sizeof(*element->workspace.fds.filtered));
-	element->workspace.fds.out_plan = fftwf_plan_dft_c2r_1d(fft_block_length(element), element->workspace.fds.filtered, (float *) element->workspace.fds.filtered, FFTW_MEASURE);
+	element->workspace.fds.out_plan = gstlal_fftwf_plan_dft_c2r_1d(fft_block_length(element), element->workspace.fds.filtered, (float *) element->workspace.fds.filtered, FFTW_MEASURE);
 	GST_LOG_OBJECT(element, "FFTW planning complete");
 
 	/*
@@ -471,14 +462,12 @@ static int create_fds_workspace(GSTLALFIRBank *element)
 
 	element->workspace.fds.working_fir_matrix = (complex float *) fftwf_malloc(fir_channels(element) * length_fd * sizeof(*element->workspace.fds.working_fir_matrix));
 
-	gstlal_fftw_unlock();
-
 	for(i = 0; i < fir_channels(element); i++) {
 		unsigned j;
 		memset(element->workspace.fds.input, 0, length_fd * sizeof(*element->workspace.fds.input));
 		for(j = 0; j < fir_length(element); j++)
 			((float *) element->workspace.fds.input)[j] = gsl_matrix_get(element->fir_matrix, i, j) / fft_block_length(element);
-		fftwf_execute(element->workspace.fds.in_plan);
+		fftwf_execute_dft_r2c(element->workspace.fds.in_plan, (float *) element->workspace.fds.input, element->workspace.fds.input);
 		for(j = 0; j < length_fd; j++)
 			element->workspace.fds.working_fir_matrix[i * length_fd + j] = conjf(element->workspace.fds.input[j]);
 	}
@@ -493,20 +482,16 @@ static int create_fds_workspace(GSTLALFIRBank *element)
 
 static void free_fds_workspace(GSTLALFIRBank *element)
 {
-	gstlal_fftw_lock();
-
 	fftwf_free(element->workspace.fds.working_fir_matrix);
 	element->workspace.fds.working_fir_matrix = NULL;
 	fftwf_free(element->workspace.fds.input);
 	element->workspace.fds.input = NULL;
-	fftwf_destroy_plan(element->workspace.fds.in_plan);
+	gstlal_fftwf_plan_release(element->workspace.fds.in_plan);
 	element->workspace.fds.in_plan = NULL;
 	fftwf_free(element->workspace.fds.filtered);
 	element->workspace.fds.filtered = NULL;
-	fftwf_destroy_plan(element->workspace.fds.out_plan);
+	gstlal_fftwf_plan_release(element->workspace.fds.out_plan);
 	element->workspace.fds.out_plan = NULL;
-
-	gstlal_fftw_unlock();
 }
 
 
@@ -541,8 +526,8 @@ static unsigned tddfilter(GSTLALFIRBank *element, GstBuffer *outbuf, unsigned ou
 {
 	unsigned i;
 	unsigned input_length;
-	double *input;
-	gsl_vector_view input_view;
+	const double *input;
+	gsl_vector_const_view input_view;
 	gsl_matrix_view output;
 
 	/*
@@ -564,9 +549,8 @@ static unsigned tddfilter(GSTLALFIRBank *element, GstBuffer *outbuf, unsigned ou
 	 * properly.
 	 */
 
-	input = g_malloc(input_length * sizeof(*input));
-	gst_audioadapter_copy_samples(element->adapter, input, input_length, NULL, NULL);
-	input_view = gsl_vector_view_array(input, fir_length(element));
+	input = gst_audioadapter_peek_samples(element->adapter, input_length, NULL, NULL);
+	input_view = gsl_vector_const_view_array(input, fir_length(element));
 
 	/*
 	 * wrap output buffer in a GSL matrix view.
@@ -604,7 +588,6 @@ static unsigned tddfilter(GSTLALFIRBank *element, GstBuffer *outbuf, unsigned ou
 	 * done
 	 */
 
-	g_free(input);
 	return output_length;
 }
 
@@ -613,8 +596,8 @@ static unsigned tdsfilter(GSTLALFIRBank *element, GstBuffer *outbuf, unsigned ou
 {
 	unsigned i;
 	unsigned input_length;
-	float *input;
-	gsl_vector_float_view input_view;
+	const float *input;
+	gsl_vector_float_const_view input_view;
 	gsl_matrix_float_view output;
 
 	/*
@@ -636,9 +619,8 @@ static unsigned tdsfilter(GSTLALFIRBank *element, GstBuffer *outbuf, unsigned ou
 	 * properly.
 	 */
 
-	input = g_malloc(input_length * sizeof(*input));
-	gst_audioadapter_copy_samples(element->adapter, input, input_length, NULL, NULL);
-	input_view = gsl_vector_float_view_array(input, fir_length(element));
+	input = gst_audioadapter_peek_samples(element->adapter, input_length, NULL, NULL);
+	input_view = gsl_vector_float_const_view_array(input, fir_length(element));
 
 	/*
 	 * wrap output buffer in a GSL matrix view.
@@ -676,7 +658,6 @@ static unsigned tdsfilter(GSTLALFIRBank *element, GstBuffer *outbuf, unsigned ou
 	 * done
 	 */
 
-	g_free(input);
 	return output_length;
 }
 
@@ -696,7 +677,7 @@ static unsigned fddfilter(GSTLALFIRBank *element, GstBuffer *outbuf, unsigned ou
 	unsigned stride = fft_block_stride(element);
 	unsigned filter_length_fd = fft_block_length(element) / 2 + 1;
 	unsigned input_length;
-	double *input, *malloced_input;
+	const double *input;
 	double *output_end;
 	gsl_vector_view workspace;
 	gsl_matrix_view output;
@@ -722,8 +703,7 @@ static unsigned fddfilter(GSTLALFIRBank *element, GstBuffer *outbuf, unsigned ou
 	 * retrieve input samples
 	 */
 
-	input = malloced_input = g_malloc(input_length * sizeof(*input));
-	gst_audioadapter_copy_samples(element->adapter, input, input_length, NULL, NULL);
+	input = gst_audioadapter_peek_samples(element->adapter, input_length, NULL, NULL);
 
 	/*
 	 * wrap workspace (as real numbers) in a GSL vector view.  note
@@ -761,7 +741,7 @@ static unsigned fddfilter(GSTLALFIRBank *element, GstBuffer *outbuf, unsigned ou
 		 */
 
 		memcpy(element->workspace.fdd.input, input, fft_block_length(element) * sizeof(*input));
-		fftw_execute(element->workspace.fdd.in_plan);
+		fftw_execute_dft_r2c(element->workspace.fdd.in_plan, (double *) element->workspace.fdd.input, element->workspace.fdd.input);
 
 		/*
 		 * loop over filters
@@ -784,7 +764,7 @@ static unsigned fddfilter(GSTLALFIRBank *element, GstBuffer *outbuf, unsigned ou
 			complex double *workspace_fd = element->workspace.fdd.filtered;
 			for(last_input = input + filter_length_fd; input < last_input; )
 				*(workspace_fd++) = *(input++) * *(filter++);
-			fftw_execute(element->workspace.fdd.out_plan);
+			fftw_execute_dft_c2r(element->workspace.fdd.out_plan, element->workspace.fdd.filtered, (double *) element->workspace.fdd.filtered);
 			gsl_matrix_set_col(&output.matrix, j, &workspace.vector);
 		}
 
@@ -800,7 +780,6 @@ static unsigned fddfilter(GSTLALFIRBank *element, GstBuffer *outbuf, unsigned ou
 	 * done
 	 */
 
-	g_free(malloced_input);
 	return output_length;
 }
 
@@ -810,7 +789,7 @@ static unsigned fdsfilter(GSTLALFIRBank *element, GstBuffer *outbuf, unsigned ou
 	unsigned stride = fft_block_stride(element);
 	unsigned filter_length_fd = fft_block_length(element) / 2 + 1;
 	unsigned input_length;
-	float *input, *malloced_input;
+	const float *input;
 	float *output_end;
 	gsl_vector_float_view workspace;
 	gsl_matrix_float_view output;
@@ -836,8 +815,7 @@ static unsigned fdsfilter(GSTLALFIRBank *element, GstBuffer *outbuf, unsigned ou
 	 * retrieve input samples
 	 */
 
-	input = malloced_input = g_malloc(input_length * sizeof(*input));
-	gst_audioadapter_copy_samples(element->adapter, input, input_length, NULL, NULL);
+	input = gst_audioadapter_peek_samples(element->adapter, input_length, NULL, NULL);
 
 	/*
 	 * wrap workspace (as real numbers) in a GSL vector view.  note
@@ -875,7 +853,7 @@ static unsigned fdsfilter(GSTLALFIRBank *element, GstBuffer *outbuf, unsigned ou
 		 */
 
 		memcpy(element->workspace.fds.input, input, fft_block_length(element) * sizeof(*input));
-		fftwf_execute(element->workspace.fds.in_plan);
+		fftwf_execute_dft_r2c(element->workspace.fds.in_plan, (float *) element->workspace.fds.input, element->workspace.fds.input);
 
 		/*
 		 * loop over filters
@@ -898,7 +876,7 @@ static unsigned fdsfilter(GSTLALFIRBank *element, GstBuffer *outbuf, unsigned ou
 			complex float *workspace_fd = element->workspace.fds.filtered;
 			for(last_input = input + filter_length_fd; input < last_input; )
 				*(workspace_fd++) = *(input++) * *(filter++);
-			fftwf_execute(element->workspace.fds.out_plan);
+			fftwf_execute_dft_c2r(element->workspace.fds.out_plan, element->workspace.fds.filtered, (float *) element->workspace.fds.filtered);
 			gsl_matrix_float_set_col(&output.matrix, j, &workspace.vector);
 		}
 
@@ -914,7 +892,6 @@ static unsigned fdsfilter(GSTLALFIRBank *element, GstBuffer *outbuf, unsigned ou
 	 * done
 	 */
 
-	g_free(malloced_input);
 	return output_length;
 }
 
@@ -132,23 +132,31 @@ static int mark_segments(GSTLALSegmentSrc *element, GstBuffer *buffer)
     guint8 *data = GST_BUFFER_DATA(buffer);
     GstClockTime start = GST_BUFFER_TIMESTAMP(buffer);
     GstClockTime stop = GST_BUFFER_TIMESTAMP(buffer) + GST_BUFFER_DURATION(buffer);
-    gint i;
+    const struct gstlal_segment *seg;
+    gint n;
 
-    /* This is ridiculous, but doesn't require sorted or coalesced
-     * segments.  Could some fancy data structure help? */
-    for (i = 0; i < element->seglist->length; i++) {
+    g_mutex_lock(element->segment_matrix_lock);
+    if(!element->segindex) {
+        g_mutex_unlock(element->segment_matrix_lock);
+        return 0;
+    }
+
+    /* the index is sorted and coalesced, so only the segments that
+     * intersect the buffer are visited.  buffers are normally produced
+     * in order, so the cursor makes the search O(1) */
+    for (n = gstlal_segment_index_get_range(element->segindex, start, stop, &element->segcursor, &seg); n--; seg++) {
     	/* clip segment to buffer */
-        GstClockTime segstart = CLAMP(element->seglist->segments[i].start, start, stop);
-        GstClockTime segstop  = CLAMP(element->seglist->segments[i].stop,  start, stop);
+        GstClockTime segstart = CLAMP(seg->start, start, stop);
+        GstClockTime segstop  = CLAMP(seg->stop,  start, stop);
 
 	/* convert to samples */
 	guint64 startix = gst_util_uint64_scale_int_round(segstart - start, element->rate, GST_SECOND);
 	guint64 stopix  = gst_util_uint64_scale_int_round(segstop  - start, element->rate, GST_SECOND);
 
 	/* set samples */
-	for(; startix < stopix; startix++)
-		data[startix] = element->invert_output ? 0 : 0x80;
+	memset(&data[startix], element->invert_output ? 0 : 0x80, stopix - startix);
     }
+    g_mutex_unlock(element->segment_matrix_lock);
 
     return 0;
 }
@@ -385,7 +393,10 @@ static void set_property(GObject *object, enum property prop_id, const GValue *v
         case ARG_SEGMENT_LIST:
             g_mutex_lock(element->segment_matrix_lock);
             gstlal_segment_list_free(element->seglist);
+            gstlal_segment_index_free(element->segindex);
             element->seglist = gstlal_segment_list_from_g_value_array(g_value_get_boxed(value));
+            element->segindex = element->seglist ? gstlal_segment_index_new(element->seglist) : NULL;
+            element->segcursor = 0;
             g_mutex_unlock(element->segment_matrix_lock);
             break;
         case ARG_INVERT_OUTPUT:
@@ -448,6 +459,8 @@ static void finalize(GObject *object)
 
     gstlal_segment_list_free(element->seglist);
     element->seglist = NULL;
+    gstlal_segment_index_free(element->segindex);
+    element->segindex = NULL;
     g_mutex_free(element->segment_matrix_lock);
     element->segment_matrix_lock = NULL;
 
@@ -569,6 +582,8 @@ static void gstlal_segmentsrc_class_init(GSTLALSegmentSrcClass *klass)
 static void gstlal_segmentsrc_init(GSTLALSegmentSrc *segment_src, GSTLALSegmentSrcClass *klass)
 {
     segment_src->seglist = NULL;
+    segment_src->segindex = NULL;
+    segment_src->segcursor = 0;
     segment_src->rate = 0;
     segment_src->segment_matrix_lock = g_mutex_new();
     gst_base_src_set_format(GST_BASE_SRC(segment_src), GST_FORMAT_TIME);
@@ -31,6 +31,8 @@ struct _GSTLALSegmentSrc {
 
     GMutex			*segment_matrix_lock;
     struct gstlal_segment_list	*seglist;
+    struct gstlal_segment_index	*segindex;
+    gint			segcursor;
     gboolean			invert_output;
     gint			rate;
 };
@@ -321,6 +321,189 @@ static int sim_inspiral_strain(REAL8TimeSeries **strain, SimInspiralTable *sim_i
 }
 
 
+/*
+ * Look-ahead waveform generation.  When the lookahead property is > 0,
+ * injections that will be reached within that many seconds of the end of
+ * the current buffer are taken off the injection list and handed to a
+ * pool of worker threads, which run them in order of geocent_end_time and
+ * project them onto the detector.  The list of jobs is owned by the
+ * streaming thread;  a worker publishes its result by atomically setting
+ * the job's done flag, so picking up a finished waveform takes no lock.
+ * Only if the data catches up with a job still in progress does the
+ * streaming thread block, on injection_done.
+ */
+
+
+struct injection_job {
+	SimInspiralTable *sim_inspiral;
+	LALDetector detector;
+	double deltaT;
+	LIGOTimeGPS start;	/* padded geocentre start of the waveform */
+	REAL8TimeSeries *strain;	/* NULL if generation failed */
+	volatile gint done;
+	struct injection_job *next;
+};
+
+
+static void injection_job_free(struct injection_job *job)
+{
+	if(job) {
+		XLALFree(job->sim_inspiral);
+		XLALDestroyREAL8TimeSeries(job->strain);
+	}
+	g_free(job);
+}
+
+
+static gint injection_job_compare(gconstpointer a, gconstpointer b, gpointer user_data)
+{
+	const struct injection_job *job_a = a;
+	const struct injection_job *job_b = b;
+
+	return XLALGPSCmp(&job_a->sim_inspiral->geocent_end_time, &job_b->sim_inspiral->geocent_end_time);
+}
+
+
+static void injection_job_run(gpointer data, gpointer user_data)
+{
+	struct injection_job *job = data;
+	GSTLALSimulation *element = GSTLAL_SIMULATION(user_data);
+
+	if(sim_inspiral_strain(&job->strain, job->sim_inspiral, job->deltaT, job->detector)) {
+		XLALPrintError("%s(): failure generating injection at %d.%09d\n", __func__, job->sim_inspiral->geocent_end_time.gpsSeconds, job->sim_inspiral->geocent_end_time.gpsNanoSeconds);
+		XLALClearErrno();
+		job->strain = NULL;
+	}
+
+	g_mutex_lock(element->injection_lock);
+	g_atomic_int_set(&job->done, 1);
+	g_cond_broadcast(element->injection_done);
+	g_mutex_unlock(element->injection_lock);
+}
+
+
+static void injection_job_wait(GSTLALSimulation *element, struct injection_job *job)
+{
+	if(g_atomic_int_get(&job->done))
+		return;
+	GST_DEBUG_OBJECT(element, "waiting for injection at %d.%09d", job->sim_inspiral->geocent_end_time.gpsSeconds, job->sim_inspiral->geocent_end_time.gpsNanoSeconds);
+	g_mutex_lock(element->injection_lock);
+	while(!g_atomic_int_get(&job->done))
+		g_cond_wait(element->injection_done, element->injection_lock);
+	g_mutex_unlock(element->injection_lock);
+}
+
+
+static int submit_injection_job(GSTLALSimulation *element, SimInspiralTable *sim_inspiral, LIGOTimeGPS start, double deltaT, const LALDetector *detector)
+{
+	struct injection_job *job = g_new0(struct injection_job, 1);
+	struct injection_job **tail;
+
+	if(!element->injection_pool) {
+		GError *error = NULL;
+		element->injection_pool = g_thread_pool_new(injection_job_run, element, element->n_workers, TRUE, &error);
+		if(!element->injection_pool) {
+			XLALPrintError("%s(): failure starting worker threads: %s\n", __func__, error ? error->message : "unknown error");
+			g_clear_error(&error);
+			g_free(job);
+			XLAL_ERROR(XLAL_EFUNC);
+		}
+		g_thread_pool_set_sort_function(element->injection_pool, injection_job_compare, NULL);
+	}
+
+	job->sim_inspiral = sim_inspiral;
+	job->sim_inspiral->next = NULL;
+	job->detector = *detector;
+	job->deltaT = deltaT;
+	job->start = start;
+
+	/* keep the list in submission order */
+	for(tail = &element->injection_jobs; *tail; tail = &(*tail)->next);
+	*tail = job;
+
+	g_thread_pool_push(element->injection_pool, job, NULL);
+	return 0;
+}
+
+
+/*
+ * Stop the workers and discard all outstanding jobs
+ */
+
+
+static void stop_injection_workers(GSTLALSimulation *element)
+{
+	if(element->injection_pool) {
+		/* drop queued jobs, wait for running ones */
+		g_thread_pool_free(element->injection_pool, TRUE, TRUE);
+		element->injection_pool = NULL;
+	}
+	while(element->injection_jobs) {
+		struct injection_job *next = element->injection_jobs->next;
+		injection_job_free(element->injection_jobs);
+		element->injection_jobs = next;
+	}
+}
+
+
+/*
+ * Resize simulation_series to cover a detector strain series and add it in
+ */
+
+
+static int add_injection_series(GSTLALSimulation *element, const REAL8TimeSeries *inspiral_series, double injection_window, const COMPLEX16FrequencySeries *response)
+{
+	double DeltaT;
+
+	DeltaT = XLALGPSDiff(&inspiral_series->epoch, &element->simulation_series->epoch);
+	DeltaT += inspiral_series->data->length * inspiral_series->deltaT + injection_window;
+	DeltaT -= element->simulation_series->data->length * element->simulation_series->deltaT;
+	if(DeltaT > 0.)
+		element->simulation_series = XLALResizeREAL8TimeSeries(element->simulation_series, 0, element->simulation_series->data->length + ceil(DeltaT / element->simulation_series->deltaT));
+	if(!element->simulation_series)
+		XLAL_ERROR(XLAL_EFUNC);
+
+	if(XLALSimAddInjectionREAL8TimeSeries(element->simulation_series, (REAL8TimeSeries *) inspiral_series, response))
+		XLAL_ERROR(XLAL_EFUNC);
+
+	GST_LOG("inspiral series epoch time (%d, %d), length %u", inspiral_series->epoch.gpsSeconds, inspiral_series->epoch.gpsNanoSeconds, inspiral_series->data->length);
+
+	return 0;
+}
+
+
+/*
+ * Add the pre-generated waveforms that the data has now reached
+ */
+
+
+static int collect_injection_jobs(GSTLALSimulation *element, const LIGOTimeGPS *hEndTime, double injection_window, const COMPLEX16FrequencySeries *response)
+{
+	struct injection_job **job_ptr = &element->injection_jobs;
+
+	while(*job_ptr) {
+		struct injection_job *job = *job_ptr;
+
+		if(XLALGPSDiff(&job->start, hEndTime) > injection_window) {
+			job_ptr = &job->next;
+			continue;
+		}
+
+		injection_job_wait(element, job);
+		if(!job->strain || add_injection_series(element, job->strain, injection_window, response)) {
+			*job_ptr = job->next;
+			injection_job_free(job);
+			XLAL_ERROR(XLAL_EFUNC);
+		}
+
+		*job_ptr = job->next;
+		injection_job_free(job);
+	}
+
+	return 0;
+}
+
+
 static int update_simulation_series(REAL8TimeSeries *h, GSTLALSimulation *element, const COMPLEX16FrequencySeries *response)
 {
 	double injTime, DeltaT, startMinusEnd, endMinusStart;
@@ -419,46 +602,46 @@ static int update_simulation_series(REAL8TimeSeries *h, GSTLALSimulation *elemen
 			continue;
 		}
 
-		if(startMinusEnd > injection_window) /* injection starts after h */ {
+		if(startMinusEnd > injection_window + element->lookahead) /* injection starts after h and the look-ahead interval */ {
 			prevSimInspiral = thisSimInspiral;
 			thisSimInspiral = thisSimInspiral->next;
 			continue;
 		}
 
 		/*
-		 * compute injection waveform
+		 * with look-ahead, remove injection from list and queue it
+		 * for the workers
 		 */
 
-		if(sim_inspiral_strain(&inspiral_series, thisSimInspiral, h->deltaT, *detector))
-			XLAL_ERROR(XLAL_EFUNC);
+		if(element->lookahead > 0.) {
+			SimInspiralTable *tmpSimInspiral = thisSimInspiral;
+			if(prevSimInspiral)
+				prevSimInspiral->next = thisSimInspiral->next;
+			if(thisSimInspiral == element->injection_document->sim_inspiral_table_head)
+				element->injection_document->sim_inspiral_table_head = thisSimInspiral->next;
+			thisSimInspiral = thisSimInspiral->next;
+			if(submit_injection_job(element, tmpSimInspiral, injStartTime, h->deltaT, detector)) {
+				XLALFree(tmpSimInspiral);
+				XLAL_ERROR(XLAL_EFUNC);
+			}
+			continue;
+		}
 
 		/*
-		 * resize simulation_series to cover this time
+		 * compute injection waveform
 		 */
 
-		DeltaT = XLALGPSDiff(&inspiral_series->epoch, &element->simulation_series->epoch);
-		DeltaT += inspiral_series->data->length * inspiral_series->deltaT + injection_window;
-		DeltaT -= element->simulation_series->data->length * element->simulation_series->deltaT;
-		if(DeltaT > 0.)
-			element->simulation_series = XLALResizeREAL8TimeSeries(element->simulation_series, 0, element->simulation_series->data->length + ceil(DeltaT / element->simulation_series->deltaT));
-		if(!element->simulation_series) {
-			XLALDestroyREAL8TimeSeries(inspiral_series);
+		if(sim_inspiral_strain(&inspiral_series, thisSimInspiral, h->deltaT, *detector))
 			XLAL_ERROR(XLAL_EFUNC);
-		}
 
 		/*
 		 * add detector strain to simulation_series
 		 */
 
-		if(XLALSimAddInjectionREAL8TimeSeries(element->simulation_series, inspiral_series, response)) {
+		if(add_injection_series(element, inspiral_series, injection_window, response)) {
 			XLALDestroyREAL8TimeSeries(inspiral_series);
 			XLAL_ERROR(XLAL_EFUNC);
 		}
-
-		// NOTE: this only works for fake frames 16khz, but txt 4k Hz
-		int len = ceil((double) inspiral_series->data->length/ 16384 * 4096 * 1.5);
-		GST_LOG("inspiral series epoch time (%d, %d), length %d\n", inspiral_series->epoch.gpsSeconds, inspiral_series->epoch.gpsNanoSeconds, len);
-		//printf("simulation series epoch time (%d, %d), length %u\n", element->simulation_series->epoch.gpsSeconds, element->simulation_series->epoch.gpsNanoSeconds, element->simulation_series->data->length);
 		XLALDestroyREAL8TimeSeries(inspiral_series);
 
 		/*
@@ -476,6 +659,13 @@ static int update_simulation_series(REAL8TimeSeries *h, GSTLALSimulation *elemen
 		}
 	}
 
+	/*
+	 * add waveforms generated ahead of time
+	 */
+
+	if(collect_injection_jobs(element, &hEndTime, injection_window, response))
+		XLAL_ERROR(XLAL_EFUNC);
+
 	return 0;
 }
 
@@ -709,7 +899,9 @@ enum property {
 	ARG_XML_LOCATION = 1,
 	ARG_INSTRUMENT,
 	ARG_CHANNEL_NAME,
-	ARG_UNITS
+	ARG_UNITS,
+	ARG_LOOKAHEAD,
+	ARG_N_WORKERS
 };
 
 
@@ -724,10 +916,21 @@ static void set_property(GObject *object, enum property id, const GValue *value,
 	case ARG_XML_LOCATION:
 		g_free(element->xml_location);
 		element->xml_location = g_value_dup_string(value);
+		stop_injection_workers(element);
 		destroy_injection_document(element->injection_document);
 		element->injection_document = NULL;
 		break;
 
+	case ARG_LOOKAHEAD:
+		element->lookahead = g_value_get_double(value);
+		break;
+
+	case ARG_N_WORKERS:
+		element->n_workers = g_value_get_uint(value);
+		if(element->injection_pool)
+			g_thread_pool_set_max_threads(element->injection_pool, element->n_workers, NULL);
+		break;
+
 	default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, id, pspec);
 		break;
@@ -760,6 +963,14 @@ static void get_property(GObject *object, enum property id, GValue *value, GPara
 		g_value_set_string(value, element->units);
 		break;
 
+	case ARG_LOOKAHEAD:
+		g_value_set_double(value, element->lookahead);
+		break;
+
+	case ARG_N_WORKERS:
+		g_value_set_uint(value, element->n_workers);
+		break;
+
 	default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, id, pspec);
 		break;
@@ -778,6 +989,11 @@ static void finalize(GObject * object)
 {
 	GSTLALSimulation *element = GSTLAL_SIMULATION(object);
 
+	stop_injection_workers(element);
+	g_mutex_free(element->injection_lock);
+	element->injection_lock = NULL;
+	g_cond_free(element->injection_done);
+	element->injection_done = NULL;
 	g_free(element->xml_location);
 	element->xml_location = NULL;
 	destroy_injection_document(element->injection_document);
@@ -909,6 +1125,28 @@ static void gstlal_simulation_class_init(GSTLALSimulationClass *klass)
 			G_PARAM_READABLE | G_PARAM_STATIC_STRINGS
 		)
 	);
+	g_object_class_install_property(
+		gobject_class,
+		ARG_LOOKAHEAD,
+		g_param_spec_double(
+			"lookahead",
+			"Look-ahead",
+			"Generate injection waveforms on worker threads this many seconds before the data reaches them.  0 generates each waveform on the streaming thread when it is needed.",
+			0, G_MAXDOUBLE, 0,
+			G_PARAM_READWRITE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS
+		)
+	);
+	g_object_class_install_property(
+		gobject_class,
+		ARG_N_WORKERS,
+		g_param_spec_uint(
+			"n-workers",
+			"Number of workers",
+			"Number of threads generating injection waveforms when lookahead is > 0.",
+			1, 256, 2,
+			G_PARAM_READWRITE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS
+		)
+	);
 }
 
 
@@ -925,6 +1163,10 @@ static void gstlal_simulation_init(GSTLALSimulation *element, GSTLALSimulationCl
 	element->channel_name = NULL;
 	element->units = NULL;
 	element->simulation_series = NULL;
+	element->injection_pool = NULL;
+	element->injection_lock = g_mutex_new();
+	element->injection_done = g_cond_new();
+	element->injection_jobs = NULL;
 
 	gst_base_transform_set_gap_aware(GST_BASE_TRANSFORM(element), TRUE);
 }
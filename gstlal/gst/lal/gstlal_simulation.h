@@ -75,6 +75,13 @@ struct _GSTLALSimulation {
 	char *units;
 
 	REAL8TimeSeries *simulation_series;
+
+	gdouble lookahead;
+	guint n_workers;
+	GThreadPool *injection_pool;
+	GMutex *injection_lock;
+	GCond *injection_done;
+	struct injection_job *injection_jobs;
 };
 
 
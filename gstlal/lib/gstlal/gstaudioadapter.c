@@ -35,6 +35,10 @@
  * be checked by checking the #GstAudioAdapter:size property, buffers
  * retrieved with gst_audioadapter_get_list_samples(), and then data
  * flushed from it with gst_audioadapter_flush_samples().
+ *
+ * Code that only needs to read the samples can use
+ * gst_audioadapter_peek_samples(), which avoids copying the data when it
+ * lies within a single non-gap #GstBuffer.
  */
 
 
@@ -103,6 +107,20 @@ static guint64 expected_offset(GstAudioAdapter *adapter)
 }
 
 
+static void *get_scratch(GstAudioAdapter *adapter, gsize size)
+{
+	/* grow geometrically so that a slowly increasing request size
+	 * doesn't cause a reallocation on every call */
+	if(size > adapter->scratch_size) {
+		gsize new_size = MAX(size, 2 * adapter->scratch_size);
+		g_free(adapter->scratch);
+		adapter->scratch = g_malloc(new_size);
+		adapter->scratch_size = new_size;
+	}
+	return adapter->scratch;
+}
+
+
 /*
  * ============================================================================
  *
@@ -413,6 +431,71 @@ done:
 }
 
 
+/**
+ * gst_audioadapter_peek_samples:
+ * @adapter: a #GstAudioAdapter
+ * @samples: the number of samples to peek at
+ * @copied_gap: if not %NULL, the address of a #gboolean that will be set to
+ * %TRUE if any gap samples were among the samples or %FALSE if all
+ * samples were not gap samples.
+ * @copied_nongap: if not %NULL, the address of a #gboolean that will be set
+ * to %TRUE if any non-gap samples were among the samples or %FALSE if all
+ * samples were gaps.
+ *
+ * Return a pointer to @samples contiguous samples from the
+ * #GstAudioAdapter's head.  If the samples lie within a single non-gap
+ * #GstBuffer the pointer addresses that #GstBuffer's data directly and no
+ * copy is made.  Otherwise the samples are assembled, as by
+ * gst_audioadapter_copy_samples(), in a scratch buffer owned by the
+ * #GstAudioAdapter and a pointer to that is returned.
+ *
+ * The memory is read-only.  It remains valid until the next call to
+ * gst_audioadapter_peek_samples(), gst_audioadapter_flush_samples() or
+ * gst_audioadapter_clear(), or until the unit size is changed.
+ *
+ * Returns: pointer to the samples, or %NULL if @samples is 0.
+ */
+
+
+const void *gst_audioadapter_peek_samples(GstAudioAdapter *adapter, guint samples, gboolean *copied_gap, gboolean *copied_nongap)
+{
+	GList *head;
+	GstBuffer *buf;
+	guint skip;
+	void *dst;
+
+	if(!samples) {
+		if(copied_gap)
+			*copied_gap = FALSE;
+		if(copied_nongap)
+			*copied_nongap = FALSE;
+		return NULL;
+	}
+	g_assert_cmpuint(samples, <=, adapter->size);
+
+	/* the first buffer with samples in it.  zero-length buffers at the
+	 * head don't prevent the samples from being used in place */
+	head = g_queue_peek_head_link(adapter->queue);
+	skip = adapter->skip;
+	while(!samples_remaining(GST_BUFFER(head->data), skip)) {
+		head = g_list_next(head);
+		skip = 0;
+	}
+	buf = GST_BUFFER(head->data);
+	if(!GST_BUFFER_FLAG_IS_SET(buf, GST_BUFFER_FLAG_GAP) && samples <= samples_remaining(buf, skip)) {
+		if(copied_gap)
+			*copied_gap = FALSE;
+		if(copied_nongap)
+			*copied_nongap = TRUE;
+		return GST_BUFFER_DATA(buf) + skip * adapter->unit_size;
+	}
+
+	dst = get_scratch(adapter, (gsize) samples * adapter->unit_size);
+	gst_audioadapter_copy_samples(adapter, dst, samples, copied_gap, copied_nongap);
+	return dst;
+}
+
+
 /**
  * gst_audioadapter_get_list_samples:
  * @adapter: a #GstAudioAdapter
@@ -554,6 +637,9 @@ static void set_property(GObject *object, enum property id, const GValue *value,
 		if(unit_size != adapter->unit_size) {
 			gst_audioadapter_clear(adapter);
 			adapter->unit_size = unit_size;
+			g_free(adapter->scratch);
+			adapter->scratch = NULL;
+			adapter->scratch_size = 0;
 		}
 	}
 		break;
@@ -601,6 +687,9 @@ static void finalize(GObject *object)
 
 	g_queue_free(adapter->queue);
 	adapter->queue = NULL;
+	g_free(adapter->scratch);
+	adapter->scratch = NULL;
+	adapter->scratch_size = 0;
 
 	G_OBJECT_CLASS(parent_class)->finalize(object);
 }
@@ -665,4 +754,6 @@ static void gst_audioadapter_init(GstAudioAdapter *adapter, GstAudioAdapterClass
 	adapter->unit_size = 0;
 	adapter->size = 0;
 	adapter->skip = 0;
+	adapter->scratch = NULL;
+	adapter->scratch_size = 0;
 }
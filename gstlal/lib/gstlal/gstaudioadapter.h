@@ -81,6 +81,8 @@ struct _GstAudioAdapter {
 	guint unit_size;	/* bytes */
 	guint size;		/* samples (units) */
 	guint skip;		/* samples (units) */
+	void *scratch;		/* see gst_audioadapter_peek_samples() */
+	gsize scratch_size;	/* bytes */
 };
 
 
@@ -118,6 +120,7 @@ guint gst_audioadapter_tail_gap_length(GstAudioAdapter *adapter);
 guint gst_audioadapter_head_nongap_length(GstAudioAdapter *adapter);
 guint gst_audioadapter_tail_nongap_length(GstAudioAdapter *adapter);
 void gst_audioadapter_copy_samples(GstAudioAdapter *adapter, void *dst, guint samples, gboolean *copied_gap, gboolean *copied_nongap);
+const void *gst_audioadapter_peek_samples(GstAudioAdapter *adapter, guint samples, gboolean *copied_gap, gboolean *copied_nongap);
 GList *gst_audioadapter_get_list_samples(GstAudioAdapter *adapter, guint samples);
 void gst_audioadapter_flush_samples(GstAudioAdapter *adapter, guint samples);
 
@@ -48,13 +48,19 @@
 #include <stdlib.h>
 #include <math.h>
 #include <setjmp.h>
+#include <unistd.h>
+#include <glib.h>
 
 
 #include <gstlal_cdf_weighted_chisq_P.h>
 
 
+#ifndef TRUE
 #define TRUE  1
+#endif
+#ifndef FALSE
 #define FALSE 0
+#endif
 #define PI 3.1415926535897932384626433832795028841968
 #define LOG2_OVER_8 .0866433975699931636771540151822720710094	/* ln(2) / 8 */
 
@@ -307,7 +313,7 @@ static int *order(const double *A, int N)
  */
 
 
-static double cfe(double x, jmp_buf env, int *count, int lim, const double *A, const double *noncent, const int *dof, int N, int *index)
+static double cfe(double x, jmp_buf env, int *count, int lim, const double *A, const double *noncent, const int *dof, int N, const int *index)
 {
 	double axl, sxl, sum;
 	int j;
@@ -343,78 +349,75 @@ static double cfe(double x, jmp_buf env, int *count, int lim, const double *A, c
 /*
  * ============================================================================
  *
- *                                Exported API
+ *                            Distribution Set-Up
  *
  * ============================================================================
  */
 
 
-/**
- * gstlal_cdf_weighted_chisq_P:
- * @A:  coefficient of j-th \chi^{2} variable
- * @noncent:  non-centrality parameter of the j-th \chi^{2} variable
- * @dof:  degrees of freedom of the j-th \chi^{2} variable
- * @N:  number of \chi^{2} variables
- * @var:  variance of zero-mean normal variable 
- * @c:  point at which distribution is to be evaluated
- * @lim:  maximum number of terms in integration;  < 0 --> no limit
- * @accuracy:  maximum error
- * @trace:  if not NULL will contain diagnostic information
- * @fault: if not NULL will contain reason for failure
- *
- * Compute the cummulative distribution function for a linear combination
- * of non-central chi-squared random variables.
- *
- * On failure, the value stored in the location pointed to by fault means:
- * 1 required accuracy NOT achieved, 2 round-off error possibly
- * significant, 3 invalid parameters, 4 unable to locate integration
- * parameters, 5 out of memory,
- *
- * Returns:  the value of the cumulative distribution function at c or NaN
- * on failure.
+/*
+ * everything that depends only on the weights, not on the point at which
+ * the distribution is evaluated.  computed once and shared, read-only, by
+ * any number of evaluations.
  */
 
 
-double gstlal_cdf_weighted_chisq_P(
-	const double *A,
-	const double *noncent,
-	const int *dof,
-	int N,
-	double var,
-	double c,
-	int lim,
-	double accuracy,
-	struct gstlal_cdf_weighted_chisq_P_trace *trace,
-	int *fault
-)
-{
-	int j;
-	int count = 0;
-	int nterm_limit = lim;
-	double xnt;
-	double utx;
-	double delta_u;
-	double x;
-	double Amax;
-	double Amin;
-	double mean;	/* mean of the distribution */
-	double stddev;	/* standard deviation of the distribution */
-	double integral;
-	double absolute_sum;
+struct distribution {
+	const double *A;
+	const double *noncent;
+	const int *dof;
+	int N;
+	double var;
+	int lim;
+	double accuracy;
+
+	/* look-up table for sorted coefficients */
 	int *index;
-	double result = nan("");
-	struct gstlal_cdf_weighted_chisq_P_trace trace_local = GSTLAL_CDF_WEIGHTED_CHISQ_P_TRACE_INITIALIZER;
-	int fault_local = 0;
+	double Amin;
+	double Amax;
+	double mean;
+	double stddev;
+
+	/* truncation point with no convergence factor */
+	double utx;
+	/* calls to errbd, truncation, cfe made finding the above */
+	int count;
+
+	/* cut-offs bounding the range of the distribution at the initial
+	 * accuracy and variance, and the calls made finding them */
+	double ctff_upper;
+	double ctff_lower;
+	int ctff_count;
+
+	/* non-zero if the parameters are unusable */
+	int fault;
+};
+
+
+static void distribution_init(struct distribution *dist, const double *A, const double *noncent, const int *dof, int N, double var, int lim, double accuracy)
+{
 	jmp_buf env;
+	int j;
+
+	dist->A = A;
+	dist->noncent = noncent;
+	dist->dof = dof;
+	dist->N = N;
+	dist->var = var;
+	dist->lim = lim;
+	dist->accuracy = accuracy;
+	dist->count = 0;
+	dist->ctff_count = -1;
+	dist->fault = 0;
 
 	/*
 	 * construct look-up table for sorted coefficients
 	 */
 
-	index = order(A, N);
-	if(!index) {
-		fault_local = 5;
-		goto done;
+	dist->index = order(A, N);
+	if(!dist->index) {
+		dist->fault = 5;
+		return;
 	}
 
 	/*
@@ -422,18 +425,18 @@ double gstlal_cdf_weighted_chisq_P(
 	 */
 
 	if(setjmp(env)) {
-		fault_local = 4;
-		goto done;
+		dist->fault = 4;
+		return;
 	}
 
 	if(N < 0) {
-		fault_local = 3;
-		goto done;
+		dist->fault = 3;
+		return;
 	}
 	for(j = 0; j < N; j++)
 		if(dof[j] < 0 || noncent[j] < 0) {
-			fault_local = 3;
-			goto done;
+			dist->fault = 3;
+			return;
 		}
 
 	/*
@@ -442,54 +445,126 @@ double gstlal_cdf_weighted_chisq_P(
 	 * help with numerical accuracy
 	 */
 
-	stddev = var;
-	Amin = Amax = (N == 0) ? 0 : A[0];
-	mean = 0;
+	dist->stddev = var;
+	dist->Amin = dist->Amax = (N == 0) ? 0 : A[0];
+	dist->mean = 0;
 	for(j = 0; j < N; j++) {
-		stddev += pow(A[index[j]], 2) * (2 * dof[index[j]] + 4 * noncent[index[j]]);
-		mean += A[index[j]] * (dof[index[j]] + noncent[index[j]]);
-		if(A[j] > Amax)
-			Amax = A[j];
-		else if(A[j] < Amin)
-			Amin = A[j];
+		int i = dist->index[j];
+		dist->stddev += pow(A[i], 2) * (2 * dof[i] + 4 * noncent[i]);
+		dist->mean += A[i] * (dof[i] + noncent[i]);
+		if(A[j] > dist->Amax)
+			dist->Amax = A[j];
+		else if(A[j] < dist->Amin)
+			dist->Amin = A[j];
 	}
-	stddev = sqrt(stddev);
+	dist->stddev = sqrt(dist->stddev);
 
 	/*
 	 * check that parameter values are valid
 	 */
 
-	if(Amin == 0 && Amax == 0 && var == 0) {
-		fault_local = 3;
-		goto done;
+	if(dist->Amin == 0 && dist->Amax == 0 && var == 0) {
+		dist->fault = 3;
+		return;
 	}
 
 	/*
-	 * special case:  Dirac \delta
+	 * special case:  Dirac \delta.  nothing else to set up
 	 */
 
-	if(stddev == 0) {
-		result = (c > 0) ? 1 : 0;
-		goto done;
-	}
+	if(dist->stddev == 0)
+		return;
 
 	/*
 	 * truncation point with no convergence factor.  use 16/stddev as
 	 * initial guess for u
 	 */
 
-	utx = findu(16 / stddev, var, accuracy / 2, env, &count, lim, A, noncent, dof, N);
+	dist->utx = findu(16 / dist->stddev, var, accuracy / 2, env, &dist->count, lim, A, noncent, dof, N);
+
+	/*
+	 * range of the distribution as the first pass of the integration
+	 * loop sees it when no convergence factor is applied.  found
+	 * without a limit on the number of calls:  the calls are charged to
+	 * each evaluation that uses the result, so the limit is enforced
+	 * exactly as if the evaluation had made them itself
+	 */
+
+	{
+	int count = 0;
+	dist->ctff_upper = ctff(accuracy / 2, +4.5 / dist->stddev, env, &count, -1, var, A, noncent, dof, N, dist->Amin, dist->Amax, dist->mean);
+	dist->ctff_lower = ctff(accuracy / 2, -4.5 / dist->stddev, env, &count, -1, var, A, noncent, dof, N, dist->Amin, dist->Amax, dist->mean);
+	dist->ctff_count = count;
+	}
+}
+
+
+static void distribution_free(struct distribution *dist)
+{
+	free(dist->index);
+	dist->index = NULL;
+}
+
+
+/*
+ * evaluate the cumulative distribution function at c
+ */
+
+
+static double distribution_P(const struct distribution *dist, double c, struct gstlal_cdf_weighted_chisq_P_trace *trace, int *fault)
+{
+	const double *A = dist->A;
+	const double *noncent = dist->noncent;
+	const int *dof = dist->dof;
+	const int *index = dist->index;
+	int N = dist->N;
+	int lim = dist->lim;
+	int j;
+	int count = dist->count;
+	int nterm_limit = lim;
+	double var = dist->var;
+	double accuracy = dist->accuracy;
+	double utx = dist->utx;
+	double xnt;
+	double delta_u;
+	double x;
+	double integral;
+	double absolute_sum;
+	int first_pass = TRUE;
+	double result = nan("");
+	struct gstlal_cdf_weighted_chisq_P_trace trace_local = GSTLAL_CDF_WEIGHTED_CHISQ_P_TRACE_INITIALIZER;
+	int fault_local = dist->fault;
+	jmp_buf env;
+
+	if(fault_local)
+		goto done;
+
+	if(setjmp(env)) {
+		fault_local = 4;
+		goto done;
+	}
+
+	/*
+	 * special case:  Dirac \delta
+	 */
+
+	if(dist->stddev == 0) {
+		result = (c > 0) ? 1 : 0;
+		goto done;
+	}
 
 	/*
 	 * does convergence factor help?
 	 */
 
-	if(c != 0 && N > 0 && fabs(A[index[N-1]]) > 0.07 * stddev) {
+	if(c != 0 && N > 0 && fabs(A[index[N-1]]) > 0.07 * dist->stddev) {
 		double tausq = accuracy / 4 / cfe(c, env, &count, lim, A, noncent, dof, N, index);
 		if(!isnan(tausq) && truncation(utx, var + tausq, env, &count, lim, A, noncent, dof, N) < accuracy / 5) {
 			var += tausq;
 			utx = findu(utx, var, accuracy / 4, env, &count, lim, A, noncent, dof, N);
 			trace_local.init_convergence_factor_sd = sqrt(tausq);
+			/* the precomputed range no longer applies */
+			first_pass = FALSE;
 		}
 	}
 	trace_local.truncation_point = utx;
@@ -502,13 +577,26 @@ double gstlal_cdf_weighted_chisq_P(
 	integral = absolute_sum = 0;
 	while(TRUE) {
 		double xntm;
+		double d1, d2;
 
 		/*
 		 * find integration interval
 		 */
 
-		double d1 = ctff(accuracy, +4.5 / stddev, env, &count, lim, var, A, noncent, dof, N, Amin, Amax, mean) - c;
-		double d2 = c - ctff(accuracy, -4.5 / stddev, env, &count, lim, var, A, noncent, dof, N, Amin, Amax, mean);
+		if(first_pass && dist->ctff_count >= 0) {
+			count += dist->ctff_count;
+			if(count > lim && lim >= 0) {
+				/* where counter() would have stopped */
+				count = lim + 1;
+				longjmp(env, 1);
+			}
+			d1 = dist->ctff_upper - c;
+			d2 = c - dist->ctff_lower;
+		} else {
+			d1 = ctff(accuracy, +4.5 / dist->stddev, env, &count, lim, var, A, noncent, dof, N, dist->Amin, dist->Amax, dist->mean) - c;
+			d2 = c - ctff(accuracy, -4.5 / dist->stddev, env, &count, lim, var, A, noncent, dof, N, dist->Amin, dist->Amax, dist->mean);
+		}
+		first_pass = FALSE;
 
 		if(d1 < 0) {
 			result = 1;
@@ -615,6 +703,207 @@ done:
 		*trace = trace_local;
 	if(fault)
 		*fault = fault_local;
-	free(index);
 	return result;
 }
+
+
+/*
+ * a share of a batch evaluation
+ */
+
+
+struct batch_job {
+	const struct distribution *dist;
+	const double *c;
+	double *P;
+	int *fault;
+	int n;
+	int nfaults;
+};
+
+
+static void batch_job_run(gpointer data, gpointer user_data)
+{
+	struct batch_job *job = data;
+	int i;
+
+	job->nfaults = 0;
+	for(i = 0; i < job->n; i++) {
+		int fault;
+		job->P[i] = distribution_P(job->dist, job->c[i], NULL, &fault);
+		if(job->fault)
+			job->fault[i] = fault;
+		if(fault)
+			job->nfaults++;
+	}
+}
+
+
+/*
+ * ============================================================================
+ *
+ *                                Exported API
+ *
+ * ============================================================================
+ */
+
+
+/**
+ * gstlal_cdf_weighted_chisq_P:
+ * @A:  coefficient of j-th \chi^{2} variable
+ * @noncent:  non-centrality parameter of the j-th \chi^{2} variable
+ * @dof:  degrees of freedom of the j-th \chi^{2} variable
+ * @N:  number of \chi^{2} variables
+ * @var:  variance of zero-mean normal variable 
+ * @c:  point at which distribution is to be evaluated
+ * @lim:  maximum number of terms in integration;  < 0 --> no limit
+ * @accuracy:  maximum error
+ * @trace:  if not NULL will contain diagnostic information
+ * @fault: if not NULL will contain reason for failure
+ *
+ * Compute the cummulative distribution function for a linear combination
+ * of non-central chi-squared random variables.
+ *
+ * On failure, the value stored in the location pointed to by fault means:
+ * 1 required accuracy NOT achieved, 2 round-off error possibly
+ * significant, 3 invalid parameters, 4 unable to locate integration
+ * parameters, 5 out of memory,
+ *
+ * Returns:  the value of the cumulative distribution function at c or NaN
+ * on failure.  Fault 2 is a warning:  the value is still computed and
+ * returned.
+ */
+
+
+double gstlal_cdf_weighted_chisq_P(
+	const double *A,
+	const double *noncent,
+	const int *dof,
+	int N,
+	double var,
+	double c,
+	int lim,
+	double accuracy,
+	struct gstlal_cdf_weighted_chisq_P_trace *trace,
+	int *fault
+)
+{
+	struct distribution dist;
+	double result;
+
+	distribution_init(&dist, A, noncent, dof, N, var, lim, accuracy);
+	result = distribution_P(&dist, c, trace, fault);
+	distribution_free(&dist);
+
+	return result;
+}
+
+
+/**
+ * gstlal_cdf_weighted_chisq_P_array:
+ * @A:  coefficient of j-th \chi^{2} variable
+ * @noncent:  non-centrality parameter of the j-th \chi^{2} variable
+ * @dof:  degrees of freedom of the j-th \chi^{2} variable
+ * @N:  number of \chi^{2} variables
+ * @var:  variance of zero-mean normal variable
+ * @c:  points at which distribution is to be evaluated
+ * @P:  location in which to store the values of the distribution at the M
+ * points
+ * @M:  number of points
+ * @lim:  maximum number of terms in integration;  < 0 --> no limit
+ * @accuracy:  maximum error
+ * @fault: if not NULL, array of M locations that will contain the reason
+ * for failure at each point, as for gstlal_cdf_weighted_chisq_P()
+ * @nthreads:  number of threads to use;  <= 0 --> one per processor
+ *
+ * Compute the cummulative distribution function for a linear combination
+ * of non-central chi-squared random variables at many points.  Equivalent
+ * to calling gstlal_cdf_weighted_chisq_P() for each point, and gives
+ * identical results, but the work that does not depend on the point is
+ * done once, and the points are shared among @nthreads threads.
+ *
+ * Returns:  the number of points at which the evaluation reported a fault,
+ * including fault 2, at which a value is still stored in @P.  @P holds NaN
+ * at the points with any other fault.
+ */
+
+
+int gstlal_cdf_weighted_chisq_P_array(
+	const double *A,
+	const double *noncent,
+	const int *dof,
+	int N,
+	double var,
+	const double *c,
+	double *P,
+	int M,
+	int lim,
+	double accuracy,
+	int *fault,
+	int nthreads
+)
+{
+	/* points per job.  the cost of an evaluation varies a lot across
+	 * the distribution, so the jobs are kept small and handed out on
+	 * demand */
+	const int chunk = 64;
+	struct distribution dist;
+	struct batch_job *jobs;
+	int njobs, i;
+	int nfaults = 0;
+
+	if(M <= 0)
+		return 0;
+
+	distribution_init(&dist, A, noncent, dof, N, var, lim, accuracy);
+
+	if(nthreads <= 0)
+		nthreads = sysconf(_SC_NPROCESSORS_ONLN);
+	njobs = (M + chunk - 1) / chunk;
+	if(nthreads > njobs)
+		nthreads = njobs;
+
+	jobs = malloc(njobs * sizeof(*jobs));
+	if(!jobs) {
+		distribution_free(&dist);
+		for(i = 0; i < M; i++) {
+			P[i] = nan("");
+			if(fault)
+				fault[i] = 5;
+		}
+		return M;
+	}
+	for(i = 0; i < njobs; i++) {
+		jobs[i].dist = &dist;
+		jobs[i].c = c + i * chunk;
+		jobs[i].P = P + i * chunk;
+		jobs[i].fault = fault ? fault + i * chunk : NULL;
+		jobs[i].n = (i + 1) * chunk <= M ? chunk : M - i * chunk;
+	}
+
+	if(nthreads > 1) {
+		GThreadPool *pool;
+#if !GLIB_CHECK_VERSION(2, 32, 0)
+		if(!g_thread_supported())
+			g_thread_init(NULL);
+#endif
+		pool = g_thread_pool_new(batch_job_run, NULL, nthreads, TRUE, NULL);
+		if(pool) {
+			for(i = 0; i < njobs; i++)
+				g_thread_pool_push(pool, &jobs[i], NULL);
+			/* wait for the queue to drain */
+			g_thread_pool_free(pool, FALSE, TRUE);
+		} else
+			nthreads = 1;
+	}
+	if(nthreads <= 1)
+		for(i = 0; i < njobs; i++)
+			batch_job_run(&jobs[i], NULL);
+
+	for(i = 0; i < njobs; i++)
+		nfaults += jobs[i].nfaults;
+
+	free(jobs);
+	distribution_free(&dist);
+	return nfaults;
+}
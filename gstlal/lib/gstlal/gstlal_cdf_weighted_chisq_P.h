@@ -43,6 +43,7 @@ struct gstlal_cdf_weighted_chisq_P_trace {
 
 
 double gstlal_cdf_weighted_chisq_P(const double *A, const double *noncent, const int *dof, int N, double var, double c, int lim, double accuracy, struct gstlal_cdf_weighted_chisq_P_trace *trace, int *fault);
+int gstlal_cdf_weighted_chisq_P_array(const double *A, const double *noncent, const int *dof, int N, double var, const double *c, double *P, int M, int lim, double accuracy, int *fault, int nthreads);
 
 
 #endif /* __GSTLAL_CDF_WEIGHTED_CHISQ_P_H__ */
@@ -0,0 +1,622 @@
+/*
+ * Copyright (C) 2026  The gstlal authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+/**
+ * SECTION:gstlal_element_stats
+ * @title: Element Statistics
+ * @include: gstlal/gstlal_element_stats.h
+ * @short_description:  Latency and throughput instrumentation for
+ * elements.
+ *
+ * An element holds a struct gstlal_element_stats and reports to it from
+ * its streaming thread:  gstlal_element_stats_input() when a buffer
+ * arrives, gstlal_element_stats_processed() when it is done with it,
+ * gstlal_element_stats_output() for each buffer it renders, if it is a
+ * sink, gstlal_element_stats_push() to push each output buffer otherwise,
+ * and gstlal_element_stats_queue_level() when the amount of data it holds
+ * changes.
+ *
+ * The latency of an output buffer is the wall time since the arrival of
+ * the input buffer whose data completed it, i.e. the first input whose end
+ * time is at or after the end of the output, so elements that accumulate
+ * data in adapters are measured from the buffer that let them produce
+ * output.  The stream lag is the GPS time now minus the end of the output,
+ * which includes everything upstream.
+ *
+ * The statistics are available as properties, see
+ * gstlal_element_stats_install_properties(), and can be published in a
+ * file, normally under /dev/shm, that other processes map and read
+ * without locking, see struct gstlal_element_stats_page.  gstlal's
+ * gstlal_element_stats program prints them.
+ */
+
+
+/*
+ * ============================================================================
+ *
+ *                                  Preamble
+ *
+ * ============================================================================
+ */
+
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+
+#include <glib.h>
+#include <glib-object.h>
+#include <gst/gst.h>
+
+
+#include <lal/Date.h>
+
+
+#include <gstlal_element_stats.h>
+
+
+/*
+ * ============================================================================
+ *
+ *                               Internal Code
+ *
+ * ============================================================================
+ */
+
+
+/* input buffers whose output is still pending */
+#define N_ARRIVALS 64
+/* the moving averages follow the last 1 / MEAN_WEIGHT buffers or so */
+#define MEAN_WEIGHT 16
+
+
+struct arrival {
+	GstClockTime stream_end;
+	GstClockTime wall;
+};
+
+
+struct gstlal_element_stats {
+	GstElement *element;
+	GMutex *lock;
+	/* points at local or at the mapped file */
+	struct gstlal_element_stats_page *page;
+	struct gstlal_element_stats_page local;
+	gchar *filename;
+	/* ring of input arrivals in stream order */
+	struct arrival arrivals[N_ARRIVALS];
+	gint first_arrival;
+	gint n_arrivals;
+	GstClockTime processing_start;
+};
+
+
+static GstClockTime gps_now(void)
+{
+	LIGOTimeGPS now;
+
+	if(!XLALGPSTimeNow(&now))
+		return GST_CLOCK_TIME_NONE;
+	return XLALGPSToINT8NS(&now);
+}
+
+
+/*
+ * seqlock writer side.  called with the lock held, so there is only ever
+ * one writer.  g_atomic_int_inc() is a full barrier.
+ */
+
+
+static void page_begin(struct gstlal_element_stats *stats)
+{
+	g_atomic_int_inc((volatile gint *) &stats->page->sequence);
+}
+
+
+static void page_end(struct gstlal_element_stats *stats)
+{
+	stats->page->update_time = gps_now();
+	g_atomic_int_inc((volatile gint *) &stats->page->sequence);
+}
+
+
+static void update_mean_max(guint64 x, guint64 *last, guint64 *mean, guint64 *max)
+{
+	*last = x;
+	*mean = *mean ? (gint64) *mean + ((gint64) x - (gint64) *mean) / MEAN_WEIGHT : x;
+	if(x > *max)
+		*max = x;
+}
+
+
+static void unmap_page(struct gstlal_element_stats *stats)
+{
+	if(stats->page != &stats->local) {
+		stats->local = *stats->page;
+		munmap(stats->page, sizeof(*stats->page));
+		unlink(stats->filename);
+		stats->page = &stats->local;
+	}
+	g_free(stats->filename);
+	stats->filename = NULL;
+}
+
+
+/*
+ * ============================================================================
+ *
+ *                                Exported API
+ *
+ * ============================================================================
+ */
+
+
+/**
+ * gstlal_element_stats_new:
+ * @element:  the element being instrumented, not referenced
+ *
+ * Returns:  a new struct gstlal_element_stats with all statistics zero,
+ * not published in a file.
+ */
+
+
+struct gstlal_element_stats *gstlal_element_stats_new(GstElement *element)
+{
+	struct gstlal_element_stats *stats = g_new0(struct gstlal_element_stats, 1);
+
+	stats->element = element;
+	stats->lock = g_mutex_new();
+	stats->page = &stats->local;
+	stats->local.magic = GSTLAL_ELEMENT_STATS_MAGIC;
+	stats->local.version = GSTLAL_ELEMENT_STATS_VERSION;
+	stats->local.pid = getpid();
+	stats->processing_start = GST_CLOCK_TIME_NONE;
+
+	return stats;
+}
+
+
+/**
+ * gstlal_element_stats_free:
+ * @stats:  the struct gstlal_element_stats to free
+ *
+ * Frees @stats, removing its stats file if it has one.
+ */
+
+
+void gstlal_element_stats_free(struct gstlal_element_stats *stats)
+{
+	if(!stats)
+		return;
+	unmap_page(stats);
+	g_mutex_free(stats->lock);
+	g_free(stats);
+}
+
+
+/**
+ * gstlal_element_stats_set_file:
+ * @stats:  a struct gstlal_element_stats
+ * @filename:  the file to publish in, or %NULL or "" to stop publishing
+ *
+ * Create @filename, replacing any existing file, and publish the
+ * statistics in it from now on.  The previous file, if any, is removed.
+ *
+ * Returns:  %TRUE on success, %FALSE if the file could not be created, in
+ * which case the statistics are not published.
+ */
+
+
+gboolean gstlal_element_stats_set_file(struct gstlal_element_stats *stats, const gchar *filename)
+{
+	struct gstlal_element_stats_page *page;
+	gboolean success = TRUE;
+	int fd;
+
+	/*
+	 * this is called from set_property() with the object lock held,
+	 * so errors are not logged against the object, that would take the
+	 * lock again
+	 */
+
+	g_mutex_lock(stats->lock);
+	unmap_page(stats);
+	if(!filename || !*filename)
+		goto done;
+
+	fd = open(filename, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if(fd < 0) {
+		GST_ERROR("%s: open('%s') failed: %s", GST_OBJECT_NAME(stats->element), filename, strerror(errno));
+		success = FALSE;
+		goto done;
+	}
+	if(ftruncate(fd, sizeof(*page)) < 0 || (page = mmap(NULL, sizeof(*page), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)) == MAP_FAILED) {
+		GST_ERROR("%s: mapping '%s' failed: %s", GST_OBJECT_NAME(stats->element), filename, strerror(errno));
+		close(fd);
+		unlink(filename);
+		success = FALSE;
+		goto done;
+	}
+	close(fd);
+
+	*page = stats->local;
+	page->sequence = 0;
+	g_strlcpy(page->element, GST_OBJECT_NAME(stats->element) ? GST_OBJECT_NAME(stats->element) : "", sizeof(page->element));
+	stats->page = page;
+	stats->filename = g_strdup(filename);
+
+done:
+	g_mutex_unlock(stats->lock);
+	return success;
+}
+
+
+/**
+ * gstlal_element_stats_get_page:
+ * @stats:  a struct gstlal_element_stats
+ * @page:  (out caller-allocates):  a consistent copy of the statistics
+ */
+
+
+void gstlal_element_stats_get_page(struct gstlal_element_stats *stats, struct gstlal_element_stats_page *page)
+{
+	g_mutex_lock(stats->lock);
+	*page = *stats->page;
+	g_mutex_unlock(stats->lock);
+}
+
+
+/**
+ * gstlal_element_stats_input:
+ * @stats:  a struct gstlal_element_stats
+ * @buf:  the buffer that has arrived
+ *
+ * Record the arrival of @buf and start timing its processing.  Buffers
+ * without a valid timestamp and duration are counted but cannot be matched
+ * to output.
+ */
+
+
+void gstlal_element_stats_input(struct gstlal_element_stats *stats, GstBuffer *buf)
+{
+	GstClockTime now = gst_util_get_timestamp();
+
+	g_mutex_lock(stats->lock);
+	stats->processing_start = now;
+	if(GST_BUFFER_TIMESTAMP_IS_VALID(buf) && GST_BUFFER_DURATION_IS_VALID(buf)) {
+		struct arrival *arrival;
+		if(stats->n_arrivals == N_ARRIVALS) {
+			/* nothing has come out for a long time, forget the oldest */
+			stats->first_arrival = (stats->first_arrival + 1) % N_ARRIVALS;
+			stats->n_arrivals--;
+		}
+		arrival = &stats->arrivals[(stats->first_arrival + stats->n_arrivals++) % N_ARRIVALS];
+		arrival->stream_end = GST_BUFFER_TIMESTAMP(buf) + GST_BUFFER_DURATION(buf);
+		arrival->wall = now;
+	}
+	page_begin(stats);
+	stats->page->buffers_in++;
+	page_end(stats);
+	g_mutex_unlock(stats->lock);
+}
+
+
+/**
+ * gstlal_element_stats_output:
+ * @stats:  a struct gstlal_element_stats
+ * @stream_end:  the timestamp plus duration of the output buffer
+ *
+ * Record the output of a buffer.  Call it once per output buffer, in
+ * stream order.
+ */
+
+
+void gstlal_element_stats_output(struct gstlal_element_stats *stats, GstClockTime stream_end)
+{
+	GstClockTime now = gst_util_get_timestamp();
+	GstClockTime gps = gps_now();
+
+	g_mutex_lock(stats->lock);
+	page_begin(stats);
+	stats->page->buffers_out++;
+	if(GST_CLOCK_TIME_IS_VALID(stream_end) && stats->n_arrivals) {
+		struct arrival *arrival;
+		/* drop inputs that ended before this output, their data is
+		 * all out */
+		while(stats->n_arrivals > 1 && stats->arrivals[stats->first_arrival].stream_end < stream_end) {
+			stats->first_arrival = (stats->first_arrival + 1) % N_ARRIVALS;
+			stats->n_arrivals--;
+		}
+		/* the first remaining input completed this output, or, if
+		 * the output ends after all input, the last one did */
+		arrival = &stats->arrivals[stats->first_arrival];
+		update_mean_max(now - arrival->wall, &stats->page->latency_last, &stats->page->latency_mean, &stats->page->latency_max);
+	}
+	if(GST_CLOCK_TIME_IS_VALID(stream_end) && GST_CLOCK_TIME_IS_VALID(gps))
+		stats->page->stream_lag = (gint64) gps - (gint64) stream_end;
+	page_end(stats);
+	g_mutex_unlock(stats->lock);
+}
+
+
+/**
+ * gstlal_element_stats_push:
+ * @stats:  a struct gstlal_element_stats
+ * @pad:  the source pad
+ * @buf:  the output buffer
+ *
+ * Record the output of @buf, as gstlal_element_stats_output() does, and
+ * push it from @pad.  Downstream elements run in the pushing thread, so the
+ * output is recorded before the push, and the time spent in the push is
+ * left out of the processing time of the current input buffer.
+ *
+ * Returns:  the result of gst_pad_push()
+ */
+
+
+GstFlowReturn gstlal_element_stats_push(struct gstlal_element_stats *stats, GstPad *pad, GstBuffer *buf)
+{
+	GstClockTime stream_end = GST_CLOCK_TIME_NONE;
+	GstClockTime push_start;
+	GstFlowReturn result;
+
+	if(GST_BUFFER_TIMESTAMP_IS_VALID(buf) && GST_BUFFER_DURATION_IS_VALID(buf))
+		stream_end = GST_BUFFER_TIMESTAMP(buf) + GST_BUFFER_DURATION(buf);
+	gstlal_element_stats_output(stats, stream_end);
+
+	push_start = gst_util_get_timestamp();
+	result = gst_pad_push(pad, buf);
+
+	g_mutex_lock(stats->lock);
+	if(GST_CLOCK_TIME_IS_VALID(stats->processing_start))
+		stats->processing_start += gst_util_get_timestamp() - push_start;
+	g_mutex_unlock(stats->lock);
+
+	return result;
+}
+
+
+/**
+ * gstlal_element_stats_processed:
+ * @stats:  a struct gstlal_element_stats
+ *
+ * Record the end of the processing of the buffer last passed to
+ * gstlal_element_stats_input().
+ */
+
+
+void gstlal_element_stats_processed(struct gstlal_element_stats *stats)
+{
+	GstClockTime now = gst_util_get_timestamp();
+
+	g_mutex_lock(stats->lock);
+	if(GST_CLOCK_TIME_IS_VALID(stats->processing_start)) {
+		page_begin(stats);
+		update_mean_max(now - stats->processing_start, &stats->page->processing_last, &stats->page->processing_mean, &stats->page->processing_max);
+		page_end(stats);
+		stats->processing_start = GST_CLOCK_TIME_NONE;
+	}
+	g_mutex_unlock(stats->lock);
+}
+
+
+/**
+ * gstlal_element_stats_queue_level:
+ * @stats:  a struct gstlal_element_stats
+ * @level:  the amount of data the element is holding
+ */
+
+
+void gstlal_element_stats_queue_level(struct gstlal_element_stats *stats, guint64 level)
+{
+	g_mutex_lock(stats->lock);
+	page_begin(stats);
+	stats->page->queue_level = level;
+	if(level > stats->page->queue_level_max)
+		stats->page->queue_level_max = level;
+	page_end(stats);
+	g_mutex_unlock(stats->lock);
+}
+
+
+/**
+ * gstlal_element_stats_install_properties:
+ * @klass:  the element's class
+ * @first_prop_id:  the ID to give the first property, the others follow
+ * in the order of enum gstlal_element_stats_property
+ * @queue_level_units:  what the element's queue level counts, e.g.
+ * "samples", or NULL for elements that do not hold data between buffers,
+ * which then get no "queue-level" property
+ *
+ * Install the "stats-file" property and read-only properties for the
+ * statistics.  The element's set_property and get_property methods pass
+ * IDs they do not recognize to gstlal_element_stats_set_property() and
+ * gstlal_element_stats_get_property() with @first_prop_id subtracted.
+ */
+
+
+void gstlal_element_stats_install_properties(GObjectClass *klass, guint first_prop_id, const gchar *queue_level_units)
+{
+	gchar *blurb;
+
+	g_object_class_install_property(
+		klass,
+		first_prop_id + GSTLAL_ELEMENT_STATS_PROP_FILE,
+		g_param_spec_string(
+			"stats-file",
+			"Statistics file",
+			"Publish latency and throughput statistics in this file, normally under /dev/shm, for other processes to read.  The file is removed when the element is destroyed.  Empty to not publish.",
+			NULL,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+		)
+	);
+	g_object_class_install_property(
+		klass,
+		first_prop_id + GSTLAL_ELEMENT_STATS_PROP_BUFFERS,
+		g_param_spec_uint64(
+			"buffers-processed",
+			"Buffers processed",
+			"Number of input buffers processed.",
+			0, G_MAXUINT64, 0,
+			G_PARAM_READABLE | G_PARAM_STATIC_STRINGS
+		)
+	);
+	g_object_class_install_property(
+		klass,
+		first_prop_id + GSTLAL_ELEMENT_STATS_PROP_LATENCY,
+		g_param_spec_uint64(
+			"buffer-latency",
+			"Buffer latency",
+			"Wall time in nanoseconds from the arrival of the input that completed the last output buffer to that output, moving average.",
+			0, G_MAXUINT64, 0,
+			G_PARAM_READABLE | G_PARAM_STATIC_STRINGS
+		)
+	);
+	g_object_class_install_property(
+		klass,
+		first_prop_id + GSTLAL_ELEMENT_STATS_PROP_MAX_LATENCY,
+		g_param_spec_uint64(
+			"max-buffer-latency",
+			"Maximum buffer latency",
+			"Largest buffer latency seen, in nanoseconds.",
+			0, G_MAXUINT64, 0,
+			G_PARAM_READABLE | G_PARAM_STATIC_STRINGS
+		)
+	);
+	g_object_class_install_property(
+		klass,
+		first_prop_id + GSTLAL_ELEMENT_STATS_PROP_PROCESSING_TIME,
+		g_param_spec_uint64(
+			"processing-time",
+			"Processing time",
+			"Wall time in nanoseconds spent on each input buffer, moving average.",
+			0, G_MAXUINT64, 0,
+			G_PARAM_READABLE | G_PARAM_STATIC_STRINGS
+		)
+	);
+	if(queue_level_units) {
+		blurb = g_strdup_printf("Amount of data held inside the element, in %s.", queue_level_units);
+		g_object_class_install_property(
+			klass,
+			first_prop_id + GSTLAL_ELEMENT_STATS_PROP_QUEUE_LEVEL,
+			g_param_spec_uint64(
+				"queue-level",
+				"Queue level",
+				blurb,
+				0, G_MAXUINT64, 0,
+				G_PARAM_READABLE | G_PARAM_STATIC_NAME | G_PARAM_STATIC_NICK
+			)
+		);
+		g_free(blurb);
+	}
+	g_object_class_install_property(
+		klass,
+		first_prop_id + GSTLAL_ELEMENT_STATS_PROP_STREAM_LAG,
+		g_param_spec_int64(
+			"stream-lag",
+			"Stream lag",
+			"GPS time now minus the end of the last output buffer, in nanoseconds.",
+			G_MININT64, G_MAXINT64, 0,
+			G_PARAM_READABLE | G_PARAM_STATIC_STRINGS
+		)
+	);
+}
+
+
+/**
+ * gstlal_element_stats_set_property:
+ * @stats:  a struct gstlal_element_stats
+ * @prop_offset:  property ID minus the first ID given to
+ * gstlal_element_stats_install_properties()
+ * @value:  the new value
+ *
+ * Returns:  %FALSE if @prop_offset is not a writable statistics property.
+ */
+
+
+gboolean gstlal_element_stats_set_property(struct gstlal_element_stats *stats, guint prop_offset, const GValue *value)
+{
+	switch(prop_offset) {
+	case GSTLAL_ELEMENT_STATS_PROP_FILE:
+		gstlal_element_stats_set_file(stats, g_value_get_string(value));
+		return TRUE;
+
+	default:
+		return FALSE;
+	}
+}
+
+
+/**
+ * gstlal_element_stats_get_property:
+ * @stats:  a struct gstlal_element_stats
+ * @prop_offset:  property ID minus the first ID given to
+ * gstlal_element_stats_install_properties()
+ * @value:  set to the property's value
+ *
+ * Returns:  %FALSE if @prop_offset is not a statistics property.
+ */
+
+
+gboolean gstlal_element_stats_get_property(struct gstlal_element_stats *stats, guint prop_offset, GValue *value)
+{
+	struct gstlal_element_stats_page page;
+
+	if(prop_offset == GSTLAL_ELEMENT_STATS_PROP_FILE) {
+		g_mutex_lock(stats->lock);
+		g_value_set_string(value, stats->filename);
+		g_mutex_unlock(stats->lock);
+		return TRUE;
+	}
+
+	gstlal_element_stats_get_page(stats, &page);
+	switch(prop_offset) {
+	case GSTLAL_ELEMENT_STATS_PROP_BUFFERS:
+		g_value_set_uint64(value, page.buffers_in);
+		return TRUE;
+
+	case GSTLAL_ELEMENT_STATS_PROP_LATENCY:
+		g_value_set_uint64(value, page.latency_mean);
+		return TRUE;
+
+	case GSTLAL_ELEMENT_STATS_PROP_MAX_LATENCY:
+		g_value_set_uint64(value, page.latency_max);
+		return TRUE;
+
+	case GSTLAL_ELEMENT_STATS_PROP_PROCESSING_TIME:
+		g_value_set_uint64(value, page.processing_mean);
+		return TRUE;
+
+	case GSTLAL_ELEMENT_STATS_PROP_QUEUE_LEVEL:
+		g_value_set_uint64(value, page.queue_level);
+		return TRUE;
+
+	case GSTLAL_ELEMENT_STATS_PROP_STREAM_LAG:
+		g_value_set_int64(value, page.stream_lag);
+		return TRUE;
+
+	default:
+		return FALSE;
+	}
+}
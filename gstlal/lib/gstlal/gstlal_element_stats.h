@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2026  The gstlal authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifndef __GSTLAL_ELEMENT_STATS_H__
+#define __GSTLAL_ELEMENT_STATS_H__
+
+
+/*
+ * ============================================================================
+ *
+ *                                  Preamble
+ *
+ * ============================================================================
+ */
+
+
+#include <glib.h>
+#include <glib-object.h>
+#include <gst/gst.h>
+
+
+G_BEGIN_DECLS
+
+
+/*
+ * ============================================================================
+ *
+ *                                    Types
+ *
+ * ============================================================================
+ */
+
+
+#define GSTLAL_ELEMENT_STATS_MAGIC 0x53454c47	/* "GLES" */
+#define GSTLAL_ELEMENT_STATS_VERSION 1
+
+
+/**
+ * struct gstlal_element_stats_page:
+ * @magic:  #GSTLAL_ELEMENT_STATS_MAGIC
+ * @version:  #GSTLAL_ELEMENT_STATS_VERSION
+ * @sequence:  odd while the element is updating the page
+ * @pid:  the process the element lives in
+ * @element:  the element's name, nul-terminated
+ * @buffers_in:  input buffers seen
+ * @buffers_out:  output buffers produced
+ * @latency_last:  wall time from the arrival of the input buffer that
+ * completed the most recent output to that output, in ns
+ * @latency_mean:  moving average of @latency_last, in ns
+ * @latency_max:  largest @latency_last, in ns
+ * @processing_last:  wall time spent on the most recent input buffer, in
+ * ns
+ * @processing_mean:  moving average of @processing_last, in ns
+ * @processing_max:  largest @processing_last, in ns
+ * @queue_level:  data held inside the element, in units the element
+ * documents
+ * @queue_level_max:  largest @queue_level
+ * @stream_lag:  GPS time now minus the end of the most recent output, in
+ * ns
+ * @update_time:  GPS time of the last update, in ns
+ *
+ * The layout of a stats file.  All fields are native-endian.  An external
+ * reader maps the file read-only and copies the page, retrying if
+ * @sequence was odd or changed during the copy.  The element never blocks
+ * on readers.
+ */
+
+
+struct gstlal_element_stats_page {
+	guint32 magic;
+	guint32 version;
+	volatile gint32 sequence;
+	guint32 pid;
+	gchar element[64];
+	guint64 buffers_in;
+	guint64 buffers_out;
+	guint64 latency_last;
+	guint64 latency_mean;
+	guint64 latency_max;
+	guint64 processing_last;
+	guint64 processing_mean;
+	guint64 processing_max;
+	guint64 queue_level;
+	guint64 queue_level_max;
+	gint64 stream_lag;
+	guint64 update_time;
+};
+
+
+/**
+ * struct gstlal_element_stats:
+ *
+ * The opaque gstlal_element_stats structure.
+ */
+
+
+struct gstlal_element_stats;
+
+
+/**
+ * enum gstlal_element_stats_property:
+ *
+ * Offsets of the properties installed by
+ * gstlal_element_stats_install_properties() from the first property ID.
+ */
+
+
+enum gstlal_element_stats_property {
+	GSTLAL_ELEMENT_STATS_PROP_FILE = 0,
+	GSTLAL_ELEMENT_STATS_PROP_BUFFERS,
+	GSTLAL_ELEMENT_STATS_PROP_LATENCY,
+	GSTLAL_ELEMENT_STATS_PROP_MAX_LATENCY,
+	GSTLAL_ELEMENT_STATS_PROP_PROCESSING_TIME,
+	GSTLAL_ELEMENT_STATS_PROP_QUEUE_LEVEL,
+	GSTLAL_ELEMENT_STATS_PROP_STREAM_LAG,
+	GSTLAL_ELEMENT_STATS_N_PROPERTIES
+};
+
+
+/*
+ * ============================================================================
+ *
+ *                                Exported API
+ *
+ * ============================================================================
+ */
+
+
+struct gstlal_element_stats *gstlal_element_stats_new(GstElement *element);
+void gstlal_element_stats_free(struct gstlal_element_stats *stats);
+gboolean gstlal_element_stats_set_file(struct gstlal_element_stats *stats, const gchar *filename);
+void gstlal_element_stats_get_page(struct gstlal_element_stats *stats, struct gstlal_element_stats_page *page);
+
+void gstlal_element_stats_input(struct gstlal_element_stats *stats, GstBuffer *buf);
+void gstlal_element_stats_output(struct gstlal_element_stats *stats, GstClockTime stream_end);
+GstFlowReturn gstlal_element_stats_push(struct gstlal_element_stats *stats, GstPad *pad, GstBuffer *buf);
+void gstlal_element_stats_processed(struct gstlal_element_stats *stats);
+void gstlal_element_stats_queue_level(struct gstlal_element_stats *stats, guint64 level);
+
+void gstlal_element_stats_install_properties(GObjectClass *klass, guint first_prop_id, const gchar *queue_level_units);
+gboolean gstlal_element_stats_set_property(struct gstlal_element_stats *stats, guint prop_offset, const GValue *value);
+gboolean gstlal_element_stats_get_property(struct gstlal_element_stats *stats, guint prop_offset, GValue *value);
+
+
+G_END_DECLS
+
+
+#endif	/* __GSTLAL_ELEMENT_STATS_H__ */
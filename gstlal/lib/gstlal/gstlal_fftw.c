@@ -31,6 +31,7 @@
  */
 
 
+#include <complex.h>
 #include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -62,6 +63,15 @@
 #include <lal/FFTWMutex.h>
 
 
+/*
+ * our own stuff
+ */
+
+
+#include <gstlal/gstlal.h>
+#include <gstlal/gstlal_fftw.h>
+
+
 /*
  * ============================================================================
  *
@@ -120,16 +130,25 @@ void gstlal_fftw_unlock(void)
  * GSTLAL_FFTW_WISDOM and GSTLAL_FFTWF_WISDOM, respectively, or if one or
  * the other isn't set then the respective FFTW default is used.  This
  * function acquires and releases the GstLAL FFTW locks and is thread-safe.
+ * Only the first call loads anything, so each plugin can call it from its
+ * init function.
  */
 
 
 void gstlal_load_fftw_wisdom(void)
 {
+	static gboolean loaded = FALSE;
 	char *filename;
 	int savederrno;
 
 	gstlal_fftw_lock();
 
+	if(loaded) {
+		gstlal_fftw_unlock();
+		return;
+	}
+	loaded = TRUE;
+
 	/*
 	 * double precision
 	 */
@@ -174,3 +193,466 @@ void gstlal_load_fftw_wisdom(void)
 
 	gstlal_fftw_unlock();
 }
+
+
+/*
+ * ============================================================================
+ *
+ *                              FFTW Plan Cache
+ *
+ * ============================================================================
+ */
+
+
+/*
+ * plans are shared between everything that asks for the same transform.
+ * the plan is made on the cache's own scratch arrays, so planning never
+ * touches the caller's data, and callers execute it on their arrays with
+ * FFTW's new-array execute functions, e.g. fftw_execute_dft_r2c(), which
+ * are thread-safe.  a plan made for SIMD-aligned arrays may only be used
+ * with SIMD-aligned arrays, so the alignment of the caller's arrays is
+ * part of the key, as is whether the transform is in-place.
+ *
+ * only the FFTW planner needs the wisdom lock.  the cache has its own lock
+ * that is held only for table look-ups, so an element asking for a plan
+ * that has already been made does not wait for another element that is
+ * planning.
+ */
+
+
+enum plan_type {
+	PLAN_DFT_R2C,
+	PLAN_DFT_C2R,
+	PLANF_DFT_R2C,
+	PLANF_DFT_C2R
+};
+
+
+struct plan_key {
+	int n;
+	enum plan_type type;
+	gboolean aligned;
+	gboolean in_place;
+	unsigned flags;
+};
+
+
+struct plan_entry {
+	struct plan_key key;	/* must be first */
+	void *plan;
+	guint refcount;
+};
+
+
+G_LOCK_DEFINE_STATIC(plan_cache);
+static GHashTable *plans_by_key;
+static GHashTable *plans_by_plan;
+static guint64 plan_cache_hits;
+static guint64 plan_cache_misses;
+
+
+static guint plan_key_hash(gconstpointer p)
+{
+	const struct plan_key *key = p;
+
+	return ((((guint) key->n * 31 + key->type) * 31 + key->aligned) * 31 + key->in_place) * 31 + key->flags;
+}
+
+
+static gboolean plan_key_equal(gconstpointer a, gconstpointer b)
+{
+	const struct plan_key *x = a, *y = b;
+
+	return x->n == y->n && x->type == y->type && x->aligned == y->aligned && x->in_place == y->in_place && x->flags == y->flags;
+}
+
+
+static void make_plan_key(struct plan_key *key, int n, enum plan_type type, const void *in, const void *out, unsigned flags)
+{
+	memset(key, 0, sizeof(*key));
+	key->n = n;
+	key->type = type;
+	key->in_place = in == out;
+	if(type == PLAN_DFT_R2C || type == PLAN_DFT_C2R)
+		key->aligned = !(fftw_alignment_of((double *) in) || fftw_alignment_of((double *) out));
+	else
+		key->aligned = !(fftwf_alignment_of((float *) in) || fftwf_alignment_of((float *) out));
+	/* a plan for unaligned arrays works with any arrays */
+	key->flags = key->aligned ? flags : flags | FFTW_UNALIGNED;
+}
+
+
+/*
+ * called with the cache lock held
+ */
+
+
+static void *plan_cache_lookup(const struct plan_key *key)
+{
+	struct plan_entry *entry;
+
+	if(!plans_by_key) {
+		plans_by_key = g_hash_table_new(plan_key_hash, plan_key_equal);
+		plans_by_plan = g_hash_table_new(g_direct_hash, g_direct_equal);
+	}
+	entry = g_hash_table_lookup(plans_by_key, key);
+	if(!entry)
+		return NULL;
+	entry->refcount++;
+	return entry->plan;
+}
+
+
+/*
+ * called with the wisdom lock held
+ */
+
+
+static void *make_plan(const struct plan_key *key)
+{
+	int length_fd = key->n / 2 + 1;
+	void *plan;
+
+	if(key->type == PLAN_DFT_R2C || key->type == PLAN_DFT_C2R) {
+		/* large enough for the in-place layout, offset by one
+		 * sample when planning for unaligned arrays */
+		double *real = fftw_malloc((2 * length_fd + 1) * sizeof(*real));
+		complex double *cplx = key->in_place ? (complex double *) real : fftw_malloc(length_fd * sizeof(*cplx));
+		double *r = key->aligned ? real : real + 1;
+		complex double *c = key->in_place ? (complex double *) r : cplx;
+		if(key->type == PLAN_DFT_R2C)
+			plan = fftw_plan_dft_r2c_1d(key->n, r, c, key->flags);
+		else
+			plan = fftw_plan_dft_c2r_1d(key->n, c, r, key->flags);
+		if(!key->in_place)
+			fftw_free(cplx);
+		fftw_free(real);
+	} else {
+		float *real = fftwf_malloc((2 * length_fd + 1) * sizeof(*real));
+		complex float *cplx = key->in_place ? (complex float *) real : fftwf_malloc(length_fd * sizeof(*cplx));
+		float *r = key->aligned ? real : real + 1;
+		complex float *c = key->in_place ? (complex float *) r : cplx;
+		if(key->type == PLANF_DFT_R2C)
+			plan = fftwf_plan_dft_r2c_1d(key->n, r, c, key->flags);
+		else
+			plan = fftwf_plan_dft_c2r_1d(key->n, c, r, key->flags);
+		if(!key->in_place)
+			fftwf_free(cplx);
+		fftwf_free(real);
+	}
+
+	return plan;
+}
+
+
+static void *plan_cache_get(int n, enum plan_type type, const void *in, const void *out, unsigned flags)
+{
+	struct plan_key key;
+	struct plan_entry *entry;
+	void *plan;
+
+	make_plan_key(&key, n, type, in, out, flags);
+
+	G_LOCK(plan_cache);
+	plan = plan_cache_lookup(&key);
+	if(plan)
+		plan_cache_hits++;
+	G_UNLOCK(plan_cache);
+	if(plan)
+		return plan;
+
+	/*
+	 * miss.  plan under the wisdom lock, checking again once we have
+	 * it in case another thread was planning the same transform
+	 */
+
+	gstlal_fftw_lock();
+	G_LOCK(plan_cache);
+	plan = plan_cache_lookup(&key);
+	if(plan)
+		plan_cache_hits++;
+	G_UNLOCK(plan_cache);
+	if(plan) {
+		gstlal_fftw_unlock();
+		return plan;
+	}
+
+	plan = make_plan(&key);
+	if(!plan) {
+		gstlal_fftw_unlock();
+		GST_ERROR("FFTW failed to plan a transform of length %d", n);
+		return NULL;
+	}
+
+	entry = g_new(struct plan_entry, 1);
+	entry->key = key;
+	entry->plan = plan;
+	entry->refcount = 1;
+	G_LOCK(plan_cache);
+	g_hash_table_insert(plans_by_key, &entry->key, entry);
+	g_hash_table_insert(plans_by_plan, plan, entry);
+	plan_cache_misses++;
+	GST_DEBUG("planned FFT of length %d (%" G_GUINT64_FORMAT " hits, %" G_GUINT64_FORMAT " misses)", n, plan_cache_hits, plan_cache_misses);
+	G_UNLOCK(plan_cache);
+	gstlal_fftw_unlock();
+
+	return plan;
+}
+
+
+static void plan_cache_release(void *plan)
+{
+	struct plan_entry *entry;
+
+	if(!plan)
+		return;
+	G_LOCK(plan_cache);
+	entry = plans_by_plan ? g_hash_table_lookup(plans_by_plan, plan) : NULL;
+	if(entry && entry->refcount)
+		entry->refcount--;
+	else
+		GST_ERROR("released FFTW plan %p that the plan cache did not hand out", plan);
+	G_UNLOCK(plan_cache);
+}
+
+
+/**
+ * gstlal_fftw_plan_dft_r2c_1d:
+ * @n:  transform length
+ * @in:  the input array the plan will be executed on
+ * @out:  the output array the plan will be executed on, may equal @in
+ * @flags:  FFTW planner flags
+ *
+ * Get a plan for a double-precision real-to-complex transform from the
+ * plan cache, planning it if this is the first request for that length,
+ * flags, alignment and in-placeness.  @in and @out are not touched.
+ * Execute the plan with fftw_execute_dft_r2c() on @in and @out or on any
+ * other arrays with the same alignment and in-placeness;  do not destroy
+ * it, release it with gstlal_fftw_plan_release().
+ *
+ * Returns:  the plan, or NULL if FFTW could not make one
+ */
+
+
+fftw_plan gstlal_fftw_plan_dft_r2c_1d(int n, double *in, complex double *out, unsigned flags)
+{
+	return plan_cache_get(n, PLAN_DFT_R2C, in, out, flags);
+}
+
+
+/**
+ * gstlal_fftw_plan_dft_c2r_1d:
+ * @n:  transform length
+ * @in:  the input array the plan will be executed on
+ * @out:  the output array the plan will be executed on, may equal @in
+ * @flags:  FFTW planner flags
+ *
+ * As gstlal_fftw_plan_dft_r2c_1d() for the complex-to-real transform.
+ * Execute the plan with fftw_execute_dft_c2r().
+ *
+ * Returns:  the plan, or NULL if FFTW could not make one
+ */
+
+
+fftw_plan gstlal_fftw_plan_dft_c2r_1d(int n, complex double *in, double *out, unsigned flags)
+{
+	return plan_cache_get(n, PLAN_DFT_C2R, in, out, flags);
+}
+
+
+/**
+ * gstlal_fftw_plan_release:
+ * @plan:  a plan from gstlal_fftw_plan_dft_r2c_1d() or
+ * gstlal_fftw_plan_dft_c2r_1d(), or NULL
+ *
+ * Give back a plan.  The plan stays in the cache for the next element that
+ * asks for it until gstlal_fftw_plan_cache_clear() is called.
+ */
+
+
+void gstlal_fftw_plan_release(fftw_plan plan)
+{
+	plan_cache_release(plan);
+}
+
+
+/**
+ * gstlal_fftwf_plan_dft_r2c_1d:
+ * @n:  transform length
+ * @in:  the input array the plan will be executed on
+ * @out:  the output array the plan will be executed on, may equal @in
+ * @flags:  FFTW planner flags
+ *
+ * Single-precision version of gstlal_fftw_plan_dft_r2c_1d().  Execute the
+ * plan with fftwf_execute_dft_r2c().
+ *
+ * Returns:  the plan, or NULL if FFTW could not make one
+ */
+
+
+fftwf_plan gstlal_fftwf_plan_dft_r2c_1d(int n, float *in, complex float *out, unsigned flags)
+{
+	return plan_cache_get(n, PLANF_DFT_R2C, in, out, flags);
+}
+
+
+/**
+ * gstlal_fftwf_plan_dft_c2r_1d:
+ * @n:  transform length
+ * @in:  the input array the plan will be executed on
+ * @out:  the output array the plan will be executed on, may equal @in
+ * @flags:  FFTW planner flags
+ *
+ * Single-precision version of gstlal_fftw_plan_dft_c2r_1d().  Execute the
+ * plan with fftwf_execute_dft_c2r().
+ *
+ * Returns:  the plan, or NULL if FFTW could not make one
+ */
+
+
+fftwf_plan gstlal_fftwf_plan_dft_c2r_1d(int n, complex float *in, float *out, unsigned flags)
+{
+	return plan_cache_get(n, PLANF_DFT_C2R, in, out, flags);
+}
+
+
+/**
+ * gstlal_fftwf_plan_release:
+ * @plan:  a plan from gstlal_fftwf_plan_dft_r2c_1d() or
+ * gstlal_fftwf_plan_dft_c2r_1d(), or NULL
+ *
+ * Single-precision version of gstlal_fftw_plan_release().
+ */
+
+
+void gstlal_fftwf_plan_release(fftwf_plan plan)
+{
+	plan_cache_release(plan);
+}
+
+
+/**
+ * gstlal_fftw_plan_cache_warm_up:
+ * @sizes:  transform lengths
+ * @n_sizes:  number of lengths in @sizes
+ * @flags:  FFTW planner flags
+ *
+ * Plan the in-place, SIMD-aligned, double- and single-precision
+ * real-to-complex and complex-to-real transforms of each length, the ones
+ * lal_firbank uses, so that elements created later find them in the cache.
+ * The plans are released again immediately.
+ */
+
+
+void gstlal_fftw_plan_cache_warm_up(const int *sizes, int n_sizes, unsigned flags)
+{
+	int i;
+
+	gstlal_load_fftw_wisdom();
+
+	for(i = 0; i < n_sizes; i++) {
+		int length_fd = sizes[i] / 2 + 1;
+		complex double *d = fftw_malloc(length_fd * sizeof(*d));
+		complex float *f = fftwf_malloc(length_fd * sizeof(*f));
+
+		gstlal_fftw_plan_release(gstlal_fftw_plan_dft_r2c_1d(sizes[i], (double *) d, d, flags));
+		gstlal_fftw_plan_release(gstlal_fftw_plan_dft_c2r_1d(sizes[i], d, (double *) d, flags));
+		gstlal_fftwf_plan_release(gstlal_fftwf_plan_dft_r2c_1d(sizes[i], (float *) f, f, flags));
+		gstlal_fftwf_plan_release(gstlal_fftwf_plan_dft_c2r_1d(sizes[i], f, (float *) f, flags));
+
+		fftw_free(d);
+		fftwf_free(f);
+	}
+}
+
+
+/**
+ * gstlal_fftw_plan_cache_warm_up_from_env:
+ *
+ * Call gstlal_fftw_plan_cache_warm_up() with FFTW_MEASURE for the
+ * comma-separated transform lengths in the environment variable
+ * GSTLAL_FFTW_PLANS, if it is set.
+ */
+
+
+void gstlal_fftw_plan_cache_warm_up_from_env(void)
+{
+	const char *env = getenv(GSTLAL_FFTW_PLANS_ENV);
+	gchar **tokens, **token;
+	int *sizes;
+	int n_sizes = 0;
+
+	if(!env)
+		return;
+
+	tokens = g_strsplit(env, ",", 0);
+	sizes = g_new(int, g_strv_length(tokens));
+	for(token = tokens; *token; token++) {
+		char *end;
+		long n = strtol(*token, &end, 10);
+		if(end == *token || *end || n <= 0 || n > G_MAXINT)
+			GST_ERROR("%s: ignoring invalid transform length \"%s\"", GSTLAL_FFTW_PLANS_ENV, *token);
+		else
+			sizes[n_sizes++] = n;
+	}
+	g_strfreev(tokens);
+
+	gstlal_fftw_plan_cache_warm_up(sizes, n_sizes, FFTW_MEASURE);
+	g_free(sizes);
+}
+
+
+/**
+ * gstlal_fftw_plan_cache_get_stats:
+ * @hits:  (out) (allow-none):  requests answered from the cache
+ * @misses:  (out) (allow-none):  requests that needed planning
+ * @plans:  (out) (allow-none):  plans in the cache
+ *
+ * Report how well the plan cache is doing.
+ */
+
+
+void gstlal_fftw_plan_cache_get_stats(guint64 *hits, guint64 *misses, guint *plans)
+{
+	G_LOCK(plan_cache);
+	if(hits)
+		*hits = plan_cache_hits;
+	if(misses)
+		*misses = plan_cache_misses;
+	if(plans)
+		*plans = plans_by_key ? g_hash_table_size(plans_by_key) : 0;
+	G_UNLOCK(plan_cache);
+}
+
+
+/**
+ * gstlal_fftw_plan_cache_clear:
+ *
+ * Destroy the plans nobody is holding.
+ */
+
+
+void gstlal_fftw_plan_cache_clear(void)
+{
+	GHashTableIter iter;
+	struct plan_entry *entry;
+
+	gstlal_fftw_lock();
+	G_LOCK(plan_cache);
+	if(plans_by_key) {
+		g_hash_table_iter_init(&iter, plans_by_key);
+		while(g_hash_table_iter_next(&iter, NULL, (gpointer *) &entry)) {
+			if(entry->refcount)
+				continue;
+			g_hash_table_iter_remove(&iter);
+			g_hash_table_remove(plans_by_plan, entry->plan);
+			if(entry->key.type == PLAN_DFT_R2C || entry->key.type == PLAN_DFT_C2R)
+				fftw_destroy_plan(entry->plan);
+			else
+				fftwf_destroy_plan(entry->plan);
+			g_free(entry);
+		}
+	}
+	G_UNLOCK(plan_cache);
+	gstlal_fftw_unlock();
+}
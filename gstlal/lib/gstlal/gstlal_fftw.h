@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2026  The gstlal authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifndef __GSTLAL_FFTW_H__
+#define __GSTLAL_FFTW_H__
+
+
+/*
+ * ============================================================================
+ *
+ *                                  Preamble
+ *
+ * ============================================================================
+ */
+
+
+#include <complex.h>
+#include <glib.h>
+#include <fftw3.h>
+
+
+G_BEGIN_DECLS
+
+
+/*
+ * ============================================================================
+ *
+ *                                 Prototypes
+ *
+ * ============================================================================
+ */
+
+
+fftw_plan gstlal_fftw_plan_dft_r2c_1d(int n, double *in, complex double *out, unsigned flags);
+fftw_plan gstlal_fftw_plan_dft_c2r_1d(int n, complex double *in, double *out, unsigned flags);
+void gstlal_fftw_plan_release(fftw_plan plan);
+
+fftwf_plan gstlal_fftwf_plan_dft_r2c_1d(int n, float *in, complex float *out, unsigned flags);
+fftwf_plan gstlal_fftwf_plan_dft_c2r_1d(int n, complex float *in, float *out, unsigned flags);
+void gstlal_fftwf_plan_release(fftwf_plan plan);
+
+void gstlal_fftw_plan_cache_warm_up(const int *sizes, int n_sizes, unsigned flags);
+void gstlal_fftw_plan_cache_warm_up_from_env(void);
+void gstlal_fftw_plan_cache_get_stats(guint64 *hits, guint64 *misses, guint *plans);
+void gstlal_fftw_plan_cache_clear(void);
+
+
+G_END_DECLS
+
+
+#endif	/* __GSTLAL_FFTW_H__ */
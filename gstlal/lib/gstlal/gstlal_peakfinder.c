@@ -20,6 +20,8 @@ struct gstlal_peak_state *gstlal_peak_state_new(guint channels, gstlal_peak_type
 	new->channels = channels;
 	new->samples = g_malloc0(sizeof(guint) * channels);
 	new->interpsamples = g_malloc0(sizeof(double) * channels);
+	/* big enough for either precision */
+	new->absvalues.as_double = g_malloc0(sizeof(double) * channels);
 	new->num_events = 0;
 	new->pad = 0;
 	new->thresh = 0;
@@ -68,6 +70,7 @@ int gstlal_peak_state_free(struct gstlal_peak_state *val)
 {
 	g_free(val->samples);
 	g_free(val->interpsamples);
+	g_free(val->absvalues.as_double);
 	g_free(val->values.as_float);
 	g_free(val->interpvalues.as_float);
 	XLALDestroyLanczosTriggerInterpolant(val->interp);
@@ -79,6 +82,7 @@ int gstlal_peak_state_clear(struct gstlal_peak_state *val)
 {
 	memset(val->samples, 0.0, val->channels * sizeof(guint));
 	memset(val->interpsamples, 0.0, val->channels * sizeof(double));
+	memset(val->absvalues.as_double, 0.0, val->channels * sizeof(double));
 	memset(val->values.as_float, 0.0, val->channels * val->unit);
 	memset(val->interpvalues.as_float, 0.0, val->channels * val->unit);
 	val->num_events = 0;
@@ -173,24 +177,24 @@ int gstlal_peak_over_window(struct gstlal_peak_state *state, const void *data, g
 }
 
 /* A convenience function to find the series around a peak based on the type specified by state */
-int gstlal_series_around_peak(struct gstlal_peak_state *state, void *data, void *outputmat, guint n)
+int gstlal_series_around_peak(struct gstlal_peak_state *state, const void *data, void *outputmat, guint n)
 {	
 	switch (state->type)
 	{
 		case GSTLAL_PEAK_FLOAT:
-		return gstlal_float_series_around_peak(state, (float *) data, (float *) outputmat, n);
+		return gstlal_float_series_around_peak(state, (const float *) data, (float *) outputmat, n);
 		break;
 		
 		case GSTLAL_PEAK_DOUBLE:
-		return gstlal_double_series_around_peak(state, (double *) data, (double *) outputmat, n);
+		return gstlal_double_series_around_peak(state, (const double *) data, (double *) outputmat, n);
 		break;
 		
 		case GSTLAL_PEAK_COMPLEX:
-		return gstlal_float_complex_series_around_peak(state, (float complex *) data, (float complex *) outputmat, n);
+		return gstlal_float_complex_series_around_peak(state, (const float complex *) data, (float complex *) outputmat, n);
 		break;
 
 		case GSTLAL_PEAK_DOUBLE_COMPLEX:
-		return gstlal_double_complex_series_around_peak(state, (double complex *) data, (double complex *) outputmat, n);
+		return gstlal_double_complex_series_around_peak(state, (const double complex *) data, (double complex *) outputmat, n);
 		break;
 
 		default:
@@ -206,7 +210,9 @@ int gstlal_series_around_peak(struct gstlal_peak_state *state, void *data, void
  */
 
 /* float */
-#define ABSFUNC(x) x * x
+#define ABSFUNC(x) ((x) * (x))
+#define ABSTYPE float
+#define ABSMEMBER(structure) structure ## _float
 #define TYPE_STRING float
 #define XLAL_TYPE_STRING REAL4
 #define TYPE float
@@ -215,9 +221,13 @@ int gstlal_series_around_peak(struct gstlal_peak_state *state, void *data, void
 #undef TYPE_STRING
 #undef XLAL_TYPE_STRING
 #undef ABSFUNC
+#undef ABSTYPE
+#undef ABSMEMBER
 
 /* double */
-#define ABSFUNC(x) x * x
+#define ABSFUNC(x) ((x) * (x))
+#define ABSTYPE double
+#define ABSMEMBER(structure) structure ## _double
 #define TYPE_STRING double
 #define XLAL_TYPE_STRING REAL8
 #define TYPE double
@@ -226,9 +236,13 @@ int gstlal_series_around_peak(struct gstlal_peak_state *state, void *data, void
 #undef TYPE_STRING
 #undef XLAL_TYPE_STRING
 #undef ABSFUNC
+#undef ABSTYPE
+#undef ABSMEMBER
 
 /* float complex */
-#define ABSFUNC(x) ((float *) &x)[0] * ((float *) &x)[0] + ((float *) &x)[1] * ((float *) &x)[1]
+#define ABSFUNC(x) (crealf(x) * crealf(x) + cimagf(x) * cimagf(x))
+#define ABSTYPE float
+#define ABSMEMBER(structure) structure ## _float
 #define TYPE_STRING float_complex
 #define XLAL_TYPE_STRING COMPLEX8
 #define TYPE float complex
@@ -237,9 +251,13 @@ int gstlal_series_around_peak(struct gstlal_peak_state *state, void *data, void
 #undef TYPE_STRING
 #undef XLAL_TYPE_STRING
 #undef ABSFUNC
+#undef ABSTYPE
+#undef ABSMEMBER
 
 /* double complex */
-#define ABSFUNC(x) ((double *) &x)[0] * ((double *) &x)[0] + ((double *) &x)[1] * ((double *) &x)[1]
+#define ABSFUNC(x) (creal(x) * creal(x) + cimag(x) * cimag(x))
+#define ABSTYPE double
+#define ABSMEMBER(structure) structure ## _double
 #define TYPE_STRING double_complex
 #define XLAL_TYPE_STRING COMPLEX16
 #define TYPE double complex
@@ -248,4 +266,6 @@ int gstlal_series_around_peak(struct gstlal_peak_state *state, void *data, void
 #undef TYPE_STRING
 #undef XLAL_TYPE_STRING
 #undef ABSFUNC
+#undef ABSTYPE
+#undef ABSMEMBER
 
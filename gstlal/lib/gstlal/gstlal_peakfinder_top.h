@@ -39,6 +39,12 @@ struct gstlal_peak_state {
 		float complex * as_float_complex;
 		double complex * as_double_complex;
 		} interpvalues;
+	/* running maximum of |value|^2 of each channel, single precision for
+	 * the float types and double precision otherwise */
+	union	{
+		float * as_float;
+		double * as_double;
+		} absvalues;
 	gstlal_peak_type_specifier type;
 	guint unit;
 	guint pad;
@@ -66,7 +72,7 @@ int gstlal_peak_state_clear(struct gstlal_peak_state *state);
 /* Convenience functions */
 GstBuffer *gstlal_new_buffer_from_peak(struct gstlal_peak_state *input, GstPad *pad, guint64 offset, guint64 length, GstClockTime time, guint rate);
 int gstlal_peak_over_window(struct gstlal_peak_state *state, const void *data, guint64 length);
-int gstlal_series_around_peak(struct gstlal_peak_state *state, void *data, void *outputmat, guint n);
+int gstlal_series_around_peak(struct gstlal_peak_state *state, const void *data, void *outputmat, guint n);
 
 
 /*
@@ -34,6 +34,12 @@
  * code is to support passing segment lists through #GObject properties as
  * #GValueArrays, not to implement a segment arithmetic library.
  *
+ * Elements that must answer "which segment contains this time" for every
+ * buffer should build a struct gstlal_segment_index from the list with
+ * gstlal_segment_index_new().  The index is a sorted, coalesced copy of
+ * the list that is searched by bisection, and a caller-held cursor makes
+ * the typical monotonically-increasing sequence of queries O(1) each.
+ *
  * Reviewed:  fd83b7bb2e8c918577ab7b06b5c358fbef14310f  2014-08-13  K. Cannon, J. Creighton, B. Sathyaprakash.
  */
 
@@ -47,10 +53,51 @@
  */
 
 
+#include <stdlib.h>
+#include <string.h>
 #include <glib.h>
 #include <gstlal_segments.h>
 
 
+/*
+ * ============================================================================
+ *
+ *                               Internal Code
+ *
+ * ============================================================================
+ */
+
+
+/*
+ * bisection search for the first segment in the array for which t < stop.
+ * requires the stops to be non-decreasing.
+ */
+
+
+static gint bisect_stop(const struct gstlal_segment *segments, gint lo, gint hi, guint64 t)
+{
+	while(lo < hi) {
+		gint mid = lo + (hi - lo) / 2;
+		if(t < segments[mid].stop)
+			hi = mid;
+		else
+			lo = mid + 1;
+	}
+	return lo;
+}
+
+
+static int segment_cmp(const void *a, const void *b)
+{
+	const struct gstlal_segment *seg_a = a, *seg_b = b;
+	if(seg_a->start != seg_b->start)
+		return seg_a->start < seg_b->start ? -1 : +1;
+	if(seg_a->stop != seg_b->stop)
+		return seg_a->stop < seg_b->stop ? -1 : +1;
+	return 0;
+}
+
+
 /*
  * ============================================================================
  *
@@ -125,6 +172,7 @@ struct gstlal_segment_list *gstlal_segment_list_new(void)
 
 	new->segments = NULL;
 	new->length = 0;
+	new->ordered = TRUE;
 
 	return  new;
 }
@@ -179,7 +227,8 @@ gint gstlal_segment_list_length(const struct gstlal_segment_list *segmentlist)
  *
  * Note that no check is made to ensure the segments in the list are in
  * order and disjoint.  Any conditions such as those must be enforced by
- * the application.
+ * the application.  The list does record whether the segments' stops are
+ * in non-decreasing order, which decides how it is searched.
  *
  * Returns:  the struct gstlal_segment_list or NULL on failure.
  */
@@ -195,6 +244,8 @@ struct gstlal_segment_list *gstlal_segment_list_append(struct gstlal_segment_lis
 	}
 
 	segmentlist->segments = new_segments;
+	if(segmentlist->length && segment->stop < segmentlist->segments[segmentlist->length - 1].stop)
+		segmentlist->ordered = FALSE;
 	segmentlist->segments[segmentlist->length] = *segment;
 	gstlal_segment_free(segment);
 	segmentlist->length += 1;
@@ -209,7 +260,9 @@ struct gstlal_segment_list *gstlal_segment_list_append(struct gstlal_segment_lis
  * @t:  the value to search for
  *
  * Search for the first struct gstlal_segment in @segmentlist for which t <
- * stop.
+ * stop.  If the segments' stops are in non-decreasing order, as they are
+ * if the segments are in order and disjoint, the search is a bisection,
+ * otherwise the list is scanned from the start.
  *
  * Returns:  the index of the first matching struct gstlal_segment or the
  * length of the list if no struct gstlal_segments match.
@@ -220,6 +273,9 @@ gint gstlal_segment_list_index(const struct gstlal_segment_list *segmentlist, gu
 {
 	gint i;
 
+	if(segmentlist->ordered)
+		return bisect_stop(segmentlist->segments, 0, segmentlist->length, t);
+
 	for(i = 0; i < segmentlist->length; i++)
 		if(t < segmentlist->segments[i].stop)
 			break;
@@ -261,20 +317,49 @@ struct gstlal_segment_list *gstlal_segment_list_get_range(const struct gstlal_se
 {
 	struct gstlal_segment_list *new = gstlal_segment_list_new();
 	gint lo, hi;
-	gint i;
 
 	if(!new)
 		return NULL;
 
-	lo = gstlal_segment_list_index(segmentlist, start);
-	hi = gstlal_segment_list_index(segmentlist, stop);
-
-	for(i = lo; i <= hi; i++) {
-		if(i >= segmentlist->length || segmentlist->segments[i].start >= stop)
-			continue;
-		if(!gstlal_segment_list_append(new, gstlal_segment_new(segmentlist->segments[i].start, segmentlist->segments[i].stop))) {
-			gstlal_segment_list_free(new);
-			return NULL;
+	if(!segmentlist->ordered) {
+		/*
+		 * no order to exploit:  take the segments between the
+		 * first to end after start and the first to end after
+		 * stop that begin before stop, as the list always has
+		 */
+
+		gint i;
+
+		lo = gstlal_segment_list_index(segmentlist, start);
+		hi = gstlal_segment_list_index(segmentlist, stop);
+
+		for(i = lo; i <= hi; i++) {
+			if(i >= segmentlist->length || segmentlist->segments[i].start >= stop)
+				continue;
+			if(!gstlal_segment_list_append(new, gstlal_segment_new(segmentlist->segments[i].start, segmentlist->segments[i].stop))) {
+				gstlal_segment_list_free(new);
+				return NULL;
+			}
+		}
+	} else {
+		/*
+		 * segments [lo, hi) are those with start < stop and start <
+		 * seg.stop.  the first is found by bisection, the last by
+		 * walking forward from it, so the cost is O(log n + k) for k
+		 * segments in the range.
+		 */
+
+		lo = gstlal_segment_list_index(segmentlist, start);
+		for(hi = lo; hi < segmentlist->length && segmentlist->segments[hi].start < stop; hi++);
+
+		if(hi > lo) {
+			new->segments = g_try_new(struct gstlal_segment, hi - lo);
+			if(!new->segments) {
+				gstlal_segment_list_free(new);
+				return NULL;
+			}
+			memcpy(new->segments, &segmentlist->segments[lo], (hi - lo) * sizeof(*new->segments));
+			new->length = hi - lo;
 		}
 	}
 
@@ -289,6 +374,186 @@ struct gstlal_segment_list *gstlal_segment_list_get_range(const struct gstlal_se
 }
 
 
+/**
+ * gstlal_segment_index_new:
+ * @segmentlist:  the struct gstlal_segment_list to index
+ *
+ * Construct a struct gstlal_segment_index from a struct
+ * gstlal_segment_list.  The segments are copied, sorted, and overlapping
+ * or abutting segments are merged, so the index represents the union of
+ * the segments in @segmentlist regardless of their order.  Empty segments
+ * are discarded.  The index does not refer to @segmentlist after it has
+ * been constructed.
+ *
+ * See also:  gstlal_segment_index_free()
+ *
+ * Returns:  the newly-allocated struct gstlal_segment_index or %NULL on
+ * failure.
+ */
+
+
+struct gstlal_segment_index *gstlal_segment_index_new(const struct gstlal_segment_list *segmentlist)
+{
+	struct gstlal_segment_index *new = g_new(struct gstlal_segment_index, 1);
+	gint i;
+
+	if(!new)
+		return NULL;
+
+	new->segments = NULL;
+	new->length = 0;
+	if(!segmentlist->length)
+		return new;
+
+	new->segments = g_try_new(struct gstlal_segment, segmentlist->length);
+	if(!new->segments) {
+		g_free(new);
+		return NULL;
+	}
+	memcpy(new->segments, segmentlist->segments, segmentlist->length * sizeof(*new->segments));
+	qsort(new->segments, segmentlist->length, sizeof(*new->segments), segment_cmp);
+
+	/*
+	 * coalesce in place
+	 */
+
+	for(i = 0; i < segmentlist->length; i++) {
+		struct gstlal_segment *seg = &new->segments[i];
+		if(seg->stop <= seg->start)
+			continue;
+		if(new->length && seg->start <= new->segments[new->length - 1].stop)
+			new->segments[new->length - 1].stop = MAX(new->segments[new->length - 1].stop, seg->stop);
+		else
+			new->segments[new->length++] = *seg;
+	}
+
+	return new;
+}
+
+
+/**
+ * gstlal_segment_index_free:
+ * @index:  the struct gstlal_segment_index to free
+ *
+ * Frees all memory associated with a struct gstlal_segment_index.
+ *
+ * See also:  gstlal_segment_index_new()
+ */
+
+
+void gstlal_segment_index_free(struct gstlal_segment_index *index)
+{
+	if(index) {
+		g_free(index->segments);
+		index->segments = NULL;
+	}
+	g_free(index);
+}
+
+
+/**
+ * gstlal_segment_index_length:
+ * @index:  a struct gstlal_segment_index
+ *
+ * Returns:  the number of (coalesced) segments in the index.
+ */
+
+
+gint gstlal_segment_index_length(const struct gstlal_segment_index *index)
+{
+	return index->length;
+}
+
+
+/**
+ * gstlal_segment_index_get:
+ * @index:  a struct gstlal_segment_index
+ * @i:  the position of the segment to retrieve
+ *
+ * Returns:  the struct gstlal_segment at the requested position in the
+ * index.  The address is a pointer into the index, it cannot be free'ed.
+ */
+
+
+const struct gstlal_segment *gstlal_segment_index_get(const struct gstlal_segment_index *index, gint i)
+{
+	return &index->segments[i];
+}
+
+
+/**
+ * gstlal_segment_index_search:
+ * @index:  the struct gstlal_segment_index to search
+ * @t:  the value to search for
+ * @cursor:  if not %NULL, the address of a #gint holding the result of a
+ * previous search.  Initialize it to 0 before the first search.
+ *
+ * Search for the first segment in @index for which t < stop.  If @cursor
+ * is not %NULL the segment it identifies and the one following it are
+ * checked before falling back to a bisection search, so a sequence of
+ * queries at non-decreasing times costs O(1) each.  The cursor is updated
+ * with the result.  Each thread doing searches must use its own cursor.
+ *
+ * The segment containing @t, if any, is the segment at the returned
+ * position if its start is <= @t.
+ *
+ * Returns:  the position of the first matching segment or the length of
+ * the index if no segments match.
+ */
+
+
+gint gstlal_segment_index_search(const struct gstlal_segment_index *index, guint64 t, gint *cursor)
+{
+	gint i;
+
+	if(cursor && *cursor >= 0 && *cursor <= index->length) {
+		/* is the answer at or just after the last hit? */
+		for(i = *cursor; i <= index->length && i <= *cursor + 1; i++)
+			if((i == index->length || t < index->segments[i].stop) && (i == 0 || t >= index->segments[i - 1].stop)) {
+				*cursor = i;
+				return i;
+			}
+	}
+
+	i = bisect_stop(index->segments, 0, index->length, t);
+	if(cursor)
+		*cursor = i;
+	return i;
+}
+
+
+/**
+ * gstlal_segment_index_get_range:
+ * @index:  a struct gstlal_segment_index
+ * @start:  the start of the range
+ * @stop:  the end of the range
+ * @cursor:  cursor passed to gstlal_segment_index_search(), or %NULL
+ * @first:  the address of a pointer that will be set to the first segment
+ * intersecting [start, stop), or %NULL if there are none
+ *
+ * Find the segments in @index that intersect [start, stop).  Because the
+ * segments in the index are sorted and disjoint these form a contiguous
+ * block beginning at *@first.  Unlike gstlal_segment_list_get_range() no
+ * new list is constructed and the segments are not clipped to the range;
+ * the calling code must do that if it's needed.  The cost is that of one
+ * gstlal_segment_index_search() plus O(k) for k segments in the range.
+ *
+ * Returns:  the number of segments intersecting [start, stop).
+ */
+
+
+gint gstlal_segment_index_get_range(const struct gstlal_segment_index *index, guint64 start, guint64 stop, gint *cursor, const struct gstlal_segment **first)
+{
+	gint lo = gstlal_segment_index_search(index, start, cursor);
+	gint hi;
+
+	for(hi = lo; hi < index->length && index->segments[hi].start < stop; hi++);
+
+	*first = hi > lo ? &index->segments[lo] : NULL;
+	return hi - lo;
+}
+
+
 /**
  * gstlal_segment_from_g_value_array:
  * @va:  a two-element #GValueArray
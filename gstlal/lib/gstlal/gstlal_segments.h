@@ -56,6 +56,22 @@ struct gstlal_segment_list {
 	/*< private >*/
 	struct gstlal_segment *segments;
 	gint length;
+	gboolean ordered;
+};
+
+
+/**
+ * struct gstlal_segment_index:
+ *
+ * The opaque gstlal_segment_index structure.  A sorted, coalesced copy of
+ * a struct gstlal_segment_list supporting logarithmic-time searches.
+ */
+
+
+struct gstlal_segment_index {
+	/*< private >*/
+	struct gstlal_segment *segments;
+	gint length;
 };
 
 
@@ -69,6 +85,13 @@ gint gstlal_segment_list_index(const struct gstlal_segment_list *segmentlist, gu
 struct gstlal_segment *gstlal_segment_list_get(struct gstlal_segment_list *segmentlist, gint index);
 struct gstlal_segment_list *gstlal_segment_list_get_range(const struct gstlal_segment_list *segmentlist, guint64 start, guint64 stop);
 
+struct gstlal_segment_index *gstlal_segment_index_new(const struct gstlal_segment_list *segmentlist);
+void gstlal_segment_index_free(struct gstlal_segment_index *index);
+gint gstlal_segment_index_length(const struct gstlal_segment_index *index);
+const struct gstlal_segment *gstlal_segment_index_get(const struct gstlal_segment_index *index, gint i);
+gint gstlal_segment_index_search(const struct gstlal_segment_index *index, guint64 t, gint *cursor);
+gint gstlal_segment_index_get_range(const struct gstlal_segment_index *index, guint64 start, guint64 stop, gint *cursor, const struct gstlal_segment **first);
+
 struct gstlal_segment_list *gstlal_segment_list_from_g_value_array(GValueArray *va);
 struct gstlal_segment *gstlal_segment_from_g_value_array(GValueArray *va);
 GValueArray * g_value_array_from_gstlal_segment(struct gstlal_segment seg);
@@ -47,6 +47,7 @@
 
 
 import optparse
+import os
 import sys
 import time
 
@@ -324,9 +325,9 @@ class GWDataSourceInfo(object):
 		Initialize a GWDataSourceInfo class instance from command line options specified by append_options()
 		""" 
 
-		## A list of possible, valid data sources ("frames", "framexmit", "lvshm", "nds", "white", "silence", "AdvVirgo", "LIGO", "AdvLIGO")
-		self.data_sources = set(("frames", "framexmit", "lvshm", "nds", "white", "silence", "AdvVirgo", "LIGO", "AdvLIGO"))
-		self.live_sources = set(("framexmit", "lvshm"))
+		## A list of possible, valid data sources ("frames", "framexmit", "lvshm", "dirwatch", "nds", "white", "silence", "AdvVirgo", "LIGO", "AdvLIGO")
+		self.data_sources = set(("frames", "framexmit", "lvshm", "dirwatch", "nds", "white", "silence", "AdvVirgo", "LIGO", "AdvLIGO"))
+		self.live_sources = set(("framexmit", "lvshm", "dirwatch"))
 		assert self.live_sources <= self.data_sources
 
 		# Sanity check the options
@@ -356,6 +357,11 @@ class GWDataSourceInfo(object):
 		self.shm_assumed_duration = options.shared_memory_assumed_duration
 		self.shm_block_size = options.shared_memory_block_size # NOTE: should this be incorporated into options.block_size? currently only used for offline data sources
 
+		## A dictionary of directories watched for frame files, e.g., {"H1": "/dev/shm/llhoft/H1"}
+		self.frame_dir_dict = dict((instrument, os.path.join("/dev/shm/llhoft", instrument)) for instrument in self.channel_dict)
+		if options.frame_directory is not None:
+			self.frame_dir_dict.update( channel_dict_from_channel_list(options.frame_directory) )
+
 		## A dictionary of framexmit addresses
 		self.framexmit_addr = framexmit_ports["CIT"]
 		if options.framexmit_addr is not None:
@@ -461,7 +467,7 @@ def append_options(parser):
 	for applications that read GW data.
 	
 -	--data-source [string]
-		Set the data source from [frames|framexmit|lvshm|nds|silence|white|AdvVirgo|LIGO|AdvLIGO].
+		Set the data source from [frames|framexmit|lvshm|dirwatch|nds|silence|white|AdvVirgo|LIGO|AdvLIGO].
 
 -	--block-size [int] (bytes)
 		Data block size to read in bytes. Default 16384 * 8 * 512 which is 512 seconds of double
@@ -519,6 +525,10 @@ def append_options(parser):
 		Set the name of the shared memory partition for a given instrument.
 		Can be given multiple times as --shared-memory-partition=IFO=PARTITION-NAME
 
+-	--frame-directory [string]
+		Set the directory watched for new frame files for a given instrument when --data-source=dirwatch.
+		Can be given multiple times as --frame-directory=IFO=DIRECTORY.  Default = /dev/shm/llhoft/IFO.
+
 -	--shared-memory-assumed-duration [int]
 		Set the assumed span of files in seconds. Default = 4 seconds.
 
@@ -570,7 +580,7 @@ def append_options(parser):
 	-# Many other combinations possible, please add some!
 	"""
 	group = optparse.OptionGroup(parser, "Data source options", "Use these options to set up the appropriate data source")
-	group.add_option("--data-source", metavar = "source", help = "Set the data source from [frames|framexmit|lvshm|nds|silence|white|AdvVirgo|LIGO|AdvLIGO].  Required.")
+	group.add_option("--data-source", metavar = "source", help = "Set the data source from [frames|framexmit|lvshm|dirwatch|nds|silence|white|AdvVirgo|LIGO|AdvLIGO].  Required.")
 	group.add_option("--block-size", type="int", metavar = "bytes", default = 16384 * 8 * 512, help = "Data block size to read in bytes. Default 16384 * 8 * 512 (512 seconds of double precision data at 16384 Hz.  This parameter is only used if --data-source is one of white, silence, AdvVirgo, LIGO, AdvLIGO, nds.")
 	group.add_option("--frame-cache", metavar = "filename", help = "Set the name of the LAL cache listing the LIGO-Virgo .gwf frame files (optional).  This is required iff --data-source=frames")
 	group.add_option("--gps-start-time", metavar = "seconds", help = "Set the start time of the segment to analyze in GPS seconds. Required unless --data-source=lvshm")
@@ -585,6 +595,7 @@ def append_options(parser):
 	group.add_option("--state-channel-name", metavar = "name", action = "append", help = "Set the name of the state vector channel.  This channel will be used to control the flow of data via the on/off bits.  Can be given multiple times as --channel-name=IFO=CHANNEL-NAME")
 	group.add_option("--dq-channel-name", metavar = "name", action = "append", help = "Set the name of the data quality channel.  This channel will be used to control the flow of data via the on/off bits.  Can be given multiple times as --channel-name=IFO=CHANNEL-NAME")
 	group.add_option("--shared-memory-partition", metavar = "name", action = "append", help = "Set the name of the shared memory partition for a given instrument.  Can be given multiple times as --shared-memory-partition=IFO=PARTITION-NAME")
+	group.add_option("--frame-directory", metavar = "directory", action = "append", help = "Set the directory watched for new frame files for a given instrument when --data-source=dirwatch.  Can be given multiple times as --frame-directory=IFO=DIRECTORY.  Default = /dev/shm/llhoft/IFO.")
 	group.add_option("--shared-memory-assumed-duration", type = "int", default = 4, help = "Set the assumed span of files in seconds. Default = 4.")
 	group.add_option("--shared-memory-block-size", type = "int", default = 4096, help = "Set the byte size to read per buffer. Default = 4096.")
 	group.add_option("--frame-segments-file", metavar = "filename", help = "Set the name of the LIGO light-weight XML file from which to load frame segments.  Optional iff --data-source=frames")
@@ -798,7 +809,7 @@ def mkbasicsrc(pipeline, gw_data_source_info, instrument, nxydump_segment = None
 			statevector = pipeparts.mkqueue(pipeline, statevector, max_size_buffers = 0, max_size_bytes = 0, max_size_time = gst.SECOND * 60 * 12)
 		src = pipeparts.mkqueue(pipeline, src, max_size_buffers = 0, max_size_bytes = 0, max_size_time = gst.SECOND * 60 * 10)
 	
-	elif gw_data_source_info.data_source in ("framexmit", "lvshm"):
+	elif gw_data_source_info.data_source in ("framexmit", "lvshm", "dirwatch"):
 		# See https://wiki.ligo.org/DAC/ER2DataDistributionPlan#LIGO_Online_DQ_Channel_Specifica
 		state_vector_on_bits, state_vector_off_bits = gw_data_source_info.state_vector_on_off_bits[instrument]
 		dq_vector_on_bits, dq_vector_off_bits = gw_data_source_info.dq_vector_on_off_bits[instrument]
@@ -808,6 +819,8 @@ def mkbasicsrc(pipeline, gw_data_source_info, instrument, nxydump_segment = None
 			src = pipeparts.mklvshmsrc(pipeline, shm_name = gw_data_source_info.shm_part_dict[instrument], assumed_duration = gw_data_source_info.shm_assumed_duration, blocksize = gw_data_source_info.shm_block_size, wait_time = 120)
 		elif gw_data_source_info.data_source == "framexmit":
 			src = pipeparts.mkframexmitsrc(pipeline, multicast_iface = gw_data_source_info.framexmit_iface, multicast_group = gw_data_source_info.framexmit_addr[instrument][0], port = gw_data_source_info.framexmit_addr[instrument][1], wait_time = 120)
+		elif gw_data_source_info.data_source == "dirwatch":
+			src = pipeparts.mkdirwatchsrc(pipeline, location = gw_data_source_info.frame_dir_dict[instrument])
 		else:
 			# impossible code path
 			raise ValueError(gw_data_source_info.data_source)
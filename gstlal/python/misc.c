@@ -28,6 +28,7 @@
 
 #include <Python.h>
 #include <numpy/arrayobject.h>
+#include <limits.h>
 #include <stdlib.h>
 
 
@@ -109,6 +110,66 @@ static PyObject *gstlal_cdf_weighted_chisq_P_wrapper(PyObject *self, PyObject *a
 }
 
 
+static PyObject *gstlal_cdf_weighted_chisq_P_array_wrapper(PyObject *self, PyObject *args)
+{
+	PyArrayObject *A, *noncent, *dof;
+	PyObject *c_obj;
+	PyArrayObject *c, *P;
+	int *dof_local;
+	double var, accuracy;
+	npy_intp N, M;
+	int lim;
+	int nthreads = 0;
+	npy_intp i;
+
+	if(!PyArg_ParseTuple(args, "O!O!O!dOid|i", &PyArray_Type, &A, &PyArray_Type, &noncent, &PyArray_Type, &dof, &var, &c_obj, &lim, &accuracy, &nthreads))
+		return NULL;
+	A = get_continuous_1d_pyarray(A, NPY_DOUBLE);
+	noncent = get_continuous_1d_pyarray(noncent, NPY_DOUBLE);
+	dof = get_continuous_1d_pyarray(dof, NPY_LONG);
+	c = (PyArrayObject *) PyArray_ContiguousFromAny(c_obj, NPY_DOUBLE, 0, 0);
+	if(!A || !noncent || !dof || !c) {
+		Py_XDECREF(A); Py_XDECREF(noncent); Py_XDECREF(dof); Py_XDECREF(c);
+		return NULL;
+	}
+
+	N = PyArray_SIZE(A);
+	if(N != PyArray_SIZE(noncent) || N != PyArray_SIZE(dof)) {
+		PyErr_SetString(PyExc_ValueError, "array size mismatch");
+		Py_DECREF(A); Py_DECREF(noncent); Py_DECREF(dof); Py_DECREF(c);
+		return NULL;
+	}
+	M = PyArray_SIZE(c);
+	/* the library counts variables and points with ints */
+	if(N > INT_MAX || M > INT_MAX) {
+		PyErr_SetString(PyExc_ValueError, "array too large");
+		Py_DECREF(A); Py_DECREF(noncent); Py_DECREF(dof); Py_DECREF(c);
+		return NULL;
+	}
+
+	/* result has the shape of c */
+	P = (PyArrayObject *) PyArray_SimpleNew(PyArray_NDIM(c), PyArray_DIMS(c), NPY_DOUBLE);
+	dof_local = malloc(N * sizeof(*dof_local));
+	if(!P || !dof_local) {
+		free(dof_local);
+		Py_XDECREF(P);
+		Py_DECREF(A); Py_DECREF(noncent); Py_DECREF(dof); Py_DECREF(c);
+		return PyErr_NoMemory();
+	}
+	for(i = 0; i < N; i++)
+		dof_local[i] = ((long *) PyArray_DATA(dof))[i];
+
+	Py_BEGIN_ALLOW_THREADS
+	gstlal_cdf_weighted_chisq_P_array((double *) PyArray_DATA(A), (double *) PyArray_DATA(noncent), dof_local, (int) N, var, (double *) PyArray_DATA(c), (double *) PyArray_DATA(P), (int) M, lim, accuracy, NULL, nthreads);
+	Py_END_ALLOW_THREADS
+
+	free(dof_local);
+	Py_DECREF(A); Py_DECREF(noncent); Py_DECREF(dof); Py_DECREF(c);
+
+	return PyArray_Return(P);
+}
+
+
 /*
  * ============================================================================
  *
@@ -120,6 +181,7 @@ static PyObject *gstlal_cdf_weighted_chisq_P_wrapper(PyObject *self, PyObject *a
 
 static struct PyMethodDef methods[] = {
 	{"cdf_weighted_chisq_P", gstlal_cdf_weighted_chisq_P_wrapper, METH_VARARGS, NULL},
+	{"cdf_weighted_chisq_P_array", gstlal_cdf_weighted_chisq_P_array_wrapper, METH_VARARGS, "cdf_weighted_chisq_P_array(A, noncent, dof, var, c, lim, accuracy[, nthreads])\n\nEvaluate cdf_weighted_chisq_P() at every element of c.  Returns an array of the shape of c, with NaN where the evaluation failed, as cdf_weighted_chisq_P() gives.  A possibly significant round-off error (fault 2) is not a failure, and the value is returned.  The points are shared among nthreads threads, one per processor if <= 0 (the default)."},
 	{NULL, }
 };
 
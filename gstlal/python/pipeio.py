@@ -131,6 +131,10 @@ def caps_from_numpy_dtype(dtype):
 		caps = gst.Caps("audio/x-raw-float, width=32")
 	elif dtype.char == 'd':
 		caps = gst.Caps("audio/x-raw-float, width=64")
+	elif dtype.char == 'F':
+		caps = gst.Caps("audio/x-raw-complex, width=64")
+	elif dtype.char == 'D':
+		caps = gst.Caps("audio/x-raw-complex, width=128")
 	elif dtype.char == 'b':
 		caps = gst.Caps("audio/x-raw-int, width=8, signed=true")
 	elif dtype.char == 'B':
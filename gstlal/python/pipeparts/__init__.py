@@ -290,6 +290,11 @@ def mklalcachesrc(pipeline, location, use_mmap = True, **properties):
 	return mkgeneric(pipeline, None, "lal_cachesrc", location = location, use_mmap = use_mmap, **properties)
 
 
+## Adds a <a href="@gstlalgtkdoc/GstLALDirWatchSrc.html">lal_dirwatchsrc</a> element to a pipeline with useful default properties
+def mkdirwatchsrc(pipeline, location, **properties):
+	return mkgeneric(pipeline, None, "lal_dirwatchsrc", location = location, **properties)
+
+
 def mklvshmsrc(pipeline, shm_name, **properties):
 	return mkgeneric(pipeline, None, "gds_lvshmsrc", shm_name = shm_name, **properties)
 
@@ -892,6 +897,9 @@ def mkcomputegamma(pipeline, dctrl, exc, cos, sin, **properties):
 def mkbursttriggergen(pipeline, src, **properties):
 	return mkgeneric(pipeline, src, "lal_bursttriggergen", **properties)
 
+def mkbursttiler(pipeline, src, **properties):
+	return mkgeneric(pipeline, src, "lal_bursttiler", **properties)
+
 def mkodctodqv(pipeline, src, **properties):
 	return mkgeneric(pipeline, src, "lal_odc_to_dqv", **properties)
 
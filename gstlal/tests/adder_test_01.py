@@ -0,0 +1,191 @@
+#!/usr/bin/env python
+# Copyright (C) 2026  The gstlal authors
+#
+# This program is free software; you can redistribute it and/or modify it
+# under the terms of the GNU General Public License as published by the
+# Free Software Foundation; either version 2 of the License, or (at your
+# option) any later version.
+#
+# This program is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+# Public License for more details.
+#
+# You should have received a copy of the GNU General Public License along
+# with this program; if not, write to the Free Software Foundation, Inc.,
+# 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#
+# =============================================================================
+#
+#                                   Preamble
+#
+# =============================================================================
+#
+
+
+import numpy
+from gstlal import pipeparts
+from gstlal import pipeio
+import test_common
+import gst
+
+
+#
+# =============================================================================
+#
+#                                  Utilities
+#
+# =============================================================================
+#
+
+
+#
+# an input stream starting at sample start, cut into buffers of blocksize
+# samples, the buffers numbered in gaps being gaps and those numbered in
+# holes not being sent at all.  gap buffers are filled with NaN so the sum
+# is spoiled if the adder ever reads one.  returns the buffers as (offset,
+# array, is_gap) and what the stream contributes to the sum, 0 outside its
+# buffers and in its gaps.
+#
+
+
+def make_input(rnd, dtype, length, start, blocksize, gaps, holes):
+	contribution = numpy.zeros((length, 1), dtype = dtype)
+	buffers = []
+	for i, offset in enumerate(range(start, length, blocksize)):
+		n = min(blocksize, length - offset)
+		if i in holes:
+			continue
+		if i in gaps:
+			data = numpy.empty((n, 1), dtype = dtype)
+			data.fill(float("nan"))
+			buffers.append((offset, data, True))
+			continue
+		data = rnd.uniform(-1., 1., (n, 1))
+		if numpy.dtype(dtype).kind == "c":
+			data = data + 1j * rnd.uniform(-1., 1., (n, 1))
+		data = data.astype(dtype)
+		contribution[offset:offset + n] = data
+		buffers.append((offset, data, False))
+	return buffers, contribution
+
+
+#
+# =============================================================================
+#
+#                                  Pipelines
+#
+# =============================================================================
+#
+
+
+def adder_test_01(pipeline, name, inputs, rate, output_buffers):
+	head = pipeparts.mkadder(pipeline, None)
+
+	def need_data(elem, arg, (buffers, rate)):
+		if buffers:
+			offset, data, is_gap = buffers.pop(0)
+			buf = pipeio.audio_buffer_from_array(data, (gst.SECOND * offset + rate // 2) // rate, offset, rate)
+			if is_gap:
+				buf.flag_set(gst.BUFFER_FLAG_GAP)
+			elem.emit("push-buffer", buf)
+		else:
+			elem.emit("end-of-stream")
+	for buffers in inputs:
+		src = pipeparts.mkgeneric(pipeline, None, "appsrc", caps = pipeio.caps_from_array(buffers[0][1], rate = rate), format = gst.FORMAT_TIME)
+		src.connect("need-data", need_data, (list(buffers), rate))
+		src.link(head)
+
+	head = pipeparts.mkappsink(pipeline, head)
+	def appsink_get_buffer(elem, output_buffers):
+		buf = elem.get_last_buffer()
+		output_buffers.append((buf.offset, pipeio.array_from_audio_buffer(buf), buf.flag_is_set(gst.BUFFER_FLAG_GAP)))
+	head.connect("new-buffer", appsink_get_buffer, output_buffers)
+
+	return pipeline
+
+
+#
+# =============================================================================
+#
+#                                    Tests
+#
+# =============================================================================
+#
+
+
+#
+# does the sum of full, partial and gap buffers come out the same as
+# numpy's, for all the formats summed in one fused pass?  streams is a
+# list of (start, blocksize, gaps, holes) describing the inputs.
+#
+
+
+def adder_test_01_check(name, dtype, streams, rate = 512, length = 16384):
+	rnd = numpy.random.RandomState(1)
+	inputs = []
+	expected = numpy.zeros((length, 1), dtype = dtype)
+	bound = numpy.zeros((length, 1))
+	covered = numpy.zeros(length, dtype = "bool")
+	for start, blocksize, gaps, holes in streams:
+		buffers, contribution = make_input(rnd, dtype, length, start, blocksize, gaps, holes)
+		inputs.append(buffers)
+		expected += contribution
+		bound += abs(contribution)
+		for offset, data, is_gap in buffers:
+			if not is_gap:
+				covered[offset:offset + len(data)] = True
+	# the sum may be taken in any order
+	bound *= 4 * len(streams) * numpy.finfo(dtype).eps
+
+	output_buffers = []
+	test_common.build_and_run(adder_test_01, name, inputs = inputs, rate = rate, output_buffers = output_buffers)
+
+	# reassemble the output, reading gaps as 0
+	output = numpy.zeros((length, 1), dtype = dtype)
+	gap = numpy.zeros(length, dtype = "bool")
+	next_offset = 0
+	for offset, data, is_gap in output_buffers:
+		if offset != next_offset:
+			raise ValueError("%s: expected a buffer at offset %d, got %d" % (name, next_offset, offset))
+		if data.dtype != numpy.dtype(dtype):
+			raise ValueError("%s: expected %s output, got %s" % (name, numpy.dtype(dtype), data.dtype))
+		if not is_gap:
+			output[offset:offset + len(data)] = data
+		gap[offset:offset + len(data)] = is_gap
+		next_offset = offset + len(data)
+	if next_offset != length:
+		raise ValueError("%s: expected %d samples, got %d" % (name, length, next_offset))
+
+	if (gap & covered).any():
+		raise ValueError("%s: samples with data marked as gap at %s" % (name, numpy.flatnonzero(gap & covered)))
+	bad = ~(abs(output - expected) <= bound)
+	if bad.any():
+		bad = numpy.flatnonzero(bad)
+		raise ValueError("%s: at samples %s expected %s, got %s" % (name, bad, expected[bad, 0], output[bad, 0]))
+
+
+#
+# =============================================================================
+#
+#                                     Main
+#
+# =============================================================================
+#
+
+
+# a stream of full buffers, others cut differently so each is split into
+# pieces at the others' boundaries, with gaps, and with holes and a late
+# start so the buffers after them only cover the end of the output, two at
+# once in one place.  blocks of the fused pass hold 2048 doubles, so a 4096
+# sample buffer spans several.
+mixed = [(0, 4096, (), ()), (300, 3000, (1, 4), (2,)), (0, 4096, (1, 3), ()), (0, 777, (2, 6, 7, 10, 14, 15, 16, 20), (4, 11, 12))]
+
+# gaps in every input at once, where the output is a gap, and partial
+# buffers with nothing else but gaps, which are added into zeros
+sparse = [(0, 2048, (1, 2, 5), ()), (100, 1000, (2, 3, 4, 5, 9, 10), (13,)), (0, 1500, (3,), (1, 6))]
+
+for dtype, suffix in (("float32", "a"), ("float64", "b"), ("complex64", "c"), ("complex128", "d")):
+	adder_test_01_check("adder_test_01%s" % suffix, dtype, mixed)
+	adder_test_01_check("adder_test_01%s_sparse" % suffix, dtype, sparse)
@@ -0,0 +1,163 @@
+/*
+ * Consistency check for gst_audioadapter_peek_samples()
+ *
+ * Copyright (C) 2026  The gstlal authors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+/*
+ * Pushes a sequence of gap, non-gap and zero-length buffers into a
+ * GstAudioAdapter and, at every head position as the adapter is flushed
+ * one sample at a time, peeks at every possible number of samples.  Checks
+ * that the peeked samples and the gap/non-gap flags are the same as those
+ * gst_audioadapter_copy_samples() gives, that gap samples read as zero
+ * whatever the gap buffer holds, and that no copy is made when the samples
+ * lie within one non-gap buffer.  Exits with a non-zero status on any
+ * failure.
+ */
+
+
+/*
+ * ============================================================================
+ *
+ *                                  Preamble
+ *
+ * ============================================================================
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+
+
+#include <glib.h>
+#include <gst/gst.h>
+
+
+#include <gstlal/gstaudioadapter.h>
+
+
+/*
+ * ============================================================================
+ *
+ *                                    Main
+ *
+ * ============================================================================
+ */
+
+
+#define CHECK(expr) do { if(!(expr)) { fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #expr); return 1; } } while(0)
+
+
+#define CHANNELS 2
+#define RATE 16
+
+
+/* buffer lengths in samples, negative for gaps */
+static const gint lengths[] = {10, 7, -5, -3, 0, 12, -4, 1, 9, -6};
+
+
+int main(int argc, char *argv[])
+{
+	GstAudioAdapter *adapter;
+	GstBuffer *bufs[G_N_ELEMENTS(lengths)];
+	guint unit_size = CHANNELS * sizeof(double);
+	guint64 offset = 0;
+	guint total = 0;
+	double *expect, *copy;
+	guint i;
+
+	gst_init(&argc, &argv);
+
+	adapter = g_object_new(GST_TYPE_AUDIOADAPTER, "unit-size", unit_size, NULL);
+
+	for(i = 0; i < G_N_ELEMENTS(lengths); i++) {
+		guint n = ABS(lengths[i]);
+		GstBuffer *buf = gst_buffer_new_and_alloc(n * unit_size);
+		double *data = (double *) GST_BUFFER_DATA(buf);
+		guint j;
+
+		/* gap buffers hold garbage, it must never be seen */
+		for(j = 0; j < n * CHANNELS; j++)
+			data[j] = lengths[i] < 0 ? 1e300 : offset * CHANNELS + j + 1;
+		if(lengths[i] < 0)
+			GST_BUFFER_FLAG_SET(buf, GST_BUFFER_FLAG_GAP);
+		GST_BUFFER_OFFSET(buf) = offset;
+		GST_BUFFER_OFFSET_END(buf) = offset + n;
+		GST_BUFFER_TIMESTAMP(buf) = gst_util_uint64_scale_int_round(offset, GST_SECOND, RATE);
+		GST_BUFFER_DURATION(buf) = gst_util_uint64_scale_int_round(offset + n, GST_SECOND, RATE) - GST_BUFFER_TIMESTAMP(buf);
+		offset += n;
+		total += n;
+
+		/* keep a reference to compare the zero-copy pointers with */
+		bufs[i] = gst_buffer_ref(buf);
+		gst_audioadapter_push(adapter, buf);
+	}
+	CHECK(adapter->size == total);
+
+	/* what the samples should read as:  0 in gaps */
+	expect = g_new(double, total * CHANNELS);
+	copy = g_new(double, total * CHANNELS);
+	for(i = 0, offset = 0; i < G_N_ELEMENTS(lengths); offset += ABS(lengths[i]), i++) {
+		guint j;
+		for(j = offset * CHANNELS; j < (offset + ABS(lengths[i])) * CHANNELS; j++)
+			expect[j] = lengths[i] < 0 ? 0.0 : j + 1;
+	}
+
+	for(offset = 0; offset < total; offset++) {
+		guint n;
+
+		/* the buffer holding the head sample, and its first sample */
+		guint64 start = 0;
+		for(i = 0; start + ABS(lengths[i]) <= offset; i++)
+			start += ABS(lengths[i]);
+
+		for(n = 1; n <= total - offset; n++) {
+			gboolean peek_gap, peek_nongap, copy_gap, copy_nongap;
+			const double *peek = gst_audioadapter_peek_samples(adapter, n, &peek_gap, &peek_nongap);
+			gboolean in_one_nongap = lengths[i] > 0 && offset + n <= start + lengths[i];
+			guint j;
+
+			gst_audioadapter_copy_samples(adapter, copy, n, &copy_gap, &copy_nongap);
+			CHECK(peek != NULL);
+			CHECK(memcmp(peek, copy, n * unit_size) == 0);
+			CHECK(peek_gap == copy_gap);
+			CHECK(peek_nongap == copy_nongap);
+
+			for(j = 0; j < n * CHANNELS; j++)
+				CHECK(peek[j] == expect[offset * CHANNELS + j]);
+
+			if(in_one_nongap)
+				CHECK(peek == (const double *) GST_BUFFER_DATA(bufs[i]) + (offset - start) * CHANNELS);
+			else
+				CHECK(peek != (const double *) GST_BUFFER_DATA(bufs[i]) + (offset - start) * CHANNELS);
+		}
+
+		gst_audioadapter_flush_samples(adapter, 1);
+		CHECK(adapter->size == total - offset - 1);
+	}
+
+	CHECK(gst_audioadapter_peek_samples(adapter, 0, NULL, NULL) == NULL);
+
+	g_free(expect);
+	g_free(copy);
+	for(i = 0; i < G_N_ELEMENTS(lengths); i++)
+		gst_buffer_unref(bufs[i]);
+	g_object_unref(adapter);
+
+	return 0;
+}
@@ -0,0 +1,102 @@
+#!/usr/bin/env python
+# Copyright (C) 2026  The gstlal authors
+#
+# This program is free software; you can redistribute it and/or modify it
+# under the terms of the GNU General Public License as published by the
+# Free Software Foundation; either version 2 of the License, or (at your
+# option) any later version.
+#
+# This program is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+# Public License for more details.
+#
+# You should have received a copy of the GNU General Public License along
+# with this program; if not, write to the Free Software Foundation, Inc.,
+# 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#
+# =============================================================================
+#
+#                                   Preamble
+#
+# =============================================================================
+#
+
+
+import numpy
+from gstlal import misc
+
+
+#
+# =============================================================================
+#
+#                                    Tests
+#
+# =============================================================================
+#
+
+
+#
+# does cdf_weighted_chisq_P_array() give exactly what
+# cdf_weighted_chisq_P() gives at every point, NaN included, whatever the
+# number of threads and the shape of c?
+#
+
+
+def cdf_weighted_chisq_P_test_01(name, A, noncent, dof, var, lim = 10000, accuracy = 1e-8):
+	A = numpy.array(A, dtype = "double")
+	noncent = numpy.array(noncent, dtype = "double")
+	dof = numpy.array(dof, dtype = "int")
+
+	# more points than one job holds, and the origin
+	c = numpy.linspace(-20., 40., 400)
+	c[200] = 0.
+
+	expected = numpy.array([misc.cdf_weighted_chisq_P(A, noncent, dof, var, x, lim, accuracy) for x in c])
+
+	for nthreads in (1, 3, 0):
+		for shape in (c.shape, (20, 20)):
+			P = misc.cdf_weighted_chisq_P_array(A, noncent, dof, var, c.reshape(shape), lim, accuracy, nthreads)
+			if P.shape != shape:
+				raise ValueError("%s: nthreads = %d: expected shape %s, got %s" % (name, nthreads, shape, P.shape))
+			P = P.reshape(c.shape)
+			same = (P == expected) | (numpy.isnan(P) & numpy.isnan(expected))
+			if not same.all():
+				raise ValueError("%s: nthreads = %d, shape %s: at c = %s expected %s, got %s" % (name, nthreads, shape, c[~same], expected[~same], P[~same]))
+
+	# the scalar case
+	P = misc.cdf_weighted_chisq_P_array(A, noncent, dof, var, c[123], lim, accuracy)
+	if not (P == expected[123] or (numpy.isnan(P) and numpy.isnan(expected[123]))):
+		raise ValueError("%s: at c = %g expected %s, got %s" % (name, c[123], expected[123], P))
+
+	return expected
+
+
+#
+# =============================================================================
+#
+#                                     Main
+#
+# =============================================================================
+#
+
+
+# mixed signs, non-central, with a normal term
+P = cdf_weighted_chisq_P_test_01("cdf_weighted_chisq_P_test_01a", [1.0, -0.5, 2.0, 0.25], [0.0, 1.5, 0.3, 4.0], [1, 2, 3, 1], 0.5)
+if numpy.isnan(P).any():
+	raise ValueError("cdf_weighted_chisq_P_test_01a: unexpected failure")
+
+# central chi-squared
+cdf_weighted_chisq_P_test_01("cdf_weighted_chisq_P_test_01b", [1.0], [0.0], [4], 0.0)
+
+# the normal term alone
+cdf_weighted_chisq_P_test_01("cdf_weighted_chisq_P_test_01c", [0.0], [0.0], [1], 1.0)
+
+# invalid parameters, NaN everywhere
+P = cdf_weighted_chisq_P_test_01("cdf_weighted_chisq_P_test_01d", [1.0, 2.0], [-1.0, 0.0], [1, 1], 0.0)
+if not numpy.isnan(P).all():
+	raise ValueError("cdf_weighted_chisq_P_test_01d: expected NaN")
+
+# too few terms allowed, the integration fails
+cdf_weighted_chisq_P_test_01("cdf_weighted_chisq_P_test_01e", [1.0, -0.5, 2.0], [0.0, 1.5, 0.3], [1, 2, 3], 0.5, lim = 1)
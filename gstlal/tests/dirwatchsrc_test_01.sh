@@ -0,0 +1,83 @@
+#!/bin/sh
+
+dir="dirwatchsrc_test_01.d"
+log="dirwatchsrc_test_01.log"
+expected="dirwatchsrc_test_01.expected"
+output="dirwatchsrc_test_01.output"
+
+cleanup() {
+	rm -rf $dir $log $expected $output
+}
+
+# start gst-launch in the background and wait for it to report that the
+# live source is running, by which time the directory is being watched.
+# $pid is set to the process ID.
+start_pipeline() {
+	gst-launch "$@" >$log 2>&1 &
+	pid=$!
+	n=0
+	until grep -q "Pipeline is live" $log ; do
+		if ! kill -0 $pid 2>/dev/null || [ $n -ge 600 ] ; then
+			cat $log
+			kill $pid 2>/dev/null
+			return 1
+		fi
+		n=$((n + 1))
+		sleep 0.1
+	done
+}
+
+# wait for the pipeline to exit on its own.  it stops after num-buffers
+# buffers, so a missing buffer shows up as a timeout.
+wait_pipeline() {
+	( sleep 60 && kill $pid 2>/dev/null ) &
+	watchdog=$!
+	wait $pid
+	result=$?
+	kill $watchdog 2>/dev/null
+	[ $result -eq 0 ] || cat $log
+	return $result
+}
+
+#
+# files written the way a low-latency writer does:  into a hidden file,
+# renamed when complete.  the second file is copied directly to exercise
+# IN_CLOSE_WRITE.  a file present before the element starts must be
+# ignored.
+#
+
+cleanup
+mkdir $dir
+cp Makefile $dir/H-DIRWATCHSRC_TEST_01-874018399-128.gwf
+
+start_pipeline lal_dirwatchsrc location=$dir wait-time=-1 num-buffers=3 ! filesink location=$output || { cleanup ; exit 1 ; }
+cp Makefile $dir/.tmp && mv $dir/.tmp $dir/H-DIRWATCHSRC_TEST_01-874018527-128.gwf
+cp Makefile $dir/H-DIRWATCHSRC_TEST_01-874018655-128.gwf
+cp Makefile $dir/.tmp && mv $dir/.tmp $dir/H-DIRWATCHSRC_TEST_01-874018783-128.gwf
+wait_pipeline || { cleanup ; exit 1 ; }
+
+cat Makefile Makefile Makefile >$expected
+cmp $expected $output || { cleanup ; exit 1 ; }
+
+#
+# heart-beat:  the file covering [t0 + 1, t0 + 2) is never written.  with
+# wait-time=1 it is declared missing at t0 + 3, a 0-length heart-beat
+# buffer is pushed in its place, and the following file is pushed after
+# it.  the third buffer can only be reached through the heart-beat.
+#
+
+cleanup
+mkdir $dir
+
+start_pipeline lal_dirwatchsrc location=$dir wait-time=1 num-buffers=3 ! filesink location=$output || { cleanup ; exit 1 ; }
+t0=$(lalapps_tconvert now)
+cp Makefile $dir/H-DIRWATCHSRC_TEST_01-$t0-1.gwf
+cp ${srcdir:-.}/Makefile.am $dir/H-DIRWATCHSRC_TEST_01-$((t0 + 2))-1.gwf
+wait_pipeline || { cleanup ; exit 1 ; }
+
+cat Makefile ${srcdir:-.}/Makefile.am >$expected
+cmp $expected $output
+result=$?
+
+cleanup
+exit $result
@@ -0,0 +1,184 @@
+/*
+ * Consistency check for the element statistics page
+ *
+ * Copyright (C) 2026  The gstlal authors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+/*
+ * Feeds a struct gstlal_element_stats the buffers of an element that
+ * accumulates two input buffers per output, publishes the statistics in a
+ * file, and checks that the file agrees with the element's copy, that the
+ * latency is measured from the input that completed each output, that the
+ * time spent downstream of gstlal_element_stats_push() is left out, and
+ * that the file is removed with the statistics.  The layout is checked against
+ * the one gstlal_element_stats reads.  Exits with a non-zero status on any
+ * failure.
+ */
+
+
+/*
+ * ============================================================================
+ *
+ *                                  Preamble
+ *
+ * ============================================================================
+ */
+
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+
+#include <glib.h>
+#include <gst/gst.h>
+
+
+#include <gstlal/gstlal_element_stats.h>
+
+
+/*
+ * ============================================================================
+ *
+ *                                    Main
+ *
+ * ============================================================================
+ */
+
+
+#define CHECK(expr) do { if(!(expr)) { fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #expr); return 1; } } while(0)
+
+
+/* a slow downstream element */
+static GstFlowReturn slow_chain(GstPad *pad, GstBuffer *buf)
+{
+	g_usleep(100000);
+	gst_buffer_unref(buf);
+	return GST_FLOW_OK;
+}
+
+
+int main(int argc, char *argv[])
+{
+	GstElement *element;
+	GstPad *srcpad, *sinkpad;
+	struct gstlal_element_stats *stats;
+	struct gstlal_element_stats_page page, *mapped;
+	gchar *filename;
+	GValue value = {0,};
+	int fd, i;
+
+	gst_init(&argc, &argv);
+	element = gst_bin_new("stats_test");
+	stats = gstlal_element_stats_new(element);
+	filename = g_strdup_printf("%s/gstlal_element_stats_test.%d", g_get_tmp_dir(), (int) getpid());
+
+	/* "@IIiI64sQQQQQQQQQQqQ" in gstlal_element_stats */
+	CHECK(sizeof(struct gstlal_element_stats_page) == 176);
+	CHECK(G_STRUCT_OFFSET(struct gstlal_element_stats_page, sequence) == 8);
+
+	CHECK(gstlal_element_stats_set_file(stats, filename));
+
+	/* 1 s input buffers, one 2 s output per two inputs */
+	for(i = 0; i < 8; i++) {
+		GstBuffer *buf = gst_buffer_new();
+		GST_BUFFER_TIMESTAMP(buf) = 1000000000 * GST_SECOND + i * GST_SECOND;
+		GST_BUFFER_DURATION(buf) = GST_SECOND;
+		gstlal_element_stats_input(stats, buf);
+		gstlal_element_stats_queue_level(stats, i % 2 ? 0 : 4096);
+		if(i % 2) {
+			g_usleep(2000);
+			gstlal_element_stats_output(stats, GST_BUFFER_TIMESTAMP(buf) + GST_BUFFER_DURATION(buf));
+		}
+		gstlal_element_stats_processed(stats);
+		gst_buffer_unref(buf);
+	}
+
+	gstlal_element_stats_get_page(stats, &page);
+	CHECK(page.magic == GSTLAL_ELEMENT_STATS_MAGIC);
+	CHECK(page.buffers_in == 8);
+	CHECK(page.buffers_out == 4);
+	CHECK(!strcmp(page.element, "stats_test"));
+	/* measured from the second input of each pair, which arrived just
+	 * before the sleep, not from the first */
+	CHECK(page.latency_last >= 2000 * GST_USECOND);
+	CHECK(page.latency_max < 1 * GST_SECOND);
+	CHECK(page.processing_max >= page.latency_max);
+	CHECK(page.queue_level == 0);
+	CHECK(page.queue_level_max == 4096);
+	/* the stream is in 2001, well before now */
+	CHECK(page.stream_lag > 0);
+
+	fd = open(filename, O_RDONLY);
+	CHECK(fd >= 0);
+	mapped = mmap(NULL, sizeof(*mapped), PROT_READ, MAP_SHARED, fd, 0);
+	CHECK(mapped != MAP_FAILED);
+	close(fd);
+	CHECK(mapped->sequence % 2 == 0);
+	CHECK(mapped->buffers_in == page.buffers_in);
+	CHECK(mapped->latency_max == page.latency_max);
+	CHECK(mapped->update_time == page.update_time);
+	munmap(mapped, sizeof(*mapped));
+
+	g_value_init(&value, G_TYPE_STRING);
+	CHECK(gstlal_element_stats_get_property(stats, GSTLAL_ELEMENT_STATS_PROP_FILE, &value));
+	CHECK(!strcmp(g_value_get_string(&value), filename));
+	g_value_unset(&value);
+	g_value_init(&value, G_TYPE_UINT64);
+	CHECK(gstlal_element_stats_get_property(stats, GSTLAL_ELEMENT_STATS_PROP_BUFFERS, &value));
+	CHECK(g_value_get_uint64(&value) == 8);
+	g_value_unset(&value);
+	CHECK(!gstlal_element_stats_get_property(stats, GSTLAL_ELEMENT_STATS_N_PROPERTIES, &value));
+
+	/* a push that takes 100 ms downstream counts in neither the latency
+	 * nor the processing time */
+	srcpad = gst_pad_new("src", GST_PAD_SRC);
+	sinkpad = gst_pad_new("sink", GST_PAD_SINK);
+	gst_pad_set_chain_function(sinkpad, slow_chain);
+	CHECK(gst_pad_link(srcpad, sinkpad) == GST_PAD_LINK_OK);
+	gst_pad_set_active(sinkpad, TRUE);
+	gst_pad_set_active(srcpad, TRUE);
+	for(i = 8; i < 10; i++) {
+		GstBuffer *buf = gst_buffer_new();
+		GST_BUFFER_TIMESTAMP(buf) = 1000000000 * GST_SECOND + i * GST_SECOND;
+		GST_BUFFER_DURATION(buf) = GST_SECOND;
+		gstlal_element_stats_input(stats, buf);
+		CHECK(gstlal_element_stats_push(stats, srcpad, buf) == GST_FLOW_OK);
+		gstlal_element_stats_processed(stats);
+	}
+	gstlal_element_stats_get_page(stats, &page);
+	CHECK(page.buffers_in == 10);
+	CHECK(page.buffers_out == 6);
+	CHECK(page.latency_last < 50 * GST_MSECOND);
+	CHECK(page.processing_last < 50 * GST_MSECOND);
+	gst_pad_set_active(srcpad, FALSE);
+	gst_pad_set_active(sinkpad, FALSE);
+	gst_object_unref(srcpad);
+	gst_object_unref(sinkpad);
+
+	gstlal_element_stats_free(stats);
+	CHECK(!g_file_test(filename, G_FILE_TEST_EXISTS));
+
+	g_free(filename);
+	gst_object_unref(element);
+	fprintf(stderr, "element statistics OK\n");
+	return 0;
+}
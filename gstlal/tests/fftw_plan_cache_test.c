@@ -0,0 +1,162 @@
+/*
+ * Consistency check for the FFTW plan cache
+ *
+ * Copyright (C) 2026  The gstlal authors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+/*
+ * Asks the plan cache for the same transforms more than once and checks
+ * that they are planned once, that the hit and miss counts agree, that
+ * arrays with different alignment or in-placeness get their own plans,
+ * and that a cached plan executed on new arrays with the new-array API
+ * agrees with a direct evaluation of the DFT.  Exits with a non-zero
+ * status on any failure.
+ */
+
+
+/*
+ * ============================================================================
+ *
+ *                                  Preamble
+ *
+ * ============================================================================
+ */
+
+
+#include <complex.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+#include <glib.h>
+#include <gst/gst.h>
+#include <fftw3.h>
+
+
+#include <gstlal/gstlal_fftw.h>
+
+
+/*
+ * ============================================================================
+ *
+ *                                    Main
+ *
+ * ============================================================================
+ */
+
+
+#define CHECK(expr) do { if(!(expr)) { fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #expr); return 1; } } while(0)
+#define N 96
+
+
+int main(int argc, char *argv[])
+{
+	int sizes[] = {N};
+	complex double *a, *b, *out;
+	double *real;
+	fftw_plan plan, again, unaligned, out_of_place, inverse;
+	guint64 hits, misses;
+	guint plans;
+	int i, k;
+
+	gst_init(&argc, &argv);
+
+	/*
+	 * warm-up plans the four in-place transforms
+	 */
+
+	gstlal_fftw_plan_cache_warm_up(sizes, 1, FFTW_ESTIMATE);
+	gstlal_fftw_plan_cache_get_stats(&hits, &misses, &plans);
+	CHECK(hits == 0 && misses == 4 && plans == 4);
+
+	/*
+	 * in-place on aligned arrays finds the warm-up plans, twice
+	 */
+
+	a = fftw_malloc((N / 2 + 1) * sizeof(*a));
+	b = fftw_malloc((N / 2 + 1) * sizeof(*b));
+	plan = gstlal_fftw_plan_dft_r2c_1d(N, (double *) a, a, FFTW_ESTIMATE);
+	again = gstlal_fftw_plan_dft_r2c_1d(N, (double *) b, b, FFTW_ESTIMATE);
+	inverse = gstlal_fftw_plan_dft_c2r_1d(N, b, (double *) b, FFTW_ESTIMATE);
+	CHECK(plan && plan == again && inverse && inverse != plan);
+	gstlal_fftw_plan_cache_get_stats(&hits, &misses, &plans);
+	CHECK(hits == 3 && misses == 4 && plans == 4);
+
+	/*
+	 * other flags, alignment and out-of-place need their own plans
+	 */
+
+	real = fftw_malloc((N + 1) * sizeof(*real));
+	out = fftw_malloc((N / 2 + 1) * sizeof(*out));
+	CHECK(gstlal_fftw_plan_dft_r2c_1d(N, (double *) a, a, FFTW_MEASURE) != plan);
+	unaligned = gstlal_fftw_plan_dft_r2c_1d(N, real + 1, out, FFTW_ESTIMATE);
+	out_of_place = gstlal_fftw_plan_dft_r2c_1d(N, real, out, FFTW_ESTIMATE);
+	CHECK(unaligned && out_of_place && unaligned != out_of_place && unaligned != plan && out_of_place != plan);
+	gstlal_fftw_plan_cache_get_stats(&hits, &misses, &plans);
+	CHECK(hits == 3 && misses == 7 && plans == 7);
+
+	/*
+	 * the shared plan transforms whatever arrays it is given
+	 */
+
+	for(i = 0; i < N; i++)
+		real[i] = ((double *) b)[i] = sin(0.3 * i) + (i % 5) - 2.0;
+	fftw_execute_dft_r2c(plan, (double *) b, b);
+	fftw_execute_dft_r2c(unaligned, real, out);
+	for(k = 0; k < N / 2 + 1; k++) {
+		complex double dft = 0.0;
+		for(i = 0; i < N; i++)
+			dft += real[i] * cexp(-2.0 * M_PI * I * i * k / N);
+		CHECK(cabs(b[k] - dft) < 1e-9 * N && cabs(out[k] - dft) < 1e-9 * N);
+	}
+
+	/*
+	 * and the inverse brings it back
+	 */
+
+	fftw_execute_dft_c2r(inverse, b, (double *) b);
+	for(i = 0; i < N; i++)
+		CHECK(fabs(((double *) b)[i] / N - real[i]) < 1e-9);
+
+	/*
+	 * clearing only destroys the plans nobody holds
+	 */
+
+	gstlal_fftw_plan_release(plan);
+	gstlal_fftw_plan_release(inverse);
+	gstlal_fftw_plan_cache_clear();
+	gstlal_fftw_plan_cache_get_stats(NULL, NULL, &plans);
+	CHECK(plans == 4);
+	CHECK(gstlal_fftw_plan_dft_r2c_1d(N, (double *) a, a, FFTW_ESTIMATE) == again);
+	gstlal_fftw_plan_release(again);
+	gstlal_fftw_plan_release(again);
+	gstlal_fftw_plan_release(unaligned);
+	gstlal_fftw_plan_release(out_of_place);
+	gstlal_fftw_plan_cache_clear();
+	gstlal_fftw_plan_cache_get_stats(NULL, NULL, &plans);
+	CHECK(plans == 1);
+
+	fftw_free(a);
+	fftw_free(b);
+	fftw_free(real);
+	fftw_free(out);
+
+	return 0;
+}
@@ -0,0 +1,198 @@
+/*
+ * Micro-benchmark and consistency check for the gstlal segment index
+ *
+ * Copyright (C) 2026  The gstlal authors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+/*
+ * Builds a segment list resembling a long offline run (tens of thousands
+ * of segments), then times per-buffer lookups three ways:  the original
+ * linear scan, bisection without a cursor, and bisection with a cursor
+ * for monotonically advancing buffers.  The results of every lookup are
+ * cross-checked against the linear scan and the program exits with a
+ * non-zero status on any mismatch.  Run by "make bench";  the exact
+ * results are checked by segments_test in "make check".
+ *
+ * Usage:  segments_bench [n_segments [n_queries]]
+ */
+
+
+/*
+ * ============================================================================
+ *
+ *                                  Preamble
+ *
+ * ============================================================================
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <glib.h>
+
+
+#include <gstlal/gstlal_segments.h>
+
+
+#define SECOND 1000000000ULL
+
+
+/*
+ * ============================================================================
+ *
+ *                               Internal Code
+ *
+ * ============================================================================
+ */
+
+
+/* reference implementation:  what gstlal_segment_list_index() used to do */
+static gint linear_index(const struct gstlal_segment_list *segmentlist, guint64 t)
+{
+	gint i;
+
+	for(i = 0; i < gstlal_segment_list_length(segmentlist); i++)
+		if(t < gstlal_segment_list_get((struct gstlal_segment_list *) segmentlist, i)->stop)
+			break;
+
+	return i;
+}
+
+
+static struct gstlal_segment_list *make_segments(gint n, guint64 *end)
+{
+	struct gstlal_segment_list *segmentlist = gstlal_segment_list_new();
+	guint64 t = 1000000000ULL * SECOND;
+	gint i;
+
+	srand(1);
+	for(i = 0; i < n; i++) {
+		/* gaps of 1--64 s, segments of 1--512 s */
+		guint64 start = t + (1 + rand() % 64) * SECOND;
+		guint64 stop = start + (1 + rand() % 512) * SECOND;
+		gstlal_segment_list_append(segmentlist, gstlal_segment_new(start, stop));
+		t = stop;
+	}
+	*end = t;
+
+	return segmentlist;
+}
+
+
+static double elapsed(gint64 t0)
+{
+	return (g_get_monotonic_time() - t0) / 1e6;
+}
+
+
+/*
+ * ============================================================================
+ *
+ *                                    Main
+ *
+ * ============================================================================
+ */
+
+
+int main(int argc, char *argv[])
+{
+	gint n_segments = argc > 1 ? atoi(argv[1]) : 50000;
+	gint n_queries = argc > 2 ? atoi(argv[2]) : 200000;
+	struct gstlal_segment_list *segmentlist;
+	struct gstlal_segment_index *index;
+	guint64 t_start, t_end, step;
+	guint64 checksum_linear = 0, checksum_bisect = 0, checksum_cursor = 0;
+	gint cursor = 0;
+	gint failures = 0;
+	gint64 t0;
+	gint i;
+
+	segmentlist = make_segments(n_segments, &t_end);
+	index = gstlal_segment_index_new(segmentlist);
+	t_start = gstlal_segment_list_get(segmentlist, 0)->start - SECOND;
+	step = (t_end - t_start) / n_queries;
+
+	if(gstlal_segment_index_length(index) != gstlal_segment_list_length(segmentlist)) {
+		fprintf(stderr, "index has %d segments, expected %d\n", gstlal_segment_index_length(index), gstlal_segment_list_length(segmentlist));
+		failures++;
+	}
+
+	/*
+	 * monotonic queries, as made by a source producing consecutive
+	 * buffers
+	 */
+
+	t0 = g_get_monotonic_time();
+	for(i = 0; i < n_queries; i++)
+		checksum_linear += linear_index(segmentlist, t_start + i * step);
+	printf("linear scan:       %d segments, %d queries, %.6f s\n", n_segments, n_queries, elapsed(t0));
+
+	t0 = g_get_monotonic_time();
+	for(i = 0; i < n_queries; i++)
+		checksum_bisect += gstlal_segment_list_index(segmentlist, t_start + i * step);
+	printf("bisection:         %d segments, %d queries, %.6f s\n", n_segments, n_queries, elapsed(t0));
+
+	t0 = g_get_monotonic_time();
+	for(i = 0; i < n_queries; i++)
+		checksum_cursor += gstlal_segment_index_search(index, t_start + i * step, &cursor);
+	printf("index with cursor: %d segments, %d queries, %.6f s\n", n_segments, n_queries, elapsed(t0));
+
+	if(checksum_bisect != checksum_linear || checksum_cursor != checksum_linear) {
+		fprintf(stderr, "search results disagree with linear scan\n");
+		failures++;
+	}
+
+	/*
+	 * random queries, cursor must still give correct answers
+	 */
+
+	cursor = 0;
+	for(i = 0; i < 10000; i++) {
+		guint64 t = t_start + (guint64) rand() % (t_end - t_start + SECOND);
+		gint expected = linear_index(segmentlist, t);
+		if(gstlal_segment_index_search(index, t, &cursor) != expected || gstlal_segment_list_index(segmentlist, t) != expected) {
+			fprintf(stderr, "random query at %" G_GUINT64_FORMAT " disagrees with linear scan\n", t);
+			failures++;
+			break;
+		}
+	}
+
+	/*
+	 * range queries:  1 s buffers marching across the list
+	 */
+
+	cursor = 0;
+	t0 = g_get_monotonic_time();
+	for(i = 0; i < n_queries; i++) {
+		const struct gstlal_segment *first;
+		guint64 start = t_start + i * step;
+		gint n = gstlal_segment_index_get_range(index, start, start + SECOND, &cursor, &first);
+		struct gstlal_segment_list *sublist = gstlal_segment_list_get_range(segmentlist, start, start + SECOND);
+		if(n != gstlal_segment_list_length(sublist)) {
+			fprintf(stderr, "range query at %" G_GUINT64_FORMAT " found %d segments, expected %d\n", start, n, gstlal_segment_list_length(sublist));
+			failures++;
+		}
+		gstlal_segment_list_free(sublist);
+	}
+	printf("range queries:     %d segments, %d queries, %.6f s\n", n_segments, n_queries, elapsed(t0));
+
+	gstlal_segment_index_free(index);
+	gstlal_segment_list_free(segmentlist);
+
+	return failures ? 1 : 0;
+}
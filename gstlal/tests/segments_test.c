@@ -0,0 +1,288 @@
+/*
+ * Correctness check for the gstlal segment list and segment index
+ *
+ * Copyright (C) 2026  The gstlal authors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+/*
+ * Checks the exact positions returned by gstlal_segment_list_index() and
+ * gstlal_segment_index_search() at and around every segment boundary, and
+ * the exact segments returned by gstlal_segment_list_get_range() and
+ * gstlal_segment_index_get_range(), on small hand-made lists:  an ordered
+ * list with abutting segments, and an unordered one with overlapping,
+ * abutting, duplicate and empty segments.  The unordered list must give
+ * the same answers as a linear scan, and its index must be the sorted
+ * union of its segments.  Exits with a non-zero status on any failure.
+ */
+
+
+/*
+ * ============================================================================
+ *
+ *                                  Preamble
+ *
+ * ============================================================================
+ */
+
+
+#include <stdio.h>
+#include <glib.h>
+
+
+#include <gstlal/gstlal_segments.h>
+
+
+/*
+ * ============================================================================
+ *
+ *                               Internal Code
+ *
+ * ============================================================================
+ */
+
+
+#define CHECK(expr) do { if(!(expr)) { fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #expr); return 1; } } while(0)
+
+
+static struct gstlal_segment_list *make_list(const guint64 (*segs)[2], gint n)
+{
+	struct gstlal_segment_list *segmentlist = gstlal_segment_list_new();
+	gint i;
+
+	for(i = 0; i < n; i++)
+		gstlal_segment_list_append(segmentlist, gstlal_segment_new(segs[i][0], segs[i][1]));
+
+	return segmentlist;
+}
+
+
+/* reference implementation:  the first segment with t < stop */
+static gint linear_index(struct gstlal_segment_list *segmentlist, guint64 t)
+{
+	gint i;
+
+	for(i = 0; i < gstlal_segment_list_length(segmentlist); i++)
+		if(t < gstlal_segment_list_get(segmentlist, i)->stop)
+			break;
+
+	return i;
+}
+
+
+/*
+ * the list's search and range results agree with a linear scan and with
+ * explicit clipping for every query in [t0, t1) and every range of up to
+ * 4 in that interval
+ */
+
+
+static int check_list(struct gstlal_segment_list *segmentlist, guint64 t0, guint64 t1)
+{
+	guint64 t, start, stop;
+
+	for(t = t0; t < t1; t++)
+		CHECK(gstlal_segment_list_index(segmentlist, t) == linear_index(segmentlist, t));
+
+	for(start = t0; start < t1; start++)
+		for(stop = start; stop <= start + 4; stop++) {
+			struct gstlal_segment_list *sublist = gstlal_segment_list_get_range(segmentlist, start, stop);
+			gint lo = linear_index(segmentlist, start);
+			gint hi = linear_index(segmentlist, stop);
+			gint i, n = 0;
+
+			CHECK(sublist != NULL);
+			for(i = lo; i <= hi && i < gstlal_segment_list_length(segmentlist); i++) {
+				struct gstlal_segment *seg = gstlal_segment_list_get(segmentlist, i);
+				struct gstlal_segment *got;
+				if(seg->start >= stop)
+					continue;
+				CHECK(n < gstlal_segment_list_length(sublist));
+				got = gstlal_segment_list_get(sublist, n);
+				CHECK(got->start == (n == 0 ? MAX(seg->start, start) : seg->start));
+				CHECK(got->stop == (n == gstlal_segment_list_length(sublist) - 1 ? MIN(seg->stop, stop) : seg->stop));
+				n++;
+			}
+			CHECK(n == gstlal_segment_list_length(sublist));
+			if(n)
+				CHECK(gstlal_segment_list_get(sublist, n - 1)->stop <= stop);
+			gstlal_segment_list_free(sublist);
+		}
+
+	return 0;
+}
+
+
+/*
+ * the index holds exactly the expected segments, and its search and range
+ * results are exact for every query in [t0, t1), with and without a
+ * cursor, in order and out of order
+ */
+
+
+static int check_index(struct gstlal_segment_index *index, const guint64 (*expect)[2], gint n, guint64 t0, guint64 t1)
+{
+	guint64 t, start, stop;
+	gint cursor;
+	gint i;
+
+	CHECK(gstlal_segment_index_length(index) == n);
+	for(i = 0; i < n; i++) {
+		CHECK(gstlal_segment_index_get(index, i)->start == expect[i][0]);
+		CHECK(gstlal_segment_index_get(index, i)->stop == expect[i][1]);
+	}
+
+	cursor = 0;
+	for(t = t0; t < t1; t++) {
+		gint want;
+		for(want = 0; want < n && t >= expect[want][1]; want++);
+		CHECK(gstlal_segment_index_search(index, t, NULL) == want);
+		CHECK(gstlal_segment_index_search(index, t, &cursor) == want);
+		CHECK(cursor == want);
+	}
+
+	/* backwards, so the cursor is always behind the answer */
+	cursor = n;
+	for(t = t1; t-- > t0;) {
+		gint want;
+		for(want = 0; want < n && t >= expect[want][1]; want++);
+		CHECK(gstlal_segment_index_search(index, t, &cursor) == want);
+	}
+
+	cursor = 0;
+	for(start = t0; start < t1; start++)
+		for(stop = start; stop <= start + 4; stop++) {
+			const struct gstlal_segment *first;
+			gint lo, hi;
+			for(lo = 0; lo < n && expect[lo][1] <= start; lo++);
+			for(hi = lo; hi < n && expect[hi][0] < stop; hi++);
+			CHECK(gstlal_segment_index_get_range(index, start, stop, &cursor, &first) == hi - lo);
+			if(hi > lo)
+				CHECK(first == gstlal_segment_index_get(index, lo));
+			else
+				CHECK(first == NULL);
+		}
+
+	return 0;
+}
+
+
+/*
+ * ============================================================================
+ *
+ *                                    Main
+ *
+ * ============================================================================
+ */
+
+
+int main(int argc, char *argv[])
+{
+	/* in order, [20, 30) and [30, 35) abut */
+	static const guint64 ordered[][2] = {{10, 15}, {20, 30}, {30, 35}, {40, 41}};
+	static const guint64 ordered_union[][2] = {{10, 15}, {20, 35}, {40, 41}};
+	/* out of order, overlapping, abutting, duplicated and empty */
+	static const guint64 unordered[][2] = {{40, 45}, {10, 20}, {30, 30}, {15, 25}, {50, 52}, {25, 28}, {40, 45}, {5, 6}, {60, 55}, {44, 50}};
+	static const guint64 unordered_union[][2] = {{5, 6}, {10, 28}, {40, 52}};
+	struct gstlal_segment_list *segmentlist;
+	struct gstlal_segment_list *sublist;
+	struct gstlal_segment_index *index;
+	const struct gstlal_segment *first;
+	gint cursor;
+
+	/*
+	 * ordered list:  exact positions at the boundaries
+	 */
+
+	segmentlist = make_list(ordered, G_N_ELEMENTS(ordered));
+	CHECK(gstlal_segment_list_index(segmentlist, 0) == 0);
+	CHECK(gstlal_segment_list_index(segmentlist, 10) == 0);
+	CHECK(gstlal_segment_list_index(segmentlist, 14) == 0);
+	CHECK(gstlal_segment_list_index(segmentlist, 15) == 1);
+	CHECK(gstlal_segment_list_index(segmentlist, 29) == 1);
+	CHECK(gstlal_segment_list_index(segmentlist, 30) == 2);
+	CHECK(gstlal_segment_list_index(segmentlist, 35) == 3);
+	CHECK(gstlal_segment_list_index(segmentlist, 40) == 3);
+	CHECK(gstlal_segment_list_index(segmentlist, 41) == 4);
+	CHECK(gstlal_segment_list_index(segmentlist, G_MAXUINT64) == 4);
+
+	/* a range across the abutting pair keeps both, clipped at the ends */
+	sublist = gstlal_segment_list_get_range(segmentlist, 25, 33);
+	CHECK(gstlal_segment_list_length(sublist) == 2);
+	CHECK(gstlal_segment_list_get(sublist, 0)->start == 25);
+	CHECK(gstlal_segment_list_get(sublist, 0)->stop == 30);
+	CHECK(gstlal_segment_list_get(sublist, 1)->start == 30);
+	CHECK(gstlal_segment_list_get(sublist, 1)->stop == 33);
+	gstlal_segment_list_free(sublist);
+
+	/* a range in a gap is empty, one ending at a start excludes it */
+	sublist = gstlal_segment_list_get_range(segmentlist, 15, 20);
+	CHECK(gstlal_segment_list_length(sublist) == 0);
+	gstlal_segment_list_free(sublist);
+
+	CHECK(check_list(segmentlist, 0, 45) == 0);
+
+	/* the index merges the abutting pair */
+	index = gstlal_segment_index_new(segmentlist);
+	CHECK(check_index(index, ordered_union, G_N_ELEMENTS(ordered_union), 0, 45) == 0);
+
+	cursor = 0;
+	CHECK(gstlal_segment_index_get_range(index, 12, 38, &cursor, &first) == 2);
+	CHECK(first->start == 10 && first->stop == 15);
+	CHECK(first[1].start == 20 && first[1].stop == 35);
+	CHECK(cursor == 0);
+
+	gstlal_segment_index_free(index);
+	gstlal_segment_list_free(segmentlist);
+
+	/*
+	 * unordered list:  the list is searched as before, the index is
+	 * the sorted union
+	 */
+
+	segmentlist = make_list(unordered, G_N_ELEMENTS(unordered));
+	CHECK(gstlal_segment_list_index(segmentlist, 0) == 0);
+	CHECK(gstlal_segment_list_index(segmentlist, 44) == 0);
+	CHECK(gstlal_segment_list_index(segmentlist, 45) == 4);
+	CHECK(gstlal_segment_list_index(segmentlist, 52) == 8);
+	CHECK(gstlal_segment_list_index(segmentlist, 60) == 10);
+	CHECK(check_list(segmentlist, 0, 65) == 0);
+
+	index = gstlal_segment_index_new(segmentlist);
+	CHECK(check_index(index, unordered_union, G_N_ELEMENTS(unordered_union), 0, 65) == 0);
+	gstlal_segment_index_free(index);
+	gstlal_segment_list_free(segmentlist);
+
+	/*
+	 * empty list
+	 */
+
+	segmentlist = gstlal_segment_list_new();
+	CHECK(gstlal_segment_list_index(segmentlist, 0) == 0);
+	sublist = gstlal_segment_list_get_range(segmentlist, 0, 10);
+	CHECK(gstlal_segment_list_length(sublist) == 0);
+	gstlal_segment_list_free(sublist);
+	index = gstlal_segment_index_new(segmentlist);
+	cursor = 0;
+	CHECK(gstlal_segment_index_length(index) == 0);
+	CHECK(gstlal_segment_index_search(index, 5, &cursor) == 0);
+	CHECK(gstlal_segment_index_get_range(index, 0, 10, &cursor, &first) == 0 && first == NULL);
+	gstlal_segment_index_free(index);
+	gstlal_segment_list_free(segmentlist);
+
+	return 0;
+}
@@ -0,0 +1,151 @@
+#!/usr/bin/env python
+# Copyright (C) 2026  The gstlal authors
+#
+# This program is free software; you can redistribute it and/or modify it
+# under the terms of the GNU General Public License as published by the
+# Free Software Foundation; either version 2 of the License, or (at your
+# option) any later version.
+#
+# This program is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+# Public License for more details.
+#
+# You should have received a copy of the GNU General Public License along
+# with this program; if not, write to the Free Software Foundation, Inc.,
+# 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+
+#
+# Times lal_simulation on a dense injection campaign with waveforms
+# generated on the streaming thread (lookahead = 0) and ahead of time on
+# worker threads, and checks that both produce the same h(t).
+#
+# Usage:  simulation_bench_01.py [n_injections [n_workers]]
+#
+
+
+#
+# =============================================================================
+#
+#                                   Preamble
+#
+# =============================================================================
+#
+
+
+import numpy
+import sys
+import time
+
+
+from glue.ligolw import ligolw
+from glue.ligolw import lsctables
+from glue.ligolw import utils as ligolw_utils
+from gstlal import pipeparts
+from gstlal import pipeio
+import test_common
+
+
+#
+# =============================================================================
+#
+#                               Injection File
+#
+# =============================================================================
+#
+
+
+def write_injection_file(filename, n_injections, spacing, first_end_time):
+	numpy.random.seed(0)
+	xmldoc = ligolw.Document()
+	xmldoc.appendChild(ligolw.LIGO_LW())
+	sim_inspiral_table = lsctables.New(lsctables.SimInspiralTable)
+	xmldoc.childNodes[0].appendChild(sim_inspiral_table)
+
+	for i in range(n_injections):
+		row = sim_inspiral_table.RowType()
+		for column, coltype in sim_inspiral_table.validcolumns.items():
+			column = column.split(":")[-1]
+			if coltype in ("lstring", "char_s", "char_v"):
+				setattr(row, column, "")
+			elif coltype == "ilwd:char":
+				setattr(row, column, sim_inspiral_table.get_next_id() if column == "simulation_id" else lsctables.ProcessID(0))
+			else:
+				setattr(row, column, 0)
+		row.waveform = "TaylorT4threePointFivePN"
+		row.f_lower = 30.
+		row.mass1, row.mass2 = numpy.random.uniform(5., 20., 2)
+		row.mchirp = (row.mass1 * row.mass2)**.6 / (row.mass1 + row.mass2)**.2
+		row.eta = row.mass1 * row.mass2 / (row.mass1 + row.mass2)**2
+		row.distance = numpy.random.uniform(100., 1000.)
+		row.longitude = numpy.random.uniform(0., 2. * numpy.pi)
+		row.latitude = numpy.arcsin(numpy.random.uniform(-1., 1.))
+		row.inclination = numpy.arccos(numpy.random.uniform(-1., 1.))
+		row.polarization = numpy.random.uniform(0., 2. * numpy.pi)
+		row.coa_phase = numpy.random.uniform(0., 2. * numpy.pi)
+		t = first_end_time + i * spacing + numpy.random.uniform(0., spacing / 2.)
+		row.geocent_end_time = int(t)
+		row.geocent_end_time_ns = int((t - int(t)) * 1e9)
+		sim_inspiral_table.append(row)
+
+	ligolw_utils.write_filename(xmldoc, filename)
+
+
+#
+# =============================================================================
+#
+#                                  Pipelines
+#
+# =============================================================================
+#
+
+
+def simulation_bench_01(pipeline, name, injection_file, duration, rate, lookahead, n_workers, results):
+	head = test_common.test_src(pipeline, buffer_length = 1.0, rate = rate, width = 64, channels = 1, test_duration = duration, wave = 4, verbose = False)
+	head = pipeparts.mktaginject(pipeline, head, "instrument=H1,channel-name=LSC-STRAIN,units=strain")
+	head = pipeparts.mkgeneric(pipeline, head, "lal_simulation", xml_location = injection_file, lookahead = lookahead, n_workers = n_workers)
+	head = pipeparts.mkappsink(pipeline, head, max_buffers = 64)
+	def appsink_get_array(elem, results):
+		results.append(pipeio.array_from_audio_buffer(elem.get_last_buffer()).copy())
+	head.connect("new-buffer", appsink_get_array, results)
+	return pipeline
+
+
+#
+# =============================================================================
+#
+#                                     Main
+#
+# =============================================================================
+#
+
+
+n_injections = int(sys.argv[1]) if len(sys.argv) > 1 else 2000
+n_workers = int(sys.argv[2]) if len(sys.argv) > 2 else 4
+rate = 4096	# Hz
+spacing = 4.0	# seconds between injections
+first_end_time = 100	# s
+duration = first_end_time + n_injections * spacing + 20.	# seconds
+injection_file = "simulation_bench_01_injections.xml"
+
+write_injection_file(injection_file, n_injections, spacing, first_end_time)
+
+timings = {}
+outputs = {}
+for lookahead in (0., 32.):
+	name = "simulation_bench_01_lookahead%d" % lookahead
+	outputs[lookahead] = []
+	start = time.time()
+	test_common.build_and_run(simulation_bench_01, name, injection_file = injection_file, duration = duration, rate = rate, lookahead = lookahead, n_workers = n_workers, results = outputs[lookahead])
+	timings[lookahead] = time.time() - start
+	print >>sys.stderr, "%s: %d injections, %g s of data in %.2f s (%.1f x real time)" % (name, n_injections, duration, timings[lookahead], duration / timings[lookahead])
+
+print >>sys.stderr, "speed-up with %d workers: %.2f" % (n_workers, timings[0.] / timings[32.])
+
+reference = numpy.concatenate(outputs[0.])
+result = numpy.concatenate(outputs[32.])
+if reference.shape != result.shape or (reference != result).any():
+	raise ValueError("h(t) with look-ahead differs from h(t) without:  max |difference| = %g" % abs(reference - result).max())
+if not reference.any():
+	raise ValueError("no injections were made")